@@ -0,0 +1,171 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test suite for compression.cpp
+///
+/// @file
+///
+/// DISCLAIMER
+///
+/// Copyright 2015 ArangoDB GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Jan Steemann
+/// @author Copyright 2015, ArangoDB GmbH, Cologne, Germany
+////////////////////////////////////////////////////////////////////////////////
+
+#include <boost/test/unit_test.hpp>
+
+#include "Basics/compression.h"
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                    private macros
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief compresses and decompresses a string and checks the result
+////////////////////////////////////////////////////////////////////////////////
+
+static size_t RoundTrip (std::string const& value) {
+  std::string compressed;
+  compressed.resize(TRI_MaxCompressedSizeBlock(value.size()));
+
+  size_t const length = TRI_CompressBlock(value.c_str(), value.size(), &compressed[0], compressed.size());
+  BOOST_CHECK(length > 0);
+
+  std::string decompressed;
+  decompressed.resize(value.size());
+
+  BOOST_CHECK(TRI_DecompressBlock(compressed.c_str(), length, &decompressed[0], decompressed.size()));
+  BOOST_CHECK(decompressed == value);
+
+  return length;
+}
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                 setup / tear-down
+// -----------------------------------------------------------------------------
+
+struct CCompressionSetup {
+  CCompressionSetup () {
+    BOOST_TEST_MESSAGE("setup compression");
+  }
+
+  ~CCompressionSetup () {
+    BOOST_TEST_MESSAGE("tear-down compression");
+  }
+};
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                        test suite
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief setup
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_FIXTURE_TEST_SUITE(CCompressionTest, CCompressionSetup)
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test short and empty blocks, which are stored as literals
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE (tst_compression_short) {
+  BOOST_CHECK_EQUAL((size_t) 1, RoundTrip(""));
+  BOOST_CHECK_EQUAL((size_t) 2, RoundTrip("a"));
+  BOOST_CHECK_EQUAL((size_t) 13, RoundTrip("aaaaaaaaaaaa"));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test repetitive blocks
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE (tst_compression_repetitive) {
+  std::string value(100000, 'x');
+  BOOST_CHECK(RoundTrip(value) < 500);
+
+  value.clear();
+  for (size_t i = 0; i < 1000; ++i) {
+    value += "{\"name\":\"test" + std::to_string(i % 17) + "\",\"description\":\"some text\"}";
+  }
+  BOOST_CHECK(RoundTrip(value) < value.size() / 4);
+
+  // overlapping back-references with short offsets
+  value.clear();
+  for (size_t i = 0; i < 5000; ++i) {
+    value.push_back("abc"[i % 3]);
+  }
+  BOOST_CHECK(RoundTrip(value) < 100);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test incompressible blocks
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE (tst_compression_random) {
+  std::string value;
+  uint32_t state = 12345;
+
+  for (size_t i = 0; i < 70000; ++i) {
+    state = state * 1103515245 + 12345;
+    value.push_back(static_cast<char>(state >> 16));
+  }
+
+  BOOST_CHECK(RoundTrip(value) <= TRI_MaxCompressedSizeBlock(value.size()));
+
+  // does not fit into a buffer of the original size
+  std::string compressed;
+  compressed.resize(value.size());
+  BOOST_CHECK_EQUAL((size_t) 0, TRI_CompressBlock(value.c_str(), value.size(), &compressed[0], compressed.size()));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test decompression of corrupt data
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE (tst_compression_corrupt) {
+  std::string value(1000, 'y');
+  std::string compressed;
+  compressed.resize(TRI_MaxCompressedSizeBlock(value.size()));
+  compressed.resize(TRI_CompressBlock(value.c_str(), value.size(), &compressed[0], compressed.size()));
+
+  std::string decompressed;
+  decompressed.resize(value.size());
+
+  // wrong original size
+  BOOST_CHECK(! TRI_DecompressBlock(compressed.c_str(), compressed.size(), &decompressed[0], decompressed.size() - 1));
+  decompressed.resize(value.size() + 1);
+  BOOST_CHECK(! TRI_DecompressBlock(compressed.c_str(), compressed.size(), &decompressed[0], decompressed.size()));
+  decompressed.resize(value.size());
+
+  // truncated input
+  for (size_t i = 0; i < compressed.size(); ++i) {
+    BOOST_CHECK(! TRI_DecompressBlock(compressed.c_str(), i, &decompressed[0], decompressed.size()));
+  }
+
+  // back-reference before the start of the output
+  char const invalid[] = { 0x10, 'a', 0x02, 0x00, 0x00 };
+  BOOST_CHECK(! TRI_DecompressBlock(invalid, sizeof(invalid), &decompressed[0], 5));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief generate tests
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_SUITE_END ()
+
+// Local Variables:
+// mode: outline-minor
+// outline-regexp: "^\\(/// @brief\\|/// {@inheritDoc}\\|/// @addtogroup\\|// --SECTION--\\|/// @\\}\\)"
+// End:
@@ -423,6 +423,104 @@ BOOST_AUTO_TEST_CASE (tst_crc32_utf8) {
   BOOST_CHECK_EQUAL((uint64_t) 2590070434ULL,   TRI_FinalCrc32(TRI_BlockCrc32(TRI_InitialCrc32(), buffer.c_str(), strlen(buffer.c_str()))));
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test crc32c
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE (tst_crc32c_simple) {
+  std::string buffer;
+
+  buffer = "";
+  BOOST_CHECK_EQUAL((uint64_t) 0ULL, TRI_FinalCrc32(TRI_BlockCrc32C(TRI_InitialCrc32(), buffer.c_str(), buffer.size())));
+
+  buffer = "a";
+  BOOST_CHECK_EQUAL((uint64_t) 3251651376ULL, TRI_FinalCrc32(TRI_BlockCrc32C(TRI_InitialCrc32(), buffer.c_str(), buffer.size())));
+
+  buffer = "123456789";
+  BOOST_CHECK_EQUAL((uint64_t) 3808858755ULL, TRI_FinalCrc32(TRI_BlockCrc32C(TRI_InitialCrc32(), buffer.c_str(), buffer.size())));
+
+  buffer = "the quick brown fox jumped over the lazy dog";
+  BOOST_CHECK_EQUAL((uint64_t) 3928504206ULL, TRI_FinalCrc32(TRI_BlockCrc32C(TRI_InitialCrc32(), buffer.c_str(), buffer.size())));
+
+  buffer = "The Quick Brown Fox Jumped Over The Lazy Dog";
+  BOOST_CHECK_EQUAL((uint64_t) 4053635637ULL, TRI_FinalCrc32(TRI_BlockCrc32C(TRI_InitialCrc32(), buffer.c_str(), buffer.size())));
+
+  buffer = "äöüßÄÖÜ€µ";
+  BOOST_CHECK_EQUAL((uint64_t) 1426740181ULL, TRI_FinalCrc32(TRI_BlockCrc32C(TRI_InitialCrc32(), buffer.c_str(), buffer.size())));
+
+  // all byte values, at all alignments. this exercises both the bulk and
+  // the tail processing of the hardware and software implementations
+  buffer.clear();
+  for (size_t i = 0; i < 4 * 256; ++i) {
+    buffer.push_back(static_cast<char>(i & 0xFF));
+  }
+  BOOST_CHECK_EQUAL((uint64_t) 752840335ULL, TRI_FinalCrc32(TRI_BlockCrc32C(TRI_InitialCrc32(), buffer.c_str(), buffer.size())));
+
+  for (size_t offset = 1; offset < 8; ++offset) {
+    uint32_t expected = TRI_InitialCrc32();
+    for (size_t i = offset; i < buffer.size(); ++i) {
+      expected = TRI_BlockCrc32C(expected, buffer.c_str() + i, 1);
+    }
+
+    BOOST_CHECK_EQUAL(TRI_FinalCrc32(expected),
+                      TRI_FinalCrc32(TRI_BlockCrc32C(TRI_InitialCrc32(), buffer.c_str() + offset, buffer.size() - offset)));
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test that the hardware and software crc32c implementations agree
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE (tst_crc32c_hardware_software) {
+  if (! TRI_HasHardwareCrc32C()) {
+    BOOST_TEST_MESSAGE("CPU does not support SSE 4.2, comparing the software implementation with itself");
+  }
+
+  // pseudo-random data, so that all bytes of the lookup tables are used
+  std::string buffer;
+  uint32_t seed = 0x12345678;
+
+  for (size_t i = 0; i < 8 * 1024 + 7; ++i) {
+    seed = seed * 1103515245 + 12345;
+    buffer.push_back(static_cast<char>(seed >> 16));
+  }
+
+  // all lengths up to 256 bytes, at all alignments
+  for (size_t offset = 0; offset < 8; ++offset) {
+    for (size_t length = 0; length <= 256; ++length) {
+      BOOST_CHECK_EQUAL(TRI_SoftwareBlockCrc32C(TRI_InitialCrc32(), buffer.c_str() + offset, length),
+                        TRI_BlockCrc32C(TRI_InitialCrc32(), buffer.c_str() + offset, length));
+    }
+  }
+
+  // large blocks, and a value that is continued over several calls
+  for (size_t offset = 0; offset < 8; ++offset) {
+    size_t const length = buffer.size() - offset;
+
+    BOOST_CHECK_EQUAL(TRI_SoftwareBlockCrc32C(TRI_InitialCrc32(), buffer.c_str() + offset, length),
+                      TRI_BlockCrc32C(TRI_InitialCrc32(), buffer.c_str() + offset, length));
+
+    uint32_t expected = TRI_InitialCrc32();
+    uint32_t actual = TRI_InitialCrc32();
+
+    for (size_t i = offset; i < buffer.size(); i += 13) {
+      size_t const n = (std::min)(static_cast<size_t>(13), buffer.size() - i);
+      expected = TRI_SoftwareBlockCrc32C(expected, buffer.c_str() + i, n);
+      actual = TRI_BlockCrc32C(actual, buffer.c_str() + i, n);
+    }
+
+    BOOST_CHECK_EQUAL(expected, actual);
+  }
+
+  // blocks of a single byte value
+  for (int value = 0; value < 256; value += 15) {
+    std::string const block(1000, static_cast<char>(value));
+
+    BOOST_CHECK_EQUAL(TRI_SoftwareBlockCrc32C(TRI_InitialCrc32(), block.c_str(), block.size()),
+                      TRI_BlockCrc32C(TRI_InitialCrc32(), block.c_str(), block.size()));
+  }
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief generate tests
 ////////////////////////////////////////////////////////////////////////////////
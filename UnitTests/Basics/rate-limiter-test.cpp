@@ -0,0 +1,193 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test suite for RateLimiter
+///
+/// @file
+///
+/// DISCLAIMER
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Jan Steemann
+/// @author Copyright 2015, ArangoDB GmbH, Cologne, Germany
+////////////////////////////////////////////////////////////////////////////////
+
+#include <boost/test/unit_test.hpp>
+
+#include "Basics/RateLimiter.h"
+
+#include <thread>
+#include <vector>
+
+using namespace triagens::basics;
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                 setup / tear-down
+// -----------------------------------------------------------------------------
+
+struct CRateLimiterSetup {
+  CRateLimiterSetup () {
+    BOOST_TEST_MESSAGE("setup RateLimiter");
+  }
+
+  ~CRateLimiterSetup () {
+    BOOST_TEST_MESSAGE("tear-down RateLimiter");
+  }
+};
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                        test suite
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief setup
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_FIXTURE_TEST_SUITE(CRateLimiterTest, CRateLimiterSetup)
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test a limiter without a rate
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE (tst_unlimited) {
+  RateLimiter limiter(0);
+
+  BOOST_CHECK_EQUAL(0, (int) limiter.rate());
+
+  for (size_t i = 0; i < 100; ++i) {
+    BOOST_CHECK_EQUAL(0, (int) limiter.consume(1000 * 1000 * 1000));
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test a burst that fits into the bucket
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE (tst_burst) {
+  RateLimiter limiter(1000 * 1000);
+
+  BOOST_CHECK_EQUAL(1000 * 1000, (int) limiter.rate());
+
+  // the bucket starts full and holds one second worth of units
+  for (size_t i = 0; i < 10; ++i) {
+    BOOST_CHECK_EQUAL(0, (int) limiter.consume(1000));
+  }
+
+  BOOST_CHECK_EQUAL(0, (int) limiter.consume(0));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test that a consumer in debt is put to sleep
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE (tst_debt) {
+  RateLimiter limiter(100 * 1000);
+
+  // empty the bucket
+  limiter.consume(100 * 1000);
+
+  double const start = TRI_microtime();
+  uint64_t waitTime = limiter.consume(10 * 1000);
+  double const elapsed = TRI_microtime() - start;
+
+  // 10000 units at 100000 units per second take 100 ms, less what has been
+  // refilled since emptying the bucket
+  BOOST_CHECK(waitTime > 80 * 1000);
+  BOOST_CHECK(waitTime <= 100 * 1000);
+  BOOST_CHECK(elapsed >= (double) waitTime / 1000000.0 * 0.9);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test that a consumption larger than the bucket is paid off in full
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE (tst_large_consumption) {
+  RateLimiter limiter(100 * 1000);
+
+  // 1.5 seconds worth of units, of which 1 second is in the bucket
+  uint64_t waitTime = limiter.consume(150 * 1000);
+
+  BOOST_CHECK(waitTime > 450 * 1000);
+  BOOST_CHECK(waitTime <= 500 * 1000);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test changing the rate
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE (tst_set_rate) {
+  RateLimiter limiter(1000 * 1000);
+
+  // lowering the rate also shrinks the bucket
+  limiter.setRate(10 * 1000);
+  BOOST_CHECK_EQUAL(10 * 1000, (int) limiter.rate());
+
+  BOOST_CHECK_EQUAL(0, (int) limiter.consume(10 * 1000));
+
+  uint64_t waitTime = limiter.consume(1000);
+  BOOST_CHECK(waitTime > 80 * 1000);
+  BOOST_CHECK(waitTime <= 100 * 1000);
+
+  // turning off the limit
+  limiter.setRate(0);
+  BOOST_CHECK_EQUAL(0, (int) limiter.rate());
+  BOOST_CHECK_EQUAL(0, (int) limiter.consume(1000 * 1000));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test that concurrent consumers share the rate
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE (tst_concurrent) {
+  size_t const numThreads = 4;
+  size_t const numOps = 10;
+  uint64_t const units = 5 * 1000;
+
+  RateLimiter limiter(1000 * 1000);
+
+  // empty the bucket
+  limiter.consume(1000 * 1000);
+
+  double const start = TRI_microtime();
+
+  std::vector<std::thread> threads;
+
+  for (size_t i = 0; i < numThreads; ++i) {
+    threads.emplace_back([&limiter, numOps, units] () -> void {
+      for (size_t j = 0; j < numOps; ++j) {
+        limiter.consume(units);
+      }
+    });
+  }
+
+  for (auto& it : threads) {
+    it.join();
+  }
+
+  double const elapsed = TRI_microtime() - start;
+
+  // 200000 units at 1000000 units per second take at least 200 ms
+  BOOST_CHECK(elapsed >= 0.18);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief generate tests
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_SUITE_END ()
+
+// Local Variables:
+// mode: outline-minor
+// outline-regexp: "^\\(/// @brief\\|/// {@inheritDoc}\\|/// @addtogroup\\|// --SECTION--\\|/// @\\}\\)"
+// End:
@@ -512,6 +512,155 @@ describe ArangoDB do
 
     end
 
+################################################################################
+## streaming cursors
+################################################################################
+
+    context "handling a streaming cursor:" do
+      before do
+        @cn = "users"
+        ArangoDB.drop_collection(@cn)
+        @cid = ArangoDB.create_collection(@cn, false)
+
+        (0...10).each{|i|
+          ArangoDB.post("/_api/document?collection=#{@cid}", :body => "{ \"n\" : #{i} }")
+        }
+      end
+
+      after do
+        ArangoDB.drop_collection(@cn)
+      end
+
+      it "creates a streaming cursor single run" do
+        cmd = api
+        body = "{ \"query\" : \"FOR u IN #{@cn} LIMIT 2 RETURN u.n\", \"batchSize\" : 5, \"options\" : { \"stream\" : true } }"
+        doc = ArangoDB.log_post("#{prefix}-create-stream-single", cmd, :body => body)
+        
+        doc.code.should eq(201)
+        doc.headers['content-type'].should eq("application/json; charset=utf-8")
+        doc.parsed_response['error'].should eq(false)
+        doc.parsed_response['code'].should eq(201)
+        doc.parsed_response['id'].should be_nil
+        doc.parsed_response['hasMore'].should eq(false)
+        doc.parsed_response['count'].should eq(nil)
+        doc.parsed_response['result'].length.should eq(2)
+        doc.parsed_response['extra'].should have_key('stats')
+        doc.parsed_response['cached'].should eq(false)
+      end
+
+      it "creates a streaming cursor and continues it" do
+        cmd = api
+        body = "{ \"query\" : \"FOR u IN #{@cn} LIMIT 5 RETURN u.n\", \"batchSize\" : 2, \"options\" : { \"stream\" : true } }"
+        doc = ArangoDB.log_post("#{prefix}-create-stream", cmd, :body => body)
+        
+        doc.code.should eq(201)
+        doc.headers['content-type'].should eq("application/json; charset=utf-8")
+        doc.parsed_response['error'].should eq(false)
+        doc.parsed_response['code'].should eq(201)
+        doc.parsed_response['id'].should be_kind_of(String)
+        doc.parsed_response['id'].should match(@reId)
+        doc.parsed_response['hasMore'].should eq(true)
+        doc.parsed_response['count'].should eq(nil)
+        doc.parsed_response['result'].length.should eq(2)
+        doc.parsed_response['extra'].should be_nil
+
+        id = doc.parsed_response['id']
+
+        cmd = api + "/#{id}"
+        doc = ArangoDB.log_put("#{prefix}-create-stream", cmd)
+
+        doc.code.should eq(200)
+        doc.parsed_response['error'].should eq(false)
+        doc.parsed_response['code'].should eq(200)
+        doc.parsed_response['id'].should eq(id)
+        doc.parsed_response['hasMore'].should eq(true)
+        doc.parsed_response['result'].length.should eq(2)
+
+        doc = ArangoDB.log_put("#{prefix}-create-stream", cmd)
+
+        doc.code.should eq(200)
+        doc.parsed_response['error'].should eq(false)
+        doc.parsed_response['code'].should eq(200)
+        doc.parsed_response['id'].should be_nil
+        doc.parsed_response['hasMore'].should eq(false)
+        doc.parsed_response['result'].length.should eq(1)
+        doc.parsed_response['extra'].should have_key('stats')
+
+        doc = ArangoDB.log_put("#{prefix}-create-stream", cmd)
+
+        doc.code.should eq(404)
+        doc.parsed_response['error'].should eq(true)
+        doc.parsed_response['code'].should eq(404)
+        doc.parsed_response['errorNum'].should eq(1600)
+      end
+
+      it "deletes a streaming cursor" do
+        cmd = api
+        body = "{ \"query\" : \"FOR u IN #{@cn} RETURN u.n\", \"batchSize\" : 2, \"options\" : { \"stream\" : true } }"
+        doc = ArangoDB.log_post("#{prefix}-delete-stream", cmd, :body => body)
+        
+        doc.code.should eq(201)
+        doc.parsed_response['hasMore'].should eq(true)
+
+        id = doc.parsed_response['id']
+
+        cmd = api + "/#{id}"
+        doc = ArangoDB.log_delete("#{prefix}-delete-stream", cmd)
+
+        doc.code.should eq(202)
+        doc.parsed_response['error'].should eq(false)
+        doc.parsed_response['code'].should eq(202)
+        doc.parsed_response['id'].should eq(id)
+      end
+
+      it "continues a streaming cursor that calls a user function" do
+        ArangoDB.delete("/_api/aqlfunction/UnitTests%3A%3AstreamDouble")
+        body = "{ \"name\" : \"UnitTests::streamDouble\", \"code\" : \"function (value) { return value * 2; }\" }"
+        doc = ArangoDB.post("/_api/aqlfunction", :body => body)
+        doc.code.should eq(201)
+
+        # the execution engine produces up to 1000 values at a time, so the
+        # function is called again while producing the later batches
+        cmd = api
+        body = "{ \"query\" : \"FOR i IN 1..2500 RETURN UnitTests::streamDouble(i)\", \"batchSize\" : 400, \"options\" : { \"stream\" : true } }"
+        doc = ArangoDB.log_post("#{prefix}-create-stream-function", cmd, :body => body)
+
+        doc.code.should eq(201)
+        doc.parsed_response['error'].should eq(false)
+        doc.parsed_response['hasMore'].should eq(true)
+        doc.parsed_response['result'].length.should eq(400)
+
+        id = doc.parsed_response['id']
+        result = doc.parsed_response['result']
+
+        cmd = api + "/#{id}"
+        while doc.parsed_response['hasMore']
+          doc = ArangoDB.log_put("#{prefix}-create-stream-function", cmd)
+
+          doc.code.should eq(200)
+          doc.parsed_response['error'].should eq(false)
+          result.concat(doc.parsed_response['result'])
+        end
+
+        result.should eq((1..2500).map{|i| i * 2 })
+        doc.parsed_response['extra'].should have_key('stats')
+
+        ArangoDB.delete("/_api/aqlfunction/UnitTests%3A%3AstreamDouble")
+      end
+
+      it "rejects a streaming cursor with count" do
+        cmd = api
+        body = "{ \"query\" : \"FOR u IN #{@cn} RETURN u.n\", \"count\" : true, \"options\" : { \"stream\" : true } }"
+        doc = ArangoDB.log_post("#{prefix}-create-stream-count", cmd, :body => body)
+        
+        doc.code.should eq(400)
+        doc.parsed_response['error'].should eq(true)
+        doc.parsed_response['code'].should eq(400)
+        doc.parsed_response['errorNum'].should eq(10)
+      end
+
+    end
+
 ################################################################################
 ## checking a query
 ################################################################################
@@ -44,6 +44,30 @@ describe ArangoDB do
       doc.code.should eq(200)
     end
 
+################################################################################
+## check WAL sync time statistics
+###############################################################################
+
+    it "testing statistics for WAL sync time" do 
+      cn = "UnitTestsStatistics"
+      ArangoDB.drop_collection(cn)
+      ArangoDB.create_collection(cn)
+
+      cmd = "/_api/document?collection=#{cn}&waitForSync=true"
+      doc = ArangoDB.log_post("#{prefix}", cmd, :body => "{ \"value\" : 1 }")
+      doc.code.should eq(201)
+
+      cmd = "/_admin/statistics"
+      doc = ArangoDB.log_get("#{prefix}", cmd) 
+  
+      doc.code.should eq(200)
+      sync = doc.parsed_response['server']['walSyncTime']
+      sync['count'].should be > 0
+      sync['counts'].length.should eq(7)
+
+      ArangoDB.drop_collection(cn)
+    end
+
 ################################################################################
 ## check statistics for wrong user interaction
 ###############################################################################
@@ -217,6 +217,22 @@ void AqlItemBlock::destroy () {
 // --SECTION--                                                    public methods
 // -----------------------------------------------------------------------------
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief estimate the memory used by the block and the values it owns
+////////////////////////////////////////////////////////////////////////////////
+
+size_t AqlItemBlock::memoryUsage () const {
+  size_t size = sizeof(AqlValue) * _data.size();
+
+  // values can be referenced multiple times in a block, but are only
+  // accounted once
+  for (auto const& it : _valueCount) {
+    size += it.first.memoryUsage();
+  }
+
+  return size;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief shrink the block to the specified number of rows
 ////////////////////////////////////////////////////////////////////////////////
@@ -298,6 +298,12 @@ namespace triagens {
           return _docColls;
         }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief estimate the memory used by the block and the values it owns
+////////////////////////////////////////////////////////////////////////////////
+
+        size_t memoryUsage () const;
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief shrink the block to the specified number of rows
 ////////////////////////////////////////////////////////////////////////////////
@@ -37,6 +37,48 @@ using namespace triagens::aql;
 using Json = triagens::basics::Json;
 using JsonHelper = triagens::basics::JsonHelper;
 
+// -----------------------------------------------------------------------------
+// --SECTION--                                                 private functions
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief estimate the memory used by a JSON value and its sub-values
+////////////////////////////////////////////////////////////////////////////////
+
+static size_t MemoryUsageJson (TRI_json_t const* json) {
+  size_t size = 0;
+
+  switch (json->_type) {
+    case TRI_JSON_STRING:
+    case TRI_JSON_STRING_REFERENCE: {
+      size += json->_value._string.length;
+      break;
+    }
+
+    case TRI_JSON_ARRAY:
+    case TRI_JSON_OBJECT: {
+      size_t const n = TRI_LengthVector(&json->_value._objects);
+
+      // sub-values are stored inline in the vector
+      for (size_t i = 0; i < n; ++i) {
+        auto sub = static_cast<TRI_json_t const*>(TRI_AtVector(&json->_value._objects, i));
+        size += sizeof(TRI_json_t) + MemoryUsageJson(sub);
+      }
+      break;
+    }
+
+    default: {
+      break;
+    }
+  }
+
+  return size;
+}
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                    public methods
+// -----------------------------------------------------------------------------
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief a quick method to decide whether a value is true
 ////////////////////////////////////////////////////////////////////////////////
@@ -187,6 +229,44 @@ AqlValue AqlValue::shallowClone () const {
   return clone();
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief estimate the memory used by the value
+////////////////////////////////////////////////////////////////////////////////
+
+size_t AqlValue::memoryUsage () const {
+  switch (_type) {
+    case JSON: {
+      return sizeof(Json) + sizeof(TRI_json_t) + MemoryUsageJson(_json->json());
+    }
+
+    case DOCVEC: {
+      size_t size = sizeof(std::vector<AqlItemBlock*>);
+      for (auto const& it : *_vector) {
+        size += sizeof(AqlItemBlock) + it->memoryUsage();
+      }
+      return size;
+    }
+
+    case RANGE: {
+      return sizeof(Range);
+    }
+
+    case SHAPED: {
+      // the document is not copied, but it is kept in memory as long as the
+      // value is alive. this does not include the uncompressed body of a
+      // compressed marker, which is bounded by its own cache
+      TRI_ASSERT(_marker != nullptr);
+      return static_cast<size_t>(_marker->_size);
+    }
+
+    case EMPTY: {
+      return 0;
+    }
+  }
+
+  return 0;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief whether or not the AqlValue contains a string value
 ////////////////////////////////////////////////////////////////////////////////
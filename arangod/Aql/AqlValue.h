@@ -223,6 +223,13 @@ namespace triagens {
 
       AqlValue shallowClone () const;
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief estimate the memory used by the value, excluding the size of the
+/// AqlValue itself. SHAPED values point into datafiles and use no memory
+////////////////////////////////////////////////////////////////////////////////
+
+      size_t memoryUsage () const;
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief whether or not the AqlValue contains a string value
 ////////////////////////////////////////////////////////////////////////////////
@@ -1106,6 +1106,16 @@ AstNode* Ast::createNodeNop () {
 ////////////////////////////////////////////////////////////////////////////////
 
 void Ast::injectBindParameters (BindParameters& parameters) {
+  injectBindParameters(parameters, std::unordered_set<std::string>());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief injects bind parameters into the AST, except for the parameters
+/// with the given names
+////////////////////////////////////////////////////////////////////////////////
+
+void Ast::injectBindParameters (BindParameters& parameters,
+                                std::unordered_set<std::string> const& keep) {
   auto p = parameters();
 
   auto func = [&](AstNode* node, void*) -> AstNode* {
@@ -1128,6 +1138,17 @@ void Ast::injectBindParameters (BindParameters& parameters) {
       // mark the bind parameter as being used
       (*it).second.second = true;
 
+      if (keep.find((*it).first) != keep.end()) {
+        // the parameter stays in the AST. it is not constant, as its value 
+        // is not known to the optimizer, but otherwise it behaves like a value
+        node->setFlag(DETERMINED_CONSTANT);
+        node->setFlag(DETERMINED_SIMPLE, VALUE_SIMPLE);
+        node->setFlag(DETERMINED_RUNONDBSERVER, VALUE_RUNONDBSERVER);
+        node->setFlag(DETERMINED_THROWS);
+        node->setFlag(DETERMINED_NONDETERMINISTIC);
+        return node;
+      }
+
       auto value = (*it).second.first;
 
       if (*param == '@') {
@@ -1152,23 +1173,7 @@ void Ast::injectBindParameters (BindParameters& parameters) {
         }
       }
       else {
-        node = nodeFromJson(value, false);
-
-        if (node != nullptr) {
-          // already mark node as constant here
-          node->setFlag(DETERMINED_CONSTANT, VALUE_CONSTANT);
-          // mark node as simple
-          node->setFlag(DETERMINED_SIMPLE, VALUE_SIMPLE);
-          // mark node as executable on db-server
-          node->setFlag(DETERMINED_RUNONDBSERVER, VALUE_RUNONDBSERVER);
-          // mark node as non-throwing
-          node->setFlag(DETERMINED_THROWS);
-          // mark node as deterministic
-          node->setFlag(DETERMINED_NONDETERMINISTIC);
-          
-          // finally note that the node was created from a bind parameter
-          node->setFlag(FLAG_BIND_PARAMETER);
-        }
+        node = nodeFromBindParameter(value);
       }
     }
 
@@ -1204,6 +1209,144 @@ void Ast::injectBindParameters (BindParameters& parameters) {
   }
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief returns the names of the bind parameters that can be left in the
+/// AST for execution plans that are reused with other parameter values
+////////////////////////////////////////////////////////////////////////////////
+
+std::unordered_set<std::string> Ast::rebindableParameters (BindParameters& parameters) const {
+  std::unordered_set<std::string> result;
+  std::unordered_set<std::string> rejected;
+
+  auto const& p = parameters();
+
+  std::function<void(AstNode const*, AstNode const*, bool)> visit = [&] (AstNode const* node, 
+                                                                        AstNode const* parent,
+                                                                        bool mustBeConstant) -> void {
+    if (node == nullptr) {
+      return;
+    }
+
+    if (node->type == NODE_TYPE_LIMIT ||
+        node->type == NODE_TYPE_ARRAY_LIMIT) {
+      // limit values must be known when the plan is created
+      mustBeConstant = true;
+    }
+
+    if (node->type == NODE_TYPE_PARAMETER) {
+      std::string const name(node->getStringValue());
+
+      bool isOperand = false;
+
+      if (parent != nullptr && ! mustBeConstant) {
+        switch (parent->type) {
+          case NODE_TYPE_OPERATOR_UNARY_PLUS:
+          case NODE_TYPE_OPERATOR_UNARY_MINUS:
+          case NODE_TYPE_OPERATOR_UNARY_NOT:
+          case NODE_TYPE_OPERATOR_BINARY_AND:
+          case NODE_TYPE_OPERATOR_BINARY_OR:
+          case NODE_TYPE_OPERATOR_BINARY_PLUS:
+          case NODE_TYPE_OPERATOR_BINARY_MINUS:
+          case NODE_TYPE_OPERATOR_BINARY_TIMES:
+          case NODE_TYPE_OPERATOR_BINARY_DIV:
+          case NODE_TYPE_OPERATOR_BINARY_MOD:
+          case NODE_TYPE_OPERATOR_BINARY_EQ:
+          case NODE_TYPE_OPERATOR_BINARY_NE:
+          case NODE_TYPE_OPERATOR_BINARY_LT:
+          case NODE_TYPE_OPERATOR_BINARY_LE:
+          case NODE_TYPE_OPERATOR_BINARY_GT:
+          case NODE_TYPE_OPERATOR_BINARY_GE:
+          case NODE_TYPE_OPERATOR_BINARY_IN:
+          case NODE_TYPE_OPERATOR_BINARY_NIN:
+          case NODE_TYPE_OPERATOR_TERNARY:
+            isOperand = true;
+            break;
+          default:
+            break;
+        }
+      }
+
+      auto it = p.find(name);
+
+      if (! isOperand || 
+          name[0] == '@' ||
+          it == p.end() ||
+          TRI_IsArrayJson((*it).second.first) || 
+          TRI_IsObjectJson((*it).second.first)) {
+        // collection parameters, parameters with array or object values and 
+        // parameters used in other places, e.g. in LIMIT or as attribute 
+        // names, may change the structure of the plan
+        rejected.emplace(name);
+      }
+      else {
+        result.emplace(name);
+      }
+      return;
+    }
+
+    size_t const n = node->numMembers();
+
+    for (size_t i = 0; i < n; ++i) {
+      visit(node->getMember(i), node, mustBeConstant);
+    }
+  };
+
+  visit(_root, nullptr, false);
+
+  for (auto const& it : rejected) {
+    result.erase(it);
+  }
+
+  return result;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief create an AST node for the value of a bind parameter
+////////////////////////////////////////////////////////////////////////////////
+
+AstNode* Ast::nodeFromBindParameter (TRI_json_t const* value) {
+  AstNode* node = nodeFromJson(value, false);
+
+  if (node != nullptr) {
+    // already mark node as constant here
+    node->setFlag(DETERMINED_CONSTANT, VALUE_CONSTANT);
+    // mark node as simple
+    node->setFlag(DETERMINED_SIMPLE, VALUE_SIMPLE);
+    // mark node as executable on db-server
+    node->setFlag(DETERMINED_RUNONDBSERVER, VALUE_RUNONDBSERVER);
+    // mark node as non-throwing
+    node->setFlag(DETERMINED_THROWS);
+    // mark node as deterministic
+    node->setFlag(DETERMINED_NONDETERMINISTIC);
+    
+    // finally note that the node was created from a bind parameter
+    node->setFlag(FLAG_BIND_PARAMETER);
+  }
+
+  return node;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief create an AST node from its JSON representation in an execution
+/// plan
+////////////////////////////////////////////////////////////////////////////////
+
+AstNode* Ast::nodeFromPlanJson (triagens::basics::Json const& json) {
+  if (AstNode::getNodeTypeFromJson(json) == NODE_TYPE_PARAMETER) {
+    // the plan was created for other values of this bind parameter
+    std::string const name = triagens::basics::JsonHelper::getStringValue(json.json(), "name", "");
+    auto value = _query->bindParameter(name);
+
+    if (value == nullptr) {
+      THROW_ARANGO_EXCEPTION_PARAMS(TRI_ERROR_QUERY_BIND_PARAMETER_MISSING, name.c_str());
+    }
+
+    return nodeFromBindParameter(value);
+  }
+
+  return new AstNode(this, json);
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief replace variables
 ////////////////////////////////////////////////////////////////////////////////
@@ -1546,6 +1689,11 @@ AstNode* Ast::clone (AstNode const* node) {
       type == NODE_TYPE_OBJECT_ELEMENT ||
       type == NODE_TYPE_FCALL_USER) {
     copy->setStringValue(node->getStringValue());
+
+    if (type == NODE_TYPE_PARAMETER) {
+      // bind parameters left in the AST carry their properties in the flags
+      copy->flags = node->flags;
+    }
   }
   else if (type == NODE_TYPE_VARIABLE ||
            type == NODE_TYPE_REFERENCE ||
@@ -571,6 +571,43 @@ namespace triagens {
 
         void injectBindParameters (BindParameters&);
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief injects bind parameters into the AST, except for the parameters
+/// with the given names. these are left in the AST as parameter nodes, which
+/// the optimizer treats like values that are unknown until execution. an
+/// execution plan created from such an AST can be reused for other values
+/// of these parameters, but it must be instanciated from its JSON
+/// representation before execution, which replaces the parameter nodes with
+/// the values
+////////////////////////////////////////////////////////////////////////////////
+
+        void injectBindParameters (BindParameters&,
+                                   std::unordered_set<std::string> const&);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief returns the names of the bind parameters that can be left in the
+/// AST for execution plans that are reused with other parameter values.
+/// these are the parameters with scalar values that are only used as
+/// operands of comparisons, arithmetic and logical operators, so the
+/// structure of the plan cannot depend on their values
+////////////////////////////////////////////////////////////////////////////////
+
+        std::unordered_set<std::string> rebindableParameters (BindParameters&) const;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief create an AST node for the value of a bind parameter
+////////////////////////////////////////////////////////////////////////////////
+
+        AstNode* nodeFromBindParameter (TRI_json_t const*);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief create an AST node from its JSON representation in an execution
+/// plan. bind parameters left in the plan are replaced with the parameter
+/// values of the current query
+////////////////////////////////////////////////////////////////////////////////
+
+        AstNode* nodeFromPlanJson (triagens::basics::Json const&);
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief replace variables
 ////////////////////////////////////////////////////////////////////////////////
@@ -580,7 +580,7 @@ AstNode::AstNode (Ast* ast,
     size_t const len = subNodes.size();
     for (size_t i = 0; i < len; i++) {
       Json subNode(subNodes.at(static_cast<int>(i)));
-      addMember(new AstNode(ast, subNode));
+      addMember(ast->nodeFromPlanJson(subNode));
     }
   }
 
@@ -43,8 +43,7 @@ CollectionScanner::CollectionScanner (triagens::arango::AqlTransaction* trx,
                                       TRI_transaction_collection_t* trxCollection) 
   : trx(trx), 
     trxCollection(trxCollection),
-    totalCount(0),
-    position(0) {
+    totalCount(0) {
 }
   
 CollectionScanner::~CollectionScanner () {
@@ -61,6 +60,7 @@ CollectionScanner::~CollectionScanner () {
 RandomCollectionScanner::RandomCollectionScanner (triagens::arango::AqlTransaction* trx,
                                                   TRI_transaction_collection_t* trxCollection) 
   : CollectionScanner(trx, trxCollection),
+    position(0),
     initialPosition(0),
     step(0) {
 
@@ -97,7 +97,8 @@ void RandomCollectionScanner::reset () {
 
 LinearCollectionScanner::LinearCollectionScanner (triagens::arango::AqlTransaction* trx,
                                                   TRI_transaction_collection_t* trxCollection) 
-  : CollectionScanner(trx, trxCollection) {
+  : CollectionScanner(trx, trxCollection),
+    position() {
 
 }
 
@@ -117,7 +118,45 @@ int LinearCollectionScanner::scan (std::vector<TRI_doc_mptr_copy_t>& docs,
 // -----------------------------------------------------------------------------
 
 void LinearCollectionScanner::reset () {
-  position = 0;
+  position.reset();
+}
+
+// -----------------------------------------------------------------------------
+// --SECTION--                               struct PartitionedCollectionScanner
+// -----------------------------------------------------------------------------
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                        constructors / destructors
+// -----------------------------------------------------------------------------
+
+PartitionedCollectionScanner::PartitionedCollectionScanner (triagens::arango::AqlTransaction* trx,
+                                                            TRI_transaction_collection_t* trxCollection,
+                                                            size_t partition,
+                                                            size_t numPartitions) 
+  : CollectionScanner(trx, trxCollection),
+    position(),
+    partition(partition),
+    numPartitions(numPartitions) {
+
+}
+
+int PartitionedCollectionScanner::scan (std::vector<TRI_doc_mptr_copy_t>& docs,
+                                        size_t batchSize) {
+  return trx->readPartition(trxCollection,
+                            docs,
+                            position,
+                            partition,
+                            numPartitions,
+                            static_cast<TRI_voc_size_t>(batchSize),
+                            &totalCount);
+}
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                  public functions
+// -----------------------------------------------------------------------------
+
+void PartitionedCollectionScanner::reset () {
+  position.reset();
 }
 
 // -----------------------------------------------------------------------------
@@ -31,6 +31,7 @@
 #define ARANGODB_AQL_COLLECTION_SCANNER_H 1
 
 #include "Basics/Common.h"
+#include "Indexes/PrimaryIndex.h"
 #include "Utils/AqlTransaction.h"
 #include "VocBase/document-collection.h"
 #include "VocBase/transaction.h"
@@ -65,7 +66,6 @@ namespace triagens {
       triagens::arango::AqlTransaction* trx;
       TRI_transaction_collection_t* trxCollection;
       uint32_t totalCount;
-      TRI_voc_size_t position;
     };
 
 // -----------------------------------------------------------------------------
@@ -86,6 +86,7 @@ namespace triagens {
 
       void reset () override;
 
+      TRI_voc_size_t position;
       uint32_t initialPosition;
       uint32_t step;
     };
@@ -107,8 +108,35 @@ namespace triagens {
                 size_t) override;
       
       void reset () override;
+
+      triagens::arango::PrimaryIndex::Position position;
     };
 
+
+// -----------------------------------------------------------------------------
+// --SECTION--                               struct PartitionedCollectionScanner
+// -----------------------------------------------------------------------------
+
+    struct PartitionedCollectionScanner final : public CollectionScanner {
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                        constructors / destructors
+// -----------------------------------------------------------------------------
+  
+      PartitionedCollectionScanner (triagens::arango::AqlTransaction*,
+                                    TRI_transaction_collection_t*,
+                                    size_t,
+                                    size_t); 
+
+      int scan (std::vector<TRI_doc_mptr_copy_t>&,
+                size_t) override;
+      
+      void reset () override;
+
+      triagens::arango::PrimaryIndex::Position position;
+      size_t const partition;
+      size_t const numPartitions;
+    };
   }
 }
 
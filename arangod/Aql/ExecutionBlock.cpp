@@ -26,6 +26,7 @@
 ////////////////////////////////////////////////////////////////////////////////
 
 #include "Aql/ExecutionBlock.h"
+#include "Aql/AttributeAccessor.h"
 #include "Aql/CollectionScanner.h"
 #include "Aql/ExecutionEngine.h"
 #include "Aql/Functions.h"
@@ -33,6 +34,7 @@
 #include "Basics/StringUtils.h"
 #include "Basics/StringBuffer.h"
 #include "Basics/json-utilities.h"
+#include "Basics/system-functions.h"
 #include "Basics/Exceptions.h"
 #include "Dispatcher/DispatcherThread.h"
 #include "Cluster/ClusterMethods.h"
@@ -41,6 +43,7 @@
 #include "Indexes/SkiplistIndex2.h"
 #include "V8/v8-globals.h"
 #include "VocBase/edge-collection.h"
+#include "VocBase/KeyGenerator.h"
 #include "VocBase/vocbase.h"
 
 using namespace std;
@@ -157,6 +160,43 @@ void AggregatorGroup::addValues (AqlItemBlock const* src,
   rowsAreValid = false;
 }
 
+// -----------------------------------------------------------------------------
+// --SECTION--                                    GroupKeyHash and GroupKeyEqual
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief hasher for groups
+////////////////////////////////////////////////////////////////////////////////
+
+size_t GroupKeyHash::operator() (std::vector<AqlValue> const& value) const {
+  uint64_t hash = 0x12345678;
+
+  for (size_t i = 0; i < _num; ++i) {
+    hash ^= value[i].hash(_trx, _colls[i]);
+  }
+
+  return static_cast<size_t>(hash);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief comparator for groups
+////////////////////////////////////////////////////////////////////////////////
+    
+bool GroupKeyEqual::operator() (std::vector<AqlValue> const& lhs,
+                                std::vector<AqlValue> const& rhs) const {
+  size_t const n = lhs.size();
+
+  for (size_t i = 0; i < n; ++i) {
+    int res = AqlValue::Compare(_trx, lhs[i], _colls[i], rhs[i], _colls[i], false);
+
+    if (res != 0) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
 // -----------------------------------------------------------------------------
 // --SECTION--                                              class ExecutionBlock
 // -----------------------------------------------------------------------------
@@ -180,7 +220,8 @@ ExecutionBlock::ExecutionBlock (ExecutionEngine* engine,
   : _engine(engine),
     _trx(engine->getQuery()->trx()), 
     _exeNode(ep), 
-    _done(false) {
+    _done(false),
+    _profile(engine->getQuery()->profiling()) {
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -445,7 +486,7 @@ void ExecutionBlock::inheritRegisters (AqlItemBlock const* src,
 bool ExecutionBlock::getBlock (size_t atLeast, size_t atMost) {
   throwIfKilled(); // check if we were aborted
 
-  std::unique_ptr<AqlItemBlock> docs(_dependencies[0]->getSome(atLeast, atMost));
+  std::unique_ptr<AqlItemBlock> docs(_dependencies[0]->getSomeProfiled(atLeast, atMost));
 
   if (docs == nullptr) {
     return false;
@@ -507,13 +548,59 @@ size_t ExecutionBlock::skipSome (size_t atLeast, size_t atMost) {
   return skipped;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief getSome, and record the call in the node's runtime statistics if 
+/// the query is profiled
+////////////////////////////////////////////////////////////////////////////////
+
+AqlItemBlock* ExecutionBlock::getSomeProfiled (size_t atLeast, size_t atMost) {
+  if (! _profile) {
+    return getSome(atLeast, atMost);
+  }
+
+  double const start = TRI_microtime();
+  AqlItemBlock* result = getSome(atLeast, atMost);
+
+  auto& stats = _engine->_stats.nodes[_exeNode->id()];
+  ++stats.calls;
+  stats.runtime += TRI_microtime() - start;
+
+  if (result != nullptr) {
+    stats.items  += static_cast<int64_t>(result->size());
+    stats.memory += static_cast<int64_t>(result->memoryUsage());
+  }
+
+  return result;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief skipSome, and record the call in the node's runtime statistics if
+/// the query is profiled
+////////////////////////////////////////////////////////////////////////////////
+
+size_t ExecutionBlock::skipSomeProfiled (size_t atLeast, size_t atMost) {
+  if (! _profile) {
+    return skipSome(atLeast, atMost);
+  }
+
+  double const start = TRI_microtime();
+  size_t const skipped = skipSome(atLeast, atMost);
+
+  auto& stats = _engine->_stats.nodes[_exeNode->id()];
+  ++stats.calls;
+  stats.runtime += TRI_microtime() - start;
+  stats.items   += static_cast<int64_t>(skipped);
+
+  return skipped;
+}
+
 // skip exactly <number> outputs, returns <true> if _done after
 // skipping, and <false> otherwise . . .
 bool ExecutionBlock::skip (size_t number) {
-  size_t skipped = skipSome(number, number);
+  size_t skipped = skipSomeProfiled(number, number);
   size_t nr = skipped;
   while (nr != 0 && skipped < number) {
-    nr = skipSome(number - skipped, number - skipped);
+    nr = skipSomeProfiled(number - skipped, number - skipped);
     skipped += nr;
   }
   if (nr == 0) {
@@ -784,8 +871,33 @@ int SingletonBlock::getOrSkipSome (size_t,   // atLeast,
 // --SECTION--                                    class EnumerateCollectionBlock
 // -----------------------------------------------------------------------------
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief whether the scan of a collection will read all of its documents,
+/// i.e. it is not cut short by a LIMIT. a SORT or COLLECT consumes all input
+/// before a LIMIT above it takes effect
+////////////////////////////////////////////////////////////////////////////////
+
+static bool IsCompleteScan (ExecutionNode const* node) {
+  while (node->hasParent()) {
+    node = node->getParents()[0];
+
+    switch (node->getType()) {
+      case ExecutionNode::LIMIT:
+        return false;
+      case ExecutionNode::SORT:
+      case ExecutionNode::AGGREGATE:
+        return true;
+      default:
+        break;
+    }
+  }
+
+  return true;
+}
+
 EnumerateCollectionBlock::EnumerateCollectionBlock (ExecutionEngine* engine,
-                                                    EnumerateCollectionNode const* ep)
+                                                    EnumerateCollectionNode const* ep,
+                                                    bool prefetch)
   : ExecutionBlock(engine, ep),
     _collection(ep->_collection),
     _scanner(nullptr),
@@ -796,6 +908,13 @@ EnumerateCollectionBlock::EnumerateCollectionBlock (ExecutionEngine* engine,
   auto trxCollection = _trx->trxCollection(_collection->cid());
   if (trxCollection != nullptr) {
     _trx->orderDitch(trxCollection);
+
+    if (prefetch && ! _random && IsCompleteScan(ep)) {
+      // documents are returned in primary index order, which is random with
+      // respect to their positions in the datafiles, so let the kernel read
+      // the datafiles in the background instead of faulting in single pages
+      TRI_PrefetchDocumentCollection(_collection->documentCollection());
+    }
   }
 
   if (_random) {
@@ -812,6 +931,17 @@ EnumerateCollectionBlock::~EnumerateCollectionBlock () {
   delete _scanner;
 }
 
+void EnumerateCollectionBlock::setPartition (size_t partition,
+                                             size_t numPartitions) {
+  TRI_ASSERT(! _random);
+
+  auto trxCollection = _trx->trxCollection(_collection->cid());
+  auto scanner = new PartitionedCollectionScanner(_trx, trxCollection, partition, numPartitions);
+
+  delete _scanner;
+  _scanner = scanner;
+}
+
 bool EnumerateCollectionBlock::moreDocuments (size_t hint) {
   if (hint < DefaultBatchSize) {
     hint = DefaultBatchSize;
@@ -1413,7 +1543,7 @@ bool IndexRangeBlock::initRanges () {
 
   if (_anyBoundVariable) {
     if (_hasV8Expression) {
-      bool const isRunningInCluster = triagens::arango::ServerState::instance()->isRunningInCluster();
+      bool const mustExitContext = _engine->getQuery()->mustExitContext();
 
       // must have a V8 context here to protect Expression::execute()
       auto engine = _engine;
@@ -1422,13 +1552,11 @@ bool IndexRangeBlock::initRanges () {
           engine->getQuery()->enterContext(); 
         },
         [&]() -> void {
-          if (isRunningInCluster) {
+          if (mustExitContext) {
             // must invalidate the expression now as we might be called from
             // different threads
-            if (triagens::arango::ServerState::instance()->isRunningInCluster()) {
-              for (auto const& e : _allVariableBoundExpressions) {
-                e->invalidate();
-              }
+            for (auto const& e : _allVariableBoundExpressions) {
+              e->invalidate();
             }
           
             engine->getQuery()->exitContext(); 
@@ -2759,150 +2887,576 @@ void EnumerateListBlock::throwArrayExpectedException () {
 }
 
 // -----------------------------------------------------------------------------
-// --SECTION--                                            class CalculationBlock
+// --SECTION--                                                  class GraphBlock
 // -----------------------------------------------------------------------------
-        
-CalculationBlock::CalculationBlock (ExecutionEngine* engine,
-                                    CalculationNode const* en)
-  : ExecutionBlock(engine, en),
-    _expression(en->expression()),
-    _inVars(),
-    _inRegs(),
-    _outReg(ExecutionNode::MaxRegisterId) {
 
-  std::unordered_set<Variable const*> inVars;
-  _expression->variables(inVars);
+GraphBlock::GraphBlock (ExecutionEngine* engine,
+                        ExecutionNode const* en,
+                        bool includeData)
+  : ExecutionBlock(engine, en),
+    _ids(),
+    _index(0),
+    _computed(false),
+    _includeData(includeData) {
+}
 
-  _inVars.reserve(inVars.size());
-  _inRegs.reserve(inVars.size());
+GraphBlock::~GraphBlock () {
+}
 
-  for (auto& it : inVars) {
-    _inVars.emplace_back(it);
-    auto it2 = en->getRegisterPlan()->varInfo.find(it->id);
+int GraphBlock::initializeCursor (AqlItemBlock* items, size_t pos) {
+  int res = ExecutionBlock::initializeCursor(items, pos);
 
-    TRI_ASSERT(it2 != en->getRegisterPlan()->varInfo.end());
-    TRI_ASSERT(it2->second.registerId < ExecutionNode::MaxRegisterId);
-    _inRegs.emplace_back(it2->second.registerId);
+  if (res != TRI_ERROR_NO_ERROR) {
+    return res;
   }
 
-  // check if the expression is "only" a reference to another variable
-  // this allows further optimizations inside doEvaluation
-  _isReference = (_expression->node()->type == NODE_TYPE_REFERENCE);
+  // handle local data (if any)
+  _ids.clear();
+  _index = 0;
+  _computed = false;
 
-  if (_isReference) {
-    TRI_ASSERT(_inRegs.size() == 1);
+  return TRI_ERROR_NO_ERROR;
+}
+
+AqlItemBlock* GraphBlock::getSome (size_t, size_t atMost) {
+  if (_done) {
+    return nullptr;
   }
 
-  auto it3 = en->getRegisterPlan()->varInfo.find(en->_outVariable->id);
-  TRI_ASSERT(it3 != en->getRegisterPlan()->varInfo.end());
-  _outReg = it3->second.registerId;
-  TRI_ASSERT(_outReg < ExecutionNode::MaxRegisterId);
-  
-  if (en->_conditionVariable != nullptr) {
-    auto it = en->getRegisterPlan()->varInfo.find(en->_conditionVariable->id);
-    TRI_ASSERT(it != en->getRegisterPlan()->varInfo.end());
-    _conditionReg = it->second.registerId;
-    TRI_ASSERT(_conditionReg < ExecutionNode::MaxRegisterId);
+  unique_ptr<AqlItemBlock> res(nullptr);
+
+  do {
+    // repeatedly try to get more stuff from upstream
+    // note that an input row may produce zero ids, in which case we have to
+    // try again!
+    if (! prepareIds(atMost)) {
+      _done = true;
+      return nullptr;
+    }
+
+    // if we make it here, then _buffer.front() exists
+    AqlItemBlock* cur = _buffer.front();
+    size_t const n = _ids.size();
+
+    if (_index < n) {
+      size_t toSend = (std::min)(atMost, n - _index);
+
+      // create the result
+      res.reset(new AqlItemBlock(toSend, getPlanNode()->getRegisterPlan()->nrRegs[getPlanNode()->getDepth()]));
+
+      inheritRegisters(cur, res.get(), _pos);
+
+      for (size_t j = 0; j < toSend; j++) {
+        if (j > 0) {
+          // re-use already copied aqlvalues
+          for (RegisterId i = 0; i < cur->getNrRegs(); i++) {
+            res->setValue(j, i, res->getValueReference(0, i));
+            // Note that if this throws, all values will be
+            // deleted properly, since the first row is.
+          }
+        }
+
+        AqlValue a = idToAqlValue(_ids[_index++]);
+
+        try {
+          TRI_IF_FAILURE("GraphBlock::getSome") {
+            THROW_ARANGO_EXCEPTION(TRI_ERROR_DEBUG);
+          }
+          res->setValue(j, cur->getNrRegs(), a);
+        }
+        catch (...) {
+          a.destroy();
+          throw;
+        }
+      }
+    }
+
+    if (_index == n) {
+      nextRow();
+    }
   }
-}
+  while (res.get() == nullptr);
 
-CalculationBlock::~CalculationBlock () {
+  // Clear out registers no longer needed later:
+  clearRegisters(res.get());
+  return res.release();
 }
 
-int CalculationBlock::initialize () {
-  return ExecutionBlock::initialize();
-}
+size_t GraphBlock::skipSome (size_t atLeast, size_t atMost) {
+  if (_done) {
+    return 0;
+  }
 
-////////////////////////////////////////////////////////////////////////////////
-/// @brief fill the target register in the item block with a reference to 
-/// another variable
-////////////////////////////////////////////////////////////////////////////////
+  size_t skipped = 0;
 
-void CalculationBlock::fillBlockWithReference (AqlItemBlock* result) {
-  result->setDocumentCollection(_outReg, result->getDocumentCollection(_inRegs[0]));
+  while (skipped < atLeast) {
+    if (! prepareIds(atMost)) {
+      _done = true;
+      return skipped;
+    }
 
-  size_t const n = result->size();
-  for (size_t i = 0; i < n; i++) {
-    // need not clone to avoid a copy, the AqlItemBlock's hash takes
-    // care of correct freeing:
-    auto a = result->getValueReference(i, _inRegs[0]);
+    // the ids must be computed to know how many rows the input row
+    // produces, but documents are not fetched for skipped rows
+    size_t const available = _ids.size() - _index;
 
-    try {
-      TRI_IF_FAILURE("CalculationBlock::fillBlockWithReference") {
-        THROW_ARANGO_EXCEPTION(TRI_ERROR_DEBUG);
-      }
-      result->setValue(i, _outReg, a);
+    if (atMost - skipped < available) {
+      _index += atMost - skipped;
+      skipped = atMost;
     }
-    catch (...) {
-      a.destroy();
-      throw;
+    else {
+      skipped += available;
+      nextRow();
     }
   }
+
+  return skipped;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-/// @brief shared code for executing a simple or a V8 expression
+/// @brief look up the id of a collection used in the query
 ////////////////////////////////////////////////////////////////////////////////
 
-void CalculationBlock::executeExpression (AqlItemBlock* result) {
-  result->setDocumentCollection(_outReg, nullptr);
+TRI_voc_cid_t GraphBlock::lookupCollection (std::string const& name) const {
+  TRI_voc_cid_t cid = _trx->resolver()->getCollectionId(name);
 
-  bool const hasCondition = (static_cast<CalculationNode const*>(_exeNode)->_conditionVariable != nullptr);
+  if (cid == 0) {
+    THROW_ARANGO_EXCEPTION_PARAMS(TRI_ERROR_ARANGO_COLLECTION_NOT_FOUND, name.c_str());
+  }
 
-  size_t const n = result->size();
+  if (_trx->trxCollection(cid) == nullptr) {
+    // collection was not registered when the query started
+    THROW_ARANGO_EXCEPTION_MESSAGE(TRI_ERROR_TRANSACTION_UNREGISTERED_COLLECTION, name);
+  }
 
-  for (size_t i = 0; i < n; i++) {
-    // check the condition variable (if any)
-    if (hasCondition) {
-      AqlValue conditionResult = result->getValueReference(i, _conditionReg);
+  return cid;
+}
 
-      if (! conditionResult.isTrue()) {
-        TRI_IF_FAILURE("CalculationBlock::executeExpressionWithCondition") {
-          THROW_ARANGO_EXCEPTION(TRI_ERROR_DEBUG);
-        }
-        result->setValue(i, _outReg, AqlValue(new Json(TRI_UNKNOWN_MEM_ZONE, &Expression::NullJson, Json::NOFREE)));
-        continue;
-      }
-    }
-    
-    // execute the expression
-    TRI_document_collection_t const* myCollection = nullptr;
-    AqlValue a = _expression->execute(_trx, result, i, _inVars, _inRegs, &myCollection);
-    
-    try {
-      TRI_IF_FAILURE("CalculationBlock::executeExpression") {
-        THROW_ARANGO_EXCEPTION(TRI_ERROR_DEBUG);
-      }
-      result->setValue(i, _outReg, a);
-    }
-    catch (...) {
-      a.destroy();
-      throw;
-    }
-    throwIfKilled(); // check if we were aborted
+////////////////////////////////////////////////////////////////////////////////
+/// @brief order a ditch for the edge collection
+////////////////////////////////////////////////////////////////////////////////
+
+void GraphBlock::orderEdgeDitch (std::string const& name) {
+  auto trxCollection = _trx->trxCollection(_trx->resolver()->getCollectionId(name));
+
+  if (trxCollection != nullptr &&
+      _trx->orderDitch(trxCollection) == nullptr) {
+    THROW_ARANGO_EXCEPTION(TRI_ERROR_OUT_OF_MEMORY);
   }
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-/// @brief doEvaluation, private helper to do the work
+/// @brief extract a vertex id from a register value
 ////////////////////////////////////////////////////////////////////////////////
 
-void CalculationBlock::doEvaluation (AqlItemBlock* result) {
-  TRI_ASSERT(result != nullptr);
+VertexId GraphBlock::extractVertexId (AqlItemBlock const* items,
+                                      size_t pos,
+                                      RegisterId reg,
+                                      std::string const& vertexCollection,
+                                      bool mustBeInVertexCollection,
+                                      char const* functionName,
+                                      std::string& buffer) const {
+  Json value(items->getValueReference(pos, reg).toJson(_trx, items->getDocumentCollection(reg), false));
+  TRI_json_t const* json = value.json();
 
-  if (_isReference) {
-    // the calculation is a reference to a variable only.
-    // no need to execute the expression at all
-    fillBlockWithReference(result);
-    throwIfKilled(); // check if we were aborted
-    return;
+  if (TRI_IsObjectJson(json)) {
+    json = TRI_LookupObjectJson(json, TRI_VOC_ATTRIBUTE_ID);
   }
 
-  // non-reference expression
+  if (! TRI_IsStringJson(json)) {
+    THROW_ARANGO_EXCEPTION_PARAMS(TRI_ERROR_QUERY_FUNCTION_ARGUMENT_TYPE_MISMATCH, functionName);
+  }
 
-  TRI_ASSERT(_expression != nullptr);
+  buffer = JsonHelper::getStringValue(json, "");
 
-  if (! _expression->isV8()) {
+  if (buffer.find('/') == std::string::npos) {
+    // a document key. turn it into an id
+    buffer = vertexCollection + "/" + buffer;
+  }
+
+  size_t split;
+  char const* str = buffer.c_str();
+
+  if (! TRI_ValidateDocumentIdKeyGenerator(str, &split)) {
+    THROW_ARANGO_EXCEPTION(TRI_ERROR_ARANGO_DOCUMENT_KEY_BAD);
+  }
+
+  std::string const collectionName = buffer.substr(0, split);
+  auto coli = _trx->resolver()->getCollectionStruct(collectionName);
+
+  if (coli == nullptr || 
+      (mustBeInVertexCollection && collectionName != vertexCollection)) {
+    THROW_ARANGO_EXCEPTION(TRI_ERROR_ARANGO_COLLECTION_NOT_FOUND);
+  }
+
+  return VertexId(coli->_cid, str + split + 1);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief create the AqlValue for an id, either the id string or the document
+////////////////////////////////////////////////////////////////////////////////
+
+AqlValue GraphBlock::idToAqlValue (VertexId const& id) const {
+  auto resolver = _trx->resolver();
+
+  if (! _includeData) {
+    return AqlValue(new Json(resolver->getCollectionName(id.cid) + "/" + std::string(id.key)));
+  }
+
+  auto trxCollection = _trx->trxCollection(id.cid);
+
+  if (trxCollection == nullptr) {
+    THROW_ARANGO_EXCEPTION_MESSAGE(TRI_ERROR_TRANSACTION_UNREGISTERED_COLLECTION, resolver->getCollectionName(id.cid));
+  }
+
+  TRI_doc_mptr_copy_t mptr;
+  int res = _trx->readSingle(trxCollection, &mptr, id.key); 
+
+  if (res != TRI_ERROR_NO_ERROR) {
+    THROW_ARANGO_EXCEPTION(res);
+  }
+
+  AqlValue shaped(static_cast<TRI_df_marker_t const*>(mptr.getDataPtr()));
+
+  return AqlValue(new Json(shaped.toJson(_trx, trxCollection->_collection->_collection, true)));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief make sure the ids for the current input row are computed
+////////////////////////////////////////////////////////////////////////////////
+
+bool GraphBlock::prepareIds (size_t atMost) {
+  if (_buffer.empty()) {
+    size_t toFetch = (std::min)(DefaultBatchSize, atMost);
+    if (! ExecutionBlock::getBlock(toFetch, toFetch)) {
+      return false;
+    }
+    _pos = 0;           // this is in the first block
+  }
+
+  if (! _computed) {
+    _ids.clear();
+    _index = 0;
+    computeIds(_buffer.front(), _pos);
+    _computed = true;
+  }
+
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief move on to the next input row
+////////////////////////////////////////////////////////////////////////////////
+
+void GraphBlock::nextRow () {
+  _ids.clear();
+  _index = 0;
+  _computed = false;
+
+  // advance read position in the current block . . .
+  if (++_pos == _buffer.front()->size()) {
+    delete _buffer.front();
+    _buffer.pop_front();  // does not throw
+    _pos = 0;
+  }
+}
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                              class TraversalBlock
+// -----------------------------------------------------------------------------
+
+TraversalBlock::TraversalBlock (ExecutionEngine* engine,
+                                TraversalNode const* en)
+  : GraphBlock(engine, en, en->_includeData),
+    _inVarRegId(ExecutionNode::MaxRegisterId),
+    _start() {
+
+  auto it = en->getRegisterPlan()->varInfo.find(en->_inVariable->id);
+
+  if (it == en->getRegisterPlan()->varInfo.end()) {
+    THROW_ARANGO_EXCEPTION_MESSAGE(TRI_ERROR_INTERNAL, "variable not found");
+  }
+
+  _inVarRegId = (*it).second.registerId;
+  TRI_ASSERT(_inVarRegId < ExecutionNode::MaxRegisterId);
+
+  orderEdgeDitch(en->_edgeCollection);
+}
+
+TraversalBlock::~TraversalBlock () {
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief compute the neighbors of the start vertex in the input row
+////////////////////////////////////////////////////////////////////////////////
+
+void TraversalBlock::computeIds (AqlItemBlock const* items, 
+                                 size_t pos) {
+  auto en = static_cast<TraversalNode const*>(getPlanNode());
+
+  triagens::basics::traverser::NeighborsOptions opts;
+  opts.direction = en->_direction;
+  opts.minDepth  = en->_minDepth;
+  opts.maxDepth  = en->_maxDepth;
+  opts.start     = extractVertexId(items, pos, _inVarRegId, en->_vertexCollection, true, "NEIGHBORS", _start);
+
+  TRI_voc_cid_t eCid = lookupCollection(en->_edgeCollection);
+
+  // all edges have the same weight
+  auto wc = [](TRI_doc_mptr_copy_t&) -> double { return 1; };
+
+  std::unique_ptr<EdgeCollectionInfo> eci(new EdgeCollectionInfo(
+    eCid,
+    _trx->documentCollection(eCid),
+    wc
+  ));
+
+  if (! en->_edgeExamples.isEmpty()) {
+    opts.addEdgeFilter(en->_edgeExamples, eci->getShaper(), eCid, _trx->resolver()); 
+  }
+
+  std::vector<EdgeCollectionInfo*> edgeCollectionInfos{ eci.get() };
+  std::unordered_set<VertexId> neighbors;
+
+  TRI_RunNeighborsSearch(edgeCollectionInfos, opts, neighbors);
+
+  _ids.assign(neighbors.begin(), neighbors.end());
+}
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                           class ShortestPathBlock
+// -----------------------------------------------------------------------------
+
+ShortestPathBlock::ShortestPathBlock (ExecutionEngine* engine,
+                                      ShortestPathNode const* en)
+  : GraphBlock(engine, en, en->_includeData),
+    _startRegId(ExecutionNode::MaxRegisterId),
+    _targetRegId(ExecutionNode::MaxRegisterId),
+    _start(),
+    _target() {
+
+  auto const& varInfo = en->getRegisterPlan()->varInfo;
+  auto it = varInfo.find(en->_startVariable->id);
+
+  if (it == varInfo.end()) {
+    THROW_ARANGO_EXCEPTION_MESSAGE(TRI_ERROR_INTERNAL, "variable not found");
+  }
+
+  _startRegId = (*it).second.registerId;
+  TRI_ASSERT(_startRegId < ExecutionNode::MaxRegisterId);
+
+  it = varInfo.find(en->_targetVariable->id);
+
+  if (it == varInfo.end()) {
+    THROW_ARANGO_EXCEPTION_MESSAGE(TRI_ERROR_INTERNAL, "variable not found");
+  }
+
+  _targetRegId = (*it).second.registerId;
+  TRI_ASSERT(_targetRegId < ExecutionNode::MaxRegisterId);
+
+  orderEdgeDitch(en->_edgeCollection);
+}
+
+ShortestPathBlock::~ShortestPathBlock () {
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief compute the shortest path between the vertices in the input row
+////////////////////////////////////////////////////////////////////////////////
+
+void ShortestPathBlock::computeIds (AqlItemBlock const* items, 
+                                    size_t pos) {
+  auto en = static_cast<ShortestPathNode const*>(getPlanNode());
+
+  triagens::basics::traverser::ShortestPathOptions opts;
+  opts.direction = en->_direction;
+  opts.start     = extractVertexId(items, pos, _startRegId, en->_vertexCollection, false, "SHORTEST_PATH", _start);
+  opts.end       = extractVertexId(items, pos, _targetRegId, en->_vertexCollection, false, "SHORTEST_PATH", _target);
+
+  TRI_voc_cid_t eCid = lookupCollection(en->_edgeCollection);
+
+  // all edges have the same weight
+  auto wc = [](TRI_doc_mptr_copy_t&) -> double { return 1; };
+
+  std::unique_ptr<EdgeCollectionInfo> eci(new EdgeCollectionInfo(
+    eCid,
+    _trx->documentCollection(eCid),
+    wc
+  ));
+
+  std::vector<EdgeCollectionInfo*> edgeCollectionInfos{ eci.get() };
+
+  auto path = TRI_RunSimpleShortestPathSearch(edgeCollectionInfos, opts);
+
+  if (path.get() == nullptr) {
+    // no path. SHORTEST_PATH() returns null in this case, which cannot be 
+    // iterated over
+    THROW_ARANGO_EXCEPTION_MESSAGE(TRI_ERROR_QUERY_ARRAY_EXPECTED, 
+                                   TRI_errno_string(TRI_ERROR_QUERY_ARRAY_EXPECTED) +
+                                   std::string(" as operand to FOR loop"));
+  }
+
+  if (en->_produceEdges) {
+    _ids.assign(path->edges.begin(), path->edges.end());
+  }
+  else {
+    _ids.assign(path->vertices.begin(), path->vertices.end());
+  }
+}
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                            class CalculationBlock
+// -----------------------------------------------------------------------------
+        
+CalculationBlock::CalculationBlock (ExecutionEngine* engine,
+                                    CalculationNode const* en,
+                                    bool copyExpression)
+  : ExecutionBlock(engine, en),
+    _expression(copyExpression ? en->expression()->clone() : en->expression()),
+    _inVars(),
+    _inRegs(),
+    _outReg(ExecutionNode::MaxRegisterId),
+    _ownsExpression(copyExpression) {
+
+  if (_ownsExpression) {
+    _expression->prepareConcurrentExecution();
+  }
+
+  std::unordered_set<Variable const*> inVars;
+  _expression->variables(inVars);
+
+  _inVars.reserve(inVars.size());
+  _inRegs.reserve(inVars.size());
+
+  for (auto& it : inVars) {
+    _inVars.emplace_back(it);
+    auto it2 = en->getRegisterPlan()->varInfo.find(it->id);
+
+    TRI_ASSERT(it2 != en->getRegisterPlan()->varInfo.end());
+    TRI_ASSERT(it2->second.registerId < ExecutionNode::MaxRegisterId);
+    _inRegs.emplace_back(it2->second.registerId);
+  }
+
+  // check if the expression is "only" a reference to another variable
+  // this allows further optimizations inside doEvaluation
+  _isReference = (_expression->node()->type == NODE_TYPE_REFERENCE);
+
+  if (_isReference) {
+    TRI_ASSERT(_inRegs.size() == 1);
+  }
+
+  auto it3 = en->getRegisterPlan()->varInfo.find(en->_outVariable->id);
+  TRI_ASSERT(it3 != en->getRegisterPlan()->varInfo.end());
+  _outReg = it3->second.registerId;
+  TRI_ASSERT(_outReg < ExecutionNode::MaxRegisterId);
+  
+  if (en->_conditionVariable != nullptr) {
+    auto it = en->getRegisterPlan()->varInfo.find(en->_conditionVariable->id);
+    TRI_ASSERT(it != en->getRegisterPlan()->varInfo.end());
+    _conditionReg = it->second.registerId;
+    TRI_ASSERT(_conditionReg < ExecutionNode::MaxRegisterId);
+  }
+}
+
+CalculationBlock::~CalculationBlock () {
+  if (_ownsExpression) {
+    delete _expression;
+  }
+}
+
+int CalculationBlock::initialize () {
+  return ExecutionBlock::initialize();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief fill the target register in the item block with a reference to 
+/// another variable
+////////////////////////////////////////////////////////////////////////////////
+
+void CalculationBlock::fillBlockWithReference (AqlItemBlock* result) {
+  result->setDocumentCollection(_outReg, result->getDocumentCollection(_inRegs[0]));
+
+  size_t const n = result->size();
+  for (size_t i = 0; i < n; i++) {
+    // need not clone to avoid a copy, the AqlItemBlock's hash takes
+    // care of correct freeing:
+    auto a = result->getValueReference(i, _inRegs[0]);
+
+    try {
+      TRI_IF_FAILURE("CalculationBlock::fillBlockWithReference") {
+        THROW_ARANGO_EXCEPTION(TRI_ERROR_DEBUG);
+      }
+      result->setValue(i, _outReg, a);
+    }
+    catch (...) {
+      a.destroy();
+      throw;
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief shared code for executing a simple or a V8 expression
+////////////////////////////////////////////////////////////////////////////////
+
+void CalculationBlock::executeExpression (AqlItemBlock* result) {
+  result->setDocumentCollection(_outReg, nullptr);
+
+  bool const hasCondition = (static_cast<CalculationNode const*>(_exeNode)->_conditionVariable != nullptr);
+
+  size_t const n = result->size();
+
+  for (size_t i = 0; i < n; i++) {
+    // check the condition variable (if any)
+    if (hasCondition) {
+      AqlValue conditionResult = result->getValueReference(i, _conditionReg);
+
+      if (! conditionResult.isTrue()) {
+        TRI_IF_FAILURE("CalculationBlock::executeExpressionWithCondition") {
+          THROW_ARANGO_EXCEPTION(TRI_ERROR_DEBUG);
+        }
+        result->setValue(i, _outReg, AqlValue(new Json(TRI_UNKNOWN_MEM_ZONE, &Expression::NullJson, Json::NOFREE)));
+        continue;
+      }
+    }
+    
+    // execute the expression
+    TRI_document_collection_t const* myCollection = nullptr;
+    AqlValue a = _expression->execute(_trx, result, i, _inVars, _inRegs, &myCollection);
+    
+    try {
+      TRI_IF_FAILURE("CalculationBlock::executeExpression") {
+        THROW_ARANGO_EXCEPTION(TRI_ERROR_DEBUG);
+      }
+      result->setValue(i, _outReg, a);
+    }
+    catch (...) {
+      a.destroy();
+      throw;
+    }
+    throwIfKilled(); // check if we were aborted
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief doEvaluation, private helper to do the work
+////////////////////////////////////////////////////////////////////////////////
+
+void CalculationBlock::doEvaluation (AqlItemBlock* result) {
+  TRI_ASSERT(result != nullptr);
+
+  if (_isReference) {
+    // the calculation is a reference to a variable only.
+    // no need to execute the expression at all
+    fillBlockWithReference(result);
+    throwIfKilled(); // check if we were aborted
+    return;
+  }
+
+  // non-reference expression
+
+  TRI_ASSERT(_expression != nullptr);
+
+  if (! _expression->isV8()) {
     // an expression that does not require V8
 
     Functions::InitializeThreadContext();
@@ -2916,7 +3470,7 @@ void CalculationBlock::doEvaluation (AqlItemBlock* result) {
     }
   }
   else {
-    bool const isRunningInCluster = triagens::arango::ServerState::instance()->isRunningInCluster();
+    bool const mustExitContext = _engine->getQuery()->mustExitContext();
 
     // must have a V8 context here to protect Expression::execute()
     triagens::basics::ScopeGuard guard{
@@ -2924,7 +3478,7 @@ void CalculationBlock::doEvaluation (AqlItemBlock* result) {
         _engine->getQuery()->enterContext(); 
       },
       [&]() -> void { 
-        if (isRunningInCluster) {
+        if (mustExitContext) {
           // must invalidate the expression now as we might be called from
           // different threads
           _expression->invalidate();
@@ -3076,7 +3630,7 @@ std::vector<AqlItemBlock*>* SubqueryBlock::executeSubquery () {
 
   try {
     do {
-      std::unique_ptr<AqlItemBlock> tmp(_subquery->getSome(DefaultBatchSize, DefaultBatchSize));
+      std::unique_ptr<AqlItemBlock> tmp(_subquery->getSomeProfiled(DefaultBatchSize, DefaultBatchSize));
 
       if (tmp.get() == nullptr) {
         break;
@@ -3885,42 +4439,403 @@ int HashedAggregateBlock::getOrSkipSome (size_t atLeast,
     TRI_ASSERT(skipped > 0);
   }
 
-  result = buildResult(nullptr);
-  
-  return TRI_ERROR_NO_ERROR;
+  result = buildResult(nullptr);
+  
+  return TRI_ERROR_NO_ERROR;
+}
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                               class HashJoinBlock
+// -----------------------------------------------------------------------------
+
+HashJoinBlock::HashJoinBlock (ExecutionEngine* engine,
+                              HashJoinNode const* en)
+  : ExecutionBlock(engine, en),
+    _collection(en->_collection),
+    _probeRegisters(),
+    _accessors(),
+    _keyCollections(),
+    _hashTable(nullptr),
+    _matches(nullptr),
+    _index(0),
+    _computed(false),
+    _prefetched(false),
+    _mustStoreResult(true) {
+
+  auto trxCollection = _trx->trxCollection(_collection->cid());
+  if (trxCollection != nullptr) {
+    _trx->orderDitch(trxCollection);
+  }
+
+  auto const& varInfo = en->getRegisterPlan()->varInfo;
+
+  for (auto const& it : en->_probeVariables) {
+    auto it2 = varInfo.find(it->id);
+
+    if (it2 == varInfo.end()) {
+      THROW_ARANGO_EXCEPTION_MESSAGE(TRI_ERROR_INTERNAL, "variable not found");
+    }
+
+    TRI_ASSERT(it2->second.registerId < ExecutionNode::MaxRegisterId);
+    _probeRegisters.emplace_back(it2->second.registerId);
+  }
+
+  try {
+    for (auto const& it : en->_buildAttributes) {
+      std::vector<char const*> parts;
+      for (auto const& part : it) {
+        parts.emplace_back(part.c_str());
+      }
+
+      _accessors.emplace_back(new AttributeAccessor(parts, en->_outVariable));
+      _keyCollections.emplace_back(nullptr);
+    }
+  }
+  catch (...) {
+    for (auto& it : _accessors) {
+      delete it;
+    }
+    throw;
+  }
+}
+
+HashJoinBlock::~HashJoinBlock () {
+  freeHashTable();
+
+  for (auto& it : _accessors) {
+    delete it;
+  }
+}
+
+int HashJoinBlock::initialize () {
+  auto ep = static_cast<HashJoinNode const*>(_exeNode);
+  _mustStoreResult = ep->isVarUsedLater(ep->_outVariable);
+
+  return ExecutionBlock::initialize();
+}
+
+int HashJoinBlock::initializeCursor (AqlItemBlock* items, 
+                                     size_t pos) {
+  int res = ExecutionBlock::initializeCursor(items, pos);
+
+  if (res != TRI_ERROR_NO_ERROR) {
+    return res;
+  }
+
+  // the hash table is rebuilt on first use, so a re-initialized subquery
+  // or inner loop sees the current state of the collection
+  freeHashTable();
+  _matches = nullptr;
+  _index = 0;
+  _computed = false;
+
+  return TRI_ERROR_NO_ERROR;
+}
+
+AqlItemBlock* HashJoinBlock::getSome (size_t, // atLeast,
+                                      size_t atMost) {
+  if (_done) {
+    return nullptr;
+  }
+
+  std::unique_ptr<AqlItemBlock> res;
+
+  do {
+    // repeatedly try to get more stuff from upstream
+    // note that an input row may have no matches, in which case we have to
+    // try again!
+    if (! prepareMatches(atMost)) {
+      _done = true;
+      return nullptr;
+    }
+
+    // if we make it here, then _buffer.front() exists
+    AqlItemBlock* cur = _buffer.front();
+    size_t const n = (_matches == nullptr ? 0 : _matches->size());
+
+    if (_index < n) {
+      size_t const toSend = (std::min)(atMost, n - _index);
+      size_t const curRegs = cur->getNrRegs();
+      RegisterId nrRegs = getPlanNode()->getRegisterPlan()->nrRegs[getPlanNode()->getDepth()];
+
+      res.reset(requestBlock(toSend, nrRegs));
+      TRI_ASSERT(curRegs <= res->getNrRegs());
+
+      inheritRegisters(cur, res.get(), _pos);
+
+      // set our collection for our output register
+      res->setDocumentCollection(static_cast<triagens::aql::RegisterId>(curRegs), _trx->documentCollection(_collection->cid()));
+
+      for (size_t j = 0; j < toSend; j++) {
+        if (j > 0) {
+          // re-use already copied aqlvalues
+          for (RegisterId i = 0; i < curRegs; i++) {
+            res->setValue(j, i, res->getValueReference(0, i));
+            // Note: if this throws, then all values will be deleted
+            // properly since the first one is.
+          }
+        }
+
+        if (_mustStoreResult) {
+          res->setShaped(j, 
+                         static_cast<triagens::aql::RegisterId>(curRegs),
+                         (*_matches)[_index]);
+        }
+
+        ++_index;
+      }
+    }
+
+    if (_index >= n) {
+      nextRow();
+    }
+  }
+  while (res.get() == nullptr);
+
+  // Clear out registers no longer needed later:
+  clearRegisters(res.get());
+
+  return res.release();
+}
+
+size_t HashJoinBlock::skipSome (size_t atLeast, size_t atMost) {
+  if (_done) {
+    return 0;
+  }
+
+  size_t skipped = 0;
+
+  while (skipped < atLeast) {
+    if (! prepareMatches(atMost)) {
+      _done = true;
+      return skipped;
+    }
+
+    size_t const n = (_matches == nullptr ? 0 : _matches->size());
+    size_t const available = n - _index;
+
+    if (atMost - skipped < available) {
+      _index += atMost - skipped;
+      skipped = atMost;
+    }
+    else {
+      skipped += available;
+      nextRow();
+    }
+  }
+
+  return skipped;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief scan the collection and build the hash table from its documents
+////////////////////////////////////////////////////////////////////////////////
+
+void HashJoinBlock::buildHashTable () {
+  TRI_ASSERT(_hashTable == nullptr);
+
+  auto ep = static_cast<HashJoinNode const*>(_exeNode);
+  auto trxCollection = _trx->trxCollection(_collection->cid());
+  auto document = _trx->documentCollection(_collection->cid());
+
+  if (! _prefetched) {
+    // the complete collection is read, so let the kernel read the datafiles
+    // in the background. the table is rebuilt for every cursor, but the
+    // datafiles only need to be prefetched once
+    _prefetched = true;
+    TRI_PrefetchDocumentCollection(_collection->documentCollection());
+  }
+
+  _hashTable = new HashTable(1024, GroupKeyHash(_trx, _keyCollections), GroupKeyEqual(_trx, _keyCollections));
+
+  LinearCollectionScanner scanner(_trx, trxCollection);
+  std::vector<Variable const*> const vars{ ep->_outVariable };
+  std::vector<RegisterId> const regs{ 0 };
+  std::vector<TRI_doc_mptr_copy_t> documents;
+  size_t const n = _accessors.size();
+
+  while (true) {
+    throwIfKilled(); // check if we were aborted
+
+    TRI_IF_FAILURE("HashJoinBlock::buildHashTable") {
+      THROW_ARANGO_EXCEPTION(TRI_ERROR_DEBUG);
+    }
+
+    documents.clear();
+    documents.reserve(DefaultBatchSize);
+
+    int res = scanner.scan(documents, DefaultBatchSize);
+
+    if (res != TRI_ERROR_NO_ERROR) {
+      THROW_ARANGO_EXCEPTION(res);
+    }
+
+    if (documents.empty()) {
+      break;
+    }
+
+    _engine->_stats.scannedFull += static_cast<int64_t>(documents.size());
+
+    // the attribute accessors read the documents from an item block
+    std::unique_ptr<AqlItemBlock> items(requestBlock(documents.size(), 1));
+    items->setDocumentCollection(0, document);
+
+    for (size_t i = 0; i < documents.size(); ++i) {
+      items->setShaped(i, 0, reinterpret_cast<TRI_df_marker_t const*>(documents[i].getDataPtr()));
+    }
+
+    for (size_t i = 0; i < documents.size(); ++i) {
+      std::vector<AqlValue> key;
+      key.reserve(n);
+
+      try {
+        for (auto& accessor : _accessors) {
+          key.emplace_back(accessor->get(_trx, items.get(), i, vars, regs));
+        }
+
+        auto marker = reinterpret_cast<TRI_df_marker_t const*>(documents[i].getDataPtr());
+        auto it = _hashTable->find(key);
+
+        if (it == _hashTable->end()) {
+          _hashTable->emplace(key, std::vector<TRI_df_marker_t const*>{ marker });
+        }
+        else {
+          // duplicate key value. the key is already stored
+          (*it).second.emplace_back(marker);
+
+          for (auto& value : key) {
+            value.destroy();
+          }
+        }
+      }
+      catch (...) {
+        for (auto& value : key) {
+          value.destroy();
+        }
+        throw;
+      }
+    }
+
+    AqlItemBlock* block = items.release();
+    returnBlock(block);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief free the hash table and the key values stored in it
+////////////////////////////////////////////////////////////////////////////////
+
+void HashJoinBlock::freeHashTable () {
+  if (_hashTable == nullptr) {
+    return;
+  }
+
+  for (auto& it : *_hashTable) {
+    for (auto& value : it.first) {
+      const_cast<AqlValue*>(&value)->destroy();
+    }
+  }
+
+  delete _hashTable;
+  _hashTable = nullptr;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief look up the documents matching the key values of an input row
+////////////////////////////////////////////////////////////////////////////////
+
+std::vector<TRI_df_marker_t const*> const* HashJoinBlock::lookup (AqlItemBlock const* items,
+                                                                  size_t pos) {
+  size_t const n = _probeRegisters.size();
+  std::vector<AqlValue> key;
+  key.reserve(n);
+
+  // shaped values must be turned into JSON, as the hasher and the comparator 
+  // expect all key values to be of the same kind. all other values are used 
+  // without copying them
+  std::vector<bool> mustDestroy(n, false);
+
+  auto cleanup = [&] () -> void {
+    for (size_t i = 0; i < key.size(); ++i) {
+      if (mustDestroy[i]) {
+        key[i].destroy();
+      }
+    }
+  };
+
+  try {
+    for (size_t i = 0; i < n; ++i) {
+      RegisterId const reg = _probeRegisters[i];
+      AqlValue const& value = items->getValueReference(pos, reg);
+
+      if (value.isShaped()) {
+        key.emplace_back(AqlValue(new Json(value.toJson(_trx, items->getDocumentCollection(reg), true))));
+        mustDestroy[i] = true;
+      }
+      else {
+        key.emplace_back(value);
+      }
+    }
+
+    auto it = _hashTable->find(key);
+    cleanup();
+
+    if (it == _hashTable->end()) {
+      return nullptr;
+    }
+
+    return &((*it).second);
+  }
+  catch (...) {
+    cleanup();
+    throw;
+  }
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-/// @brief hasher for groups
+/// @brief make sure the matches for the current input row are looked up
 ////////////////////////////////////////////////////////////////////////////////
 
-size_t HashedAggregateBlock::GroupKeyHash::operator() (std::vector<AqlValue> const& value) const {
-  uint64_t hash = 0x12345678;
+bool HashJoinBlock::prepareMatches (size_t atMost) {
+  if (_buffer.empty()) {
+    size_t toFetch = (std::min)(DefaultBatchSize, atMost);
+    if (! ExecutionBlock::getBlock(toFetch, toFetch)) {
+      return false;
+    }
+    _pos = 0;           // this is in the first block
+  }
 
-  for (size_t i = 0; i < _num; ++i) {
-    hash ^= value[i].hash(_trx, _colls[i]);
+  if (_hashTable == nullptr) {
+    // build the hash table only when there is input, so queries that never
+    // produce rows for this join do not read the collection at all
+    buildHashTable();
   }
 
-  return static_cast<size_t>(hash);
+  if (! _computed) {
+    _matches = lookup(_buffer.front(), _pos);
+    _index = 0;
+    _computed = true;
+  }
+
+  return true;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-/// @brief comparator for groups
+/// @brief move on to the next input row
 ////////////////////////////////////////////////////////////////////////////////
-    
-bool HashedAggregateBlock::GroupKeyEqual::operator() (std::vector<AqlValue> const& lhs,
-                                                      std::vector<AqlValue> const& rhs) const {
-  size_t const n = lhs.size();
 
-  for (size_t i = 0; i < n; ++i) {
-    int res = AqlValue::Compare(_trx, lhs[i], _colls[i], rhs[i], _colls[i], false);
+void HashJoinBlock::nextRow () {
+  _matches = nullptr;
+  _index = 0;
+  _computed = false;
 
-    if (res != 0) {
-      return false;
-    }
+  // advance read position in the current block . . .
+  if (++_pos == _buffer.front()->size()) {
+    AqlItemBlock* cur = _buffer.front();
+    _buffer.pop_front();  // does not throw
+    returnBlock(cur);
+    _pos = 0;
   }
-
-  return true;
 }
 
 // -----------------------------------------------------------------------------
@@ -3931,7 +4846,14 @@ SortBlock::SortBlock (ExecutionEngine* engine,
                       SortNode const* en)
   : ExecutionBlock(engine, en),
     _sortRegisters(),
-    _stable(en->_stable) {
+    _stable(en->_stable),
+    _limit(en->_limit),
+    _memoryLimit(engine->getQuery()->sortMemoryLimit()),
+    _runs(),
+    _runBlocks(),
+    _runPositions(),
+    _mergeHeap(),
+    _mergeRemaining(0) {
   
   for (auto const& p : en->_elements) {
     auto it = en->getRegisterPlan()->varInfo.find(p.first->id);
@@ -3942,6 +4864,7 @@ SortBlock::SortBlock (ExecutionEngine* engine,
 }
 
 SortBlock::~SortBlock () {
+  clearRuns();
 }
 
 int SortBlock::initialize () {
@@ -3949,20 +4872,55 @@ int SortBlock::initialize () {
 }
 
 int SortBlock::initializeCursor (AqlItemBlock* items, size_t pos) {
+  clearRuns();
+
   int res = ExecutionBlock::initializeCursor(items, pos);
   if (res != TRI_ERROR_NO_ERROR) {
     return res;
   }
-  // suck all blocks into _buffer
-  while (getBlock(DefaultBatchSize, DefaultBatchSize)) {
-  }
+  if (_limit > 0) {
+    // only the first _limit rows are needed
+    doTopKSorting();
 
-  if (_buffer.empty()) {
-    _done = true;
-    return TRI_ERROR_NO_ERROR;
+    if (_buffer.empty()) {
+      _done = true;
+      return TRI_ERROR_NO_ERROR;
+    }
   }
+  else {
+    // suck all blocks into _buffer
+    size_t memoryUsage = 0;
 
-  doSorting();
+    while (getBlock(DefaultBatchSize, DefaultBatchSize)) {
+      if (_memoryLimit > 0) {
+        memoryUsage += _buffer.back()->memoryUsage();
+
+        if (memoryUsage > _memoryLimit) {
+          // buffered rows exceed the budget. sort them and move them to disk
+          spillRun();
+          memoryUsage = 0;
+        }
+      }
+    }
+
+    if (! _runs.empty()) {
+      if (! _buffer.empty()) {
+        spillRun();
+      }
+
+      // the sorted rows will be merged from the runs on demand
+      startMerge();
+      fillBuffer(DefaultBatchSize);
+    }
+    else if (! _buffer.empty()) {
+      doSorting();
+    }
+
+    if (_buffer.empty()) {
+      _done = true;
+      return TRI_ERROR_NO_ERROR;
+    }
+  }
 
   _done = false;
   _pos = 0;
@@ -3970,6 +4928,41 @@ int SortBlock::initializeCursor (AqlItemBlock* items, size_t pos) {
   return TRI_ERROR_NO_ERROR;
 }
 
+int SortBlock::shutdown (int errorCode) {
+  clearRuns();
+
+  return ExecutionBlock::shutdown(errorCode);
+}
+
+bool SortBlock::hasMore () {
+  if (! _done && _buffer.empty() && _mergeRemaining > 0) {
+    fillBuffer(DefaultBatchSize);
+    _pos = 0;
+  }
+
+  return ExecutionBlock::hasMore();
+}
+
+int64_t SortBlock::remaining () {
+  return ExecutionBlock::remaining() + static_cast<int64_t>(_mergeRemaining);
+}
+
+int SortBlock::getOrSkipSome (size_t atLeast,
+                              size_t atMost,
+                              bool skipping,
+                              AqlItemBlock*& result,
+                              size_t& skipped) {
+  if (! _done && _mergeRemaining > 0) {
+    if (_buffer.empty()) {
+      _pos = 0;
+    }
+    // make sure the base class never needs to ask our dependency for more
+    fillBuffer(atMost + _pos);
+  }
+
+  return ExecutionBlock::getOrSkipSome(atLeast, atMost, skipping, result, skipped);
+}
+
 void SortBlock::doSorting () {
   // coords[i][j] is the <j>th row of the <i>th block
   std::vector<std::pair<size_t, size_t>> coords;
@@ -4129,30 +5122,368 @@ void SortBlock::doSorting () {
     for (auto& x : newbuffer) {
       delete x;
     }
-    throw;
-  }
-  _buffer.swap(newbuffer);  // does not throw since allocators
-  // are the same
-  for (auto& x : newbuffer) {
-    delete x;
+    throw;
+  }
+  _buffer.swap(newbuffer);  // does not throw since allocators
+  // are the same
+  for (auto& x : newbuffer) {
+    delete x;
+  }
+}
+
+void SortBlock::doTopKSorting () {
+  TRI_ASSERT(_limit > 0);
+  TRI_ASSERT(_buffer.empty());
+
+  // the rows kept so far, each row owns the values of all its registers
+  std::vector<std::vector<AqlValue>> rows;
+  // arrival sequence of each kept row
+  std::vector<size_t> sequences;
+  // heap of positions in rows, its top is the kept row that sorts last
+  std::vector<size_t> heap;
+
+  std::vector<TRI_document_collection_t const*> colls;
+  std::vector<TRI_document_collection_t const*> docColls;
+  RegisterId nrRegs = 0;
+  size_t sequence = 0;
+
+  TopKLessThan ourLessThan(_trx, rows, sequences, _sortRegisters, colls);
+
+  try {
+    while (getBlock(DefaultBatchSize, DefaultBatchSize)) {
+      AqlItemBlock* block = _buffer.back();
+
+      if (docColls.empty()) {
+        nrRegs = block->getNrRegs();
+        docColls = block->getDocumentCollections();
+        for (auto const& reg : _sortRegisters) {
+          colls.emplace_back(block->getDocumentCollection(reg.first));
+        }
+      }
+
+      size_t const n = block->size();
+
+      for (size_t i = 0; i < n; ++i, ++sequence) {
+        if (heap.size() < _limit) {
+          // heap not yet full, simply add the row
+          size_t const slot = rows.size();
+          rows.emplace_back(std::vector<AqlValue>());
+          sequences.emplace_back(sequence);
+
+          moveRow(block, i, rows.back());
+          heap.emplace_back(slot);
+          std::push_heap(heap.begin(), heap.end(), ourLessThan);
+          continue;
+        }
+
+        if (! ourLessThan(block, i, heap.front())) {
+          // row will not make it into the result
+          continue;
+        }
+
+        // replace the kept row that sorts last
+        std::pop_heap(heap.begin(), heap.end(), ourLessThan);
+        size_t const slot = heap.back();
+
+        for (auto& value : rows[slot]) {
+          value.destroy();
+        }
+        sequences[slot] = sequence;
+        moveRow(block, i, rows[slot]);
+        std::push_heap(heap.begin(), heap.end(), ourLessThan);
+      }
+
+      // the input block is not needed anymore
+      TRI_ASSERT(_buffer.back() == block);
+      _buffer.pop_back();
+      returnBlock(block);
+    }
+
+    // bring the kept rows into their final order
+    std::sort(heap.begin(), heap.end(), ourLessThan);
+
+    size_t const sum = heap.size();
+    size_t count = 0;
+
+    while (count < sum) {
+      size_t sizeNext = (std::min)(sum - count, DefaultBatchSize);
+      AqlItemBlock* next = requestBlock(sizeNext, nrRegs);
+
+      try {
+        _buffer.emplace_back(next);
+      }
+      catch (...) {
+        delete next;
+        throw;
+      }
+
+      for (size_t i = 0; i < sizeNext; ++i) {
+        auto& row = rows[heap[count]];
+
+        for (RegisterId j = 0; j < nrRegs; ++j) {
+          if (! row[j].isEmpty()) {
+            next->setValue(i, j, row[j]);
+            // responsibility is now with the new block
+            row[j].erase();
+          }
+        }
+        ++count;
+      }
+
+      for (RegisterId j = 0; j < nrRegs; ++j) {
+        next->setDocumentCollection(j, docColls[j]);
+      }
+    }
+  }
+  catch (...) {
+    for (auto& row : rows) {
+      for (auto& value : row) {
+        value.destroy();
+      }
+    }
+    throw;
+  }
+}
+
+void SortBlock::moveRow (AqlItemBlock* block,
+                         size_t row,
+                         std::vector<AqlValue>& target) {
+  RegisterId const nrRegs = block->getNrRegs();
+  target.resize(nrRegs);
+
+  for (RegisterId j = 0; j < nrRegs; ++j) {
+    target[j] = takeValue(block, row, j);
+  }
+}
+
+AqlValue SortBlock::takeValue (AqlItemBlock* block,
+                               size_t row,
+                               RegisterId reg) {
+  AqlValue a = block->getValue(row, reg);
+
+  if (a.isEmpty()) {
+    return a;
+  }
+
+  if (a.requiresDestruction() && block->valueCount(a) == 1) {
+    // we are the only user of the value, so we can steal it
+    block->steal(a);
+    block->eraseValue(row, reg);
+    return a;
+  }
+
+  return a.clone();
+}
+
+void SortBlock::spillRun () {
+  TRI_ASSERT(! _buffer.empty());
+
+  doSorting();
+
+  std::unique_ptr<SortRun> run(new SortRun());
+
+  for (auto const& block : _buffer) {
+    run->append(block, _trx);
+  }
+
+  _runs.emplace_back(run.get());
+  run.release();
+
+  for (auto& block : _buffer) {
+    returnBlock(block);
+  }
+  _buffer.clear();
+}
+
+void SortBlock::startMerge () {
+  TRI_ASSERT(_buffer.empty());
+  TRI_ASSERT(_runBlocks.empty());
+
+  size_t const n = _runs.size();
+  _runBlocks.reserve(n);
+  _runPositions.reserve(n);
+  _mergeHeap.reserve(n);
+  _mergeRemaining = 0;
+
+  for (size_t i = 0; i < n; ++i) {
+    _runs[i]->rewind();
+    _runBlocks.emplace_back(_runs[i]->next());
+    _runPositions.emplace_back(0);
+    _mergeRemaining += _runs[i]->size();
+
+    if (_runBlocks.back() != nullptr) {
+      _mergeHeap.emplace_back(i);
+    }
+  }
+
+  MergeGreaterThan ourGreaterThan(_trx, _runBlocks, _runPositions, _sortRegisters);
+  std::make_heap(_mergeHeap.begin(), _mergeHeap.end(), ourGreaterThan);
+}
+
+void SortBlock::mergeBlock () {
+  TRI_ASSERT(_mergeRemaining > 0);
+  TRI_ASSERT(! _mergeHeap.empty());
+
+  size_t const sizeNext = (std::min)(_mergeRemaining, DefaultBatchSize);
+  RegisterId const nrRegs = _runBlocks[_mergeHeap.front()]->getNrRegs();
+
+  std::unique_ptr<AqlItemBlock> next(requestBlock(sizeNext, nrRegs));
+  MergeGreaterThan ourGreaterThan(_trx, _runBlocks, _runPositions, _sortRegisters);
+
+  for (size_t i = 0; i < sizeNext; ++i) {
+    TRI_ASSERT(! _mergeHeap.empty());
+
+    // take the smallest row of all runs
+    std::pop_heap(_mergeHeap.begin(), _mergeHeap.end(), ourGreaterThan);
+    size_t const run = _mergeHeap.back();
+    _mergeHeap.pop_back();
+
+    AqlItemBlock* cur = _runBlocks[run];
+    size_t const pos = _runPositions[run];
+
+    for (RegisterId j = 0; j < nrRegs; ++j) {
+      AqlValue a = takeValue(cur, pos, j);
+
+      if (a.isEmpty()) {
+        continue;
+      }
+
+      try {
+        next->setValue(i, j, a);
+      }
+      catch (...) {
+        a.destroy();
+        throw;
+      }
+    }
+
+    if (++_runPositions[run] >= cur->size()) {
+      // current block of the run is used up, read the next one
+      delete cur;
+      _runBlocks[run] = nullptr;
+      _runBlocks[run] = _runs[run]->next();
+      _runPositions[run] = 0;
+    }
+
+    if (_runBlocks[run] != nullptr) {
+      _mergeHeap.emplace_back(run);
+      std::push_heap(_mergeHeap.begin(), _mergeHeap.end(), ourGreaterThan);
+    }
+  }
+
+  // values read back from a run are plain JSON and belong to no collection
+  for (RegisterId j = 0; j < nrRegs; ++j) {
+    next->setDocumentCollection(j, nullptr);
+  }
+
+  _buffer.emplace_back(next.get());
+  next.release();
+  _mergeRemaining -= sizeNext;
+}
+
+void SortBlock::fillBuffer (size_t atMost) {
+  size_t sum = 0;
+  for (auto const& block : _buffer) {
+    sum += block->size();
+  }
+
+  while (sum < atMost && _mergeRemaining > 0) {
+    mergeBlock();
+    sum += _buffer.back()->size();
+  }
+}
+
+void SortBlock::clearRuns () {
+  for (auto& block : _runBlocks) {
+    delete block;
+  }
+  _runBlocks.clear();
+  _runPositions.clear();
+  _mergeHeap.clear();
+  _mergeRemaining = 0;
+
+  for (auto& run : _runs) {
+    delete run;
+  }
+  _runs.clear();
+}
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                      class SortBlock::OurLessThan
+// -----------------------------------------------------------------------------
+
+bool SortBlock::OurLessThan::operator() (std::pair<size_t, size_t> const& a,
+                                         std::pair<size_t, size_t> const& b) {
+
+  size_t i = 0;
+  for (auto const& reg : _sortRegisters) {
+
+    int cmp = AqlValue::Compare(
+      _trx,
+      _buffer[a.first]->getValueReference(a.second, reg.first),
+      _colls[i],
+      _buffer[b.first]->getValueReference(b.second, reg.first),
+      _colls[i],
+      true
+    );
+    
+    if (cmp < 0) {
+      return reg.second;
+    } 
+    else if (cmp > 0) {
+      return ! reg.second;
+    }
+    i++;
+  }
+
+  return false;
+}
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                     class SortBlock::TopKLessThan
+// -----------------------------------------------------------------------------
+
+bool SortBlock::TopKLessThan::operator() (size_t a,
+                                          size_t b) const {
+  auto const& lhs = _rows[a];
+  auto const& rhs = _rows[b];
+
+  size_t i = 0;
+  for (auto const& reg : _sortRegisters) {
+    int cmp = AqlValue::Compare(
+      _trx,
+      lhs[reg.first],
+      _colls[i],
+      rhs[reg.first],
+      _colls[i],
+      true
+    );
+    
+    if (cmp < 0) {
+      return reg.second;
+    } 
+    else if (cmp > 0) {
+      return ! reg.second;
+    }
+    i++;
   }
-}
 
-// -----------------------------------------------------------------------------
-// --SECTION--                                      class SortBlock::OurLessThan
-// -----------------------------------------------------------------------------
+  // equal rows are kept in arrival order
+  return _sequences[a] < _sequences[b];
+}
 
-bool SortBlock::OurLessThan::operator() (std::pair<size_t, size_t> const& a,
-                                         std::pair<size_t, size_t> const& b) {
+bool SortBlock::TopKLessThan::operator() (AqlItemBlock const* block,
+                                          size_t row,
+                                          size_t b) const {
+  auto const& rhs = _rows[b];
 
   size_t i = 0;
   for (auto const& reg : _sortRegisters) {
-
     int cmp = AqlValue::Compare(
       _trx,
-      _buffer[a.first]->getValueReference(a.second, reg.first),
+      block->getValueReference(row, reg.first),
       _colls[i],
-      _buffer[b.first]->getValueReference(b.second, reg.first),
+      rhs[reg.first],
       _colls[i],
       true
     );
@@ -4169,6 +5500,36 @@ bool SortBlock::OurLessThan::operator() (std::pair<size_t, size_t> const& a,
   return false;
 }
 
+// -----------------------------------------------------------------------------
+// --SECTION--                                 class SortBlock::MergeGreaterThan
+// -----------------------------------------------------------------------------
+
+bool SortBlock::MergeGreaterThan::operator() (size_t a,
+                                              size_t b) const {
+  for (auto const& reg : _sortRegisters) {
+    // rows read back from a run do not contain any shaped values, so they
+    // can be compared without their collections
+    int cmp = AqlValue::Compare(
+      _trx,
+      _blocks[a]->getValueReference(_positions[a], reg.first),
+      nullptr,
+      _blocks[b]->getValueReference(_positions[b], reg.first),
+      nullptr,
+      true
+    );
+    
+    if (cmp < 0) {
+      return ! reg.second;
+    } 
+    else if (cmp > 0) {
+      return reg.second;
+    }
+  }
+
+  // equal rows are taken from the earlier run first
+  return a > b;
+}
+
 // -----------------------------------------------------------------------------
 // --SECTION--                                                  class LimitBlock
 // -----------------------------------------------------------------------------
@@ -4510,10 +5871,8 @@ int ModificationBlock::extractKey (AqlValue const& value,
 void ModificationBlock::constructMptr (TRI_doc_mptr_copy_t* dst,
                                        TRI_df_marker_t const* marker) const { 
   dst->_rid = TRI_EXTRACT_MARKER_RID(marker);
-  dst->_fid = 0;
+  dst->_fidIndex = 0;
   dst->_hash = 0;
-  dst->_prev = nullptr;
-  dst->_next = nullptr;
   dst->setDataPtr(marker);
 }
 
@@ -5641,10 +7000,10 @@ AqlItemBlock* GatherBlock::getSome (size_t atLeast, size_t atMost) {
 
   // the simple case . . .  
   if (_isSimple) {
-    auto res = _dependencies.at(_atDep)->getSome(atLeast, atMost);
+    auto res = _dependencies.at(_atDep)->getSomeProfiled(atLeast, atMost);
     while (res == nullptr && _atDep < _dependencies.size() - 1) {
       _atDep++;
-      res = _dependencies.at(_atDep)->getSome(atLeast, atMost);
+      res = _dependencies.at(_atDep)->getSomeProfiled(atLeast, atMost);
     }
     if (res == nullptr) {
       _done = true;
@@ -5763,10 +7122,10 @@ size_t GatherBlock::skipSome (size_t atLeast, size_t atMost) {
 
   // the simple case . . .  
   if (_isSimple) {
-    auto skipped = _dependencies.at(_atDep)->skipSome(atLeast, atMost);
+    auto skipped = _dependencies.at(_atDep)->skipSomeProfiled(atLeast, atMost);
     while (skipped == 0 && _atDep < _dependencies.size() - 1) {
       _atDep++;
-      skipped = _dependencies.at(_atDep)->skipSome(atLeast, atMost);
+      skipped = _dependencies.at(_atDep)->skipSomeProfiled(atLeast, atMost);
     }
     if (skipped == 0) {
       _done = true;
@@ -5846,7 +7205,7 @@ bool GatherBlock::getBlock (size_t i, size_t atLeast, size_t atMost) {
   ENTER_BLOCK
   TRI_ASSERT(i < _dependencies.size());
   TRI_ASSERT(! _isSimple);
-  AqlItemBlock* docs = _dependencies.at(i)->getSome(atLeast, atMost);
+  AqlItemBlock* docs = _dependencies.at(i)->getSomeProfiled(atLeast, atMost);
   if (docs != nullptr) {
     try {
       _gatherBlockBuffer.at(i).emplace_back(docs);
@@ -5899,6 +7258,420 @@ bool GatherBlock::OurLessThan::operator() (std::pair<size_t, size_t> const& a,
   return false;
 }
 
+// -----------------------------------------------------------------------------
+// --SECTION--                                         class ParallelGatherBlock
+// -----------------------------------------------------------------------------
+
+ParallelGatherBlock::ParallelGatherBlock (ExecutionEngine* engine,
+                                          GatherNode const* en)
+  : ExecutionBlock(engine, en),
+    _collection(en->collection()),
+    _workers(),
+    _pool(),
+    _condition(),
+    _results(),
+    _running(0),
+    _stopping(false),
+    _errorCode(TRI_ERROR_NO_ERROR),
+    _errorMessage(),
+    _started(false),
+    _current(nullptr),
+    _posInCurrent(0) {
+
+  TRI_ASSERT(en->parallelism() > 1);
+
+  // the nodes executed by the workers, from the singleton up to the node
+  // below the gather
+  std::vector<ExecutionNode const*> nodes;
+  ExecutionNode const* node = en;
+
+  do {
+    node = node->getFirstDependency();
+    TRI_ASSERT(node != nullptr);
+    nodes.emplace_back(node);
+  }
+  while (node->getType() != ExecutionNode::SINGLETON);
+
+  std::reverse(nodes.begin(), nodes.end());
+
+  size_t const n = en->parallelism();
+  _workers.reserve(n);
+
+  try {
+    for (size_t i = 0; i < n; ++i) {
+      _workers.emplace_back(new ExecutionEngine(engine->getQuery()));
+      auto worker = _workers.back();
+      ExecutionBlock* previous = nullptr;
+
+      for (auto const& it : nodes) {
+        std::unique_ptr<ExecutionBlock> block;
+
+        switch (it->getType()) {
+          case ExecutionNode::SINGLETON: {
+            block.reset(new SingletonBlock(worker, static_cast<SingletonNode const*>(it)));
+            break;
+          }
+          case ExecutionNode::ENUMERATE_COLLECTION: {
+            // only the first worker prefetches the collection's datafiles
+            auto scan = new EnumerateCollectionBlock(worker, static_cast<EnumerateCollectionNode const*>(it), i == 0);
+            block.reset(scan);
+            scan->setPartition(i, n);
+            break;
+          }
+          case ExecutionNode::CALCULATION: {
+            // each worker needs its own copy of the expression
+            block.reset(new CalculationBlock(worker, static_cast<CalculationNode const*>(it), true));
+            break;
+          }
+          case ExecutionNode::FILTER: {
+            block.reset(new FilterBlock(worker, static_cast<FilterNode const*>(it)));
+            break;
+          }
+          default: {
+            THROW_ARANGO_EXCEPTION_MESSAGE(TRI_ERROR_INTERNAL, "unexpected node type in parallel collection scan");
+          }
+        }
+
+        worker->addBlock(block.get());
+        auto current = block.release();
+
+        if (previous != nullptr) {
+          current->addDependency(previous);
+        }
+        previous = current;
+      }
+
+      worker->root(previous);
+    }
+  }
+  catch (...) {
+    for (auto& it : _workers) {
+      delete it;
+    }
+    throw;
+  }
+}
+
+ParallelGatherBlock::~ParallelGatherBlock () {
+  stopWorkers();
+
+  // join the threads before the workers go away
+  _pool.reset();
+
+  delete _current;
+
+  for (auto& it : _workers) {
+    delete it;
+  }
+}
+
+int ParallelGatherBlock::initialize () {
+  int res = ExecutionBlock::initialize();
+
+  if (res != TRI_ERROR_NO_ERROR) {
+    return res;
+  }
+
+  for (auto& it : _workers) {
+    res = it->root()->initialize();
+
+    if (res != TRI_ERROR_NO_ERROR) {
+      return res;
+    }
+  }
+
+  return TRI_ERROR_NO_ERROR;
+}
+
+int ParallelGatherBlock::shutdown (int errorCode) {
+  stopWorkers();
+
+  delete _current;
+  _current = nullptr;
+
+  int ret = ExecutionBlock::shutdown(errorCode);
+
+  for (auto& it : _workers) {
+    int res = it->shutdown(errorCode);
+
+    if (res != TRI_ERROR_NO_ERROR) {
+      ret = res;
+    }
+  }
+
+  return ret;
+}
+
+int ParallelGatherBlock::initializeCursor (AqlItemBlock* items, 
+                                           size_t pos) {
+  stopWorkers();
+
+  delete _current;
+  _current = nullptr;
+  _posInCurrent = 0;
+  _started = false;
+
+  return ExecutionBlock::initializeCursor(items, pos);
+}
+
+bool ParallelGatherBlock::hasMore () {
+  if (_done) {
+    return false;
+  }
+
+  if (_current == nullptr) {
+    return fetchResult();
+  }
+
+  return true;
+}
+
+AqlItemBlock* ParallelGatherBlock::getSome (size_t, // atLeast 
+                                            size_t atMost) {
+  if (_done) {
+    return nullptr;
+  }
+
+  if (_current == nullptr && ! fetchResult()) {
+    return nullptr;
+  }
+
+  size_t const available = _current->size() - _posInCurrent;
+
+  if (_posInCurrent == 0 && available <= atMost) {
+    // return the block of the worker as is
+    AqlItemBlock* result = _current;
+    _current = nullptr;
+    return result;
+  }
+
+  size_t const toSend = (std::min)(available, atMost);
+  AqlItemBlock* result = _current->slice(_posInCurrent, _posInCurrent + toSend);
+  _posInCurrent += toSend;
+
+  if (_posInCurrent >= _current->size()) {
+    AqlItemBlock* cur = _current;
+    _current = nullptr;
+    returnBlock(cur);
+  }
+
+  return result;
+}
+
+size_t ParallelGatherBlock::skipSome (size_t atLeast, 
+                                      size_t atMost) {
+  size_t skipped = 0;
+
+  while (skipped < atLeast && ! _done) {
+    if (_current == nullptr && ! fetchResult()) {
+      break;
+    }
+
+    size_t const toSkip = (std::min)(_current->size() - _posInCurrent, atMost - skipped);
+    _posInCurrent += toSkip;
+    skipped += toSkip;
+
+    if (_posInCurrent >= _current->size()) {
+      AqlItemBlock* cur = _current;
+      _current = nullptr;
+      returnBlock(cur);
+    }
+  }
+
+  return skipped;
+}
+
+bool ParallelGatherBlock::fetchResult () {
+  TRI_ASSERT(_current == nullptr);
+
+  while (true) {
+    if (! _started) {
+      if (_buffer.empty()) {
+        if (! ExecutionBlock::getBlock(DefaultBatchSize, DefaultBatchSize)) {
+          _done = true;
+          return false;
+        }
+        _pos = 0;
+      }
+
+      startWorkers(_buffer.front(), _pos);
+    }
+
+    {
+      CONDITION_LOCKER(guard, _condition);
+
+      while (_results.empty() && 
+             _running > 0 && 
+             _errorCode == TRI_ERROR_NO_ERROR) {
+        guard.wait();
+      }
+
+      if (! _results.empty() && _errorCode == TRI_ERROR_NO_ERROR) {
+        _current = _results.front();
+        _results.pop_front();
+        _posInCurrent = 0;
+
+        // wake up workers waiting for space in the queue
+        guard.broadcast();
+        return true;
+      }
+    }
+
+    // all workers are done with the current input row, or one of them failed
+    stopWorkers();
+    _started = false;
+
+    if (_errorCode != TRI_ERROR_NO_ERROR) {
+      int errorCode = _errorCode;
+      std::string errorMessage;
+      errorMessage.swap(_errorMessage);
+      _errorCode = TRI_ERROR_NO_ERROR;
+
+      THROW_ARANGO_EXCEPTION_MESSAGE(errorCode, errorMessage);
+    }
+
+    // advance to the next input row
+    AqlItemBlock* cur = _buffer.front();
+
+    if (++_pos >= cur->size()) {
+      _buffer.pop_front();
+      _pos = 0;
+      returnBlock(cur);
+    }
+  }
+}
+
+void ParallelGatherBlock::startWorkers (AqlItemBlock* items, 
+                                        size_t pos) {
+  TRI_ASSERT(! _started);
+
+  for (auto& it : _workers) {
+    int res = it->initializeCursor(items, pos);
+
+    if (res != TRI_ERROR_NO_ERROR) {
+      THROW_ARANGO_EXCEPTION(res);
+    }
+  }
+
+  // the workers read-lock the collection for each batch they read. release
+  // the lock the transaction may still hold, as a sequential scan does after
+  // its first batch. otherwise a writer waiting for the lock would block the
+  // workers and the query would never release the lock
+  auto trxCollection = _trx->trxCollection(_collection->cid());
+
+  if (trxCollection != nullptr) {
+    _trx->unlockPartitions(trxCollection);
+  }
+
+  if (_pool == nullptr) {
+    _pool.reset(new triagens::basics::ThreadPool(_workers.size(), "AqlScan"));
+  }
+
+  {
+    CONDITION_LOCKER(guard, _condition);
+    _stopping = false;
+    _running = _workers.size();
+  }
+
+  _started = true;
+
+  for (auto& it : _workers) {
+    ExecutionEngine* worker = it;
+    _pool->enqueue([this, worker] () -> void {
+      runWorker(worker);
+    });
+  }
+}
+
+void ParallelGatherBlock::runWorker (ExecutionEngine* worker) {
+  // keep at most two result blocks per worker
+  size_t const maxResults = 2 * _workers.size();
+
+  int res = TRI_ERROR_NO_ERROR;
+  std::string message;
+
+  try {
+    while (true) {
+      {
+        CONDITION_LOCKER(guard, _condition);
+
+        while (! _stopping && _results.size() >= maxResults) {
+          guard.wait();
+        }
+
+        if (_stopping) {
+          break;
+        }
+      }
+
+      std::unique_ptr<AqlItemBlock> result(worker->getSome(DefaultBatchSize, DefaultBatchSize));
+
+      if (result == nullptr) {
+        break;
+      }
+
+      CONDITION_LOCKER(guard, _condition);
+
+      if (_stopping) {
+        break;
+      }
+
+      _results.emplace_back(result.get());
+      result.release();
+      guard.broadcast();
+    }
+  }
+  catch (triagens::basics::Exception const& ex) {
+    res = ex.code();
+    message = ex.message();
+  }
+  catch (std::bad_alloc const&) {
+    res = TRI_ERROR_OUT_OF_MEMORY;
+  }
+  catch (...) {
+    res = TRI_ERROR_INTERNAL;
+  }
+
+  CONDITION_LOCKER(guard, _condition);
+
+  if (res != TRI_ERROR_NO_ERROR && _errorCode == TRI_ERROR_NO_ERROR) {
+    _errorCode = res;
+    _errorMessage = message.empty() ? std::string(TRI_errno_string(res)) : message;
+    _stopping = true;
+  }
+
+  TRI_ASSERT(_running > 0);
+  --_running;
+  guard.broadcast();
+}
+
+void ParallelGatherBlock::stopWorkers () {
+  {
+    CONDITION_LOCKER(guard, _condition);
+
+    _stopping = true;
+    guard.broadcast();
+
+    while (_running > 0) {
+      guard.wait();
+    }
+
+    for (auto& it : _results) {
+      delete it;
+    }
+    _results.clear();
+  }
+
+  // the statistics of the workers are only accessed by the workers while 
+  // they are running. the workers do not contain a LIMIT, so their fullCount
+  // is unused and must not be added
+  for (auto& it : _workers) {
+    it->_stats.fullCount = 0;
+    _engine->_stats.add(it->_stats);
+    it->_stats = ExecutionStats();
+  }
+}
+
 // -----------------------------------------------------------------------------
 // --SECTION--                                            class BlockWithClients
 // -----------------------------------------------------------------------------
@@ -7002,6 +8775,12 @@ size_t RemoteBlock::skipSome (size_t atLeast, size_t atMost) {
   if (JsonHelper::getBooleanValue(responseBodyJson.json(), "error", true)) {
     THROW_ARANGO_EXCEPTION(TRI_ERROR_CLUSTER_AQL_COMMUNICATION);
   }
+
+  ExecutionStats newStats(responseBodyJson.get("stats"));
+  
+  _engine->_stats.addDelta(_deltaStats, newStats);
+  _deltaStats = newStats;
+
   size_t skipped = JsonHelper::getNumericValue<size_t>(responseBodyJson.json(),
                                                        "skipped", 0);
   return skipped;
@@ -34,13 +34,17 @@
 #include "Aql/CollectionScanner.h"
 #include "Aql/ExecutionNode.h"
 #include "Aql/Range.h"
+#include "Aql/SortRun.h"
 #include "Aql/WalkerWorker.h"
 #include "Aql/ExecutionStats.h"
+#include "Basics/ConditionVariable.h"
 #include "Basics/StringBuffer.h"
+#include "Basics/ThreadPool.h"
 #include "Cluster/ClusterComm.h"
 #include "Utils/AqlTransaction.h"
 #include "Utils/transactions.h"
 #include "Utils/V8TransactionContext.h"
+#include "V8Server/V8Traverser.h"
 #include "VocBase/shaped-json.h"
 
 struct TRI_df_marker_s;
@@ -54,6 +58,7 @@ namespace triagens {
 
     struct CollectionScanner;
 
+    class AttributeAccessor;
     class ExecutionEngine;
 
 // -----------------------------------------------------------------------------
@@ -96,6 +101,47 @@ namespace triagens {
                       RegisterId groupRegister);
     };
 
+// -----------------------------------------------------------------------------
+// --SECTION--                                    GroupKeyHash and GroupKeyEqual
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief hasher for a vector of AQL values
+////////////////////////////////////////////////////////////////////////////////
+
+    struct GroupKeyHash {
+      GroupKeyHash (triagens::arango::AqlTransaction* trx,
+                    std::vector<TRI_document_collection_t const*>& colls)
+        : _trx(trx),
+          _colls(colls),
+          _num(colls.size()) {
+      }
+
+      size_t operator() (std::vector<AqlValue> const& value) const;
+      
+      triagens::arango::AqlTransaction* _trx;
+      std::vector<TRI_document_collection_t const*>& _colls;
+      size_t const _num;
+    };
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief comparator for a vector of AQL values
+////////////////////////////////////////////////////////////////////////////////
+    
+    struct GroupKeyEqual {
+      GroupKeyEqual (triagens::arango::AqlTransaction* trx,
+                     std::vector<TRI_document_collection_t const*>& colls)
+        : _trx(trx),
+          _colls(colls) {
+      }
+
+      bool operator() (std::vector<AqlValue> const&,
+                       std::vector<AqlValue> const&) const;
+      
+      triagens::arango::AqlTransaction* _trx;
+      std::vector<TRI_document_collection_t const*>& _colls;
+    };
+
 // -----------------------------------------------------------------------------
 // --SECTION--                                                    ExecutionBlock
 // -----------------------------------------------------------------------------
@@ -230,6 +276,22 @@ namespace triagens {
 
         virtual AqlItemBlock* getSome (size_t atLeast, size_t atMost);
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief getSome, and record the call in the node's runtime statistics if 
+/// the query is profiled. blocks fetching from their dependencies and the
+/// engine fetching from its root use this instead of calling getSome
+/// directly
+////////////////////////////////////////////////////////////////////////////////
+
+        AqlItemBlock* getSomeProfiled (size_t atLeast, size_t atMost);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief skipSome, and record the call in the node's runtime statistics if
+/// the query is profiled
+////////////////////////////////////////////////////////////////////////////////
+
+        size_t skipSomeProfiled (size_t atLeast, size_t atMost);
+
 // -----------------------------------------------------------------------------
 // --SECTION--                                                 protected methods
 // -----------------------------------------------------------------------------
@@ -385,6 +447,12 @@ namespace triagens {
 
         bool _done;
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief whether or not runtime statistics are recorded for the block
+////////////////////////////////////////////////////////////////////////////////
+
+        bool const _profile;
+
 // -----------------------------------------------------------------------------
 // --SECTION--                                                  public variables
 // -----------------------------------------------------------------------------
@@ -475,8 +543,16 @@ namespace triagens {
 
       public:
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief create the block
+///
+/// if prefetch is true and the collection will be scanned completely, the
+/// kernel is asked to read the collection's datafiles in the background
+////////////////////////////////////////////////////////////////////////////////
+
         EnumerateCollectionBlock (ExecutionEngine* engine,
-                                  EnumerateCollectionNode const* ep);
+                                  EnumerateCollectionNode const* ep,
+                                  bool prefetch = true);
 
         ~EnumerateCollectionBlock ();
 
@@ -496,6 +572,13 @@ namespace triagens {
 
         bool moreDocuments (size_t hint);
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief restrict the scan to one of multiple partitions of the collection
+////////////////////////////////////////////////////////////////////////////////
+
+        void setPartition (size_t,
+                           size_t);
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief initialize, here we fetch all docs from the database
 ////////////////////////////////////////////////////////////////////////////////
@@ -961,6 +1044,242 @@ namespace triagens {
 
     };
 
+// -----------------------------------------------------------------------------
+// --SECTION--                                                        GraphBlock
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief common base class for blocks that compute a list of vertices or
+/// edges for each input row and produce one output row per list element
+////////////////////////////////////////////////////////////////////////////////
+
+    class GraphBlock : public ExecutionBlock {
+
+      public:
+
+        GraphBlock (ExecutionEngine*,
+                    ExecutionNode const*,
+                    bool);
+
+        virtual ~GraphBlock ();
+
+        int initializeCursor (AqlItemBlock* items, size_t pos) override;
+
+        AqlItemBlock* getSome (size_t atLeast, size_t atMost) override final;
+
+////////////////////////////////////////////////////////////////////////////////
+// skip between atLeast and atMost returns the number actually skipped . . .
+// will only return less than atLeast if there aren't atLeast many
+// things to skip overall.
+////////////////////////////////////////////////////////////////////////////////
+
+        size_t skipSome (size_t atLeast, size_t atMost) override final;
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                 protected methods
+// -----------------------------------------------------------------------------
+
+      protected:
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief compute the ids for the given input row and store them in _ids
+////////////////////////////////////////////////////////////////////////////////
+
+        virtual void computeIds (AqlItemBlock const*, size_t) = 0;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief look up the id of a collection used in the query
+////////////////////////////////////////////////////////////////////////////////
+
+        TRI_voc_cid_t lookupCollection (std::string const&) const;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief order a ditch for the edge collection. the vertex ids computed by
+/// the searches point into its edge markers and are kept across calls to
+/// getSome, so the compactor must not move the markers until the query ends
+////////////////////////////////////////////////////////////////////////////////
+
+        void orderEdgeDitch (std::string const&);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief extract a vertex id from a register value. the value can either be
+/// a document with an _id attribute, a document id or a document key. the
+/// id string is stored in the buffer, which must outlive the vertex id
+////////////////////////////////////////////////////////////////////////////////
+
+        VertexId extractVertexId (AqlItemBlock const*,
+                                  size_t,
+                                  RegisterId,
+                                  std::string const&,
+                                  bool,
+                                  char const*,
+                                  std::string&) const;
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                 private functions
+// -----------------------------------------------------------------------------
+
+      private:
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief create the AqlValue for an id, either the id string or the document
+////////////////////////////////////////////////////////////////////////////////
+
+        AqlValue idToAqlValue (VertexId const&) const;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief make sure the ids for the current input row are computed. returns
+/// false if there are no more input rows
+////////////////////////////////////////////////////////////////////////////////
+
+        bool prepareIds (size_t);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief move on to the next input row
+////////////////////////////////////////////////////////////////////////////////
+
+        void nextRow ();
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                               protected variables
+// -----------------------------------------------------------------------------
+
+      protected:
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief ids computed for the current input row
+////////////////////////////////////////////////////////////////////////////////
+
+        std::vector<VertexId> _ids;
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                 private variables
+// -----------------------------------------------------------------------------
+
+      private:
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief position of the next id to produce
+////////////////////////////////////////////////////////////////////////////////
+
+        size_t _index;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief whether the ids for the current input row have been computed
+////////////////////////////////////////////////////////////////////////////////
+
+        bool _computed;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief whether or not to produce documents instead of id strings
+////////////////////////////////////////////////////////////////////////////////
+
+        bool const _includeData;
+
+    };
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                    TraversalBlock
+// -----------------------------------------------------------------------------
+
+    class TraversalBlock : public GraphBlock {
+
+      public:
+
+        TraversalBlock (ExecutionEngine*,
+                        TraversalNode const*);
+
+        ~TraversalBlock ();
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                 protected methods
+// -----------------------------------------------------------------------------
+
+      protected:
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief compute the neighbors of the start vertex in the input row
+////////////////////////////////////////////////////////////////////////////////
+
+        void computeIds (AqlItemBlock const*, size_t) override final;
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                 private variables
+// -----------------------------------------------------------------------------
+
+      private:
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief the register index containing the start vertex
+////////////////////////////////////////////////////////////////////////////////
+
+        RegisterId _inVarRegId;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief id string of the current start vertex
+////////////////////////////////////////////////////////////////////////////////
+
+        std::string _start;
+
+    };
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                 ShortestPathBlock
+// -----------------------------------------------------------------------------
+
+    class ShortestPathBlock : public GraphBlock {
+
+      public:
+
+        ShortestPathBlock (ExecutionEngine*,
+                           ShortestPathNode const*);
+
+        ~ShortestPathBlock ();
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                 protected methods
+// -----------------------------------------------------------------------------
+
+      protected:
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief compute the shortest path between the vertices in the input row
+////////////////////////////////////////////////////////////////////////////////
+
+        void computeIds (AqlItemBlock const*, size_t) override final;
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                 private variables
+// -----------------------------------------------------------------------------
+
+      private:
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief the register index containing the start vertex
+////////////////////////////////////////////////////////////////////////////////
+
+        RegisterId _startRegId;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief the register index containing the target vertex
+////////////////////////////////////////////////////////////////////////////////
+
+        RegisterId _targetRegId;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief id string of the current start vertex
+////////////////////////////////////////////////////////////////////////////////
+
+        std::string _start;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief id string of the current target vertex
+////////////////////////////////////////////////////////////////////////////////
+
+        std::string _target;
+
+    };
+
 // -----------------------------------------------------------------------------
 // --SECTION--                                                  CalculationBlock
 // -----------------------------------------------------------------------------
@@ -969,8 +1288,15 @@ namespace triagens {
 
       public:
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief constructor. a block that is executed concurrently with other
+/// blocks for the same node must use its own copy of the expression, as
+/// expressions keep state during their evaluation
+////////////////////////////////////////////////////////////////////////////////
+
         CalculationBlock (ExecutionEngine*,
-                          CalculationNode const*);
+                          CalculationNode const*,
+                          bool = false);
 
         ~CalculationBlock ();
 
@@ -1044,6 +1370,12 @@ namespace triagens {
 
         bool _isReference;
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief whether or not the block owns its copy of the expression
+////////////////////////////////////////////////////////////////////////////////
+
+        bool const _ownsExpression;
+
     };
 
 // -----------------------------------------------------------------------------
@@ -1289,69 +1621,249 @@ namespace triagens {
 
         RegisterId _groupRegister;
         
-////////////////////////////////////////////////////////////////////////////////
-/// @brief hasher for a vector of AQL values
-////////////////////////////////////////////////////////////////////////////////
-
-        struct GroupKeyHash {
-          GroupKeyHash (triagens::arango::AqlTransaction* trx,
-                        std::vector<TRI_document_collection_t const*>& colls)
-            : _trx(trx),
-              _colls(colls),
-              _num(colls.size()) {
-          }
-
-          size_t operator() (std::vector<AqlValue> const& value) const;
-          
-          triagens::arango::AqlTransaction* _trx;
-          std::vector<TRI_document_collection_t const*>& _colls;
-          size_t const _num;
-        };
-
-////////////////////////////////////////////////////////////////////////////////
-/// @brief comparator for a vector of AQL values
-////////////////////////////////////////////////////////////////////////////////
-        
-        struct GroupKeyEqual {
-          GroupKeyEqual (triagens::arango::AqlTransaction* trx,
-                         std::vector<TRI_document_collection_t const*>& colls)
-            : _trx(trx),
-              _colls(colls) {
-          }
-
-          bool operator() (std::vector<AqlValue> const&,
-                           std::vector<AqlValue> const&) const;
-          
-          triagens::arango::AqlTransaction* _trx;
-          std::vector<TRI_document_collection_t const*>& _colls;
-        };
-        
     };
 
 // -----------------------------------------------------------------------------
-// --SECTION--                                                         SortBlock
+// --SECTION--                                                     HashJoinBlock
 // -----------------------------------------------------------------------------
 
-    class SortBlock : public ExecutionBlock  {
+    class HashJoinBlock : public ExecutionBlock {
 
       public:
 
-        SortBlock (ExecutionEngine*,
-                   SortNode const*);
+        HashJoinBlock (ExecutionEngine*,
+                       HashJoinNode const*);
 
-        ~SortBlock ();
+        ~HashJoinBlock ();
 
         int initialize () override;
 
-        int initializeCursor (AqlItemBlock* items, size_t pos) override final;
+        int initializeCursor (AqlItemBlock* items, size_t pos) override;
+
+        AqlItemBlock* getSome (size_t atLeast, size_t atMost) override final;
 
 ////////////////////////////////////////////////////////////////////////////////
-/// @brief dosorting
+// skip between atLeast and atMost returns the number actually skipped . . .
+// will only return less than atLeast if there aren't atLeast many
+// things to skip overall.
 ////////////////////////////////////////////////////////////////////////////////
 
-      private:
+        size_t skipSome (size_t atLeast, size_t atMost) override final;
 
-        void doSorting ();
+// -----------------------------------------------------------------------------
+// --SECTION--                                                   private methods
+// -----------------------------------------------------------------------------
+
+      private:
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief scan the collection and build the hash table from its documents
+////////////////////////////////////////////////////////////////////////////////
+
+        void buildHashTable ();
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief free the hash table and the key values stored in it
+////////////////////////////////////////////////////////////////////////////////
+
+        void freeHashTable ();
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief look up the documents matching the key values of an input row.
+/// returns a nullptr if there are none
+////////////////////////////////////////////////////////////////////////////////
+
+        std::vector<TRI_df_marker_t const*> const* lookup (AqlItemBlock const*,
+                                                           size_t);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief make sure the matches for the current input row are looked up. 
+/// returns false if there are no more input rows
+////////////////////////////////////////////////////////////////////////////////
+
+        bool prepareMatches (size_t);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief move on to the next input row
+////////////////////////////////////////////////////////////////////////////////
+
+        void nextRow ();
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                 private variables
+// -----------------------------------------------------------------------------
+
+      private:
+
+        typedef std::unordered_map<std::vector<AqlValue>, 
+                                   std::vector<TRI_df_marker_t const*>,
+                                   GroupKeyHash,
+                                   GroupKeyEqual> HashTable;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief collection
+////////////////////////////////////////////////////////////////////////////////
+
+        Collection* _collection;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief the registers containing the key values of the input rows
+////////////////////////////////////////////////////////////////////////////////
+
+        std::vector<RegisterId> _probeRegisters;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief accessors for the key attributes of the documents
+////////////////////////////////////////////////////////////////////////////////
+
+        std::vector<AttributeAccessor*> _accessors;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief collections of the key values, as needed by the hasher and the 
+/// comparator. the key values are never shaped, so all entries are nullptr
+////////////////////////////////////////////////////////////////////////////////
+
+        std::vector<TRI_document_collection_t const*> _keyCollections;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief the hash table, built on first use after each initializeCursor
+////////////////////////////////////////////////////////////////////////////////
+
+        HashTable* _hashTable;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief the documents matching the current input row
+////////////////////////////////////////////////////////////////////////////////
+
+        std::vector<TRI_df_marker_t const*> const* _matches;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief position of the next match to produce
+////////////////////////////////////////////////////////////////////////////////
+
+        size_t _index;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief whether the matches for the current input row have been looked up
+////////////////////////////////////////////////////////////////////////////////
+
+        bool _computed;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief whether or not the datafiles have been prefetched
+////////////////////////////////////////////////////////////////////////////////
+
+        bool _prefetched;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief whether or not the matching documents need to be stored
+////////////////////////////////////////////////////////////////////////////////
+
+        bool _mustStoreResult;
+    };
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                         SortBlock
+// -----------------------------------------------------------------------------
+
+    class SortBlock : public ExecutionBlock  {
+
+      public:
+
+        SortBlock (ExecutionEngine*,
+                   SortNode const*);
+
+        ~SortBlock ();
+
+        int initialize () override;
+
+        int initializeCursor (AqlItemBlock* items, size_t pos) override final;
+
+        int shutdown (int) override final;
+
+        bool hasMore () override final;
+
+        int64_t remaining () override final;
+
+      protected:
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief getOrSkipSome, refills the buffer from the spilled runs before
+/// handing out rows
+////////////////////////////////////////////////////////////////////////////////
+
+        int getOrSkipSome (size_t atLeast,
+                           size_t atMost,
+                           bool skipping,
+                           AqlItemBlock*& result,
+                           size_t& skipped) override final;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief dosorting
+////////////////////////////////////////////////////////////////////////////////
+
+      private:
+
+        void doSorting ();
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief sorts the blocks currently in _buffer and writes them to a new
+/// run on disk. the blocks are freed afterwards
+////////////////////////////////////////////////////////////////////////////////
+
+        void spillRun ();
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief prepares the k-way merge of all spilled runs
+////////////////////////////////////////////////////////////////////////////////
+
+        void startMerge ();
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief produces the next block of merged rows and appends it to _buffer
+////////////////////////////////////////////////////////////////////////////////
+
+        void mergeBlock ();
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief refills _buffer from the spilled runs until it contains at least
+/// the specified number of rows or all runs are exhausted
+////////////////////////////////////////////////////////////////////////////////
+
+        void fillBuffer (size_t);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief removes all spilled runs and their temporary files
+////////////////////////////////////////////////////////////////////////////////
+
+        void clearRuns ();
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief doTopKSorting, sorts the input while keeping only the first
+/// <_limit> rows in a bounded heap. all other rows are released as soon as
+/// their input block has been processed
+////////////////////////////////////////////////////////////////////////////////
+
+        void doTopKSorting ();
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief moves the values of a row of an input block into a row kept by
+/// the top-k sort. values are stolen from the block if possible and cloned
+/// otherwise
+////////////////////////////////////////////////////////////////////////////////
+
+        static void moveRow (AqlItemBlock*,
+                             size_t,
+                             std::vector<AqlValue>&);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief takes a value out of a block. the value is stolen from the block if
+/// it is its only user and cloned otherwise
+////////////////////////////////////////////////////////////////////////////////
+
+        static AqlValue takeValue (AqlItemBlock*,
+                                   size_t,
+                                   RegisterId);
 
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief OurLessThan
@@ -1380,6 +1892,77 @@ namespace triagens {
             std::vector<TRI_document_collection_t const*>& _colls;
         };
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief TopKLessThan, compares the rows kept by the top-k sort. rows that
+/// compare equal are ordered by their arrival sequence, so the top-k sort
+/// is always stable
+////////////////////////////////////////////////////////////////////////////////
+
+        class TopKLessThan {
+
+          public:
+            TopKLessThan (triagens::arango::AqlTransaction* trx,
+                          std::vector<std::vector<AqlValue>>& rows,
+                          std::vector<size_t>& sequences,
+                          std::vector<std::pair<RegisterId, bool>>& sortRegisters,
+                          std::vector<TRI_document_collection_t const*>& colls)
+              : _trx(trx),
+                _rows(rows),
+                _sequences(sequences),
+                _sortRegisters(sortRegisters),
+                _colls(colls) {
+            }
+
+            bool operator() (size_t a, 
+                             size_t b) const;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief whether or not a row of an input block sorts before a kept row.
+/// the input row has arrived later, so it does not sort before an equal row
+////////////////////////////////////////////////////////////////////////////////
+
+            bool operator() (AqlItemBlock const*, 
+                             size_t,
+                             size_t) const;
+
+          private:
+            triagens::arango::AqlTransaction* _trx;
+            std::vector<std::vector<AqlValue>>& _rows;
+            std::vector<size_t>& _sequences;
+            std::vector<std::pair<RegisterId, bool>>& _sortRegisters;
+            std::vector<TRI_document_collection_t const*>& _colls;
+        };
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief MergeGreaterThan, compares the current rows of two spilled runs.
+/// it is used for a min-heap of runs, so it returns true if the row of the
+/// first run sorts after the row of the second. rows that compare equal are
+/// ordered by run, so the merge is stable if the runs are
+////////////////////////////////////////////////////////////////////////////////
+
+        class MergeGreaterThan {
+
+          public:
+            MergeGreaterThan (triagens::arango::AqlTransaction* trx,
+                              std::vector<AqlItemBlock*>& blocks,
+                              std::vector<size_t>& positions,
+                              std::vector<std::pair<RegisterId, bool>>& sortRegisters)
+              : _trx(trx),
+                _blocks(blocks),
+                _positions(positions),
+                _sortRegisters(sortRegisters) {
+            }
+
+            bool operator() (size_t a,
+                             size_t b) const;
+
+          private:
+            triagens::arango::AqlTransaction* _trx;
+            std::vector<AqlItemBlock*>& _blocks;
+            std::vector<size_t>& _positions;
+            std::vector<std::pair<RegisterId, bool>>& _sortRegisters;
+        };
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief pairs, consisting of variable and sort direction
 /// (true = ascending | false = descending)
@@ -1393,6 +1976,51 @@ namespace triagens {
 
         bool _stable;
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief maximum number of rows to produce (0 = unlimited). if set, the
+/// block performs a top-k sort instead of a full sort
+////////////////////////////////////////////////////////////////////////////////
+
+        size_t _limit;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief memory budget (in bytes) for the rows buffered by a full sort
+/// (0 = unlimited). if exceeded, sorted runs are spilled to temporary files
+////////////////////////////////////////////////////////////////////////////////
+
+        size_t _memoryLimit;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief the runs spilled to disk, in input order
+////////////////////////////////////////////////////////////////////////////////
+
+        std::vector<SortRun*> _runs;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief the current block of each run during the merge (nullptr if the
+/// run is exhausted)
+////////////////////////////////////////////////////////////////////////////////
+
+        std::vector<AqlItemBlock*> _runBlocks;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief the current row in the current block of each run
+////////////////////////////////////////////////////////////////////////////////
+
+        std::vector<size_t> _runPositions;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief min-heap of runs that still have rows, ordered by their current row
+////////////////////////////////////////////////////////////////////////////////
+
+        std::vector<size_t> _mergeHeap;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief number of rows not yet merged
+////////////////////////////////////////////////////////////////////////////////
+
+        size_t _mergeRemaining;
+
     };
 
 // -----------------------------------------------------------------------------
@@ -2003,6 +2631,191 @@ namespace triagens {
         };
     };
 
+// -----------------------------------------------------------------------------
+// --SECTION--                                               ParallelGatherBlock
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief gathers the results of a full collection scan and the filters and
+/// calculations following it, which are executed by multiple worker threads
+/// on different partitions of the collection. each worker runs its own copy
+/// of the pipeline in a separate engine, and the results are returned in the
+/// order in which the workers produce them
+////////////////////////////////////////////////////////////////////////////////
+
+    class ParallelGatherBlock : public ExecutionBlock {
+
+      public:
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief constructor
+////////////////////////////////////////////////////////////////////////////////
+
+        ParallelGatherBlock (ExecutionEngine*,
+                             GatherNode const*);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief destructor
+////////////////////////////////////////////////////////////////////////////////
+
+        ~ParallelGatherBlock ();
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief initialize
+////////////////////////////////////////////////////////////////////////////////
+
+        int initialize () override final;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief shutdown, stops the workers and shuts down their engines
+////////////////////////////////////////////////////////////////////////////////
+         
+        int shutdown (int) override final;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief initializeCursor
+////////////////////////////////////////////////////////////////////////////////
+
+        int initializeCursor (AqlItemBlock* items, size_t pos) override final;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief count, unknown because of the filters executed by the workers
+////////////////////////////////////////////////////////////////////////////////
+        
+        int64_t count () const override final {
+          return -1;
+        }
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief remaining, unknown because of the filters executed by the workers
+////////////////////////////////////////////////////////////////////////////////
+
+        int64_t remaining () override final {
+          return -1;
+        }
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief hasMore
+////////////////////////////////////////////////////////////////////////////////
+
+        bool hasMore () override final;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief getSome
+////////////////////////////////////////////////////////////////////////////////
+
+        AqlItemBlock* getSome (size_t, size_t) override final;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief skipSome
+////////////////////////////////////////////////////////////////////////////////
+
+        size_t skipSome (size_t, size_t) override final;
+        
+      private:
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief fetch the next result block of the workers into _current, starting
+/// the workers for the next input row if required. returns false if there
+/// are no more results
+////////////////////////////////////////////////////////////////////////////////
+
+        bool fetchResult ();
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief start the workers for an input row
+////////////////////////////////////////////////////////////////////////////////
+
+        void startWorkers (AqlItemBlock*, 
+                           size_t);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief execute the pipeline of a worker, called in a worker thread
+////////////////////////////////////////////////////////////////////////////////
+
+        void runWorker (ExecutionEngine*);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief stop the workers and wait until they are finished. discards the
+/// results not yet returned, and adds the statistics of the workers to the
+/// statistics of the query
+////////////////////////////////////////////////////////////////////////////////
+
+        void stopWorkers ();
+
+      private:
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief the collection being scanned
+////////////////////////////////////////////////////////////////////////////////
+
+        Collection const* _collection;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief the engines executing the pipelines, one per partition
+////////////////////////////////////////////////////////////////////////////////
+
+        std::vector<ExecutionEngine*> _workers;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief the threads executing the workers, created on first use
+////////////////////////////////////////////////////////////////////////////////
+
+        std::unique_ptr<triagens::basics::ThreadPool> _pool;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief condition variable protecting the variables below, and used for
+/// signaling between the workers and the consumer
+////////////////////////////////////////////////////////////////////////////////
+
+        triagens::basics::ConditionVariable _condition;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief results produced by the workers but not yet returned
+////////////////////////////////////////////////////////////////////////////////
+
+        std::deque<AqlItemBlock*> _results;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief number of workers still running
+////////////////////////////////////////////////////////////////////////////////
+
+        size_t _running;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief whether or not the workers should stop
+////////////////////////////////////////////////////////////////////////////////
+
+        bool _stopping;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief the first error a worker ran into
+////////////////////////////////////////////////////////////////////////////////
+
+        int _errorCode;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief the message of the first error a worker ran into
+////////////////////////////////////////////////////////////////////////////////
+
+        std::string _errorMessage;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief whether or not the workers were started for the current input row
+////////////////////////////////////////////////////////////////////////////////
+
+        bool _started;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief the result block currently being returned, and the position in it
+////////////////////////////////////////////////////////////////////////////////
+
+        AqlItemBlock* _current;
+
+        size_t _posInCurrent;
+
+    };
+
 // -----------------------------------------------------------------------------
 // --SECTION--                                                  BlockWithClients
 // -----------------------------------------------------------------------------
@@ -64,6 +64,18 @@ static ExecutionBlock* CreateBlock (ExecutionEngine* engine,
       return new EnumerateListBlock(engine,
                                     static_cast<EnumerateListNode const*>(en));
     }
+    case ExecutionNode::TRAVERSAL: {
+      return new TraversalBlock(engine,
+                                static_cast<TraversalNode const*>(en));
+    }
+    case ExecutionNode::SHORTEST_PATH: {
+      return new ShortestPathBlock(engine,
+                                   static_cast<ShortestPathNode const*>(en));
+    }
+    case ExecutionNode::HASH_JOIN: {
+      return new HashJoinBlock(engine,
+                               static_cast<HashJoinNode const*>(en));
+    }
     case ExecutionNode::CALCULATION: {
       return new CalculationBlock(engine,
                                   static_cast<CalculationNode const*>(en));
@@ -142,6 +154,10 @@ static ExecutionBlock* CreateBlock (ExecutionEngine* engine,
                                  (en)->collection());
     }
     case ExecutionNode::GATHER: {
+      if (static_cast<GatherNode const*>(en)->parallelism() > 0) {
+        return new ParallelGatherBlock(engine,
+                                       static_cast<GatherNode const*>(en));
+      }
       return new GatherBlock(engine,
                              static_cast<GatherNode const*>(en));
     }
@@ -211,6 +227,7 @@ struct Instanciator final : public WalkerWorker<ExecutionNode> {
   ExecutionEngine* engine;
   ExecutionBlock*  root;
   std::unordered_map<ExecutionNode*, ExecutionBlock*> cache;
+  std::unordered_set<ExecutionNode*> parallel;
 
   Instanciator (ExecutionEngine* engine) 
     : engine(engine),
@@ -220,7 +237,31 @@ struct Instanciator final : public WalkerWorker<ExecutionNode> {
   ~Instanciator () {
   }
 
+  virtual bool before (ExecutionNode* en) override final {
+    if (en->getType() == ExecutionNode::GATHER &&
+        static_cast<GatherNode const*>(en)->parallelism() > 0) {
+      // the nodes between the gather and the collection scan are executed
+      // by the workers of the gather block, which create their own blocks
+      auto current = en->getFirstDependency();
+
+      while (current != nullptr) {
+        parallel.emplace(current);
+
+        if (current->getType() == ExecutionNode::ENUMERATE_COLLECTION) {
+          break;
+        }
+        current = current->getFirstDependency();
+      }
+    }
+
+    return false;
+  }
+
   virtual void after (ExecutionNode* en) override final {
+    if (parallel.find(en) != parallel.end()) {
+      return;
+    }
+
     ExecutionBlock* block = nullptr;
     {
       std::unique_ptr<ExecutionBlock> eb(CreateBlock(engine, en, cache));
@@ -239,7 +280,8 @@ struct Instanciator final : public WalkerWorker<ExecutionNode> {
       
       if (nodeType == ExecutionNode::DISTRIBUTE ||
           nodeType == ExecutionNode::SCATTER ||
-          nodeType == ExecutionNode::GATHER) {
+          (nodeType == ExecutionNode::GATHER && 
+           static_cast<GatherNode const*>(en)->parallelism() == 0)) {
         THROW_ARANGO_EXCEPTION_MESSAGE(TRI_ERROR_INTERNAL, "logic error, got cluster node in local query");
       }
 
@@ -250,7 +292,12 @@ struct Instanciator final : public WalkerWorker<ExecutionNode> {
     TRI_ASSERT(block != nullptr);
 
     // Now add dependencies:
-    for (auto const& it : en->getDependencies()) {
+    for (auto it : en->getDependencies()) {
+      // skip the nodes executed by the workers of a parallel gather
+      while (parallel.find(it) != parallel.end()) {
+        it = it->getFirstDependency();
+      }
+
       auto it2 = cache.find(it);
       TRI_ASSERT(it2 != cache.end());
       block->addDependency(it2->second);
@@ -535,6 +582,12 @@ struct CoordinatorInstanciator : public WalkerWorker<ExecutionNode> {
     optimizerOptionsRules.add(Json("-all"));
     optimizerOptions.set("rules", optimizerOptionsRules);
     options.set("optimizer", optimizerOptions);
+
+    if (query->profiling()) {
+      // let the DB servers collect runtime statistics for their nodes, too
+      options.set("profile", Json(true));
+    }
+
     result.set("options", options);
     std::unique_ptr<std::string> body(new std::string(triagens::basics::JsonHelper::toString(result.json())));
     
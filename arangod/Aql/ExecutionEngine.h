@@ -149,7 +149,7 @@ namespace triagens {
 ////////////////////////////////////////////////////////////////////////////////
 
         AqlItemBlock* getSome (size_t atLeast, size_t atMost) {
-          return _root->getSome(atLeast, atMost);
+          return _root->getSomeProfiled(atLeast, atMost);
         }
         
 ////////////////////////////////////////////////////////////////////////////////
@@ -157,7 +157,7 @@ namespace triagens {
 ////////////////////////////////////////////////////////////////////////////////
 
         size_t skipSome (size_t atLeast, size_t atMost) {
-          return _root->skipSome(atLeast, atMost);
+          return _root->skipSomeProfiled(atLeast, atMost);
         }
         
 ////////////////////////////////////////////////////////////////////////////////
@@ -165,7 +165,7 @@ namespace triagens {
 ////////////////////////////////////////////////////////////////////////////////
 
         AqlItemBlock* getOne () {
-          return _root->getSome(1, 1);
+          return _root->getSomeProfiled(1, 1);
         }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -77,7 +77,10 @@ std::unordered_map<int, std::string const> const ExecutionNode::TypeNames{
   { static_cast<int>(DISTRIBUTE),                   "DistributeNode" },
   { static_cast<int>(GATHER),                       "GatherNode" },
   { static_cast<int>(NORESULTS),                    "NoResultsNode" },
-  { static_cast<int>(UPSERT),                       "UpsertNode" }
+  { static_cast<int>(UPSERT),                       "UpsertNode" },
+  { static_cast<int>(TRAVERSAL),                    "TraversalNode" },
+  { static_cast<int>(SHORTEST_PATH),                "ShortestPathNode" },
+  { static_cast<int>(HASH_JOIN),                    "HashJoinNode" }
 };
           
 // -----------------------------------------------------------------------------
@@ -145,6 +148,12 @@ ExecutionNode* ExecutionNode::fromJsonFactory (ExecutionPlan* plan,
       return new EnumerateCollectionNode(plan, oneNode);
     case ENUMERATE_LIST:
       return new EnumerateListNode(plan, oneNode);
+    case TRAVERSAL:
+      return new TraversalNode(plan, oneNode);
+    case SHORTEST_PATH:
+      return new ShortestPathNode(plan, oneNode);
+    case HASH_JOIN:
+      return new HashJoinNode(plan, oneNode);
     case FILTER:
       return new FilterNode(plan, oneNode);
     case LIMIT:
@@ -940,6 +949,23 @@ void ExecutionNode::RegisterPlan::after (ExecutionNode *en) {
       break;
     }
 
+    case ExecutionNode::TRAVERSAL: 
+    case ExecutionNode::SHORTEST_PATH: 
+    case ExecutionNode::HASH_JOIN: {
+      depth++;
+      nrRegsHere.emplace_back(1);
+      // create a copy of the last value here
+      // this is requried because back returns a reference and emplace/push_back may invalidate all references
+      RegisterId registerId = 1 + nrRegs.back();
+      nrRegs.emplace_back(registerId);
+
+      auto const& vars = en->getVariablesSetHere();
+      TRI_ASSERT(vars.size() == 1);
+      varInfo.emplace(vars[0]->id, VarInfo(depth, totalNrRegs));
+      totalNrRegs++;
+      break;
+    }
+
     case ExecutionNode::CALCULATION: {
       nrRegsHere[depth]++;
       nrRegs[depth]++;
@@ -1476,6 +1502,212 @@ double EnumerateListNode::estimateCost (size_t& nrItems) const {
   return depCost + static_cast<double>(length) * incoming; 
 }
 
+// -----------------------------------------------------------------------------
+// --SECTION--                                          methods of TraversalNode
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief stringify an edge direction, using the names of the AQL functions
+////////////////////////////////////////////////////////////////////////////////
+
+static char const* EdgeDirectionToString (TRI_edge_direction_e direction) {
+  switch (direction) {
+    case TRI_EDGE_IN:
+      return "inbound";
+    case TRI_EDGE_OUT:
+      return "outbound";
+    case TRI_EDGE_ANY:
+      break;
+  }
+
+  return "any";
+}
+
+TraversalNode::TraversalNode (ExecutionPlan* plan,
+                              triagens::basics::Json const& base)
+  : ExecutionNode(plan, base),
+    _vertexCollection(JsonHelper::checkAndGetStringValue(base.json(), "vertexCollection")),
+    _edgeCollection(JsonHelper::checkAndGetStringValue(base.json(), "edgeCollection")),
+    _inVariable(varFromJson(plan->getAst(), base, "inVariable")),
+    _outVariable(varFromJson(plan->getAst(), base, "outVariable")),
+    _direction(TRI_EDGE_ANY),
+    _minDepth(JsonHelper::checkAndGetNumericValue<uint64_t>(base.json(), "minDepth")),
+    _maxDepth(JsonHelper::checkAndGetNumericValue<uint64_t>(base.json(), "maxDepth")),
+    _edgeExamples(),
+    _includeData(JsonHelper::checkAndGetBooleanValue(base.json(), "includeData")) {
+
+  std::string const direction = JsonHelper::checkAndGetStringValue(base.json(), "direction");
+
+  if (direction == "outbound") {
+    _direction = TRI_EDGE_OUT;
+  }
+  else if (direction == "inbound") {
+    _direction = TRI_EDGE_IN;
+  }
+
+  triagens::basics::Json edgeExamples = base.get("edgeExamples");
+
+  if (! edgeExamples.isEmpty() && ! edgeExamples.isNull()) {
+    _edgeExamples = edgeExamples.copy();
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief toJson, for TraversalNode
+////////////////////////////////////////////////////////////////////////////////
+
+void TraversalNode::toJsonHelper (triagens::basics::Json& nodes,
+                                  TRI_memory_zone_t* zone,
+                                  bool verbose) const {
+  triagens::basics::Json json(ExecutionNode::toJsonHelperGeneric(nodes, zone, verbose));  // call base class method
+  if (json.isEmpty()) {
+    return;
+  }
+  json("vertexCollection", triagens::basics::Json(_vertexCollection))
+      ("edgeCollection",   triagens::basics::Json(_edgeCollection))
+      ("inVariable",       _inVariable->toJson())
+      ("outVariable",      _outVariable->toJson())
+      ("direction",        triagens::basics::Json(EdgeDirectionToString(_direction)))
+      ("minDepth",         triagens::basics::Json(static_cast<double>(_minDepth)))
+      ("maxDepth",         triagens::basics::Json(static_cast<double>(_maxDepth)))
+      ("includeData",      triagens::basics::Json(_includeData));
+
+  if (_edgeExamples.isEmpty()) {
+    json("edgeExamples", triagens::basics::Json(triagens::basics::Json::Null));
+  }
+  else {
+    json("edgeExamples", _edgeExamples.copy());
+  }
+
+  // And add it:
+  nodes(json);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief clone ExecutionNode recursively
+////////////////////////////////////////////////////////////////////////////////
+
+ExecutionNode* TraversalNode::clone (ExecutionPlan* plan,
+                                     bool withDependencies,
+                                     bool withProperties) const {
+  auto outVariable = _outVariable;
+  auto inVariable = _inVariable;
+
+  if (withProperties) {
+    outVariable = plan->getAst()->variables()->createVariable(outVariable);
+    inVariable = plan->getAst()->variables()->createVariable(inVariable);
+  }
+
+  auto c = new TraversalNode(plan, _id, _vertexCollection, _edgeCollection, inVariable, outVariable, 
+                             _direction, _minDepth, _maxDepth, _edgeExamples, _includeData);
+
+  cloneHelper(c, plan, withDependencies, withProperties);
+
+  return static_cast<ExecutionNode*>(c);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief the cost of a traversal node
+////////////////////////////////////////////////////////////////////////////////
+        
+double TraversalNode::estimateCost (size_t& nrItems) const {
+  size_t incoming = 0;
+  double depCost = _dependencies.at(0)->getCost(incoming);
+
+  // the number of neighbors can only be determined at runtime. we assume
+  // each vertex has 10 neighbors, so the result grows with each level
+  double length = 1.0;
+
+  for (uint64_t i = 0; i < _maxDepth && length < 1000000.0; ++i) {
+    length *= 10.0;
+  }
+
+  nrItems = static_cast<size_t>(length) * incoming;
+  return depCost + length * incoming; 
+}
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                       methods of ShortestPathNode
+// -----------------------------------------------------------------------------
+
+ShortestPathNode::ShortestPathNode (ExecutionPlan* plan,
+                                    triagens::basics::Json const& base)
+  : ExecutionNode(plan, base),
+    _vertexCollection(JsonHelper::checkAndGetStringValue(base.json(), "vertexCollection")),
+    _edgeCollection(JsonHelper::checkAndGetStringValue(base.json(), "edgeCollection")),
+    _startVariable(varFromJson(plan->getAst(), base, "startVariable")),
+    _targetVariable(varFromJson(plan->getAst(), base, "targetVariable")),
+    _outVariable(varFromJson(plan->getAst(), base, "outVariable")),
+    _direction(JsonHelper::checkAndGetStringValue(base.json(), "direction")),
+    _produceEdges(JsonHelper::checkAndGetBooleanValue(base.json(), "produceEdges")),
+    _includeData(JsonHelper::checkAndGetBooleanValue(base.json(), "includeData")) {
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief toJson, for ShortestPathNode
+////////////////////////////////////////////////////////////////////////////////
+
+void ShortestPathNode::toJsonHelper (triagens::basics::Json& nodes,
+                                     TRI_memory_zone_t* zone,
+                                     bool verbose) const {
+  triagens::basics::Json json(ExecutionNode::toJsonHelperGeneric(nodes, zone, verbose));  // call base class method
+  if (json.isEmpty()) {
+    return;
+  }
+  json("vertexCollection", triagens::basics::Json(_vertexCollection))
+      ("edgeCollection",   triagens::basics::Json(_edgeCollection))
+      ("startVariable",    _startVariable->toJson())
+      ("targetVariable",   _targetVariable->toJson())
+      ("outVariable",      _outVariable->toJson())
+      ("direction",        triagens::basics::Json(_direction))
+      ("produceEdges",     triagens::basics::Json(_produceEdges))
+      ("includeData",      triagens::basics::Json(_includeData));
+
+  // And add it:
+  nodes(json);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief clone ExecutionNode recursively
+////////////////////////////////////////////////////////////////////////////////
+
+ExecutionNode* ShortestPathNode::clone (ExecutionPlan* plan,
+                                        bool withDependencies,
+                                        bool withProperties) const {
+  auto outVariable = _outVariable;
+  auto startVariable = _startVariable;
+  auto targetVariable = _targetVariable;
+
+  if (withProperties) {
+    outVariable = plan->getAst()->variables()->createVariable(outVariable);
+    startVariable = plan->getAst()->variables()->createVariable(startVariable);
+    targetVariable = plan->getAst()->variables()->createVariable(targetVariable);
+  }
+
+  auto c = new ShortestPathNode(plan, _id, _vertexCollection, _edgeCollection, startVariable, targetVariable, 
+                                outVariable, _direction, _produceEdges, _includeData);
+
+  cloneHelper(c, plan, withDependencies, withProperties);
+
+  return static_cast<ExecutionNode*>(c);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief the cost of a shortest path node
+////////////////////////////////////////////////////////////////////////////////
+        
+double ShortestPathNode::estimateCost (size_t& nrItems) const {
+  size_t incoming = 0;
+  double depCost = _dependencies.at(0)->getCost(incoming);
+
+  // the length of the path is unknown until runtime. finding it may
+  // require visiting many more vertices than are on the path
+  size_t const length = 10;
+
+  nrItems = length * incoming;
+  return depCost + 100.0 * incoming; 
+}
+
 // -----------------------------------------------------------------------------
 // --SECTION--                                         methods of IndexRangeNode
 // -----------------------------------------------------------------------------
@@ -1812,6 +2044,130 @@ bool IndexRangeNode::estimateItemsWithIndexSelectivity (size_t incoming,
   return true;
 }
 
+// -----------------------------------------------------------------------------
+// --SECTION--                                           methods of HashJoinNode
+// -----------------------------------------------------------------------------
+
+HashJoinNode::HashJoinNode (ExecutionPlan* plan,
+                            triagens::basics::Json const& base)
+  : ExecutionNode(plan, base),
+    _vocbase(plan->getAst()->query()->vocbase()),
+    _collection(plan->getAst()->query()->collections()->get(JsonHelper::checkAndGetStringValue(base.json(), "collection"))),
+    _outVariable(varFromJson(plan->getAst(), base, "outVariable")),
+    _probeVariables(),
+    _buildAttributes() {
+
+  triagens::basics::Json jsonKeys = base.get("keys");
+
+  if (! jsonKeys.isArray()) {
+    THROW_ARANGO_EXCEPTION_MESSAGE(TRI_ERROR_INTERNAL, "missing join keys in HashJoinNode");
+  }
+
+  size_t const n = jsonKeys.size();
+
+  for (size_t i = 0; i < n; ++i) {
+    triagens::basics::Json jsonKey = jsonKeys.at(static_cast<int>(i));
+    triagens::basics::Json jsonAttribute = jsonKey.get("attribute");
+
+    if (! jsonAttribute.isArray()) {
+      THROW_ARANGO_EXCEPTION_MESSAGE(TRI_ERROR_INTERNAL, "invalid join key in HashJoinNode");
+    }
+
+    std::vector<std::string> attribute;
+    size_t const m = jsonAttribute.size();
+
+    for (size_t j = 0; j < m; ++j) {
+      attribute.emplace_back(JsonHelper::getStringValue(jsonAttribute.at(static_cast<int>(j)).json(), ""));
+    }
+
+    _probeVariables.emplace_back(varFromJson(plan->getAst(), jsonKey, "probeVariable"));
+    _buildAttributes.emplace_back(attribute);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief toJson, for HashJoinNode
+////////////////////////////////////////////////////////////////////////////////
+
+void HashJoinNode::toJsonHelper (triagens::basics::Json& nodes,
+                                 TRI_memory_zone_t* zone,
+                                 bool verbose) const {
+  triagens::basics::Json json(ExecutionNode::toJsonHelperGeneric(nodes, zone, verbose));  // call base class method
+
+  if (json.isEmpty()) {
+    return;
+  }
+
+  triagens::basics::Json keys(triagens::basics::Json::Array, _probeVariables.size());
+
+  for (size_t i = 0; i < _probeVariables.size(); ++i) {
+    triagens::basics::Json attribute(triagens::basics::Json::Array, _buildAttributes[i].size());
+
+    for (auto const& it : _buildAttributes[i]) {
+      attribute(triagens::basics::Json(it));
+    }
+
+    keys(triagens::basics::Json(triagens::basics::Json::Object)
+           ("probeVariable", _probeVariables[i]->toJson())
+           ("attribute", attribute));
+  }
+
+  json("database", triagens::basics::Json(_vocbase->_name))
+      ("collection", triagens::basics::Json(_collection->getName()))
+      ("outVariable", _outVariable->toJson())
+      ("keys", keys);
+
+  // And add it:
+  nodes(json);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief clone ExecutionNode recursively
+////////////////////////////////////////////////////////////////////////////////
+
+ExecutionNode* HashJoinNode::clone (ExecutionPlan* plan,
+                                    bool withDependencies,
+                                    bool withProperties) const {
+  auto outVariable = _outVariable;
+  auto probeVariables = _probeVariables;
+
+  if (withProperties) {
+    outVariable = plan->getAst()->variables()->createVariable(outVariable);
+
+    for (auto& it : probeVariables) {
+      it = plan->getAst()->variables()->createVariable(it);
+    }
+  }
+
+  auto c = new HashJoinNode(plan, _id, _vocbase, _collection, outVariable, probeVariables, _buildAttributes);
+
+  cloneHelper(c, plan, withDependencies, withProperties);
+
+  return static_cast<ExecutionNode*>(c);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief the cost of a hash join node
+////////////////////////////////////////////////////////////////////////////////
+        
+double HashJoinNode::estimateCost (size_t& nrItems) const {
+  size_t incoming = 0;
+  double depCost = _dependencies.at(0)->getCost(incoming);
+  size_t const count = _collection->count();
+
+  // the number of matches can only be determined at runtime. we assume a 
+  // join along a foreign key, i.e. each document of the smaller side matches
+  // some documents of the larger side, and each document of the larger side
+  // matches one document of the smaller side
+  nrItems = (incoming == 0 ? 0 : (std::max)(incoming, count));
+
+  // the collection is scanned once. extracting the key from each document,
+  // hashing and storing it is more expensive than scanning, calculating the
+  // key for and probing with an item of the other side, so it pays to build 
+  // the hash table from the smaller side
+  return depCost + 4.0 * count + incoming + nrItems;
+}
+
 // -----------------------------------------------------------------------------
 // --SECTION--                                              methods of LimitNode
 // -----------------------------------------------------------------------------
@@ -2174,7 +2530,8 @@ SortNode::SortNode (ExecutionPlan* plan,
                     bool stable)
   : ExecutionNode(plan, base),
     _elements(elements),
-    _stable(stable) {
+    _stable(stable),
+    _limit(JsonHelper::getNumericValue<decltype(_limit)>(base.json(), "limit", 0)) {
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -2198,6 +2555,7 @@ void SortNode::toJsonHelper (triagens::basics::Json& nodes,
   }
   json("elements", values);
   json("stable", triagens::basics::Json(_stable));
+  json("limit", triagens::basics::Json(static_cast<double>(_limit)));
 
   // And add it:
   nodes(json);
@@ -2335,6 +2693,12 @@ double SortNode::estimateCost (size_t& nrItems) const {
   if (nrItems <= 3.0) {
     return depCost + nrItems;
   }
+  if (_limit > 0 && _limit < nrItems) {
+    // top-k sort: every item is compared against a heap of size <limit>
+    double cost = depCost + nrItems * log(static_cast<double>((std::max)(_limit, static_cast<size_t>(3))));
+    nrItems = _limit;
+    return cost;
+  }
   return depCost + nrItems * log(nrItems);
 }
 
@@ -2497,6 +2861,9 @@ struct UserVarFinder final : public WalkerWorker<ExecutionNode> {
     else if (en->getType() == ExecutionNode::ENUMERATE_COLLECTION ||
              en->getType() == ExecutionNode::INDEX_RANGE ||
              en->getType() == ExecutionNode::ENUMERATE_LIST ||
+             en->getType() == ExecutionNode::TRAVERSAL ||
+             en->getType() == ExecutionNode::SHORTEST_PATH ||
+             en->getType() == ExecutionNode::HASH_JOIN ||
              en->getType() == ExecutionNode::AGGREGATE) {
       depth += 1;
     }
@@ -3248,7 +3615,8 @@ GatherNode::GatherNode (ExecutionPlan* plan,
   : ExecutionNode(plan, base),
     _elements(elements),
     _vocbase(plan->getAst()->query()->vocbase()),
-    _collection(plan->getAst()->query()->collections()->get(JsonHelper::checkAndGetStringValue(base.json(), "collection"))) {
+    _collection(plan->getAst()->query()->collections()->get(JsonHelper::checkAndGetStringValue(base.json(), "collection"))),
+    _parallelism(JsonHelper::getNumericValue<size_t>(base.json(), "parallelism", 0)) {
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -3274,6 +3642,7 @@ void GatherNode::toJsonHelper (triagens::basics::Json& nodes,
     values(element);
   }
   json("elements", values);
+  json("parallelism", triagens::basics::Json(static_cast<double>(_parallelism)));
 
   // And add it:
   nodes(json);
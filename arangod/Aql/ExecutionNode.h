@@ -43,6 +43,7 @@
 #include "Aql/WalkerWorker.h"
 #include "Basics/JsonHelper.h"
 #include "lib/Basics/json-utilities.h"
+#include "VocBase/edge-collection.h"
 #include "VocBase/voc-types.h"
 #include "VocBase/vocbase.h"
 
@@ -101,7 +102,10 @@ namespace triagens {
           RETURN                  = 18,
           NORESULTS               = 19,
           DISTRIBUTE              = 20,
-          UPSERT                  = 21
+          UPSERT                  = 21,
+          TRAVERSAL               = 22,
+          SHORTEST_PATH           = 23,
+          HASH_JOIN               = 24
         };
 
 // -----------------------------------------------------------------------------
@@ -1013,6 +1017,14 @@ namespace triagens {
           _random = true;
         }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief whether or not the documents are iterated in random order
+////////////////////////////////////////////////////////////////////////////////
+
+        bool random () const {
+          return _random;
+        }
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief return the database
 ////////////////////////////////////////////////////////////////////////////////
@@ -1177,6 +1189,331 @@ namespace triagens {
 
     };
 
+// -----------------------------------------------------------------------------
+// --SECTION--                                               class TraversalNode
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief class TraversalNode, produces the neighbors of a start vertex
+/// within a depth range, one vertex per row
+////////////////////////////////////////////////////////////////////////////////
+
+    class TraversalNode : public ExecutionNode {
+      
+      friend class ExecutionNode;
+      friend class ExecutionBlock;
+      friend class TraversalBlock;
+      friend class RedundantCalculationsReplacer;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief constructor
+////////////////////////////////////////////////////////////////////////////////
+
+      public:
+
+        TraversalNode (ExecutionPlan* plan,
+                       size_t id,
+                       std::string const& vertexCollection,
+                       std::string const& edgeCollection,
+                       Variable const* inVariable,
+                       Variable const* outVariable,
+                       TRI_edge_direction_e direction,
+                       uint64_t minDepth,
+                       uint64_t maxDepth,
+                       triagens::basics::Json const& edgeExamples,
+                       bool includeData) 
+          : ExecutionNode(plan, id), 
+            _vertexCollection(vertexCollection),
+            _edgeCollection(edgeCollection),
+            _inVariable(inVariable), 
+            _outVariable(outVariable),
+            _direction(direction),
+            _minDepth(minDepth),
+            _maxDepth(maxDepth),
+            _edgeExamples(edgeExamples.copy()),
+            _includeData(includeData) {
+
+          TRI_ASSERT(_inVariable != nullptr);
+          TRI_ASSERT(_outVariable != nullptr);
+        }
+        
+        TraversalNode (ExecutionPlan*, triagens::basics::Json const& base);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief return the type of the node
+////////////////////////////////////////////////////////////////////////////////
+
+        NodeType getType () const override final {
+          return TRAVERSAL;
+        }
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief export to JSON
+////////////////////////////////////////////////////////////////////////////////
+
+        void toJsonHelper (triagens::basics::Json&,
+                           TRI_memory_zone_t*,
+                           bool) const override final;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief clone ExecutionNode recursively
+////////////////////////////////////////////////////////////////////////////////
+
+        ExecutionNode* clone (ExecutionPlan* plan,
+                              bool withDependencies,
+                              bool withProperties) const override final;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief the cost of a traversal node
+////////////////////////////////////////////////////////////////////////////////
+        
+        double estimateCost (size_t&) const override final;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief getVariablesUsedHere, returning a vector
+////////////////////////////////////////////////////////////////////////////////
+
+        std::vector<Variable const*> getVariablesUsedHere () const override final {
+          return std::vector<Variable const*>{ _inVariable };
+        }
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief getVariablesUsedHere, modifying the set in-place
+////////////////////////////////////////////////////////////////////////////////
+
+        void getVariablesUsedHere (std::unordered_set<Variable const*>& vars) const override final {
+          vars.emplace(_inVariable);
+        }
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief getVariablesSetHere
+////////////////////////////////////////////////////////////////////////////////
+
+        std::vector<Variable const*> getVariablesSetHere () const override final {
+          return std::vector<Variable const*>{ _outVariable };
+        }
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                 private variables
+// -----------------------------------------------------------------------------
+
+      private:
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief name of the vertex collection
+////////////////////////////////////////////////////////////////////////////////
+
+        std::string const _vertexCollection;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief name of the edge collection
+////////////////////////////////////////////////////////////////////////////////
+
+        std::string const _edgeCollection;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief input variable, containing the start vertex
+////////////////////////////////////////////////////////////////////////////////
+
+        Variable const* _inVariable;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief output variable to write the neighbors to
+////////////////////////////////////////////////////////////////////////////////
+
+        Variable const* _outVariable;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief direction in which edges are followed
+////////////////////////////////////////////////////////////////////////////////
+
+        TRI_edge_direction_e _direction;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief minimum depth of neighbors to produce
+////////////////////////////////////////////////////////////////////////////////
+
+        uint64_t _minDepth;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief maximum depth of neighbors to produce
+////////////////////////////////////////////////////////////////////////////////
+
+        uint64_t _maxDepth;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief edge examples to filter on. empty if all edges are followed
+////////////////////////////////////////////////////////////////////////////////
+
+        triagens::basics::Json _edgeExamples;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief whether or not to produce vertex documents instead of ids
+////////////////////////////////////////////////////////////////////////////////
+
+        bool _includeData;
+
+    };
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                            class ShortestPathNode
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief class ShortestPathNode, produces the vertices or the edges on the
+/// shortest path between two vertices, one per row, in path order
+////////////////////////////////////////////////////////////////////////////////
+
+    class ShortestPathNode : public ExecutionNode {
+      
+      friend class ExecutionNode;
+      friend class ExecutionBlock;
+      friend class ShortestPathBlock;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief constructor
+////////////////////////////////////////////////////////////////////////////////
+
+      public:
+
+        ShortestPathNode (ExecutionPlan* plan,
+                          size_t id,
+                          std::string const& vertexCollection,
+                          std::string const& edgeCollection,
+                          Variable const* startVariable,
+                          Variable const* targetVariable,
+                          Variable const* outVariable,
+                          std::string const& direction,
+                          bool produceEdges,
+                          bool includeData) 
+          : ExecutionNode(plan, id), 
+            _vertexCollection(vertexCollection),
+            _edgeCollection(edgeCollection),
+            _startVariable(startVariable), 
+            _targetVariable(targetVariable), 
+            _outVariable(outVariable),
+            _direction(direction),
+            _produceEdges(produceEdges),
+            _includeData(includeData) {
+
+          TRI_ASSERT(_startVariable != nullptr);
+          TRI_ASSERT(_targetVariable != nullptr);
+          TRI_ASSERT(_outVariable != nullptr);
+        }
+        
+        ShortestPathNode (ExecutionPlan*, triagens::basics::Json const& base);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief return the type of the node
+////////////////////////////////////////////////////////////////////////////////
+
+        NodeType getType () const override final {
+          return SHORTEST_PATH;
+        }
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief export to JSON
+////////////////////////////////////////////////////////////////////////////////
+
+        void toJsonHelper (triagens::basics::Json&,
+                           TRI_memory_zone_t*,
+                           bool) const override final;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief clone ExecutionNode recursively
+////////////////////////////////////////////////////////////////////////////////
+
+        ExecutionNode* clone (ExecutionPlan* plan,
+                              bool withDependencies,
+                              bool withProperties) const override final;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief the cost of a shortest path node
+////////////////////////////////////////////////////////////////////////////////
+        
+        double estimateCost (size_t&) const override final;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief getVariablesUsedHere, returning a vector
+////////////////////////////////////////////////////////////////////////////////
+
+        std::vector<Variable const*> getVariablesUsedHere () const override final {
+          return std::vector<Variable const*>{ _startVariable, _targetVariable };
+        }
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief getVariablesUsedHere, modifying the set in-place
+////////////////////////////////////////////////////////////////////////////////
+
+        void getVariablesUsedHere (std::unordered_set<Variable const*>& vars) const override final {
+          vars.emplace(_startVariable);
+          vars.emplace(_targetVariable);
+        }
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief getVariablesSetHere
+////////////////////////////////////////////////////////////////////////////////
+
+        std::vector<Variable const*> getVariablesSetHere () const override final {
+          return std::vector<Variable const*>{ _outVariable };
+        }
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                 private variables
+// -----------------------------------------------------------------------------
+
+      private:
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief name of the vertex collection
+////////////////////////////////////////////////////////////////////////////////
+
+        std::string const _vertexCollection;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief name of the edge collection
+////////////////////////////////////////////////////////////////////////////////
+
+        std::string const _edgeCollection;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief input variable, containing the start vertex
+////////////////////////////////////////////////////////////////////////////////
+
+        Variable const* _startVariable;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief input variable, containing the target vertex
+////////////////////////////////////////////////////////////////////////////////
+
+        Variable const* _targetVariable;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief output variable to write the path elements to
+////////////////////////////////////////////////////////////////////////////////
+
+        Variable const* _outVariable;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief direction in which edges are followed
+////////////////////////////////////////////////////////////////////////////////
+
+        std::string const _direction;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief whether the edges of the path are produced instead of its vertices
+////////////////////////////////////////////////////////////////////////////////
+
+        bool _produceEdges;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief whether or not to produce documents instead of ids
+////////////////////////////////////////////////////////////////////////////////
+
+        bool _includeData;
+
+    };
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief class IndexRangeNode
 ////////////////////////////////////////////////////////////////////////////////
@@ -1383,6 +1720,171 @@ namespace triagens {
         bool _reverse;
     };
 
+// -----------------------------------------------------------------------------
+// --SECTION--                                                class HashJoinNode
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief class HashJoinNode, enumerates the documents of a collection that
+/// match the join key values of each input row. the documents are read once
+/// into an in-memory hash table keyed by one or more of their attributes,
+/// which is then probed with the key values calculated for the input rows
+////////////////////////////////////////////////////////////////////////////////
+
+    class HashJoinNode : public ExecutionNode {
+      
+      friend class ExecutionNode;
+      friend class ExecutionBlock;
+      friend class HashJoinBlock;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief constructor
+////////////////////////////////////////////////////////////////////////////////
+
+      public:
+
+        HashJoinNode (ExecutionPlan* plan,
+                      size_t id,
+                      TRI_vocbase_t* vocbase, 
+                      Collection* collection,
+                      Variable const* outVariable,
+                      std::vector<Variable const*> const& probeVariables,
+                      std::vector<std::vector<std::string>> const& buildAttributes)
+          : ExecutionNode(plan, id), 
+            _vocbase(vocbase), 
+            _collection(collection),
+            _outVariable(outVariable),
+            _probeVariables(probeVariables),
+            _buildAttributes(buildAttributes) {
+
+          TRI_ASSERT(_vocbase != nullptr);
+          TRI_ASSERT(_collection != nullptr);
+          TRI_ASSERT(_outVariable != nullptr);
+          TRI_ASSERT(! _probeVariables.empty());
+          TRI_ASSERT(_probeVariables.size() == _buildAttributes.size());
+        }
+
+        HashJoinNode (ExecutionPlan*, triagens::basics::Json const& base);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief return the type of the node
+////////////////////////////////////////////////////////////////////////////////
+
+        NodeType getType () const override final {
+          return HASH_JOIN;
+        }
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief export to JSON
+////////////////////////////////////////////////////////////////////////////////
+
+        void toJsonHelper (triagens::basics::Json&,
+                           TRI_memory_zone_t*,
+                           bool) const override final;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief clone ExecutionNode recursively
+////////////////////////////////////////////////////////////////////////////////
+
+        ExecutionNode* clone (ExecutionPlan* plan,
+                              bool withDependencies,
+                              bool withProperties) const override final;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief the cost of a hash join node is the cost of building the hash table
+/// once plus the cost of one lookup per incoming item
+////////////////////////////////////////////////////////////////////////////////
+        
+        double estimateCost (size_t&) const override final;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief getVariablesUsedHere, returning a vector
+////////////////////////////////////////////////////////////////////////////////
+
+        std::vector<Variable const*> getVariablesUsedHere () const override final {
+          return _probeVariables;
+        }
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief getVariablesUsedHere, modifying the set in-place
+////////////////////////////////////////////////////////////////////////////////
+
+        void getVariablesUsedHere (std::unordered_set<Variable const*>& vars) const override final {
+          for (auto const& it : _probeVariables) {
+            vars.emplace(it);
+          }
+        }
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief getVariablesSetHere
+////////////////////////////////////////////////////////////////////////////////
+
+        std::vector<Variable const*> getVariablesSetHere () const override final {
+          return std::vector<Variable const*>{ _outVariable };
+        }
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief return the database
+////////////////////////////////////////////////////////////////////////////////
+
+        TRI_vocbase_t* vocbase () const {
+          return _vocbase;
+        }
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief return the collection
+////////////////////////////////////////////////////////////////////////////////
+
+        Collection const* collection () const {
+          return _collection;
+        }
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief return the out variable
+////////////////////////////////////////////////////////////////////////////////
+
+        Variable const* outVariable () const {
+          return _outVariable;
+        }
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                 private variables
+// -----------------------------------------------------------------------------
+
+      private:
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief the database
+////////////////////////////////////////////////////////////////////////////////
+
+        TRI_vocbase_t* _vocbase;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief the collection the hash table is built from
+////////////////////////////////////////////////////////////////////////////////
+
+        Collection* _collection;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief output variable, containing the matching documents
+////////////////////////////////////////////////////////////////////////////////
+
+        Variable const* _outVariable;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief input variables, containing the join key values of each input row
+////////////////////////////////////////////////////////////////////////////////
+
+        std::vector<Variable const*> _probeVariables;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief the document attributes the hash table is keyed by, one attribute
+/// path per probe variable
+////////////////////////////////////////////////////////////////////////////////
+
+        std::vector<std::vector<std::string>> _buildAttributes;
+    };
+
 // -----------------------------------------------------------------------------
 // --SECTION--                                                   class LimitNode
 // -----------------------------------------------------------------------------
@@ -1473,6 +1975,30 @@ namespace triagens {
           _fullCount = true;
         }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief return the offset value
+////////////////////////////////////////////////////////////////////////////////
+
+        size_t offset () const {
+          return _offset;
+        }
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief return the limit value
+////////////////////////////////////////////////////////////////////////////////
+
+        size_t limit () const {
+          return _limit;
+        }
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief whether or not the node fully counts what it limits
+////////////////////////////////////////////////////////////////////////////////
+
+        bool fullCount () const {
+          return _fullCount;
+        }
+
       private:
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -1991,7 +2517,8 @@ namespace triagens {
                   bool stable) 
           : ExecutionNode(plan, id),
             _elements(elements),
-            _stable(stable) {
+            _stable(stable),
+            _limit(0) {
 
         }
         
@@ -2016,6 +2543,25 @@ namespace triagens {
           return _stable;
         }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief the maximum number of rows the sort needs to produce
+/// (0 = unlimited, i.e. a full sort)
+////////////////////////////////////////////////////////////////////////////////
+
+        inline size_t limit () const {
+          return _limit;
+        }
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief set the maximum number of rows the sort needs to produce
+/// this turns the sort into a top-k sort that keeps only the first <limit>
+/// rows in memory
+////////////////////////////////////////////////////////////////////////////////
+
+        void setLimit (size_t limit) {
+          _limit = limit;
+        }
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief export to JSON
 ////////////////////////////////////////////////////////////////////////////////
@@ -2032,6 +2578,7 @@ namespace triagens {
                               bool withDependencies,
                               bool withProperties) const override final {
           auto c = new SortNode(plan, _id, _elements, _stable);
+          c->setLimit(_limit);
 
           cloneHelper(c, plan, withDependencies, withProperties);
 
@@ -2112,6 +2659,12 @@ namespace triagens {
 ////////////////////////////////////////////////////////////////////////////////
 
         bool _stable;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief maximum number of rows to produce (0 = unlimited)
+////////////////////////////////////////////////////////////////////////////////
+
+        size_t _limit;
     };
 
 
@@ -3713,10 +4266,12 @@ namespace triagens {
         GatherNode (ExecutionPlan* plan, 
                     size_t id,
                     TRI_vocbase_t* vocbase,
-                    Collection const* collection)
+                    Collection const* collection,
+                    size_t parallelism = 0)
           : ExecutionNode(plan, id),
             _vocbase(vocbase),
-            _collection(collection) {
+            _collection(collection),
+            _parallelism(parallelism) {
         }
 
         GatherNode (ExecutionPlan*,
@@ -3746,7 +4301,7 @@ namespace triagens {
         ExecutionNode* clone (ExecutionPlan* plan,
                               bool withDependencies,
                               bool withProperties) const override final {
-          auto c = new GatherNode(plan, _id, _vocbase, _collection);
+          auto c = new GatherNode(plan, _id, _vocbase, _collection, _parallelism);
 
           cloneHelper(c, plan, withDependencies, withProperties);
 
@@ -3811,6 +4366,15 @@ namespace triagens {
           return _collection;
         }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief return the number of partitions that are scanned in parallel
+/// on the local server, or 0 if the node gathers results from shards
+////////////////////////////////////////////////////////////////////////////////
+
+        size_t parallelism () const {
+          return _parallelism;
+        }
+
       private:
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -3832,6 +4396,12 @@ namespace triagens {
 
         Collection const* _collection;
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief number of partitions of the collection scanned in parallel
+////////////////////////////////////////////////////////////////////////////////
+
+        size_t _parallelism;
+
     };
 
   }   // namespace triagens::aql
@@ -1836,6 +1836,9 @@ bool ExecutionPlan::isDeadSimple () const {
     if (nodeType == ExecutionNode::SUBQUERY ||
         nodeType == ExecutionNode::ENUMERATE_COLLECTION ||
         nodeType == ExecutionNode::ENUMERATE_LIST ||
+        nodeType == ExecutionNode::TRAVERSAL ||
+        nodeType == ExecutionNode::SHORTEST_PATH ||
+        nodeType == ExecutionNode::HASH_JOIN ||
         nodeType == ExecutionNode::INDEX_RANGE) {
       // these node types are not simple
       return false;
@@ -40,10 +40,11 @@ using JsonHelper = triagens::basics::JsonHelper;
 
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief convert the statistics to JSON
+/// the per-node statistics are only included if requested and present
 ////////////////////////////////////////////////////////////////////////////////
 
-Json ExecutionStats::toJson () const {
-  Json json(Json::Object, 5);
+Json ExecutionStats::toJson (bool includeNodes) const {
+  Json json(Json::Object, 7);
   json.set("writesExecuted", Json(static_cast<double>(writesExecuted)));
   json.set("writesIgnored",  Json(static_cast<double>(writesIgnored)));
   json.set("scannedFull",    Json(static_cast<double>(scannedFull)));
@@ -56,6 +57,22 @@ Json ExecutionStats::toJson () const {
     json.set("fullCount",      Json(static_cast<double>(fullCount)));
   }
 
+  if (includeNodes && ! nodes.empty()) {
+    Json jsonNodes(Json::Array, nodes.size());
+
+    for (auto const& it : nodes) {
+      Json jsonNode(Json::Object, 5);
+      jsonNode.set("id",      Json(static_cast<double>(it.first)));
+      jsonNode.set("calls",   Json(static_cast<double>(it.second.calls)));
+      jsonNode.set("items",   Json(static_cast<double>(it.second.items)));
+      jsonNode.set("memory",  Json(static_cast<double>(it.second.memory)));
+      jsonNode.set("runtime", Json(it.second.runtime));
+      jsonNodes.add(jsonNode);
+    }
+
+    json.set("nodes", jsonNodes);
+  }
+
   return json;
 }
 
@@ -78,7 +95,8 @@ ExecutionStats::ExecutionStats()
    scannedFull(0),
    scannedIndex(0),
    filtered(0),
-   fullCount(-1) {
+   fullCount(-1),
+   nodes() {
 }
 
 ExecutionStats::ExecutionStats (triagens::basics::Json const& jsonStats) {
@@ -94,6 +112,23 @@ ExecutionStats::ExecutionStats (triagens::basics::Json const& jsonStats) {
 
   // note: fullCount is an optional attribute!
   fullCount      = JsonHelper::getNumericValue<int64_t>(jsonStats.json(), "fullCount", -1);
+
+  // note: the per-node statistics are optional, too
+  Json jsonNodes = jsonStats.get("nodes");
+
+  if (jsonNodes.isArray()) {
+    size_t const n = jsonNodes.size();
+
+    for (size_t i = 0; i < n; ++i) {
+      Json jsonNode = jsonNodes.at(static_cast<int>(i));
+
+      auto& node = nodes[JsonHelper::checkAndGetNumericValue<size_t>(jsonNode.json(), "id")];
+      node.calls   = JsonHelper::getNumericValue<int64_t>(jsonNode.json(), "calls", 0);
+      node.items   = JsonHelper::getNumericValue<int64_t>(jsonNode.json(), "items", 0);
+      node.memory  = JsonHelper::getNumericValue<int64_t>(jsonNode.json(), "memory", 0);
+      node.runtime = JsonHelper::getNumericValue<double>(jsonNode.json(), "runtime", 0.0);
+    }
+  }
 }
 
 // -----------------------------------------------------------------------------
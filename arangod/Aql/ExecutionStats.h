@@ -36,6 +36,77 @@
 namespace triagens {
   namespace aql {
 
+// -----------------------------------------------------------------------------
+// --SECTION--                                         struct ExecutionNodeStats
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief runtime statistics of a single execution node, only collected for
+/// queries that are profiled
+////////////////////////////////////////////////////////////////////////////////
+
+    struct ExecutionNodeStats {
+
+      ExecutionNodeStats ()
+        : calls(0),
+          items(0),
+          memory(0),
+          runtime(0.0) {
+      }
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief sumarize two sets of ExecutionNodeStats
+////////////////////////////////////////////////////////////////////////////////
+
+      void add (ExecutionNodeStats const& summand) {
+        calls   += summand.calls;
+        items   += summand.items;
+        memory  += summand.memory;
+        runtime += summand.runtime;
+      }
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief sumarize the delta of two other sets of ExecutionNodeStats to us
+////////////////////////////////////////////////////////////////////////////////
+
+      void addDelta (ExecutionNodeStats const& lastStats, ExecutionNodeStats const& newStats) {
+        calls   += newStats.calls   - lastStats.calls;
+        items   += newStats.items   - lastStats.items;
+        memory  += newStats.memory  - lastStats.memory;
+        runtime += newStats.runtime - lastStats.runtime;
+      }
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief number of getSome and skipSome calls
+////////////////////////////////////////////////////////////////////////////////
+
+      int64_t calls;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief number of items produced or skipped
+////////////////////////////////////////////////////////////////////////////////
+
+      int64_t items;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief estimated memory of the AqlItemBlocks produced
+////////////////////////////////////////////////////////////////////////////////
+
+      int64_t memory;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief wall time spent in getSome and skipSome, including the time spent
+/// in the node's dependencies
+////////////////////////////////////////////////////////////////////////////////
+
+      double runtime;
+
+    };
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                             struct ExecutionStats
+// -----------------------------------------------------------------------------
+
     struct ExecutionStats {
 
       ExecutionStats ();
@@ -50,7 +121,7 @@ namespace triagens {
 /// @brief convert the statistics to JSON
 ////////////////////////////////////////////////////////////////////////////////
 
-      triagens::basics::Json toJson () const;
+      triagens::basics::Json toJson (bool = true) const;
 
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief create empty statistics for JSON
@@ -69,6 +140,10 @@ namespace triagens {
         scannedIndex   += summand.scannedIndex;
         fullCount      += summand.fullCount;
         filtered       += summand.filtered;
+
+        for (auto const& it : summand.nodes) {
+          nodes[it.first].add(it.second);
+        }
       }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -82,6 +157,13 @@ namespace triagens {
         scannedIndex   += newStats.scannedIndex   - lastStats.scannedIndex;
         fullCount      += newStats.fullCount      - lastStats.fullCount;
         filtered       += newStats.filtered       - lastStats.filtered;
+
+        ExecutionNodeStats const empty;
+
+        for (auto const& it : newStats.nodes) {
+          auto it2 = lastStats.nodes.find(it.first);
+          nodes[it.first].addDelta(it2 == lastStats.nodes.end() ? empty : (*it2).second, it.second);
+        }
       }
 
 
@@ -121,6 +203,13 @@ namespace triagens {
 
       int64_t fullCount; 
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief runtime statistics per execution node id, only filled for queries 
+/// that are profiled
+////////////////////////////////////////////////////////////////////////////////
+
+      std::map<size_t, ExecutionNodeStats> nodes;
+
     };
 
   }
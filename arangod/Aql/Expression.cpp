@@ -71,6 +71,31 @@ TRI_json_t const Expression::TrueJson  = { TRI_JSON_BOOLEAN, { true } };
 
 TRI_json_t const Expression::FalseJson = { TRI_JSON_BOOLEAN, { false } };
 
+// -----------------------------------------------------------------------------
+// --SECTION--                                                 private functions
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief computes the values that AST nodes determine lazily and cache in
+/// themselves, so that concurrent evaluations only read the nodes
+////////////////////////////////////////////////////////////////////////////////
+
+static void PrepareNodeForConcurrentExecution (AstNode const* node) {
+  size_t const n = node->numMembers();
+
+  for (size_t i = 0; i < n; ++i) {
+    PrepareNodeForConcurrentExecution(node->getMemberUnchecked(i));
+  }
+
+  // determines and caches the constness flags of the node
+  if (node->isConstant() &&
+      (node->type == NODE_TYPE_VALUE ||
+       node->type == NODE_TYPE_ARRAY ||
+       node->type == NODE_TYPE_OBJECT)) {
+    node->computeJson();
+  }
+}
+
 // -----------------------------------------------------------------------------
 // --SECTION--                                        constructors / destructors
 // -----------------------------------------------------------------------------
@@ -104,7 +129,7 @@ Expression::Expression (Ast* ast,
 
 Expression::Expression (Ast* ast,
                         triagens::basics::Json const& json)
-  : Expression(ast, new AstNode(ast, json.get("expression"))) {
+  : Expression(ast, ast->nodeFromPlanJson(json.get("expression"))) {
 
 }
 
@@ -277,6 +302,20 @@ void Expression::invalidate () {
   // expression data will be freed in the destructor
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief prepares the expression for being executed by another thread
+////////////////////////////////////////////////////////////////////////////////
+
+void Expression::prepareConcurrentExecution () {
+  if (! _built) {
+    buildExpression();
+  }
+
+  TRI_ASSERT(_type != V8);
+
+  PrepareNodeForConcurrentExecution(_node);
+}
+
 // -----------------------------------------------------------------------------
 // --SECTION--                                                   private methods
 // -----------------------------------------------------------------------------
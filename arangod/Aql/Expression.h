@@ -290,6 +290,16 @@ namespace triagens {
 
         void invalidate ();
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief prepares the expression for being executed by another thread
+/// this builds the expression and computes the values that the AST nodes
+/// otherwise compute lazily on first use, so that multiple copies of the
+/// expression can be executed concurrently. must not be called for V8
+/// expressions
+////////////////////////////////////////////////////////////////////////////////
+
+        void prepareConcurrentExecution ();
+
         void setVariable (Variable const* variable, TRI_json_t const* value) {
           _variables.emplace(variable, value);
         }
@@ -28,6 +28,8 @@
 ////////////////////////////////////////////////////////////////////////////////
 
 #include "Aql/Functions.h"
+#include "Aql/AqlItemBlock.h"
+#include "Aql/ExecutionBlock.h"
 #include "Aql/Function.h"
 #include "Aql/Query.h"
 #include "Basics/Exceptions.h"
@@ -37,6 +39,11 @@
 #include "Basics/ScopeGuard.h"
 #include "Basics/StringBuffer.h"
 #include "Basics/Utf8Helper.h"
+#include "FulltextIndex/fulltext-index.h"
+#include "FulltextIndex/fulltext-query.h"
+#include "FulltextIndex/fulltext-result.h"
+#include "Indexes/FulltextIndex.h"
+#include "Indexes/GeoIndex2.h"
 #include "Rest/SslInterface.h"
 #include "V8Server/V8Traverser.h"
 #include "VocBase/KeyGenerator.h"
@@ -772,1179 +779,3205 @@ AqlValue Functions::Like (triagens::aql::Query* query,
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-/// @brief function PASSTHRU
+/// @brief convert a value into a UTF-16 string, using the same rules as
+/// AQL's TO_STRING. all string functions operate on UTF-16 code units, so
+/// lengths and positions are the same as in the JavaScript implementation
 ////////////////////////////////////////////////////////////////////////////////
 
-AqlValue Functions::Passthru (triagens::aql::Query*,
-                              triagens::arango::AqlTransaction* trx,
-                              FunctionParameters const& parameters) {
-
-  if (parameters.empty()) {
-    return AqlValue(new Json(Json::Null));
+static UnicodeString ValueToUnicodeString (TRI_json_t const* json) {
+  if (TRI_IsStringJson(json)) {
+    return UnicodeString::fromUTF8(StringPiece(json->_value._string.data, 
+                                               static_cast<int32_t>(json->_value._string.length - 1)));
   }
 
-  auto json = ExtractFunctionParameter(trx, parameters, 0, true);
-  return AqlValue(new Json(TRI_UNKNOWN_MEM_ZONE, json.steal()));
+  triagens::basics::StringBuffer buffer(TRI_UNKNOWN_MEM_ZONE, 24);
+  AppendAsString(buffer, json);
+
+  return UnicodeString::fromUTF8(StringPiece(buffer.c_str(), static_cast<int32_t>(buffer.length())));
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-/// @brief function UNSET
+/// @brief convert a UTF-16 string into a UTF-8 JSON string
 ////////////////////////////////////////////////////////////////////////////////
 
-AqlValue Functions::Unset (triagens::aql::Query* query,
-                           triagens::arango::AqlTransaction* trx,
-                           FunctionParameters const& parameters) {
-  auto value = ExtractFunctionParameter(trx, parameters, 0, false);
-
-  if (! value.isObject()) {
-    RegisterInvalidArgumentWarning(query, "UNSET");
-    return AqlValue(new Json(Json::Null));
-  }
- 
-  std::unordered_set<std::string> names;
-  ExtractKeys(names, query, trx, parameters, 1, "UNSET");
+static Json UnicodeStringToJson (UnicodeString const& value) {
+  std::string result;
+  value.toUTF8String(result);
 
+  return Json(TRI_UNKNOWN_MEM_ZONE, result);
+}
 
-  // create result object
-  TRI_json_t const* valueJson = value.json();
-  size_t const n = TRI_LengthVector(&valueJson->_value._objects);
+////////////////////////////////////////////////////////////////////////////////
+/// @brief extract a numeric function parameter. values that cannot be 
+/// converted to a number are treated as 0
+////////////////////////////////////////////////////////////////////////////////
 
-  size_t size;
-  if (names.size() >= n / 2) {
-    size = 4; 
-  }
-  else {
-    size = (n / 2) - names.size(); 
-  }
+static double ExtractNumericParameter (triagens::arango::AqlTransaction* trx,
+                                       FunctionParameters const& parameters,
+                                       size_t position) {
+  auto const value = ExtractFunctionParameter(trx, parameters, position, false);
 
-  std::unique_ptr<TRI_json_t> j(TRI_CreateObjectJson(TRI_UNKNOWN_MEM_ZONE, size));
+  bool isValid;
+  double const result = ValueToNumber(value.json(), isValid);
 
-  if (j == nullptr) {
-    THROW_ARANGO_EXCEPTION(TRI_ERROR_OUT_OF_MEMORY);
+  if (! isValid || std::isnan(result)) {
+    return 0.0;
   }
+  return result;
+}
 
-  for (size_t i = 0; i < n; i += 2) {
-    auto key = static_cast<TRI_json_t const*>(TRI_AtVector(&valueJson->_value._objects, i));
-    auto value = static_cast<TRI_json_t const*>(TRI_AtVector(&valueJson->_value._objects, i + 1));
-
-    if (TRI_IsStringJson(key) && 
-        names.find(key->_value._string.data) == names.end()) {
-      auto copy = TRI_CopyJson(TRI_UNKNOWN_MEM_ZONE, value);
-
-      if (copy == nullptr) {
-        THROW_ARANGO_EXCEPTION(TRI_ERROR_OUT_OF_MEMORY);
-      } 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief whether or not a function parameter is present and not null
+////////////////////////////////////////////////////////////////////////////////
 
-      TRI_Insert3ObjectJson(TRI_UNKNOWN_MEM_ZONE, j.get(), key->_value._string.data, copy);
-    }
-  } 
+static bool HasNonNullParameter (triagens::arango::AqlTransaction* trx,
+                                 FunctionParameters const& parameters,
+                                 size_t position) {
+  if (position >= parameters.size()) {
+    return false;
+  }
 
-  auto jr = new Json(TRI_UNKNOWN_MEM_ZONE, j.get());
-  j.release();
-  return AqlValue(jr);
+  auto const value = ExtractFunctionParameter(trx, parameters, position, false);
+  return (! value.isEmpty() && ! value.isNull());
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-/// @brief function KEEP
+/// @brief return a part of a UTF-16 string. the semantics are the same as
+/// for JavaScript's String.prototype.substr: negative start positions are
+/// counted from the end of the string, and the length is clamped
 ////////////////////////////////////////////////////////////////////////////////
 
-AqlValue Functions::Keep (triagens::aql::Query* query,
-                          triagens::arango::AqlTransaction* trx,
-                          FunctionParameters const& parameters) {
-  auto value = ExtractFunctionParameter(trx, parameters, 0, false);
+static UnicodeString UnicodeSubstring (UnicodeString const& value,
+                                       double start,
+                                       double length = HUGE_VAL) {
+  double const n = static_cast<double>(value.length());
 
-  if (! value.isObject()) {
-    RegisterInvalidArgumentWarning(query, "KEEP");
-    return AqlValue(new Json(Json::Null));
+  start = std::trunc(start);
+  if (start < 0.0) {
+    start = (std::max)(n + start, 0.0);
   }
- 
-  std::unordered_set<std::string> names;
-  ExtractKeys(names, query, trx, parameters, 1, "KEEP");
-
-
-  // create result object
-  std::unique_ptr<TRI_json_t> j(TRI_CreateObjectJson(TRI_UNKNOWN_MEM_ZONE, names.size()));
-
-  if (j == nullptr) {
-    THROW_ARANGO_EXCEPTION(TRI_ERROR_OUT_OF_MEMORY);
+  else {
+    start = (std::min)(start, n);
   }
 
-  TRI_json_t const* valueJson = value.json();
-  size_t const n = TRI_LengthVector(&valueJson->_value._objects);
-
-  for (size_t i = 0; i < n; i += 2) {
-    auto key = static_cast<TRI_json_t const*>(TRI_AtVector(&valueJson->_value._objects, i));
-    auto value = static_cast<TRI_json_t const*>(TRI_AtVector(&valueJson->_value._objects, i + 1));
-
-    if (TRI_IsStringJson(key) && 
-        names.find(key->_value._string.data) != names.end()) {
-      auto copy = TRI_CopyJson(TRI_UNKNOWN_MEM_ZONE, value);
-
-      if (copy == nullptr) {
-        THROW_ARANGO_EXCEPTION(TRI_ERROR_OUT_OF_MEMORY);
-      } 
-
-      TRI_Insert3ObjectJson(TRI_UNKNOWN_MEM_ZONE, j.get(), key->_value._string.data, copy);
-    }
-  } 
+  length = (std::min)((std::max)(std::trunc(length), 0.0), n - start);
 
-  auto jr = new Json(TRI_UNKNOWN_MEM_ZONE, j.get());
-  j.release();
-  return AqlValue(jr);
+  return UnicodeString(value, static_cast<int32_t>(start), static_cast<int32_t>(length));
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-/// @brief function MERGE
+/// @brief whether or not a character is whitespace, as defined by 
+/// JavaScript's \s character class
 ////////////////////////////////////////////////////////////////////////////////
 
-AqlValue Functions::Merge (triagens::aql::Query* query,
-                           triagens::arango::AqlTransaction* trx,
-                           FunctionParameters const& parameters) {
-  size_t const n = parameters.size();
-
-  if (n == 0) {
-    // no parameters
-    return AqlValue(new Json(Json::Object));
+static bool IsWhitespace (UChar c) {
+  switch (c) {
+    case 0x0009: 
+    case 0x000a: 
+    case 0x000b: 
+    case 0x000c: 
+    case 0x000d: 
+    case 0x0020: 
+    case 0x00a0: 
+    case 0x1680:
+    case 0x2028:
+    case 0x2029:
+    case 0x202f:
+    case 0x205f:
+    case 0x3000:
+    case 0xfeff:
+      return true;
   }
 
-  // use the first argument as the preliminary result
-  auto initial = ExtractFunctionParameter(trx, parameters, 0, true);
-
-  if (! initial.isObject()) {
-    RegisterInvalidArgumentWarning(query, "MERGE");
-    return AqlValue(new Json(Json::Null));
-  }
+  return (c >= 0x2000 && c <= 0x200a);
+}
 
-  std::unique_ptr<TRI_json_t> result(initial.steal());
+////////////////////////////////////////////////////////////////////////////////
+/// @brief remove characters from the start and/or the end of a string. if
+/// chars is a nullptr, whitespace is removed
+////////////////////////////////////////////////////////////////////////////////
 
-  // now merge in all other arguments
-  for (size_t i = 1; i < n; ++i) {
-    auto param = ExtractFunctionParameter(trx, parameters, i, false);
+static UnicodeString TrimString (UnicodeString const& value,
+                                 UnicodeString const* chars,
+                                 bool left,
+                                 bool right) {
+  int32_t start = 0;
+  int32_t end = value.length();
 
-    if (! param.isObject()) {
-      RegisterInvalidArgumentWarning(query, "MERGE");
-      return AqlValue(new Json(Json::Null));
+  auto const isTrimmed = [&chars] (UChar c) -> bool {
+    if (chars == nullptr) {
+      return IsWhitespace(c);
     }
- 
-    auto merged = TRI_MergeJson(TRI_UNKNOWN_MEM_ZONE, result.get(), param.json(), false, true);
+    return (chars->indexOf(c) >= 0);
+  };
 
-    if (merged == nullptr) {
-      THROW_ARANGO_EXCEPTION(TRI_ERROR_OUT_OF_MEMORY);
+  if (left) {
+    while (start < end && isTrimmed(value.charAt(start))) {
+      ++start;
     }
+  }
 
-    result.reset(merged);
-  } 
+  if (right) {
+    while (end > start && isTrimmed(value.charAt(end - 1))) {
+      --end;
+    }
+  }
 
-  auto jr = new Json(TRI_UNKNOWN_MEM_ZONE, result.get());
-  result.release();
-  return AqlValue(jr);
+  return UnicodeString(value, start, end - start);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-/// @brief function HAS
+/// @brief check if one of the search strings matches at the given position.
+/// the search strings are tried in order, so the first one that matches wins
+/// even if a later one would produce a longer match. this is the behavior of
+/// a regex alternation, which the JavaScript implementation used. returns the
+/// position after the match, or -1 if there is no match. which is set to the
+/// index of the matching search string
 ////////////////////////////////////////////////////////////////////////////////
 
-AqlValue Functions::Has (triagens::aql::Query* query,
-                         triagens::arango::AqlTransaction* trx,
-                         FunctionParameters const& parameters) {
-  size_t const n = parameters.size();
+static int32_t MatchSearchStrings (UnicodeString const& value,
+                                   int32_t position,
+                                   std::vector<UnicodeString> const& searches,
+                                   size_t& which) {
+  int32_t const n = value.length();
 
-  if (n < 2) {
-    // no parameters
-    return AqlValue(new Json(false));
-  }
-    
-  auto value = ExtractFunctionParameter(trx, parameters, 0, false);
+  for (size_t i = 0; i < searches.size(); ++i) {
+    int32_t const length = searches[i].length();
 
-  if (! value.isObject()) {
-    // not an object
-    return AqlValue(new Json(false));
+    if (position + length <= n &&
+        value.compare(position, length, searches[i]) == 0) {
+      which = i;
+      return position + length;
+    }
   }
- 
-  // process name parameter 
-  auto name = ExtractFunctionParameter(trx, parameters, 1, false);
-
-  char const* p;
 
-  if (! name.isString()) {
-    triagens::basics::StringBuffer buffer(TRI_UNKNOWN_MEM_ZONE);
-    AppendAsString(buffer, name.json());
-    p = buffer.c_str();
-  }
-  else {
-    p = name.json()->_value._string.data;
-  }
- 
-  bool const hasAttribute = (TRI_LookupObjectJson(value.json(), p) != nullptr);
-  return AqlValue(new Json(hasAttribute));
+  return -1;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-/// @brief function ATTRIBUTES
+/// @brief split a string at each occurrence of one of the search strings,
+/// with the semantics of JavaScript's String.prototype.split
 ////////////////////////////////////////////////////////////////////////////////
 
-AqlValue Functions::Attributes (triagens::aql::Query* query,
-                                triagens::arango::AqlTransaction* trx,
-                                FunctionParameters const& parameters) {
-  size_t const n = parameters.size();
-
-  if (n < 1) {
-    // no parameters
-    return AqlValue(new Json(Json::Null));
-  }
-    
-  auto value = ExtractFunctionParameter(trx, parameters, 0, false);
+static Json SplitString (UnicodeString const& value,
+                         std::vector<UnicodeString> const& separators,
+                         double limit) {
+  Json result(Json::Array);
 
-  if (! value.isObject()) {
-    // not an object
-    RegisterWarning(query, "ATTRIBUTES", TRI_ERROR_QUERY_FUNCTION_ARGUMENT_TYPE_MISMATCH);
-    return AqlValue(new Json(Json::Null));
+  if (limit <= 0.0) {
+    return result;
   }
- 
-  bool const removeInternal = GetBooleanParameter(trx, parameters, 1, false);
-  bool const doSort = GetBooleanParameter(trx, parameters, 2, false);
-
-  auto const valueJson = value.json();
-  TRI_ASSERT(TRI_IsObjectJson(valueJson));
 
-  size_t const numValues = TRI_LengthVectorJson(valueJson);
+  int32_t const n = value.length();
+  size_t which;
 
-  if (numValues == 0) {
-    // empty object
-    return AqlValue(new Json(Json::Object));
+  if (n == 0) {
+    if (MatchSearchStrings(value, 0, separators, which) == -1) {
+      result.add(UnicodeStringToJson(value));
+    }
+    return result;
   }
 
-  std::vector<std::pair<char const*, size_t>> sortPositions;
-  sortPositions.reserve(numValues / 2);
+  int32_t p = 0;
+  int32_t q = 0;
 
-  // create a vector with positions into the object
-  for (size_t i = 0; i < numValues; i += 2) {
-    auto key = static_cast<TRI_json_t const*>(TRI_AddressVector(&valueJson->_value._objects, i));
+  while (q < n) {
+    int32_t const e = MatchSearchStrings(value, q, separators, which);
 
-    if (! TRI_IsStringJson(key)) {
-      // somehow invalid
+    if (e == -1 || e == p) {
+      // no match, or an empty match at the start of the current part
+      ++q;
       continue;
     }
 
-    if (removeInternal && *key->_value._string.data == '_') {
-      // skip attribute
-      continue;
+    result.add(UnicodeStringToJson(UnicodeString(value, p, q - p)));
+
+    if (static_cast<double>(result.size()) >= limit) {
+      return result;
     }
 
-    sortPositions.emplace_back(std::make_pair(key->_value._string.data, i));
+    p = e;
+    q = p;
   }
 
-  if (doSort) {
-    // sort according to attribute name
-    std::sort(sortPositions.begin(), sortPositions.end(), [] (std::pair<char const*, size_t> const& lhs,
-                                                              std::pair<char const*, size_t> const& rhs) -> bool {
-      return TRI_compare_utf8(lhs.first, rhs.first) < 0;
-    });
-  }
+  result.add(UnicodeStringToJson(UnicodeString(value, p, n - p)));
 
-  // create the output
-  Json result(Json::Array, sortPositions.size());
+  return result;
+}
 
-  // iterate over either sorted or unsorted object 
-  for (auto const& it : sortPositions) {
-    auto key = static_cast<TRI_json_t const*>(TRI_AddressVector(&valueJson->_value._objects, it.second));
+////////////////////////////////////////////////////////////////////////////////
+/// @brief shared implementation of the TRIM, LTRIM and RTRIM functions. the
+/// characters to remove are taken from the second parameter if it is set,
+/// otherwise whitespace is removed
+////////////////////////////////////////////////////////////////////////////////
 
-    result.add(Json(std::string(key->_value._string.data, key->_value._string.length - 1)));
-  } 
+static AqlValue TrimFunction (triagens::arango::AqlTransaction* trx,
+                              FunctionParameters const& parameters,
+                              bool useChars,
+                              bool left,
+                              bool right) {
+  auto const value = ExtractFunctionParameter(trx, parameters, 0, false);
+  UnicodeString const source = ValueToUnicodeString(value.json());
 
-  return AqlValue(new Json(TRI_UNKNOWN_MEM_ZONE, result.steal()));
+  if (! useChars || ! HasNonNullParameter(trx, parameters, 1)) {
+    return AqlValue(new Json(UnicodeStringToJson(TrimString(source, nullptr, left, right))));
+  }
+
+  auto const charsParameter = ExtractFunctionParameter(trx, parameters, 1, false);
+  UnicodeString const chars = ValueToUnicodeString(charsParameter.json());
+
+  return AqlValue(new Json(UnicodeStringToJson(TrimString(source, &chars, left, right))));
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-/// @brief function VALUES
+/// @brief function CONCAT_SEPARATOR
 ////////////////////////////////////////////////////////////////////////////////
 
-AqlValue Functions::Values (triagens::aql::Query* query,
-                            triagens::arango::AqlTransaction* trx,
-                            FunctionParameters const& parameters) {
+AqlValue Functions::ConcatSeparator (triagens::aql::Query*,
+                                     triagens::arango::AqlTransaction* trx,
+                                     FunctionParameters const& parameters) {
+  triagens::basics::StringBuffer separator(TRI_UNKNOWN_MEM_ZONE, 24);
+  triagens::basics::StringBuffer buffer(TRI_UNKNOWN_MEM_ZONE, 24);
+
   size_t const n = parameters.size();
+  bool found = false;
 
-  if (n < 1) {
-    // no parameters
-    return AqlValue(new Json(Json::Null));
-  }
+  for (size_t i = 0; i < n; ++i) {
+    auto const member = ExtractFunctionParameter(trx, parameters, i, false);
+    TRI_json_t const* json = member.json();
     
-  auto value = ExtractFunctionParameter(trx, parameters, 0, false);
+    if (i == 0) {
+      AppendAsString(separator, json);
+      continue;
+    }
 
-  if (! value.isObject()) {
-    // not an object
-    RegisterWarning(query, "ATTRIBUTES", TRI_ERROR_QUERY_FUNCTION_ARGUMENT_TYPE_MISMATCH);
-    return AqlValue(new Json(Json::Null));
-  }
- 
-  bool const removeInternal = GetBooleanParameter(trx, parameters, 1, false);
-
-  auto const valueJson = value.json();
-  TRI_ASSERT(TRI_IsObjectJson(valueJson));
-
-  size_t const numValues = TRI_LengthVectorJson(valueJson);
+    if (member.isEmpty() || member.isNull()) {
+      continue;
+    }
+    
+    if (found) {
+      buffer.appendText(separator.c_str(), separator.length());
+    }
+    
+    if (member.isArray()) {
+      // append each member individually
+      size_t const subLength = TRI_LengthArrayJson(json);
+      found = false;
 
-  if (numValues == 0) {
-    // empty object
-    return AqlValue(new Json(Json::Object));
-  }
+      for (size_t j = 0; j < subLength; ++j) {
+        auto sub = static_cast<TRI_json_t const*>(TRI_AtVector(&json->_value._objects, j));
 
-  // create the output
-  Json result(Json::Array, numValues);
+        if (sub == nullptr || sub->_type == TRI_JSON_NULL) {
+          continue;
+        }
 
-  // create a vector with positions into the object
-  for (size_t i = 0; i < numValues; i += 2) {
-    auto key = static_cast<TRI_json_t const*>(TRI_AddressVector(&valueJson->_value._objects, i));
+        if (found) {
+          buffer.appendText(separator.c_str(), separator.length());
+        }
 
-    if (! TRI_IsStringJson(key)) {
-      // somehow invalid
-      continue;
+        AppendAsString(buffer, sub);
+        found = true;
+      }
     }
-
-    if (removeInternal && *key->_value._string.data == '_') {
-      // skip attribute
-      continue;
+    else {
+      // convert member to a string and append
+      AppendAsString(buffer, json);
+      found = true;
     }
-
-    auto value = static_cast<TRI_json_t const*>(TRI_AddressVector(&valueJson->_value._objects, i + 1));
-    result.add(Json(TRI_UNKNOWN_MEM_ZONE, TRI_CopyJson(TRI_UNKNOWN_MEM_ZONE, value)));
   }
+  
+  size_t length = buffer.length();
+  std::unique_ptr<TRI_json_t> j(TRI_CreateStringJson(TRI_UNKNOWN_MEM_ZONE, buffer.steal(), length));
 
-  return AqlValue(new Json(TRI_UNKNOWN_MEM_ZONE, result.steal()));
+  auto jr = new Json(TRI_UNKNOWN_MEM_ZONE, j.get());
+  j.release();
+  return AqlValue(jr);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-/// @brief function MIN
+/// @brief function CHAR_LENGTH
 ////////////////////////////////////////////////////////////////////////////////
 
-AqlValue Functions::Min (triagens::aql::Query* query,
-                         triagens::arango::AqlTransaction* trx,
-                         FunctionParameters const& parameters) {
-  auto value = ExtractFunctionParameter(trx, parameters, 0, false);
-
-  if (! value.isArray()) {
-    // not an array
-    RegisterWarning(query, "MIN", TRI_ERROR_QUERY_ARRAY_EXPECTED);
-    return AqlValue(new Json(Json::Null));
-  }
-
-  TRI_json_t const* valueJson = value.json();
-  size_t const n = TRI_LengthArrayJson(valueJson);
-  TRI_json_t const* minValue = nullptr;;
+AqlValue Functions::CharLength (triagens::aql::Query*,
+                                triagens::arango::AqlTransaction* trx,
+                                FunctionParameters const& parameters) {
+  auto const value = ExtractFunctionParameter(trx, parameters, 0, false);
+  TRI_json_t const* json = value.json();
 
-  for (size_t i = 0; i < n; ++i) {
-    auto value = static_cast<TRI_json_t const*>(TRI_AtVector(&valueJson->_value._objects, i));
+  if (TRI_IsStringJson(json)) {
+    // count UTF-16 code units without creating a copy of the string
+    char const* p = json->_value._string.data;
+    char const* end = p + json->_value._string.length - 1;
+    size_t length = 0;
 
-    if (TRI_IsNullJson(value)) {
-      continue;
-    }
+    while (p < end) {
+      unsigned char c = static_cast<unsigned char>(*p);
 
-    if (minValue == nullptr ||
-        TRI_CompareValuesJson(value, minValue) < 0) {
-      minValue = value;
+      if (c < 0x80) {
+        ++p;
+        ++length;
+      }
+      else if (c >= 0xf0) {
+        // four-byte sequences are encoded as surrogate pairs in UTF-16
+        p += 4;
+        length += 2;
+      }
+      else if (c >= 0xe0) {
+        p += 3;
+        ++length;
+      }
+      else if (c >= 0xc0) {
+        p += 2;
+        ++length;
+      }
+      else {
+        // stray continuation byte
+        ++p;
+        ++length;
+      }
     }
-  } 
 
-  if (minValue != nullptr) {
-    std::unique_ptr<TRI_json_t> result(TRI_CopyJson(TRI_UNKNOWN_MEM_ZONE, minValue));
-    
-    if (result != nullptr) {
-      auto jr = new Json(TRI_UNKNOWN_MEM_ZONE, result.get());
-      result.release();
-      return AqlValue(jr);
-    }
+    return AqlValue(new Json(static_cast<double>(length)));
   }
 
-  return AqlValue(new Json(Json::Null));
+  return AqlValue(new Json(static_cast<double>(ValueToUnicodeString(json).length())));
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-/// @brief function MAX
+/// @brief function LOWER
 ////////////////////////////////////////////////////////////////////////////////
 
-AqlValue Functions::Max (triagens::aql::Query* query,
-                         triagens::arango::AqlTransaction* trx,
-                         FunctionParameters const& parameters) {
-  auto value = ExtractFunctionParameter(trx, parameters, 0, false);
+AqlValue Functions::Lower (triagens::aql::Query*,
+                           triagens::arango::AqlTransaction* trx,
+                           FunctionParameters const& parameters) {
+  auto const value = ExtractFunctionParameter(trx, parameters, 0, false);
 
-  if (! value.isArray()) {
-    // not an array
-    RegisterWarning(query, "MAX", TRI_ERROR_QUERY_ARRAY_EXPECTED);
-    return AqlValue(new Json(Json::Null));
+  triagens::basics::StringBuffer buffer(TRI_UNKNOWN_MEM_ZONE, 24);
+  AppendAsString(buffer, value.json());
+
+  int32_t length = 0;
+  char* result = triagens::basics::Utf8Helper::DefaultUtf8Helper.tolower(TRI_UNKNOWN_MEM_ZONE, buffer.c_str(), static_cast<int32_t>(buffer.length()), length);
+
+  if (result == nullptr) {
+    THROW_ARANGO_EXCEPTION(TRI_ERROR_OUT_OF_MEMORY);
   }
 
-  TRI_json_t const* valueJson = value.json();
-  size_t const n = TRI_LengthArrayJson(valueJson);
-  TRI_json_t const* maxValue = nullptr;;
+  std::unique_ptr<TRI_json_t> j(TRI_CreateStringJson(TRI_UNKNOWN_MEM_ZONE, result, static_cast<size_t>(length)));
 
-  for (size_t i = 0; i < n; ++i) {
-    auto value = static_cast<TRI_json_t const*>(TRI_AtVector(&valueJson->_value._objects, i));
+  auto jr = new Json(TRI_UNKNOWN_MEM_ZONE, j.get());
+  j.release();
+  return AqlValue(jr);
+}
 
-    if (TRI_IsNullJson(value)) {
-      continue;
-    }
+////////////////////////////////////////////////////////////////////////////////
+/// @brief function UPPER
+////////////////////////////////////////////////////////////////////////////////
 
-    if (maxValue == nullptr ||
-        TRI_CompareValuesJson(value, maxValue) > 0) {
-      maxValue = value;
-    }
-  } 
+AqlValue Functions::Upper (triagens::aql::Query*,
+                           triagens::arango::AqlTransaction* trx,
+                           FunctionParameters const& parameters) {
+  auto const value = ExtractFunctionParameter(trx, parameters, 0, false);
 
-  if (maxValue != nullptr) {
-    std::unique_ptr<TRI_json_t> result(TRI_CopyJson(TRI_UNKNOWN_MEM_ZONE, maxValue));
-    
-    if (result != nullptr) {
-      auto jr = new Json(TRI_UNKNOWN_MEM_ZONE, result.get());
-      result.release();
-      return AqlValue(jr);
-    }
+  triagens::basics::StringBuffer buffer(TRI_UNKNOWN_MEM_ZONE, 24);
+  AppendAsString(buffer, value.json());
+
+  int32_t length = 0;
+  char* result = triagens::basics::Utf8Helper::DefaultUtf8Helper.toupper(TRI_UNKNOWN_MEM_ZONE, buffer.c_str(), static_cast<int32_t>(buffer.length()), length);
+
+  if (result == nullptr) {
+    THROW_ARANGO_EXCEPTION(TRI_ERROR_OUT_OF_MEMORY);
   }
 
-  return AqlValue(new Json(Json::Null));
+  std::unique_ptr<TRI_json_t> j(TRI_CreateStringJson(TRI_UNKNOWN_MEM_ZONE, result, static_cast<size_t>(length)));
+
+  auto jr = new Json(TRI_UNKNOWN_MEM_ZONE, j.get());
+  j.release();
+  return AqlValue(jr);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-/// @brief function SUM
+/// @brief function SUBSTRING
 ////////////////////////////////////////////////////////////////////////////////
 
-AqlValue Functions::Sum (triagens::aql::Query* query,
-                         triagens::arango::AqlTransaction* trx,
-                         FunctionParameters const& parameters) {
-  auto value = ExtractFunctionParameter(trx, parameters, 0, false);
+AqlValue Functions::Substring (triagens::aql::Query*,
+                               triagens::arango::AqlTransaction* trx,
+                               FunctionParameters const& parameters) {
+  auto const value = ExtractFunctionParameter(trx, parameters, 0, false);
+  UnicodeString const source = ValueToUnicodeString(value.json());
 
-  if (! value.isArray()) {
-    // not an array
-    RegisterWarning(query, "SUM", TRI_ERROR_QUERY_ARRAY_EXPECTED);
-    return AqlValue(new Json(Json::Null));
-  }
+  double const offset = ExtractNumericParameter(trx, parameters, 1);
 
-  TRI_json_t const* valueJson = value.json();
-  size_t const n = TRI_LengthArrayJson(valueJson);
-  double sum = 0.0;
+  if (parameters.size() > 2) {
+    double const length = ExtractNumericParameter(trx, parameters, 2);
+    return AqlValue(new Json(UnicodeStringToJson(UnicodeSubstring(source, offset, length))));
+  }
 
-  for (size_t i = 0; i < n; ++i) {
-    auto value = static_cast<TRI_json_t const*>(TRI_AtVector(&valueJson->_value._objects, i));
+  return AqlValue(new Json(UnicodeStringToJson(UnicodeSubstring(source, offset))));
+}
 
-    if (TRI_IsNullJson(value)) {
-      continue;
-    }
+////////////////////////////////////////////////////////////////////////////////
+/// @brief function CONTAINS
+////////////////////////////////////////////////////////////////////////////////
 
-    if (! TRI_IsNumberJson(value)) {
-      RegisterInvalidArgumentWarning(query, "SUM");
-      return AqlValue(new Json(Json::Null));
-    }
+AqlValue Functions::Contains (triagens::aql::Query*,
+                              triagens::arango::AqlTransaction* trx,
+                              FunctionParameters const& parameters) {
+  auto const value = ExtractFunctionParameter(trx, parameters, 0, false);
+  auto const search = ExtractFunctionParameter(trx, parameters, 1, false);
+  bool const returnIndex = GetBooleanParameter(trx, parameters, 2, false);
 
-    // got a numeric value
-    double const number = value->_value._number;
+  UnicodeString const needle = ValueToUnicodeString(search.json());
+  int32_t result = -1;
 
-    if (! std::isnan(number) && number != HUGE_VAL && number != -HUGE_VAL) {
-      sum += number;
-    } 
-  } 
+  if (! needle.isEmpty()) {
+    result = ValueToUnicodeString(value.json()).indexOf(needle);
+  }
 
-  if (! std::isnan(sum) && sum != HUGE_VAL && sum != -HUGE_VAL) {
-    return AqlValue(new Json(sum));
-  } 
+  if (returnIndex) {
+    return AqlValue(new Json(static_cast<double>(result)));
+  }
 
-  return AqlValue(new Json(Json::Null));
+  return AqlValue(new Json(result != -1));
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-/// @brief function AVERAGE
+/// @brief function LEFT
 ////////////////////////////////////////////////////////////////////////////////
 
-AqlValue Functions::Average (triagens::aql::Query* query,
-                             triagens::arango::AqlTransaction* trx,
-                             FunctionParameters const& parameters) {
-  auto value = ExtractFunctionParameter(trx, parameters, 0, false);
+AqlValue Functions::Left (triagens::aql::Query*,
+                          triagens::arango::AqlTransaction* trx,
+                          FunctionParameters const& parameters) {
+  auto const value = ExtractFunctionParameter(trx, parameters, 0, false);
+  double const length = ExtractNumericParameter(trx, parameters, 1);
 
-  if (! value.isArray()) {
-    // not an array
-    RegisterWarning(query, "AVERAGE", TRI_ERROR_QUERY_ARRAY_EXPECTED);
-    return AqlValue(new Json(Json::Null));
-  }
+  return AqlValue(new Json(UnicodeStringToJson(UnicodeSubstring(ValueToUnicodeString(value.json()), 0.0, length))));
+}
 
-  TRI_json_t const* valueJson = value.json();
-  size_t const n = TRI_LengthArrayJson(valueJson);
-  double sum = 0.0;
-  size_t count = 0;
+////////////////////////////////////////////////////////////////////////////////
+/// @brief function RIGHT
+////////////////////////////////////////////////////////////////////////////////
 
-  for (size_t i = 0; i < n; ++i) {
-    auto value = static_cast<TRI_json_t const*>(TRI_AtVector(&valueJson->_value._objects, i));
+AqlValue Functions::Right (triagens::aql::Query*,
+                           triagens::arango::AqlTransaction* trx,
+                           FunctionParameters const& parameters) {
+  auto const value = ExtractFunctionParameter(trx, parameters, 0, false);
+  UnicodeString const source = ValueToUnicodeString(value.json());
+  double const length = ExtractNumericParameter(trx, parameters, 1);
 
-    if (TRI_IsNullJson(value)) {
-      continue;
-    }
+  double const left = (std::max)(static_cast<double>(source.length()) - length, 0.0);
 
-    if (! TRI_IsNumberJson(value)) {
-      RegisterInvalidArgumentWarning(query, "AVERAGE");
-      return AqlValue(new Json(Json::Null));
-    }
+  return AqlValue(new Json(UnicodeStringToJson(UnicodeSubstring(source, left, length))));
+}
 
-    // got a numeric value
-    double const number = value->_value._number;
+////////////////////////////////////////////////////////////////////////////////
+/// @brief function TRIM
+////////////////////////////////////////////////////////////////////////////////
 
-    if (! std::isnan(number) && number != HUGE_VAL && number != -HUGE_VAL) {
-      sum += number;
-      ++count;
-    } 
-  } 
+AqlValue Functions::Trim (triagens::aql::Query*,
+                          triagens::arango::AqlTransaction* trx,
+                          FunctionParameters const& parameters) {
+  auto const chars = ExtractFunctionParameter(trx, parameters, 1, false);
 
-  if (count > 0 && 
-      ! std::isnan(sum) && sum != HUGE_VAL && sum != -HUGE_VAL) {
-    return AqlValue(new Json(sum / static_cast<size_t>(count)));
-  } 
+  if (chars.isNumber()) {
+    // numeric type argument: 0 = both sides, 1 = left, 2 = right
+    double const type = chars.json()->_value._number;
 
-  return AqlValue(new Json(Json::Null));
+    if (type == 0.0) {
+      return TrimFunction(trx, parameters, false, true, true);
+    }
+    if (type == 1.0) {
+      return TrimFunction(trx, parameters, false, true, false);
+    }
+    if (type == 2.0) {
+      return TrimFunction(trx, parameters, false, false, true);
+    }
+  }
+
+  return TrimFunction(trx, parameters, true, true, true);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-/// @brief function MD5
+/// @brief function LTRIM
 ////////////////////////////////////////////////////////////////////////////////
 
-AqlValue Functions::Md5 (triagens::aql::Query* query,
-                         triagens::arango::AqlTransaction* trx,
-                         FunctionParameters const& parameters) {
-  auto value = ExtractFunctionParameter(trx, parameters, 0, false);
-    
-  triagens::basics::StringBuffer buffer(TRI_UNKNOWN_MEM_ZONE);
-  AppendAsString(buffer, value.json());
-  
-  // create md5
-  char hash[17]; 
-  char* p = &hash[0];
-  size_t length;
-
-  triagens::rest::SslInterface::sslMD5(buffer.c_str(), buffer.length(), p, length);
-
-  // as hex
-  char hex[33];
-  p = &hex[0];
+AqlValue Functions::LTrim (triagens::aql::Query*,
+                           triagens::arango::AqlTransaction* trx,
+                           FunctionParameters const& parameters) {
+  return TrimFunction(trx, parameters, true, true, false);
+}
 
-  triagens::rest::SslInterface::sslHEX(hash, 16, p, length);
+////////////////////////////////////////////////////////////////////////////////
+/// @brief function RTRIM
+////////////////////////////////////////////////////////////////////////////////
 
-  return AqlValue(new Json(TRI_UNKNOWN_MEM_ZONE, hex, 32));
+AqlValue Functions::RTrim (triagens::aql::Query*,
+                           triagens::arango::AqlTransaction* trx,
+                           FunctionParameters const& parameters) {
+  return TrimFunction(trx, parameters, true, false, true);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-/// @brief function SHA1
+/// @brief function FIND_FIRST
 ////////////////////////////////////////////////////////////////////////////////
 
-AqlValue Functions::Sha1 (triagens::aql::Query* query,
-                          triagens::arango::AqlTransaction* trx,
-                          FunctionParameters const& parameters) {
-  auto value = ExtractFunctionParameter(trx, parameters, 0, false);
-    
-  triagens::basics::StringBuffer buffer(TRI_UNKNOWN_MEM_ZONE);
-  AppendAsString(buffer, value.json());
-  
-  // create sha1
-  char hash[21];
-  char* p = &hash[0];
-  size_t length;
+AqlValue Functions::FindFirst (triagens::aql::Query*,
+                               triagens::arango::AqlTransaction* trx,
+                               FunctionParameters const& parameters) {
+  double start = 0.0;
 
-  triagens::rest::SslInterface::sslSHA1(buffer.c_str(), buffer.length(), p, length);
+  if (HasNonNullParameter(trx, parameters, 2)) {
+    start = ExtractNumericParameter(trx, parameters, 2);
+    if (start < 0.0) {
+      return AqlValue(new Json(-1.0));
+    }
+  }
 
-  // as hex
-  char hex[41];
-  p = &hex[0];
+  auto const value = ExtractFunctionParameter(trx, parameters, 0, false);
+  auto const search = ExtractFunctionParameter(trx, parameters, 1, false);
 
-  triagens::rest::SslInterface::sslHEX(hash, 20, p, length);
+  UnicodeString source = ValueToUnicodeString(value.json());
+  UnicodeString const needle = ValueToUnicodeString(search.json());
 
-  return AqlValue(new Json(TRI_UNKNOWN_MEM_ZONE, hex, 40));
+  if (HasNonNullParameter(trx, parameters, 3)) {
+    double const end = ExtractNumericParameter(trx, parameters, 3);
+    if (end < start || end < 0.0) {
+      return AqlValue(new Json(-1.0));
+    }
+    source = UnicodeSubstring(source, 0.0, end + 1.0);
+  }
+
+  int32_t const position = static_cast<int32_t>((std::min)(std::trunc(start), static_cast<double>(source.length())));
+
+  if (needle.isEmpty()) {
+    return AqlValue(new Json(static_cast<double>(position)));
+  }
+
+  return AqlValue(new Json(static_cast<double>(source.indexOf(needle, position))));
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-/// @brief function UNIQUE
+/// @brief function FIND_LAST
 ////////////////////////////////////////////////////////////////////////////////
 
-AqlValue Functions::Unique (triagens::aql::Query* query,
-                            triagens::arango::AqlTransaction* trx,
-                            FunctionParameters const& parameters) {
-  if (parameters.size() != 1) {
-    THROW_ARANGO_EXCEPTION_PARAMS(TRI_ERROR_QUERY_FUNCTION_ARGUMENT_NUMBER_MISMATCH, "UNIQUE", (int) 1, (int) 1);
+AqlValue Functions::FindLast (triagens::aql::Query*,
+                              triagens::arango::AqlTransaction* trx,
+                              FunctionParameters const& parameters) {
+  double start = 0.0;
+
+  if (HasNonNullParameter(trx, parameters, 2)) {
+    start = ExtractNumericParameter(trx, parameters, 2);
   }
 
-  auto const value = ExtractFunctionParameter(trx, parameters, 0, false);
+  bool const hasEnd = HasNonNullParameter(trx, parameters, 3);
+  double end = 0.0;
 
-  if (! value.isArray()) {
-    // not an array
-    RegisterWarning(query, "UNIQUE", TRI_ERROR_QUERY_ARRAY_EXPECTED);
-    return AqlValue(new Json(Json::Null));
+  if (hasEnd) {
+    end = ExtractNumericParameter(trx, parameters, 3);
+    if (end < start || end < 0.0) {
+      return AqlValue(new Json(-1.0));
+    }
   }
-  
-  std::unordered_set<TRI_json_t const*, triagens::basics::JsonHash, triagens::basics::JsonEqual> values(
-    512, 
-    triagens::basics::JsonHash(), 
-    triagens::basics::JsonEqual()
-  );
 
-  TRI_json_t const* valueJson = value.json();
-  size_t const n = TRI_LengthArrayJson(valueJson);
+  auto const value = ExtractFunctionParameter(trx, parameters, 0, false);
+  auto const search = ExtractFunctionParameter(trx, parameters, 1, false);
 
-  for (size_t i = 0; i < n; ++i) {
-    auto value = static_cast<TRI_json_t const*>(TRI_AddressVector(&valueJson->_value._objects, i));
+  UnicodeString source = ValueToUnicodeString(value.json());
+  UnicodeString const needle = ValueToUnicodeString(search.json());
 
-    if (value == nullptr) {
-      continue;
+  bool const restrict = (start > 0.0 || hasEnd);
+
+  if (restrict) {
+    if (hasEnd) {
+      source = UnicodeSubstring(source, start, end - start + 1.0);
+    }
+    else {
+      source = UnicodeSubstring(source, start);
     }
+  }
 
-    values.emplace(value); 
-  } 
+  int32_t result;
 
-  std::unique_ptr<TRI_json_t> result(TRI_CreateArrayJson(TRI_UNKNOWN_MEM_ZONE, values.size()));
- 
-  for (auto const& it : values) {
-    auto copy = TRI_CopyJson(TRI_UNKNOWN_MEM_ZONE, it);
+  if (needle.isEmpty()) {
+    result = source.length();
+  }
+  else {
+    result = source.lastIndexOf(needle);
+  }
 
-    if (copy == nullptr) {
-      THROW_ARANGO_EXCEPTION(TRI_ERROR_OUT_OF_MEMORY);
-    }
- 
-    TRI_PushBack3ArrayJson(TRI_UNKNOWN_MEM_ZONE, result.get(), copy); 
+  if (restrict && result != -1) {
+    return AqlValue(new Json(static_cast<double>(result) + std::trunc(start)));
   }
-      
-  auto jr = new Json(TRI_UNKNOWN_MEM_ZONE, result.get());
-  result.release();
-  return AqlValue(jr);
+
+  return AqlValue(new Json(static_cast<double>(result)));
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-/// @brief function UNION
+/// @brief function SPLIT
 ////////////////////////////////////////////////////////////////////////////////
 
-AqlValue Functions::Union (triagens::aql::Query* query,
+AqlValue Functions::Split (triagens::aql::Query* query,
                            triagens::arango::AqlTransaction* trx,
                            FunctionParameters const& parameters) {
-  size_t const n = parameters.size();
+  auto const value = ExtractFunctionParameter(trx, parameters, 0, false);
+  UnicodeString const source = ValueToUnicodeString(value.json());
 
-  if (n < 2) {
-    THROW_ARANGO_EXCEPTION_PARAMS(TRI_ERROR_QUERY_FUNCTION_ARGUMENT_NUMBER_MISMATCH, "UNION", (int) 2, (int) Function::MaxArguments);
+  if (! HasNonNullParameter(trx, parameters, 1)) {
+    Json result(Json::Array, 1);
+    result.add(UnicodeStringToJson(source));
+    return AqlValue(new Json(TRI_UNKNOWN_MEM_ZONE, result.steal()));
   }
 
-  std::unique_ptr<TRI_json_t> result(TRI_CreateArrayJson(TRI_UNKNOWN_MEM_ZONE, 16));
+  double limit = HUGE_VAL;
 
-  for (size_t i = 0; i < n; ++i) {
-    auto value = ExtractFunctionParameter(trx, parameters, i, false);
+  if (HasNonNullParameter(trx, parameters, 2)) {
+    limit = std::trunc(ExtractNumericParameter(trx, parameters, 2));
 
-    if (! value.isArray()) {
-      // not an array
-      RegisterInvalidArgumentWarning(query, "UNION");
+    if (limit < 0.0) {
+      RegisterInvalidArgumentWarning(query, "SPLIT");
       return AqlValue(new Json(Json::Null));
     }
+  }
 
-    TRI_json_t const* valueJson = value.json();
-    size_t const nrValues = TRI_LengthArrayJson(valueJson);
+  auto const separator = ExtractFunctionParameter(trx, parameters, 1, false);
+  std::vector<UnicodeString> separators;
 
-    if (TRI_ReserveVector(&(result.get()->_value._objects), nrValues) != TRI_ERROR_NO_ERROR) {
-      THROW_ARANGO_EXCEPTION(TRI_ERROR_OUT_OF_MEMORY);
-    }
+  if (separator.isArray()) {
+    TRI_json_t const* json = separator.json();
+    size_t const n = TRI_LengthArrayJson(json);
+    separators.reserve(n);
 
-    TRI_IF_FAILURE("AqlFunctions::OutOfMemory1") {
-      THROW_ARANGO_EXCEPTION(TRI_ERROR_DEBUG);
+    for (size_t i = 0; i < n; ++i) {
+      separators.emplace_back(ValueToUnicodeString(static_cast<TRI_json_t const*>(TRI_AtVector(&json->_value._objects, i))));
     }
-    
-    // this passes ownership for the JSON contens into result
-    for (size_t j = 0; j < nrValues; ++j) {
-      TRI_json_t* copy = TRI_CopyJson(TRI_UNKNOWN_MEM_ZONE, TRI_LookupArrayJson(valueJson, j));
-
-      if (copy == nullptr) {
-        THROW_ARANGO_EXCEPTION(TRI_ERROR_OUT_OF_MEMORY);
-      }
-    
-      TRI_PushBack3ArrayJson(TRI_UNKNOWN_MEM_ZONE, result.get(), copy);
+  }
+  else {
+    separators.emplace_back(ValueToUnicodeString(separator.json()));
+  }
 
-      TRI_IF_FAILURE("AqlFunctions::OutOfMemory2") {
-        THROW_ARANGO_EXCEPTION(TRI_ERROR_DEBUG);
-      }
-    } 
-  } 
-      
-  TRI_IF_FAILURE("AqlFunctions::OutOfMemory3") {
-    THROW_ARANGO_EXCEPTION(TRI_ERROR_DEBUG);
+  if (separators.empty()) {
+    // an empty list of separators matches everywhere
+    separators.emplace_back(UnicodeString());
   }
 
-  auto jr = new Json(TRI_UNKNOWN_MEM_ZONE, result.get());
-  result.release();
-  return AqlValue(jr);
+  Json result = SplitString(source, separators, limit);
+  return AqlValue(new Json(TRI_UNKNOWN_MEM_ZONE, result.steal()));
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-/// @brief function UNION_DISTINCT
+/// @brief function SUBSTITUTE
 ////////////////////////////////////////////////////////////////////////////////
 
-AqlValue Functions::UnionDistinct (triagens::aql::Query* query,
-                                   triagens::arango::AqlTransaction* trx,
-                                   FunctionParameters const& parameters) {
-  size_t const n = parameters.size();
+AqlValue Functions::Substitute (triagens::aql::Query* query,
+                                triagens::arango::AqlTransaction* trx,
+                                FunctionParameters const& parameters) {
+  auto const value = ExtractFunctionParameter(trx, parameters, 0, false);
+  UnicodeString const source = ValueToUnicodeString(value.json());
 
-  if (n < 2) {
-    THROW_ARANGO_EXCEPTION_PARAMS(TRI_ERROR_QUERY_FUNCTION_ARGUMENT_NUMBER_MISMATCH, "UNION_DISTINCT", (int) 2, (int) Function::MaxArguments);
-  }
+  auto const search = ExtractFunctionParameter(trx, parameters, 1, false);
+  auto const replace = ExtractFunctionParameter(trx, parameters, 2, false);
+  
+  std::vector<UnicodeString> searches;
+  std::vector<UnicodeString> replacements;
+  size_t limitPosition = 3;
 
-  std::unordered_set<TRI_json_t*, triagens::basics::JsonHash, triagens::basics::JsonEqual> values(
-    512, 
-    triagens::basics::JsonHash(), 
-    triagens::basics::JsonEqual()
-  );
+  if (search.isObject()) {
+    // search strings are the attribute names, replacements their values
+    TRI_json_t const* json = search.json();
+    size_t const n = TRI_LengthVector(&json->_value._objects);
 
-  auto freeValues = [&values] () -> void {
-    for (auto& it : values) {
-      TRI_FreeJson(TRI_UNKNOWN_MEM_ZONE, it);
+    for (size_t i = 0; i < n; i += 2) {
+      auto key = static_cast<TRI_json_t const*>(TRI_AtVector(&json->_value._objects, i));
+      auto value = static_cast<TRI_json_t const*>(TRI_AtVector(&json->_value._objects, i + 1));
+
+      searches.emplace_back(ValueToUnicodeString(key));
+      replacements.emplace_back(ValueToUnicodeString(value));
     }
-  };
 
-  std::unique_ptr<TRI_json_t> result;
+    // the limit is the third parameter in this variant
+    limitPosition = 2;
+  }
+  else if (search.isArray()) {
+    TRI_json_t const* json = search.json();
+    size_t const n = TRI_LengthArrayJson(json);
+
+    if (n == 0) {
+      RegisterInvalidArgumentWarning(query, "SUBSTITUTE");
+      return AqlValue(new Json(UnicodeStringToJson(source)));
+    }
+
+    UnicodeString constant;
+    if (! replace.isArray() && ! replace.isNull() && ! replace.isEmpty()) {
+      constant = ValueToUnicodeString(replace.json());
+    }
 
-  try {
     for (size_t i = 0; i < n; ++i) {
-      auto value = ExtractFunctionParameter(trx, parameters, i, false);
+      searches.emplace_back(ValueToUnicodeString(static_cast<TRI_json_t const*>(TRI_AtVector(&json->_value._objects, i))));
 
-      if (! value.isArray()) {
-        // not an array
-        freeValues();
-        RegisterInvalidArgumentWarning(query, "UNION_DISTINCT");
-        return AqlValue(new Json(Json::Null));
+      if (replace.isArray()) {
+        // replace each search string with the member at the same position
+        if (i < TRI_LengthArrayJson(replace.json())) {
+          replacements.emplace_back(ValueToUnicodeString(static_cast<TRI_json_t const*>(TRI_AtVector(&replace.json()->_value._objects, i))));
+        }
+        else {
+          replacements.emplace_back(UnicodeString());
+        }
+      }
+      else {
+        // replace all search strings with a constant string
+        replacements.emplace_back(constant);
       }
+    }
+  }
+  else {
+    searches.emplace_back(ValueToUnicodeString(search.json()));
 
-      TRI_json_t const* valueJson = value.json();
-      size_t const nrValues = TRI_LengthArrayJson(valueJson);
+    if (replace.isNull() || replace.isEmpty()) {
+      replacements.emplace_back(UnicodeString());
+    }
+    else {
+      replacements.emplace_back(ValueToUnicodeString(replace.json()));
+    }
+  }
 
-      for (size_t j = 0; j < nrValues; ++j) {
-        auto value = static_cast<TRI_json_t*>(TRI_AddressVector(&valueJson->_value._objects, j));
+  // if a search string occurs multiple times, its last replacement is used
+  for (size_t i = 0; i < searches.size(); ++i) {
+    for (size_t j = i + 1; j < searches.size(); ++j) {
+      if (searches[i] == searches[j]) {
+        replacements[i] = replacements[j];
+      }
+    }
+  }
 
-        if (values.find(value) == values.end()) { 
-          std::unique_ptr<TRI_json_t> copy(TRI_CopyJson(TRI_UNKNOWN_MEM_ZONE, value));
+  double limit = HUGE_VAL;
 
-          if (copy == nullptr) {
-            THROW_ARANGO_EXCEPTION(TRI_ERROR_OUT_OF_MEMORY);
-          }
-      
-          TRI_IF_FAILURE("AqlFunctions::OutOfMemory1") {
-            THROW_ARANGO_EXCEPTION(TRI_ERROR_DEBUG);
-          }
+  if (HasNonNullParameter(trx, parameters, limitPosition)) {
+    limit = ExtractNumericParameter(trx, parameters, limitPosition);
 
-          values.emplace(copy.get());
-          copy.release();
-        }
-      }
+    if (limit < 0.0) {
+      RegisterInvalidArgumentWarning(query, "SUBSTITUTE");
+      return AqlValue(new Json(Json::Null));
     }
+  }
 
-    result.reset(TRI_CreateArrayJson(TRI_UNKNOWN_MEM_ZONE, values.size()));
+  UnicodeString result;
+  int32_t const n = source.length();
+  int32_t position = 0;
+  size_t which;
 
-    if (result == nullptr) {
-      THROW_ARANGO_EXCEPTION(TRI_ERROR_OUT_OF_MEMORY);
+  while (position <= n) {
+    int32_t const end = MatchSearchStrings(source, position, searches, which);
+
+    if (end == -1) {
+      if (position < n) {
+        result.append(source.charAt(position));
+      }
+      ++position;
+      continue;
     }
-          
-    TRI_IF_FAILURE("AqlFunctions::OutOfMemory2") {
-      THROW_ARANGO_EXCEPTION(TRI_ERROR_DEBUG);
+
+    if (limit > 0.0) {
+      result.append(replacements[which]);
+      limit -= 1.0;
     }
-   
-    for (auto const& it : values) {
-      TRI_PushBack3ArrayJson(TRI_UNKNOWN_MEM_ZONE, result.get(), it); 
+    else {
+      result.append(source, position, end - position);
     }
 
+    if (end == position) {
+      // empty match. copy the next character and move on
+      if (position < n) {
+        result.append(source.charAt(position));
+      }
+      ++position;
+    }
+    else {
+      position = end;
+    }
   }
-  catch (...) {  
-    freeValues();
-    throw;
-  }
-    
-  TRI_IF_FAILURE("AqlFunctions::OutOfMemory3") {
-    THROW_ARANGO_EXCEPTION(TRI_ERROR_DEBUG);
-  }
-      
-  auto jr = new Json(TRI_UNKNOWN_MEM_ZONE, result.get());
-  result.release();
-  return AqlValue(jr);
+
+  return AqlValue(new Json(UnicodeStringToJson(result)));
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-/// @brief function INTERSECTION
+/// @brief function PASSTHRU
 ////////////////////////////////////////////////////////////////////////////////
 
-AqlValue Functions::Intersection (triagens::aql::Query* query,
-                                  triagens::arango::AqlTransaction* trx,
-                                  FunctionParameters const& parameters) {
+AqlValue Functions::Passthru (triagens::aql::Query*,
+                              triagens::arango::AqlTransaction* trx,
+                              FunctionParameters const& parameters) {
+
+  if (parameters.empty()) {
+    return AqlValue(new Json(Json::Null));
+  }
+
+  auto json = ExtractFunctionParameter(trx, parameters, 0, true);
+  return AqlValue(new Json(TRI_UNKNOWN_MEM_ZONE, json.steal()));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief function UNSET
+////////////////////////////////////////////////////////////////////////////////
+
+AqlValue Functions::Unset (triagens::aql::Query* query,
+                           triagens::arango::AqlTransaction* trx,
+                           FunctionParameters const& parameters) {
+  auto value = ExtractFunctionParameter(trx, parameters, 0, false);
+
+  if (! value.isObject()) {
+    RegisterInvalidArgumentWarning(query, "UNSET");
+    return AqlValue(new Json(Json::Null));
+  }
+ 
+  std::unordered_set<std::string> names;
+  ExtractKeys(names, query, trx, parameters, 1, "UNSET");
+
+
+  // create result object
+  TRI_json_t const* valueJson = value.json();
+  size_t const n = TRI_LengthVector(&valueJson->_value._objects);
+
+  size_t size;
+  if (names.size() >= n / 2) {
+    size = 4; 
+  }
+  else {
+    size = (n / 2) - names.size(); 
+  }
+
+  std::unique_ptr<TRI_json_t> j(TRI_CreateObjectJson(TRI_UNKNOWN_MEM_ZONE, size));
+
+  if (j == nullptr) {
+    THROW_ARANGO_EXCEPTION(TRI_ERROR_OUT_OF_MEMORY);
+  }
+
+  for (size_t i = 0; i < n; i += 2) {
+    auto key = static_cast<TRI_json_t const*>(TRI_AtVector(&valueJson->_value._objects, i));
+    auto value = static_cast<TRI_json_t const*>(TRI_AtVector(&valueJson->_value._objects, i + 1));
+
+    if (TRI_IsStringJson(key) && 
+        names.find(key->_value._string.data) == names.end()) {
+      auto copy = TRI_CopyJson(TRI_UNKNOWN_MEM_ZONE, value);
+
+      if (copy == nullptr) {
+        THROW_ARANGO_EXCEPTION(TRI_ERROR_OUT_OF_MEMORY);
+      } 
+
+      TRI_Insert3ObjectJson(TRI_UNKNOWN_MEM_ZONE, j.get(), key->_value._string.data, copy);
+    }
+  } 
+
+  auto jr = new Json(TRI_UNKNOWN_MEM_ZONE, j.get());
+  j.release();
+  return AqlValue(jr);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief function KEEP
+////////////////////////////////////////////////////////////////////////////////
+
+AqlValue Functions::Keep (triagens::aql::Query* query,
+                          triagens::arango::AqlTransaction* trx,
+                          FunctionParameters const& parameters) {
+  auto value = ExtractFunctionParameter(trx, parameters, 0, false);
+
+  if (! value.isObject()) {
+    RegisterInvalidArgumentWarning(query, "KEEP");
+    return AqlValue(new Json(Json::Null));
+  }
+ 
+  std::unordered_set<std::string> names;
+  ExtractKeys(names, query, trx, parameters, 1, "KEEP");
+
+
+  // create result object
+  std::unique_ptr<TRI_json_t> j(TRI_CreateObjectJson(TRI_UNKNOWN_MEM_ZONE, names.size()));
+
+  if (j == nullptr) {
+    THROW_ARANGO_EXCEPTION(TRI_ERROR_OUT_OF_MEMORY);
+  }
+
+  TRI_json_t const* valueJson = value.json();
+  size_t const n = TRI_LengthVector(&valueJson->_value._objects);
+
+  for (size_t i = 0; i < n; i += 2) {
+    auto key = static_cast<TRI_json_t const*>(TRI_AtVector(&valueJson->_value._objects, i));
+    auto value = static_cast<TRI_json_t const*>(TRI_AtVector(&valueJson->_value._objects, i + 1));
+
+    if (TRI_IsStringJson(key) && 
+        names.find(key->_value._string.data) != names.end()) {
+      auto copy = TRI_CopyJson(TRI_UNKNOWN_MEM_ZONE, value);
+
+      if (copy == nullptr) {
+        THROW_ARANGO_EXCEPTION(TRI_ERROR_OUT_OF_MEMORY);
+      } 
+
+      TRI_Insert3ObjectJson(TRI_UNKNOWN_MEM_ZONE, j.get(), key->_value._string.data, copy);
+    }
+  } 
+
+  auto jr = new Json(TRI_UNKNOWN_MEM_ZONE, j.get());
+  j.release();
+  return AqlValue(jr);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief function MERGE
+////////////////////////////////////////////////////////////////////////////////
+
+AqlValue Functions::Merge (triagens::aql::Query* query,
+                           triagens::arango::AqlTransaction* trx,
+                           FunctionParameters const& parameters) {
+  size_t const n = parameters.size();
+
+  if (n == 0) {
+    // no parameters
+    return AqlValue(new Json(Json::Object));
+  }
+
+  // use the first argument as the preliminary result
+  auto initial = ExtractFunctionParameter(trx, parameters, 0, true);
+
+  if (! initial.isObject()) {
+    RegisterInvalidArgumentWarning(query, "MERGE");
+    return AqlValue(new Json(Json::Null));
+  }
+
+  std::unique_ptr<TRI_json_t> result(initial.steal());
+
+  // now merge in all other arguments
+  for (size_t i = 1; i < n; ++i) {
+    auto param = ExtractFunctionParameter(trx, parameters, i, false);
+
+    if (! param.isObject()) {
+      RegisterInvalidArgumentWarning(query, "MERGE");
+      return AqlValue(new Json(Json::Null));
+    }
+ 
+    auto merged = TRI_MergeJson(TRI_UNKNOWN_MEM_ZONE, result.get(), param.json(), false, true);
+
+    if (merged == nullptr) {
+      THROW_ARANGO_EXCEPTION(TRI_ERROR_OUT_OF_MEMORY);
+    }
+
+    result.reset(merged);
+  } 
+
+  auto jr = new Json(TRI_UNKNOWN_MEM_ZONE, result.get());
+  result.release();
+  return AqlValue(jr);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief function HAS
+////////////////////////////////////////////////////////////////////////////////
+
+AqlValue Functions::Has (triagens::aql::Query* query,
+                         triagens::arango::AqlTransaction* trx,
+                         FunctionParameters const& parameters) {
   size_t const n = parameters.size();
 
   if (n < 2) {
-    THROW_ARANGO_EXCEPTION_PARAMS(TRI_ERROR_QUERY_FUNCTION_ARGUMENT_NUMBER_MISMATCH, "INTERSECTION", (int) 2, (int) Function::MaxArguments);
+    // no parameters
+    return AqlValue(new Json(false));
+  }
+    
+  auto value = ExtractFunctionParameter(trx, parameters, 0, false);
+
+  if (! value.isObject()) {
+    // not an object
+    return AqlValue(new Json(false));
+  }
+ 
+  // process name parameter 
+  auto name = ExtractFunctionParameter(trx, parameters, 1, false);
+
+  char const* p;
+
+  if (! name.isString()) {
+    triagens::basics::StringBuffer buffer(TRI_UNKNOWN_MEM_ZONE);
+    AppendAsString(buffer, name.json());
+    p = buffer.c_str();
+  }
+  else {
+    p = name.json()->_value._string.data;
+  }
+ 
+  bool const hasAttribute = (TRI_LookupObjectJson(value.json(), p) != nullptr);
+  return AqlValue(new Json(hasAttribute));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief function ATTRIBUTES
+////////////////////////////////////////////////////////////////////////////////
+
+AqlValue Functions::Attributes (triagens::aql::Query* query,
+                                triagens::arango::AqlTransaction* trx,
+                                FunctionParameters const& parameters) {
+  size_t const n = parameters.size();
+
+  if (n < 1) {
+    // no parameters
+    return AqlValue(new Json(Json::Null));
+  }
+    
+  auto value = ExtractFunctionParameter(trx, parameters, 0, false);
+
+  if (! value.isObject()) {
+    // not an object
+    RegisterWarning(query, "ATTRIBUTES", TRI_ERROR_QUERY_FUNCTION_ARGUMENT_TYPE_MISMATCH);
+    return AqlValue(new Json(Json::Null));
+  }
+ 
+  bool const removeInternal = GetBooleanParameter(trx, parameters, 1, false);
+  bool const doSort = GetBooleanParameter(trx, parameters, 2, false);
+
+  auto const valueJson = value.json();
+  TRI_ASSERT(TRI_IsObjectJson(valueJson));
+
+  size_t const numValues = TRI_LengthVectorJson(valueJson);
+
+  if (numValues == 0) {
+    // empty object
+    return AqlValue(new Json(Json::Object));
+  }
+
+  std::vector<std::pair<char const*, size_t>> sortPositions;
+  sortPositions.reserve(numValues / 2);
+
+  // create a vector with positions into the object
+  for (size_t i = 0; i < numValues; i += 2) {
+    auto key = static_cast<TRI_json_t const*>(TRI_AddressVector(&valueJson->_value._objects, i));
+
+    if (! TRI_IsStringJson(key)) {
+      // somehow invalid
+      continue;
+    }
+
+    if (removeInternal && *key->_value._string.data == '_') {
+      // skip attribute
+      continue;
+    }
+
+    sortPositions.emplace_back(std::make_pair(key->_value._string.data, i));
+  }
+
+  if (doSort) {
+    // sort according to attribute name
+    std::sort(sortPositions.begin(), sortPositions.end(), [] (std::pair<char const*, size_t> const& lhs,
+                                                              std::pair<char const*, size_t> const& rhs) -> bool {
+      return TRI_compare_utf8(lhs.first, rhs.first) < 0;
+    });
+  }
+
+  // create the output
+  Json result(Json::Array, sortPositions.size());
+
+  // iterate over either sorted or unsorted object 
+  for (auto const& it : sortPositions) {
+    auto key = static_cast<TRI_json_t const*>(TRI_AddressVector(&valueJson->_value._objects, it.second));
+
+    result.add(Json(std::string(key->_value._string.data, key->_value._string.length - 1)));
+  } 
+
+  return AqlValue(new Json(TRI_UNKNOWN_MEM_ZONE, result.steal()));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief function VALUES
+////////////////////////////////////////////////////////////////////////////////
+
+AqlValue Functions::Values (triagens::aql::Query* query,
+                            triagens::arango::AqlTransaction* trx,
+                            FunctionParameters const& parameters) {
+  size_t const n = parameters.size();
+
+  if (n < 1) {
+    // no parameters
+    return AqlValue(new Json(Json::Null));
+  }
+    
+  auto value = ExtractFunctionParameter(trx, parameters, 0, false);
+
+  if (! value.isObject()) {
+    // not an object
+    RegisterWarning(query, "ATTRIBUTES", TRI_ERROR_QUERY_FUNCTION_ARGUMENT_TYPE_MISMATCH);
+    return AqlValue(new Json(Json::Null));
+  }
+ 
+  bool const removeInternal = GetBooleanParameter(trx, parameters, 1, false);
+
+  auto const valueJson = value.json();
+  TRI_ASSERT(TRI_IsObjectJson(valueJson));
+
+  size_t const numValues = TRI_LengthVectorJson(valueJson);
+
+  if (numValues == 0) {
+    // empty object
+    return AqlValue(new Json(Json::Object));
+  }
+
+  // create the output
+  Json result(Json::Array, numValues);
+
+  // create a vector with positions into the object
+  for (size_t i = 0; i < numValues; i += 2) {
+    auto key = static_cast<TRI_json_t const*>(TRI_AddressVector(&valueJson->_value._objects, i));
+
+    if (! TRI_IsStringJson(key)) {
+      // somehow invalid
+      continue;
+    }
+
+    if (removeInternal && *key->_value._string.data == '_') {
+      // skip attribute
+      continue;
+    }
+
+    auto value = static_cast<TRI_json_t const*>(TRI_AddressVector(&valueJson->_value._objects, i + 1));
+    result.add(Json(TRI_UNKNOWN_MEM_ZONE, TRI_CopyJson(TRI_UNKNOWN_MEM_ZONE, value)));
+  }
+
+  return AqlValue(new Json(TRI_UNKNOWN_MEM_ZONE, result.steal()));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief function MIN
+////////////////////////////////////////////////////////////////////////////////
+
+AqlValue Functions::Min (triagens::aql::Query* query,
+                         triagens::arango::AqlTransaction* trx,
+                         FunctionParameters const& parameters) {
+  auto value = ExtractFunctionParameter(trx, parameters, 0, false);
+
+  if (! value.isArray()) {
+    // not an array
+    RegisterWarning(query, "MIN", TRI_ERROR_QUERY_ARRAY_EXPECTED);
+    return AqlValue(new Json(Json::Null));
+  }
+
+  TRI_json_t const* valueJson = value.json();
+  size_t const n = TRI_LengthArrayJson(valueJson);
+  TRI_json_t const* minValue = nullptr;;
+
+  for (size_t i = 0; i < n; ++i) {
+    auto value = static_cast<TRI_json_t const*>(TRI_AtVector(&valueJson->_value._objects, i));
+
+    if (TRI_IsNullJson(value)) {
+      continue;
+    }
+
+    if (minValue == nullptr ||
+        TRI_CompareValuesJson(value, minValue) < 0) {
+      minValue = value;
+    }
+  } 
+
+  if (minValue != nullptr) {
+    std::unique_ptr<TRI_json_t> result(TRI_CopyJson(TRI_UNKNOWN_MEM_ZONE, minValue));
+    
+    if (result != nullptr) {
+      auto jr = new Json(TRI_UNKNOWN_MEM_ZONE, result.get());
+      result.release();
+      return AqlValue(jr);
+    }
+  }
+
+  return AqlValue(new Json(Json::Null));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief function MAX
+////////////////////////////////////////////////////////////////////////////////
+
+AqlValue Functions::Max (triagens::aql::Query* query,
+                         triagens::arango::AqlTransaction* trx,
+                         FunctionParameters const& parameters) {
+  auto value = ExtractFunctionParameter(trx, parameters, 0, false);
+
+  if (! value.isArray()) {
+    // not an array
+    RegisterWarning(query, "MAX", TRI_ERROR_QUERY_ARRAY_EXPECTED);
+    return AqlValue(new Json(Json::Null));
+  }
+
+  TRI_json_t const* valueJson = value.json();
+  size_t const n = TRI_LengthArrayJson(valueJson);
+  TRI_json_t const* maxValue = nullptr;;
+
+  for (size_t i = 0; i < n; ++i) {
+    auto value = static_cast<TRI_json_t const*>(TRI_AtVector(&valueJson->_value._objects, i));
+
+    if (TRI_IsNullJson(value)) {
+      continue;
+    }
+
+    if (maxValue == nullptr ||
+        TRI_CompareValuesJson(value, maxValue) > 0) {
+      maxValue = value;
+    }
+  } 
+
+  if (maxValue != nullptr) {
+    std::unique_ptr<TRI_json_t> result(TRI_CopyJson(TRI_UNKNOWN_MEM_ZONE, maxValue));
+    
+    if (result != nullptr) {
+      auto jr = new Json(TRI_UNKNOWN_MEM_ZONE, result.get());
+      result.release();
+      return AqlValue(jr);
+    }
+  }
+
+  return AqlValue(new Json(Json::Null));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief function SUM
+////////////////////////////////////////////////////////////////////////////////
+
+AqlValue Functions::Sum (triagens::aql::Query* query,
+                         triagens::arango::AqlTransaction* trx,
+                         FunctionParameters const& parameters) {
+  auto value = ExtractFunctionParameter(trx, parameters, 0, false);
+
+  if (! value.isArray()) {
+    // not an array
+    RegisterWarning(query, "SUM", TRI_ERROR_QUERY_ARRAY_EXPECTED);
+    return AqlValue(new Json(Json::Null));
+  }
+
+  TRI_json_t const* valueJson = value.json();
+  size_t const n = TRI_LengthArrayJson(valueJson);
+  double sum = 0.0;
+
+  for (size_t i = 0; i < n; ++i) {
+    auto value = static_cast<TRI_json_t const*>(TRI_AtVector(&valueJson->_value._objects, i));
+
+    if (TRI_IsNullJson(value)) {
+      continue;
+    }
+
+    if (! TRI_IsNumberJson(value)) {
+      RegisterInvalidArgumentWarning(query, "SUM");
+      return AqlValue(new Json(Json::Null));
+    }
+
+    // got a numeric value
+    double const number = value->_value._number;
+
+    if (! std::isnan(number) && number != HUGE_VAL && number != -HUGE_VAL) {
+      sum += number;
+    } 
+  } 
+
+  if (! std::isnan(sum) && sum != HUGE_VAL && sum != -HUGE_VAL) {
+    return AqlValue(new Json(sum));
+  } 
+
+  return AqlValue(new Json(Json::Null));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief function AVERAGE
+////////////////////////////////////////////////////////////////////////////////
+
+AqlValue Functions::Average (triagens::aql::Query* query,
+                             triagens::arango::AqlTransaction* trx,
+                             FunctionParameters const& parameters) {
+  auto value = ExtractFunctionParameter(trx, parameters, 0, false);
+
+  if (! value.isArray()) {
+    // not an array
+    RegisterWarning(query, "AVERAGE", TRI_ERROR_QUERY_ARRAY_EXPECTED);
+    return AqlValue(new Json(Json::Null));
+  }
+
+  TRI_json_t const* valueJson = value.json();
+  size_t const n = TRI_LengthArrayJson(valueJson);
+  double sum = 0.0;
+  size_t count = 0;
+
+  for (size_t i = 0; i < n; ++i) {
+    auto value = static_cast<TRI_json_t const*>(TRI_AtVector(&valueJson->_value._objects, i));
+
+    if (TRI_IsNullJson(value)) {
+      continue;
+    }
+
+    if (! TRI_IsNumberJson(value)) {
+      RegisterInvalidArgumentWarning(query, "AVERAGE");
+      return AqlValue(new Json(Json::Null));
+    }
+
+    // got a numeric value
+    double const number = value->_value._number;
+
+    if (! std::isnan(number) && number != HUGE_VAL && number != -HUGE_VAL) {
+      sum += number;
+      ++count;
+    } 
+  } 
+
+  if (count > 0 && 
+      ! std::isnan(sum) && sum != HUGE_VAL && sum != -HUGE_VAL) {
+    return AqlValue(new Json(sum / static_cast<size_t>(count)));
+  } 
+
+  return AqlValue(new Json(Json::Null));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief function MD5
+////////////////////////////////////////////////////////////////////////////////
+
+AqlValue Functions::Md5 (triagens::aql::Query* query,
+                         triagens::arango::AqlTransaction* trx,
+                         FunctionParameters const& parameters) {
+  auto value = ExtractFunctionParameter(trx, parameters, 0, false);
+    
+  triagens::basics::StringBuffer buffer(TRI_UNKNOWN_MEM_ZONE);
+  AppendAsString(buffer, value.json());
+  
+  // create md5
+  char hash[17]; 
+  char* p = &hash[0];
+  size_t length;
+
+  triagens::rest::SslInterface::sslMD5(buffer.c_str(), buffer.length(), p, length);
+
+  // as hex
+  char hex[33];
+  p = &hex[0];
+
+  triagens::rest::SslInterface::sslHEX(hash, 16, p, length);
+
+  return AqlValue(new Json(TRI_UNKNOWN_MEM_ZONE, hex, 32));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief function SHA1
+////////////////////////////////////////////////////////////////////////////////
+
+AqlValue Functions::Sha1 (triagens::aql::Query* query,
+                          triagens::arango::AqlTransaction* trx,
+                          FunctionParameters const& parameters) {
+  auto value = ExtractFunctionParameter(trx, parameters, 0, false);
+    
+  triagens::basics::StringBuffer buffer(TRI_UNKNOWN_MEM_ZONE);
+  AppendAsString(buffer, value.json());
+  
+  // create sha1
+  char hash[21];
+  char* p = &hash[0];
+  size_t length;
+
+  triagens::rest::SslInterface::sslSHA1(buffer.c_str(), buffer.length(), p, length);
+
+  // as hex
+  char hex[41];
+  p = &hex[0];
+
+  triagens::rest::SslInterface::sslHEX(hash, 20, p, length);
+
+  return AqlValue(new Json(TRI_UNKNOWN_MEM_ZONE, hex, 40));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief function UNIQUE
+////////////////////////////////////////////////////////////////////////////////
+
+AqlValue Functions::Unique (triagens::aql::Query* query,
+                            triagens::arango::AqlTransaction* trx,
+                            FunctionParameters const& parameters) {
+  if (parameters.size() != 1) {
+    THROW_ARANGO_EXCEPTION_PARAMS(TRI_ERROR_QUERY_FUNCTION_ARGUMENT_NUMBER_MISMATCH, "UNIQUE", (int) 1, (int) 1);
+  }
+
+  auto const value = ExtractFunctionParameter(trx, parameters, 0, false);
+
+  if (! value.isArray()) {
+    // not an array
+    RegisterWarning(query, "UNIQUE", TRI_ERROR_QUERY_ARRAY_EXPECTED);
+    return AqlValue(new Json(Json::Null));
+  }
+  
+  std::unordered_set<TRI_json_t const*, triagens::basics::JsonHash, triagens::basics::JsonEqual> values(
+    512, 
+    triagens::basics::JsonHash(), 
+    triagens::basics::JsonEqual()
+  );
+
+  TRI_json_t const* valueJson = value.json();
+  size_t const n = TRI_LengthArrayJson(valueJson);
+
+  for (size_t i = 0; i < n; ++i) {
+    auto value = static_cast<TRI_json_t const*>(TRI_AddressVector(&valueJson->_value._objects, i));
+
+    if (value == nullptr) {
+      continue;
+    }
+
+    values.emplace(value); 
+  } 
+
+  std::unique_ptr<TRI_json_t> result(TRI_CreateArrayJson(TRI_UNKNOWN_MEM_ZONE, values.size()));
+ 
+  for (auto const& it : values) {
+    auto copy = TRI_CopyJson(TRI_UNKNOWN_MEM_ZONE, it);
+
+    if (copy == nullptr) {
+      THROW_ARANGO_EXCEPTION(TRI_ERROR_OUT_OF_MEMORY);
+    }
+ 
+    TRI_PushBack3ArrayJson(TRI_UNKNOWN_MEM_ZONE, result.get(), copy); 
+  }
+      
+  auto jr = new Json(TRI_UNKNOWN_MEM_ZONE, result.get());
+  result.release();
+  return AqlValue(jr);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief function UNION
+////////////////////////////////////////////////////////////////////////////////
+
+AqlValue Functions::Union (triagens::aql::Query* query,
+                           triagens::arango::AqlTransaction* trx,
+                           FunctionParameters const& parameters) {
+  size_t const n = parameters.size();
+
+  if (n < 2) {
+    THROW_ARANGO_EXCEPTION_PARAMS(TRI_ERROR_QUERY_FUNCTION_ARGUMENT_NUMBER_MISMATCH, "UNION", (int) 2, (int) Function::MaxArguments);
+  }
+
+  std::unique_ptr<TRI_json_t> result(TRI_CreateArrayJson(TRI_UNKNOWN_MEM_ZONE, 16));
+
+  for (size_t i = 0; i < n; ++i) {
+    auto value = ExtractFunctionParameter(trx, parameters, i, false);
+
+    if (! value.isArray()) {
+      // not an array
+      RegisterInvalidArgumentWarning(query, "UNION");
+      return AqlValue(new Json(Json::Null));
+    }
+
+    TRI_json_t const* valueJson = value.json();
+    size_t const nrValues = TRI_LengthArrayJson(valueJson);
+
+    if (TRI_ReserveVector(&(result.get()->_value._objects), nrValues) != TRI_ERROR_NO_ERROR) {
+      THROW_ARANGO_EXCEPTION(TRI_ERROR_OUT_OF_MEMORY);
+    }
+
+    TRI_IF_FAILURE("AqlFunctions::OutOfMemory1") {
+      THROW_ARANGO_EXCEPTION(TRI_ERROR_DEBUG);
+    }
+    
+    // this passes ownership for the JSON contens into result
+    for (size_t j = 0; j < nrValues; ++j) {
+      TRI_json_t* copy = TRI_CopyJson(TRI_UNKNOWN_MEM_ZONE, TRI_LookupArrayJson(valueJson, j));
+
+      if (copy == nullptr) {
+        THROW_ARANGO_EXCEPTION(TRI_ERROR_OUT_OF_MEMORY);
+      }
+    
+      TRI_PushBack3ArrayJson(TRI_UNKNOWN_MEM_ZONE, result.get(), copy);
+
+      TRI_IF_FAILURE("AqlFunctions::OutOfMemory2") {
+        THROW_ARANGO_EXCEPTION(TRI_ERROR_DEBUG);
+      }
+    } 
+  } 
+      
+  TRI_IF_FAILURE("AqlFunctions::OutOfMemory3") {
+    THROW_ARANGO_EXCEPTION(TRI_ERROR_DEBUG);
+  }
+
+  auto jr = new Json(TRI_UNKNOWN_MEM_ZONE, result.get());
+  result.release();
+  return AqlValue(jr);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief function UNION_DISTINCT
+////////////////////////////////////////////////////////////////////////////////
+
+AqlValue Functions::UnionDistinct (triagens::aql::Query* query,
+                                   triagens::arango::AqlTransaction* trx,
+                                   FunctionParameters const& parameters) {
+  size_t const n = parameters.size();
+
+  if (n < 2) {
+    THROW_ARANGO_EXCEPTION_PARAMS(TRI_ERROR_QUERY_FUNCTION_ARGUMENT_NUMBER_MISMATCH, "UNION_DISTINCT", (int) 2, (int) Function::MaxArguments);
+  }
+
+  std::unordered_set<TRI_json_t*, triagens::basics::JsonHash, triagens::basics::JsonEqual> values(
+    512, 
+    triagens::basics::JsonHash(), 
+    triagens::basics::JsonEqual()
+  );
+
+  auto freeValues = [&values] () -> void {
+    for (auto& it : values) {
+      TRI_FreeJson(TRI_UNKNOWN_MEM_ZONE, it);
+    }
+  };
+
+  std::unique_ptr<TRI_json_t> result;
+
+  try {
+    for (size_t i = 0; i < n; ++i) {
+      auto value = ExtractFunctionParameter(trx, parameters, i, false);
+
+      if (! value.isArray()) {
+        // not an array
+        freeValues();
+        RegisterInvalidArgumentWarning(query, "UNION_DISTINCT");
+        return AqlValue(new Json(Json::Null));
+      }
+
+      TRI_json_t const* valueJson = value.json();
+      size_t const nrValues = TRI_LengthArrayJson(valueJson);
+
+      for (size_t j = 0; j < nrValues; ++j) {
+        auto value = static_cast<TRI_json_t*>(TRI_AddressVector(&valueJson->_value._objects, j));
+
+        if (values.find(value) == values.end()) { 
+          std::unique_ptr<TRI_json_t> copy(TRI_CopyJson(TRI_UNKNOWN_MEM_ZONE, value));
+
+          if (copy == nullptr) {
+            THROW_ARANGO_EXCEPTION(TRI_ERROR_OUT_OF_MEMORY);
+          }
+      
+          TRI_IF_FAILURE("AqlFunctions::OutOfMemory1") {
+            THROW_ARANGO_EXCEPTION(TRI_ERROR_DEBUG);
+          }
+
+          values.emplace(copy.get());
+          copy.release();
+        }
+      }
+    }
+
+    result.reset(TRI_CreateArrayJson(TRI_UNKNOWN_MEM_ZONE, values.size()));
+
+    if (result == nullptr) {
+      THROW_ARANGO_EXCEPTION(TRI_ERROR_OUT_OF_MEMORY);
+    }
+          
+    TRI_IF_FAILURE("AqlFunctions::OutOfMemory2") {
+      THROW_ARANGO_EXCEPTION(TRI_ERROR_DEBUG);
+    }
+   
+    for (auto const& it : values) {
+      TRI_PushBack3ArrayJson(TRI_UNKNOWN_MEM_ZONE, result.get(), it); 
+    }
+
+  }
+  catch (...) {  
+    freeValues();
+    throw;
+  }
+    
+  TRI_IF_FAILURE("AqlFunctions::OutOfMemory3") {
+    THROW_ARANGO_EXCEPTION(TRI_ERROR_DEBUG);
+  }
+      
+  auto jr = new Json(TRI_UNKNOWN_MEM_ZONE, result.get());
+  result.release();
+  return AqlValue(jr);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief function INTERSECTION
+////////////////////////////////////////////////////////////////////////////////
+
+AqlValue Functions::Intersection (triagens::aql::Query* query,
+                                  triagens::arango::AqlTransaction* trx,
+                                  FunctionParameters const& parameters) {
+  size_t const n = parameters.size();
+
+  if (n < 2) {
+    THROW_ARANGO_EXCEPTION_PARAMS(TRI_ERROR_QUERY_FUNCTION_ARGUMENT_NUMBER_MISMATCH, "INTERSECTION", (int) 2, (int) Function::MaxArguments);
+  }
+
+  std::unordered_map<TRI_json_t*, size_t, triagens::basics::JsonHash, triagens::basics::JsonEqual> values(
+    512, 
+    triagens::basics::JsonHash(), 
+    triagens::basics::JsonEqual()
+  );
+
+  auto freeValues = [&values] () -> void {
+    for (auto& it : values) {
+      TRI_FreeJson(TRI_UNKNOWN_MEM_ZONE, it.first);
+    }
+    values.clear();
+  };
+
+  std::unique_ptr<TRI_json_t> result;
+
+  try {
+    for (size_t i = 0; i < n; ++i) {
+      auto value = ExtractFunctionParameter(trx, parameters, i, false);
+
+      if (! value.isArray()) {
+        // not an array
+        freeValues();
+        RegisterWarning(query, "INTERSECTION", TRI_ERROR_QUERY_ARRAY_EXPECTED);
+        return AqlValue(new Json(Json::Null));
+      }
+
+      TRI_json_t const* valueJson = value.json();
+      size_t const nrValues = TRI_LengthArrayJson(valueJson);
+
+      for (size_t j = 0; j < nrValues; ++j) {
+        auto value = static_cast<TRI_json_t const*>(TRI_AddressVector(&valueJson->_value._objects, j));
+
+        if (i == 0) {
+          // round one
+          std::unique_ptr<TRI_json_t> copy(TRI_CopyJson(TRI_UNKNOWN_MEM_ZONE, value));
+
+          if (copy == nullptr) {
+            THROW_ARANGO_EXCEPTION(TRI_ERROR_OUT_OF_MEMORY);
+          }
+    
+          TRI_IF_FAILURE("AqlFunctions::OutOfMemory1") {
+            THROW_ARANGO_EXCEPTION(TRI_ERROR_DEBUG);
+          }
+
+          auto r = values.emplace(copy.get(), 1);
+ 
+          if (r.second) {
+            // successfully inserted
+            copy.release();
+          }
+        }
+        else {
+          // check if we have seen the same element before
+          auto it = values.find(const_cast<TRI_json_t*>(value));
+
+          if (it != values.end()) {
+            // already seen
+            TRI_ASSERT((*it).second > 0);
+            ++((*it).second);
+          }
+        }
+      }
+    }
+ 
+    // count how many valid we have 
+    size_t total = 0;
+
+    for (auto const& it : values) {
+      if (it.second == n) {
+        ++total;
+      }
+    }
+
+    result.reset(TRI_CreateArrayJson(TRI_UNKNOWN_MEM_ZONE, total));
+
+    if (result == nullptr) {
+      THROW_ARANGO_EXCEPTION(TRI_ERROR_OUT_OF_MEMORY);
+    }
+          
+    TRI_IF_FAILURE("AqlFunctions::OutOfMemory2") {
+      THROW_ARANGO_EXCEPTION(TRI_ERROR_DEBUG);
+    }
+   
+    for (auto& it : values) {
+      if (it.second == n) {
+        TRI_PushBack3ArrayJson(TRI_UNKNOWN_MEM_ZONE, result.get(), it.first); 
+      }
+      else {
+        TRI_FreeJson(TRI_UNKNOWN_MEM_ZONE, it.first);
+      }
+    }
+    values.clear();
+   
+  } 
+  catch (...) {
+    freeValues();
+    throw;
+  }
+    
+  TRI_IF_FAILURE("AqlFunctions::OutOfMemory3") {
+    THROW_ARANGO_EXCEPTION(TRI_ERROR_DEBUG);
+  }
+      
+  auto jr = new Json(TRI_UNKNOWN_MEM_ZONE, result.get());
+  result.release();
+  return AqlValue(jr);
+}
+
+// TODO DELETE THESE HELPER FUNCTIONS.
+
+static inline Json TRI_ExpandShapedJson (VocShaper* shaper,
+                                         CollectionNameResolver const* resolver,
+                                         TRI_voc_cid_t const& cid,
+                                         TRI_doc_mptr_t const* mptr) {
+  TRI_df_marker_t const* marker = static_cast<TRI_df_marker_t const*>(mptr->getDataPtr());
+
+  TRI_shaped_json_t shaped;
+  TRI_EXTRACT_SHAPED_JSON_MARKER(shaped, marker);
+  Json json(shaper->memoryZone(), TRI_JsonShapedJson(shaper, &shaped));
+  char const* key = TRI_EXTRACT_MARKER_KEY(marker);
+  std::string id(resolver->getCollectionName(cid));
+  id.push_back('/');
+  id.append(key);
+  json(TRI_VOC_ATTRIBUTE_ID, Json(id));
+  json(TRI_VOC_ATTRIBUTE_REV, Json(std::to_string(TRI_EXTRACT_MARKER_RID(marker))));
+  json(TRI_VOC_ATTRIBUTE_KEY, Json(key));
+
+  if (TRI_IS_EDGE_MARKER(marker)) {
+    std::string from(resolver->getCollectionNameCluster(TRI_EXTRACT_MARKER_FROM_CID(marker)));
+    from.push_back('/');
+    from.append(TRI_EXTRACT_MARKER_FROM_KEY(marker));
+    json(TRI_VOC_ATTRIBUTE_FROM, Json(from));
+    std::string to(resolver->getCollectionNameCluster(TRI_EXTRACT_MARKER_TO_CID(marker)));
+
+    to.push_back('/');
+    to.append(TRI_EXTRACT_MARKER_TO_KEY(marker));
+    json(TRI_VOC_ATTRIBUTE_TO, Json(to));
+  }
+
+  return json;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Transforms VertexId to Json
+////////////////////////////////////////////////////////////////////////////////
+
+static Json VertexIdToJson (triagens::arango::AqlTransaction* trx,
+                            CollectionNameResolver const* resolver,
+                            VertexId const& id) {
+  TRI_doc_mptr_copy_t mptr;
+  auto collection = trx->trxCollection(id.cid);
+  int res = trx->readSingle(collection, &mptr, id.key); 
+
+  if (res != TRI_ERROR_NO_ERROR) {
+    THROW_ARANGO_EXCEPTION(res);
+  }
+
+  return TRI_ExpandShapedJson(
+    collection->_collection->_collection->getShaper(),
+    resolver,
+    id.cid,
+    &mptr
+  );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Transforms VertexId to std::string
+////////////////////////////////////////////////////////////////////////////////
+
+static std::string VertexIdToString (CollectionNameResolver const* resolver,
+                                     VertexId const& id) {
+  return resolver->getCollectionName(id.cid) + "/" + std::string(id.key);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Transforms an unordered_map<VertexId> to AQL json values
+////////////////////////////////////////////////////////////////////////////////
+
+static AqlValue VertexIdsToAqlValue (triagens::arango::AqlTransaction* trx,
+                                     CollectionNameResolver const* resolver,
+                                     std::unordered_set<VertexId>& ids,
+                                     bool includeData = false) {
+  std::unique_ptr<Json> result(new Json(Json::Array, ids.size()));
+
+  if (includeData) {
+    for (auto& it : ids) {
+      result->add(Json(VertexIdToJson(trx, resolver, it)));
+    }
+  } 
+  else {
+    for (auto& it : ids) {
+      result->add(Json(VertexIdToString(resolver, it)));
+    }
+  }
+
+  AqlValue v(result.get());
+  result.release();
+
+  return v;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief function NEIGHBORS
+////////////////////////////////////////////////////////////////////////////////
+
+AqlValue Functions::Neighbors (triagens::aql::Query* query,
+                               triagens::arango::AqlTransaction* trx,
+                               FunctionParameters const& parameters) {
+  size_t const n = parameters.size();
+  basics::traverser::NeighborsOptions opts;
+
+  if (n < 4 || n > 6) {
+    THROW_ARANGO_EXCEPTION_PARAMS(TRI_ERROR_QUERY_FUNCTION_ARGUMENT_NUMBER_MISMATCH, "NEIGHBORS", (int) 4, (int) 6);
+  }
+
+  auto resolver = trx->resolver();
+
+  Json vertexCol = ExtractFunctionParameter(trx, parameters, 0, false);
+
+  if (! vertexCol.isString()) {
+    THROW_ARANGO_EXCEPTION_PARAMS(TRI_ERROR_QUERY_FUNCTION_ARGUMENT_TYPE_MISMATCH, "NEIGHBORS");
+  }
+  std::string vColName = basics::JsonHelper::getStringValue(vertexCol.json(), "");
+
+  Json edgeCol = ExtractFunctionParameter(trx, parameters, 1, false);
+
+  if (! edgeCol.isString()) {
+    THROW_ARANGO_EXCEPTION_PARAMS(TRI_ERROR_QUERY_FUNCTION_ARGUMENT_TYPE_MISMATCH, "NEIGHBORS");
+  }
+  std::string eColName = basics::JsonHelper::getStringValue(edgeCol.json(), "");
+
+  Json vertexInfo = ExtractFunctionParameter(trx, parameters, 2, false);
+  std::string vertexId;
+  if (vertexInfo.isString()) {
+    vertexId = basics::JsonHelper::getStringValue(vertexInfo.json(), "");
+    if (vertexId.find("/") != std::string::npos) {
+      
+      // TODO tmp can be replaced by Traversal::IdStringToVertexId
+      size_t split;
+      char const* str = vertexId.c_str();
+
+      if (! TRI_ValidateDocumentIdKeyGenerator(str, &split)) {
+        THROW_ARANGO_EXCEPTION(TRI_ERROR_ARANGO_DOCUMENT_KEY_BAD);
+      }
+
+      std::string const collectionName = vertexId.substr(0, split);
+      auto coli = resolver->getCollectionStruct(collectionName);
+
+      if (coli == nullptr || collectionName.compare(vColName) != 0) {
+        THROW_ARANGO_EXCEPTION(TRI_ERROR_ARANGO_COLLECTION_NOT_FOUND);
+      }
+
+      VertexId v(coli->_cid, const_cast<char*>(str + split + 1));
+      opts.start = v;
+    }
+    else {
+      VertexId v(resolver->getCollectionId(vColName), vertexId.c_str());
+      opts.start = v;
+    }
+  }
+  else if (vertexInfo.isObject()) {
+    if (! vertexInfo.has("_id")) {
+      THROW_ARANGO_EXCEPTION_PARAMS(TRI_ERROR_QUERY_FUNCTION_ARGUMENT_TYPE_MISMATCH, "NEIGHBORS");
+    }
+    vertexId = basics::JsonHelper::getStringValue(vertexInfo.get("_id").json(), "");
+    // TODO tmp can be replaced by Traversal::IdStringToVertexId
+    size_t split;
+    char const* str = vertexId.c_str();
+
+    if (! TRI_ValidateDocumentIdKeyGenerator(str, &split)) {
+      THROW_ARANGO_EXCEPTION(TRI_ERROR_ARANGO_DOCUMENT_KEY_BAD);
+    }
+
+    std::string const collectionName = vertexId.substr(0, split);
+    auto coli = resolver->getCollectionStruct(collectionName);
+
+    if (coli == nullptr || collectionName.compare(vColName) != 0) {
+      THROW_ARANGO_EXCEPTION(TRI_ERROR_ARANGO_COLLECTION_NOT_FOUND);
+    }
+
+    VertexId v(coli->_cid, const_cast<char*>(str + split + 1));
+    opts.start = v;
+  }
+  else {
+    THROW_ARANGO_EXCEPTION_PARAMS(TRI_ERROR_QUERY_FUNCTION_ARGUMENT_TYPE_MISMATCH, "NEIGHBORS");
+  }
+
+  Json direction = ExtractFunctionParameter(trx, parameters, 3, false);
+  if (direction.isString()) {
+    std::string const dir = basics::JsonHelper::getStringValue(direction.json(), "");
+    if (dir.compare("outbound") == 0) {
+      opts.direction = TRI_EDGE_OUT;
+    }
+    else if (dir.compare("inbound") == 0) {
+      opts.direction = TRI_EDGE_IN;
+    }
+    else if (dir.compare("any") == 0) {
+      opts.direction = TRI_EDGE_ANY;
+    }
+    else {
+      THROW_ARANGO_EXCEPTION_PARAMS(TRI_ERROR_QUERY_FUNCTION_ARGUMENT_TYPE_MISMATCH, "NEIGHBORS");
+    }
+  }
+  else {
+    THROW_ARANGO_EXCEPTION_PARAMS(TRI_ERROR_QUERY_FUNCTION_ARGUMENT_TYPE_MISMATCH, "NEIGHBORS");
+  }
+
+
+  bool includeData = false;
+
+  if (n > 5) {
+    auto options = ExtractFunctionParameter(trx, parameters, 5, false);
+    if (! options.isObject()) {
+      THROW_ARANGO_EXCEPTION_PARAMS(TRI_ERROR_QUERY_FUNCTION_ARGUMENT_TYPE_MISMATCH, "NEIGHBORS");
+    }
+    includeData = basics::JsonHelper::getBooleanValue(options.json(), "includeData", false);
+    opts.minDepth = basics::JsonHelper::getNumericValue<uint64_t>(options.json(), "minDepth", 1);
+    if (opts.minDepth == 0) {
+      opts.maxDepth = basics::JsonHelper::getNumericValue<uint64_t>(options.json(), "maxDepth", 1);
+    } 
+    else {
+      opts.maxDepth = basics::JsonHelper::getNumericValue<uint64_t>(options.json(), "maxDepth", opts.minDepth);
+    }
+  }
+
+  std::unordered_set<VertexId> neighbors;
+
+
+  TRI_voc_cid_t eCid = resolver->getCollectionId(eColName);
+
+
+  // Function to return constant distance
+  auto wc = [](TRI_doc_mptr_copy_t& edge) -> double { return 1; };
+
+  std::unique_ptr<EdgeCollectionInfo> eci(new EdgeCollectionInfo(
+    eCid,
+    trx->documentCollection(eCid),
+    wc
+  ));
+  TRI_IF_FAILURE("EdgeCollectionInfoOOM1") {
+    THROW_ARANGO_EXCEPTION(TRI_ERROR_DEBUG);
+  }
+  
+
+  if (n > 4) {
+    auto edgeExamples = ExtractFunctionParameter(trx, parameters, 4, false);
+    if (! (edgeExamples.isArray() && edgeExamples.size() == 0) ) {
+      opts.addEdgeFilter(edgeExamples, eci->getShaper(), eCid, resolver); 
+    }
+  }
+  
+  std::vector<EdgeCollectionInfo*> edgeCollectionInfos;
+  triagens::basics::ScopeGuard guard{
+    []() -> void { },
+    [&edgeCollectionInfos]() -> void {
+      for (auto& p : edgeCollectionInfos) {
+        delete p;
+      }
+    }
+  };
+  edgeCollectionInfos.emplace_back(eci.get());
+  eci.release();
+  TRI_IF_FAILURE("EdgeCollectionInfoOOM2") {
+    THROW_ARANGO_EXCEPTION(TRI_ERROR_DEBUG);
+  }
+
+  TRI_RunNeighborsSearch(
+    edgeCollectionInfos,
+    opts,
+    neighbors
+  );
+
+  return VertexIdsToAqlValue(trx, resolver, neighbors, includeData);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief orders a ditch for a collection used in the query and read-locks
+/// it. indexes that are queried directly need the lock, and so does the
+/// access to the documents they return. the caller must release the lock
+/// with unlockRead
+////////////////////////////////////////////////////////////////////////////////
+
+static TRI_transaction_collection_t* ReadLockCollection (triagens::arango::AqlTransaction* trx,
+                                                         TRI_voc_cid_t cid) {
+  auto trxCollection = trx->trxCollection(cid);
+  TRI_ASSERT(trxCollection != nullptr);
+
+  if (trx->orderDitch(trxCollection) == nullptr) {
+    THROW_ARANGO_EXCEPTION(TRI_ERROR_OUT_OF_MEMORY);
+  }
+
+  int res = trx->lockRead(trxCollection);
+
+  if (res != TRI_ERROR_NO_ERROR) {
+    THROW_ARANGO_EXCEPTION(res);
+  }
+
+  return trxCollection;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief returns the id of a collection used in the query
+////////////////////////////////////////////////////////////////////////////////
+
+static TRI_voc_cid_t GetCollectionId (triagens::arango::AqlTransaction* trx,
+                                      std::string const& collectionName) {
+  TRI_voc_cid_t const cid = trx->resolver()->getCollectionId(collectionName);
+
+  if (cid == 0) {
+    THROW_ARANGO_EXCEPTION_PARAMS(TRI_ERROR_ARANGO_COLLECTION_NOT_FOUND, collectionName.c_str());
+  }
+
+  if (trx->trxCollection(cid) == nullptr) {
+    // collection was not registered when the query started
+    THROW_ARANGO_EXCEPTION_MESSAGE(TRI_ERROR_TRANSACTION_UNREGISTERED_COLLECTION, collectionName);
+  }
+
+  return cid;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief returns the first geo index of a collection used in the query.
+/// the collection must be locked by the caller
+////////////////////////////////////////////////////////////////////////////////
+
+static triagens::arango::GeoIndex2* GetGeoIndex (triagens::arango::AqlTransaction* trx,
+                                                 std::string const& collectionName,
+                                                 TRI_voc_cid_t cid) {
+  auto document = trx->documentCollection(cid);
+
+  for (auto const& idx : document->allIndexes()) {
+    if (idx->type() == triagens::arango::Index::TRI_IDX_TYPE_GEO1_INDEX ||
+        idx->type() == triagens::arango::Index::TRI_IDX_TYPE_GEO2_INDEX) {
+      return static_cast<triagens::arango::GeoIndex2*>(idx);
+    }
+  }
+
+  THROW_ARANGO_EXCEPTION_PARAMS(TRI_ERROR_QUERY_GEO_INDEX_MISSING, collectionName.c_str());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief converts the result of a geo index query into an array of
+/// documents, sorted by their distance. if a distance attribute name is
+/// given, the distance is stored in each document under this name.
+/// if a bounding rectangle is given, only points inside of it are returned.
+/// the coordinates are freed in any case
+////////////////////////////////////////////////////////////////////////////////
+
+static AqlValue GeoCoordinatesToAqlValue (triagens::arango::AqlTransaction* trx,
+                                          TRI_voc_cid_t cid,
+                                          GeoCoordinates* cors,
+                                          std::string const& distanceAttribute,
+                                          double const* bounds = nullptr) {
+  if (cors == nullptr) {
+    return AqlValue(new Json(Json::Array));
+  }
+
+  std::vector<std::pair<double, TRI_doc_mptr_t const*>> found;
+
+  try {
+    size_t const n = cors->length;
+    found.reserve(n);
+
+    for (size_t i = 0; i < n; ++i) {
+      GeoCoordinate const& point = cors->coordinates[i];
+
+      if (bounds != nullptr &&
+          (point.latitude < bounds[0] || point.latitude > bounds[1] ||
+           point.longitude < bounds[2] || point.longitude > bounds[3])) {
+        continue;
+      }
+
+      found.emplace_back(cors->distances[i], static_cast<TRI_doc_mptr_t const*>(point.data));
+    }
+  }
+  catch (...) {
+    GeoIndex_CoordinatesFree(cors);
+    throw;
+  }
+
+  GeoIndex_CoordinatesFree(cors);
+
+  // sort result by distance
+  std::sort(found.begin(), found.end(), [] (std::pair<double, TRI_doc_mptr_t const*> const& lhs,
+                                            std::pair<double, TRI_doc_mptr_t const*> const& rhs) {
+    return lhs.first < rhs.first;
+  });
+
+  auto shaper = trx->documentCollection(cid)->getShaper();
+  auto resolver = trx->resolver();
+
+  std::unique_ptr<Json> result(new Json(Json::Array, found.size()));
+
+  for (auto const& it : found) {
+    Json doc(TRI_ExpandShapedJson(shaper, resolver, cid, it.second));
+
+    if (! distanceAttribute.empty()) {
+      TRI_json_t distance;
+      TRI_InitNumberJson(&distance, it.first);
+      TRI_ReplaceObjectJson(doc.zone(), doc.json(), distanceAttribute.c_str(), &distance);
+    }
+
+    result->add(doc);
+  }
+
+  AqlValue v(result.get());
+  result.release();
+
+  return v;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief extracts the optional distance attribute name of a geo function
+////////////////////////////////////////////////////////////////////////////////
+
+static std::string GetDistanceAttribute (triagens::aql::Query* query,
+                                         triagens::arango::AqlTransaction* trx,
+                                         FunctionParameters const& parameters,
+                                         size_t position,
+                                         char const* functionName) {
+  Json attribute = ExtractFunctionParameter(trx, parameters, position, false);
+
+  if (attribute.isNull()) {
+    return "";
+  }
+
+  if (! attribute.isString()) {
+    RegisterInvalidArgumentWarning(query, functionName);
+  }
+  
+  triagens::basics::StringBuffer buffer(TRI_UNKNOWN_MEM_ZONE);
+  AppendAsString(buffer, attribute.json());
+
+  return std::string(buffer.c_str(), buffer.length());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief function NEAR
+////////////////////////////////////////////////////////////////////////////////
+
+AqlValue Functions::Near (triagens::aql::Query* query,
+                          triagens::arango::AqlTransaction* trx,
+                          FunctionParameters const& parameters) {
+  size_t const n = parameters.size();
+
+  if (n < 3 || n > 5) {
+    THROW_ARANGO_EXCEPTION_PARAMS(TRI_ERROR_QUERY_FUNCTION_ARGUMENT_NUMBER_MISMATCH, "NEAR", (int) 3, (int) 5);
+  }
+
+  Json collection = ExtractFunctionParameter(trx, parameters, 0, false);
+
+  if (! collection.isString()) {
+    THROW_ARANGO_EXCEPTION_PARAMS(TRI_ERROR_QUERY_FUNCTION_ARGUMENT_TYPE_MISMATCH, "NEAR");
+  }
+
+  std::string const collectionName = basics::JsonHelper::getStringValue(collection.json(), "");
+
+  bool isValid;
+  double const latitude = ValueToNumber(ExtractFunctionParameter(trx, parameters, 1, false).json(), isValid);
+  double const longitude = ValueToNumber(ExtractFunctionParameter(trx, parameters, 2, false).json(), isValid);
+
+  // default limit
+  double limit = 100.0;
+  
+  if (n > 3) {
+    Json limitJson = ExtractFunctionParameter(trx, parameters, 3, false);
+
+    if (! limitJson.isNull()) {
+      limit = ValueToNumber(limitJson.json(), isValid);
+    }
+  }
+
+  std::string const distanceAttribute = GetDistanceAttribute(query, trx, parameters, 4, "NEAR");
+
+  TRI_voc_cid_t const cid = GetCollectionId(trx, collectionName);
+
+  // the geo index has no lock of its own, and the documents it returns
+  // are read afterwards
+  auto trxCollection = ReadLockCollection(trx, cid);
+  triagens::basics::ScopeGuard guard{
+    []() -> void { },
+    [&trx, &trxCollection]() -> void {
+      trx->unlockRead(trxCollection);
+    }
+  };
+
+  auto index = GetGeoIndex(trx, collectionName, cid);
+
+  if (limit < 1.0) {
+    return AqlValue(new Json(Json::Array));
+  }
+
+  GeoCoordinates* cors = index->nearQuery(latitude, longitude, static_cast<size_t>(limit));
+
+  return GeoCoordinatesToAqlValue(trx, cid, cors, distanceAttribute);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief function WITHIN
+////////////////////////////////////////////////////////////////////////////////
+
+AqlValue Functions::Within (triagens::aql::Query* query,
+                            triagens::arango::AqlTransaction* trx,
+                            FunctionParameters const& parameters) {
+  size_t const n = parameters.size();
+
+  if (n < 4 || n > 5) {
+    THROW_ARANGO_EXCEPTION_PARAMS(TRI_ERROR_QUERY_FUNCTION_ARGUMENT_NUMBER_MISMATCH, "WITHIN", (int) 4, (int) 5);
+  }
+
+  Json collection = ExtractFunctionParameter(trx, parameters, 0, false);
+
+  if (! collection.isString()) {
+    THROW_ARANGO_EXCEPTION_PARAMS(TRI_ERROR_QUERY_FUNCTION_ARGUMENT_TYPE_MISMATCH, "WITHIN");
+  }
+
+  std::string const collectionName = basics::JsonHelper::getStringValue(collection.json(), "");
+
+  bool isValid;
+  double const latitude = ValueToNumber(ExtractFunctionParameter(trx, parameters, 1, false).json(), isValid);
+  double const longitude = ValueToNumber(ExtractFunctionParameter(trx, parameters, 2, false).json(), isValid);
+  double const radius = ValueToNumber(ExtractFunctionParameter(trx, parameters, 3, false).json(), isValid);
+
+  std::string const distanceAttribute = GetDistanceAttribute(query, trx, parameters, 4, "WITHIN");
+
+  TRI_voc_cid_t const cid = GetCollectionId(trx, collectionName);
+
+  // the geo index has no lock of its own, and the documents it returns
+  // are read afterwards
+  auto trxCollection = ReadLockCollection(trx, cid);
+  triagens::basics::ScopeGuard guard{
+    []() -> void { },
+    [&trx, &trxCollection]() -> void {
+      trx->unlockRead(trxCollection);
+    }
+  };
+
+  auto index = GetGeoIndex(trx, collectionName, cid);
+
+  GeoCoordinates* cors = index->withinQuery(latitude, longitude, radius);
+
+  return GeoCoordinatesToAqlValue(trx, cid, cors, distanceAttribute);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief function WITHIN_RECTANGLE
+/// looks up all points within the circle around the rectangle's center that
+/// touches its corners, and then removes all points outside the rectangle
+////////////////////////////////////////////////////////////////////////////////
+
+AqlValue Functions::WithinRectangle (triagens::aql::Query* query,
+                                     triagens::arango::AqlTransaction* trx,
+                                     FunctionParameters const& parameters) {
+  size_t const n = parameters.size();
+
+  if (n != 5) {
+    THROW_ARANGO_EXCEPTION_PARAMS(TRI_ERROR_QUERY_FUNCTION_ARGUMENT_NUMBER_MISMATCH, "WITHIN_RECTANGLE", (int) 5, (int) 5);
+  }
+
+  Json collection = ExtractFunctionParameter(trx, parameters, 0, false);
+
+  if (! collection.isString()) {
+    THROW_ARANGO_EXCEPTION_PARAMS(TRI_ERROR_QUERY_FUNCTION_ARGUMENT_TYPE_MISMATCH, "WITHIN_RECTANGLE");
+  }
+
+  std::string const collectionName = basics::JsonHelper::getStringValue(collection.json(), "");
+
+  double values[4];
+
+  for (size_t i = 0; i < 4; ++i) {
+    Json value = ExtractFunctionParameter(trx, parameters, i + 1, false);
+
+    if (! value.isNumber()) {
+      RegisterInvalidArgumentWarning(query, "WITHIN_RECTANGLE");
+      return AqlValue(new Json(Json::Null));
+    }
+
+    values[i] = basics::JsonHelper::getNumericValue<double>(value.json(), 0.0);
+  }
+
+  double const latitude1  = values[0];
+  double const longitude1 = values[1];
+  double const latitude2  = values[2];
+  double const longitude2 = values[3];
+
+  TRI_voc_cid_t const cid = GetCollectionId(trx, collectionName);
+
+  // the geo index has no lock of its own, and the documents it returns
+  // are read afterwards
+  auto trxCollection = ReadLockCollection(trx, cid);
+  triagens::basics::ScopeGuard guard{
+    []() -> void { },
+    [&trx, &trxCollection]() -> void {
+      trx->unlockRead(trxCollection);
+    }
+  };
+
+  auto index = GetGeoIndex(trx, collectionName, cid);
+
+  // distance between the corners in meters
+  double const deltaLat = (latitude2 - latitude1) * M_PI / 180.0;
+  double const deltaLon = (longitude2 - longitude1) * M_PI / 180.0;
+  double const a = std::sin(deltaLat / 2.0) * std::sin(deltaLat / 2.0) + 
+                   std::cos(latitude1 * M_PI / 180.0) * std::cos(latitude2 * M_PI / 180.0) *
+                   std::sin(deltaLon / 2.0) * std::sin(deltaLon / 2.0);
+  double const c = 2.0 * std::atan2(std::sqrt(a), std::sqrt(1.0 - a));
+  double const diameter = 6378.137 /* radius of earth in kilometers */ * c * 1000.0;
+
+  double const midLatitude  = latitude1 + (latitude2 - latitude1) * 0.5;
+  double const midLongitude = longitude1 + (longitude2 - longitude1) * 0.5;
+
+  // lower and upper latitude, lower and upper longitude
+  double const bounds[4] = {
+    (std::min)(latitude1, latitude2),
+    (std::max)(latitude1, latitude2),
+    (std::min)(longitude1, longitude2),
+    (std::max)(longitude1, longitude2)
+  };
+
+  GeoCoordinates* cors = index->withinQuery(midLatitude, midLongitude, diameter);
+
+  return GeoCoordinatesToAqlValue(trx, cid, cors, "", &bounds[0]);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief extracts a coordinate from an array at the given position. returns
+/// NaN if there is no number at the position, so that any comparison with it
+/// fails
+////////////////////////////////////////////////////////////////////////////////
+
+static double GetCoordinate (TRI_json_t const* json,
+                             size_t position) {
+  if (TRI_IsArrayJson(json) && position < TRI_LengthArrayJson(json)) {
+    auto value = static_cast<TRI_json_t const*>(TRI_AtVector(&json->_value._objects, position));
+
+    if (TRI_IsNumberJson(value)) {
+      return value->_value._number;
+    }
+  }
+
+  return std::numeric_limits<double>::quiet_NaN();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief function IS_IN_POLYGON
+////////////////////////////////////////////////////////////////////////////////
+
+AqlValue Functions::IsInPolygon (triagens::aql::Query* query,
+                                 triagens::arango::AqlTransaction* trx,
+                                 FunctionParameters const& parameters) {
+  size_t const n = parameters.size();
+
+  if (n < 2 || n > 3) {
+    THROW_ARANGO_EXCEPTION_PARAMS(TRI_ERROR_QUERY_FUNCTION_ARGUMENT_NUMBER_MISMATCH, "IS_IN_POLYGON", (int) 2, (int) 3);
+  }
+
+  Json points = ExtractFunctionParameter(trx, parameters, 0, false);
+
+  if (! points.isArray()) {
+    RegisterWarning(query, "POINT_IN_POLYGON", TRI_ERROR_QUERY_ARRAY_EXPECTED);
+    return AqlValue(new Json(false));
+  }
+
+  Json latitude = ExtractFunctionParameter(trx, parameters, 1, false);
+  Json longitude = ExtractFunctionParameter(trx, parameters, 2, false);
+
+  double searchLat, searchLon;
+  size_t pointLat, pointLon;
+
+  if (latitude.isArray()) {
+    if (ValueToBoolean(longitude.json())) {
+      // first list value is longitude, then latitude
+      searchLat = GetCoordinate(latitude.json(), 1);
+      searchLon = GetCoordinate(latitude.json(), 0);
+      pointLat = 1;
+      pointLon = 0;
+    }
+    else {
+      // first list value is latitude, then longitude
+      searchLat = GetCoordinate(latitude.json(), 0);
+      searchLon = GetCoordinate(latitude.json(), 1);
+      pointLat = 0;
+      pointLon = 1;
+    }
+  }
+  else if (latitude.isNumber() && longitude.isNumber()) {
+    searchLat = basics::JsonHelper::getNumericValue<double>(latitude.json(), 0.0);
+    searchLon = basics::JsonHelper::getNumericValue<double>(longitude.json(), 0.0);
+    pointLat = 0;
+    pointLon = 1;
+  }
+  else {
+    RegisterWarning(query, "POINT_IN_POLYGON", TRI_ERROR_QUERY_FUNCTION_ARGUMENT_TYPE_MISMATCH);
+    return AqlValue(new Json(false));
+  }
+
+  TRI_json_t const* polygon = points.json();
+  size_t const length = TRI_LengthArrayJson(polygon);
+
+  if (length == 0) {
+    return AqlValue(new Json(false));
   }
 
-  std::unordered_map<TRI_json_t*, size_t, triagens::basics::JsonHash, triagens::basics::JsonEqual> values(
-    512, 
-    triagens::basics::JsonHash(), 
-    triagens::basics::JsonEqual()
-  );
+  bool oddNodes = false;
+  size_t j = length - 1;
 
-  auto freeValues = [&values] () -> void {
-    for (auto& it : values) {
-      TRI_FreeJson(TRI_UNKNOWN_MEM_ZONE, it.first);
+  for (size_t i = 0; i < length; ++i) {
+    auto current = static_cast<TRI_json_t const*>(TRI_AtVector(&polygon->_value._objects, i));
+
+    if (! TRI_IsArrayJson(current)) {
+      continue;
     }
-    values.clear();
-  };
 
-  std::unique_ptr<TRI_json_t> result;
+    auto previous = static_cast<TRI_json_t const*>(TRI_AtVector(&polygon->_value._objects, j));
 
-  try {
-    for (size_t i = 0; i < n; ++i) {
-      auto value = ExtractFunctionParameter(trx, parameters, i, false);
+    double const iLat = GetCoordinate(current, pointLat);
+    double const iLon = GetCoordinate(current, pointLon);
+    double const jLat = GetCoordinate(previous, pointLat);
+    double const jLon = GetCoordinate(previous, pointLon);
 
-      if (! value.isArray()) {
-        // not an array
-        freeValues();
-        RegisterWarning(query, "INTERSECTION", TRI_ERROR_QUERY_ARRAY_EXPECTED);
-        return AqlValue(new Json(Json::Null));
+    if (((iLat < searchLat && jLat >= searchLat) || 
+         (jLat < searchLat && iLat >= searchLat)) &&
+        (iLon <= searchLon || jLon <= searchLon)) {
+      if ((iLon + (searchLat - iLat) / (jLat - iLat) * (jLon - iLon)) < searchLon) {
+        oddNodes = ! oddNodes;
       }
+    }
 
-      TRI_json_t const* valueJson = value.json();
-      size_t const nrValues = TRI_LengthArrayJson(valueJson);
+    j = i;
+  }
 
-      for (size_t j = 0; j < nrValues; ++j) {
-        auto value = static_cast<TRI_json_t const*>(TRI_AddressVector(&valueJson->_value._objects, j));
+  return AqlValue(new Json(oddNodes));
+}
 
-        if (i == 0) {
-          // round one
-          std::unique_ptr<TRI_json_t> copy(TRI_CopyJson(TRI_UNKNOWN_MEM_ZONE, value));
+////////////////////////////////////////////////////////////////////////////////
+/// @brief function FULLTEXT
+/// the matching documents are returned as a vector of blocks with shaped
+/// values, so they do not need to be converted into JSON
+////////////////////////////////////////////////////////////////////////////////
 
-          if (copy == nullptr) {
-            THROW_ARANGO_EXCEPTION(TRI_ERROR_OUT_OF_MEMORY);
-          }
-    
-          TRI_IF_FAILURE("AqlFunctions::OutOfMemory1") {
-            THROW_ARANGO_EXCEPTION(TRI_ERROR_DEBUG);
-          }
+AqlValue Functions::Fulltext (triagens::aql::Query* query,
+                              triagens::arango::AqlTransaction* trx,
+                              FunctionParameters const& parameters) {
+  size_t const n = parameters.size();
 
-          auto r = values.emplace(copy.get(), 1);
- 
-          if (r.second) {
-            // successfully inserted
-            copy.release();
-          }
-        }
-        else {
-          // check if we have seen the same element before
-          auto it = values.find(const_cast<TRI_json_t*>(value));
+  if (n < 3 || n > 4) {
+    THROW_ARANGO_EXCEPTION_PARAMS(TRI_ERROR_QUERY_FUNCTION_ARGUMENT_NUMBER_MISMATCH, "FULLTEXT", (int) 3, (int) 4);
+  }
 
-          if (it != values.end()) {
-            // already seen
-            TRI_ASSERT((*it).second > 0);
-            ++((*it).second);
-          }
-        }
-      }
-    }
- 
-    // count how many valid we have 
-    size_t total = 0;
+  Json collection = ExtractFunctionParameter(trx, parameters, 0, false);
 
-    for (auto const& it : values) {
-      if (it.second == n) {
-        ++total;
+  if (! collection.isString()) {
+    THROW_ARANGO_EXCEPTION_PARAMS(TRI_ERROR_QUERY_FUNCTION_ARGUMENT_TYPE_MISMATCH, "FULLTEXT");
+  }
+
+  std::string const collectionName = basics::JsonHelper::getStringValue(collection.json(), "");
+
+  Json attribute = ExtractFunctionParameter(trx, parameters, 1, false);
+
+  if (! attribute.isString()) {
+    THROW_ARANGO_EXCEPTION_PARAMS(TRI_ERROR_QUERY_FUNCTION_ARGUMENT_TYPE_MISMATCH, "FULLTEXT");
+  }
+
+  std::string const attributeName = basics::JsonHelper::getStringValue(attribute.json(), "");
+
+  Json queryString = ExtractFunctionParameter(trx, parameters, 2, false);
+
+  if (! queryString.isString()) {
+    THROW_ARANGO_EXCEPTION_PARAMS(TRI_ERROR_QUERY_FUNCTION_ARGUMENT_TYPE_MISMATCH, "FULLTEXT");
+  }
+
+  size_t maxResults = 0; // 0 means "all results"
+
+  if (n > 3) {
+    Json limit = ExtractFunctionParameter(trx, parameters, 3, false);
+
+    if (limit.isNumber()) {
+      int64_t value = basics::JsonHelper::getNumericValue<int64_t>(limit.json(), 0);
+
+      if (value > 0) {
+        maxResults = static_cast<size_t>(value);
       }
     }
+  }
 
-    result.reset(TRI_CreateArrayJson(TRI_UNKNOWN_MEM_ZONE, total));
+  TRI_voc_cid_t const cid = GetCollectionId(trx, collectionName);
 
-    if (result == nullptr) {
-      THROW_ARANGO_EXCEPTION(TRI_ERROR_OUT_OF_MEMORY);
+  // the shaped values point into the datafiles, which must stay alive
+  // until the query is finished. the lock protects the master pointers of
+  // the documents found against concurrent removals
+  auto trxCollection = ReadLockCollection(trx, cid);
+  triagens::basics::ScopeGuard guard{
+    []() -> void { },
+    [&trx, &trxCollection]() -> void {
+      trx->unlockRead(trxCollection);
     }
-          
-    TRI_IF_FAILURE("AqlFunctions::OutOfMemory2") {
-      THROW_ARANGO_EXCEPTION(TRI_ERROR_DEBUG);
+  };
+
+  auto document = trx->documentCollection(cid);
+  triagens::arango::FulltextIndex* fulltextIndex = nullptr;
+
+  for (auto const& idx : document->allIndexes()) {
+    if (idx->type() == triagens::arango::Index::TRI_IDX_TYPE_FULLTEXT_INDEX &&
+        ! idx->fields().empty() &&
+        idx->fields()[0] == attributeName) {
+      fulltextIndex = static_cast<triagens::arango::FulltextIndex*>(idx);
+      break;
     }
-   
-    for (auto& it : values) {
-      if (it.second == n) {
-        TRI_PushBack3ArrayJson(TRI_UNKNOWN_MEM_ZONE, result.get(), it.first); 
-      }
-      else {
-        TRI_FreeJson(TRI_UNKNOWN_MEM_ZONE, it.first);
+  }
+
+  if (fulltextIndex == nullptr) {
+    THROW_ARANGO_EXCEPTION_PARAMS(TRI_ERROR_QUERY_FULLTEXT_INDEX_MISSING, collectionName.c_str());
+  }
+
+  TRI_fulltext_query_t* ft = TRI_CreateQueryFulltextIndex(TRI_FULLTEXT_SEARCH_MAX_WORDS, maxResults);
+
+  if (ft == nullptr) {
+    THROW_ARANGO_EXCEPTION(TRI_ERROR_OUT_OF_MEMORY);
+  }
+
+  bool isSubstringQuery = false;
+  int res = TRI_ParseQueryFulltextIndex(ft, basics::JsonHelper::getStringValue(queryString.json(), "").c_str(), &isSubstringQuery);
+
+  if (res == TRI_ERROR_NO_ERROR && isSubstringQuery) {
+    res = TRI_ERROR_NOT_IMPLEMENTED;
+  }
+
+  if (res != TRI_ERROR_NO_ERROR) {
+    TRI_FreeQueryFulltextIndex(ft);
+    THROW_ARANGO_EXCEPTION(res);
+  }
+
+  // note: the query is freed by the index
+  TRI_fulltext_result_t* queryResult = TRI_QueryFulltextIndex(fulltextIndex->internals(), ft);
+
+  if (queryResult == nullptr) {
+    THROW_ARANGO_EXCEPTION(TRI_ERROR_OUT_OF_MEMORY);
+  }
+
+  std::unique_ptr<std::vector<AqlItemBlock*>> blocks(new std::vector<AqlItemBlock*>());
+
+  try {
+    size_t const numDocuments = static_cast<size_t>(queryResult->_numDocuments);
+    size_t count = 0;
+
+    while (count < numDocuments) {
+      size_t const sizeNext = (std::min)(numDocuments - count, ExecutionBlock::DefaultBatchSize);
+      std::unique_ptr<AqlItemBlock> block(new AqlItemBlock(sizeNext, 1));
+
+      for (size_t i = 0; i < sizeNext; ++i) {
+        auto mptr = reinterpret_cast<TRI_doc_mptr_t const*>(queryResult->_documents[count++]);
+        block->setValue(i, 0, AqlValue(static_cast<TRI_df_marker_t const*>(mptr->getDataPtr())));
       }
+      block->setDocumentCollection(0, document);
+
+      blocks->emplace_back(block.get());
+      block.release();
     }
-    values.clear();
-   
-  } 
+  }
   catch (...) {
-    freeValues();
+    TRI_FreeResultFulltextIndex(queryResult);
+    for (auto& it : *blocks) {
+      delete it;
+    }
     throw;
   }
-    
-  TRI_IF_FAILURE("AqlFunctions::OutOfMemory3") {
-    THROW_ARANGO_EXCEPTION(TRI_ERROR_DEBUG);
+
+  TRI_FreeResultFulltextIndex(queryResult);
+
+  if (blocks->empty()) {
+    return AqlValue(new Json(Json::Array));
   }
-      
-  auto jr = new Json(TRI_UNKNOWN_MEM_ZONE, result.get());
-  result.release();
-  return AqlValue(jr);
+
+  AqlValue v(blocks.get());
+  blocks.release();
+
+  return v;
 }
 
-// TODO DELETE THESE HELPER FUNCTIONS.
+////////////////////////////////////////////////////////////////////////////////
+/// @brief number of milliseconds per day
+////////////////////////////////////////////////////////////////////////////////
 
-static inline Json TRI_ExpandShapedJson (VocShaper* shaper,
-                                         CollectionNameResolver const* resolver,
-                                         TRI_voc_cid_t const& cid,
-                                         TRI_doc_mptr_t const* mptr) {
-  TRI_df_marker_t const* marker = static_cast<TRI_df_marker_t const*>(mptr->getDataPtr());
+static double const MillisecondsPerDay = 86400000.0;
 
-  TRI_shaped_json_t shaped;
-  TRI_EXTRACT_SHAPED_JSON_MARKER(shaped, marker);
-  Json json(shaper->memoryZone(), TRI_JsonShapedJson(shaper, &shaped));
-  char const* key = TRI_EXTRACT_MARKER_KEY(marker);
-  std::string id(resolver->getCollectionName(cid));
-  id.push_back('/');
-  id.append(key);
-  json(TRI_VOC_ATTRIBUTE_ID, Json(id));
-  json(TRI_VOC_ATTRIBUTE_REV, Json(std::to_string(TRI_EXTRACT_MARKER_RID(marker))));
-  json(TRI_VOC_ATTRIBUTE_KEY, Json(key));
+////////////////////////////////////////////////////////////////////////////////
+/// @brief largest absolute timestamp value representable by a date, as
+/// defined by ECMAScript's TimeClip
+////////////////////////////////////////////////////////////////////////////////
 
-  if (TRI_IS_EDGE_MARKER(marker)) {
-    std::string from(resolver->getCollectionNameCluster(TRI_EXTRACT_MARKER_FROM_CID(marker)));
-    from.push_back('/');
-    from.append(TRI_EXTRACT_MARKER_FROM_KEY(marker));
-    json(TRI_VOC_ATTRIBUTE_FROM, Json(from));
-    std::string to(resolver->getCollectionNameCluster(TRI_EXTRACT_MARKER_TO_CID(marker)));
+static double const MaxTimestamp = 8.64e15;
 
-    to.push_back('/');
-    to.append(TRI_EXTRACT_MARKER_TO_KEY(marker));
-    json(TRI_VOC_ATTRIBUTE_TO, Json(to));
+////////////////////////////////////////////////////////////////////////////////
+/// @brief components of a date, all in UTC
+////////////////////////////////////////////////////////////////////////////////
+
+enum DateComponent {
+  DATE_COMPONENT_DAYOFWEEK,
+  DATE_COMPONENT_YEAR,
+  DATE_COMPONENT_MONTH,
+  DATE_COMPONENT_DAY,
+  DATE_COMPONENT_HOUR,
+  DATE_COMPONENT_MINUTE,
+  DATE_COMPONENT_SECOND,
+  DATE_COMPONENT_MILLISECOND
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief number of days since the Unix epoch for a date in the proleptic
+/// Gregorian calendar. month is 1-based and must be between 1 and 12, while
+/// day may be outside the valid range for the month and is simply added
+////////////////////////////////////////////////////////////////////////////////
+
+static int64_t DaysFromCivil (int64_t year,
+                              int64_t month,
+                              int64_t day) {
+  year -= (month <= 2 ? 1 : 0);
+  int64_t const era = (year >= 0 ? year : year - 399) / 400;
+  int64_t const yoe = year - era * 400;
+  int64_t const doy = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+  int64_t const doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+
+  return era * 146097 + doe - 719468;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief date in the proleptic Gregorian calendar for a number of days since
+/// the Unix epoch. this is the inverse of DaysFromCivil
+////////////////////////////////////////////////////////////////////////////////
+
+static void CivilFromDays (int64_t days,
+                           int64_t& year,
+                           int64_t& month,
+                           int64_t& day) {
+  days += 719468;
+  int64_t const era = (days >= 0 ? days : days - 146096) / 146097;
+  int64_t const doe = days - era * 146097;
+  int64_t const yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+  int64_t const doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+  int64_t const mp = (5 * doy + 2) / 153;
+
+  day = doy - (153 * mp + 2) / 5 + 1;
+  month = mp + (mp < 10 ? 3 : -9);
+  year = yoe + era * 400 + (month <= 2 ? 1 : 0);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief timestamp for the given date components, which may be outside
+/// their natural ranges. month is 0-based. this follows ECMAScript's
+/// MakeDay / MakeTime, so e.g. month 12 is January of the following year
+////////////////////////////////////////////////////////////////////////////////
+
+static double MakeTimestamp (double year,
+                             double month,
+                             double day,
+                             double hour,
+                             double minute,
+                             double second,
+                             double millisecond) {
+  double const y = year + std::floor(month / 12.0);
+  double const m = month - std::floor(month / 12.0) * 12.0;
+
+  if (std::abs(y) > 400000.0) {
+    // way out of range, and too big for the integer arithmetic below
+    return NAN;
   }
 
-  return json;
+  double const days = static_cast<double>(DaysFromCivil(static_cast<int64_t>(y), static_cast<int64_t>(m) + 1, 1)) + day - 1.0;
+
+  return days * MillisecondsPerDay + 
+         hour * 3600000.0 + 
+         minute * 60000.0 + 
+         second * 1000.0 + 
+         millisecond;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-/// @brief Transforms VertexId to Json
+/// @brief parse a fixed number of digits from a string
 ////////////////////////////////////////////////////////////////////////////////
 
-static Json VertexIdToJson (triagens::arango::AqlTransaction* trx,
-                            CollectionNameResolver const* resolver,
-                            VertexId const& id) {
-  TRI_doc_mptr_copy_t mptr;
-  auto collection = trx->trxCollection(id.cid);
-  int res = trx->readSingle(collection, &mptr, id.key); 
+static bool ParseDigits (char const*& p,
+                         char const* end,
+                         int minDigits,
+                         int maxDigits,
+                         int64_t& result) {
+  int digits = 0;
+  result = 0;
 
-  if (res != TRI_ERROR_NO_ERROR) {
-    THROW_ARANGO_EXCEPTION(res);
+  while (p < end && digits < maxDigits && *p >= '0' && *p <= '9') {
+    result = result * 10 + (*p - '0');
+    ++p;
+    ++digits;
   }
 
-  return TRI_ExpandShapedJson(
-    collection->_collection->_collection->getShaper(),
-    resolver,
-    id.cid,
-    &mptr
-  );
+  return (digits >= minDigits);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-/// @brief Transforms VertexId to std::string
+/// @brief parse a date string into a timestamp
+///
+/// accepted are ISO 8601 dates and date times, with a few relaxations that
+/// the JavaScript implementation of the date functions permitted:
+/// - months and days may consist of a single digit
+/// - the date and time parts may be separated by a space
+/// - the year may be followed by just a month, or nothing at all
+/// - leading and trailing whitespace is ignored
+/// values without a timezone specifier are interpreted as UTC
 ////////////////////////////////////////////////////////////////////////////////
 
-static std::string VertexIdToString (CollectionNameResolver const* resolver,
-                                     VertexId const& id) {
-  return resolver->getCollectionName(id.cid) + "/" + std::string(id.key);
+static bool ParseDateString (char const* p,
+                             char const* end,
+                             double& timestamp) {
+  while (p < end && (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n')) {
+    ++p;
+  }
+  while (end > p && (end[-1] == ' ' || end[-1] == '\t' || end[-1] == '\r' || end[-1] == '\n')) {
+    --end;
+  }
+
+  int64_t year;
+  int64_t month = 1;
+  int64_t day = 1;
+  int64_t hour = 0;
+  int64_t minute = 0;
+  int64_t second = 0;
+  int64_t millisecond = 0;
+  int64_t offset = 0;
+
+  // year, either with 4 digits or as an expanded year with sign and 6 digits
+  if (p < end && (*p == '+' || *p == '-')) {
+    bool const negative = (*p == '-');
+    ++p;
+    if (! ParseDigits(p, end, 6, 6, year)) {
+      return false;
+    }
+    if (negative) {
+      year = -year;
+    }
+  }
+  else if (! ParseDigits(p, end, 4, 4, year)) {
+    return false;
+  }
+
+  bool hasDay = false;
+
+  if (p < end && *p == '-') {
+    ++p;
+    if (! ParseDigits(p, end, 1, 2, month) || month < 1 || month > 12) {
+      return false;
+    }
+
+    if (p < end && *p == '-') {
+      ++p;
+      if (! ParseDigits(p, end, 1, 2, day) || day < 1 || day > 31) {
+        return false;
+      }
+      hasDay = true;
+    }
+  }
+
+  if (hasDay && p < end && (*p == 'T' || *p == 't' || *p == ' ')) {
+    ++p;
+
+    if (! ParseDigits(p, end, 2, 2, hour) || hour > 23 ||
+        p >= end || *p++ != ':' ||
+        ! ParseDigits(p, end, 2, 2, minute) || minute > 59) {
+      return false;
+    }
+
+    if (p < end && *p == ':') {
+      ++p;
+      if (! ParseDigits(p, end, 2, 2, second) || second > 59) {
+        return false;
+      }
+
+      if (p < end && *p == '.') {
+        ++p;
+        // only the first three fractional digits are significant
+        int64_t factor = 100;
+        char const* start = p;
+
+        while (p < end && *p >= '0' && *p <= '9') {
+          millisecond += (*p - '0') * factor;
+          factor /= 10;
+          ++p;
+        }
+
+        if (p == start) {
+          return false;
+        }
+      }
+    }
+  }
+
+  // timezone specifier
+  if (p < end && (*p == 'Z' || *p == 'z')) {
+    ++p;
+  }
+  else if (p < end && (*p == '+' || *p == '-')) {
+    bool const negative = (*p == '-');
+    int64_t offsetHours;
+    int64_t offsetMinutes = 0;
+
+    ++p;
+    if (! ParseDigits(p, end, 2, 2, offsetHours) || offsetHours > 23) {
+      return false;
+    }
+    if (p < end && *p == ':') {
+      ++p;
+    }
+    if (p < end && ! ParseDigits(p, end, 2, 2, offsetMinutes)) {
+      return false;
+    }
+    if (offsetMinutes > 59) {
+      return false;
+    }
+
+    offset = (offsetHours * 60 + offsetMinutes) * 60000;
+    if (negative) {
+      offset = -offset;
+    }
+  }
+
+  if (p != end) {
+    // trailing garbage
+    return false;
+  }
+
+  timestamp = static_cast<double>(DaysFromCivil(year, month, day)) * MillisecondsPerDay +
+              static_cast<double>(hour * 3600000 + minute * 60000 + second * 1000 + millisecond - offset);
+
+  return (std::abs(timestamp) <= MaxTimestamp);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-/// @brief Transforms an unordered_map<VertexId> to AQL json values
+/// @brief convert a date component parameter into a number, using the same
+/// rules as the JavaScript implementation (null is 0, strings are parsed as
+/// base 10 integers). returns NaN for values that cannot be converted
 ////////////////////////////////////////////////////////////////////////////////
 
-static AqlValue VertexIdsToAqlValue (triagens::arango::AqlTransaction* trx,
-                                     CollectionNameResolver const* resolver,
-                                     std::unordered_set<VertexId>& ids,
-                                     bool includeData = false) {
-  std::unique_ptr<Json> result(new Json(Json::Array, ids.size()));
+static double DateComponentToNumber (TRI_json_t const* json) {
+  if (TRI_IsStringJson(json)) {
+    char const* p = json->_value._string.data;
+    char const* end = p + json->_value._string.length - 1;
 
-  if (includeData) {
-    for (auto& it : ids) {
-      result->add(Json(VertexIdToJson(trx, resolver, it)));
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n')) {
+      ++p;
     }
-  } 
-  else {
-    for (auto& it : ids) {
-      result->add(Json(VertexIdToString(resolver, it)));
+
+    bool negative = false;
+    if (p < end && (*p == '+' || *p == '-')) {
+      negative = (*p == '-');
+      ++p;
+    }
+
+    if (p == end || *p < '0' || *p > '9') {
+      return NAN;
+    }
+
+    double value = 0.0;
+    while (p < end && *p >= '0' && *p <= '9') {
+      value = value * 10.0 + (*p - '0');
+      ++p;
     }
+
+    return (negative ? -value : value);
   }
 
-  AqlValue v(result.get());
-  result.release();
+  if (json == nullptr || json->_type == TRI_JSON_NULL) {
+    return 0.0;
+  }
+  
+  if (json->_type == TRI_JSON_NUMBER) {
+    return json->_value._number;
+  }
 
-  return v;
+  return NAN;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-/// @brief function NEIGHBORS
+/// @brief create a timestamp from the parameters of a date function
+///
+/// a single parameter is either a timestamp number or a date string. more
+/// parameters are the individual date components (year, month, day, hour,
+/// minute, second, millisecond), with month being 1-based. registers a
+/// warning and returns false if no valid date can be created
 ////////////////////////////////////////////////////////////////////////////////
 
-AqlValue Functions::Neighbors (triagens::aql::Query* query,
-                               triagens::arango::AqlTransaction* trx,
-                               FunctionParameters const& parameters) {
+static bool MakeDate (triagens::aql::Query* query,
+                      triagens::arango::AqlTransaction* trx,
+                      FunctionParameters const& parameters,
+                      char const* functionName,
+                      double& timestamp) {
   size_t const n = parameters.size();
-  basics::traverser::NeighborsOptions opts;
 
-  if (n < 4 || n > 6) {
-    THROW_ARANGO_EXCEPTION_PARAMS(TRI_ERROR_QUERY_FUNCTION_ARGUMENT_NUMBER_MISMATCH, "NEIGHBORS", (int) 4, (int) 6);
-  }
+  if (n == 1) {
+    Json value = ExtractFunctionParameter(trx, parameters, 0, false);
+    TRI_json_t const* json = value.json();
 
-  auto resolver = trx->resolver();
+    if (json != nullptr && json->_type == TRI_JSON_NUMBER) {
+      timestamp = json->_value._number;
 
-  Json vertexCol = ExtractFunctionParameter(trx, parameters, 0, false);
+      if (std::isnan(timestamp) || std::abs(timestamp) > MaxTimestamp) {
+        RegisterWarning(query, functionName, TRI_ERROR_QUERY_INVALID_DATE_VALUE);
+        return false;
+      }
 
-  if (! vertexCol.isString()) {
-    THROW_ARANGO_EXCEPTION_PARAMS(TRI_ERROR_QUERY_FUNCTION_ARGUMENT_TYPE_MISMATCH, "NEIGHBORS");
-  }
-  std::string vColName = basics::JsonHelper::getStringValue(vertexCol.json(), "");
+      timestamp = std::trunc(timestamp);
+      return true;
+    }
+  
+    if (TRI_IsStringJson(json)) {
+      if (! ParseDateString(json->_value._string.data, 
+                            json->_value._string.data + json->_value._string.length - 1, 
+                            timestamp)) {
+        RegisterWarning(query, functionName, TRI_ERROR_QUERY_INVALID_DATE_VALUE);
+        return false;
+      }
+      return true;
+    }
 
-  Json edgeCol = ExtractFunctionParameter(trx, parameters, 1, false);
+    RegisterInvalidArgumentWarning(query, functionName);
+    RegisterWarning(query, functionName, TRI_ERROR_QUERY_INVALID_DATE_VALUE);
+    return false;
+  }
 
-  if (! edgeCol.isString()) {
-    THROW_ARANGO_EXCEPTION_PARAMS(TRI_ERROR_QUERY_FUNCTION_ARGUMENT_TYPE_MISMATCH, "NEIGHBORS");
+  if (n < 3) {
+    RegisterWarning(query, functionName, TRI_ERROR_QUERY_INVALID_DATE_VALUE);
+    return false;
   }
-  std::string eColName = basics::JsonHelper::getStringValue(edgeCol.json(), "");
 
-  Json vertexInfo = ExtractFunctionParameter(trx, parameters, 2, false);
-  std::string vertexId;
-  if (vertexInfo.isString()) {
-    vertexId = basics::JsonHelper::getStringValue(vertexInfo.json(), "");
-    if (vertexId.find("/") != std::string::npos) {
-      
-      // TODO tmp can be replaced by Traversal::IdStringToVertexId
-      size_t split;
-      char const* str = vertexId.c_str();
+  // year, month, day, hour, minute, second, millisecond
+  double components[7] = { 0.0, 0.0, 1.0, 0.0, 0.0, 0.0, 0.0 };
 
-      if (! TRI_ValidateDocumentIdKeyGenerator(str, &split)) {
-        THROW_ARANGO_EXCEPTION(TRI_ERROR_ARANGO_DOCUMENT_KEY_BAD);
-      }
+  for (size_t i = 0; i < n && i < 7; ++i) {
+    Json value = ExtractFunctionParameter(trx, parameters, i, false);
+    TRI_json_t const* json = value.json();
 
-      std::string const collectionName = vertexId.substr(0, split);
-      auto coli = resolver->getCollectionStruct(collectionName);
+    if (json != nullptr && 
+        json->_type != TRI_JSON_NULL && 
+        json->_type != TRI_JSON_NUMBER && 
+        ! TRI_IsStringJson(json)) {
+      RegisterInvalidArgumentWarning(query, functionName);
+      return false;
+    }
 
-      if (coli == nullptr || collectionName.compare(vColName) != 0) {
-        THROW_ARANGO_EXCEPTION(TRI_ERROR_ARANGO_COLLECTION_NOT_FOUND);
-      }
+    double const v = DateComponentToNumber(json);
 
-      VertexId v(coli->_cid, const_cast<char*>(str + split + 1));
-      opts.start = v;
-    }
-    else {
-      VertexId v(resolver->getCollectionId(vColName), vertexId.c_str());
-      opts.start = v;
-    }
-  }
-  else if (vertexInfo.isObject()) {
-    if (! vertexInfo.has("_id")) {
-      THROW_ARANGO_EXCEPTION_PARAMS(TRI_ERROR_QUERY_FUNCTION_ARGUMENT_TYPE_MISMATCH, "NEIGHBORS");
+    if (std::isnan(v)) {
+      RegisterWarning(query, functionName, TRI_ERROR_QUERY_INVALID_DATE_VALUE);
+      return false;
     }
-    vertexId = basics::JsonHelper::getStringValue(vertexInfo.get("_id").json(), "");
-    // TODO tmp can be replaced by Traversal::IdStringToVertexId
-    size_t split;
-    char const* str = vertexId.c_str();
 
-    if (! TRI_ValidateDocumentIdKeyGenerator(str, &split)) {
-      THROW_ARANGO_EXCEPTION(TRI_ERROR_ARANGO_DOCUMENT_KEY_BAD);
+    if (v < 0.0) {
+      RegisterWarning(query, functionName, TRI_ERROR_QUERY_INVALID_DATE_VALUE);
+      return false;
     }
 
-    std::string const collectionName = vertexId.substr(0, split);
-    auto coli = resolver->getCollectionStruct(collectionName);
-
-    if (coli == nullptr || collectionName.compare(vColName) != 0) {
-      THROW_ARANGO_EXCEPTION(TRI_ERROR_ARANGO_COLLECTION_NOT_FOUND);
-    }
+    components[i] = std::trunc(v);
+  }
 
-    VertexId v(coli->_cid, const_cast<char*>(str + split + 1));
-    opts.start = v;
+  if (components[0] <= 99.0) {
+    // two-digit years are interpreted as 19xx
+    components[0] += 1900.0;
   }
-  else {
-    THROW_ARANGO_EXCEPTION_PARAMS(TRI_ERROR_QUERY_FUNCTION_ARGUMENT_TYPE_MISMATCH, "NEIGHBORS");
+
+  // months are 1-based in AQL
+  timestamp = MakeTimestamp(components[0], components[1] - 1.0, components[2], 
+                            components[3], components[4], components[5], components[6]);
+
+  if (std::isnan(timestamp) || std::abs(timestamp) > MaxTimestamp) {
+    RegisterWarning(query, functionName, TRI_ERROR_QUERY_INVALID_DATE_VALUE);
+    return false;
   }
 
-  Json direction = ExtractFunctionParameter(trx, parameters, 3, false);
-  if (direction.isString()) {
-    std::string const dir = basics::JsonHelper::getStringValue(direction.json(), "");
-    if (dir.compare("outbound") == 0) {
-      opts.direction = TRI_EDGE_OUT;
-    }
-    else if (dir.compare("inbound") == 0) {
-      opts.direction = TRI_EDGE_IN;
-    }
-    else if (dir.compare("any") == 0) {
-      opts.direction = TRI_EDGE_ANY;
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief extract a component from a timestamp
+////////////////////////////////////////////////////////////////////////////////
+
+static int64_t GetDateComponent (double timestamp,
+                                 DateComponent component) {
+  double const days = std::floor(timestamp / MillisecondsPerDay);
+  int64_t const ms = static_cast<int64_t>(timestamp - days * MillisecondsPerDay);
+
+  switch (component) {
+    case DATE_COMPONENT_DAYOFWEEK: {
+      // the Unix epoch was a Thursday
+      int64_t const weekday = (static_cast<int64_t>(days) + 4) % 7;
+      return (weekday < 0 ? weekday + 7 : weekday);
     }
-    else {
-      THROW_ARANGO_EXCEPTION_PARAMS(TRI_ERROR_QUERY_FUNCTION_ARGUMENT_TYPE_MISMATCH, "NEIGHBORS");
+    case DATE_COMPONENT_YEAR:
+    case DATE_COMPONENT_MONTH:
+    case DATE_COMPONENT_DAY: {
+      int64_t year, month, day;
+      CivilFromDays(static_cast<int64_t>(days), year, month, day);
+
+      if (component == DATE_COMPONENT_YEAR) {
+        return year;
+      }
+      if (component == DATE_COMPONENT_MONTH) {
+        return month;
+      }
+      return day;
     }
-  }
-  else {
-    THROW_ARANGO_EXCEPTION_PARAMS(TRI_ERROR_QUERY_FUNCTION_ARGUMENT_TYPE_MISMATCH, "NEIGHBORS");
+    case DATE_COMPONENT_HOUR:
+      return ms / 3600000;
+    case DATE_COMPONENT_MINUTE:
+      return (ms / 60000) % 60;
+    case DATE_COMPONENT_SECOND:
+      return (ms / 1000) % 60;
+    case DATE_COMPONENT_MILLISECOND:
+      return ms % 1000;
   }
 
+  TRI_ASSERT(false);
+  return 0;
+}
 
-  bool includeData = false;
+////////////////////////////////////////////////////////////////////////////////
+/// @brief shared implementation of the functions returning a date component
+////////////////////////////////////////////////////////////////////////////////
 
-  if (n > 5) {
-    auto options = ExtractFunctionParameter(trx, parameters, 5, false);
-    if (! options.isObject()) {
-      THROW_ARANGO_EXCEPTION_PARAMS(TRI_ERROR_QUERY_FUNCTION_ARGUMENT_TYPE_MISMATCH, "NEIGHBORS");
-    }
-    includeData = basics::JsonHelper::getBooleanValue(options.json(), "includeData", false);
-    opts.minDepth = basics::JsonHelper::getNumericValue<uint64_t>(options.json(), "minDepth", 1);
-    if (opts.minDepth == 0) {
-      opts.maxDepth = basics::JsonHelper::getNumericValue<uint64_t>(options.json(), "maxDepth", 1);
-    } 
-    else {
-      opts.maxDepth = basics::JsonHelper::getNumericValue<uint64_t>(options.json(), "maxDepth", opts.minDepth);
-    }
+static AqlValue DateComponentFunction (triagens::aql::Query* query,
+                                       triagens::arango::AqlTransaction* trx,
+                                       FunctionParameters const& parameters,
+                                       char const* functionName,
+                                       DateComponent component) {
+  double timestamp;
+
+  if (! MakeDate(query, trx, parameters, functionName, timestamp)) {
+    return AqlValue(new Json(Json::Null));
   }
 
-  std::unordered_set<VertexId> neighbors;
+  return AqlValue(new Json(static_cast<double>(GetDateComponent(timestamp, component))));
+}
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief function DATE_NOW
+////////////////////////////////////////////////////////////////////////////////
 
-  TRI_voc_cid_t eCid = resolver->getCollectionId(eColName);
+AqlValue Functions::DateNow (triagens::aql::Query*,
+                             triagens::arango::AqlTransaction*,
+                             FunctionParameters const&) {
+  return AqlValue(new Json(std::floor(TRI_microtime() * 1000.0)));
+}
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief function DATE_TIMESTAMP
+////////////////////////////////////////////////////////////////////////////////
 
-  // Function to return constant distance
-  auto wc = [](TRI_doc_mptr_copy_t& edge) -> double { return 1; };
+AqlValue Functions::DateTimestamp (triagens::aql::Query* query,
+                                   triagens::arango::AqlTransaction* trx,
+                                   FunctionParameters const& parameters) {
+  double timestamp;
 
-  std::unique_ptr<EdgeCollectionInfo> eci(new EdgeCollectionInfo(
-    eCid,
-    trx->documentCollection(eCid),
-    wc
-  ));
-  TRI_IF_FAILURE("EdgeCollectionInfoOOM1") {
-    THROW_ARANGO_EXCEPTION(TRI_ERROR_DEBUG);
+  if (! MakeDate(query, trx, parameters, "DATE_TIMESTAMP", timestamp)) {
+    return AqlValue(new Json(Json::Null));
   }
-  
 
-  if (n > 4) {
-    auto edgeExamples = ExtractFunctionParameter(trx, parameters, 4, false);
-    if (! (edgeExamples.isArray() && edgeExamples.size() == 0) ) {
-      opts.addEdgeFilter(edgeExamples, eci->getShaper(), eCid, resolver); 
-    }
+  return AqlValue(new Json(timestamp));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief function DATE_ISO8601
+////////////////////////////////////////////////////////////////////////////////
+
+AqlValue Functions::DateIso8601 (triagens::aql::Query* query,
+                                 triagens::arango::AqlTransaction* trx,
+                                 FunctionParameters const& parameters) {
+  double timestamp;
+
+  if (! MakeDate(query, trx, parameters, "DATE_ISO8601", timestamp)) {
+    return AqlValue(new Json(Json::Null));
   }
-  
-  std::vector<EdgeCollectionInfo*> edgeCollectionInfos;
-  triagens::basics::ScopeGuard guard{
-    []() -> void { },
-    [&edgeCollectionInfos]() -> void {
-      for (auto& p : edgeCollectionInfos) {
-        delete p;
-      }
-    }
-  };
-  edgeCollectionInfos.emplace_back(eci.get());
-  eci.release();
-  TRI_IF_FAILURE("EdgeCollectionInfoOOM2") {
-    THROW_ARANGO_EXCEPTION(TRI_ERROR_DEBUG);
+
+  int64_t const year = GetDateComponent(timestamp, DATE_COMPONENT_YEAR);
+  char buffer[32];
+  int length;
+
+  if (year >= 0 && year <= 9999) {
+    length = snprintf(buffer, sizeof(buffer), "%04d-", static_cast<int>(year));
+  }
+  else {
+    // expanded year representation
+    length = snprintf(buffer, sizeof(buffer), "%+07d-", static_cast<int>(year));
   }
 
-  TRI_RunNeighborsSearch(
-    edgeCollectionInfos,
-    opts,
-    neighbors
-  );
+  length += snprintf(buffer + length, sizeof(buffer) - length, "%02d-%02dT%02d:%02d:%02d.%03dZ",
+                     static_cast<int>(GetDateComponent(timestamp, DATE_COMPONENT_MONTH)),
+                     static_cast<int>(GetDateComponent(timestamp, DATE_COMPONENT_DAY)),
+                     static_cast<int>(GetDateComponent(timestamp, DATE_COMPONENT_HOUR)),
+                     static_cast<int>(GetDateComponent(timestamp, DATE_COMPONENT_MINUTE)),
+                     static_cast<int>(GetDateComponent(timestamp, DATE_COMPONENT_SECOND)),
+                     static_cast<int>(GetDateComponent(timestamp, DATE_COMPONENT_MILLISECOND)));
 
-  return VertexIdsToAqlValue(trx, resolver, neighbors, includeData);
+  return AqlValue(new Json(TRI_UNKNOWN_MEM_ZONE, buffer, static_cast<size_t>(length)));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief function DATE_DAYOFWEEK
+////////////////////////////////////////////////////////////////////////////////
+
+AqlValue Functions::DateDayOfWeek (triagens::aql::Query* query,
+                                   triagens::arango::AqlTransaction* trx,
+                                   FunctionParameters const& parameters) {
+  return DateComponentFunction(query, trx, parameters, "DATE_DAYOFWEEK", DATE_COMPONENT_DAYOFWEEK);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief function DATE_YEAR
+////////////////////////////////////////////////////////////////////////////////
+
+AqlValue Functions::DateYear (triagens::aql::Query* query,
+                              triagens::arango::AqlTransaction* trx,
+                              FunctionParameters const& parameters) {
+  return DateComponentFunction(query, trx, parameters, "DATE_YEAR", DATE_COMPONENT_YEAR);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief function DATE_MONTH
+////////////////////////////////////////////////////////////////////////////////
+
+AqlValue Functions::DateMonth (triagens::aql::Query* query,
+                               triagens::arango::AqlTransaction* trx,
+                               FunctionParameters const& parameters) {
+  return DateComponentFunction(query, trx, parameters, "DATE_MONTH", DATE_COMPONENT_MONTH);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief function DATE_DAY
+////////////////////////////////////////////////////////////////////////////////
+
+AqlValue Functions::DateDay (triagens::aql::Query* query,
+                             triagens::arango::AqlTransaction* trx,
+                             FunctionParameters const& parameters) {
+  return DateComponentFunction(query, trx, parameters, "DATE_DAY", DATE_COMPONENT_DAY);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief function DATE_HOUR
+////////////////////////////////////////////////////////////////////////////////
+
+AqlValue Functions::DateHour (triagens::aql::Query* query,
+                              triagens::arango::AqlTransaction* trx,
+                              FunctionParameters const& parameters) {
+  return DateComponentFunction(query, trx, parameters, "DATE_HOUR", DATE_COMPONENT_HOUR);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief function DATE_MINUTE
+////////////////////////////////////////////////////////////////////////////////
+
+AqlValue Functions::DateMinute (triagens::aql::Query* query,
+                                triagens::arango::AqlTransaction* trx,
+                                FunctionParameters const& parameters) {
+  return DateComponentFunction(query, trx, parameters, "DATE_MINUTE", DATE_COMPONENT_MINUTE);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief function DATE_SECOND
+////////////////////////////////////////////////////////////////////////////////
+
+AqlValue Functions::DateSecond (triagens::aql::Query* query,
+                                triagens::arango::AqlTransaction* trx,
+                                FunctionParameters const& parameters) {
+  return DateComponentFunction(query, trx, parameters, "DATE_SECOND", DATE_COMPONENT_SECOND);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief function DATE_MILLISECOND
+////////////////////////////////////////////////////////////////////////////////
+
+AqlValue Functions::DateMillisecond (triagens::aql::Query* query,
+                                     triagens::arango::AqlTransaction* trx,
+                                     FunctionParameters const& parameters) {
+  return DateComponentFunction(query, trx, parameters, "DATE_MILLISECOND", DATE_COMPONENT_MILLISECOND);
 }
 
 // -----------------------------------------------------------------------------
@@ -426,6 +426,15 @@ void Optimizer::setupRules () {
                      specializeCollectRule_pass1,
                      false);
 
+  if (! triagens::arango::ServerState::instance()->isCoordinator()) {
+    // iterate over NEIGHBORS() and SHORTEST_PATH() results with native 
+    // traversal nodes instead of calculating them as arrays
+    registerRule("use-traversal-nodes",
+                 useTraversalNodesRule,
+                 useTraversalNodesRule_pass1,
+                 true);
+  }
+
   // move calculations up the dependency chain (to pull them out of
   // inner loops etc.)
   registerRule("move-calculations-up",
@@ -589,6 +598,14 @@ void Optimizer::setupRules () {
                useIndexForSortRule_pass6,
                true);
 
+  if (! triagens::arango::ServerState::instance()->isCoordinator()) {
+    // join collections without a usable index with an in-memory hash table
+    registerRule("use-hash-join",
+                 useHashJoinRule,
+                 useHashJoinRule_pass6,
+                 true);
+  }
+
   // finally, push calculations as far down as possible
   registerRule("move-calculations-down",
                moveCalculationsDownRule,
@@ -608,6 +625,20 @@ void Optimizer::setupRules () {
                patchUpdateStatementsRule,
                patchUpdateStatementsRule_pass9,
                true);
+  
+  // make a SORT that is followed by a LIMIT keep only the required rows
+  registerRule("sort-limit",
+               sortLimitRule,
+               sortLimitRule_pass9,
+               true);
+
+  if (! triagens::arango::ServerState::instance()->isRunningInCluster()) {
+    // scan large collections with multiple threads
+    registerRule("parallelize-collection-scans",
+                 parallelizeCollectionScansRule,
+                 parallelizeCollectionScansRule_pass9,
+                 true);
+  }
 
   if (triagens::arango::ServerState::instance()->isCoordinator()) {
     // distribute operations in cluster
@@ -91,6 +91,10 @@ namespace triagens {
         // split and-combined filters into multiple smaller filters
         splitFiltersRule_pass1                        = 110,
 
+        // execute NEIGHBORS() and SHORTEST_PATH() in FOR loops with native
+        // traversal nodes
+        useTraversalNodesRule_pass1                   = 115,
+
         // move calculations up the dependency chain (to pull them out of
         // inner loops etc.)
         moveCalculationsUpRule_pass1                  = 120,
@@ -192,6 +196,10 @@ namespace triagens {
         // try to find sort blocks which are superseeded by indexes
         useIndexForSortRule_pass6                     = 850,
 
+        // replace full collection scans filtered by equality conditions with
+        // values from an outer loop with hash joins
+        useHashJoinRule_pass6                         = 860,
+
 //////////////////////////////////////////////////////////////////////////////
 /// Pass 9: push down calculations beyond FILTERs and LIMITs
 //////////////////////////////////////////////////////////////////////////////
@@ -210,6 +218,18 @@ namespace triagens {
         
         patchUpdateStatementsRule_pass9               = 902,
 
+//////////////////////////////////////////////////////////////////////////////
+/// Pass 9: turn SORT + LIMIT into a top-k sort
+//////////////////////////////////////////////////////////////////////////////
+        
+        sortLimitRule_pass9                           = 903,
+
+//////////////////////////////////////////////////////////////////////////////
+/// Pass 9: scan large collections with multiple threads
+//////////////////////////////////////////////////////////////////////////////
+        
+        parallelizeCollectionScansRule_pass9          = 904,
+
 //////////////////////////////////////////////////////////////////////////////
 /// "Pass 10": final transformations for the cluster
 //////////////////////////////////////////////////////////////////////////////
@@ -151,7 +151,10 @@ int triagens::aql::removeRedundantSortsRule (Optimizer* opt,
           }
         }
         else if (current->getType() == EN::ENUMERATE_LIST ||
-                 current->getType() == EN::ENUMERATE_COLLECTION) {
+                 current->getType() == EN::ENUMERATE_COLLECTION ||
+                 current->getType() == EN::TRAVERSAL ||
+                 current->getType() == EN::SHORTEST_PATH ||
+                 current->getType() == EN::HASH_JOIN) {
           // ok, but we cannot remove two different sorts if one of these node types is between them
           // example: in the following query, the one sort will be optimized away:
           //   FOR i IN [ { a: 1 }, { a: 2 } , { a: 3 } ] SORT i.a ASC SORT i.a DESC RETURN i
@@ -848,9 +851,12 @@ int triagens::aql::removeSortRandRule (Optimizer* opt,
         case EN::FILTER: 
         case EN::SUBQUERY:
         case EN::ENUMERATE_LIST:
+        case EN::TRAVERSAL:
+        case EN::SHORTEST_PATH:
+        case EN::HASH_JOIN:
         case EN::INDEX_RANGE: {
           // if we found another SortNode, an AggregateNode, FilterNode, a SubqueryNode, 
-          // an EnumerateListNode or an IndexRangeNode
+          // an EnumerateListNode, a graph node or an IndexRangeNode
           // this means we cannot apply our optimization
           collectionNode = nullptr;
           current = nullptr;
@@ -1050,6 +1056,9 @@ int triagens::aql::moveCalculationsDownRule (Optimizer* opt,
       else if (currentType == EN::INDEX_RANGE ||
                currentType == EN::ENUMERATE_COLLECTION ||
                currentType == EN::ENUMERATE_LIST ||
+               currentType == EN::TRAVERSAL ||
+               currentType == EN::SHORTEST_PATH ||
+               currentType == EN::HASH_JOIN ||
                currentType == EN::AGGREGATE ||
                currentType == EN::NORESULTS) {
         // we will not push further down than such nodes
@@ -2095,6 +2104,9 @@ class FilterToEnumCollFinder final : public WalkerWorker<ExecutionNode> {
 
       switch (en->getType()) {
         case EN::ENUMERATE_LIST:
+        case EN::TRAVERSAL:
+        case EN::SHORTEST_PATH:
+        case EN::HASH_JOIN:
         case EN::SUBQUERY:        
         case EN::SORT:
         case EN::INDEX_RANGE:
@@ -2932,7 +2944,10 @@ class SortToIndexNode final : public WalkerWorker<ExecutionNode> {
 
         if (node->getType() == EN::ENUMERATE_COLLECTION ||
             node->getType() == EN::INDEX_RANGE ||
-            node->getType() == EN::ENUMERATE_LIST) {
+            node->getType() == EN::ENUMERATE_LIST ||
+            node->getType() == EN::TRAVERSAL ||
+            node->getType() == EN::SHORTEST_PATH ||
+            node->getType() == EN::HASH_JOIN) {
           // we are contained in an outer loop
           return true;
 
@@ -3041,6 +3056,9 @@ class SortToIndexNode final : public WalkerWorker<ExecutionNode> {
     bool before (ExecutionNode* en) override final {
       switch (en->getType()) {
       case EN::ENUMERATE_LIST:
+      case EN::TRAVERSAL:
+      case EN::SHORTEST_PATH:
+      case EN::HASH_JOIN:
       case EN::CALCULATION:
       case EN::SUBQUERY:
       case EN::FILTER:
@@ -3867,6 +3885,9 @@ int triagens::aql::distributeFilternCalcToClusterRule (Optimizer* opt,
 
       switch (inspectNode->getType()) {
         case EN::ENUMERATE_LIST:
+        case EN::TRAVERSAL:
+        case EN::SHORTEST_PATH:
+        case EN::HASH_JOIN:
         case EN::SINGLETON:
         case EN::INSERT:
         case EN::REMOVE:
@@ -3965,6 +3986,9 @@ int triagens::aql::distributeSortToClusterRule (Optimizer* opt,
 
       switch (inspectNode->getType()) {
         case EN::ENUMERATE_LIST:
+        case EN::TRAVERSAL:
+        case EN::SHORTEST_PATH:
+        case EN::HASH_JOIN:
         case EN::SINGLETON:
         case EN::AGGREGATE:
         case EN::INSERT:
@@ -4246,6 +4270,9 @@ class RemoveToEnumCollFinder final : public WalkerWorker<ExecutionNode> {
         }
         case EN::SINGLETON:
         case EN::ENUMERATE_LIST:
+        case EN::TRAVERSAL:
+        case EN::SHORTEST_PATH:
+        case EN::HASH_JOIN:
         case EN::SUBQUERY:        
         case EN::AGGREGATE:
         case EN::INSERT:
@@ -4798,6 +4825,9 @@ int triagens::aql::patchUpdateStatementsRule (Optimizer* opt,
       auto const type = dep->getType();
 
       if (type == EN::ENUMERATE_LIST || 
+          type == EN::TRAVERSAL ||
+          type == EN::SHORTEST_PATH ||
+          type == EN::HASH_JOIN ||
           type == EN::INDEX_RANGE ||
           type == EN::SUBQUERY) {
         // not suitable
@@ -4833,6 +4863,670 @@ int triagens::aql::patchUpdateStatementsRule (Optimizer* opt,
   return TRI_ERROR_NO_ERROR;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief make a SORT that is directly followed by a LIMIT produce only
+/// offset + limit rows, using a bounded heap instead of a full sort
+////////////////////////////////////////////////////////////////////////////////
+
+int triagens::aql::sortLimitRule (Optimizer* opt, 
+                                  ExecutionPlan* plan, 
+                                  Optimizer::Rule const* rule) {
+  bool modified = false;
+  std::vector<ExecutionNode*>&& nodes = plan->findNodesOfType(EN::SORT, true);
+  
+  for (auto const& n : nodes) {
+    if (! n->hasParent()) {
+      continue;
+    }
+
+    auto parent = n->getParents()[0];
+
+    if (parent->getType() != EN::LIMIT) {
+      // SORT must be directly followed by a LIMIT
+      continue;
+    }
+
+    auto limitNode = static_cast<LimitNode const*>(parent);
+
+    if (limitNode->fullCount()) {
+      // LIMIT needs to see all rows in order to count them
+      continue;
+    }
+
+    size_t const offset = limitNode->offset();
+    size_t const limit = limitNode->limit();
+
+    if (limit == 0 || 
+        offset + limit < offset) {
+      // nothing to gain for LIMIT 0, and an overflowing offset + limit
+      continue;
+    }
+
+    auto sortNode = static_cast<SortNode*>(n);
+
+    if (sortNode->limit() == offset + limit) {
+      // already applied
+      continue;
+    }
+
+    sortNode->setLimit(offset + limit);
+    modified = true;
+  }
+  
+  // always re-add the original plan, be it modified or not
+  // only a flag in the plan will be modified
+  opt->addPlan(plan, rule, modified);
+
+  return TRI_ERROR_NO_ERROR;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief returns the name of a collection passed to a graph function, or an
+/// empty string if the argument is not a collection used in the query
+////////////////////////////////////////////////////////////////////////////////
+
+static std::string GraphFunctionCollection (ExecutionPlan const* plan,
+                                            AstNode const* node) {
+  if (node->type != NODE_TYPE_COLLECTION && 
+      ! node->isStringValue()) {
+    return "";
+  }
+
+  std::string const name(node->getStringValue());
+
+  if (plan->getAst()->query()->collections()->get(name) == nullptr) {
+    // collection was not registered for the query
+    return "";
+  }
+
+  return name;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief returns the edge direction passed to a graph function, or an empty
+/// string if the argument is not a valid constant direction
+////////////////////////////////////////////////////////////////////////////////
+
+static std::string GraphFunctionDirection (AstNode const* node) {
+  if (! node->isStringValue()) {
+    return "";
+  }
+
+  std::string const direction(node->getStringValue());
+
+  if (direction != "outbound" && 
+      direction != "inbound" && 
+      direction != "any") {
+    return "";
+  }
+
+  return direction;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief create a TraversalNode from the arguments of a NEIGHBORS() call. 
+/// returns a nullptr if the call cannot be executed by a TraversalNode
+////////////////////////////////////////////////////////////////////////////////
+
+static ExecutionNode* CreateTraversalNode (ExecutionPlan* plan,
+                                           AstNode const* args,
+                                           Variable const* inVariable,
+                                           Variable const* outVariable) {
+  size_t const n = args->numMembers();
+
+  if (n < 4 || n > 6) {
+    return nullptr;
+  }
+
+  std::string const vertexCollection = GraphFunctionCollection(plan, args->getMember(0));
+  std::string const edgeCollection = GraphFunctionCollection(plan, args->getMember(1));
+  std::string const direction = GraphFunctionDirection(args->getMember(3));
+
+  if (vertexCollection.empty() || edgeCollection.empty() || direction.empty()) {
+    return nullptr;
+  }
+
+  TRI_edge_direction_e edgeDirection = TRI_EDGE_ANY;
+
+  if (direction == "outbound") {
+    edgeDirection = TRI_EDGE_OUT;
+  }
+  else if (direction == "inbound") {
+    edgeDirection = TRI_EDGE_IN;
+  }
+
+  triagens::basics::Json edgeExamples;
+
+  if (n > 4) {
+    auto examples = args->getMember(4);
+
+    if (! examples->isConstant()) {
+      return nullptr;
+    }
+
+    edgeExamples = triagens::basics::Json(TRI_UNKNOWN_MEM_ZONE, examples->toJsonValue(TRI_UNKNOWN_MEM_ZONE));
+
+    if (edgeExamples.isArray() && edgeExamples.size() == 0) {
+      // no filtering
+      edgeExamples = triagens::basics::Json();
+    }
+    else if (! edgeExamples.isArray() && 
+             ! edgeExamples.isObject() && 
+             ! edgeExamples.isString()) {
+      // let the function handle other values
+      return nullptr;
+    }
+  }
+
+  uint64_t minDepth = 1;
+  uint64_t maxDepth = 1;
+  bool includeData = false;
+
+  if (n > 5) {
+    auto options = args->getMember(5);
+
+    if (! options->isConstant() || ! options->isObject()) {
+      return nullptr;
+    }
+
+    triagens::basics::Json json(TRI_UNKNOWN_MEM_ZONE, options->toJsonValue(TRI_UNKNOWN_MEM_ZONE));
+
+    // same defaults as in the NEIGHBORS() function
+    includeData = triagens::basics::JsonHelper::getBooleanValue(json.json(), "includeData", false);
+    minDepth = triagens::basics::JsonHelper::getNumericValue<uint64_t>(json.json(), "minDepth", 1);
+    maxDepth = triagens::basics::JsonHelper::getNumericValue<uint64_t>(json.json(), "maxDepth", minDepth == 0 ? 1 : minDepth);
+  }
+
+  return new TraversalNode(plan, plan->nextId(), vertexCollection, edgeCollection, inVariable, outVariable,
+                           edgeDirection, minDepth, maxDepth, edgeExamples, includeData);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief create a ShortestPathNode from the arguments of a SHORTEST_PATH()
+/// call. returns a nullptr if the call cannot be executed by a
+/// ShortestPathNode
+////////////////////////////////////////////////////////////////////////////////
+
+static ExecutionNode* CreateShortestPathNode (ExecutionPlan* plan,
+                                              AstNode const* args,
+                                              Variable const* startVariable,
+                                              Variable const* targetVariable,
+                                              Variable const* outVariable,
+                                              bool produceEdges) {
+  size_t const n = args->numMembers();
+
+  if (n < 5 || n > 6) {
+    return nullptr;
+  }
+
+  std::string const vertexCollection = GraphFunctionCollection(plan, args->getMember(0));
+  std::string const edgeCollection = GraphFunctionCollection(plan, args->getMember(1));
+  std::string const direction = GraphFunctionDirection(args->getMember(4));
+
+  if (vertexCollection.empty() || edgeCollection.empty() || direction.empty()) {
+    return nullptr;
+  }
+
+  bool includeData = false;
+
+  if (n > 5) {
+    auto options = args->getMember(5);
+
+    if (! options->isConstant() || ! options->isObject()) {
+      return nullptr;
+    }
+
+    // weights, filters and additional collections are handled by the 
+    // function only
+    size_t const numOptions = options->numMembers();
+
+    for (size_t i = 0; i < numOptions; ++i) {
+      auto option = options->getMember(i);
+
+      if (option->type != NODE_TYPE_OBJECT_ELEMENT || 
+          strcmp(option->getStringValue(), "includeData") != 0) {
+        return nullptr;
+      }
+
+      auto value = option->getMember(0);
+
+      if (! value->isBoolValue()) {
+        return nullptr;
+      }
+
+      includeData = value->getBoolValue();
+    }
+  }
+
+  return new ShortestPathNode(plan, plan->nextId(), vertexCollection, edgeCollection, startVariable, targetVariable, 
+                              outVariable, direction, produceEdges, includeData);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief replace a FOR loop over the result of NEIGHBORS() or over the 
+/// vertices or edges of SHORTEST_PATH() with a TraversalNode or a
+/// ShortestPathNode, which produce their results row by row
+////////////////////////////////////////////////////////////////////////////////
+
+int triagens::aql::useTraversalNodesRule (Optimizer* opt, 
+                                          ExecutionPlan* plan, 
+                                          Optimizer::Rule const* rule) {
+  bool modified = false;
+  std::vector<ExecutionNode*>&& nodes = plan->findNodesOfType(EN::ENUMERATE_LIST, true);
+  
+  for (auto const& n : nodes) {
+    auto dep = n->getFirstDependency();
+
+    if (dep == nullptr || dep->getType() != EN::CALCULATION) {
+      continue;
+    }
+
+    auto cn = static_cast<CalculationNode*>(dep);
+    auto inVariable = n->getVariablesUsedHere()[0];
+
+    if (cn->outVariable() != inVariable || 
+        n->getVarsUsedLater().find(inVariable) != n->getVarsUsedLater().end()) {
+      // the array is not calculated directly before the loop, or it is
+      // used elsewhere, too
+      continue;
+    }
+
+    auto node = cn->expression()->node();
+    bool produceEdges = false;
+
+    if (node->type == NODE_TYPE_ATTRIBUTE_ACCESS) {
+      // SHORTEST_PATH(...).vertices or SHORTEST_PATH(...).edges
+      char const* attributeName = node->getStringValue();
+
+      if (strcmp(attributeName, "vertices") != 0 && 
+          strcmp(attributeName, "edges") != 0) {
+        continue;
+      }
+
+      produceEdges = (strcmp(attributeName, "edges") == 0);
+      node = node->getMember(0);
+
+      if (node->type != NODE_TYPE_FCALL ||
+          static_cast<Function const*>(node->getData())->externalName != "SHORTEST_PATH") {
+        continue;
+      }
+    }
+    else if (node->type != NODE_TYPE_FCALL ||
+             static_cast<Function const*>(node->getData())->externalName != "NEIGHBORS") {
+      continue;
+    }
+
+    auto args = node->getMember(0);
+    auto outVariable = n->getVariablesSetHere()[0];
+    ExecutionNode* graphNode = nullptr;
+    Variable const* targetVariable = nullptr;
+
+    if (node == cn->expression()->node()) {
+      graphNode = CreateTraversalNode(plan, args, inVariable, outVariable);
+    }
+    else {
+      targetVariable = plan->getAst()->variables()->createTemporaryVariable();
+      graphNode = CreateShortestPathNode(plan, args, inVariable, targetVariable, outVariable, produceEdges);
+    }
+
+    if (graphNode == nullptr) {
+      continue;
+    }
+
+    plan->registerNode(graphNode);
+
+    // the calculation now only produces the start vertex
+    auto expression = new Expression(plan->getAst(), args->getMember(2));
+    ExecutionNode* startNode = nullptr;
+
+    try {
+      startNode = new CalculationNode(plan, plan->nextId(), expression, inVariable);
+    }
+    catch (...) {
+      delete expression;
+      throw;
+    }
+
+    plan->registerNode(startNode);
+    plan->replaceNode(cn, startNode);
+    plan->replaceNode(n, graphNode);
+
+    if (targetVariable != nullptr) {
+      expression = new Expression(plan->getAst(), args->getMember(3));
+      ExecutionNode* targetNode = nullptr;
+
+      try {
+        targetNode = new CalculationNode(plan, plan->nextId(), expression, targetVariable);
+      }
+      catch (...) {
+        delete expression;
+        throw;
+      }
+
+      plan->registerNode(targetNode);
+      plan->insertDependency(graphNode, targetNode);
+    }
+
+    modified = true;
+  }
+  
+  if (modified) {
+    plan->findVarUsage();
+  }
+  
+  opt->addPlan(plan, rule, modified);
+
+  return TRI_ERROR_NO_ERROR;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief a join key found for a hash join
+////////////////////////////////////////////////////////////////////////////////
+
+struct HashJoinKey {
+  HashJoinKey (AstNode const* probe,
+               std::vector<std::string> const& attribute)
+    : probe(probe),
+      attribute(attribute) {
+  }
+
+  AstNode const* probe;
+  std::vector<std::string> attribute;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief returns the attribute path of an attribute access on a variable, 
+/// e.g. [ "a", "b" ] for v.a.b. returns an empty path if the node is not an
+/// attribute access on the variable
+////////////////////////////////////////////////////////////////////////////////
+
+static std::vector<std::string> HashJoinAttribute (AstNode const* node,
+                                                   Variable const* variable) {
+  std::vector<std::string> attribute;
+
+  while (node->type == NODE_TYPE_ATTRIBUTE_ACCESS) {
+    attribute.insert(attribute.begin(), std::string(node->getStringValue()));
+    node = node->getMember(0);
+  }
+
+  if (node->type != NODE_TYPE_REFERENCE || 
+      static_cast<Variable const*>(node->getData()) != variable) {
+    attribute.clear();
+  }
+
+  return attribute;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief find equality conditions between an attribute of a loop variable
+/// and an expression that can be calculated before the loop. the conditions
+/// may be and-combined
+////////////////////////////////////////////////////////////////////////////////
+
+static void FindHashJoinKeys (AstNode const* node,
+                              Variable const* variable,
+                              std::unordered_set<Variable const*> const& validVars,
+                              std::vector<HashJoinKey>& keys) {
+  if (node->type == NODE_TYPE_OPERATOR_BINARY_AND) {
+    FindHashJoinKeys(node->getMember(0), variable, validVars, keys);
+    FindHashJoinKeys(node->getMember(1), variable, validVars, keys);
+    return;
+  }
+
+  if (node->type != NODE_TYPE_OPERATOR_BINARY_EQ) {
+    return;
+  }
+
+  for (size_t i = 0; i < 2; ++i) {
+    auto attribute = HashJoinAttribute(node->getMember(i), variable);
+
+    if (attribute.empty()) {
+      continue;
+    }
+
+    auto probe = node->getMember(1 - i);
+
+    if (probe->canThrow() || ! probe->isDeterministic()) {
+      continue;
+    }
+
+    std::unordered_set<Variable const*> vars;
+    Ast::getReferencedVariables(probe, vars);
+
+    if (vars.empty()) {
+      // a comparison with a constant value is not a join
+      continue;
+    }
+
+    bool valid = true;
+
+    for (auto const& it : vars) {
+      if (validVars.find(it) == validVars.end()) {
+        // the value depends on the loop itself or on something calculated
+        // later
+        valid = false;
+        break;
+      }
+    }
+
+    if (valid) {
+      keys.emplace_back(HashJoinKey(probe, attribute));
+      return;
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief replace a full collection scan, whose documents are filtered by an
+/// equality condition with values from an outer loop, with a hash join
+////////////////////////////////////////////////////////////////////////////////
+
+int triagens::aql::useHashJoinRule (Optimizer* opt, 
+                                    ExecutionPlan* plan, 
+                                    Optimizer::Rule const* rule) {
+  std::vector<ExecutionNode*>&& nodes = plan->findNodesOfType(EN::ENUMERATE_COLLECTION, true);
+  std::vector<ExecutionNode*>&& modificationNodes = plan->findNodesOfType({ EN::INSERT, EN::UPDATE, EN::REPLACE, EN::REMOVE, EN::UPSERT }, true);
+  std::unique_ptr<ExecutionPlan> newPlan;
+  
+  for (auto const& n : nodes) {
+    auto en = static_cast<EnumerateCollectionNode const*>(n);
+
+    if (en->random() || ! n->hasDependency()) {
+      continue;
+    }
+
+    // the hash table would not see the changes made by the query to the
+    // collection it was built from
+    bool isModified = false;
+
+    for (auto const& m : modificationNodes) {
+      if (static_cast<ModificationNode const*>(m)->collection() == en->collection()) {
+        isModified = true;
+        break;
+      }
+    }
+
+    if (isModified) {
+      continue;
+    }
+
+    auto outVariable = en->outVariable();
+    auto const& validVars = n->getFirstDependency()->getVarsValid();
+    std::vector<HashJoinKey> keys;
+
+    // collect the join conditions from the filters directly following the
+    // loop. the filters are kept, so the join only needs to produce a
+    // superset of the matching documents
+    auto current = n;
+
+    while (current->hasParent()) {
+      auto const& parents = current->getParents();
+
+      if (parents.size() != 1) {
+        break;
+      }
+
+      current = parents[0];
+
+      if (current->getType() == EN::CALCULATION) {
+        continue;
+      }
+
+      if (current->getType() != EN::FILTER) {
+        break;
+      }
+
+      auto setter = plan->getVarSetBy(current->getVariablesUsedHere()[0]->id);
+
+      if (setter != nullptr && setter->getType() == EN::CALCULATION) {
+        auto cn = static_cast<CalculationNode const*>(setter);
+        FindHashJoinKeys(cn->expression()->node(), outVariable, validVars, keys);
+      }
+    }
+
+    if (keys.empty()) {
+      continue;
+    }
+
+    if (newPlan == nullptr) {
+      // the original plan is kept. the cheaper of the two plans wins
+      newPlan.reset(plan->clone());
+    }
+
+    std::vector<Variable const*> probeVariables;
+    std::vector<std::vector<std::string>> buildAttributes;
+    std::vector<ExecutionNode*> probeNodes;
+
+    for (auto const& key : keys) {
+      auto probeVariable = newPlan->getAst()->variables()->createTemporaryVariable();
+      auto expression = new Expression(newPlan->getAst(), newPlan->getAst()->clone(key.probe));
+      ExecutionNode* probeNode = nullptr;
+
+      try {
+        probeNode = new CalculationNode(newPlan.get(), newPlan->nextId(), expression, probeVariable);
+      }
+      catch (...) {
+        delete expression;
+        throw;
+      }
+
+      newPlan->registerNode(probeNode);
+      probeNodes.emplace_back(probeNode);
+      probeVariables.emplace_back(probeVariable);
+      buildAttributes.emplace_back(key.attribute);
+    }
+
+    ExecutionNode* joinNode = new HashJoinNode(newPlan.get(), newPlan->nextId(), en->vocbase(), 
+                                               const_cast<Collection*>(en->collection()), outVariable, 
+                                               probeVariables, buildAttributes);
+    newPlan->registerNode(joinNode);
+    newPlan->replaceNode(newPlan->getNodeById(n->id()), joinNode);
+
+    for (auto const& probeNode : probeNodes) {
+      newPlan->insertDependency(joinNode, probeNode);
+    }
+  }
+  
+  opt->addPlan(plan, rule, false);
+
+  if (newPlan != nullptr) {
+    newPlan->findVarUsage();
+    opt->addPlan(newPlan.release(), rule, true);
+  }
+
+  return TRI_ERROR_NO_ERROR;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief minimum number of documents each partition of a parallel collection
+/// scan should contain. smaller collections are not worth the threads
+////////////////////////////////////////////////////////////////////////////////
+
+static size_t const MinDocumentsPerScanPartition = 10000;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief whether or not a node can be executed by the worker threads of a
+/// parallel collection scan
+////////////////////////////////////////////////////////////////////////////////
+
+static bool CanRunInParallel (ExecutionNode const* node) {
+  if (node->getType() == EN::FILTER) {
+    return true;
+  }
+
+  if (node->getType() == EN::CALCULATION) {
+    auto expression = static_cast<CalculationNode const*>(node)->expression();
+    // V8 expressions need a V8 context, and functions that cannot run on a
+    // DB server may access other collections
+    return (! expression->isV8() && expression->canRunOnDBServer());
+  }
+
+  return false;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief split a full collection scan of a large collection and the filters
+/// and calculations directly following it into partitions that are executed
+/// by multiple threads
+////////////////////////////////////////////////////////////////////////////////
+
+int triagens::aql::parallelizeCollectionScansRule (Optimizer* opt, 
+                                                   ExecutionPlan* plan, 
+                                                   Optimizer::Rule const* rule) {
+  size_t const maxPartitions = plan->getAst()->query()->scanThreads();
+  bool modified = false;
+
+  if (maxPartitions > 1 &&
+      plan->findNodesOfType({ EN::INSERT, EN::UPDATE, EN::REPLACE, EN::REMOVE, EN::UPSERT }, true).empty()) {
+    // only look at top-level loops. loops in subqueries are executed 
+    // many times, and the worker threads would need to be set up each time
+    std::vector<ExecutionNode*>&& nodes = plan->findNodesOfType(EN::ENUMERATE_COLLECTION, false);
+  
+    for (auto const& n : nodes) {
+      auto en = static_cast<EnumerateCollectionNode const*>(n);
+
+      if (en->random() || 
+          ! n->hasDependency() ||
+          n->getFirstDependency()->getType() != EN::SINGLETON) {
+        // the loop must be the outermost one, otherwise the workers would
+        // need to scan the collection once per outer row
+        continue;
+      }
+
+      size_t const partitions = (std::min)(maxPartitions, en->collection()->count() / MinDocumentsPerScanPartition);
+
+      if (partitions < 2) {
+        continue;
+      }
+
+      auto last = n;
+
+      while (last->hasParent()) {
+        auto const& parents = last->getParents();
+
+        if (parents.size() != 1 || ! CanRunInParallel(parents[0])) {
+          break;
+        }
+        last = parents[0];
+      }
+
+      if (last == n || ! last->hasParent()) {
+        // nothing to be done by the workers except scanning
+        continue;
+      }
+
+      ExecutionNode* gatherNode = new GatherNode(plan, plan->nextId(), en->vocbase(), en->collection(), partitions);
+      plan->registerNode(gatherNode);
+      plan->insertDependency(last->getParents()[0], gatherNode);
+      modified = true;
+    }
+  }
+  
+  opt->addPlan(plan, rule, modified);
+
+  return TRI_ERROR_NO_ERROR;
+}
+
 // Local Variables:
 // mode: outline-minor
 // outline-regexp: "^\\(/// @brief\\|/// {@inheritDoc}\\|/// @addtogroup\\|// --SECTION--\\|/// @\\}\\)"
@@ -119,6 +119,14 @@ namespace triagens {
 
     int splitFiltersRule (Optimizer*, ExecutionPlan*, Optimizer::Rule const*);
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief replace a FOR loop over the result of NEIGHBORS() or over the 
+/// vertices or edges of SHORTEST_PATH() with a TraversalNode or a
+/// ShortestPathNode, which produce their results row by row
+////////////////////////////////////////////////////////////////////////////////
+
+    int useTraversalNodesRule (Optimizer*, ExecutionPlan*, Optimizer::Rule const*);
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief move filters up in the plan
 /// this rule modifies the plan in place
@@ -153,6 +161,13 @@ namespace triagens {
 
     int useIndexForSortRule (Optimizer*, ExecutionPlan*, Optimizer::Rule const*);
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief replace a full collection scan, whose documents are filtered by an
+/// equality condition with values from an outer loop, with a hash join
+////////////////////////////////////////////////////////////////////////////////
+
+    int useHashJoinRule (Optimizer*, ExecutionPlan*, Optimizer::Rule const*);
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief try to remove filters which are covered by indexes
 ////////////////////////////////////////////////////////////////////////////////
@@ -251,6 +266,21 @@ namespace triagens {
 ////////////////////////////////////////////////////////////////////////////////
 
     int patchUpdateStatementsRule (Optimizer*, ExecutionPlan*, Optimizer::Rule const*);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief make a SORT that is directly followed by a LIMIT produce only
+/// offset + limit rows, using a bounded heap instead of a full sort
+////////////////////////////////////////////////////////////////////////////////
+
+    int sortLimitRule (Optimizer*, ExecutionPlan*, Optimizer::Rule const*);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief split a full collection scan of a large collection and the filters
+/// and calculations directly following it into partitions that are executed
+/// by multiple threads
+////////////////////////////////////////////////////////////////////////////////
+
+    int parallelizeCollectionScansRule (Optimizer*, ExecutionPlan*, Optimizer::Rule const*);
     
   }  // namespace aql
 }  // namespace triagens
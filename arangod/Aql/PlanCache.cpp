@@ -0,0 +1,593 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Aql, execution plan cache
+///
+/// @file
+///
+/// DISCLAIMER
+///
+/// Copyright 2014 ArangoDB GmbH, Cologne, Germany
+/// Copyright 2004-2014 triAGENS GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Jan Steemann
+/// @author Copyright 2015, ArangoDB GmbH, Cologne, Germany
+////////////////////////////////////////////////////////////////////////////////
+
+#include "Aql/PlanCache.h"
+#include "Basics/fasthash.h"
+#include "Basics/Exceptions.h"
+#include "Basics/json-utilities.h"
+#include "Basics/MutexLocker.h"
+#include "Basics/ReadLocker.h"
+#include "Basics/WriteLocker.h"
+#include "VocBase/vocbase.h"
+
+using namespace triagens::aql;
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                 private variables
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief singleton instance of the plan cache
+////////////////////////////////////////////////////////////////////////////////
+
+static triagens::aql::PlanCache Instance;
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                             struct PlanCacheEntry
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief create a cache entry
+////////////////////////////////////////////////////////////////////////////////
+
+PlanCacheEntry::PlanCacheEntry (uint64_t hash,
+                                char const* queryString,
+                                size_t queryStringLength,
+                                triagens::basics::Json& plan,
+                                triagens::basics::Json& fixedParameters,
+                                std::vector<std::string> const& collections,
+                                bool isModificationQuery,
+                                bool isCacheable)
+  : _hash(hash),
+    _queryString(queryString, queryStringLength),
+    _plan(plan),
+    _fixedParameters(fixedParameters),
+    _collections(collections),
+    _isModificationQuery(isModificationQuery),
+    _isCacheable(isCacheable) {
+
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief whether or not the plan can be used for the given bind parameters
+////////////////////////////////////////////////////////////////////////////////
+
+bool PlanCacheEntry::matches (BindParametersType const& parameters) const {
+  TRI_json_t const* fixed = _fixedParameters.json();
+
+  if (! TRI_IsObjectJson(fixed)) {
+    return true;
+  }
+
+  size_t const n = TRI_LengthVector(&fixed->_value._objects);
+
+  for (size_t i = 0; i < n; i += 2) {
+    auto key = static_cast<TRI_json_t const*>(TRI_AtVector(&fixed->_value._objects, i));
+    auto value = static_cast<TRI_json_t const*>(TRI_AtVector(&fixed->_value._objects, i + 1));
+
+    auto it = parameters.find(std::string(key->_value._string.data, key->_value._string.length - 1));
+
+    if (it == parameters.end() ||
+        ! TRI_CheckSameValueJson(value, (*it).second.first)) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                     struct PlanCacheDatabaseEntry
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief create a database-specific plan cache
+////////////////////////////////////////////////////////////////////////////////
+
+PlanCacheDatabaseEntry::PlanCacheDatabaseEntry ()
+  : _entriesByHash(),
+    _entriesByCollection(),
+    _invalidations(),
+    _order(),
+    _orderLock() {
+
+  _entriesByHash.reserve(128);
+  _entriesByCollection.reserve(16);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief lookup a plan in the database-specific cache
+////////////////////////////////////////////////////////////////////////////////
+
+std::shared_ptr<PlanCacheEntry const> PlanCacheDatabaseEntry::lookup (uint64_t hash,
+                                                                      char const* queryString,
+                                                                      size_t queryStringLength,
+                                                                      BindParametersType const& parameters) const {
+  auto it = _entriesByHash.find(hash);
+
+  if (it == _entriesByHash.end()) {
+    // not found in cache
+    return nullptr;
+  }
+
+  auto const& entry = (*it).second.first;
+
+  if (queryStringLength != entry->_queryString.size() ||
+      memcmp(queryString, entry->_queryString.c_str(), queryStringLength) != 0) {
+    // found something, but obviously the plan of a different query with the same hash
+    return nullptr;
+  }
+
+  if (! entry->matches(parameters)) {
+    // plan was created for different values of the injected bind parameters
+    return nullptr;
+  }
+
+  {
+    // move the plan to the end of the usage order
+    MUTEX_LOCKER(_orderLock);
+    _order.splice(_order.end(), _order, (*it).second.second);
+  }
+
+  return entry;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief store a plan in the database-specific cache
+////////////////////////////////////////////////////////////////////////////////
+
+void PlanCacheDatabaseEntry::store (std::shared_ptr<PlanCacheEntry const> entry,
+                                    size_t maxEntries) {
+  uint64_t const hash = entry->_hash;
+
+  // remove a previous plan with the same hash
+  remove(hash);
+
+  _order.emplace_back(hash);
+
+  try {
+    _entriesByHash.emplace(hash, std::make_pair(entry, std::prev(_order.end())));
+
+    for (auto const& it : entry->_collections) {
+      _entriesByCollection[it].emplace(hash);
+    }
+  }
+  catch (...) {
+    // rollback
+    if (_entriesByHash.find(hash) != _entriesByHash.end()) {
+      remove(hash);
+    }
+    else {
+      _order.pop_back();
+    }
+    throw;
+  }
+
+  enforceMaxEntries(maxEntries);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief whether or not one of the collections was invalidated after the
+/// given tick
+////////////////////////////////////////////////////////////////////////////////
+
+bool PlanCacheDatabaseEntry::wasInvalidated (std::vector<std::string> const& collections,
+                                             uint64_t tick) const {
+  for (auto const& it : collections) {
+    auto it2 = _invalidations.find(it);
+
+    if (it2 != _invalidations.end() && (*it2).second > tick) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief invalidate all plans for a collection in the database-specific
+/// cache
+////////////////////////////////////////////////////////////////////////////////
+
+void PlanCacheDatabaseEntry::invalidate (char const* collection,
+                                         uint64_t tick) {
+  std::string const name(collection);
+
+  _invalidations[name] = tick;
+
+  auto it = _entriesByCollection.find(name);
+
+  if (it == _entriesByCollection.end()) {
+    return;
+  }
+
+  // take over the hashes, as remove() will modify _entriesByCollection
+  std::unordered_set<uint64_t> hashes;
+  hashes.swap((*it).second);
+  _entriesByCollection.erase(it);
+
+  for (auto const& hash : hashes) {
+    remove(hash);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief enforce maximum number of plans, evicting the least recently used
+/// plans first
+////////////////////////////////////////////////////////////////////////////////
+
+void PlanCacheDatabaseEntry::enforceMaxEntries (size_t value) {
+  // the caller holds the write lock, so no lookup can modify the order
+  while (_entriesByHash.size() > value) {
+    remove(_order.front());
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief remove a plan from the database-specific cache
+////////////////////////////////////////////////////////////////////////////////
+
+void PlanCacheDatabaseEntry::remove (uint64_t hash) {
+  auto it = _entriesByHash.find(hash);
+
+  if (it == _entriesByHash.end()) {
+    return;
+  }
+
+  for (auto const& name : (*it).second.first->_collections) {
+    auto it2 = _entriesByCollection.find(name);
+
+    if (it2 != _entriesByCollection.end()) {
+      (*it2).second.erase(hash);
+
+      if ((*it2).second.empty()) {
+        _entriesByCollection.erase(it2);
+      }
+    }
+  }
+
+  _order.erase((*it).second.second);
+  _entriesByHash.erase(it);
+}
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                   class PlanCache
+// -----------------------------------------------------------------------------
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                        constructors / destructors
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief create the plan cache
+////////////////////////////////////////////////////////////////////////////////
+
+PlanCache::PlanCache ()
+  : _propertiesLock(),
+    _entriesLock(),
+    _entries(),
+    _maxEntries(0),
+    _tick(0),
+    _fullInvalidationTick(0),
+    _hits(0),
+    _misses(0) {
+
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief destroy the plan cache
+////////////////////////////////////////////////////////////////////////////////
+
+PlanCache::~PlanCache () {
+  invalidate();
+}
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                    public methods
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief return the plan cache properties and statistics
+////////////////////////////////////////////////////////////////////////////////
+
+triagens::basics::Json PlanCache::properties () {
+  MUTEX_LOCKER(_propertiesLock);
+
+  size_t numEntries = 0;
+
+  for (unsigned int i = 0; i < NumberOfParts; ++i) {
+    READ_LOCKER(_entriesLock[i]);
+
+    for (auto const& it : _entries[i]) {
+      numEntries += it.second->_entriesByHash.size();
+    }
+  }
+
+  triagens::basics::Json json(triagens::basics::Json::Object, 4);
+  json("maxEntries", triagens::basics::Json(static_cast<double>(_maxEntries.load())));
+  json("entries", triagens::basics::Json(static_cast<double>(numEntries)));
+  json("hits", triagens::basics::Json(static_cast<double>(_hits.load())));
+  json("misses", triagens::basics::Json(static_cast<double>(_misses.load())));
+
+  return json;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief sets the maximum number of plans in each per-database cache
+////////////////////////////////////////////////////////////////////////////////
+
+void PlanCache::setMaxEntries (size_t value) {
+  MUTEX_LOCKER(_propertiesLock);
+
+  _maxEntries.store(value);
+
+  for (unsigned int i = 0; i < NumberOfParts; ++i) {
+    WRITE_LOCKER(_entriesLock[i]);
+
+    if (value == 0) {
+      invalidate(i);
+      continue;
+    }
+
+    for (auto& it : _entries[i]) {
+      it.second->enforceMaxEntries(value);
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief return whether or not the plan cache is turned on
+////////////////////////////////////////////////////////////////////////////////
+
+bool PlanCache::isActive () const {
+  return _maxEntries.load(std::memory_order_relaxed) > 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief return the current invalidation tick
+////////////////////////////////////////////////////////////////////////////////
+
+uint64_t PlanCache::tick () const {
+  return _tick.load();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief lookup a plan in the cache
+////////////////////////////////////////////////////////////////////////////////
+
+std::shared_ptr<PlanCacheEntry const> PlanCache::lookup (TRI_vocbase_t* vocbase,
+                                                         uint64_t hash,
+                                                         char const* queryString,
+                                                         size_t queryStringLength,
+                                                         BindParametersType const& parameters) {
+  std::shared_ptr<PlanCacheEntry const> entry;
+
+  {
+    auto const part = getPart(vocbase);
+    READ_LOCKER(_entriesLock[part]);
+
+    auto it = _entries[part].find(vocbase);
+
+    if (it != _entries[part].end()) {
+      entry = (*it).second->lookup(hash, queryString, queryStringLength, parameters);
+    }
+  }
+
+  if (entry == nullptr) {
+    ++_misses;
+  }
+  else {
+    ++_hits;
+  }
+
+  return entry;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief store a plan in the cache
+////////////////////////////////////////////////////////////////////////////////
+
+void PlanCache::store (TRI_vocbase_t* vocbase,
+                       uint64_t hash,
+                       char const* queryString,
+                       size_t queryStringLength,
+                       triagens::basics::Json& plan,
+                       triagens::basics::Json& fixedParameters,
+                       std::vector<std::string> const& collections,
+                       bool isModificationQuery,
+                       bool isCacheable,
+                       uint64_t tick) {
+  // create the cache entry outside the lock
+  auto entry = std::make_shared<PlanCacheEntry const>(hash, queryString, queryStringLength, plan, fixedParameters, collections, isModificationQuery, isCacheable);
+
+  auto const part = getPart(vocbase);
+  WRITE_LOCKER(_entriesLock[part]);
+
+  size_t const maxEntries = _maxEntries.load();
+
+  if (maxEntries == 0) {
+    // cache was turned off in the meantime
+    return;
+  }
+
+  if (_fullInvalidationTick.load() > tick) {
+    // the database was dropped or the cache was cleared while the plan was
+    // created
+    return;
+  }
+
+  auto it = _entries[part].find(vocbase);
+
+  if (it != _entries[part].end() &&
+      (*it).second->wasInvalidated(collections, tick)) {
+    // the plan may refer to an index or collection that does not exist 
+    // anymore
+    return;
+  }
+
+  if (it == _entries[part].end()) {
+    // create entry for the current database
+    it = getDatabaseEntry(vocbase, part);
+  }
+
+  (*it).second->store(entry, maxEntries);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief invalidate all plans for the given collections
+////////////////////////////////////////////////////////////////////////////////
+
+void PlanCache::invalidate (TRI_vocbase_t* vocbase,
+                            std::vector<char const*> const& collections) {
+  auto const part = getPart(vocbase);
+  WRITE_LOCKER(_entriesLock[part]);
+
+  uint64_t const tick = ++_tick;
+  auto it = getDatabaseEntry(vocbase, part);
+
+  for (auto const& collection : collections) {
+    (*it).second->invalidate(collection, tick);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief invalidate all plans for a particular collection
+////////////////////////////////////////////////////////////////////////////////
+
+void PlanCache::invalidate (TRI_vocbase_t* vocbase,
+                            char const* collection) {
+  auto const part = getPart(vocbase);
+  WRITE_LOCKER(_entriesLock[part]);
+
+  uint64_t const tick = ++_tick;
+  auto it = getDatabaseEntry(vocbase, part);
+
+  (*it).second->invalidate(collection, tick);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief invalidate all plans for a particular database
+////////////////////////////////////////////////////////////////////////////////
+
+void PlanCache::invalidate (TRI_vocbase_t* vocbase) {
+  PlanCacheDatabaseEntry* databasePlanCache = nullptr;
+
+  {
+    auto const part = getPart(vocbase);
+    WRITE_LOCKER(_entriesLock[part]);
+
+    _fullInvalidationTick = ++_tick;
+
+    auto it = _entries[part].find(vocbase);
+
+    if (it == _entries[part].end()) {
+      return;
+    }
+
+    databasePlanCache = (*it).second;
+    _entries[part].erase(it);
+  }
+
+  // delete without holding the lock
+  TRI_ASSERT(databasePlanCache != nullptr);
+  delete databasePlanCache;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief invalidate all plans
+////////////////////////////////////////////////////////////////////////////////
+
+void PlanCache::invalidate () {
+  for (unsigned int i = 0; i < NumberOfParts; ++i) {
+    WRITE_LOCKER(_entriesLock[i]);
+
+    invalidate(i);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief get the plan cache instance
+////////////////////////////////////////////////////////////////////////////////
+
+PlanCache* PlanCache::instance () {
+  return &Instance;
+}
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                   private methods
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief determine which lock to use for the cache entries
+////////////////////////////////////////////////////////////////////////////////
+
+unsigned int PlanCache::getPart (TRI_vocbase_t const* vocbase) const {
+  return static_cast<int>(fasthash64(&vocbase, sizeof(decltype(vocbase)), 0xf12345678abcdef) % NumberOfParts);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief return the cache of a database, creating it if it does not exist
+/// note that the caller of this method must hold the write lock
+////////////////////////////////////////////////////////////////////////////////
+
+std::unordered_map<TRI_vocbase_t*, PlanCacheDatabaseEntry*>::iterator PlanCache::getDatabaseEntry (TRI_vocbase_t* vocbase,
+                                                                                                    unsigned int part) {
+  auto it = _entries[part].find(vocbase);
+
+  if (it == _entries[part].end()) {
+    std::unique_ptr<PlanCacheDatabaseEntry> db(new PlanCacheDatabaseEntry());
+    it = _entries[part].emplace(vocbase, db.get()).first;
+    db.release();
+  }
+
+  return it;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief invalidate all entries in the cache part
+/// note that the caller of this method must hold the write lock
+////////////////////////////////////////////////////////////////////////////////
+
+void PlanCache::invalidate (unsigned int part) {
+  _fullInvalidationTick = ++_tick;
+
+  for (auto& it : _entries[part]) {
+    delete it.second;
+  }
+
+  _entries[part].clear();
+}
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                       END-OF-FILE
+// -----------------------------------------------------------------------------
+
+// Local Variables:
+// mode: outline-minor
+// outline-regexp: "/// @brief\\|/// {@inheritDoc}\\|/// @page\\|// --SECTION--\\|/// @\\}"
+// End:
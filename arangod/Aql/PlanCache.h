@@ -0,0 +1,431 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Aql, execution plan cache
+///
+/// @file
+///
+/// DISCLAIMER
+///
+/// Copyright 2014 ArangoDB GmbH, Cologne, Germany
+/// Copyright 2004-2014 triAGENS GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Jan Steemann
+/// @author Copyright 2015, ArangoDB GmbH, Cologne, Germany
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef ARANGODB_AQL_PLAN_CACHE_H
+#define ARANGODB_AQL_PLAN_CACHE_H 1
+
+#include "Basics/Common.h"
+#include "Aql/BindParameters.h"
+#include "Basics/JsonHelper.h"
+#include "Basics/Mutex.h"
+#include "Basics/ReadWriteLock.h"
+
+struct TRI_vocbase_t;
+
+namespace triagens {
+  namespace aql {
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                              struct PlanCacheEntry
+// -----------------------------------------------------------------------------
+
+    struct PlanCacheEntry {
+      PlanCacheEntry () = delete;
+      PlanCacheEntry (PlanCacheEntry const&) = delete;
+      PlanCacheEntry& operator= (PlanCacheEntry const&) = delete;
+
+      PlanCacheEntry (uint64_t,
+                      char const*,
+                      size_t,
+                      triagens::basics::Json&,
+                      triagens::basics::Json&,
+                      std::vector<std::string> const&,
+                      bool,
+                      bool);
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                    public methods
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief whether or not the plan can be used for the given bind parameters.
+/// this is the case if the values of all bind parameters that were injected
+/// into the plan are the same
+////////////////////////////////////////////////////////////////////////////////
+
+      bool matches (BindParametersType const&) const;
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                  member variables
+// -----------------------------------------------------------------------------
+
+      uint64_t const                  _hash;
+      std::string const               _queryString;
+      triagens::basics::Json const    _plan;
+      triagens::basics::Json const    _fixedParameters;
+      std::vector<std::string> const  _collections;
+      bool const                      _isModificationQuery;
+      bool const                      _isCacheable;
+    };
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                      struct PlanCacheDatabaseEntry
+// -----------------------------------------------------------------------------
+
+    struct PlanCacheDatabaseEntry {
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                        constructors / destructors
+// -----------------------------------------------------------------------------
+
+      PlanCacheDatabaseEntry (PlanCacheDatabaseEntry const&) = delete;
+      PlanCacheDatabaseEntry& operator= (PlanCacheDatabaseEntry const&) = delete;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief create a database-specific plan cache
+////////////////////////////////////////////////////////////////////////////////
+
+      PlanCacheDatabaseEntry ();
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                    public methods
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief lookup a plan in the database-specific cache
+////////////////////////////////////////////////////////////////////////////////
+
+      std::shared_ptr<PlanCacheEntry const> lookup (uint64_t,
+                                                    char const*,
+                                                    size_t,
+                                                    BindParametersType const&) const;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief store a plan in the database-specific cache
+////////////////////////////////////////////////////////////////////////////////
+
+      void store (std::shared_ptr<PlanCacheEntry const>,
+                  size_t);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief whether or not one of the collections was invalidated after the
+/// given tick
+////////////////////////////////////////////////////////////////////////////////
+
+      bool wasInvalidated (std::vector<std::string> const&,
+                           uint64_t) const;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief invalidate all plans for a collection in the database-specific
+/// cache
+////////////////////////////////////////////////////////////////////////////////
+
+      void invalidate (char const*,
+                       uint64_t);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief enforce maximum number of plans, evicting the least recently used
+/// plans first
+////////////////////////////////////////////////////////////////////////////////
+
+      void enforceMaxEntries (size_t);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief remove a plan from the database-specific cache
+////////////////////////////////////////////////////////////////////////////////
+
+      void remove (uint64_t);
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                  public variables
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief hash table that maps query hashes to plans, plus the position of
+/// each plan in the usage order list
+////////////////////////////////////////////////////////////////////////////////
+
+      std::unordered_map<uint64_t, std::pair<std::shared_ptr<PlanCacheEntry const>, std::list<uint64_t>::iterator>> _entriesByHash;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief hash table that maps collection names to the hashes of the plans
+/// that use them
+////////////////////////////////////////////////////////////////////////////////
+
+      std::unordered_map<std::string, std::unordered_set<uint64_t>> _entriesByCollection;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief hash table that maps collection names to the tick of their last
+/// invalidation
+////////////////////////////////////////////////////////////////////////////////
+
+      std::unordered_map<std::string, uint64_t> _invalidations;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief plan hashes in usage order, least recently used first. lookups
+/// only hold the read lock of the cache, so they modify the order under a
+/// separate mutex
+////////////////////////////////////////////////////////////////////////////////
+
+      std::list<uint64_t> mutable _order;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief mutex protecting the usage order during lookups
+////////////////////////////////////////////////////////////////////////////////
+
+      triagens::basics::Mutex mutable _orderLock;
+
+    };
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                   class PlanCache
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief cache for optimized execution plans
+///
+/// plans are stored in their serialized JSON form, keyed by a hash of the
+/// query string, the names of the bind parameters and the query options.
+/// bind parameters with scalar values that are only used as operands are
+/// left in the plan and replaced with the values of each query when the plan
+/// is instanciated. all other bind parameters are injected into the plan, so
+/// it is only reused for queries with the same values for them. plans are 
+/// invalidated whenever one of the collections they use is dropped or renamed,
+/// or when an index is created or dropped on it
+////////////////////////////////////////////////////////////////////////////////
+
+    class PlanCache {
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                        constructors / destructors
+// -----------------------------------------------------------------------------
+
+      public:
+
+        PlanCache (PlanCache const&) = delete;
+        PlanCache& operator= (PlanCache const&) = delete;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief create the plan cache
+////////////////////////////////////////////////////////////////////////////////
+
+        PlanCache ();
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief destroy the plan cache
+////////////////////////////////////////////////////////////////////////////////
+
+        ~PlanCache ();
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                    public methods
+// -----------------------------------------------------------------------------
+
+      public:
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief return the plan cache properties and statistics
+////////////////////////////////////////////////////////////////////////////////
+
+        triagens::basics::Json properties ();
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief sets the maximum number of plans in each per-database cache
+/// a value of 0 turns the plan cache off
+////////////////////////////////////////////////////////////////////////////////
+
+        void setMaxEntries (size_t);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief return whether or not the plan cache is turned on
+////////////////////////////////////////////////////////////////////////////////
+
+        bool isActive () const;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief return the current invalidation tick. it must be fetched before a
+/// query is optimized, and be passed to store(), which ignores the plan if
+/// one of its collections was invalidated in the meantime
+////////////////////////////////////////////////////////////////////////////////
+
+        uint64_t tick () const;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief lookup a plan in the cache
+/// returns a nullptr if no plan is cached for the query
+////////////////////////////////////////////////////////////////////////////////
+
+        std::shared_ptr<PlanCacheEntry const> lookup (TRI_vocbase_t*,
+                                                      uint64_t,
+                                                      char const*,
+                                                      size_t,
+                                                      BindParametersType const&);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief store a plan in the cache
+/// the cache takes over the JSON of the plan and of the injected bind 
+/// parameters. the plan is not stored if one of its collections was 
+/// invalidated after the given tick
+////////////////////////////////////////////////////////////////////////////////
+
+        void store (TRI_vocbase_t*,
+                    uint64_t,
+                    char const*,
+                    size_t,
+                    triagens::basics::Json&,
+                    triagens::basics::Json&,
+                    std::vector<std::string> const&,
+                    bool,
+                    bool,
+                    uint64_t);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief invalidate all plans for the given collections
+////////////////////////////////////////////////////////////////////////////////
+
+        void invalidate (TRI_vocbase_t*,
+                         std::vector<char const*> const&);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief invalidate all plans for a particular collection
+////////////////////////////////////////////////////////////////////////////////
+
+        void invalidate (TRI_vocbase_t*,
+                         char const*);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief invalidate all plans for a particular database
+////////////////////////////////////////////////////////////////////////////////
+
+        void invalidate (TRI_vocbase_t*);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief invalidate all plans
+////////////////////////////////////////////////////////////////////////////////
+
+        void invalidate ();
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief get the pointer to the global plan cache
+////////////////////////////////////////////////////////////////////////////////
+
+        static PlanCache* instance ();
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                   private methods
+// -----------------------------------------------------------------------------
+
+      private:
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief determine which part of the cache to use for the cache entries
+////////////////////////////////////////////////////////////////////////////////
+
+        unsigned int getPart (TRI_vocbase_t const*) const;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief return the cache of a database, creating it if it does not exist
+/// note that the caller of this method must hold the write lock
+////////////////////////////////////////////////////////////////////////////////
+
+        std::unordered_map<TRI_vocbase_t*, PlanCacheDatabaseEntry*>::iterator getDatabaseEntry (TRI_vocbase_t*,
+                                                                                                 unsigned int);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief invalidate all entries in the cache part
+/// note that the caller of this method must hold the write lock
+////////////////////////////////////////////////////////////////////////////////
+
+        void invalidate (unsigned int);
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                 private variables
+// -----------------------------------------------------------------------------
+
+      private:
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief number of R/W locks for the plan cache
+////////////////////////////////////////////////////////////////////////////////
+
+        static uint64_t const NumberOfParts = 8;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief protect property changes with a mutex
+////////////////////////////////////////////////////////////////////////////////
+
+        triagens::basics::Mutex _propertiesLock;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief read-write lock for the cache
+////////////////////////////////////////////////////////////////////////////////
+
+        triagens::basics::ReadWriteLock _entriesLock[NumberOfParts];
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief cached plans, organized per database
+////////////////////////////////////////////////////////////////////////////////
+
+        std::unordered_map<TRI_vocbase_t*, PlanCacheDatabaseEntry*> _entries[NumberOfParts];
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief maximum number of plans in each per-database cache
+////////////////////////////////////////////////////////////////////////////////
+
+        std::atomic<size_t> _maxEntries;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief invalidation tick, increased by every invalidation
+////////////////////////////////////////////////////////////////////////////////
+
+        std::atomic<uint64_t> _tick;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief tick of the last invalidation of a complete database or of the
+/// complete cache
+////////////////////////////////////////////////////////////////////////////////
+
+        std::atomic<uint64_t> _fullInvalidationTick;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief number of successful lookups
+////////////////////////////////////////////////////////////////////////////////
+
+        std::atomic<uint64_t> _hits;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief number of unsuccessful lookups
+////////////////////////////////////////////////////////////////////////////////
+
+        std::atomic<uint64_t> _misses;
+
+    };
+
+  }
+}
+
+#endif
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                       END-OF-FILE
+// -----------------------------------------------------------------------------
+
+// Local Variables:
+// mode: outline-minor
+// outline-regexp: "/// @brief\\|/// {@inheritDoc}\\|/// @page\\|// --SECTION--\\|/// @\\}"
+// End:
@@ -34,12 +34,15 @@
 #include "Aql/ExecutionPlan.h"
 #include "Aql/Optimizer.h"
 #include "Aql/Parser.h"
+#include "Aql/PlanCache.h"
 #include "Aql/QueryCache.h"
 #include "Aql/QueryList.h"
 #include "Aql/ShortStringStorage.h"
 #include "Basics/fasthash.h"
 #include "Basics/JsonHelper.h"
+#include "Basics/MutexLocker.h"
 #include "Basics/json.h"
+#include "Basics/json-utilities.h"
 #include "Basics/tri-strings.h"
 #include "Basics/Exceptions.h"
 #include "Cluster/ServerState.h"
@@ -83,6 +86,79 @@ static std::string StateNames[] = {
 static_assert(sizeof(StateNames) / sizeof(std::string) == static_cast<size_t>(ExecutionState::INVALID_STATE), 
               "invalid number of ExecutionState values");
 
+// -----------------------------------------------------------------------------
+// --SECTION--                                                 private functions
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief merge the runtime statistics of the execution nodes into the JSON
+/// representation of the nodes, including the nodes of subqueries
+////////////////////////////////////////////////////////////////////////////////
+
+static void MergeNodeStats (triagens::basics::Json nodes,
+                            std::map<size_t, ExecutionNodeStats> const& stats) {
+  if (! nodes.isArray()) {
+    return;
+  }
+
+  auto itemsOut = [&stats] (size_t id) -> int64_t {
+    auto it = stats.find(id);
+
+    if (it == stats.end()) {
+      return 0;
+    }
+    return (*it).second.items;
+  };
+
+  size_t const n = nodes.size();
+
+  for (size_t i = 0; i < n; ++i) {
+    auto node = nodes.at(static_cast<int>(i));
+
+    if (! node.isObject()) {
+      continue;
+    }
+
+    size_t const id = triagens::basics::JsonHelper::getNumericValue<size_t>(node.json(), "id", 0);
+
+    ExecutionNodeStats nodeStats;
+    auto it = stats.find(id);
+
+    if (it != stats.end()) {
+      nodeStats = (*it).second;
+    }
+
+    // the items consumed by a node are the items produced by its dependencies
+    int64_t itemsIn = 0;
+    auto dependencies = node.get("dependencies");
+
+    if (dependencies.isArray()) {
+      for (size_t j = 0; j < dependencies.size(); ++j) {
+        auto dependency = dependencies.at(static_cast<int>(j));
+
+        if (dependency.isNumber()) {
+          itemsIn += itemsOut(static_cast<size_t>(dependency.json()->_value._number));
+        }
+      }
+    }
+
+    triagens::basics::Json profile(triagens::basics::Json::Object, 5);
+    profile("calls", triagens::basics::Json(static_cast<double>(nodeStats.calls)))
+           ("itemsIn", triagens::basics::Json(static_cast<double>(itemsIn)))
+           ("itemsOut", triagens::basics::Json(static_cast<double>(nodeStats.items)))
+           ("memory", triagens::basics::Json(static_cast<double>(nodeStats.memory)))
+           ("runtime", triagens::basics::Json(nodeStats.runtime));
+
+    node.set("profile", profile);
+
+    auto subquery = node.get("subquery");
+
+    if (subquery.isObject()) {
+      MergeNodeStats(subquery.get("nodes"), stats);
+    }
+  }
+}
+
 // -----------------------------------------------------------------------------
 // --SECTION--                                                    struct Profile
 // -----------------------------------------------------------------------------
@@ -165,6 +241,12 @@ TRI_json_t* Profile::toJson (TRI_memory_zone_t*) {
           
 bool Query::DoDisableQueryTracking = false;
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief maximum number of threads for scanning a collection in parallel
+////////////////////////////////////////////////////////////////////////////////
+          
+size_t Query::MaxScanThreads = 4;
+
 // -----------------------------------------------------------------------------
 // --SECTION--                                        constructors / destructors
 // -----------------------------------------------------------------------------
@@ -206,7 +288,9 @@ Query::Query (triagens::arango::ApplicationV8* applicationV8,
     _part(part),
     _contextOwnedByExterior(contextOwnedByExterior),
     _killed(false),
-    _isModificationQuery(false) {
+    _isModificationQuery(false),
+    _isCacheableQuery(false),
+    _cachedPlan() {
 
   // std::cout << TRI_CurrentThreadId() << ", QUERY " << this << " CTOR: " << queryString << "\n";
 
@@ -248,7 +332,9 @@ Query::Query (triagens::arango::ApplicationV8* applicationV8,
     _part(part),
     _contextOwnedByExterior(contextOwnedByExterior),
     _killed(false),
-    _isModificationQuery(false) {
+    _isModificationQuery(false),
+    _isCacheableQuery(false),
+    _cachedPlan() {
 
   // std::cout << TRI_CurrentThreadId() << ", QUERY " << this << " CTOR (JSON): " << _queryJson.toString() << "\n";
 
@@ -369,6 +455,21 @@ void Query::addNode (AstNode* node) {
   _nodes.emplace_back(node);
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief return the value of a bind parameter
+////////////////////////////////////////////////////////////////////////////////
+
+TRI_json_t const* Query::bindParameter (std::string const& name) {
+  auto const& parameters = _bindParameters();
+  auto it = parameters.find(name);
+
+  if (it == parameters.end()) {
+    return nullptr;
+  }
+
+  return (*it).second.first;
+}
+
 // -----------------------------------------------------------------------------
 // --SECTION--                                                    public methods
 // -----------------------------------------------------------------------------
@@ -480,6 +581,8 @@ void Query::registerWarning (int code,
 
   TRI_ASSERT(code != TRI_ERROR_NO_ERROR);
 
+  MUTEX_LOCKER(_warningsLock);
+
   if (_warnings.size() > _maxWarningCount) {
     return;
   }
@@ -506,21 +609,55 @@ QueryResult Query::prepare (QueryRegistry* registry) {
 
     std::unique_ptr<Parser> parser(new Parser(this));
     std::unique_ptr<ExecutionPlan> plan;
+
+    bool const usePlanCache = canUsePlanCache();
+    uint64_t planCacheHash = 0;
+    uint64_t planCacheTick = 0;
+
+    if (usePlanCache) {
+      planCacheHash = planHash();
+      // the tick must be fetched before the query is optimized, so a plan
+      // that refers to a meanwhile dropped index is not stored
+      planCacheTick = PlanCache::instance()->tick();
+      auto entry = PlanCache::instance()->lookup(_vocbase, planCacheHash, _queryString, _queryLength, _bindParameters());
+
+      if (entry != nullptr) {
+        // found an optimized plan for the query. it will be instanciated 
+        // from JSON below, so we can skip parsing and optimizing the query
+        _cachedPlan = entry->_plan.copy();
+        _isModificationQuery = entry->_isModificationQuery;
+        _isCacheableQuery = entry->_isCacheable;
+      }
+    }
+
+    bool const fromAst = (_queryString != nullptr && _cachedPlan.isEmpty());
+
+    // bind parameters that are left in the plan, and are re-bound each time 
+    // the plan is instanciated from JSON
+    std::unordered_set<std::string> rebindable;
     
-    if (_queryString != nullptr) {
+    if (fromAst) {
       parser->parse(false);
+
+      if (usePlanCache) {
+        rebindable = parser->ast()->rebindableParameters(_bindParameters);
+      }
+
       // put in bind parameters
-      parser->ast()->injectBindParameters(_bindParameters);
+      parser->ast()->injectBindParameters(_bindParameters, rebindable);
     }
       
-    _isModificationQuery = parser->isModificationQuery();
+    if (_cachedPlan.isEmpty()) {
+      _isModificationQuery = parser->isModificationQuery();
+    }
 
     // create the transaction object, but do not start it yet
     _trx = new triagens::arango::AqlTransaction(createTransactionContext(), _vocbase, _collections.collections(), _part == PART_MAIN);
 
     bool planRegisters;
+    triagens::basics::Json planJson;
 
-    if (_queryString != nullptr) {
+    if (fromAst) {
       // we have an AST
       int res = _trx->begin();
 
@@ -532,6 +669,7 @@ QueryResult Query::prepare (QueryRegistry* registry) {
       enterState(AST_OPTIMIZATION);
 
       parser->ast()->validateAndOptimize();
+      _isCacheableQuery = parser->ast()->root()->isCacheable();
       // std::cout << "AST: " << triagens::basics::JsonHelper::toString(parser->ast()->toJson(TRI_UNKNOWN_MEM_ZONE, false)) << "\n";
 
       enterState(PLAN_INSTANCIATION);
@@ -550,12 +688,30 @@ QueryResult Query::prepare (QueryRegistry* registry) {
       // Now plan and all derived plans belong to the optimizer
       plan.reset(opt.stealBest()); // Now we own the best one again
       planRegisters = true;
+
+      if (! rebindable.empty()) {
+        // the plan still contains bind parameters. serialize it and 
+        // instanciate it again, which replaces the bind parameters with 
+        // their values. this is the same as what happens for a cached plan
+        plan->planRegisters();
+        planJson = plan->toJson(parser->ast(), TRI_UNKNOWN_MEM_ZONE, true);
+        plan.reset(ExecutionPlan::instanciateFromJson(parser->ast(), planJson));
+
+        if (plan.get() == nullptr) {
+          // oops
+          return QueryResult(TRI_ERROR_INTERNAL);
+        }
+
+        planRegisters = false;
+      }
     }
-    else {   // no queryString, we are instanciating from _queryJson
+    else {   // we are instanciating from _queryJson or from a cached plan
+      triagens::basics::Json const& queryJson = (_cachedPlan.isEmpty() ? _queryJson : _cachedPlan);
+
       enterState(PLAN_INSTANCIATION);
-      ExecutionPlan::getCollectionsFromJson(parser->ast(), _queryJson);
+      ExecutionPlan::getCollectionsFromJson(parser->ast(), queryJson);
 
-      parser->ast()->variables()->fromJson(_queryJson);
+      parser->ast()->variables()->fromJson(queryJson);
       // creating the plan may have produced some collections
       // we need to add them to the transaction now (otherwise the query will fail)
 
@@ -570,7 +726,7 @@ QueryResult Query::prepare (QueryRegistry* registry) {
       }
 
       // we have an execution plan in JSON format
-      plan.reset(ExecutionPlan::instanciateFromJson(parser->ast(), _queryJson));
+      plan.reset(ExecutionPlan::instanciateFromJson(parser->ast(), queryJson));
       if (plan.get() == nullptr) {
         // oops
         return QueryResult(TRI_ERROR_INTERNAL);
@@ -603,6 +759,30 @@ QueryResult Query::prepare (QueryRegistry* registry) {
     enterState(EXECUTION);
     ExecutionEngine* engine(ExecutionEngine::instanciateFromPlan(registry, this, plan.get(), planRegisters));
 
+    if (usePlanCache && fromAst && _warnings.empty()) {
+      // store the optimized plan, including its register assignments
+      try {
+        if (planJson.isEmpty()) {
+          planJson = plan->toJson(parser->ast(), TRI_UNKNOWN_MEM_ZONE, true);
+        }
+
+        // the values of all injected bind parameters must match for the
+        // plan to be reused
+        triagens::basics::Json fixedParameters(triagens::basics::Json::Object);
+
+        for (auto const& it : _bindParameters()) {
+          if (rebindable.find(it.first) == rebindable.end()) {
+            fixedParameters.set(it.first, triagens::basics::Json(TRI_UNKNOWN_MEM_ZONE, it.second.first).copy());
+          }
+        }
+
+        PlanCache::instance()->store(_vocbase, planCacheHash, _queryString, _queryLength, planJson, fixedParameters, _collections.collectionNames(), _isModificationQuery, _isCacheableQuery, planCacheTick);
+      }
+      catch (...) {
+        // failure to cache the plan does not affect the query itself
+      }
+    }
+
     // If all went well so far, then we keep _plan, _parser and _trx and
     // return:
     _plan = plan.release();
@@ -663,12 +843,11 @@ QueryResult Query::execute (QueryRegistry* registry) {
       return res;
     }
 
-    if (useQueryCache && (_isModificationQuery || ! _warnings.empty() || ! _ast->root()->isCacheable())) {
+    if (useQueryCache && (_isModificationQuery || ! _warnings.empty() || ! _isCacheableQuery)) {
       useQueryCache = false;
     }
 
     triagens::basics::Json jsonResult(triagens::basics::Json::Array, 16);
-    triagens::basics::Json stats;
 
     // this is the RegisterId our results can be found in
     auto const resultRegister = _engine->resultRegister();
@@ -734,22 +913,8 @@ QueryResult Query::execute (QueryRegistry* registry) {
       throw;
     }
 
-    stats = _engine->_stats.toJson();
-
-    _trx->commit();
-    
-    cleanupPlanAndEngine(TRI_ERROR_NO_ERROR);
-
-    enterState(FINALIZATION); 
-
-    QueryResult result(TRI_ERROR_NO_ERROR);
-    result.warnings = warningsToJson(TRI_UNKNOWN_MEM_ZONE);
-    result.json     = jsonResult.steal();
-    result.stats    = stats.steal(); 
-
-    if (_profile != nullptr && profiling()) {
-      result.profile = _profile->toJson(TRI_UNKNOWN_MEM_ZONE);
-    }
+    QueryResult result = finalize();
+    result.json = jsonResult.steal();
 
     return result;
   }
@@ -771,6 +936,40 @@ QueryResult Query::execute (QueryRegistry* registry) {
   }
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief finalizes a prepared query after all results have been fetched
+/// from its engine
+////////////////////////////////////////////////////////////////////////////////
+
+QueryResult Query::finalize () {
+  TRI_ASSERT(_engine != nullptr);
+  TRI_ASSERT(_trx != nullptr);
+
+  triagens::basics::Json stats = _engine->_stats.toJson(false);
+  triagens::basics::Json plan;
+
+  if (profiling()) {
+    plan = profiledPlan();
+  }
+
+  _trx->commit();
+    
+  cleanupPlanAndEngine(TRI_ERROR_NO_ERROR);
+
+  enterState(FINALIZATION); 
+
+  QueryResult result(TRI_ERROR_NO_ERROR);
+  result.warnings = warningsToJson(TRI_UNKNOWN_MEM_ZONE);
+  result.stats    = stats.steal(); 
+  result.plan     = plan.steal();
+
+  if (_profile != nullptr && profiling()) {
+    result.profile = _profile->toJson(TRI_UNKNOWN_MEM_ZONE);
+  }
+
+  return result;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief execute an AQL query 
 /// may only be called with an active V8 handle scope
@@ -805,7 +1004,7 @@ QueryResultV8 Query::executeV8 (v8::Isolate* isolate,
       return res;
     }
 
-    if (useQueryCache && (_isModificationQuery || ! _warnings.empty() || ! _ast->root()->isCacheable())) {
+    if (useQueryCache && (_isModificationQuery || ! _warnings.empty() || ! _isCacheableQuery)) {
       useQueryCache = false;
     }
 
@@ -880,7 +1079,12 @@ QueryResultV8 Query::executeV8 (v8::Isolate* isolate,
       throw;
     }
 
-    stats = _engine->_stats.toJson();
+    stats = _engine->_stats.toJson(false);
+    triagens::basics::Json plan;
+
+    if (profiling()) {
+      plan = profiledPlan();
+    }
 
     _trx->commit();
     
@@ -890,6 +1094,7 @@ QueryResultV8 Query::executeV8 (v8::Isolate* isolate,
 
     result.warnings = warningsToJson(TRI_UNKNOWN_MEM_ZONE);
     result.stats    = stats.steal(); 
+    result.plan     = plan.steal();
 
     if (_profile != nullptr && profiling()) {
       result.profile = _profile->toJson(TRI_UNKNOWN_MEM_ZONE);
@@ -1155,6 +1360,15 @@ void Query::exitContext () {
   }
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief whether the V8 context must be exited after each use
+////////////////////////////////////////////////////////////////////////////////
+
+bool Query::mustExitContext () const {
+  return (triagens::arango::ServerState::instance()->isRunningInCluster() ||
+          getBooleanOption("stream", false));
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief returns statistics for current query.
 ////////////////////////////////////////////////////////////////////////////////
@@ -1296,6 +1510,63 @@ bool Query::canUseQueryCache () const {
   return false;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief calculate a hash value for looking up the query's execution plan
+/// in the plan cache
+////////////////////////////////////////////////////////////////////////////////
+
+uint64_t Query::planHash () {
+  // hash the query string first
+  uint64_t hash = triagens::aql::QueryCache::instance()->hashQueryString(_queryString, _queryLength);
+
+  // the options may turn optimizer rules on or off, so they must be part of
+  // the hash, too
+  if (_options != nullptr) {
+    uint64_t const optionsHash = TRI_FastHashJson(_options);
+    hash = fasthash64(&optionsHash, sizeof(optionsHash), hash);
+  }
+
+  // scalar bind parameter values can be re-bound into a cached plan, so only
+  // the names of the bind parameters are part of the hash. the values of all
+  // other bind parameters are injected into the plan, so they are hashed, too.
+  // the names are combined with xor as their order is undefined
+  uint64_t parametersHash = 0;
+
+  for (auto const& it : _bindParameters()) {
+    auto const& name = it.first;
+    TRI_json_t const* value = it.second.first;
+
+    uint64_t h = fasthash64(name.c_str(), name.size(), 0x3a9c4fe1b2d87065ULL);
+
+    if (name[0] == '@' ||
+        TRI_IsArrayJson(value) ||
+        TRI_IsObjectJson(value)) {
+      h ^= TRI_FastHashJson(value);
+    }
+
+    parametersHash ^= h;
+  }
+
+  return fasthash64(&parametersHash, sizeof(parametersHash), hash);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief whether or not the plan cache can be used for the query
+////////////////////////////////////////////////////////////////////////////////
+
+bool Query::canUsePlanCache () const {
+  if (_queryString == nullptr || _part != PART_MAIN) {
+    return false;
+  }
+
+  if (! PlanCache::instance()->isActive() || ! getBooleanOption("planCache", true)) {
+    return false;
+  }
+  
+  // cannot use plan cache on a coordinator at the moment
+  return ! triagens::arango::ServerState::instance()->isRunningInCluster();
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief fetch a numeric value from the options
 ////////////////////////////////////////////////////////////////////////////////
@@ -1446,6 +1717,21 @@ void Query::cleanupPlanAndEngine (int errorCode) {
   }
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief return the execution plan with the runtime statistics of its nodes
+////////////////////////////////////////////////////////////////////////////////
+
+triagens::basics::Json Query::profiledPlan () const {
+  TRI_ASSERT(_plan != nullptr);
+  TRI_ASSERT(_parser != nullptr);
+  TRI_ASSERT(_engine != nullptr);
+
+  triagens::basics::Json plan = _plan->toJson(_parser->ast(), TRI_UNKNOWN_MEM_ZONE, false);
+  MergeNodeStats(plan.get("nodes"), _engine->_stats.nodes);
+
+  return plan;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief set the plan for the query
 ////////////////////////////////////////////////////////////////////////////////
@@ -32,6 +32,7 @@
 
 #include "Basics/Common.h"
 #include "Basics/JsonHelper.h"
+#include "Basics/Mutex.h"
 #include "Aql/BindParameters.h"
 #include "Aql/Collections.h"
 #include "Aql/QueryResultV8.h"
@@ -261,6 +262,13 @@ namespace triagens {
 
         void addNode (AstNode*);
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief return the value of a bind parameter, or a nullptr if the query
+/// has no bind parameter with this name
+////////////////////////////////////////////////////////////////////////////////
+
+        TRI_json_t const* bindParameter (std::string const&);
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief should we return verbose plans?
 ////////////////////////////////////////////////////////////////////////////////
@@ -309,6 +317,32 @@ namespace triagens {
           return -1;
         }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief memory budget (in bytes) for a single SORT, above which sorted runs
+/// are spilled to temporary files. 0 means unlimited
+////////////////////////////////////////////////////////////////////////////////
+
+        size_t sortMemoryLimit () const { 
+          double value = getNumericOption("sortMemoryLimit", 0.0);
+          if (value > 0) {
+            return static_cast<size_t>(value);
+          }
+          return 0;
+        }
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief maximum number of threads for scanning a collection in parallel.
+/// the query can lower the server-wide value, but not raise it
+////////////////////////////////////////////////////////////////////////////////
+
+        size_t scanThreads () const { 
+          double value = getNumericOption("scanThreads", -1.0);
+          if (value >= 0 && value < static_cast<double>(MaxScanThreads)) {
+            return static_cast<size_t>(value);
+          }
+          return MaxScanThreads;
+        }
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief extract a region from the query
 ////////////////////////////////////////////////////////////////////////////////
@@ -354,6 +388,17 @@ namespace triagens {
 
         QueryResult execute (QueryRegistry*);
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief finalizes a prepared query after all results have been fetched
+/// from its engine
+///
+/// this commits the transaction, frees the plan and the engine and returns
+/// the warnings, statistics and profile of the query. it is used by callers
+/// that call prepare() and then pull the results from the engine themselves
+////////////////////////////////////////////////////////////////////////////////
+
+        QueryResult finalize ();
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief execute an AQL query 
 /// may only be called with an active V8 handle scope
@@ -454,6 +499,14 @@ namespace triagens {
 
         void exitContext ();
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief whether the V8 context must be exited after each use. this is the
+/// case in a cluster and for streaming cursors, because the query may then be
+/// continued by a different thread
+////////////////////////////////////////////////////////////////////////////////
+
+        bool mustExitContext () const;
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief returns statistics for current query.
 ////////////////////////////////////////////////////////////////////////////////
@@ -489,6 +542,15 @@ namespace triagens {
           DoDisableQueryTracking = value;
         }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief set the maximum number of threads for scanning a collection in
+/// parallel globally
+////////////////////////////////////////////////////////////////////////////////
+        
+        static void SetMaxScanThreads (size_t value) {
+          MaxScanThreads = value;
+        }
+
 // -----------------------------------------------------------------------------
 // --SECTION--                                                   private methods
 // -----------------------------------------------------------------------------
@@ -513,6 +575,19 @@ namespace triagens {
 
         bool canUseQueryCache () const;
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief calculate a hash value for looking up the query's execution plan
+/// in the plan cache
+////////////////////////////////////////////////////////////////////////////////
+
+        uint64_t planHash ();
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief whether or not the plan cache can be used for the query
+////////////////////////////////////////////////////////////////////////////////
+
+        bool canUsePlanCache () const;
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief fetch a numeric value from the options
 ////////////////////////////////////////////////////////////////////////////////
@@ -556,6 +631,13 @@ namespace triagens {
 
         void cleanupPlanAndEngine (int);
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief return the execution plan with the runtime statistics of its nodes
+/// merged into it
+////////////////////////////////////////////////////////////////////////////////
+
+        triagens::basics::Json profiledPlan () const;
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief create a TransactionContext
 ////////////////////////////////////////////////////////////////////////////////
@@ -709,6 +791,13 @@ namespace triagens {
 
         std::vector<std::pair<int, std::string>> _warnings;
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief lock for the warnings, which may be registered concurrently by
+/// the threads of a parallel collection scan
+////////////////////////////////////////////////////////////////////////////////
+
+        triagens::basics::Mutex           _warningsLock;
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief the query part
 ////////////////////////////////////////////////////////////////////////////////
@@ -733,12 +822,32 @@ namespace triagens {
 
         bool                              _isModificationQuery;
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief whether or not the query result may be stored in the query cache
+////////////////////////////////////////////////////////////////////////////////
+
+        bool                              _isCacheableQuery;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief copy of the execution plan taken from the plan cache
+/// the plan is kept for the lifetime of the query as the execution blocks
+/// may refer to parts of it
+////////////////////////////////////////////////////////////////////////////////
+
+        triagens::basics::Json            _cachedPlan;
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief whether or not query tracking is disabled globally
 ////////////////////////////////////////////////////////////////////////////////
           
         static bool DoDisableQueryTracking;
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief maximum number of threads for scanning a collection in parallel
+////////////////////////////////////////////////////////////////////////////////
+          
+        static size_t MaxScanThreads;
+
     };
 
   }
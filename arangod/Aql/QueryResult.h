@@ -51,6 +51,7 @@ namespace triagens {
         json              = other.json;
         stats             = other.stats;
         profile           = other.profile;
+        plan              = other.plan;
         zone              = other.zone;
         clusterplan       = other.clusterplan;
         bindParameters    = other.bindParameters;
@@ -60,6 +61,7 @@ namespace triagens {
         other.json        = nullptr;
         other.stats       = nullptr;
         other.profile     = nullptr;
+        other.plan        = nullptr;
         other.clusterplan = nullptr;
       }
 
@@ -73,6 +75,7 @@ namespace triagens {
           json(nullptr),
           stats(nullptr),
           profile(nullptr),
+          plan(nullptr),
           clusterplan(nullptr) {
       }
       
@@ -97,6 +100,9 @@ namespace triagens {
         if (profile != nullptr) {
           TRI_FreeJson(zone, profile);
         }
+        if (plan != nullptr) {
+          TRI_FreeJson(zone, plan);
+        }
       }
 
       int                             code;
@@ -109,6 +115,7 @@ namespace triagens {
       TRI_json_t*                     json;
       TRI_json_t*                     stats;
       TRI_json_t*                     profile;
+      TRI_json_t*                     plan;
       TRI_json_t*                     clusterplan;
     };
 
@@ -27,6 +27,7 @@
 
 #include "Basics/Common.h"
 #include "Basics/JsonHelper.h"
+#include "Aql/Ast.h"
 #include "Aql/RangeInfo.h"
 
 using namespace triagens::basics;
@@ -133,7 +134,7 @@ AstNode const* RangeInfoBound::getExpressionAst (Ast* ast) const {
   }
 
   // ast will remember the node and delete it
-  _expressionAst = new AstNode(ast, _bound);
+  _expressionAst = ast->nodeFromPlanJson(_bound);
 
   return _expressionAst;
 }
@@ -0,0 +1,186 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Aql, sorted run of item blocks spilled to disk
+///
+/// @file
+///
+/// DISCLAIMER
+///
+/// Copyright 2014 ArangoDB GmbH, Cologne, Germany
+/// Copyright 2004-2014 triAGENS GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Jan Steemann
+/// @author Copyright 2015, ArangoDB GmbH, Cologne, Germany
+////////////////////////////////////////////////////////////////////////////////
+
+#include "Aql/SortRun.h"
+#include "Aql/AqlItemBlock.h"
+#include "Basics/Exceptions.h"
+#include "Basics/files.h"
+#include "Basics/JsonHelper.h"
+#include "Basics/logging.h"
+#include "Basics/StringBuffer.h"
+
+using namespace triagens::aql;
+using Json = triagens::basics::Json;
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                        constructors / destructors
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief create a sort run, backed by a new temporary file
+////////////////////////////////////////////////////////////////////////////////
+
+SortRun::SortRun ()
+  : _filename(),
+    _fd(-1),
+    _numberBlocks(0),
+    _readBlocks(0),
+    _size(0) {
+
+  char* filename = nullptr;
+  long systemError;
+  std::string errorMessage;
+
+  int res = TRI_GetTempName(nullptr, &filename, false, systemError, errorMessage);
+
+  if (res != TRI_ERROR_NO_ERROR) {
+    THROW_ARANGO_EXCEPTION_MESSAGE(TRI_ERROR_CANNOT_CREATE_TEMP_FILE, errorMessage);
+  }
+
+  _filename = filename;
+  TRI_Free(TRI_CORE_MEM_ZONE, filename);
+
+  _fd = TRI_CREATE(_filename.c_str(), O_CREAT | O_EXCL | O_RDWR, S_IRUSR | S_IWUSR);
+
+  if (_fd < 0) {
+    TRI_set_errno(TRI_ERROR_SYS_ERROR);
+    THROW_ARANGO_EXCEPTION_MESSAGE(TRI_ERROR_CANNOT_CREATE_TEMP_FILE,
+                                   std::string("cannot create sort run file '") + _filename + "': " + TRI_last_error());
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief destroy a sort run, removing its temporary file
+////////////////////////////////////////////////////////////////////////////////
+
+SortRun::~SortRun () {
+  if (_fd >= 0) {
+    TRI_CLOSE(_fd);
+  }
+
+  int res = TRI_UnlinkFile(_filename.c_str());
+
+  if (res != TRI_ERROR_NO_ERROR) {
+    LOG_WARNING("unable to remove sort run file '%s': %s", _filename.c_str(), TRI_errno_string(res));
+  }
+}
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                  public functions
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief append a block to the end of the run
+/// each block is stored as its length followed by its JSON serialization,
+/// which is the same format used for shipping blocks between cluster nodes
+////////////////////////////////////////////////////////////////////////////////
+
+void SortRun::append (AqlItemBlock const* block,
+                      triagens::arango::AqlTransaction* trx) {
+  TRI_ASSERT(block != nullptr);
+  TRI_ASSERT(_readBlocks == 0);
+
+  Json json(block->toJson(trx));
+
+  triagens::basics::StringBuffer buffer(TRI_UNKNOWN_MEM_ZONE);
+  int res = TRI_StringifyJson(buffer.stringBuffer(), json.json());
+
+  if (res != TRI_ERROR_NO_ERROR) {
+    THROW_ARANGO_EXCEPTION(res);
+  }
+
+  uint64_t length = static_cast<uint64_t>(buffer.length());
+
+  if (! TRI_WritePointer(_fd, &length, sizeof(length)) ||
+      ! TRI_WritePointer(_fd, buffer.c_str(), buffer.length())) {
+    THROW_ARANGO_EXCEPTION_MESSAGE(TRI_ERROR_CANNOT_WRITE_FILE,
+                                   std::string("cannot write sort run file '") + _filename + "'");
+  }
+
+  ++_numberBlocks;
+  _size += block->size();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief position the run at its first block
+////////////////////////////////////////////////////////////////////////////////
+
+void SortRun::rewind () {
+  if (TRI_LSEEK(_fd, 0, SEEK_SET) != 0) {
+    THROW_ARANGO_EXCEPTION_MESSAGE(TRI_ERROR_SYS_ERROR,
+                                   std::string("cannot seek in sort run file '") + _filename + "'");
+  }
+
+  _readBlocks = 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief read the next block of the run
+////////////////////////////////////////////////////////////////////////////////
+
+AqlItemBlock* SortRun::next () {
+  if (_readBlocks >= _numberBlocks) {
+    // all blocks read
+    return nullptr;
+  }
+
+  uint64_t length;
+
+  if (! TRI_ReadPointer(_fd, &length, sizeof(length))) {
+    THROW_ARANGO_EXCEPTION_MESSAGE(TRI_ERROR_INTERNAL,
+                                   std::string("cannot read sort run file '") + _filename + "'");
+  }
+
+  std::string data;
+  data.resize(static_cast<size_t>(length));
+
+  if (! TRI_ReadPointer(_fd, &data[0], data.size())) {
+    THROW_ARANGO_EXCEPTION_MESSAGE(TRI_ERROR_INTERNAL,
+                                   std::string("cannot read sort run file '") + _filename + "'");
+  }
+
+  Json json(TRI_UNKNOWN_MEM_ZONE, TRI_JsonString(TRI_UNKNOWN_MEM_ZONE, data.c_str()));
+
+  if (json.isEmpty()) {
+    THROW_ARANGO_EXCEPTION_MESSAGE(TRI_ERROR_INTERNAL,
+                                   std::string("corrupted sort run file '") + _filename + "'");
+  }
+
+  ++_readBlocks;
+
+  return new AqlItemBlock(json);
+}
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                       END-OF-FILE
+// -----------------------------------------------------------------------------
+
+// Local Variables:
+// mode: outline-minor
+// outline-regexp: "/// @brief\\|/// {@inheritDoc}\\|/// @page\\|// --SECTION--\\|/// @\\}"
+// End:
@@ -0,0 +1,149 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Aql, sorted run of item blocks spilled to disk
+///
+/// @file
+///
+/// DISCLAIMER
+///
+/// Copyright 2014 ArangoDB GmbH, Cologne, Germany
+/// Copyright 2004-2014 triAGENS GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Jan Steemann
+/// @author Copyright 2015, ArangoDB GmbH, Cologne, Germany
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef ARANGODB_AQL_SORT_RUN_H
+#define ARANGODB_AQL_SORT_RUN_H 1
+
+#include "Basics/Common.h"
+
+namespace triagens {
+  namespace arango {
+    class AqlTransaction;
+  }
+
+  namespace aql {
+
+    class AqlItemBlock;
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                     class SortRun
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief a run of already sorted item blocks, stored in a temporary file.
+/// the blocks are written sequentially and can be read back in the same
+/// order. the temporary file is removed when the run is destroyed
+////////////////////////////////////////////////////////////////////////////////
+
+    class SortRun {
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                        constructors / destructors
+// -----------------------------------------------------------------------------
+
+      public:
+
+        SortRun (SortRun const&) = delete;
+        SortRun& operator= (SortRun const&) = delete;
+
+        SortRun ();
+
+        ~SortRun ();
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                  public functions
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief append a block to the end of the run
+////////////////////////////////////////////////////////////////////////////////
+
+        void append (AqlItemBlock const*,
+                     triagens::arango::AqlTransaction*);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief position the run at its first block
+////////////////////////////////////////////////////////////////////////////////
+
+        void rewind ();
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief read the next block of the run. returns a nullptr if all blocks
+/// have been read. the caller takes ownership of the block
+////////////////////////////////////////////////////////////////////////////////
+
+        AqlItemBlock* next ();
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief total number of rows in the run
+////////////////////////////////////////////////////////////////////////////////
+
+        size_t size () const {
+          return _size;
+        }
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                 private variables
+// -----------------------------------------------------------------------------
+
+      private:
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief name of the temporary file
+////////////////////////////////////////////////////////////////////////////////
+
+        std::string _filename;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief file descriptor of the temporary file
+////////////////////////////////////////////////////////////////////////////////
+
+        int _fd;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief number of blocks written
+////////////////////////////////////////////////////////////////////////////////
+
+        size_t _numberBlocks;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief number of blocks read since the last rewind
+////////////////////////////////////////////////////////////////////////////////
+
+        size_t _readBlocks;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief number of rows written
+////////////////////////////////////////////////////////////////////////////////
+
+        size_t _size;
+    };
+
+  }
+}
+
+#endif
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                       END-OF-FILE
+// -----------------------------------------------------------------------------
+
+// Local Variables:
+// mode: outline-minor
+// outline-regexp: "/// @brief\\|/// {@inheritDoc}\\|/// @page\\|// --SECTION--\\|/// @\\}"
+// End:
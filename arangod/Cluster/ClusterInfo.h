@@ -234,6 +234,14 @@ namespace triagens {
           return triagens::basics::JsonHelper::getNumericValue<uint32_t>(_json, "indexBuckets", 1);
         }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief returns whether document bodies are stored compressed
+////////////////////////////////////////////////////////////////////////////////
+
+        bool compressDocuments () const {
+          return triagens::basics::JsonHelper::getBooleanValue(_json, "compressDocuments", false);
+        }
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief returns the shard keys
 ////////////////////////////////////////////////////////////////////////////////
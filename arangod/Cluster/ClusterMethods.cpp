@@ -442,6 +442,11 @@ int figuresOnCoordinator (string const& dbname,
             result->_journalfileSize      += ExtractFigure<int64_t>(figures, "journals", "fileSize");
             result->_compactorfileSize    += ExtractFigure<int64_t>(figures, "compactors", "fileSize");
             result->_shapefileSize        += ExtractFigure<int64_t>(figures, "shapefiles", "fileSize");
+
+            result->_numberCompressed     += ExtractFigure<int64_t>(figures, "compression", "count");
+            result->_sizeUncompressed     += ExtractFigure<int64_t>(figures, "compression", "uncompressedSize");
+            result->_sizeCompressed       += ExtractFigure<int64_t>(figures, "compression", "compressedSize");
+            result->_compressionTime      += static_cast<int64_t>(ExtractFigure<double>(figures, "compression", "time") * 1000000.0);
           }
           nrok++;
         }
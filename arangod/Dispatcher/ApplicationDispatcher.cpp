@@ -34,6 +34,7 @@
 #include "ApplicationDispatcher.h"
 
 #include "Basics/logging.h"
+#include "Basics/numa.h"
 #include "Dispatcher/Dispatcher.h"
 #include "Scheduler/Scheduler.h"
 #include "Scheduler/PeriodicTask.h"
@@ -175,6 +176,23 @@ void ApplicationDispatcher::setProcessorAffinity (const vector<size_t>& cores) {
 #endif
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief binds the threads to the NUMA nodes round-robin
+////////////////////////////////////////////////////////////////////////////////
+
+void ApplicationDispatcher::setNumaAffinity () {
+#ifdef TRI_HAVE_THREAD_AFFINITY
+  vector<vector<size_t>> nodes;
+  size_t const n = TRI_NumberNumaNodes();
+
+  for (size_t i = 0;  i < n;  ++i) {
+    nodes.emplace_back(TRI_NumaNodeProcessors(i));
+  }
+
+  _dispatcher->setProcessorAffinity(Dispatcher::STANDARD_QUEUE, nodes);
+#endif
+}
+
 // -----------------------------------------------------------------------------
 // --SECTION--                                        ApplicationFeature methods
 // -----------------------------------------------------------------------------
@@ -121,6 +121,13 @@ namespace triagens {
 
         void setProcessorAffinity (const std::vector<size_t>& cores);
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief binds the threads to the NUMA nodes round-robin. each thread may
+/// run on all cores of its node
+////////////////////////////////////////////////////////////////////////////////
+
+        void setNumaAffinity ();
+
 // -----------------------------------------------------------------------------
 // --SECTION--                                        ApplicationFeature methods
 // -----------------------------------------------------------------------------
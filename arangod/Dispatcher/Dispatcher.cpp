@@ -239,6 +239,20 @@ void Dispatcher::setProcessorAffinity (size_t id, std::vector<size_t> const& cor
   queue->setProcessorAffinity(cores);
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief sets the process affinity to sets of cores
+////////////////////////////////////////////////////////////////////////////////
+
+void Dispatcher::setProcessorAffinity (size_t id, std::vector<std::vector<size_t>> const& cores) {
+  DispatcherQueue* queue;
+
+  if (id >= SIZE_QUEUE || (queue = _queues[id]) == nullptr) {
+    return;
+  }
+
+  queue->setProcessorAffinity(cores);
+}
+
 // -----------------------------------------------------------------------------
 // --SECTION--                                                       END-OF-FILE
 // -----------------------------------------------------------------------------
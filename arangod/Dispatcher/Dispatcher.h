@@ -171,6 +171,12 @@ namespace triagens {
 
         void setProcessorAffinity (size_t id, const std::vector<size_t>& cores);
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief sets the process affinity to sets of cores
+////////////////////////////////////////////////////////////////////////////////
+
+        void setProcessorAffinity (size_t id, const std::vector<std::vector<size_t>>& cores);
+
 // -----------------------------------------------------------------------------
 // --SECTION--                                                 private variables
 // -----------------------------------------------------------------------------
@@ -381,9 +381,9 @@ void DispatcherQueue::startQueueThread () {
   DispatcherThread * thread = (*createDispatcherThread)(this);
 
   if (! _affinityCores.empty()) {
-    size_t c = _affinityCores[_affinityPos];
+    auto const& c = _affinityCores[_affinityPos];
 
-    LOG_DEBUG("using core %d for standard dispatcher thread", (int) c);
+    LOG_DEBUG("using %d core(s) starting at core %d for standard dispatcher thread", (int) c.size(), (int) c[0]);
 
     thread->setProcessorAffinity(c);
 
@@ -473,6 +473,18 @@ bool DispatcherQueue::notEnoughThreads () {
 ////////////////////////////////////////////////////////////////////////////////
 
 void DispatcherQueue::setProcessorAffinity (const vector<size_t>& cores) {
+  _affinityCores.clear();
+
+  for (auto const& c : cores) {
+    _affinityCores.emplace_back(vector<size_t>{ c });
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief sets the process affinity to sets of cores
+////////////////////////////////////////////////////////////////////////////////
+
+void DispatcherQueue::setProcessorAffinity (const vector<vector<size_t>>& cores) {
   _affinityCores = cores;
 }
 
@@ -163,6 +163,13 @@ namespace triagens {
 
         void setProcessorAffinity (const std::vector<size_t>& cores);
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief sets the process affinity to sets of cores. the threads are
+/// assigned to the sets round-robin
+////////////////////////////////////////////////////////////////////////////////
+
+        void setProcessorAffinity (const std::vector<std::vector<size_t>>& cores);
+
 // -----------------------------------------------------------------------------
 // --SECTION--                                                   private methods
 // -----------------------------------------------------------------------------
@@ -324,10 +331,10 @@ namespace triagens {
         Dispatcher::newDispatcherThread_fptr createDispatcherThread;
 
 ////////////////////////////////////////////////////////////////////////////////
-/// @brief cores to use for affinity
+/// @brief cores to use for affinity, one set of cores per thread
 ////////////////////////////////////////////////////////////////////////////////
 
-        std::vector<size_t> _affinityCores;
+        std::vector<std::vector<size_t>> _affinityCores;
 
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief next affinity core to use
@@ -322,9 +322,12 @@ EdgeIndex::EdgeIndex (TRI_idx_iid_t iid,
   TRI_ASSERT(iid != 0);
 
   uint32_t indexBuckets = 1;
+  int numaNode = TRI_NUMA_NODE_ANY;
+
   if (collection != nullptr) {
     // document is a nullptr in the coordinator case
     indexBuckets = collection->_info._indexBuckets;
+    numaNode = collection->_numaNode;
   }
 
   auto context = [this] () -> std::string {
@@ -338,7 +341,8 @@ EdgeIndex::EdgeIndex (TRI_idx_iid_t iid,
                                        IsEqualElementEdgeFromByKey,
                                        indexBuckets, 
                                        64,
-                                       context);
+                                       context,
+                                       numaNode);
 
   _edgesTo = new TRI_EdgeIndexHash_t(HashElementKey,
                                      HashElementEdgeTo,
@@ -347,7 +351,8 @@ EdgeIndex::EdgeIndex (TRI_idx_iid_t iid,
                                      IsEqualElementEdgeToByKey,
                                      indexBuckets,
                                      64,
-                                     context);
+                                     context,
+                                     numaNode);
 }
 
 EdgeIndex::~EdgeIndex () {
@@ -28,10 +28,16 @@
 ////////////////////////////////////////////////////////////////////////////////
 
 #include "PrimaryIndex.h"
+#include "Basics/Barrier.h"
 #include "Basics/Exceptions.h"
 #include "Basics/hashes.h"
 #include "Basics/logging.h"
+#include "Basics/numa.h"
+#include "Basics/ReadLocker.h"
+#include "Basics/ThreadPool.h"
+#include "Basics/WriteLocker.h"
 #include "VocBase/document-collection.h"
+#include "VocBase/server.h"
 #include "VocBase/transaction.h"
 
 using namespace triagens::arango;
@@ -62,6 +68,28 @@ static inline bool IsDifferentHashElement (char const* key, uint64_t hash, void
   return (hash != e->_hash || strcmp(key, TRI_EXTRACT_MARKER_KEY(e)) != 0);  // ONLY IN INDEX, PROTECTED by RUNTIME
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief determine the number of buckets for the index, which is the
+/// collection's number of index buckets rounded down to a power of two
+////////////////////////////////////////////////////////////////////////////////
+
+static size_t NumberBuckets (TRI_document_collection_t const* collection) {
+  if (collection == nullptr) {
+    return 1;
+  }
+
+  size_t numberBuckets = static_cast<size_t>(collection->_info._indexBuckets);
+  size_t nr = 1;
+
+  numberBuckets >>= 1;
+  while (numberBuckets > 0) {
+    numberBuckets >>= 1;
+    nr <<= 1;
+  }
+
+  return nr;
+}
+
 // -----------------------------------------------------------------------------
 // --SECTION--                                                class PrimaryIndex
 // -----------------------------------------------------------------------------
@@ -73,22 +101,38 @@ uint64_t const PrimaryIndex::InitialSize = 251;
 // -----------------------------------------------------------------------------
 
 PrimaryIndex::PrimaryIndex (TRI_document_collection_t* collection) 
-  : Index(0, collection, std::vector<std::string>( { TRI_VOC_ATTRIBUTE_KEY } )) {
+  : Index(0, collection, std::vector<std::string>( { TRI_VOC_ATTRIBUTE_KEY } )),
+    _buckets(NumberBuckets(collection)),
+    _bucketsMask(static_cast<uint64_t>(_buckets.size() - 1)),
+    _initialSize(InitialSize),
+    _numaNode(collection == nullptr ? TRI_NUMA_NODE_ANY : collection->_numaNode) {
+
+  // all hashes in a bucket share their lower bits. bucket sizes must be odd
+  // so the slots within a bucket are still evenly distributed
+  _initialSize = (std::max)(InitialSize / static_cast<uint64_t>(_buckets.size()), static_cast<uint64_t>(7)) | 1;
+
+  for (auto& b : _buckets) {
+    b._table = static_cast<void**>(TRI_NumaAllocate(static_cast<size_t>(_initialSize * sizeof(void*)), _numaNode, true));
+
+    if (b._table == nullptr) {
+      for (auto& other : _buckets) {
+        if (other._table != nullptr) {
+          TRI_NumaFree(other._table, static_cast<size_t>(other._nrAlloc * sizeof(void*)), _numaNode);
+        }
+      }
 
-  _primaryIndex._nrAlloc = 0;
-  _primaryIndex._nrUsed  = 0;
-  _primaryIndex._table   = static_cast<void**>(TRI_Allocate(TRI_UNKNOWN_MEM_ZONE, static_cast<size_t>(InitialSize * sizeof(void*)), true));
+      THROW_ARANGO_EXCEPTION(TRI_ERROR_OUT_OF_MEMORY);
+    }
 
-  if (_primaryIndex._table == nullptr) {
-    THROW_ARANGO_EXCEPTION(TRI_ERROR_OUT_OF_MEMORY);
+    b._nrAlloc = _initialSize;
   }
-
-  _primaryIndex._nrAlloc = InitialSize;
 }
 
 PrimaryIndex::~PrimaryIndex () {
-  if (_primaryIndex._table != nullptr) {
-    TRI_Free(TRI_UNKNOWN_MEM_ZONE, _primaryIndex._table);
+  for (auto& b : _buckets) {
+    if (b._table != nullptr) {
+      TRI_NumaFree(b._table, static_cast<size_t>(b._nrAlloc * sizeof(void*)), _numaNode);
+    }
   }
 }
 
@@ -97,7 +141,7 @@ PrimaryIndex::~PrimaryIndex () {
 // -----------------------------------------------------------------------------
         
 size_t PrimaryIndex::memory () const {
-  return static_cast<size_t>(_primaryIndex._nrAlloc * sizeof(void*));
+  return static_cast<size_t>(capacity() * sizeof(void*));
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -129,13 +173,17 @@ int PrimaryIndex::remove (TRI_doc_mptr_t const*,
 ////////////////////////////////////////////////////////////////////////////////
 
 void* PrimaryIndex::lookupKey (char const* key) const {
-  if (_primaryIndex._nrUsed == 0) {
+  // compute the hash
+  uint64_t const hash = calculateHash(key);
+  Bucket const& b = bucketFor(hash);
+
+  READ_LOCKER(b._lock);
+
+  if (b._nrUsed == 0) {
     return nullptr;
   }
 
-  // compute the hash
-  uint64_t const hash = calculateHash(key);
-  uint64_t const n = _primaryIndex._nrAlloc;
+  uint64_t const n = b._nrAlloc;
   uint64_t i, k;
 
   i = k = hash % n;
@@ -143,33 +191,38 @@ void* PrimaryIndex::lookupKey (char const* key) const {
   TRI_ASSERT_EXPENSIVE(n > 0);
 
   // search the table
-  for (; i < n && _primaryIndex._table[i] != nullptr && IsDifferentHashElement(key, hash, _primaryIndex._table[i]); ++i);
+  for (; i < n && b._table[i] != nullptr && IsDifferentHashElement(key, hash, b._table[i]); ++i);
   if (i == n) {
-    for (i = 0; i < k && _primaryIndex._table[i] != nullptr && IsDifferentHashElement(key, hash, _primaryIndex._table[i]); ++i);
+    for (i = 0; i < k && b._table[i] != nullptr && IsDifferentHashElement(key, hash, b._table[i]); ++i);
   }
 
   TRI_ASSERT_EXPENSIVE(i < n);
 
   // return whatever we found
-  return _primaryIndex._table[i];
+  return b._table[i];
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief looks up an element given a key
 /// returns the index position into which a key would belong in the second
-/// parameter. sets position to UINT64_MAX if the position cannot be determined
+/// parameter. sets position to UINT64_MAX if the position cannot be determined.
+/// the position is local to the key's bucket
 ////////////////////////////////////////////////////////////////////////////////
 
 void* PrimaryIndex::lookupKey (char const* key,
                                uint64_t& position) const {
-  if (_primaryIndex._nrUsed == 0) {
+  // compute the hash
+  uint64_t const hash = calculateHash(key);
+  Bucket const& b = bucketFor(hash);
+
+  READ_LOCKER(b._lock);
+
+  if (b._nrUsed == 0) {
     position = UINT64_MAX;
     return nullptr;
   }
 
-  // compute the hash
-  uint64_t const hash = calculateHash(key);
-  uint64_t const n = _primaryIndex._nrAlloc;
+  uint64_t const n = b._nrAlloc;
   uint64_t i, k;
 
   i = k = hash % n;
@@ -177,16 +230,16 @@ void* PrimaryIndex::lookupKey (char const* key,
   TRI_ASSERT_EXPENSIVE(n > 0);
 
   // search the table
-  for (; i < n && _primaryIndex._table[i] != nullptr && IsDifferentHashElement(key, hash, _primaryIndex._table[i]); ++i);
+  for (; i < n && b._table[i] != nullptr && IsDifferentHashElement(key, hash, b._table[i]); ++i);
   if (i == n) {
-    for (i = 0; i < k && _primaryIndex._table[i] != nullptr && IsDifferentHashElement(key, hash, _primaryIndex._table[i]); ++i);
+    for (i = 0; i < k && b._table[i] != nullptr && IsDifferentHashElement(key, hash, b._table[i]); ++i);
   }
 
   TRI_ASSERT_EXPENSIVE(i < n);
   position = i;
 
   // return whatever we found
-  return _primaryIndex._table[i];
+  return b._table[i];
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -198,28 +251,32 @@ int PrimaryIndex::insertKey (TRI_doc_mptr_t const* header,
                              void const** found) {
   *found = nullptr;
 
-  if (shouldResize()) {
+  Bucket& b = bucketFor(header->_hash);
+
+  WRITE_LOCKER(b._lock);
+
+  if (shouldResize(b)) {
     // check for out-of-memory
-    if (! resize(static_cast<uint64_t>(2 * _primaryIndex._nrAlloc + 1), false)) {
+    if (! resize(b, static_cast<uint64_t>(2 * b._nrAlloc + 1), false)) {
       return TRI_ERROR_OUT_OF_MEMORY;
     }
   }
 
-  uint64_t const n = _primaryIndex._nrAlloc;
+  uint64_t const n = b._nrAlloc;
   uint64_t i, k;
 
   TRI_ASSERT_EXPENSIVE(n > 0);
 
   i = k = header->_hash % n;
 
-  for (; i < n && _primaryIndex._table[i] != nullptr && IsDifferentKeyElement(header, _primaryIndex._table[i]); ++i);
+  for (; i < n && b._table[i] != nullptr && IsDifferentKeyElement(header, b._table[i]); ++i);
   if (i == n) {
-    for (i = 0; i < k && _primaryIndex._table[i] != nullptr && IsDifferentKeyElement(header, _primaryIndex._table[i]); ++i);
+    for (i = 0; i < k && b._table[i] != nullptr && IsDifferentKeyElement(header, b._table[i]); ++i);
   }
 
   TRI_ASSERT_EXPENSIVE(i < n);
 
-  void* old = _primaryIndex._table[i];
+  void* old = b._table[i];
 
   // if we found an element, return
   if (old != nullptr) {
@@ -229,8 +286,8 @@ int PrimaryIndex::insertKey (TRI_doc_mptr_t const* header,
   }
 
   // add a new element to the associative idx
-  _primaryIndex._table[i] = (void*) header;
-  ++_primaryIndex._nrUsed;
+  b._table[i] = (void*) header;
+  ++b._nrUsed;
 
   return TRI_ERROR_NO_ERROR;
 }
@@ -242,22 +299,26 @@ int PrimaryIndex::insertKey (TRI_doc_mptr_t const* header,
 ////////////////////////////////////////////////////////////////////////////////
 
 void PrimaryIndex::insertKey (TRI_doc_mptr_t const* header) {
-  uint64_t const n = _primaryIndex._nrAlloc;
+  Bucket& b = bucketFor(header->_hash);
+
+  WRITE_LOCKER(b._lock);
+
+  uint64_t const n = b._nrAlloc;
   uint64_t i, k;
 
   i = k = header->_hash % n;
 
-  for (; i < n && _primaryIndex._table[i] != nullptr && IsDifferentKeyElement(header, _primaryIndex._table[i]); ++i);
+  for (; i < n && b._table[i] != nullptr && IsDifferentKeyElement(header, b._table[i]); ++i);
   if (i == n) {
-    for (i = 0; i < k && _primaryIndex._table[i] != nullptr && IsDifferentKeyElement(header, _primaryIndex._table[i]); ++i);
+    for (i = 0; i < k && b._table[i] != nullptr && IsDifferentKeyElement(header, b._table[i]); ++i);
   }
 
   TRI_ASSERT_EXPENSIVE(i < n);
 
-  TRI_ASSERT_EXPENSIVE(_primaryIndex._table[i] == nullptr);
+  TRI_ASSERT_EXPENSIVE(b._table[i] == nullptr);
 
-  _primaryIndex._table[i] = const_cast<void*>(static_cast<void const*>(header));
-  ++_primaryIndex._nrUsed;
+  b._table[i] = const_cast<void*>(static_cast<void const*>(header));
+  ++b._nrUsed;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -268,27 +329,31 @@ void PrimaryIndex::insertKey (TRI_doc_mptr_t const* header) {
 
 void PrimaryIndex::insertKey (TRI_doc_mptr_t const* header,
                               uint64_t slot) {
-  uint64_t const n = _primaryIndex._nrAlloc;
+  Bucket& b = bucketFor(header->_hash);
+
+  WRITE_LOCKER(b._lock);
+
+  uint64_t const n = b._nrAlloc;
   uint64_t i, k;
 
-  if (slot != UINT64_MAX) {
+  if (slot < n) {
     i = k = slot;
   }
   else {
     i = k = header->_hash % n;
   }
 
-  for (; i < n && _primaryIndex._table[i] != nullptr && IsDifferentKeyElement(header, _primaryIndex._table[i]); ++i);
+  for (; i < n && b._table[i] != nullptr && IsDifferentKeyElement(header, b._table[i]); ++i);
   if (i == n) {
-    for (i = 0; i < k && _primaryIndex._table[i] != nullptr && IsDifferentKeyElement(header, _primaryIndex._table[i]); ++i);
+    for (i = 0; i < k && b._table[i] != nullptr && IsDifferentKeyElement(header, b._table[i]); ++i);
   }
 
   TRI_ASSERT_EXPENSIVE(i < n);
 
-  TRI_ASSERT_EXPENSIVE(_primaryIndex._table[i] == nullptr);
+  TRI_ASSERT_EXPENSIVE(b._table[i] == nullptr);
 
-  _primaryIndex._table[i] = const_cast<void*>(static_cast<void const*>(header));
-  ++_primaryIndex._nrUsed;
+  b._table[i] = const_cast<void*>(static_cast<void const*>(header));
+  ++b._nrUsed;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -297,46 +362,50 @@ void PrimaryIndex::insertKey (TRI_doc_mptr_t const* header,
 
 void* PrimaryIndex::removeKey (char const* key) {
   uint64_t const hash = calculateHash(key);
-  uint64_t const n = _primaryIndex._nrAlloc;
+  Bucket& b = bucketFor(hash);
+
+  WRITE_LOCKER(b._lock);
+
+  uint64_t const n = b._nrAlloc;
   uint64_t i, k;
 
   i = k = hash % n;
 
   // search the table
-  for (; i < n && _primaryIndex._table[i] != nullptr && IsDifferentHashElement(key, hash, _primaryIndex._table[i]); ++i);
+  for (; i < n && b._table[i] != nullptr && IsDifferentHashElement(key, hash, b._table[i]); ++i);
   if (i == n) {
-    for (i = 0; i < k && _primaryIndex._table[i] != nullptr && IsDifferentHashElement(key, hash, _primaryIndex._table[i]); ++i);
+    for (i = 0; i < k && b._table[i] != nullptr && IsDifferentHashElement(key, hash, b._table[i]); ++i);
   }
 
   TRI_ASSERT_EXPENSIVE(i < n);
 
   // if we did not find such an item return false
-  if (_primaryIndex._table[i] == nullptr) {
+  if (b._table[i] == nullptr) {
     return nullptr;
   }
 
   // remove item
-  void* old = _primaryIndex._table[i];
-  _primaryIndex._table[i] = nullptr;
-  _primaryIndex._nrUsed--;
+  void* old = b._table[i];
+  b._table[i] = nullptr;
+  b._nrUsed--;
 
   // and now check the following places for items to move here
   k = TRI_IncModU64(i, n);
 
-  while (_primaryIndex._table[k] != nullptr) {
-    uint64_t j = (static_cast<TRI_doc_mptr_t const*>(_primaryIndex._table[k])->_hash) % n;
+  while (b._table[k] != nullptr) {
+    uint64_t j = (static_cast<TRI_doc_mptr_t const*>(b._table[k])->_hash) % n;
 
     if ((i < k && ! (i < j && j <= k)) || (k < i && ! (i < j || j <= k))) {
-      _primaryIndex._table[i] = _primaryIndex._table[k];
-      _primaryIndex._table[k] = nullptr;
+      b._table[i] = b._table[k];
+      b._table[k] = nullptr;
       i = k;
     }
 
     k = TRI_IncModU64(k, n);
   }
 
-  if (_primaryIndex._nrUsed == 0) {
-    resize(InitialSize, true);
+  if (b._nrUsed == 0) {
+    resize(b, _initialSize, true);
   }
 
   // return success
@@ -344,26 +413,40 @@ void* PrimaryIndex::removeKey (char const* key) {
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-/// @brief resizes the index
+/// @brief resizes the index so it can hold the specified number of documents
 ////////////////////////////////////////////////////////////////////////////////
 
 int PrimaryIndex::resize (size_t targetSize) {
-  if (! resize(static_cast<uint64_t>(2 * targetSize + 1), false)) {
-    return TRI_ERROR_OUT_OF_MEMORY;
+  // hashes are evenly distributed over the buckets. should a bucket still
+  // receive more documents than expected, it will grow on its own
+  uint64_t const perBucket = static_cast<uint64_t>(targetSize) / static_cast<uint64_t>(_buckets.size()) + 1;
+  
+  std::vector<std::pair<Bucket*, uint64_t>> work;
+  work.reserve(_buckets.size());
+
+  for (auto& b : _buckets) {
+    work.emplace_back(&b, 2 * perBucket + 1);
   }
-  return TRI_ERROR_NO_ERROR;
+
+  return resize(work);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-/// @brief resize the index to a good size if too small
+/// @brief resize all buckets to a good size if too small
 ////////////////////////////////////////////////////////////////////////////////
 
 int PrimaryIndex::resize () {
-  if (shouldResize() &&
-      ! resize(static_cast<uint64_t>(2 * _primaryIndex._nrAlloc + 1), false)) {
-    return TRI_ERROR_OUT_OF_MEMORY;
+  std::vector<std::pair<Bucket*, uint64_t>> work;
+
+  for (auto& b : _buckets) {
+    READ_LOCKER(b._lock);
+
+    if (shouldResize(b)) {
+      work.emplace_back(&b, 2 * b._nrAlloc + 1);
+    }
   }
-  return TRI_ERROR_NO_ERROR;
+
+  return resize(work);
 }
   
 uint64_t PrimaryIndex::calculateHash (char const* key) {
@@ -375,31 +458,249 @@ uint64_t PrimaryIndex::calculateHash (char const* key,
   return TRI_FnvHashPointer(static_cast<void const*>(key), length);
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief returns the number of documents in the index
+////////////////////////////////////////////////////////////////////////////////
+
+uint64_t PrimaryIndex::size () const {
+  uint64_t result = 0;
+
+  for (auto const& b : _buckets) {
+    READ_LOCKER(b._lock);
+    result += b._nrUsed;
+  }
+
+  return result;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief returns the total number of slots in the index
+////////////////////////////////////////////////////////////////////////////////
+
+uint64_t PrimaryIndex::capacity () const {
+  uint64_t result = 0;
+
+  for (auto const& b : _buckets) {
+    READ_LOCKER(b._lock);
+    result += b._nrAlloc;
+  }
+
+  return result;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief returns the element at the specified position
+////////////////////////////////////////////////////////////////////////////////
+
+TRI_doc_mptr_t* PrimaryIndex::lookupSlot (uint64_t position) const {
+  for (auto const& b : _buckets) {
+    READ_LOCKER(b._lock);
+
+    if (position < b._nrAlloc) {
+      return static_cast<TRI_doc_mptr_t*>(b._table[position]);
+    }
+
+    position -= b._nrAlloc;
+  }
+
+  return nullptr;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief returns the position of the slot at the specified offset
+////////////////////////////////////////////////////////////////////////////////
+
+PrimaryIndex::Position PrimaryIndex::position (uint64_t offset) const {
+  for (size_t i = 0; i < _buckets.size(); ++i) {
+    Bucket const& b = _buckets[i];
+    READ_LOCKER(b._lock);
+
+    if (offset < b._nrAlloc) {
+      return Position(i, offset);
+    }
+
+    offset -= b._nrAlloc;
+  }
+
+  return end();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief returns the offset of the slot at the specified position
+////////////////////////////////////////////////////////////////////////////////
+
+uint64_t PrimaryIndex::offset (Position const& position) const {
+  uint64_t result = 0;
+
+  for (size_t i = 0; i < position._bucket && i < _buckets.size(); ++i) {
+    Bucket const& b = _buckets[i];
+    READ_LOCKER(b._lock);
+    result += b._nrAlloc;
+  }
+
+  return result + position._slot;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief returns the first element at or after the specified position
+////////////////////////////////////////////////////////////////////////////////
+
+TRI_doc_mptr_t* PrimaryIndex::lookupSequential (Position& position) const {
+  while (position._bucket < _buckets.size()) {
+    Bucket const& b = _buckets[position._bucket];
+
+    {
+      READ_LOCKER(b._lock);
+
+      for (uint64_t i = position._slot; i < b._nrAlloc; ++i) {
+        if (b._table[i] != nullptr) {
+          position._slot = i + 1;
+          return static_cast<TRI_doc_mptr_t*>(b._table[i]);
+        }
+      }
+    }
+
+    // continue with the next bucket
+    ++position._bucket;
+    position._slot = 0;
+  }
+
+  return nullptr;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief appends copies of up to limit elements between the positions
+////////////////////////////////////////////////////////////////////////////////
+
+size_t PrimaryIndex::lookupSequential (Position& position,
+                                       Position const& end,
+                                       std::vector<TRI_doc_mptr_copy_t>& result,
+                                       size_t limit) const {
+  size_t found = 0;
+
+  while (found < limit &&
+         position < end &&
+         position._bucket < _buckets.size()) {
+    Bucket const& b = _buckets[position._bucket];
+
+    {
+      READ_LOCKER(b._lock);
+
+      uint64_t n = b._nrAlloc;
+
+      if (position._bucket == end._bucket && end._slot < n) {
+        n = end._slot;
+      }
+
+      uint64_t i = position._slot;
+
+      for (; i < n && found < limit; ++i) {
+        if (b._table[i] != nullptr) {
+          result.emplace_back(*static_cast<TRI_doc_mptr_t const*>(b._table[i]));
+          ++found;
+        }
+      }
+
+      position._slot = i;
+
+      if (i < b._nrAlloc || found >= limit) {
+        // stopped by the limit or the end position
+        break;
+      }
+    }
+
+    // continue with the next bucket
+    ++position._bucket;
+    position._slot = 0;
+  }
+
+  return found;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief returns the last element before the specified position
+////////////////////////////////////////////////////////////////////////////////
+
+TRI_doc_mptr_t* PrimaryIndex::lookupSequentialReverse (Position& position) const {
+  if (position._bucket >= _buckets.size()) {
+    position = Position(_buckets.size(), 0);
+  }
+
+  while (true) {
+    if (position._slot == 0) {
+      if (position._bucket == 0) {
+        return nullptr;
+      }
+
+      // continue with the end of the previous bucket
+      --position._bucket;
+      position._slot = UINT64_MAX;
+    }
+
+    Bucket const& b = _buckets[position._bucket];
+
+    READ_LOCKER(b._lock);
+
+    uint64_t i = (std::min)(position._slot, b._nrAlloc);
+
+    while (i > 0) {
+      --i;
+
+      if (b._table[i] != nullptr) {
+        position._slot = i;
+        return static_cast<TRI_doc_mptr_t*>(b._table[i]);
+      }
+    }
+
+    position._slot = 0;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief calls the callback for each element in the index
+////////////////////////////////////////////////////////////////////////////////
+
+void PrimaryIndex::invokeOnAllElements (std::function<void(TRI_doc_mptr_t*)> const& callback) const {
+  for (auto const& b : _buckets) {
+    READ_LOCKER(b._lock);
+
+    void** ptr = b._table;
+    void** end = ptr + b._nrAlloc;
+
+    for (; ptr < end; ++ptr) {
+      if (*ptr != nullptr) {
+        callback(static_cast<TRI_doc_mptr_t*>(*ptr));
+      }
+    }
+  }
+}
+
 // -----------------------------------------------------------------------------
 // --SECTION--                                                   private methods
 // -----------------------------------------------------------------------------
 
 ////////////////////////////////////////////////////////////////////////////////
-/// @brief whether or not the index must be resized
+/// @brief whether or not a bucket must be resized
 ////////////////////////////////////////////////////////////////////////////////
 
-bool PrimaryIndex::shouldResize () const {
-  return _primaryIndex._nrAlloc < _primaryIndex._nrUsed + _primaryIndex._nrUsed;
+bool PrimaryIndex::shouldResize (Bucket const& b) const {
+  return b._nrAlloc < b._nrUsed + b._nrUsed;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-/// @brief resizes the index
+/// @brief resizes a bucket. the caller must hold the bucket's write lock
 ////////////////////////////////////////////////////////////////////////////////
 
-bool PrimaryIndex::resize (uint64_t targetSize,
+bool PrimaryIndex::resize (Bucket& b,
+                           uint64_t targetSize,
                            bool allowShrink) {
   TRI_ASSERT(targetSize > 0);
 
-  if (_primaryIndex._nrAlloc >= targetSize && ! allowShrink) {
+  if (b._nrAlloc >= targetSize && ! allowShrink) {
     return true;
   }
 
-  void** oldTable = _primaryIndex._table;
+  void** oldTable = b._table;
   
   // only log performance infos for indexes with more than this number of entries
   static uint64_t const NotificationSizeThreshold = 131072; 
@@ -411,16 +712,17 @@ bool PrimaryIndex::resize (uint64_t targetSize,
                (unsigned long long) targetSize);
   }
 
-  _primaryIndex._table = static_cast<void**>(TRI_Allocate(TRI_UNKNOWN_MEM_ZONE, (size_t) (targetSize * sizeof(void*)), true));
+  size_t const tableSize = static_cast<size_t>(targetSize * sizeof(void*));
+  b._table = static_cast<void**>(TRI_NumaAllocate(tableSize, _numaNode, true));
 
-  if (_primaryIndex._table == nullptr) {
-    _primaryIndex._table = oldTable;
+  if (b._table == nullptr) {
+    b._table = oldTable;
 
     return false;
   }
 
-  if (_primaryIndex._nrUsed > 0) {
-    uint64_t const oldAlloc = _primaryIndex._nrAlloc;
+  if (b._nrUsed > 0) {
+    uint64_t const oldAlloc = b._nrAlloc;
 
     // table is already cleared by allocate, now copy old data
     for (uint64_t j = 0; j < oldAlloc; j++) {
@@ -432,20 +734,20 @@ bool PrimaryIndex::resize (uint64_t targetSize,
 
         i = k = hash % targetSize;
 
-        for (; i < targetSize && _primaryIndex._table[i] != nullptr; ++i);
+        for (; i < targetSize && b._table[i] != nullptr; ++i);
         if (i == targetSize) {
-          for (i = 0; i < k && _primaryIndex._table[i] != nullptr; ++i);
+          for (i = 0; i < k && b._table[i] != nullptr; ++i);
         }
 
         TRI_ASSERT_EXPENSIVE(i < targetSize);
 
-        _primaryIndex._table[i] = (void*) element;
+        b._table[i] = (void*) element;
       }
     }
   }
 
-  TRI_Free(TRI_UNKNOWN_MEM_ZONE, oldTable);
-  _primaryIndex._nrAlloc = targetSize;
+  TRI_NumaFree(oldTable, static_cast<size_t>(b._nrAlloc * sizeof(void*)), _numaNode);
+  b._nrAlloc = targetSize;
 
   LOG_TIMER((TRI_microtime() - start),
             "index-resize, %s, target size: %llu", 
@@ -455,6 +757,76 @@ bool PrimaryIndex::resize (uint64_t targetSize,
   return true;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief resizes the specified buckets to their target sizes. the work is
+/// distributed to the index thread pool plus the current thread
+////////////////////////////////////////////////////////////////////////////////
+
+int PrimaryIndex::resize (std::vector<std::pair<Bucket*, uint64_t>> const& work) {
+  if (work.empty()) {
+    return TRI_ERROR_NO_ERROR;
+  }
+
+  triagens::basics::ThreadPool* indexPool = nullptr;
+
+  if (_collection != nullptr &&
+      _collection->_vocbase != nullptr &&
+      _collection->_vocbase->_server != nullptr) {
+    indexPool = _collection->_vocbase->_server->_indexPool;
+  }
+
+  size_t numThreads = 0;
+
+  if (indexPool != nullptr) {
+    numThreads = (std::min)(indexPool->numThreads(), work.size() - 1);
+  }
+
+  std::atomic<size_t> next(0);
+  std::atomic<int> result(TRI_ERROR_NO_ERROR);
+
+  auto resizer = [this, &work, &next, &result] () -> void {
+    while (true) {
+      size_t const i = next++;
+
+      if (i >= work.size()) {
+        break;
+      }
+
+      Bucket& b = *work[i].first;
+
+      WRITE_LOCKER(b._lock);
+
+      if (! resize(b, work[i].second, false)) {
+        int expected = TRI_ERROR_NO_ERROR;
+        result.compare_exchange_strong(expected, TRI_ERROR_OUT_OF_MEMORY, std::memory_order_acquire);
+      }
+    }
+  };
+
+  {
+    triagens::basics::Barrier barrier(numThreads);
+
+    for (size_t i = 0; i < numThreads; ++i) {
+      try {
+        indexPool->enqueue([&resizer, &barrier] () -> void {
+          resizer();
+          barrier.join();
+        });
+      }
+      catch (...) {
+        // this thread will pick up the work
+        barrier.join();
+      }
+    }
+
+    resizer();
+
+    // barrier waits here until all threads have joined
+  }
+
+  return result.load();
+}
+
 // -----------------------------------------------------------------------------
 // --SECTION--                                                       END-OF-FILE
 // -----------------------------------------------------------------------------
@@ -31,10 +31,17 @@
 #define ARANGODB_INDEXES_PRIMARY_INDEX_H 1
 
 #include "Basics/Common.h"
+#include "Basics/ReadWriteLock.h"
 #include "Indexes/Index.h"
 #include "VocBase/vocbase.h"
 #include "VocBase/voc-types.h"
 
+// -----------------------------------------------------------------------------
+// --SECTION--                                              forward declarations
+// -----------------------------------------------------------------------------
+
+struct TRI_doc_mptr_copy_t;
+
 // -----------------------------------------------------------------------------
 // --SECTION--                                                class PrimaryIndex
 // -----------------------------------------------------------------------------
@@ -62,10 +69,57 @@ namespace triagens {
         
       public:
 
-        struct PrimaryIndexType {
+////////////////////////////////////////////////////////////////////////////////
+/// @brief a single bucket of the index. each bucket is an open-addressing
+/// hash table of its own, protected by its own read-write lock, so resizing
+/// one bucket does not block readers of the other buckets
+////////////////////////////////////////////////////////////////////////////////
+
+        struct Bucket {
+          Bucket ()
+            : _nrAlloc(0),
+              _nrUsed(0),
+              _table(nullptr),
+              _lock() {
+          }
+
           uint64_t  _nrAlloc;     // the size of the table
           uint64_t  _nrUsed;      // the number of used entries
           void**    _table;       // the table itself
+
+          mutable triagens::basics::ReadWriteLock _lock;
+        };
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief a position in the index for sequential iteration, consisting of a
+/// bucket and a slot within the bucket. a default-constructed position is
+/// the start of the index
+////////////////////////////////////////////////////////////////////////////////
+
+        struct Position {
+          Position ()
+            : _bucket(0),
+              _slot(0) {
+          }
+
+          Position (size_t bucket,
+                    uint64_t slot)
+            : _bucket(bucket),
+              _slot(slot) {
+          }
+
+          void reset () {
+            _bucket = 0;
+            _slot = 0;
+          }
+
+          bool operator< (Position const& other) const {
+            return _bucket < other._bucket ||
+                   (_bucket == other._bucket && _slot < other._slot);
+          }
+
+          size_t   _bucket;
+          uint64_t _slot;
         };
 
 // -----------------------------------------------------------------------------
@@ -121,16 +175,97 @@ namespace triagens {
 
         void* removeKey (char const*);
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief resizes the index so it can hold the specified number of documents
+/// the buckets are resized in parallel if an index thread pool is available
+////////////////////////////////////////////////////////////////////////////////
+
         int resize (size_t);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief resizes all buckets that are too small. the buckets are resized in
+/// parallel if an index thread pool is available
+////////////////////////////////////////////////////////////////////////////////
+
         int resize ();
 
         static uint64_t calculateHash (char const*); 
         
         static uint64_t calculateHash (char const*, size_t);
-        
-        PrimaryIndexType* internals () {
-          return &_primaryIndex;
-        } 
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief returns the number of documents in the index
+////////////////////////////////////////////////////////////////////////////////
+
+        uint64_t size () const;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief returns the total number of slots in the index. the offsets used in
+/// lookupSlot and position() are in the range [0, capacity())
+////////////////////////////////////////////////////////////////////////////////
+
+        uint64_t capacity () const;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief returns the element at the specified offset, or a nullptr if
+/// the slot is empty
+////////////////////////////////////////////////////////////////////////////////
+
+        struct TRI_doc_mptr_t* lookupSlot (uint64_t) const;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief returns the position of the slot at the specified offset
+////////////////////////////////////////////////////////////////////////////////
+
+        Position position (uint64_t) const;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief returns the offset of the slot at the specified position
+////////////////////////////////////////////////////////////////////////////////
+
+        uint64_t offset (Position const&) const;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief returns the position behind the last slot of the index
+////////////////////////////////////////////////////////////////////////////////
+
+        Position end () const {
+          return Position(_buckets.size(), 0);
+        }
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief returns the first element at or after the specified position and
+/// sets the position to the slot following the element. returns a nullptr
+/// if there are no more elements
+////////////////////////////////////////////////////////////////////////////////
+
+        struct TRI_doc_mptr_t* lookupSequential (Position&) const;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief appends copies of up to limit elements at or after the specified
+/// position and before the end position to the result, and sets the position
+/// to the slot following the last element. each bucket is locked once while
+/// it is visited. returns the number of elements appended
+////////////////////////////////////////////////////////////////////////////////
+
+        size_t lookupSequential (Position&,
+                                 Position const&,
+                                 std::vector<TRI_doc_mptr_copy_t>&,
+                                 size_t) const;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief returns the last element before the specified position and sets
+/// the position to the slot of the element. returns a nullptr if there are no
+/// more elements
+////////////////////////////////////////////////////////////////////////////////
+
+        struct TRI_doc_mptr_t* lookupSequentialReverse (Position&) const;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief calls the callback for each element in the index, in slot order
+////////////////////////////////////////////////////////////////////////////////
+
+        void invokeOnAllElements (std::function<void(struct TRI_doc_mptr_t*)> const&) const;
 
 // -----------------------------------------------------------------------------
 // --SECTION--                                                   private methods
@@ -138,9 +273,19 @@ namespace triagens {
 
       private:
 
-        bool shouldResize () const;
+        Bucket& bucketFor (uint64_t hash) {
+          return _buckets[static_cast<size_t>(hash & _bucketsMask)];
+        }
+
+        Bucket const& bucketFor (uint64_t hash) const {
+          return _buckets[static_cast<size_t>(hash & _bucketsMask)];
+        }
+
+        bool shouldResize (Bucket const&) const;
+
+        bool resize (Bucket&, uint64_t, bool);
 
-        bool resize (uint64_t, bool);
+        int resize (std::vector<std::pair<Bucket*, uint64_t>> const&);
 
 // -----------------------------------------------------------------------------
 // --SECTION--                                                 private variables
@@ -149,13 +294,32 @@ namespace triagens {
       private:
 
 ////////////////////////////////////////////////////////////////////////////////
-/// @brief the actual index
+/// @brief the buckets of the index. the bucket of an element is determined
+/// by the lower bits of its hash value
+////////////////////////////////////////////////////////////////////////////////
+
+        std::vector<Bucket> _buckets;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief bit mask for determining the bucket of a hash value
+////////////////////////////////////////////////////////////////////////////////
+
+        uint64_t _bucketsMask;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief initial size of each bucket
+////////////////////////////////////////////////////////////////////////////////
+
+        uint64_t _initialSize;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief NUMA node the bucket tables are placed on
 ////////////////////////////////////////////////////////////////////////////////
 
-        PrimaryIndexType _primaryIndex;
+        int const _numaNode;
 
 ////////////////////////////////////////////////////////////////////////////////
-/// @brief associative array of pointers
+/// @brief initial size of the whole index
 ////////////////////////////////////////////////////////////////////////////////
 
         static uint64_t const InitialSize;
@@ -133,6 +133,11 @@ void RestCursorHandler::processQuery (TRI_json_t const* json) {
   
   auto options = buildOptions(json);
 
+  if (triagens::basics::JsonHelper::getBooleanValue(options.json(), "stream", false)) {
+    processStreamingQuery(queryString, bindVars, options);
+    return;
+  }
+
   triagens::aql::Query query(_applicationV8, 
                              false, 
                              _vocbase, 
@@ -162,7 +167,7 @@ void RestCursorHandler::processQuery (TRI_json_t const* json) {
     _response->setContentType("application/json; charset=utf-8");
 
     // build "extra" attribute
-    triagens::basics::Json extra(triagens::basics::Json::Object, 3); 
+    triagens::basics::Json extra(triagens::basics::Json::Object, 4); 
 
     if (queryResult.stats != nullptr) {
       extra.set("stats", triagens::basics::Json(TRI_UNKNOWN_MEM_ZONE, queryResult.stats, triagens::basics::Json::AUTOFREE));
@@ -172,6 +177,10 @@ void RestCursorHandler::processQuery (TRI_json_t const* json) {
       extra.set("profile", triagens::basics::Json(TRI_UNKNOWN_MEM_ZONE, queryResult.profile, triagens::basics::Json::AUTOFREE));
       queryResult.profile = nullptr;
     }
+    if (queryResult.plan != nullptr) {
+      extra.set("plan", triagens::basics::Json(TRI_UNKNOWN_MEM_ZONE, queryResult.plan, triagens::basics::Json::AUTOFREE));
+      queryResult.plan = nullptr;
+    }
     if (queryResult.warnings == nullptr) {
       extra.set("warnings", triagens::basics::Json(triagens::basics::Json::Array));
     }
@@ -238,6 +247,79 @@ void RestCursorHandler::processQuery (TRI_json_t const* json) {
 // --SECTION--                                                   private methods
 // -----------------------------------------------------------------------------
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief prepares the query and returns the first results from a streaming
+/// cursor
+////////////////////////////////////////////////////////////////////////////////
+
+void RestCursorHandler::processStreamingQuery (TRI_json_t const* queryString,
+                                               TRI_json_t const* bindVars,
+                                               triagens::basics::Json const& options) {
+  if (triagens::basics::JsonHelper::getBooleanValue(options.json(), "count", false)) {
+    THROW_ARANGO_EXCEPTION_MESSAGE(TRI_ERROR_BAD_PARAMETER, "<count> is not supported for streaming cursors");
+  }
+
+  std::unique_ptr<triagens::aql::Query> query(new triagens::aql::Query(
+    _applicationV8, 
+    false, 
+    _vocbase, 
+    queryString->_value._string.data,
+    static_cast<size_t>(queryString->_value._string.length - 1),
+    (bindVars != nullptr ? TRI_CopyJson(TRI_UNKNOWN_MEM_ZONE, bindVars) : nullptr),
+    TRI_CopyJson(TRI_UNKNOWN_MEM_ZONE, options.json()), 
+    triagens::aql::PART_MAIN
+  ));
+
+  registerQuery(query.get()); 
+  auto queryResult = query->prepare(_queryRegistry);
+
+  if (queryResult.code != TRI_ERROR_NO_ERROR) {
+    unregisterQuery(); 
+
+    if (queryResult.code == TRI_ERROR_REQUEST_CANCELED ||
+        (queryResult.code == TRI_ERROR_QUERY_KILLED && wasCancelled())) {
+      THROW_ARANGO_EXCEPTION(TRI_ERROR_REQUEST_CANCELED);
+    }
+
+    THROW_ARANGO_EXCEPTION_MESSAGE(queryResult.code, queryResult.details);
+  }
+
+  auto cursors = static_cast<triagens::arango::CursorRepository*>(_vocbase->_cursorRepository);
+  TRI_ASSERT(cursors != nullptr);
+
+  size_t batchSize = triagens::basics::JsonHelper::getNumericValue<size_t>(options.json(), "batchSize", 1000);
+  double ttl = triagens::basics::JsonHelper::getNumericValue<double>(options.json(), "ttl", 30);
+
+  // the cursor takes over the ownership of the query. the query stays 
+  // registered while the first batch is produced, so it can be cancelled
+  triagens::arango::QueryStreamCursor* cursor = cursors->createFromQuery(query.release(), batchSize, ttl);
+
+  try {
+    _response = createResponse(HttpResponse::CREATED);
+    _response->setContentType("application/json; charset=utf-8");
+
+    _response->body().appendChar('{');
+    cursor->dump(_response->body());
+    _response->body().appendText(",\"error\":false,\"code\":");
+    _response->body().appendInteger(static_cast<uint32_t>(_response->responseCode()));
+    _response->body().appendChar('}');
+
+    unregisterQuery(); 
+    cursors->release(cursor);
+  }
+  catch (...) {
+    bool const cancelled = wasCancelled();
+
+    unregisterQuery(); 
+    cursors->release(cursor);
+
+    if (cancelled) {
+      THROW_ARANGO_EXCEPTION(TRI_ERROR_REQUEST_CANCELED);
+    }
+    throw;
+  }
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief register the currently running query
 ////////////////////////////////////////////////////////////////////////////////
@@ -367,6 +449,10 @@ triagens::basics::Json RestCursorHandler::buildExtra (triagens::aql::QueryResult
     extra.set("profile", triagens::basics::Json(TRI_UNKNOWN_MEM_ZONE, queryResult.profile, triagens::basics::Json::AUTOFREE));
     queryResult.profile = nullptr;
   }
+  if (queryResult.plan != nullptr) {
+    extra.set("plan", triagens::basics::Json(TRI_UNKNOWN_MEM_ZONE, queryResult.plan, triagens::basics::Json::AUTOFREE));
+    queryResult.plan = nullptr;
+  }
   if (queryResult.warnings == nullptr) {
     extra.set("warnings", triagens::basics::Json(triagens::basics::Json::Array));
   }
@@ -444,7 +530,27 @@ triagens::basics::Json RestCursorHandler::buildExtra (triagens::aql::QueryResult
 ///
 /// - *profile*: if set to *true*, then the additional query profiling information
 ///   will be returned in the *extra.stats* return attribute if the query result is not
-///   served from the query cache.
+///   served from the query cache. Additionally, the execution plan of the query will
+///   be returned in the *extra.plan* attribute. Each node of this plan contains a
+///   *profile* sub-attribute with the number of calls made to the node (*calls*),
+///   the number of documents the node consumed (*itemsIn*) and produced (*itemsOut*),
+///   an estimate of the memory used for the produced documents in bytes (*memory*)
+///   and the time spent in the node and its dependencies in seconds (*runtime*).
+///
+/// - *sortMemoryLimit*: maximum number of bytes a *SORT* operation may use for
+///   buffering its input. If the limit is exceeded, the sort will write already
+///   sorted runs to temporary files and merge them when producing its result.
+///   The default value is *0*, meaning no limit.
+///
+/// - *stream*: if set to *true*, the query is not executed completely upfront.
+///   Instead, the server keeps the query and its transaction open and produces
+///   each batch of results only when it is requested. This reduces the memory
+///   usage and the time until the first results are returned for queries with
+///   big results. The query's collections stay locked until the cursor is
+///   exhausted, deleted or expires, so streaming cursors should be fetched
+///   promptly. Streaming cursors do not support the *count* attribute, do not
+///   use the query cache, and return the *extra* attribute with the last batch
+///   only.
 ///
 /// If the result set can be created by the server, the server will respond with
 /// *HTTP 201*. The body of the response will contain a JSON object with the
@@ -880,6 +986,14 @@ void RestCursorHandler::modifyCursor () {
     return;
   }
 
+  // a streaming cursor executes its query while producing the batch, so
+  // make the query cancelable
+  auto streamCursor = dynamic_cast<triagens::arango::QueryStreamCursor*>(cursor);
+
+  if (streamCursor != nullptr) {
+    registerQuery(streamCursor->query());
+  }
+
   try {
     _response = createResponse(HttpResponse::OK);
     _response->setContentType("application/json; charset=utf-8");
@@ -890,14 +1004,17 @@ void RestCursorHandler::modifyCursor () {
     _response->body().appendInteger(static_cast<uint32_t>(_response->responseCode()));
     _response->body().appendChar('}');
 
+    unregisterQuery();
     cursors->release(cursor);
   }
   catch (triagens::basics::Exception const& ex) {
+    unregisterQuery();
     cursors->release(cursor);
 
     generateError(HttpResponse::responseCode(ex.code()), ex.code(), ex.what());
   }
   catch (...) {
+    unregisterQuery();
     cursors->release(cursor);
 
     generateError(HttpResponse::SERVER_ERROR, TRI_ERROR_INTERNAL);
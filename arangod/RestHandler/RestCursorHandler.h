@@ -107,6 +107,15 @@ namespace triagens {
 
       private:
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief prepares the query and returns the first results from a streaming
+/// cursor
+////////////////////////////////////////////////////////////////////////////////
+
+        void processStreamingQuery (struct TRI_json_t const*,
+                                    struct TRI_json_t const*,
+                                    triagens::basics::Json const&);
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief register the currently running query
 ////////////////////////////////////////////////////////////////////////////////
@@ -37,6 +37,7 @@
 #include "Admin/ApplicationAdminServer.h"
 #include "Admin/RestHandlerCreator.h"
 #include "Admin/RestShutdownHandler.h"
+#include "Aql/PlanCache.h"
 #include "Aql/Query.h"
 #include "Aql/QueryCache.h"
 #include "Aql/RestAqlHandler.h"
@@ -45,11 +46,13 @@
 #include "Basics/ProgramOptions.h"
 #include "Basics/ProgramOptionsDescription.h"
 #include "Basics/RandomGenerator.h"
+#include "Basics/RateLimiter.h"
 #include "Basics/Utf8Helper.h"
 #include "Basics/files.h"
 #include "Basics/init.h"
 #include "Basics/logging.h"
 #include "Basics/messages.h"
+#include "Basics/numa.h"
 #include "Basics/ThreadPool.h"
 #include "Basics/tri-strings.h"
 #include "Cluster/ApplicationCluster.h"
@@ -85,6 +88,7 @@
 #include "V8/v8-utils.h"
 #include "V8Server/ApplicationV8.h"
 #include "VocBase/auth.h"
+#include "VocBase/compressed-json.h"
 #include "VocBase/server.h"
 #include "Wal/LogfileManager.h"
 
@@ -345,9 +349,15 @@ ArangoServer::ArangoServer (int argc, char** argv)
     _dispatcherQueueSize(16384),
     _v8Contexts(8),
     _indexThreads(2),
+    _compactorThreads(2),
+    _compactorMaxWriteRate(0),
+    _compressedCacheSize(TRI_COMPRESSED_JSON_DEFAULT_CACHE_SIZE),
+    _indexSnapshots(false),
     _databasePath(),
     _queryCacheMode("off"),
     _queryCacheMaxResults(128),
+    _queryPlanCacheSize(0),
+    _queryScanThreads(4),
     _defaultMaximalSize(TRI_JOURNAL_DEFAULT_MAXIMAL_SIZE),
     _defaultWaitForSync(false),
     _forceSyncProperties(true),
@@ -357,10 +367,13 @@ ArangoServer::ArangoServer (int argc, char** argv)
     _throwCollectionNotLoadedError(false),
     _foxxQueues(true),
     _foxxQueuesPollInterval(1.0),
+    _numaAwareAllocation(false),
     _server(nullptr),
     _queryRegistry(nullptr),
     _pairForAql(nullptr),
     _indexPool(nullptr),
+    _compactorPool(nullptr),
+    _compactorRateLimiter(nullptr),
     _threadAffinity(0) {
 
   TRI_SetApplicationName("arangod");
@@ -390,6 +403,8 @@ ArangoServer::ArangoServer (int argc, char** argv)
 
 ArangoServer::~ArangoServer () {
   delete _indexPool;
+  delete _compactorPool;
+  delete _compactorRateLimiter;
   delete _jobManager;
   delete _server;
 
@@ -524,7 +539,7 @@ void ArangoServer::buildApplicationServer () {
     ("no-upgrade", "skip a database upgrade")
     ("start-service", "used to start as windows service")
     ("no-server", "do not start the server, if console is requested")
-    ("use-thread-affinity", &_threadAffinity, "try to set thread affinity (0=disable, 1=disjunct, 2=overlap, 3=scheduler, 4=dispatcher)")
+    ("use-thread-affinity", &_threadAffinity, "try to set thread affinity (0=disable, 1=disjunct, 2=overlap, 3=scheduler, 4=dispatcher, 5=numa)")
   ;
 
   // .............................................................................
@@ -576,7 +591,13 @@ void ArangoServer::buildApplicationServer () {
     ("database.disable-query-tracking", &_disableQueryTracking, "turn off AQL query tracking by default")
     ("database.query-cache-mode", &_queryCacheMode, "mode for the AQL query cache (on, off, demand)")
     ("database.query-cache-max-results", &_queryCacheMaxResults, "maximum number of results in query cache per database")
+    ("database.query-plan-cache-size", &_queryPlanCacheSize, "maximum number of execution plans in plan cache per database (0 = off)")
+    ("database.query-scan-threads", &_queryScanThreads, "maximum number of threads for scanning a collection in an AQL query")
     ("database.index-threads", &_indexThreads, "threads to start for parallel background index creation")
+    ("database.compactor-threads", &_compactorThreads, "threads to start for compacting collections in parallel")
+    ("database.compactor-max-write-rate", &_compactorMaxWriteRate, "maximum number of bytes per second written by compaction (0 = unlimited)")
+    ("database.compressed-cache-size", &_compressedCacheSize, "maximum number of bytes per thread for caching uncompressed document bodies")
+    ("database.index-snapshots", &_indexSnapshots, "write primary index snapshots on collection unload and use them when loading the collection")
     ("database.throw-collection-not-loaded-error", &_throwCollectionNotLoadedError, "throw an error when accessing a collection that is still loading")
   ;
 
@@ -607,6 +628,7 @@ void ArangoServer::buildApplicationServer () {
     ("server.foxx-queues", &_foxxQueues, "enable Foxx queues")
     ("server.foxx-queues-poll-interval", &_foxxQueuesPollInterval, "Foxx queue manager poll interval (in seconds)")
     ("server.session-timeout", &VocbaseContext::ServerSessionTtl, "timeout of web interface server sessions (in seconds)")
+    ("server.numa-aware-allocation", &_numaAwareAllocation, "distribute the in-memory structures of collections over the NUMA nodes")
   ;
 
   bool disableStatistics = false;
@@ -727,12 +749,21 @@ void ArangoServer::buildApplicationServer () {
   // set global query tracking flag
   triagens::aql::Query::DisableQueryTracking(_disableQueryTracking);
 
+  // set the maximum number of threads for parallel collection scans
+  triagens::aql::Query::SetMaxScanThreads(static_cast<size_t>(_queryScanThreads));
+
+  // set the size of the caches for uncompressed document bodies
+  TRI_SetCompressedJsonCacheSize(_compressedCacheSize);
+
   // configure the query cache
   {
     std::pair<std::string, size_t> cacheProperties{ _queryCacheMode, _queryCacheMaxResults };
     triagens::aql::QueryCache::instance()->setProperties(cacheProperties);
   }
 
+  // configure the plan cache
+  triagens::aql::PlanCache::instance()->setMaxEntries(static_cast<size_t>(_queryPlanCacheSize));
+
   // .............................................................................
   // now run arangod
   // .............................................................................
@@ -789,6 +820,14 @@ void ArangoServer::buildApplicationServer () {
       _indexThreads = 128;
     }
   }
+
+  if (_compactorThreads < 0) {
+    _compactorThreads = 0;
+  }
+  else if (_compactorThreads > 64) {
+    // some arbitrary limit
+    _compactorThreads = 64;
+  }
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -845,6 +884,16 @@ int ArangoServer::startupServer () {
 
   startupProgress();
 
+  if (_numaAwareAllocation) {
+    size_t const numaNodes = TRI_NumberNumaNodes();
+
+    if (numaNodes > 1) {
+      LOG_INFO("distributing collection memory over %d NUMA nodes", (int) numaNodes);
+    }
+
+    TRI_SetNumaAwareAllocation(true);
+  }
+
   // open all databases
   bool const iterateMarkersOnOpen = ! wal::LogfileManager::instance()->hasFoundLastTick();
 
@@ -1056,24 +1105,54 @@ int ArangoServer::startupServer () {
 
         break;
 
+      case 5:
+        // the threads are bound to the NUMA nodes round-robin. on machines
+        // with a single node, this is the same as overlap
+        if (n < ns) {
+          ns = n;
+        }
+
+        if (n < nd) {
+          nd = n;
+        }
+
+        break;
+
       default:
         _threadAffinity = 0;
         break;
     }
 
-    if (_threadAffinity > 0) {
+    if (_threadAffinity == 5 && TRI_NumberNumaNodes() > 1) {
+      // bind the threads to the NUMA nodes instead of single cores, so the
+      // kernel can still balance them among the cores of a node, and their
+      // memory is allocated on the node they run on
+      _applicationScheduler->setNumaAffinity();
+      _applicationDispatcher->setNumaAffinity();
+
+      LOG_INFO("scheduler and dispatcher threads are distributed over %d NUMA nodes",
+               (int) TRI_NumberNumaNodes());
+    }
+    else if (_threadAffinity > 0) {
       TRI_ASSERT(ns <= n);
       TRI_ASSERT(nd <= n);
 
       vector<size_t> ps;
       vector<size_t> pd;
 
+      // processor numbers in the order in which they are handed out
+      vector<size_t> processors;
+
+      for (size_t i = 0;  i < n;  ++i) {
+        processors.push_back(i);
+      }
+
       for (size_t i = 0;  i < ns;  ++i) {
-        ps.push_back(i);
+        ps.push_back(processors[i]);
       }
 
       for (size_t i = 0;  i < nd;  ++i) {
-        pd.push_back(n - i - 1);
+        pd.push_back(processors[n - i - 1]);
       }
 
       if (0 < ns) {
@@ -1410,14 +1489,23 @@ void ArangoServer::openDatabases (bool checkVersion,
     _indexPool = new triagens::basics::ThreadPool(_indexThreads, "IndexBuilder");
   }
 
+  if (_compactorThreads > 0) {
+    _compactorPool = new triagens::basics::ThreadPool(_compactorThreads, "Compactor");
+  }
+
+  _compactorRateLimiter = new triagens::basics::RateLimiter(_compactorMaxWriteRate);
+
   int res = TRI_InitServer(_server,
                            _applicationEndpointServer,
                            _indexPool,
+                           _compactorPool,
+                           _compactorRateLimiter,
                            _databasePath.c_str(),
                            _applicationV8->appPath().c_str(),
                            &defaults,
                            _disableReplicationApplier,
-                           iterateMarkersOnOpen);
+                           iterateMarkersOnOpen,
+                           _indexSnapshots);
 
   if (res != TRI_ERROR_NO_ERROR) {
     LOG_FATAL_AND_EXIT("cannot create server instance: out of memory");
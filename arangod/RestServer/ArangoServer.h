@@ -52,6 +52,7 @@ struct TRI_vocbase_defaults_s;
 
 namespace triagens {
   namespace basics {
+    class RateLimiter;
     class ThreadPool;
   }
 
@@ -375,6 +376,76 @@ namespace triagens {
 
         int _indexThreads;
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief number of threads for compacting collections
+/// @startDocuBlock compactorThreads
+/// `--database.compactor-threads`
+///
+/// Specifies the *number* of threads that compact the datafiles of 
+/// collections. The compactor threads are shared among all databases. Each
+/// database's compactor checks its collections periodically and hands the
+/// collections that are eligible for compaction to the compactor threads.
+/// These compact the collections of all databases in the order of their
+/// share of dead data, starting with the highest.
+/// Collections of the same or of different databases are thus compacted in
+/// parallel, while the total number of concurrent compactions on the server 
+/// is limited by the number of compactor threads.
+/// Specifying a value of *0* will make each database's compactor compact its
+/// collections one after the other.
+/// @endDocuBlock
+////////////////////////////////////////////////////////////////////////////////
+
+        int _compactorThreads;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief maximum write rate for compaction
+/// @startDocuBlock compactorMaxWriteRate
+/// `--database.compactor-max-write-rate`
+///
+/// Limits the number of bytes per second that all compactions on the server
+/// together will write into compacted datafiles. Throttling the compaction
+/// will make it take longer, but reduces the disk I/O that competes with
+/// regular operations. Specifying a value of *0* turns off throttling, which
+/// is the default.
+/// @endDocuBlock
+////////////////////////////////////////////////////////////////////////////////
+
+        uint64_t _compactorMaxWriteRate;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief cache size for uncompressed document bodies
+/// @startDocuBlock compressedCacheSize
+/// `--database.compressed-cache-size`
+///
+/// Maximal number of bytes each thread uses to cache the uncompressed bodies
+/// of documents stored with *compressDocuments*. When the cache is full, the
+/// bodies that were not accessed for the longest time are freed. The default
+/// is *8 MB*.
+/// @endDocuBlock
+////////////////////////////////////////////////////////////////////////////////
+
+        uint64_t _compressedCacheSize;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief whether or not to use index snapshots
+/// @startDocuBlock indexSnapshots
+/// `--database.index-snapshots`
+///
+/// If *true*, the server writes a snapshot of a collection's primary index
+/// into the collection directory when the collection is unloaded or the
+/// server is shut down cleanly. The next load of the collection will use the
+/// snapshot instead of scanning all datafiles to rebuild the primary index.
+/// Secondary indexes are still rebuilt from the primary index.
+///
+/// A snapshot is only written if all write-ahead log entries of the
+/// collection have been transferred into its datafiles. It is removed
+/// whenever the collection is loaded, and it is ignored if the collection's
+/// datafiles do not match the snapshot anymore. The default is *false*.
+/// @endDocuBlock
+////////////////////////////////////////////////////////////////////////////////
+
+        bool _indexSnapshots;
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief path to the database
 /// @startDocuBlock DatabaseDirectory
@@ -439,6 +510,47 @@ namespace triagens {
 
         uint64_t _queryCacheMaxResults;
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief maximum number of execution plans in the plan cache per database
+/// @startDocuBlock queryPlanCacheSize
+/// `--database.query-plan-cache-size`
+///
+/// Maximum number of optimized execution plans that are kept per database.
+/// If a query is executed again with the same bind parameter values and 
+/// options, its plan is taken from the cache and the query is neither parsed
+/// nor optimized again. Cached plans are discarded when an index is created
+/// or dropped for one of the query's collections, or when one of the 
+/// collections is renamed or dropped. If the cache is full, the oldest plan
+/// is removed from it.
+///
+/// Queries can bypass the plan cache by setting the *planCache* option to 
+/// *false*.
+///
+/// The default is *0*, which turns off the plan cache.
+/// @endDocuBlock
+////////////////////////////////////////////////////////////////////////////////
+
+        uint64_t _queryPlanCacheSize;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief maximum number of threads for scanning a collection in AQL queries
+/// @startDocuBlock queryScanThreads
+/// `--database.query-scan-threads`
+///
+/// Maximum number of threads a single AQL query may use to scan a large
+/// collection in parallel. The scan is split into partitions of the
+/// collection, and the filters and calculations following the scan are
+/// executed by the threads as well. Queries can lower the number of threads
+/// with the *scanThreads* option.
+///
+/// Setting this option to *1* or *0* turns off parallel collection scans.
+///
+/// The default is *4*.
+/// @endDocuBlock
+////////////////////////////////////////////////////////////////////////////////
+
+        uint64_t _queryScanThreads;
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @startDocuBlock databaseMaximalJournalSize
 /// 
@@ -622,6 +734,26 @@ namespace triagens {
 
         double _foxxQueuesPollInterval;
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief NUMA-aware allocation of collection structures
+/// @startDocuBlock numaAwareAllocation
+/// `--server.numa-aware-allocation flag`
+///
+/// If *true*, the in-memory structures of each collection (document headers,
+/// primary index and edge index) are placed on a single NUMA node. The
+/// collections are distributed round-robin over the NUMA nodes of the machine.
+/// Otherwise the memory is placed on whichever node first touches it.
+///
+/// The option has no effect on machines with a single NUMA node. It works best
+/// when combined with `--use-thread-affinity 5`, which binds the scheduler and
+/// dispatcher threads to the NUMA nodes round-robin.
+///
+/// The default is *false*.
+/// @endDocuBlock
+////////////////////////////////////////////////////////////////////////////////
+
+        bool _numaAwareAllocation;
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief unit tests
 ///
@@ -703,6 +835,18 @@ namespace triagens {
 
         triagens::basics::ThreadPool* _indexPool;
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief thread pool for compacting collections
+////////////////////////////////////////////////////////////////////////////////
+
+        triagens::basics::ThreadPool* _compactorPool;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief write rate limiter for compaction
+////////////////////////////////////////////////////////////////////////////////
+
+        triagens::basics::RateLimiter* _compactorRateLimiter;
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief use thread affinity
 ////////////////////////////////////////////////////////////////////////////////
@@ -36,6 +36,7 @@
 
 #include "Basics/Exceptions.h"
 #include "Basics/logging.h"
+#include "Basics/numa.h"
 #include "Basics/process-utils.h"
 #include "Scheduler/PeriodicTask.h"
 #include "Scheduler/SchedulerLibev.h"
@@ -418,6 +419,24 @@ void ApplicationScheduler::setProcessorAffinity (std::vector<size_t> const& core
 #endif
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief binds the threads to the NUMA nodes round-robin
+////////////////////////////////////////////////////////////////////////////////
+
+void ApplicationScheduler::setNumaAffinity () {
+#ifdef TRI_HAVE_THREAD_AFFINITY
+  size_t const n = TRI_NumberNumaNodes();
+
+  for (uint32_t i = 0;  i < _nrSchedulerThreads;  ++i) {
+    size_t const node = i % n;
+
+    LOG_DEBUG("using NUMA node %d for scheduler thread %d", (int) node, (int) i);
+
+    _scheduler->setProcessorAffinity(i, TRI_NumaNodeProcessors(node));
+  }
+#endif
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief disables CTRL-C handling (because taken over by console input)
 ////////////////////////////////////////////////////////////////////////////////
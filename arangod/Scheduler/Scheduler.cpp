@@ -438,6 +438,16 @@ void Scheduler::setProcessorAffinity (size_t i, size_t c) {
   threads[i]->setProcessorAffinity(c);
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief sets the process affinity to a set of cores
+////////////////////////////////////////////////////////////////////////////////
+
+void Scheduler::setProcessorAffinity (size_t i, std::vector<size_t> const& cores) {
+  MUTEX_LOCKER(schedulerLock);
+
+  threads[i]->setProcessorAffinity(cores);
+}
+
 // -----------------------------------------------------------------------------
 // --SECTION--                                                   private methods
 // -----------------------------------------------------------------------------
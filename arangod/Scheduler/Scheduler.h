@@ -233,6 +233,12 @@ namespace triagens {
 
        void setProcessorAffinity (size_t i, size_t c);
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief sets the process affinity to a set of cores
+////////////////////////////////////////////////////////////////////////////////
+
+       void setProcessorAffinity (size_t i, std::vector<size_t> const& cores);
+
 // -----------------------------------------------------------------------------
 // --SECTION--                                            virtual public methods
 // -----------------------------------------------------------------------------
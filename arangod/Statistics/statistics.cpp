@@ -286,6 +286,46 @@ void TRI_FillConnectionStatistics (StatisticsCounter& httpConnections,
   connectionTime  = *TRI_ConnectionTimeDistributionStatistics;
 }
 
+// -----------------------------------------------------------------------------
+// --SECTION--                                  private WAL statistics variables
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief lock for WAL data
+////////////////////////////////////////////////////////////////////////////////
+
+static triagens::basics::Mutex WalDataLock;
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                   public WAL statistics functions
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief adds the time a commit with waitForSync waited for its sync
+////////////////////////////////////////////////////////////////////////////////
+
+void TRI_AddWalSyncTimeStatistics (double syncTime) {
+  if (! TRI_ENABLE_STATISTICS || TRI_WalSyncTimeDistributionStatistics == nullptr) {
+    return;
+  }
+
+  MUTEX_LOCKER(WalDataLock);
+
+  TRI_WalSyncTimeDistributionStatistics->addFigure(syncTime);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief fills the current statistics
+////////////////////////////////////////////////////////////////////////////////
+
+void TRI_FillWalStatistics (StatisticsDistribution& syncTime) {
+  MUTEX_LOCKER(WalDataLock);
+
+  if (TRI_WalSyncTimeDistributionStatistics != nullptr) {
+    syncTime = *TRI_WalSyncTimeDistributionStatistics;
+  }
+}
+
 // -----------------------------------------------------------------------------
 // --SECTION--                                public server statistics functions
 // -----------------------------------------------------------------------------
@@ -472,6 +512,18 @@ StatisticsVector TRI_BytesReceivedDistributionVectorStatistics;
 
 StatisticsDistribution* TRI_BytesReceivedDistributionStatistics;
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief WAL sync time distribution vector
+////////////////////////////////////////////////////////////////////////////////
+
+StatisticsVector TRI_WalSyncTimeDistributionVectorStatistics;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief WAL sync time distribution
+////////////////////////////////////////////////////////////////////////////////
+
+StatisticsDistribution* TRI_WalSyncTimeDistributionStatistics = nullptr;
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief global server statistics
 ////////////////////////////////////////////////////////////////////////////////
@@ -510,6 +562,7 @@ void TRI_InitialiseStatistics () {
   TRI_BytesSentDistributionVectorStatistics << (250) << (1000) << (2 * 1000) << (5 * 1000) << (10 * 1000);
   TRI_BytesReceivedDistributionVectorStatistics << (250) << (1000) << (2 * 1000) << (5 * 1000) << (10 * 1000);
   TRI_RequestTimeDistributionVectorStatistics << (0.01) << (0.05) << (0.1) << (0.2) << (0.5) << (1.0);
+  TRI_WalSyncTimeDistributionVectorStatistics << (0.0005) << (0.001) << (0.005) << (0.01) << (0.05) << (0.1);
 
   TRI_ConnectionTimeDistributionStatistics = new StatisticsDistribution(TRI_ConnectionTimeDistributionVectorStatistics);
   TRI_TotalTimeDistributionStatistics = new StatisticsDistribution(TRI_RequestTimeDistributionVectorStatistics);
@@ -518,6 +571,7 @@ void TRI_InitialiseStatistics () {
   TRI_IoTimeDistributionStatistics = new StatisticsDistribution(TRI_RequestTimeDistributionVectorStatistics);
   TRI_BytesSentDistributionStatistics = new StatisticsDistribution(TRI_BytesSentDistributionVectorStatistics);
   TRI_BytesReceivedDistributionStatistics = new StatisticsDistribution(TRI_BytesReceivedDistributionVectorStatistics);
+  TRI_WalSyncTimeDistributionStatistics = new StatisticsDistribution(TRI_WalSyncTimeDistributionVectorStatistics);
 
   // initialise counters for all HTTP request types
   TRI_MethodRequestsStatistics.clear();
@@ -192,6 +192,22 @@ void TRI_FillConnectionStatistics (triagens::basics::StatisticsCounter& httpConn
                                    triagens::basics::StatisticsCounter& asyncRequests,
                                    triagens::basics::StatisticsDistribution& connectionTime);
 
+// -----------------------------------------------------------------------------
+// --SECTION--                                   public WAL statistics functions
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief adds the time a commit with waitForSync waited for its sync
+////////////////////////////////////////////////////////////////////////////////
+
+void TRI_AddWalSyncTimeStatistics (double);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief fills the current statistics
+////////////////////////////////////////////////////////////////////////////////
+
+void TRI_FillWalStatistics (triagens::basics::StatisticsDistribution& syncTime);
+
 // -----------------------------------------------------------------------------
 // --SECTION--                                public server statistics functions
 // -----------------------------------------------------------------------------
@@ -302,6 +318,18 @@ extern triagens::basics::StatisticsVector TRI_BytesReceivedDistributionVectorSta
 
 extern triagens::basics::StatisticsDistribution* TRI_BytesReceivedDistributionStatistics;
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief WAL sync time distribution vector
+////////////////////////////////////////////////////////////////////////////////
+
+extern triagens::basics::StatisticsVector TRI_WalSyncTimeDistributionVectorStatistics;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief WAL sync time distribution
+////////////////////////////////////////////////////////////////////////////////
+
+extern triagens::basics::StatisticsDistribution* TRI_WalSyncTimeDistributionStatistics;
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief global server statistics
 ////////////////////////////////////////////////////////////////////////////////
@@ -165,6 +165,23 @@ namespace triagens {
           return trxColl->_collection->_collection;
         }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief explicitly read-lock a collection of the transaction, for AQL
+/// functions that access indexes directly
+////////////////////////////////////////////////////////////////////////////////
+
+        int lockRead (TRI_transaction_collection_t* trxCollection) {
+          return this->lock(trxCollection, TRI_TRANSACTION_READ);
+        }
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief read-unlock a collection locked with lockRead
+////////////////////////////////////////////////////////////////////////////////
+
+        int unlockRead (TRI_transaction_collection_t* trxCollection) {
+          return this->unlock(trxCollection, TRI_TRANSACTION_READ);
+        }
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief clone, used to make daughter transactions for parts of a distributed
 /// AQL query running on the coordinator
@@ -124,10 +124,9 @@ void CollectionExport::run (uint64_t maxWaitTime, size_t limit) {
       THROW_ARANGO_EXCEPTION(res);
     }
 
-    auto primaryIndex = _document->primaryIndex()->internals();
-    size_t const n = static_cast<size_t>(primaryIndex->_nrAlloc);
+    auto primaryIndex = _document->primaryIndex();
 
-    size_t maxDocuments = static_cast<size_t>(primaryIndex->_nrUsed);
+    size_t maxDocuments = static_cast<size_t>(primaryIndex->size());
 
     if (limit > 0 && limit < maxDocuments) {
       maxDocuments = limit;
@@ -138,19 +137,18 @@ void CollectionExport::run (uint64_t maxWaitTime, size_t limit) {
     _documents->reserve(maxDocuments);
  
     if (maxDocuments > 0) { 
-      for (size_t i = 0; i < n; ++i) {
-        auto ptr = primaryIndex->_table[i];
+      triagens::arango::PrimaryIndex::Position position;
+      TRI_doc_mptr_t const* ptr;
 
-        if (ptr != nullptr) {
-          void const* marker = static_cast<TRI_doc_mptr_t const*>(ptr)->getDataPtr();
+      while ((ptr = primaryIndex->lookupSequential(position)) != nullptr) {
+        void const* marker = ptr->getDataPtr();
 
-          // it is only safe to use the markers from the datafiles, not the WAL
-          if (! TRI_IsWalDataMarkerDatafile(marker)) {
-            _documents->emplace_back(marker);
+        // it is only safe to use the markers from the datafiles, not the WAL
+        if (! TRI_IsWalDataMarkerDatafile(marker)) {
+          _documents->emplace_back(marker);
 
-            if (--limit == 0) {
-              break;
-            }
+          if (--limit == 0) {
+            break;
           }
         }
       }
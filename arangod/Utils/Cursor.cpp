@@ -28,6 +28,10 @@
 ////////////////////////////////////////////////////////////////////////////////
 
 #include "Utils/Cursor.h"
+#include "Aql/AqlItemBlock.h"
+#include "Aql/ExecutionBlock.h"
+#include "Aql/ExecutionEngine.h"
+#include "Aql/Query.h"
 #include "Basics/JsonHelper.h"
 #include "Utils/CollectionExport.h"
 #include "VocBase/document-collection.h"
@@ -423,6 +427,256 @@ void ExportCursor::dump (triagens::basics::StringBuffer& buffer) {
   }
 }
 
+// -----------------------------------------------------------------------------
+// --SECTION--                                           class QueryStreamCursor
+// -----------------------------------------------------------------------------
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                        constructors / destructors
+// -----------------------------------------------------------------------------
+
+QueryStreamCursor::QueryStreamCursor (TRI_vocbase_t* vocbase,
+                                      CursorId id,
+                                      triagens::aql::Query* query,
+                                      size_t batchSize,
+                                      double ttl)
+  : Cursor(id, batchSize, nullptr, ttl, false),
+    _vocbase(vocbase),
+    _query(query),
+    _block(nullptr),
+    _blockPosition(0),
+    _current(nullptr),
+    _exhausted(false) {
+
+  TRI_ASSERT(_query != nullptr);
+  TRI_ASSERT(_query->engine() != nullptr);
+
+  TRI_UseVocBase(vocbase);
+}
+        
+QueryStreamCursor::~QueryStreamCursor () {
+  freeCurrent();
+  delete _block;
+
+  // destroying a query that was not finished aborts its transaction
+  delete _query;
+
+  TRI_ReleaseVocBase(_vocbase);
+}
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                    public methods
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief check whether the cursor contains more data
+////////////////////////////////////////////////////////////////////////////////
+
+bool QueryStreamCursor::hasNext () {
+  return fetch();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief return the next element
+/// the element is owned by the cursor and valid until the next call
+////////////////////////////////////////////////////////////////////////////////
+
+TRI_json_t* QueryStreamCursor::next () {
+  freeCurrent();
+
+  if (! fetch()) {
+    return nullptr;
+  }
+
+  auto const resultRegister = _query->engine()->resultRegister();
+  auto doc = _block->getDocumentCollection(resultRegister);
+  auto const& value = _block->getValueReference(_blockPosition++, resultRegister);
+
+  _current = value.toJson(_query->trx(), doc, true).steal();
+  ++_position;
+
+  return _current;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief return the number of results returned so far
+////////////////////////////////////////////////////////////////////////////////
+
+size_t QueryStreamCursor::count () const {
+  return _position;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief dump the next batch of results into a string buffer
+////////////////////////////////////////////////////////////////////////////////
+        
+void QueryStreamCursor::dump (triagens::basics::StringBuffer& buffer) {
+  try {
+    buffer.appendText("\"result\":[");
+
+    size_t const n = batchSize();
+
+    for (size_t i = 0; i < n; ++i) {
+      if (! fetch()) {
+        break;
+      }
+
+      if (i > 0) {
+        buffer.appendChar(',');
+      }
+
+      auto const resultRegister = _query->engine()->resultRegister();
+      auto doc = _block->getDocumentCollection(resultRegister);
+      auto const& value = _block->getValueReference(_blockPosition++, resultRegister);
+
+      // values that already are JSON are stringified without copying them
+      triagens::basics::Json json(value.toJson(_query->trx(), doc, false));
+
+      int res = TRI_StringifyJson(buffer.stringBuffer(), json.json());
+
+      if (res != TRI_ERROR_NO_ERROR) {
+        THROW_ARANGO_EXCEPTION(res);
+      }
+
+      ++_position;
+    }
+
+    // this finishes the query if there are no more results
+    bool const more = fetch();
+
+    buffer.appendText("],\"hasMore\":");
+    buffer.appendText(more ? "true" : "false");
+
+    if (more) {
+      // only return cursor id if there are more documents
+      buffer.appendText(",\"id\":\"");
+      buffer.appendInteger(id());
+      buffer.appendText("\"");
+    }
+
+    TRI_json_t const* extraJson = extra();
+
+    if (TRI_IsObjectJson(extraJson)) {
+      buffer.appendText(",\"extra\":");
+      TRI_StringifyJson(buffer.stringBuffer(), extraJson);
+    }
+
+    buffer.appendText(",\"cached\":false");
+
+    if (! more) {
+      // mark the cursor as deleted
+      this->deleted();
+    }
+  }
+  catch (...) {
+    // the query cannot be continued after an error
+    this->deleted();
+    throw;
+  }
+}
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                 private functions
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief positions the cursor on the next non-empty result value, fetching
+/// the next block from the execution engine if required. returns false if
+/// there are no more results. the V8 context is exited after each block
+////////////////////////////////////////////////////////////////////////////////
+
+bool QueryStreamCursor::fetch () {
+  if (_exhausted) {
+    return false;
+  }
+
+  auto engine = _query->engine();
+  TRI_ASSERT(engine != nullptr);
+
+  auto const resultRegister = engine->resultRegister();
+
+  while (true) {
+    if (_block != nullptr) {
+      size_t const n = _block->size();
+
+      for (; _blockPosition < n; ++_blockPosition) {
+        if (! _block->getValueReference(_blockPosition, resultRegister).isEmpty()) {
+          return true;
+        }
+      }
+
+      delete _block;
+      _block = nullptr;
+      _blockPosition = 0;
+    }
+
+    try {
+      _block = engine->getSome(1, triagens::aql::ExecutionBlock::DefaultBatchSize);
+    }
+    catch (...) {
+      _query->exitContext();
+      throw;
+    }
+
+    // the next block may be fetched by a different thread, so the query must
+    // not keep a V8 context it has entered for producing this one
+    _query->exitContext();
+
+    if (_block == nullptr) {
+      finish();
+      return false;
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief finishes the query after the last result was fetched. this commits
+/// the query's transaction and makes the query's warnings and statistics
+/// available as the cursor's "extra" attribute
+////////////////////////////////////////////////////////////////////////////////
+
+void QueryStreamCursor::finish () {
+  _exhausted = true;
+
+  auto queryResult = _query->finalize();
+  
+  triagens::basics::Json extra(triagens::basics::Json::Object, 4); 
+
+  if (queryResult.stats != nullptr) {
+    extra.set("stats", triagens::basics::Json(TRI_UNKNOWN_MEM_ZONE, queryResult.stats, triagens::basics::Json::AUTOFREE));
+    queryResult.stats = nullptr;
+  }
+  if (queryResult.profile != nullptr) {
+    extra.set("profile", triagens::basics::Json(TRI_UNKNOWN_MEM_ZONE, queryResult.profile, triagens::basics::Json::AUTOFREE));
+    queryResult.profile = nullptr;
+  }
+  if (queryResult.plan != nullptr) {
+    extra.set("plan", triagens::basics::Json(TRI_UNKNOWN_MEM_ZONE, queryResult.plan, triagens::basics::Json::AUTOFREE));
+    queryResult.plan = nullptr;
+  }
+  if (queryResult.warnings == nullptr) {
+    extra.set("warnings", triagens::basics::Json(triagens::basics::Json::Array));
+  }
+  else {
+    extra.set("warnings", triagens::basics::Json(TRI_UNKNOWN_MEM_ZONE, queryResult.warnings, triagens::basics::Json::AUTOFREE));
+    queryResult.warnings = nullptr;
+  }
+
+  TRI_ASSERT(_extra == nullptr);
+  _extra = extra.steal();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief free the element returned by the last call to next()
+////////////////////////////////////////////////////////////////////////////////
+
+void QueryStreamCursor::freeCurrent () {
+  if (_current != nullptr) {
+    TRI_FreeJson(TRI_UNKNOWN_MEM_ZONE, _current);
+    _current = nullptr;
+  }
+}
+
 // -----------------------------------------------------------------------------
 // --SECTION--                                                       END-OF-FILE
 // -----------------------------------------------------------------------------
@@ -38,6 +38,11 @@ struct TRI_json_t;
 struct TRI_vocbase_t;
 
 namespace triagens {
+  namespace aql {
+    class AqlItemBlock;
+    class Query;
+  }
+
   namespace arango {
 
     class CollectionExport;
@@ -235,6 +240,76 @@ namespace triagens {
         size_t const                        _size;
     };
 
+// -----------------------------------------------------------------------------
+// --SECTION--                                           class QueryStreamCursor
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief a cursor that keeps an AQL query running and fetches the results
+/// from its execution engine batch by batch, instead of materializing the
+/// complete result upfront
+///
+/// the query's transaction stays open until the cursor is exhausted, deleted
+/// or expired. the total number of results is unknown in advance, so the
+/// cursor does not support counting. the query's warnings and statistics are
+/// returned with the last batch
+////////////////////////////////////////////////////////////////////////////////
+    
+    class QueryStreamCursor : public Cursor {
+      public:
+
+        QueryStreamCursor (TRI_vocbase_t*,
+                           CursorId,
+                           triagens::aql::Query*,
+                           size_t,
+                           double);
+
+        ~QueryStreamCursor ();
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                  public functions
+// -----------------------------------------------------------------------------
+
+      public:
+
+        triagens::aql::Query* query () const {
+          return _query;
+        }
+
+        bool hasNext () override final;
+
+        struct TRI_json_t* next () override final;
+        
+        size_t count () const override final;
+
+        void dump (triagens::basics::StringBuffer&) override final;
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                 private functions
+// -----------------------------------------------------------------------------
+
+      private:
+
+        bool fetch ();
+
+        void finish ();
+
+        void freeCurrent ();
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                 private variables
+// -----------------------------------------------------------------------------
+
+      private:
+
+        TRI_vocbase_t*                      _vocbase;
+        triagens::aql::Query*               _query;
+        triagens::aql::AqlItemBlock*        _block;
+        size_t                              _blockPosition;
+        struct TRI_json_t*                  _current;
+        bool                                _exhausted;
+    };
+
   }
 }
 
@@ -96,6 +96,18 @@ namespace triagens {
                                         double, 
                                         bool);
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief creates a streaming cursor for a prepared query and stores it in 
+/// the registry
+/// the cursor will be returned with the usage flag set to true. it must be
+/// returned later using release() 
+/// the cursor will take ownership of the query
+////////////////////////////////////////////////////////////////////////////////
+
+        QueryStreamCursor* createFromQuery (triagens::aql::Query*,
+                                            size_t,
+                                            double);
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief remove a cursor by id
 ////////////////////////////////////////////////////////////////////////////////
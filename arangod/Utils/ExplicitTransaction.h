@@ -123,6 +123,19 @@ namespace triagens {
         ~ExplicitTransaction () {
         }
 
+// -----------------------------------------------------------------------------
+// --SECTION--                                                    public methods
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief read the keys of all documents of a collection
+////////////////////////////////////////////////////////////////////////////////
+
+        int readAllKeys (TRI_transaction_collection_t* trxCollection,
+                         std::vector<std::string>& keys) {
+          return this->readAll(trxCollection, keys, true);
+        }
+
     };
 
   }
@@ -403,6 +403,31 @@ namespace triagens {
                              TRI_voc_size_t limit,
                              uint32_t* total) {
 
+          auto primaryIndex = documentCollection(trxCollection)->primaryIndex();
+          auto position = primaryIndex->position(static_cast<uint64_t>(internalSkip));
+
+          int res = readIncremental(trxCollection, docs, position, batchSize, skip, limit, total);
+
+          if (res == TRI_ERROR_NO_ERROR && *total > 0) {
+            internalSkip = static_cast<TRI_voc_size_t>(primaryIndex->offset(position));
+          }
+
+          return res;
+        }
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief read all master pointers, using skip and limit and a position in
+/// the primary index that is carried from batch to batch
+////////////////////////////////////////////////////////////////////////////////
+
+        int readIncremental (TRI_transaction_collection_t* trxCollection,
+                             std::vector<TRI_doc_mptr_copy_t>& docs,
+                             PrimaryIndex::Position& position,
+                             TRI_voc_size_t batchSize,
+                             TRI_voc_ssize_t skip,
+                             TRI_voc_size_t limit,
+                             uint32_t* total) {
+
           TRI_document_collection_t* document = documentCollection(trxCollection);
 
           // READ-LOCK START
@@ -412,9 +437,10 @@ namespace triagens {
             return res;
           }
 
-          auto primaryIndex = document->primaryIndex()->internals();
+          auto primaryIndex = document->primaryIndex();
+          uint64_t const nrUsed = primaryIndex->size();
 
-          if (primaryIndex->_nrUsed == 0) {
+          if (nrUsed == 0) {
             // nothing to do
             this->unlock(trxCollection, TRI_TRANSACTION_READ);
 
@@ -427,40 +453,27 @@ namespace triagens {
             return TRI_ERROR_OUT_OF_MEMORY;
           }
 
-          void** beg = primaryIndex->_table;
-          void** end = beg + primaryIndex->_nrAlloc;
+          *total = (uint32_t) nrUsed;
 
-          if (internalSkip > 0) {
-            beg += internalSkip;
-          }
+          try {
+            while (skip > 0 && primaryIndex->lookupSequential(position) != nullptr) {
+              --skip;
+            }
 
-          void** ptr = beg;
-          uint32_t count = 0;
-          *total = (uint32_t) primaryIndex->_nrUsed;
+            size_t const n = static_cast<size_t>((std::min)(batchSize, limit));
 
-          try {
-            if (batchSize > 2048) {
+            if (n > 2048) {
               docs.reserve(2048);
             }
-            else if (batchSize > 0) {
-              docs.reserve(batchSize);
+            else if (n > 0) {
+              docs.reserve(n);
             }
 
-            // fetch documents, taking limit into account
-            for (; ptr < end && count < batchSize; ++ptr, ++internalSkip) {
-              if (*ptr) {
-                TRI_doc_mptr_t* d = (TRI_doc_mptr_t*) *ptr;
+            size_t const count = primaryIndex->lookupSequential(position, primaryIndex->end(), docs, n);
 
-                if (skip > 0) {
-                  --skip;
-                }
-                else {
-                  docs.emplace_back(*d);
-                  if (++count >= limit) {
-                    break;
-                  }
-                }
-              }
+            if (count > 0 && count >= limit) {
+              // keep the position at the document just read
+              --position._slot;
             }
           }
           catch (...) {
@@ -474,6 +487,72 @@ namespace triagens {
           return TRI_ERROR_NO_ERROR;
         }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief read the master pointers of one partition of the primary index.
+/// the primary index slots are split into numPartitions ranges of equal size.
+/// position is carried from batch to batch and is moved to the start of the
+/// partition's range on the first call.
+/// the collection's read lock is acquired directly instead of via lock() and
+/// unlock(), so that multiple threads can read different partitions of the
+/// same collection concurrently. the ditch must have been ordered by the
+/// caller already
+////////////////////////////////////////////////////////////////////////////////
+
+        int readPartition (TRI_transaction_collection_t* trxCollection,
+                           std::vector<TRI_doc_mptr_copy_t>& docs,
+                           PrimaryIndex::Position& position,
+                           size_t partition,
+                           size_t numPartitions,
+                           TRI_voc_size_t batchSize,
+                           uint32_t* total) {
+
+          TRI_ASSERT(partition < numPartitions);
+
+          if (_trx == nullptr || getStatus() != TRI_TRANSACTION_RUNNING) {
+            return TRI_ERROR_TRANSACTION_INTERNAL;
+          }
+
+          TRI_document_collection_t* document = documentCollection(trxCollection);
+
+          // READ-LOCK START
+          TRI_READ_LOCK_DOCUMENTS_INDEXES_PRIMARY_COLLECTION(document);
+
+          auto primaryIndex = document->primaryIndex();
+          uint64_t const capacity = primaryIndex->capacity();
+          auto const begin = primaryIndex->position(capacity * partition / numPartitions);
+          auto const end = primaryIndex->position(capacity * (partition + 1) / numPartitions);
+
+          *total = static_cast<uint32_t>(primaryIndex->size());
+
+          if (position < begin) {
+            position = begin;
+          }
+
+          try {
+            docs.reserve(batchSize);
+            primaryIndex->lookupSequential(position, end, docs, static_cast<size_t>(batchSize));
+          }
+          catch (...) {
+            TRI_READ_UNLOCK_DOCUMENTS_INDEXES_PRIMARY_COLLECTION(document);
+            return TRI_ERROR_OUT_OF_MEMORY;
+          }
+
+          TRI_READ_UNLOCK_DOCUMENTS_INDEXES_PRIMARY_COLLECTION(document);
+          // READ-LOCK END
+
+          return TRI_ERROR_NO_ERROR;
+        }
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief release the read lock on a collection before reading partitions of
+/// it from other threads. a sequential read releases the lock after its
+/// first batch as well
+////////////////////////////////////////////////////////////////////////////////
+
+        int unlockPartitions (TRI_transaction_collection_t* trxCollection) {
+          return this->unlock(trxCollection, TRI_TRANSACTION_READ);
+        }
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief read all master pointers, using skip and limit and an internal
 /// offset into the primary index. this can be used for incremental access to
@@ -501,8 +580,8 @@ namespace triagens {
             return res;
           }
 
-          auto primaryIndex = document->primaryIndex()->internals();
-          if (primaryIndex->_nrUsed == 0) {
+          auto primaryIndex = document->primaryIndex();
+          if (primaryIndex->size() == 0) {
             // nothing to do
             this->unlock(trxCollection, TRI_TRANSACTION_READ);
 
@@ -515,7 +594,7 @@ namespace triagens {
             return TRI_ERROR_OUT_OF_MEMORY;
           }
 
-          *total = (uint32_t) primaryIndex->_nrAlloc;
+          *total = (uint32_t) primaryIndex->capacity();
           if (*step == 0) {
             TRI_ASSERT(initialPosition == 0);
 
@@ -534,7 +613,7 @@ namespace triagens {
 
           TRI_voc_size_t numRead = 0;
           do {
-            auto d = static_cast<TRI_doc_mptr_t*>(primaryIndex->_table[position]);
+            auto d = primaryIndex->lookupSlot(position);
 
             if (d != nullptr) {
               docs.emplace_back(*d);
@@ -864,9 +943,9 @@ namespace triagens {
             return res;
           }
 
-          auto primaryIndex = document->primaryIndex()->internals();
+          auto primaryIndex = document->primaryIndex();
 
-          if (primaryIndex->_nrUsed == 0) {
+          if (primaryIndex->size() == 0) {
             // no document found
             mptr->setDataPtr(nullptr);  // PROTECTED by trx in trxCollection
           }
@@ -875,15 +954,15 @@ namespace triagens {
               return TRI_ERROR_OUT_OF_MEMORY;
             }
 
-            uint32_t total = (uint32_t) primaryIndex->_nrAlloc;
+            uint32_t total = (uint32_t) primaryIndex->capacity();
             uint32_t pos = TRI_UInt32Random() % total;
-            void** beg = primaryIndex->_table;
+            TRI_doc_mptr_t* d;
 
-            while (beg[pos] == nullptr) {
+            while ((d = primaryIndex->lookupSlot(pos)) == nullptr) {
               pos = TRI_UInt32Random() % total;
             }
 
-            *mptr = *((TRI_doc_mptr_t*) beg[pos]);
+            *mptr = *d;
           }
 
           this->unlock(trxCollection, TRI_TRANSACTION_READ);
@@ -911,24 +990,19 @@ namespace triagens {
             }
           }
 
-          auto primaryIndex = document->primaryIndex()->internals();
+          auto primaryIndex = document->primaryIndex();
+          uint64_t const nrUsed = primaryIndex->size();
 
-          if (primaryIndex->_nrUsed > 0) {
+          if (nrUsed > 0) {
             if (orderDitch(trxCollection) == nullptr) {
               return TRI_ERROR_OUT_OF_MEMORY;
             }
 
-            ids.reserve((size_t) primaryIndex->_nrUsed);
+            ids.reserve((size_t) nrUsed);
 
-            void** ptr = primaryIndex->_table;
-            void** end = ptr + primaryIndex->_nrAlloc;
-
-            for (;  ptr < end;  ++ptr) {
-              if (*ptr) {
-                TRI_doc_mptr_t const* d = (TRI_doc_mptr_t const*) *ptr;
-                ids.push_back(TRI_EXTRACT_MARKER_KEY(d));  // PROTECTED by trx in trxCollection
-              }
-            }
+            primaryIndex->invokeOnAllElements([&ids] (TRI_doc_mptr_t* d) -> void {
+              ids.push_back(TRI_EXTRACT_MARKER_KEY(d));  // PROTECTED by trx in trxCollection
+            });
           }
 
           if (lock) {
@@ -941,6 +1015,8 @@ namespace triagens {
 
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief read master pointers in order of insertion/update
+/// a negative offset reads from the back, starting with the most recently
+/// inserted/updated document at offset -1
 ////////////////////////////////////////////////////////////////////////////////
 
         int readOrdered (TRI_transaction_collection_t* trxCollection,
@@ -949,6 +1025,11 @@ namespace triagens {
                          int64_t count) {
           TRI_document_collection_t* document = documentCollection(trxCollection);
 
+          if (count <= 0) {
+            // nothing to do
+            return TRI_ERROR_NO_ERROR;
+          }
+
           // READ-LOCK START
           int res = this->lock(trxCollection, TRI_TRANSACTION_READ);
 
@@ -960,41 +1041,19 @@ namespace triagens {
             return TRI_ERROR_OUT_OF_MEMORY;
           }
 
-          TRI_doc_mptr_t* doc;
-
-          if (offset >= 0) {
-            // read from front
-            doc = document->_headersPtr->front();  // PROTECTED by trx in trxCollection
-            int64_t i = 0;
+          try {
+            std::vector<TRI_doc_mptr_t const*> ordered;
+            document->_headersPtr->ordered(offset, count, ordered);  // PROTECTED by trx in trxCollection
 
-            while (doc != nullptr && i < offset) {
-              doc = doc->_next;
-              ++i;
-            }
+            documents.reserve(ordered.size());
 
-            i = 0;
-            while (doc != nullptr && i < count) {
-              documents.emplace_back(*doc);
-              doc = doc->_next;
-              ++i;
+            for (auto const& it : ordered) {
+              documents.emplace_back(*it);
             }
           }
-          else {
-            // read from back
-            doc = document->_headersPtr->back();  // PROTECTED by trx in trxCollection
-            int64_t i = -1;
-
-            while (doc != nullptr && i > offset) {
-              doc = doc->_prev;
-              --i;
-            }
-
-            i = 0;
-            while (doc != nullptr && i < count) {
-              documents.emplace_back(*doc);
-              doc = doc->_prev;
-              ++i;
-            }
+          catch (...) {
+            this->unlock(trxCollection, TRI_TRANSACTION_READ);
+            return TRI_ERROR_OUT_OF_MEMORY;
           }
 
           this->unlock(trxCollection, TRI_TRANSACTION_READ);
@@ -1027,9 +1086,10 @@ namespace triagens {
             return res;
           }
 
-          auto primaryIndex = document->primaryIndex()->internals();
+          auto primaryIndex = document->primaryIndex();
+          uint64_t const nrUsed = primaryIndex->size();
 
-          if (primaryIndex->_nrUsed == 0) {
+          if (nrUsed == 0) {
             // nothing to do
             this->unlock(trxCollection, TRI_TRANSACTION_READ);
             // READ-LOCK END
@@ -1040,50 +1100,28 @@ namespace triagens {
             return TRI_ERROR_OUT_OF_MEMORY;
           }
 
-          void** beg = primaryIndex->_table;
-          void** ptr = beg;
-          void** end = ptr + primaryIndex->_nrAlloc;
-          uint32_t count = 0;
+          PrimaryIndex::Position position;
 
-          *total = (uint32_t) primaryIndex->_nrUsed;
+          *total = (uint32_t) nrUsed;
 
           // apply skip
           if (skip > 0) {
             // skip from the beginning
-            for (;  ptr < end && 0 < skip;  ++ptr) {
-              if (*ptr) {
-                --skip;
-              }
+            while (0 < skip && primaryIndex->lookupSequential(position) != nullptr) {
+              --skip;
             }
           }
           else if (skip < 0) {
             // skip from the end
-            ptr = end - 1;
-
-            for (; beg <= ptr; --ptr) {
-              if (*ptr) {
-                ++skip;
-
-                if (skip == 0) {
-                  break;
-                }
-              }
-            }
+            position = primaryIndex->end();
 
-            if (ptr < beg) {
-              ptr = beg;
+            while (skip < 0 && primaryIndex->lookupSequentialReverse(position) != nullptr) {
+              ++skip;
             }
           }
 
           // fetch documents, taking limit into account
-          for (; ptr < end && count < limit; ++ptr) {
-            if (*ptr) {
-              TRI_doc_mptr_t* d = (TRI_doc_mptr_t*) *ptr;
-
-              docs.emplace_back(*d);
-              ++count;
-            }
-          }
+          primaryIndex->lookupSequential(position, primaryIndex->end(), docs, static_cast<size_t>(limit));
 
           this->unlock(trxCollection, TRI_TRANSACTION_READ);
           // READ-LOCK END
@@ -1107,9 +1145,9 @@ namespace triagens {
             return res;
           }
 
-          auto primaryIndex = document->primaryIndex()->internals();
+          auto primaryIndex = document->primaryIndex();
 
-          if (primaryIndex->_nrUsed == 0) {
+          if (primaryIndex->size() == 0) {
             // nothing to do
             this->unlock(trxCollection, TRI_TRANSACTION_READ);
             // READ-LOCK END
@@ -1120,16 +1158,10 @@ namespace triagens {
             return TRI_ERROR_OUT_OF_MEMORY;
           }
 
-          void** ptr = primaryIndex->_table;
-          void** end = ptr + primaryIndex->_nrAlloc;
-
-          // fetch documents, taking limit into account
-          for (; ptr < end; ++ptr) {
-            if (*ptr) {
-              TRI_doc_mptr_t* d = (TRI_doc_mptr_t*) *ptr;
-              docs.push_back(d);
-            }
-          }
+          // fetch documents
+          primaryIndex->invokeOnAllElements([&docs] (TRI_doc_mptr_t* d) -> void {
+            docs.push_back(d);
+          });
 
           this->unlock(trxCollection, TRI_TRANSACTION_READ);
           // READ-LOCK END
@@ -1157,37 +1189,25 @@ namespace triagens {
             return res;
           }
 
-          auto primaryIndex = document->primaryIndex()->internals();
+          auto primaryIndex = document->primaryIndex();
+          uint64_t const nrUsed = primaryIndex->size();
 
-          if (primaryIndex->_nrUsed > 0) {
+          if (nrUsed > 0) {
             if (orderDitch(trxCollection) == nullptr) {
               return TRI_ERROR_OUT_OF_MEMORY;
             }
             
-            docs.reserve(static_cast<size_t>(primaryIndex->_nrUsed) % static_cast<size_t>(numberOfPartitions));
+            docs.reserve(static_cast<size_t>(nrUsed) % static_cast<size_t>(numberOfPartitions));
           
-            void** ptr = primaryIndex->_table;
-            void** end = ptr + primaryIndex->_nrAlloc;
-            *total = (uint32_t) primaryIndex->_nrUsed;
+            *total = (uint32_t) nrUsed;
 
             // fetch documents, taking partition into account
-            for (; ptr < end; ++ptr) {
-              if (*ptr) {
-                TRI_doc_mptr_t const* d = (TRI_doc_mptr_t const*) *ptr;
-
-                if (d->_hash % numberOfPartitions == partitionId) {
-                  // correct partition
-                  docs.emplace_back(*d);
-                }
+            primaryIndex->invokeOnAllElements([&docs, &partitionId, &numberOfPartitions] (TRI_doc_mptr_t* d) -> void {
+              if (d->_hash % numberOfPartitions == partitionId) {
+                // correct partition
+                docs.emplace_back(*d);  // PROTECTED by trx in trxCollection
               }
-            }
-
-            for (;  ptr < end;  ++ptr) {
-              if (*ptr) {
-                TRI_doc_mptr_t const* d = (TRI_doc_mptr_t const*) *ptr;
-                docs.push_back(*d);  // PROTECTED by trx in trxCollection
-              }
-            }
+            });
           }
 
           this->unlock(trxCollection, TRI_TRANSACTION_READ);
@@ -28,6 +28,8 @@
 ////////////////////////////////////////////////////////////////////////////////
 
 #include "V8Traverser.h"
+#include "Basics/Barrier.h"
+#include "Basics/ThreadPool.h"
 #include "Utils/transactions.h"
 #include "Utils/V8ResolverGuard.h"
 #include "Utils/CollectionNameResolver.h"
@@ -696,3 +698,332 @@ void TRI_RunNeighborsSearch (
   }
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief a vertex reached by a centrality search. the key is the position of
+/// the vertex in the list of all vertices, the length is the number of
+/// vertices on the path from the source to the vertex
+////////////////////////////////////////////////////////////////////////////////
+
+class CentralityStep {
+
+    size_t _vertex;
+    size_t _predecessor;
+    double _weight;
+    size_t _length;
+
+  public:
+
+    CentralityStep (size_t vertex,
+                    size_t predecessor,
+                    double weight,
+                    size_t length)
+      : _vertex(vertex),
+        _predecessor(predecessor),
+        _weight(weight),
+        _length(length) {
+    }
+
+    size_t const& getKey () const {
+      return _vertex;
+    }
+
+    double weight () const {
+      return _weight;
+    }
+
+    void setWeight (double weight) {
+      _weight = weight;
+    }
+
+    size_t predecessor () const {
+      return _predecessor;
+    }
+
+    size_t length () const {
+      return _length;
+    }
+
+    void setPredecessor (size_t predecessor,
+                         size_t length) {
+      _predecessor = predecessor;
+      _length = length;
+    }
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief single-source shortest path search used by the centrality
+/// computation. each worker thread uses its own searcher
+////////////////////////////////////////////////////////////////////////////////
+
+class CentralitySearcher {
+
+    typedef PriorityQueue<size_t, CentralityStep, double> Queue;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief all info required for edge collections
+////////////////////////////////////////////////////////////////////////////////
+
+    vector<EdgeCollectionInfo*> const& _edgeCollections;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief all vertices of the graph
+////////////////////////////////////////////////////////////////////////////////
+
+    vector<VertexId> const& _vertices;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief position of each vertex in _vertices
+////////////////////////////////////////////////////////////////////////////////
+
+    unordered_map<VertexId, size_t> const& _positions;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief edge direction to follow
+////////////////////////////////////////////////////////////////////////////////
+
+    TRI_edge_direction_e _direction;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief vertices in the order they were settled by the current search
+////////////////////////////////////////////////////////////////////////////////
+
+    vector<CentralityStep const*> _settled;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief betweenness contributions of the paths through each vertex,
+/// accumulated from the leaves of the shortest path tree towards the source
+////////////////////////////////////////////////////////////////////////////////
+
+    vector<double> _dependencies;
+
+  public:
+
+    CentralitySearcher (vector<EdgeCollectionInfo*> const& edgeCollections,
+                        vector<VertexId> const& vertices,
+                        unordered_map<VertexId, size_t> const& positions,
+                        TRI_edge_direction_e direction,
+                        bool computeBetweenness)
+      : _edgeCollections(edgeCollections),
+        _vertices(vertices),
+        _positions(positions),
+        _direction(direction),
+        _settled(),
+        _dependencies() {
+
+      if (computeBetweenness) {
+        _dependencies.resize(vertices.size(), 0.0);
+      }
+    }
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief compute the shortest paths from the source to all reachable
+/// vertices. the sum and the maximum of the distances are stored for the
+/// source. if betweenness is not a nullptr, each vertex on a path between
+/// two other vertices is credited with 1 / (number of vertices on the path)
+////////////////////////////////////////////////////////////////////////////////
+
+    void run (size_t source,
+              CentralityResult& result,
+              vector<double>* betweenness) {
+
+      Queue queue;
+      queue.insert(source, new CentralityStep(source, source, 0.0, 1));
+      _settled.clear();
+
+      equal_to<VertexId> eq;
+      double sum = 0.0;
+      double max = 0.0;
+
+      size_t position;
+      CentralityStep* step;
+
+      while (queue.popMinimal(position, step, true)) {
+        _settled.emplace_back(step);
+
+        double const distance = step->weight();
+        size_t const length = step->length();
+        sum += distance;
+        if (distance > max) {
+          max = distance;
+        }
+
+        VertexId const& vertex = _vertices[position];
+
+        for (auto const& edgeCollection : _edgeCollections) {
+          auto edges = edgeCollection->getEdges(_direction, vertex);
+
+          for (size_t j = 0;  j < edges.size(); ++j) {
+            VertexId neighbor = ExtractFromId(edges[j]);
+
+            if (eq(neighbor, vertex)) {
+              neighbor = ExtractToId(edges[j]);
+
+              if (eq(neighbor, vertex)) {
+                // self-loop
+                continue;
+              }
+            }
+
+            auto it = _positions.find(neighbor);
+
+            if (it == _positions.end()) {
+              // vertex is not part of the graph
+              continue;
+            }
+
+            double const weight = edgeCollection->weightEdge(edges[j]);
+
+            if (weight < 0.0 || std::isinf(weight)) {
+              // edge cannot be used in a shortest path
+              continue;
+            }
+
+            double const newWeight = distance + weight;
+            CentralityStep* other = queue.find(it->second);
+
+            if (other == nullptr) {
+              queue.insert(it->second, new CentralityStep(it->second, position, newWeight, length + 1));
+            }
+            else if (newWeight < other->weight()) {
+              queue.lowerWeight(it->second, newWeight);
+              queue.find(it->second)->setPredecessor(position, length + 1);
+            }
+          }
+        }
+      }
+
+      // each source is handled by exactly one thread
+      result.distanceSums[source] = sum;
+      result.maxDistances[source] = max;
+
+      if (betweenness == nullptr) {
+        return;
+      }
+
+      // vertices are settled after their predecessors, so walking the settled
+      // vertices backwards visits the shortest path tree bottom-up
+      for (auto it = _settled.rbegin(); it != _settled.rend(); ++it) {
+        size_t const target = (*it)->getKey();
+
+        if (target == source) {
+          continue;
+        }
+
+        double const dependency = _dependencies[target];
+        (*betweenness)[target] += dependency;
+        _dependencies[(*it)->predecessor()] += dependency + 1.0 / static_cast<double>((*it)->length());
+        _dependencies[target] = 0.0;
+      }
+
+      _dependencies[source] = 0.0;
+    }
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Execute the centrality computation. the sources are distributed
+/// over a pool of worker threads, each of which runs complete single-source
+/// searches
+////////////////////////////////////////////////////////////////////////////////
+
+void TRI_RunCentralitySearch (
+    vector<EdgeCollectionInfo*>& collectionInfos,
+    vector<VertexId> const& vertices,
+    vector<size_t> const& sources,
+    CentralityOptions const& opts,
+    CentralityResult& result) {
+
+  size_t const n = vertices.size();
+
+  unordered_map<VertexId, size_t> positions;
+  positions.reserve(n);
+
+  for (size_t i = 0; i < n; ++i) {
+    positions.emplace(vertices[i], i);
+  }
+
+  result.distanceSums.assign(n, 0.0);
+  result.maxDistances.assign(n, 0.0);
+  result.betweenness.assign(opts.computeBetweenness ? n : 0, 0.0);
+
+  size_t numberThreads = (std::min)(opts.numberThreads, sources.size());
+
+  if (numberThreads == 0) {
+    numberThreads = 1;
+  }
+
+  // betweenness is accumulated per thread and summed up afterwards
+  vector<vector<double>> partials(numberThreads);
+  atomic<size_t> next(0);
+  atomic<int> error(TRI_ERROR_NO_ERROR);
+
+  auto work = [&] (size_t id) -> void {
+    try {
+      CentralitySearcher searcher(collectionInfos, vertices, positions, opts.direction, opts.computeBetweenness);
+      vector<double>* betweenness = nullptr;
+
+      if (opts.computeBetweenness) {
+        partials[id].resize(n, 0.0);
+        betweenness = &partials[id];
+      }
+
+      while (error.load() == TRI_ERROR_NO_ERROR) {
+        size_t const i = next++;
+
+        if (i >= sources.size()) {
+          break;
+        }
+
+        searcher.run(sources[i], result, betweenness);
+      }
+    }
+    catch (Exception const& ex) {
+      int expected = TRI_ERROR_NO_ERROR;
+      error.compare_exchange_strong(expected, ex.code());
+    }
+    catch (...) {
+      int expected = TRI_ERROR_NO_ERROR;
+      error.compare_exchange_strong(expected, TRI_ERROR_OUT_OF_MEMORY);
+    }
+  };
+
+  {
+    Barrier barrier(numberThreads - 1);
+    unique_ptr<ThreadPool> pool;
+
+    if (numberThreads > 1) {
+      pool.reset(new ThreadPool(numberThreads - 1, "Centrality"));
+
+      for (size_t i = 1; i < numberThreads; ++i) {
+        try {
+          pool->enqueue([&work, &barrier, i] () -> void {
+            TransactionBase fake(true); // Fake a transaction to please checks. 
+                                        // This is due to multi-threading
+            work(i);
+            barrier.join();
+          });
+        }
+        catch (...) {
+          // the remaining sources are picked up by the other threads
+          barrier.join();
+        }
+      }
+    }
+
+    // this thread works, too
+    work(0);
+
+    barrier.synchronize();
+  }
+
+  if (error.load() != TRI_ERROR_NO_ERROR) {
+    THROW_ARANGO_EXCEPTION(error.load());
+  }
+
+  if (opts.computeBetweenness) {
+    for (auto const& partial : partials) {
+      for (size_t i = 0; i < partial.size(); ++i) {
+        result.betweenness[i] += partial[i];
+      }
+    }
+  }
+}
@@ -238,6 +238,21 @@ namespace triagens {
           bool matchesVertex (VertexId const&) const;
 
       };
+
+      struct CentralityOptions {
+
+        public:
+          TRI_edge_direction_e direction;
+          bool computeBetweenness;
+          // defaults to one thread per processor
+          size_t numberThreads;
+
+          CentralityOptions ()
+            : direction(TRI_EDGE_ANY),
+              computeBetweenness(false),
+              numberThreads(TRI_numberProcessors()) {
+          }
+      };
     }
   }
 }
@@ -374,4 +389,27 @@ void TRI_RunNeighborsSearch (std::vector<EdgeCollectionInfo*>& collectionInfos,
                              triagens::basics::traverser::NeighborsOptions& opts,
                              std::unordered_set<VertexId>& distinct);
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief result of a centrality computation. all vectors are indexed by the
+/// position of the vertex in the list of vertices the computation ran on.
+/// distance sums and maximum distances are only set for source vertices,
+/// betweenness is only set if it was requested
+////////////////////////////////////////////////////////////////////////////////
+
+struct CentralityResult {
+  std::vector<double> distanceSums;
+  std::vector<double> maxDistances;
+  std::vector<double> betweenness;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Wrapper for the centrality computation
+////////////////////////////////////////////////////////////////////////////////
+
+void TRI_RunCentralitySearch (std::vector<EdgeCollectionInfo*>& collectionInfos,
+                              std::vector<VertexId> const& vertices,
+                              std::vector<size_t> const& sources,
+                              triagens::basics::traverser::CentralityOptions const& opts,
+                              CentralityResult& result);
+
 #endif
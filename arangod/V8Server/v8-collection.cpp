@@ -1747,6 +1747,15 @@ static TRI_doc_collection_info_t* GetFigures (TRI_vocbase_col_t* collection) {
 /// * *uncollectedLogfileEntries*: The number of markers in the write-ahead
 ///   log for this collection that have not been transferred to journals or
 ///   datafiles.
+/// * *compression.count*: The number of documents that were stored
+///   compressed since the collection was loaded. This is only non-zero for
+///   collections with the *compressDocuments* property.
+/// * *compression.uncompressedSize*: The total size of these documents'
+///   bodies before compression, in bytes.
+/// * *compression.compressedSize*: The total size of these documents'
+///   bodies after compression, in bytes.
+/// * *compression.time*: The CPU time spent on compressing documents, in
+///   seconds.
 ///
 /// **Note**: collection data that are stored in the write-ahead log only are
 /// not reported in the results. When the write-ahead log is collected, documents
@@ -1863,6 +1872,13 @@ static void JS_FiguresVocbaseCol (const v8::FunctionCallbackInfo<v8::Value>& arg
   result->Set(TRI_V8_ASCII_STRING("lastTick"),   V8TickId(isolate, info->_tickMax));
   result->Set(TRI_V8_ASCII_STRING("uncollectedLogfileEntries"), v8::Number::New(isolate, (double) info->_uncollectedLogfileEntries));
 
+  v8::Handle<v8::Object> compression = v8::Object::New(isolate);
+  result->Set(TRI_V8_ASCII_STRING("compression"), compression);
+  compression->Set(TRI_V8_ASCII_STRING("count"),            v8::Number::New(isolate, (double) info->_numberCompressed));
+  compression->Set(TRI_V8_ASCII_STRING("uncompressedSize"), v8::Number::New(isolate, (double) info->_sizeUncompressed));
+  compression->Set(TRI_V8_ASCII_STRING("compressedSize"),   v8::Number::New(isolate, (double) info->_sizeCompressed));
+  compression->Set(TRI_V8_ASCII_STRING("time"),             v8::Number::New(isolate, (double) info->_compressionTime / 1000000.0));
+
   TRI_Free(TRI_UNKNOWN_MEM_ZONE, info);
 
   TRI_V8_RETURN(result);
@@ -2024,11 +2040,15 @@ static void JS_PlanIdVocbaseCol (const v8::FunctionCallbackInfo<v8::Value>& args
 ///   when the hash table has to be initially built or resized, since buckets 
 ///   are resized individually and can be initially built in parallel. For 
 ///   example, 64 might be a sensible value for a collection with 100
-///   000 000 documents. Currently, only the edge index respects this
-///   value, but other index types might follow in future ArangoDB versions. 
+///   000 000 documents. Currently, only the primary index and the edge index
+///   respect this value, but other index types might follow in future
+///   ArangoDB versions. 
 ///   Changes (see below) are applied when the collection is loaded the next 
 ///   time.
 ///
+/// * *compressDocuments*: if *true*, the bodies of documents are stored
+///   compressed in the collection's datafiles. The default is *false*.
+///
 /// In a cluster setup, the result will also contain the following attributes:
 ///
 /// * *numberOfShards*: the number of shards of the collection.
@@ -2049,6 +2069,9 @@ static void JS_PlanIdVocbaseCol (const v8::FunctionCallbackInfo<v8::Value>& args
 /// * *indexBuckets* : See above, changes are only applied when the
 ///   collection is loaded the next time.
 ///
+/// * *compressDocuments* : See above, changes only affect documents that
+///   are transferred from the write-ahead log into datafiles afterwards.
+///
 /// *Note*: it is not possible to change the journal size after the journal or
 /// datafile has been created. Changing this parameter will only effect newly
 /// created journals. Also note that you cannot lower the journal size to less
@@ -2153,6 +2176,10 @@ static void JS_PropertiesVocbaseCol (const v8::FunctionCallbackInfo<v8::Value>&
           }
           info._indexBuckets = tmp;
         }
+
+        if (po->Has(TRI_V8_ASCII_STRING("compressDocuments"))) {
+          info._compressDocuments = TRI_ObjectToBoolean(po->Get(TRI_V8_ASCII_STRING("compressDocuments")));
+        }
       }
 
       int res = ClusterInfo::instance()->setCollectionPropertiesCoordinator(databaseName, StringUtils::itoa(collection->_cid), &info);
@@ -2181,6 +2208,8 @@ static void JS_PropertiesVocbaseCol (const v8::FunctionCallbackInfo<v8::Value>&
     result->Set(WaitForSyncKey, v8::Boolean::New(isolate, info._waitForSync));
     result->Set(TRI_V8_ASCII_STRING("indexBuckets"),
                 v8::Number::New(isolate, info._indexBuckets));
+    result->Set(TRI_V8_ASCII_STRING("compressDocuments"),
+                v8::Boolean::New(isolate, info._compressDocuments));
 
     shared_ptr<CollectionInfo> c = ClusterInfo::instance()->getCollection(databaseName, StringUtils::itoa(collection->_cid));
     v8::Handle<v8::Array> shardKeys = v8::Array::New(isolate);
@@ -2223,6 +2252,7 @@ static void JS_PropertiesVocbaseCol (const v8::FunctionCallbackInfo<v8::Value>&
       bool doCompact     = base->_info._doCompact;
       bool waitForSync   = base->_info._waitForSync;
       uint32_t indexBuckets = base->_info._indexBuckets;
+      bool compressDocuments = base->_info._compressDocuments;
 
       TRI_UNLOCK_JOURNAL_ENTRIES_DOC_COLLECTION(document);
 
@@ -2272,6 +2302,10 @@ static void JS_PropertiesVocbaseCol (const v8::FunctionCallbackInfo<v8::Value>&
         }
       }
 
+      if (po->Has(TRI_V8_ASCII_STRING("compressDocuments"))) {
+        compressDocuments = TRI_ObjectToBoolean(po->Get(TRI_V8_ASCII_STRING("compressDocuments")));
+      }
+
       // update collection
       TRI_col_info_t newParameters;
 
@@ -2279,6 +2313,7 @@ static void JS_PropertiesVocbaseCol (const v8::FunctionCallbackInfo<v8::Value>&
       newParameters._maximalSize = maximalSize;
       newParameters._waitForSync = waitForSync;
       newParameters._indexBuckets = indexBuckets;
+      newParameters._compressDocuments = compressDocuments;
 
       // try to write new parameter to file
       bool doSync = base->_vocbase->_settings.forceSyncProperties;
@@ -2331,6 +2366,8 @@ static void JS_PropertiesVocbaseCol (const v8::FunctionCallbackInfo<v8::Value>&
   result->Set(JournalSizeKey, v8::Number::New( isolate, base->_info._maximalSize));
   result->Set(TRI_V8_ASCII_STRING("indexBuckets"),
               v8::Number::New(isolate, document->_info._indexBuckets));
+  result->Set(TRI_V8_ASCII_STRING("compressDocuments"),
+              v8::Boolean::New(isolate, document->_info._compressDocuments));
 
   TRI_json_t* keyOptions = document->_keyGenerator->toJson(TRI_UNKNOWN_MEM_ZONE);
 
@@ -3585,19 +3622,17 @@ static void JS_CheckPointersVocbaseCol (const v8::FunctionCallbackInfo<v8::Value
   TRI_document_collection_t* document = trx.documentCollection();
 
   // iterate over the primary index and de-reference all the pointers to data
-  auto primaryIndex = document->primaryIndex()->internals();
-  void** ptr = primaryIndex->_table;
-  void** end = ptr + primaryIndex->_nrAlloc;
+  auto primaryIndex = document->primaryIndex();
+  triagens::arango::PrimaryIndex::Position position;
+  TRI_doc_mptr_t const* ptr;
 
-  for (;  ptr < end;  ++ptr) {
-    if (*ptr) {
-      char const* key = TRI_EXTRACT_MARKER_KEY((TRI_doc_mptr_t const*) *ptr);
+  while ((ptr = primaryIndex->lookupSequential(position)) != nullptr) {
+    char const* key = TRI_EXTRACT_MARKER_KEY(ptr);
 
-      TRI_ASSERT(key != nullptr);
-      // dereference the key
-      if (*key == '\0') {
-        TRI_V8_THROW_EXCEPTION(TRI_ERROR_INTERNAL);
-      }
+    TRI_ASSERT(key != nullptr);
+    // dereference the key
+    if (*key == '\0') {
+      TRI_V8_THROW_EXCEPTION(TRI_ERROR_INTERNAL);
     }
   }
 
@@ -94,6 +94,9 @@ static void FillDistribution (v8::Isolate* isolate,
 /// Returns information about the server:
 ///
 /// - `uptime`: time since server start in seconds.
+/// - `physicalMemory`: physical memory size in bytes.
+/// - `walSyncTime`: distribution of the time commits with *waitForSync* waited
+///   for their write-ahead log data to be synced to disk, in seconds.
 ////////////////////////////////////////////////////////////////////////////////
 
 static void JS_ServerStatistics (const v8::FunctionCallbackInfo<v8::Value>& args) {
@@ -107,6 +110,12 @@ static void JS_ServerStatistics (const v8::FunctionCallbackInfo<v8::Value>& args
   result->Set(TRI_V8_ASCII_STRING("uptime"),         v8::Number::New(isolate, (double) info._uptime));
   result->Set(TRI_V8_ASCII_STRING("physicalMemory"), v8::Number::New(isolate, (double) TRI_PhysicalMemory));
 
+  StatisticsDistribution walSyncTime;
+
+  TRI_FillWalStatistics(walSyncTime);
+
+  FillDistribution(isolate, result, TRI_V8_ASCII_STRING("walSyncTime"), walSyncTime);
+
   TRI_V8_RETURN(result);
   TRI_V8_TRY_CATCH_END
 }
@@ -210,6 +219,7 @@ void TRI_InitV8Statistics (v8::Isolate* isolate,
   TRI_AddGlobalVariableVocbase(isolate, context, TRI_V8_ASCII_STRING("REQUEST_TIME_DISTRIBUTION"), DistributionList(isolate, TRI_RequestTimeDistributionVectorStatistics));
   TRI_AddGlobalVariableVocbase(isolate, context, TRI_V8_ASCII_STRING("BYTES_SENT_DISTRIBUTION"), DistributionList(isolate, TRI_BytesSentDistributionVectorStatistics));
   TRI_AddGlobalVariableVocbase(isolate, context, TRI_V8_ASCII_STRING("BYTES_RECEIVED_DISTRIBUTION"), DistributionList(isolate, TRI_BytesReceivedDistributionVectorStatistics));
+  TRI_AddGlobalVariableVocbase(isolate, context, TRI_V8_ASCII_STRING("WAL_SYNC_TIME_DISTRIBUTION"), DistributionList(isolate, TRI_WalSyncTimeDistributionVectorStatistics));
 }
 
 // -----------------------------------------------------------------------------
@@ -31,12 +31,14 @@
 
 #include "v8-vocbaseprivate.h"
 #include "Aql/Query.h"
+#include "Aql/PlanCache.h"
 #include "Aql/QueryCache.h"
 #include "Aql/QueryList.h"
 #include "Aql/QueryRegistry.h"
 #include "Basics/conversions.h"
 #include "Basics/json-utilities.h"
 #include "Basics/MutexLocker.h"
+#include "Basics/random.h"
 #include "Basics/ScopeGuard.h"
 #include "Basics/Utf8Helper.h"
 #include "Cluster/AgencyComm.h"
@@ -1210,6 +1212,9 @@ static void JS_ExecuteAqlJson (const v8::FunctionCallbackInfo<v8::Value>& args)
   if (queryResult.profile != nullptr) {
     result->ForceSet(TRI_V8_ASCII_STRING("profile"), TRI_ObjectJson(isolate, queryResult.profile));
   }
+  if (queryResult.plan != nullptr) {
+    result->ForceSet(TRI_V8_ASCII_STRING("plan"), TRI_ObjectJson(isolate, queryResult.plan));
+  }
   if (queryResult.warnings == nullptr) {
     result->ForceSet(TRI_V8_ASCII_STRING("warnings"), v8::Array::New(isolate));
   }
@@ -1311,6 +1316,9 @@ static void JS_ExecuteAql (const v8::FunctionCallbackInfo<v8::Value>& args) {
   if (queryResult.profile != nullptr) {
     result->ForceSet(TRI_V8_ASCII_STRING("profile"), TRI_ObjectJson(isolate, queryResult.profile));
   }
+  if (queryResult.plan != nullptr) {
+    result->ForceSet(TRI_V8_ASCII_STRING("plan"), TRI_ObjectJson(isolate, queryResult.plan));
+  }
   if (queryResult.warnings == nullptr) {
     result->ForceSet(TRI_V8_ASCII_STRING("warnings"), v8::Array::New(isolate));
   }
@@ -1602,6 +1610,69 @@ static void JS_QueryCacheInvalidateAql (const v8::FunctionCallbackInfo<v8::Value
   TRI_V8_TRY_CATCH_END
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief configures the AQL plan cache and returns its statistics
+////////////////////////////////////////////////////////////////////////////////
+
+static void JS_PlanCachePropertiesAql (const v8::FunctionCallbackInfo<v8::Value>& args) {
+  TRI_V8_TRY_CATCH_BEGIN(isolate);
+  v8::HandleScope scope(isolate);
+
+  TRI_vocbase_t* vocbase = GetContextVocBase(isolate);
+
+  if (vocbase == nullptr) {
+    TRI_V8_THROW_EXCEPTION(TRI_ERROR_ARANGO_DATABASE_NOT_FOUND);
+  }
+  
+  if (args.Length() > 1 || (args.Length() == 1 && ! args[0]->IsObject())) {
+    TRI_V8_THROW_EXCEPTION_USAGE("AQL_PLAN_CACHE_PROPERTIES(<properties>)");
+  }
+    
+  auto planCache = triagens::aql::PlanCache::instance();
+
+  if (args.Length() == 1) {
+    // called with options
+    auto obj = args[0]->ToObject();
+
+    if (obj->Has(TRI_V8_ASCII_STRING("maxEntries"))) {
+      int64_t maxEntries = TRI_ObjectToInt64(obj->Get(TRI_V8_ASCII_STRING("maxEntries")));
+
+      if (maxEntries < 0) {
+        TRI_V8_THROW_EXCEPTION_PARAMETER("<maxEntries> must not be negative");
+      }
+
+      planCache->setMaxEntries(static_cast<size_t>(maxEntries));
+    }
+  }
+
+  // fetch current configuration and return it
+  auto properties = planCache->properties();
+  TRI_V8_RETURN(TRI_ObjectJson(isolate, properties.json()));
+  TRI_V8_TRY_CATCH_END
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief invalidates the AQL plan cache
+////////////////////////////////////////////////////////////////////////////////
+
+static void JS_PlanCacheInvalidateAql (const v8::FunctionCallbackInfo<v8::Value>& args) {
+  TRI_V8_TRY_CATCH_BEGIN(isolate);
+  v8::HandleScope scope(isolate);
+
+  TRI_vocbase_t* vocbase = GetContextVocBase(isolate);
+
+  if (vocbase == nullptr) {
+    TRI_V8_THROW_EXCEPTION(TRI_ERROR_ARANGO_DATABASE_NOT_FOUND);
+  }
+  
+  if (args.Length() != 0) {
+    TRI_V8_THROW_EXCEPTION_USAGE("AQL_PLAN_CACHE_INVALIDATE()");
+  }
+
+  triagens::aql::PlanCache::instance()->invalidate();
+  TRI_V8_TRY_CATCH_END
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief throw collection not loaded
 ////////////////////////////////////////////////////////////////////////////////
@@ -2630,6 +2701,278 @@ static void JS_QueryNeighbors (const v8::FunctionCallbackInfo<v8::Value>& args)
   TRI_V8_TRY_CATCH_END
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Executes a centrality computation
+///
+/// computes the absolute closeness (sum of distances), eccentricity (maximum
+/// distance) or betweenness of the vertices in the given vertex collections.
+/// closeness and eccentricity are returned for the source vertices only,
+/// betweenness is returned for all vertices. if a number of samples is given
+/// for betweenness, only that many randomly chosen source vertices are used
+/// and the result is extrapolated
+////////////////////////////////////////////////////////////////////////////////
+
+static void JS_QueryCentrality (const v8::FunctionCallbackInfo<v8::Value>& args) {
+  TRI_V8_TRY_CATCH_BEGIN(isolate);
+  v8::HandleScope scope(isolate);
+
+  if (args.Length() != 4) {
+    TRI_V8_THROW_EXCEPTION_USAGE("CPP_GRAPH_CENTRALITY(<vertexcollections[]>, <edgecollections[]>, <measure>, <options>)");
+  }
+
+  // get the vertex collections
+  if (! args[0]->IsArray()) {
+    TRI_V8_THROW_TYPE_ERROR("expecting array for <vertexcollections[]>");
+  }
+  unordered_set<string> vertexCollectionNames;
+  V8ArrayToStrings(args[0], vertexCollectionNames);
+
+  // get the edge collections
+  if (! args[1]->IsArray()) {
+    TRI_V8_THROW_TYPE_ERROR("expecting array for <edgecollections[]>");
+  }
+  unordered_set<string> edgeCollectionNames;
+  V8ArrayToStrings(args[1], edgeCollectionNames);
+
+  TRI_vocbase_t* vocbase = GetContextVocBase(isolate);
+
+  if (vocbase == nullptr) {
+    TRI_V8_THROW_EXCEPTION(TRI_ERROR_ARANGO_DATABASE_NOT_FOUND);
+  }
+
+  string const measure = TRI_ObjectToString(args[2]);
+
+  if (measure != "closeness" &&
+      measure != "eccentricity" &&
+      measure != "betweenness") {
+    TRI_V8_THROW_TYPE_ERROR("expecting measure to be 'closeness', 'eccentricity' or 'betweenness'");
+  }
+
+  if (! args[3]->IsObject()) {
+    TRI_V8_THROW_TYPE_ERROR("expecting json for <options>");
+  }
+  v8::Handle<v8::Object> options = args[3]->ToObject();
+
+  traverser::CentralityOptions opts;
+  opts.computeBetweenness = (measure == "betweenness");
+
+  // Parse direction
+  v8::Local<v8::String> keyDirection = TRI_V8_ASCII_STRING("direction");
+  if (options->Has(keyDirection)) {
+    string dir = TRI_ObjectToString(options->Get(keyDirection));
+    if (dir == "outbound") {
+      opts.direction = TRI_EDGE_OUT;
+    } 
+    else if (dir == "inbound") {
+      opts.direction = TRI_EDGE_IN;
+    } 
+    else if (dir == "any") {
+      opts.direction = TRI_EDGE_ANY;
+    } 
+    else {
+      TRI_V8_THROW_TYPE_ERROR("expecting direction to be 'outbound', 'inbound' or 'any'");
+    }
+  }
+
+  // Parse Distance. edges without the weight attribute cannot be used
+  // unless a default weight is given
+  bool useWeight = false;
+  string weightAttribute;
+  double defaultWeight = HUGE_VAL;
+  v8::Local<v8::String> keyWeight = TRI_V8_ASCII_STRING("weight");
+  v8::Local<v8::String> keyDefaultWeight = TRI_V8_ASCII_STRING("defaultWeight");
+  if (options->Has(keyWeight)) {
+    useWeight = true;
+    weightAttribute = TRI_ObjectToString(options->Get(keyWeight));
+    if (options->Has(keyDefaultWeight)) {
+      defaultWeight = TRI_ObjectToDouble(options->Get(keyDefaultWeight));
+    }
+  }
+
+  // Parse threads
+  v8::Local<v8::String> keyThreads = TRI_V8_ASCII_STRING("threads");
+  if (options->Has(keyThreads)) {
+    opts.numberThreads = static_cast<size_t>(TRI_ObjectToUInt64(options->Get(keyThreads), false));
+  }
+  if (opts.numberThreads == 0) {
+    opts.numberThreads = 1;
+  }
+
+  // Parse samples
+  size_t samples = 0;
+  v8::Local<v8::String> keySamples = TRI_V8_ASCII_STRING("samples");
+  if (opts.computeBetweenness && options->Has(keySamples)) {
+    samples = static_cast<size_t>(TRI_ObjectToUInt64(options->Get(keySamples), false));
+  }
+
+  // Parse sources
+  bool useSources = false;
+  vector<string> sourceIds;
+  v8::Local<v8::String> keySources = TRI_V8_ASCII_STRING("sources");
+  if (! opts.computeBetweenness && options->Has(keySources)) {
+    if (! options->Get(keySources)->IsArray()) {
+      TRI_V8_THROW_TYPE_ERROR("expecting array of IDs for <sources>");
+    }
+    useSources = true;
+    auto list = v8::Handle<v8::Array>::Cast(options->Get(keySources));
+    for (uint32_t i = 0; i < list->Length(); i++) {
+      if (! list->Get(i)->IsString()) {
+        TRI_V8_THROW_TYPE_ERROR("expecting array of IDs for <sources>");
+      }
+      sourceIds.emplace_back(TRI_ObjectToString(list->Get(i)));
+    }
+  }
+
+  vector<TRI_voc_cid_t> readCollections;
+  vector<TRI_voc_cid_t> writeCollections;
+
+  V8ResolverGuard resolverGuard(vocbase);
+
+  int res = TRI_ERROR_NO_ERROR;
+  CollectionNameResolver const* resolver = resolverGuard.getResolver();
+
+  for (auto const& it : edgeCollectionNames) {
+    readCollections.emplace_back(resolver->getCollectionId(it));
+  }
+  for (auto const& it : vertexCollectionNames) {
+    readCollections.emplace_back(resolver->getCollectionId(it));
+  }
+
+  unordered_map<TRI_voc_cid_t, CollectionDitchInfo> ditches;
+  // Start the transaction
+  std::unique_ptr<ExplicitTransaction> trx;
+  try {
+    trx.reset(BeginTransaction(vocbase, readCollections,
+                               writeCollections, resolver, ditches));
+  } catch (Exception& e) {
+    TRI_V8_THROW_EXCEPTION(e.code());
+  }
+  
+  vector<EdgeCollectionInfo*> edgeCollectionInfos;
+  
+  triagens::basics::ScopeGuard guard{
+    []() -> void { },
+    [&edgeCollectionInfos]() -> void {
+      for (auto& p : edgeCollectionInfos) {
+        delete p;
+      }
+    }
+  };
+
+  for (auto const& it : edgeCollectionNames) {
+    auto cid = resolver->getCollectionId(it);
+    auto colObj = ditches.find(cid)->second.col->_collection->_collection;
+    if (useWeight) {
+      edgeCollectionInfos.emplace_back(new EdgeCollectionInfo(
+        cid,
+        colObj,
+        AttributeWeightCalculator(weightAttribute, defaultWeight, colObj->getShaper())
+      ));
+    }
+    else {
+      edgeCollectionInfos.emplace_back(new EdgeCollectionInfo(
+        cid,
+        colObj,
+        HopWeightCalculator()
+      ));
+    }
+  }
+
+  // collect all vertices. the keys must stay valid until the end of the
+  // computation, as the vertex ids point into them
+  vector<pair<TRI_voc_cid_t, vector<string>>> keys;
+  keys.reserve(vertexCollectionNames.size());
+  size_t n = 0;
+
+  for (auto const& it : vertexCollectionNames) {
+    auto cid = resolver->getCollectionId(it);
+    keys.emplace_back(cid, vector<string>());
+    res = trx->readAllKeys(ditches.find(cid)->second.col, keys.back().second);
+
+    if (res != TRI_ERROR_NO_ERROR) {
+      trx->finish(res);
+      TRI_V8_THROW_EXCEPTION(res);
+    }
+    n += keys.back().second.size();
+  }
+
+  vector<VertexId> vertices;
+  vector<string> ids;
+  vertices.reserve(n);
+  ids.reserve(n);
+
+  for (auto const& it : keys) {
+    string const prefix = resolver->getCollectionName(it.first) + "/";
+    for (auto const& key : it.second) {
+      vertices.emplace_back(it.first, key.c_str());
+      ids.emplace_back(prefix + key);
+    }
+  }
+
+  vector<size_t> sources;
+
+  if (useSources) {
+    unordered_map<string, size_t> positions;
+    positions.reserve(n);
+    for (size_t i = 0; i < n; ++i) {
+      positions.emplace(ids[i], i);
+    }
+    for (auto const& it : sourceIds) {
+      auto found = positions.find(it);
+      if (found != positions.end()) {
+        sources.emplace_back(found->second);
+      }
+    }
+  }
+  else {
+    sources.reserve(n);
+    for (size_t i = 0; i < n; ++i) {
+      sources.emplace_back(i);
+    }
+  }
+
+  double scale = 1.0;
+
+  if (samples > 0 && samples < sources.size()) {
+    // partial Fisher-Yates shuffle to pick the sampled sources
+    for (size_t i = 0; i < samples; ++i) {
+      size_t j = i + static_cast<size_t>(TRI_UInt32Random()) % (sources.size() - i);
+      std::swap(sources[i], sources[j]);
+    }
+    scale = static_cast<double>(sources.size()) / static_cast<double>(samples);
+    sources.resize(samples);
+  }
+
+  CentralityResult centrality;
+
+  try {
+    TRI_RunCentralitySearch(edgeCollectionInfos, vertices, sources, opts, centrality);
+  }
+  catch (Exception& e) {
+    trx->finish(e.code());
+    TRI_V8_THROW_EXCEPTION(e.code());
+  }
+
+  trx->finish(res);
+
+  v8::Handle<v8::Object> result = v8::Object::New(isolate);
+
+  if (opts.computeBetweenness) {
+    for (size_t i = 0; i < n; ++i) {
+      result->ForceSet(TRI_V8_STD_STRING(ids[i]), v8::Number::New(isolate, centrality.betweenness[i] * scale));
+    }
+  }
+  else {
+    auto const& values = (measure == "closeness" ? centrality.distanceSums : centrality.maxDistances);
+    for (auto const& it : sources) {
+      result->ForceSet(TRI_V8_STD_STRING(ids[it]), v8::Number::New(isolate, values[it]));
+    }
+  }
+
+  TRI_V8_RETURN(result);
+  TRI_V8_TRY_CATCH_END
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief sleeps and checks for query abortion in between
 ////////////////////////////////////////////////////////////////////////////////
@@ -3873,11 +4216,14 @@ void TRI_InitV8VocBridge (v8::Isolate* isolate,
   TRI_AddGlobalFunctionVocbase(isolate, context, TRI_V8_ASCII_STRING("AQL_QUERY_IS_KILLED"), JS_QueryIsKilledAql, true);
   TRI_AddGlobalFunctionVocbase(isolate, context, TRI_V8_ASCII_STRING("AQL_QUERY_CACHE_PROPERTIES"), JS_QueryCachePropertiesAql, true);
   TRI_AddGlobalFunctionVocbase(isolate, context, TRI_V8_ASCII_STRING("AQL_QUERY_CACHE_INVALIDATE"), JS_QueryCacheInvalidateAql, true);
+  TRI_AddGlobalFunctionVocbase(isolate, context, TRI_V8_ASCII_STRING("AQL_PLAN_CACHE_PROPERTIES"), JS_PlanCachePropertiesAql, true);
+  TRI_AddGlobalFunctionVocbase(isolate, context, TRI_V8_ASCII_STRING("AQL_PLAN_CACHE_INVALIDATE"), JS_PlanCacheInvalidateAql, true);
 
   TRI_AddGlobalFunctionVocbase(isolate, context, TRI_V8_ASCII_STRING("THROW_COLLECTION_NOT_LOADED"), JS_ThrowCollectionNotLoaded, true);
 
   TRI_AddGlobalFunctionVocbase(isolate, context, TRI_V8_ASCII_STRING("CPP_SHORTEST_PATH"), JS_QueryShortestPath, true);
   TRI_AddGlobalFunctionVocbase(isolate, context, TRI_V8_ASCII_STRING("CPP_NEIGHBORS"), JS_QueryNeighbors, true);
+  TRI_AddGlobalFunctionVocbase(isolate, context, TRI_V8_ASCII_STRING("CPP_GRAPH_CENTRALITY"), JS_QueryCentrality, true);
 
 
   TRI_InitV8Replication(isolate, context, server, vocbase, loader, threadNumber, v8g);
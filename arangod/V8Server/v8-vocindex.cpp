@@ -1047,6 +1047,7 @@ static void CreateCollectionCoordinator (const v8::FunctionCallbackInfo<v8::Valu
   TRI_Insert3ObjectJson(TRI_UNKNOWN_MEM_ZONE, json, "waitForSync", TRI_CreateBooleanJson(TRI_UNKNOWN_MEM_ZONE, parameters._waitForSync));
   TRI_Insert3ObjectJson(TRI_UNKNOWN_MEM_ZONE, json, "journalSize", TRI_CreateNumberJson(TRI_UNKNOWN_MEM_ZONE, parameters._maximalSize));
   TRI_Insert3ObjectJson(TRI_UNKNOWN_MEM_ZONE, json, "indexBuckets", TRI_CreateNumberJson(TRI_UNKNOWN_MEM_ZONE, parameters._indexBuckets));
+  TRI_Insert3ObjectJson(TRI_UNKNOWN_MEM_ZONE, json, "compressDocuments", TRI_CreateBooleanJson(TRI_UNKNOWN_MEM_ZONE, parameters._compressDocuments));
 
   TRI_json_t* keyOptions = TRI_CreateObjectJson(TRI_UNKNOWN_MEM_ZONE);
   if (keyOptions != nullptr) {
@@ -1621,6 +1622,10 @@ static void CreateVocBase (const v8::FunctionCallbackInfo<v8::Value>& args,
         TRI_V8_THROW_EXCEPTION_PARAMETER("indexBuckets must be a two-power between 1 and 1024");
       }
     }
+
+    if (p->Has(TRI_V8_ASCII_STRING("compressDocuments"))) {
+      parameters._compressDocuments = TRI_ObjectToBoolean(p->Get(TRI_V8_ASCII_STRING("compressDocuments")));
+    }
   }
   else {
     TRI_InitCollectionInfo(vocbase, &parameters, name.c_str(), collectionType, effectiveSize, nullptr);
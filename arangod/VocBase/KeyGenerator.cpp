@@ -294,6 +294,14 @@ int TraditionalKeyGenerator::validate (std::string const& key,
 void TraditionalKeyGenerator::track (TRI_voc_key_t) {
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief return the highest numeric key value tracked so far
+////////////////////////////////////////////////////////////////////////////////
+
+uint64_t TraditionalKeyGenerator::lastValue () const {
+  return 0;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief create a JSON representation of the generator
 ////////////////////////////////////////////////////////////////////////////////
@@ -445,6 +453,14 @@ void AutoIncrementKeyGenerator::track (TRI_voc_key_t key) {
   }
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief return the highest numeric key value tracked so far
+////////////////////////////////////////////////////////////////////////////////
+
+uint64_t AutoIncrementKeyGenerator::lastValue () const {
+  return _lastValue;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief create a JSON representation of the generator
 ////////////////////////////////////////////////////////////////////////////////
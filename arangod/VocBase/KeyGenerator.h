@@ -140,6 +140,13 @@ class KeyGenerator {
 
     virtual void track (TRI_voc_key_t) = 0;
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief return the highest numeric key value tracked so far, or 0 if the
+/// generator does not track keys
+////////////////////////////////////////////////////////////////////////////////
+
+    virtual uint64_t lastValue () const = 0;
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief return a JSON representation of the generator
 ////////////////////////////////////////////////////////////////////////////////
@@ -231,6 +238,12 @@ class TraditionalKeyGenerator : public KeyGenerator {
 
     void track (TRI_voc_key_t) override;
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief return the highest numeric key value tracked so far
+////////////////////////////////////////////////////////////////////////////////
+
+    uint64_t lastValue () const override;
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief return the generator name
 ////////////////////////////////////////////////////////////////////////////////
@@ -309,6 +322,12 @@ class AutoIncrementKeyGenerator : public KeyGenerator {
 
     void track (TRI_voc_key_t) override;
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief return the highest numeric key value tracked so far
+////////////////////////////////////////////////////////////////////////////////
+
+    uint64_t lastValue () const override;
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief return the generator name
 ////////////////////////////////////////////////////////////////////////////////
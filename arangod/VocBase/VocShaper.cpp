@@ -924,6 +924,42 @@ int VocShaper::insertAttribute (TRI_df_marker_t const* marker,
   return TRI_ERROR_NO_ERROR;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief returns the shape and attribute markers of the shaper
+////////////////////////////////////////////////////////////////////////////////
+
+std::vector<TRI_df_marker_t const*> VocShaper::markers () {
+  std::vector<TRI_df_marker_t const*> result;
+
+  {
+    READ_LOCKER(_shapeIdsLock);
+    result.reserve(static_cast<size_t>(_shapeIds._nrUsed));
+
+    for (size_t i = 0; i < _shapeIds._nrAlloc; ++i) {
+      char const* shape = static_cast<char const*>(_shapeIds._table[i]);
+
+      if (shape != nullptr) {
+        result.emplace_back(reinterpret_cast<TRI_df_marker_t const*>(shape - sizeof(TRI_df_shape_marker_t)));
+      }
+    }
+  }
+
+  {
+    READ_LOCKER(_attributeIdsLock);
+    result.reserve(result.size() + static_cast<size_t>(_attributeIds._nrUsed));
+
+    for (size_t i = 0; i < _attributeIds._nrAlloc; ++i) {
+      auto marker = static_cast<TRI_df_marker_t const*>(_attributeIds._table[i]);
+
+      if (marker != nullptr) {
+        result.emplace_back(marker);
+      }
+    }
+  }
+
+  return result;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief finds an accessor
 ////////////////////////////////////////////////////////////////////////////////
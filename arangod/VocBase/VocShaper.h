@@ -32,6 +32,7 @@
 #define ARANGODB_VOC_BASE_VOC_SHAPER_H 1
 
 #include "Basics/Common.h"
+#include "VocBase/compressed-json.h"
 #include "VocBase/datafile.h"
 #include "VocBase/document-collection.h"
 #include "VocBase/shape-accessor.h"
@@ -155,6 +156,13 @@ class VocShaper : public Shaper {
     int insertAttribute (TRI_df_marker_t const*,
                          bool);
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief returns the shape and attribute markers of the shaper, called when
+/// writing an index snapshot. shape markers are assumed to be datafile markers
+////////////////////////////////////////////////////////////////////////////////
+
+    std::vector<TRI_df_marker_t const*> markers ();
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief finds an accessor
 ////////////////////////////////////////////////////////////////////////////////
@@ -283,11 +291,18 @@ static inline void TRI_EXTRACT_SHAPED_JSON_MARKER (TRI_shaped_json_t& dst,
 
   if (type == TRI_DOC_MARKER_KEY_DOCUMENT ||
       type == TRI_DOC_MARKER_KEY_EDGE) {
-    dst._sid = static_cast<TRI_doc_document_key_marker_t const*>(src)->_shape;
-    dst._data.length = static_cast<TRI_df_marker_t const*>(src)->_size
-      - static_cast<TRI_doc_document_key_marker_t const*>(src)->_offsetJson;
-    dst._data.data = const_cast<char*>(static_cast<char const*>(src))
-      + static_cast<TRI_doc_document_key_marker_t const*>(src)->_offsetJson;
+    auto m = static_cast<TRI_doc_document_key_marker_t const*>(src);
+    dst._sid = m->_shape;
+
+    if (TRI_IsCompressedJsonMarker(m)) {
+      size_t length;
+      dst._data.data = const_cast<char*>(TRI_UncompressedJsonMarker(m, length));
+      dst._data.length = static_cast<uint32_t>(length);
+    }
+    else {
+      dst._data.length = m->base._size - m->_offsetJson;
+      dst._data.data = const_cast<char*>(static_cast<char const*>(src)) + m->_offsetJson;
+    }
   }
   else if (type == TRI_WAL_MARKER_DOCUMENT) {
     dst._sid = static_cast<triagens::wal::document_marker_t const*>(src)->_shape;
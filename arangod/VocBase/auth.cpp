@@ -422,25 +422,17 @@ bool TRI_LoadAuthInfo (TRI_vocbase_t* vocbase) {
   TRI_WriteLockReadWriteLock(&vocbase->_authInfoLock);
   ClearAuthInfo(vocbase);
 
-  auto primaryIndex = document->primaryIndex()->internals();
+  document->primaryIndex()->invokeOnAllElements([&vocbase, &document] (TRI_doc_mptr_t* ptr) -> void {
+    TRI_vocbase_auth_t* auth = ConvertAuthInfo(vocbase, document, ptr);
 
-  void** beg = primaryIndex->_table;
-  void** end = beg + primaryIndex->_nrAlloc;
-  void** ptr = beg;
-
-  for (;  ptr < end;  ++ptr) {
-    if (*ptr) {
-      TRI_vocbase_auth_t* auth = ConvertAuthInfo(vocbase, document, (TRI_doc_mptr_t const*) *ptr);
+    if (auth != nullptr) {
+      TRI_vocbase_auth_t* old = static_cast<TRI_vocbase_auth_t*>(TRI_InsertKeyAssociativePointer(&vocbase->_authInfo, auth->_username, auth, true));
 
-      if (auth != nullptr) {
-        TRI_vocbase_auth_t* old = static_cast<TRI_vocbase_auth_t*>(TRI_InsertKeyAssociativePointer(&vocbase->_authInfo, auth->_username, auth, true));
-
-        if (old != nullptr) {
-          FreeAuthInfo(old);
-        }
+      if (old != nullptr) {
+        FreeAuthInfo(old);
       }
     }
-  }
+  });
 
   TRI_WriteUnlockReadWriteLock(&vocbase->_authInfoLock);
 
@@ -31,11 +31,13 @@
 
 #include <regex.h>
 
+#include "Basics/Barrier.h"
 #include "Basics/conversions.h"
 #include "Basics/files.h"
 #include "Basics/json.h"
 #include "Basics/JsonHelper.h"
 #include "Basics/logging.h"
+#include "Basics/ThreadPool.h"
 #include "Basics/tri-strings.h"
 #include "VocBase/document-collection.h"
 #include "VocBase/server.h"
@@ -407,6 +409,84 @@ static TRI_col_file_structure_t ScanCollectionDirectory (char const* path) {
   return structure;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief opens the datafiles with the given filenames
+///
+/// opening a datafile scans all of its markers and verifies their checksums.
+/// the datafiles are independent of each other, so they are opened using the
+/// index thread pool plus the current thread. the datafile for each filename
+/// is returned at the same position in datafiles, or a nullptr and the error
+/// code in errors if it could not be opened
+////////////////////////////////////////////////////////////////////////////////
+
+static void OpenDatafiles (TRI_collection_t* collection,
+                           std::vector<char*> const& filenames,
+                           bool ignoreErrors,
+                           std::vector<TRI_datafile_t*>& datafiles,
+                           std::vector<int>& errors) {
+  datafiles.assign(filenames.size(), nullptr);
+  errors.assign(filenames.size(), TRI_ERROR_NO_ERROR);
+
+  if (filenames.empty()) {
+    return;
+  }
+
+  triagens::basics::ThreadPool* indexPool = nullptr;
+
+  if (collection->_vocbase != nullptr &&
+      collection->_vocbase->_server != nullptr) {
+    indexPool = collection->_vocbase->_server->_indexPool;
+  }
+
+  size_t numThreads = 0;
+
+  if (indexPool != nullptr) {
+    numThreads = (std::min)(indexPool->numThreads(), filenames.size() - 1);
+  }
+
+  std::atomic<size_t> next(0);
+
+  auto opener = [&filenames, &datafiles, &errors, &next, &ignoreErrors] () -> void {
+    while (true) {
+      size_t const i = next++;
+
+      if (i >= filenames.size()) {
+        break;
+      }
+
+      datafiles[i] = TRI_OpenDatafile(filenames[i], ignoreErrors);
+
+      if (datafiles[i] == nullptr) {
+        // the error number is thread-local
+        errors[i] = TRI_errno();
+
+        if (errors[i] == TRI_ERROR_NO_ERROR) {
+          errors[i] = TRI_ERROR_ARANGO_DATAFILE_UNREADABLE;
+        }
+      }
+    }
+  };
+
+  triagens::basics::Barrier barrier(numThreads);
+
+  for (size_t i = 0; i < numThreads; ++i) {
+    try {
+      indexPool->enqueue([&opener, &barrier] () -> void {
+        opener();
+        barrier.join();
+      });
+    }
+    catch (...) {
+      // this thread will pick up the work
+      barrier.join();
+    }
+  }
+
+  opener();
+
+  // barrier waits here until all threads have joined
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief checks a collection
 ///
@@ -422,6 +502,8 @@ static bool CheckCollection (TRI_collection_t* collection,
   TRI_vector_pointer_t journals;
   TRI_vector_pointer_t sealed;
   TRI_vector_string_t files;
+  std::vector<char*> filenames;
+  std::vector<std::string> types;
   bool stop;
   regex_t re;
   size_t i, n;
@@ -483,13 +565,11 @@ static bool CheckCollection (TRI_collection_t* collection,
       }
 
       // .............................................................................
-      // file is a journal or datafile, open the datafile
+      // file is a journal or datafile, remember the datafile
       // .............................................................................
 
       else if (TRI_EqualString2("db", third, thirdLen)) {
         char* filename;
-        char* ptr;
-        TRI_col_header_marker_t* cm;
 
         if (TRI_EqualString2("compaction", first, firstLen)) {
           // found a compaction file. now rename it back
@@ -534,95 +614,116 @@ static bool CheckCollection (TRI_collection_t* collection,
         }
 
         TRI_ASSERT(filename != nullptr);
-        datafile = TRI_OpenDatafile(filename, ignoreErrors);
 
-        if (datafile == nullptr) {
-          collection->_lastError = TRI_errno();
-          LOG_ERROR("cannot open datafile '%s': %s", filename, TRI_last_error());
+        // the datafiles are opened below, all at once
+        filenames.emplace_back(filename);
+        types.emplace_back(first, firstLen);
+      }
+      else {
+        LOG_ERROR("unknown datafile '%s'", file);
+      }
+    }
+  }
 
-          TRI_FreeString(TRI_CORE_MEM_ZONE, filename);
-          stop = true;
-          break;
-        }
+  TRI_DestroyVectorString(&files);
 
-        TRI_PushBackVectorPointer(&all, datafile);
+  regfree(&re);
 
-        // check the document header
-        ptr  = datafile->_data;
-        // skip the datafile header
-        ptr += TRI_DF_ALIGN_BLOCK(sizeof(TRI_df_header_marker_t));
-        cm   = (TRI_col_header_marker_t*) ptr;
+  // open the datafiles, then check them in the order of the directory listing
+  std::vector<TRI_datafile_t*> opened;
+  std::vector<int> errors;
 
-        if (cm->base._type != TRI_COL_MARKER_HEADER) {
-          LOG_ERROR("collection header mismatch in file '%s', expected TRI_COL_MARKER_HEADER, found %lu",
-                    filename,
-                    (unsigned long) cm->base._type);
+  if (! stop) {
+    OpenDatafiles(collection, filenames, ignoreErrors, opened, errors);
+  }
 
-          TRI_FreeString(TRI_CORE_MEM_ZONE, filename);
-          stop = true;
-          break;
-        }
+  for (i = 0;  i < opened.size();  ++i) {
+    if (opened[i] != nullptr) {
+      TRI_PushBackVectorPointer(&all, opened[i]);
+    }
+  }
 
-        if (cm->_cid != collection->_info._cid) {
-          LOG_ERROR("collection identifier mismatch, expected %llu, found %llu",
-                    (unsigned long long) collection->_info._cid,
-                    (unsigned long long) cm->_cid);
+  for (i = 0;  i < opened.size();  ++i) {
+    char const* filename = filenames[i];
+    std::string const& type = types[i];
+    char* ptr;
+    TRI_col_header_marker_t* cm;
 
-          TRI_FreeString(TRI_CORE_MEM_ZONE, filename);
-          stop = true;
-          break;
-        }
+    datafile = opened[i];
 
-        // file is a journal
-        if (TRI_EqualString2("journal", first, firstLen)) {
-          if (datafile->_isSealed) {
-            if (datafile->_state != TRI_DF_STATE_READ) {
-              LOG_WARNING("strange, journal '%s' is already sealed; must be a left over; will use it as datafile", filename);
-            }
+    if (datafile == nullptr) {
+      collection->_lastError = TRI_set_errno(errors[i]);
+      LOG_ERROR("cannot open datafile '%s': %s", filename, TRI_last_error());
 
-            TRI_PushBackVectorPointer(&sealed, datafile);
-          }
-          else {
-            TRI_PushBackVectorPointer(&journals, datafile);
-          }
-        }
+      stop = true;
+      break;
+    }
 
-        // file is a compactor
-        else if (TRI_EqualString2("compactor", first, firstLen)) {
-          // ignore
-        }
+    // check the document header
+    ptr  = datafile->_data;
+    // skip the datafile header
+    ptr += TRI_DF_ALIGN_BLOCK(sizeof(TRI_df_header_marker_t));
+    cm   = (TRI_col_header_marker_t*) ptr;
 
-        // file is a datafile (or was a compaction file)
-        else if (TRI_EqualString2("datafile", first, firstLen) ||
-                 TRI_EqualString2("compaction", first, firstLen)) {
-          if (! datafile->_isSealed) {
-            LOG_ERROR("datafile '%s' is not sealed, this should never happen", filename);
+    if (cm->base._type != TRI_COL_MARKER_HEADER) {
+      LOG_ERROR("collection header mismatch in file '%s', expected TRI_COL_MARKER_HEADER, found %lu",
+                filename,
+                (unsigned long) cm->base._type);
 
-            collection->_lastError = TRI_set_errno(TRI_ERROR_ARANGO_CORRUPTED_DATAFILE);
-            TRI_FreeString(TRI_CORE_MEM_ZONE, filename);
-            stop = true;
-            break;
-          }
-          else {
-            TRI_PushBackVectorPointer(&datafiles, datafile);
-          }
-        }
+      stop = true;
+      break;
+    }
 
-        else {
-          LOG_ERROR("unknown datafile '%s'", file);
+    if (cm->_cid != collection->_info._cid) {
+      LOG_ERROR("collection identifier mismatch, expected %llu, found %llu",
+                (unsigned long long) collection->_info._cid,
+                (unsigned long long) cm->_cid);
+
+      stop = true;
+      break;
+    }
+
+    // file is a journal
+    if (type == "journal") {
+      if (datafile->_isSealed) {
+        if (datafile->_state != TRI_DF_STATE_READ) {
+          LOG_WARNING("strange, journal '%s' is already sealed; must be a left over; will use it as datafile", filename);
         }
 
-        TRI_FreeString(TRI_CORE_MEM_ZONE, filename);
+        TRI_PushBackVectorPointer(&sealed, datafile);
       }
       else {
-        LOG_ERROR("unknown datafile '%s'", file);
+        TRI_PushBackVectorPointer(&journals, datafile);
       }
     }
-  }
 
-  TRI_DestroyVectorString(&files);
+    // file is a compactor
+    else if (type == "compactor") {
+      // ignore
+    }
 
-  regfree(&re);
+    // file is a datafile (or was a compaction file)
+    else if (type == "datafile" || type == "compaction") {
+      if (! datafile->_isSealed) {
+        LOG_ERROR("datafile '%s' is not sealed, this should never happen", filename);
+
+        collection->_lastError = TRI_set_errno(TRI_ERROR_ARANGO_CORRUPTED_DATAFILE);
+        stop = true;
+        break;
+      }
+      else {
+        TRI_PushBackVectorPointer(&datafiles, datafile);
+      }
+    }
+
+    else {
+      LOG_ERROR("unknown datafile '%s'", filename);
+    }
+  }
+
+  for (auto& filename : filenames) {
+    TRI_FreeString(TRI_CORE_MEM_ZONE, filename);
+  }
 
   // convert the sealed journals into datafiles
   if (! stop) {
@@ -866,6 +967,9 @@ static void FillParametersFromJson (TRI_col_info_t* parameters,
       else if (TRI_EqualString(key->_value._string.data, "waitForSync")) {
         parameters->_waitForSync = value->_value._boolean;
       }
+      else if (TRI_EqualString(key->_value._string.data, "compressDocuments")) {
+        parameters->_compressDocuments = value->_value._boolean;
+      }
     }
     else if (value->_type == TRI_JSON_OBJECT) {
       if (TRI_EqualString(key->_value._string.data, "keyOptions")) {
@@ -921,6 +1025,7 @@ void TRI_InitCollectionInfo (TRI_vocbase_t* vocbase,
   parameters->_isVolatile    = false;
   parameters->_isSystem      = false;
   parameters->_waitForSync   = vocbase->_settings.defaultWaitForSync;
+  parameters->_compressDocuments = false;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -964,6 +1069,7 @@ void TRI_CopyCollectionInfo (TRI_col_info_t* dst,
   dst->_isSystem      = src->_isSystem;
   dst->_isVolatile    = src->_isVolatile;
   dst->_waitForSync   = src->_waitForSync;
+  dst->_compressDocuments = src->_compressDocuments;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -1343,6 +1449,7 @@ TRI_json_t* TRI_CreateJsonCollectionInfo (TRI_col_info_t const* info) {
   TRI_Insert3ObjectJson(TRI_CORE_MEM_ZONE, json, "name",         TRI_CreateStringCopyJson(TRI_CORE_MEM_ZONE, info->_name, strlen(info->_name)));
   TRI_Insert3ObjectJson(TRI_CORE_MEM_ZONE, json, "isVolatile",   TRI_CreateBooleanJson(TRI_CORE_MEM_ZONE, info->_isVolatile));
   TRI_Insert3ObjectJson(TRI_CORE_MEM_ZONE, json, "waitForSync",  TRI_CreateBooleanJson(TRI_CORE_MEM_ZONE, info->_waitForSync));
+  TRI_Insert3ObjectJson(TRI_CORE_MEM_ZONE, json, "compressDocuments", TRI_CreateBooleanJson(TRI_CORE_MEM_ZONE, info->_compressDocuments));
 
   if (info->_keyOptions != nullptr) {
     TRI_Insert3ObjectJson(TRI_CORE_MEM_ZONE, json, "keyOptions", TRI_CopyJson(TRI_CORE_MEM_ZONE, info->_keyOptions));
@@ -1470,6 +1577,7 @@ int TRI_UpdateCollectionInfo (TRI_vocbase_t* vocbase,
     collection->_info._maximalSize = parameters->_maximalSize;
     collection->_info._waitForSync = parameters->_waitForSync;
     collection->_info._indexBuckets = parameters->_indexBuckets;
+    collection->_info._compressDocuments = parameters->_compressDocuments;
 
     // the following collection properties are intentionally not updated as updating
     // them would be very complicated:
@@ -1806,7 +1914,9 @@ int TRI_UpgradeCollection20 (TRI_vocbase_t* vocbase,
 
         // datafile header
         TRI_InitMarkerDatafile((char*) &header, TRI_DF_MARKER_HEADER, sizeof(TRI_df_header_marker_t));
-        header._version     = TRI_DF_VERSION;
+        // the shape markers are copied verbatim from the old datafiles, so
+        // the new datafile must use the old checksum algorithm, too
+        header._version     = TRI_DF_VERSION_CRC32;
         header._maximalSize = 0; // TODO: seems ok to set this to 0, check if this is ok
         header._fid         = tick;
         header.base._tick   = tick;
@@ -192,6 +192,7 @@ typedef struct TRI_col_info_s {
   bool               _isSystem;        // if true, this is a system collection
   bool               _isVolatile;      // if true, collection is memory-only
   bool               _waitForSync;     // if true, wait for msync
+  bool               _compressDocuments; // if true, document bodies in datafiles are compressed
 }
 TRI_col_info_t;
 
@@ -33,9 +33,14 @@
 
 #include "compactor.h"
 
+#include "Basics/ConditionLocker.h"
 #include "Basics/conversions.h"
 #include "Basics/files.h"
 #include "Basics/logging.h"
+#include "Basics/memory-map.h"
+#include "Basics/MutexLocker.h"
+#include "Basics/RateLimiter.h"
+#include "Basics/ThreadPool.h"
 #include "Basics/tri-strings.h"
 #include "Utils/transactions.h"
 #include "VocBase/document-collection.h"
@@ -106,6 +111,13 @@
 
 static int const COMPACTOR_INTERVAL = (1 * 1000 * 1000);
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief number of bytes written into a compactor file after which the
+/// compaction is throttled, if a write rate limit is configured
+////////////////////////////////////////////////////////////////////////////////
+
+#define COMPACTOR_THROTTLE_SIZE (256 * 1024)
+
 // -----------------------------------------------------------------------------
 // --SECTION--                                                     private types
 // -----------------------------------------------------------------------------
@@ -140,7 +152,10 @@ compaction_initial_context_t;
 typedef struct compaction_context_s {
   TRI_document_collection_t* _document;
   TRI_datafile_t*            _compactor;
+  uint32_t                   _fidIndex;
   TRI_doc_datafile_info_t    _dfi;
+  TRI_voc_size_t             _throttledSize;
+  bool                       _throttled;
   bool                       _keepDeletions;
 }
 compaction_context_t;
@@ -155,6 +170,49 @@ typedef struct compaction_info_s {
 }
 compaction_info_t;
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief the candidates a database's compactor thread has handed out, and
+/// the number of these that have not been compacted yet
+////////////////////////////////////////////////////////////////////////////////
+
+typedef struct compaction_round_s {
+  TRI_vocbase_t*                      _vocbase;
+  double                              _now;
+  triagens::basics::ConditionVariable _condition;
+  size_t                              _pending;
+  int                                 _numCompacted;
+}
+compaction_round_t;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief collection that may be compacted, with its compaction priority
+////////////////////////////////////////////////////////////////////////////////
+
+typedef struct compaction_candidate_s {
+  TRI_vocbase_col_t*  _collection;
+  compaction_round_t* _round;
+  double              _deadShare;
+  int64_t             _sizeDead;
+}
+compaction_candidate_t;
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                 private variables
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief protects the server-wide compaction candidates
+////////////////////////////////////////////////////////////////////////////////
+
+static triagens::basics::Mutex CandidatesLock;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief candidates of all databases that wait for a compactor thread, as a
+/// heap with the most urgent candidate at the front
+////////////////////////////////////////////////////////////////////////////////
+
+static std::vector<compaction_candidate_t> Candidates;
+
 // -----------------------------------------------------------------------------
 // --SECTION--                                                 private functions
 // -----------------------------------------------------------------------------
@@ -167,6 +225,43 @@ static inline int64_t AlignedSize (TRI_df_marker_t const* marker) {
   return static_cast<int64_t>(TRI_DF_ALIGN_BLOCK(marker->_size));
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief whether compactions are throttled at all
+////////////////////////////////////////////////////////////////////////////////
+
+static bool IsCompactionThrottled (TRI_document_collection_t* document) {
+  TRI_vocbase_t* vocbase = document->_vocbase;
+
+  return (vocbase != nullptr &&
+          vocbase->_server != nullptr &&
+          vocbase->_server->_compactorRateLimiter != nullptr &&
+          vocbase->_server->_compactorRateLimiter->rate() > 0);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief throttle the compaction after the specified number of bytes have
+/// been written. this must not be called while holding any collection locks
+////////////////////////////////////////////////////////////////////////////////
+
+static void ThrottleCompaction (TRI_document_collection_t* document,
+                                uint64_t written) {
+  TRI_vocbase_t* vocbase = document->_vocbase;
+
+  if (vocbase == nullptr || 
+      vocbase->_server == nullptr ||
+      vocbase->_server->_compactorRateLimiter == nullptr) {
+    return;
+  }
+
+  uint64_t waitTime = vocbase->_server->_compactorRateLimiter->consume(written);
+
+  if (waitTime > 0) {
+    LOG_TRACE("throttled compaction of collection '%llu' for %llu us",
+              (unsigned long long) document->_info._cid,
+              (unsigned long long) waitTime);
+  }
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief creates a compactor file, based on a datafile
 ////////////////////////////////////////////////////////////////////////////////
@@ -200,10 +295,14 @@ static TRI_datafile_t* CreateCompactor (TRI_document_collection_t* document,
 
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief write a copy of the marker into the datafile
+///
+/// markers from datafiles of an older version are re-checksummed with the
+/// algorithm of the compactor file
 ////////////////////////////////////////////////////////////////////////////////
 
 static int CopyMarker (TRI_document_collection_t* document,
                        TRI_datafile_t* compactor,
+                       TRI_datafile_t const* datafile,
                        TRI_df_marker_t const* marker,
                        TRI_df_marker_t** result) {
   int res = TRI_ReserveElementDatafile(compactor, marker->_size, result, 0);
@@ -214,7 +313,14 @@ static int CopyMarker (TRI_document_collection_t* document,
     return TRI_ERROR_ARANGO_NO_JOURNAL;
   }
 
-  return TRI_WriteElementDatafile(compactor, *result, marker, false);
+  res = TRI_WriteElementDatafile(compactor, *result, marker, false);
+
+  if (res == TRI_ERROR_NO_ERROR &&
+      datafile->_version != compactor->_version) {
+    (*result)->_crc = TRI_CrcMarkerDatafile(compactor->_version, *result);
+  }
+
+  return res;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -472,7 +578,7 @@ static bool Compactifier (TRI_df_marker_t const* marker,
     context->_keepDeletions = true;
 
     // write to compactor files
-    res = CopyMarker(document, context->_compactor, marker, &result);
+    res = CopyMarker(document, context->_compactor, datafile, marker, &result);
 
     if (res != TRI_ERROR_NO_ERROR) {
       // TODO: dont fail but recover from this state
@@ -497,16 +603,16 @@ static bool Compactifier (TRI_df_marker_t const* marker,
     TRI_ASSERT(((TRI_df_marker_t*) found2->getDataPtr())->_size > 0);  // ONLY in COMPACTIFIER, PROTECTED by fake trx outside
 
     // the fid might change
-    if (found->_fid != context->_compactor->_fid) {
+    if (found->_fidIndex != context->_fidIndex) {
       // update old datafile's info
-      TRI_doc_datafile_info_t* dfi = TRI_FindDatafileInfoDocumentCollection(document, found->_fid, false);
+      TRI_doc_datafile_info_t* dfi = TRI_FindDatafileInfoDocumentCollection(document, document->datafileId(found->_fidIndex), false);
 
       if (dfi != nullptr) {
         dfi->_numberDead += 1;
         dfi->_sizeDead += AlignedSize(marker);
       }
 
-      found2->_fid = context->_compactor->_fid;
+      found2->_fidIndex = context->_fidIndex;
     }
 
     // let marker point to the new position
@@ -521,7 +627,7 @@ static bool Compactifier (TRI_df_marker_t const* marker,
   else if (marker->_type == TRI_DOC_MARKER_KEY_DELETION &&
            context->_keepDeletions) {
     // write to compactor files
-    res = CopyMarker(document, context->_compactor, marker, &result);
+    res = CopyMarker(document, context->_compactor, datafile, marker, &result);
 
     if (res != TRI_ERROR_NO_ERROR) {
       // TODO: dont fail but recover from this state
@@ -535,7 +641,7 @@ static bool Compactifier (TRI_df_marker_t const* marker,
   // shapes
   else if (marker->_type == TRI_DF_MARKER_SHAPE) {
     // write to compactor files
-    res = CopyMarker(document, context->_compactor, marker, &result);
+    res = CopyMarker(document, context->_compactor, datafile, marker, &result);
 
     if (res != TRI_ERROR_NO_ERROR) {
       // TODO: dont fail but recover from this state
@@ -555,7 +661,7 @@ static bool Compactifier (TRI_df_marker_t const* marker,
   // attributes
   else if (marker->_type == TRI_DF_MARKER_ATTRIBUTE) {
     // write to compactor files
-    res = CopyMarker(document, context->_compactor, marker, &result);
+    res = CopyMarker(document, context->_compactor, datafile, marker, &result);
 
     if (res != TRI_ERROR_NO_ERROR) {
       // TODO: dont fail but recover from this state
@@ -583,7 +689,7 @@ static bool Compactifier (TRI_df_marker_t const* marker,
 
     if (document->_failedTransactions != nullptr) {
       // write to compactor files
-      res = CopyMarker(document, context->_compactor, marker, &result);
+      res = CopyMarker(document, context->_compactor, datafile, marker, &result);
 
       if (res != TRI_ERROR_NO_ERROR) {
         // TODO: dont fail but recover from this state
@@ -596,6 +702,20 @@ static bool Compactifier (TRI_df_marker_t const* marker,
     // otherwise don't copy
   }
 
+  if (context->_throttled &&
+      context->_compactor->_currentSize - context->_throttledSize >= COMPACTOR_THROTTLE_SIZE) {
+    // charge the rate limiter for the markers copied so far. the primary
+    // index is released while we are sleeping, so that regular operations on
+    // the collection can proceed. this is safe because every marker is
+    // checked against the primary index on its own
+    uint64_t const written = static_cast<uint64_t>(context->_compactor->_currentSize - context->_throttledSize);
+    context->_throttledSize = context->_compactor->_currentSize;
+
+    TRI_WRITE_UNLOCK_DOCUMENTS_INDEXES_PRIMARY_COLLECTION(document);
+    ThrottleCompaction(document, written);
+    TRI_WRITE_LOCK_DOCUMENTS_INDEXES_PRIMARY_COLLECTION(document);
+  }
+
   return true;
 }
 
@@ -676,6 +796,9 @@ static int RemoveDatafile (TRI_document_collection_t* document,
     TRI_Free(TRI_UNKNOWN_MEM_ZONE, dfi);
   }
 
+  // no master pointer refers to the datafile anymore
+  document->releaseDatafileIndex(df->_fid);
+
   TRI_WRITE_UNLOCK_DATAFILES_DOC_COLLECTION(document);
 
   return TRI_ERROR_NO_ERROR;
@@ -829,7 +952,10 @@ static void CompactifyDatafiles (TRI_document_collection_t* document,
   // these attributes remain the same for all datafiles we collect
   context._document  = document;
   context._compactor = compactor;
+  context._fidIndex  = document->datafileIndex(compactor->_fid);
   context._dfi._fid  = compactor->_fid;
+  context._throttledSize = compactor->_currentSize;
+  context._throttled = IsCompactionThrottled(document);
 
   // now compact all datafiles
   for (i = 0; i < n; ++i) {
@@ -859,6 +985,13 @@ static void CompactifyDatafiles (TRI_document_collection_t* document,
       // TODO: Remove
       return;
     }
+
+    // the compactifier charges the rate limiter in batches of markers. charge
+    // the rest of the datafile only now that the primary index is unlocked
+    if (context._throttled) {
+      ThrottleCompaction(document, static_cast<uint64_t>(compactor->_currentSize - context._throttledSize));
+      context._throttledSize = compactor->_currentSize;
+    }
   } // next file
 
 
@@ -884,6 +1017,15 @@ static void CompactifyDatafiles (TRI_document_collection_t* document,
 
   TRI_WRITE_UNLOCK_DATAFILES_DOC_COLLECTION(document);
 
+  // all surviving markers now live in the compactor, so the pages of the
+  // compacted datafiles are not needed anymore. they stay mapped until the
+  // datafiles are dropped, but their memory can be reclaimed right away
+  for (i = 0; i < n; ++i) {
+    compaction_info_t* compaction = static_cast<compaction_info_t*>(TRI_AtVector(compactions, i));
+
+    TRI_AdviseDatafile(compaction->_datafile, TRI_MADVISE_DONTNEED);
+  }
+
 
   if (context._dfi._numberAlive == 0 &&
       context._dfi._numberDead == 0 &&
@@ -1199,6 +1341,273 @@ static bool CheckAndLockCompaction (TRI_vocbase_t* vocbase) {
   return true;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief check whether a collection should be compacted, and calculate its
+/// compaction priority from its datafile statistics
+////////////////////////////////////////////////////////////////////////////////
+
+static bool GetCompactionCandidate (TRI_vocbase_col_t* collection,
+                                    double now,
+                                    compaction_candidate_t* candidate) {
+  if (! TRI_TRY_READ_LOCK_STATUS_VOCBASE_COL(collection)) {
+    // if we can't acquire the read lock instantly, we continue directly
+    // we don't want to stall here for too long
+    return false;
+  }
+
+  TRI_document_collection_t* document = collection->_collection;
+
+  if (document == nullptr ||
+      collection->_status != TRI_VOC_COL_STATUS_LOADED ||
+      ! document->_info._doCompact ||
+      document->_lastCompaction + COMPACTOR_COLLECTION_INTERVAL > now) {
+    TRI_READ_UNLOCK_STATUS_VOCBASE_COL(collection);
+    return false;
+  }
+
+  if (! TRI_TRY_READ_LOCK_DATAFILES_DOC_COLLECTION(document)) {
+    TRI_READ_UNLOCK_STATUS_VOCBASE_COL(collection);
+    return false;
+  }
+
+  int64_t sizeDead = 0;
+  int64_t sizeAlive = 0;
+  size_t const n = document->_datafiles._length;
+
+  for (size_t i = 0; i < n; ++i) {
+    TRI_datafile_t* df = static_cast<TRI_datafile_t*>(document->_datafiles._buffer[i]);
+    TRI_doc_datafile_info_t* dfi = TRI_FindDatafileInfoDocumentCollection(document, df->_fid, false);
+
+    if (dfi != nullptr) {
+      sizeDead  += dfi->_sizeDead;
+      sizeAlive += dfi->_sizeAlive;
+    }
+  }
+
+  TRI_READ_UNLOCK_DATAFILES_DOC_COLLECTION(document);
+  TRI_READ_UNLOCK_STATUS_VOCBASE_COL(collection);
+
+  // collections without dead data are still candidates, as small datafiles
+  // are merged and datafiles with deletions only are removed
+  candidate->_collection = collection;
+  candidate->_round      = nullptr;
+  candidate->_sizeDead   = sizeDead;
+  candidate->_deadShare  = 0.0;
+
+  if (sizeDead > 0) {
+    candidate->_deadShare = (double) sizeDead / ((double) sizeDead + (double) sizeAlive);
+  }
+
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief compact a single collection. returns whether any work was done
+////////////////////////////////////////////////////////////////////////////////
+
+static bool CompactifyCollection (TRI_vocbase_col_t* collection,
+                                  double now) {
+  if (! TRI_TRY_READ_LOCK_STATUS_VOCBASE_COL(collection)) {
+    // if we can't acquire the read lock instantly, we continue directly
+    // we don't want to stall here for too long
+    return false;
+  }
+
+  TRI_document_collection_t* document = collection->_collection;
+
+  if (document == nullptr) {
+    TRI_READ_UNLOCK_STATUS_VOCBASE_COL(collection);
+    return false;
+  }
+
+  bool worked    = false;
+  bool doCompact = document->_info._doCompact;
+
+  // for document collection, compactify datafiles
+  if (collection->_status == TRI_VOC_COL_STATUS_LOADED && doCompact) {
+    // check whether someone else holds a read-lock on the compaction lock
+    if (! TRI_TryWriteLockReadWriteLock(&document->_compactionLock)) {
+      // someone else is holding the compactor lock, we'll not compact
+      TRI_READ_UNLOCK_STATUS_VOCBASE_COL(collection);
+      return false;
+    }
+
+    if (document->_lastCompaction + COMPACTOR_COLLECTION_INTERVAL <= now) {
+      auto ce = document->ditches()->createCompactionDitch(__FILE__, __LINE__);
+
+      if (ce == nullptr) {
+        // out of memory
+        LOG_WARNING("out of memory when trying to create compaction ditch");
+      }
+      else {
+        worked = CompactifyDocumentCollection(document);
+
+        if (! worked) {
+          // set compaction stamp
+          document->_lastCompaction = now;
+        }
+        // if we worked, then we don't set the compaction stamp to force another round of compaction
+
+        document->ditches()->freeDitch(ce);
+      }
+    }
+
+    // read-unlock the compaction lock
+    TRI_WriteUnlockReadWriteLock(&document->_compactionLock);
+  }
+
+  TRI_READ_UNLOCK_STATUS_VOCBASE_COL(collection);
+
+  return worked;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief compare the urgency of two compaction candidates. collections with
+/// a higher share of dead data are more urgent
+////////////////////////////////////////////////////////////////////////////////
+
+static bool IsLessUrgent (compaction_candidate_t const& left,
+                          compaction_candidate_t const& right) {
+  if (left._deadShare != right._deadShare) {
+    return left._deadShare < right._deadShare;
+  }
+  return left._sizeDead < right._sizeDead;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief compact a collection and report the result to its round
+////////////////////////////////////////////////////////////////////////////////
+
+static void CompactifyCandidate (compaction_candidate_t const& candidate) {
+  compaction_round_t* round = candidate._round;
+  bool const worked = CompactifyCollection(candidate._collection, round->_now);
+
+  if (worked) {
+    // signal the cleanup thread that we worked and that it can now wake up
+    TRI_LockCondition(&round->_vocbase->_cleanupCondition);
+    TRI_SignalCondition(&round->_vocbase->_cleanupCondition);
+    TRI_UnlockCondition(&round->_vocbase->_cleanupCondition);
+  }
+
+  CONDITION_LOCKER(guard, round->_condition);
+
+  if (worked) {
+    ++round->_numCompacted;
+  }
+
+  if (--round->_pending == 0) {
+    guard.signal();
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief compact the most urgent of the server's candidates, which may
+/// belong to any database
+////////////////////////////////////////////////////////////////////////////////
+
+static void CompactifyNextCandidate () {
+  compaction_candidate_t candidate;
+
+  {
+    MUTEX_LOCKER(CandidatesLock);
+
+    if (Candidates.empty()) {
+      return;
+    }
+
+    std::pop_heap(Candidates.begin(), Candidates.end(), IsLessUrgent);
+    candidate = Candidates.back();
+    Candidates.pop_back();
+  }
+
+  CompactifyCandidate(candidate);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief compact the candidate collections of a database. if the server has
+/// compactor threads, the candidates are put into a queue shared by all
+/// databases, and each compactor thread picks the most urgent candidate of
+/// any database. the compactor threads thus also limit the number of
+/// concurrent compactions on the server. returns when all candidates of the
+/// database have been handled, with the number of collections worked on
+////////////////////////////////////////////////////////////////////////////////
+
+static int CompactifyCollections (TRI_vocbase_t* vocbase,
+                                  std::vector<compaction_candidate_t>& candidates,
+                                  double now) {
+  compaction_round_t round;
+  round._vocbase      = vocbase;
+  round._now          = now;
+  round._pending      = candidates.size();
+  round._numCompacted = 0;
+
+  for (auto& candidate : candidates) {
+    candidate._round = &round;
+  }
+
+  triagens::basics::ThreadPool* compactorPool = vocbase->_server->_compactorPool;
+
+  if (compactorPool == nullptr) {
+    // compact in this thread, most urgent candidate first
+    std::sort(candidates.begin(), candidates.end(), [] (compaction_candidate_t const& left, compaction_candidate_t const& right) {
+      return IsLessUrgent(right, left);
+    });
+
+    for (auto const& candidate : candidates) {
+      CompactifyCandidate(candidate);
+    }
+
+    return round._numCompacted;
+  }
+
+  size_t queued = 0;
+
+  {
+    MUTEX_LOCKER(CandidatesLock);
+
+    try {
+      for (auto const& candidate : candidates) {
+        Candidates.emplace_back(candidate);
+        std::push_heap(Candidates.begin(), Candidates.end(), IsLessUrgent);
+        ++queued;
+      }
+    }
+    catch (...) {
+      // out of memory. the remaining candidates are compacted below
+    }
+  }
+
+  size_t failed = 0;
+
+  for (size_t i = 0; i < queued; ++i) {
+    try {
+      compactorPool->enqueue([] () -> void {
+        CompactifyNextCandidate();
+      });
+    }
+    catch (...) {
+      ++failed;
+    }
+  }
+
+  // this thread picks up the work that could not be handed out
+  for (size_t i = 0; i < failed; ++i) {
+    CompactifyNextCandidate();
+  }
+
+  for (size_t i = queued; i < candidates.size(); ++i) {
+    CompactifyCandidate(candidates[i]);
+  }
+
+  CONDITION_LOCKER(guard, round._condition);
+
+  while (round._pending > 0) {
+    guard.wait();
+  }
+
+  return round._numCompacted;
+}
+
 // -----------------------------------------------------------------------------
 // --SECTION--                                                  public functions
 // -----------------------------------------------------------------------------
@@ -1382,6 +1791,7 @@ void TRI_CompactorVocBase (void* data) {
   TRI_ASSERT(vocbase->_state == 1);
 
   std::vector<TRI_vocbase_col_t*> collections;
+  std::vector<compaction_candidate_t> candidates;
 
   while (true) {
     // keep initial _state value as vocbase->_state might change during compaction loop
@@ -1402,68 +1812,20 @@ void TRI_CompactorVocBase (void* data) {
         collections.clear();
       }
 
-      for (auto& collection : collections) {
-        if (! TRI_TRY_READ_LOCK_STATUS_VOCBASE_COL(collection)) {
-          // if we can't acquire the read lock instantly, we continue directly
-          // we don't want to stall here for too long
-          continue;
-        }
-
-        TRI_document_collection_t* document = collection->_collection;
-
-        if (document == nullptr) {
-          TRI_READ_UNLOCK_STATUS_VOCBASE_COL(collection);
-          continue;
-        }
-
-        bool worked    = false;
-        bool doCompact = document->_info._doCompact;
+      // determine the collections to compact. the collections with the
+      // highest share of dead data are compacted first
+      candidates.clear();
 
-        // for document collection, compactify datafiles
-        if (collection->_status == TRI_VOC_COL_STATUS_LOADED && doCompact) {
-          // check whether someone else holds a read-lock on the compaction lock
-          if (! TRI_TryWriteLockReadWriteLock(&document->_compactionLock)) {
-            // someone else is holding the compactor lock, we'll not compact
-            TRI_READ_UNLOCK_STATUS_VOCBASE_COL(collection);
-            continue;
-          }
-
-          if (document->_lastCompaction + COMPACTOR_COLLECTION_INTERVAL <= now) {
-            auto ce = document->ditches()->createCompactionDitch(__FILE__, __LINE__);
-
-            if (ce == nullptr) {
-              // out of memory
-              LOG_WARNING("out of memory when trying to create compaction ditch");
-            }
-            else {
-              worked = CompactifyDocumentCollection(document);
-
-              if (! worked) {
-                // set compaction stamp
-                document->_lastCompaction = now;
-              }
-              // if we worked, then we don't set the compaction stamp to force another round of compaction
-
-              document->ditches()->freeDitch(ce);
-            }
-          }
-
-          // read-unlock the compaction lock
-          TRI_WriteUnlockReadWriteLock(&document->_compactionLock);
-        }
-
-        TRI_READ_UNLOCK_STATUS_VOCBASE_COL(collection);
-
-        if (worked) {
-          ++numCompacted;
+      for (auto& collection : collections) {
+        compaction_candidate_t candidate;
 
-          // signal the cleanup thread that we worked and that it can now wake up
-          TRI_LockCondition(&vocbase->_cleanupCondition);
-          TRI_SignalCondition(&vocbase->_cleanupCondition);
-          TRI_UnlockCondition(&vocbase->_cleanupCondition);
+        if (GetCompactionCandidate(collection, now, &candidate)) {
+          candidates.emplace_back(candidate);
         }
       }
 
+      numCompacted = CompactifyCollections(vocbase, candidates, now);
+
       UnlockCompaction(vocbase);
     }
 
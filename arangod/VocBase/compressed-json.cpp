@@ -0,0 +1,266 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @brief compressed document bodies in datafiles
+///
+/// @file
+///
+/// DISCLAIMER
+///
+/// Copyright 2014 ArangoDB GmbH, Cologne, Germany
+/// Copyright 2004-2014 triAGENS GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Jan Steemann
+/// @author Copyright 2015, ArangoDB GmbH, Cologne, Germany
+////////////////////////////////////////////////////////////////////////////////
+
+#include "compressed-json.h"
+#include "Basics/compression.h"
+#include "Basics/Exceptions.h"
+
+using namespace triagens::basics;
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                     private types
+// -----------------------------------------------------------------------------
+
+namespace {
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief an uncompressed body in the cache
+///
+/// the tick and crc of the marker are stored so that a body cached for a
+/// marker whose memory has been unmapped and reused is not returned for the
+/// marker that now lives at the same address
+////////////////////////////////////////////////////////////////////////////////
+
+  struct CachedBody {
+    uintptr_t       _key;
+    TRI_voc_tick_t  _tick;
+    TRI_voc_crc_t   _crc;
+    char*           _data;
+    size_t          _length;
+  };
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief the per-thread cache of uncompressed bodies
+///
+/// the most recently used body is at the front of the list
+////////////////////////////////////////////////////////////////////////////////
+
+  struct BodyCache {
+    BodyCache ()
+      : _bodies(),
+        _index(),
+        _size(0) {
+    }
+
+    ~BodyCache () {
+      for (auto& it : _bodies) {
+        TRI_Free(TRI_UNKNOWN_MEM_ZONE, it._data);
+      }
+    }
+
+    void remove (std::list<CachedBody>::iterator it) {
+      _size -= (*it)._length;
+      _index.erase((*it)._key);
+      TRI_Free(TRI_UNKNOWN_MEM_ZONE, (*it)._data);
+      _bodies.erase(it);
+    }
+
+    std::list<CachedBody>                                          _bodies;
+    std::unordered_map<uintptr_t, std::list<CachedBody>::iterator> _index;
+    size_t                                                         _size;
+  };
+
+}
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                 private variables
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief number of most recently used bodies that are never evicted
+////////////////////////////////////////////////////////////////////////////////
+
+static size_t const MinimalCachedBodies = 4;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief maximal total size of the uncompressed bodies cached per thread
+////////////////////////////////////////////////////////////////////////////////
+
+static std::atomic<uint64_t> MaximalCacheSize(TRI_COMPRESSED_JSON_DEFAULT_CACHE_SIZE);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief the cache of uncompressed bodies of the current thread
+////////////////////////////////////////////////////////////////////////////////
+
+static thread_local BodyCache Cache;
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                 private functions
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief evicts the least recently used bodies until the cache fits into its
+/// maximal size again
+////////////////////////////////////////////////////////////////////////////////
+
+static void EvictBodies (BodyCache& cache) {
+  uint64_t const maximalSize = MaximalCacheSize.load(std::memory_order_relaxed);
+
+  while (cache._size > maximalSize &&
+         cache._bodies.size() > MinimalCachedBodies) {
+    cache.remove(std::prev(cache._bodies.end()));
+  }
+}
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                  public functions
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief compresses a document body for storing it in a datafile marker
+////////////////////////////////////////////////////////////////////////////////
+
+bool TRI_CompressJson (char const* data,
+                       size_t length,
+                       std::string& buffer) {
+  if (length < TRI_COMPRESSED_JSON_MINIMAL_SIZE || length > UINT32_MAX) {
+    return false;
+  }
+
+  // only store compressed bodies that are actually smaller
+  size_t const available = length - sizeof(uint32_t) - 1;
+
+  buffer.resize(sizeof(uint32_t) + available);
+
+  uint32_t const uncompressed = static_cast<uint32_t>(length);
+  memcpy(&buffer[0], &uncompressed, sizeof(uint32_t));
+
+  size_t const compressed = TRI_CompressBlock(data, length, &buffer[sizeof(uint32_t)], available);
+
+  if (compressed == 0) {
+    return false;
+  }
+
+  buffer.resize(sizeof(uint32_t) + compressed);
+
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief returns the uncompressed body of a compressed datafile marker
+////////////////////////////////////////////////////////////////////////////////
+
+char const* TRI_UncompressedJsonMarker (TRI_doc_document_key_marker_t const* marker,
+                                        size_t& length) {
+  TRI_ASSERT(TRI_IsCompressedJsonMarker(marker));
+
+  BodyCache& cache = Cache;
+  uintptr_t const key = reinterpret_cast<uintptr_t>(marker);
+
+  auto found = cache._index.find(key);
+
+  if (found != cache._index.end()) {
+    auto it = (*found).second;
+
+    if ((*it)._tick == marker->base._tick &&
+        (*it)._crc == marker->base._crc) {
+      // move to the front
+      cache._bodies.splice(cache._bodies.begin(), cache._bodies, it);
+      length = (*it)._length;
+      return (*it)._data;
+    }
+
+    // the body belongs to a marker that lived at the same address before
+    cache.remove(it);
+  }
+
+  // not yet in the cache
+  uint16_t const offset = TRI_OffsetJsonMarker(marker);
+
+  if (marker->base._size < offset + sizeof(uint32_t)) {
+    THROW_ARANGO_EXCEPTION(TRI_ERROR_ARANGO_CORRUPTED_DATAFILE);
+  }
+
+  char const* body = reinterpret_cast<char const*>(marker) + offset;
+  uint32_t uncompressed;
+  memcpy(&uncompressed, body, sizeof(uint32_t));
+
+  if (uncompressed > TRI_MARKER_MAXIMAL_SIZE) {
+    THROW_ARANGO_EXCEPTION(TRI_ERROR_ARANGO_CORRUPTED_DATAFILE);
+  }
+
+  char* data = static_cast<char*>(TRI_Allocate(TRI_UNKNOWN_MEM_ZONE, uncompressed == 0 ? 1 : uncompressed, false));
+
+  if (data == nullptr) {
+    THROW_ARANGO_EXCEPTION(TRI_ERROR_OUT_OF_MEMORY);
+  }
+
+  if (! TRI_DecompressBlock(body + sizeof(uint32_t), marker->base._size - offset - sizeof(uint32_t), data, uncompressed)) {
+    TRI_Free(TRI_UNKNOWN_MEM_ZONE, data);
+    THROW_ARANGO_EXCEPTION(TRI_ERROR_ARANGO_CORRUPTED_DATAFILE);
+  }
+
+  try {
+    cache._bodies.push_front(CachedBody{ key, marker->base._tick, marker->base._crc, data, static_cast<size_t>(uncompressed) });
+  }
+  catch (...) {
+    TRI_Free(TRI_UNKNOWN_MEM_ZONE, data);
+    throw;
+  }
+
+  try {
+    cache._index.emplace(key, cache._bodies.begin());
+  }
+  catch (...) {
+    cache._bodies.pop_front();
+    TRI_Free(TRI_UNKNOWN_MEM_ZONE, data);
+    throw;
+  }
+
+  cache._size += uncompressed;
+  EvictBodies(cache);
+
+  length = uncompressed;
+  return data;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief sets the maximal size of the per-thread cache of uncompressed bodies
+////////////////////////////////////////////////////////////////////////////////
+
+void TRI_SetCompressedJsonCacheSize (uint64_t size) {
+  MaximalCacheSize.store(size);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief returns the maximal size of the per-thread cache of uncompressed
+/// bodies
+////////////////////////////////////////////////////////////////////////////////
+
+uint64_t TRI_GetCompressedJsonCacheSize () {
+  return MaximalCacheSize.load();
+}
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                       END-OF-FILE
+// -----------------------------------------------------------------------------
+
+// Local Variables:
+// mode: outline-minor
+// outline-regexp: "/// @brief\\|/// {@inheritDoc}\\|/// @page\\|// --SECTION--\\|/// @\\}"
+// End:
@@ -0,0 +1,120 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @brief compressed document bodies in datafiles
+///
+/// @file
+///
+/// DISCLAIMER
+///
+/// Copyright 2014 ArangoDB GmbH, Cologne, Germany
+/// Copyright 2004-2014 triAGENS GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Jan Steemann
+/// @author Copyright 2015, ArangoDB GmbH, Cologne, Germany
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef ARANGODB_VOC_BASE_COMPRESSED__JSON_H
+#define ARANGODB_VOC_BASE_COMPRESSED__JSON_H 1
+
+#include "Basics/Common.h"
+#include "VocBase/datafile.h"
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                 public constants
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief minimal size of a document body that is considered for compression
+////////////////////////////////////////////////////////////////////////////////
+
+#define TRI_COMPRESSED_JSON_MINIMAL_SIZE (64)
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief default maximal size of the per-thread cache of uncompressed bodies
+////////////////////////////////////////////////////////////////////////////////
+
+#define TRI_COMPRESSED_JSON_DEFAULT_CACHE_SIZE (8 * 1024 * 1024)
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                  public functions
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief whether or not the body of a datafile document marker is compressed
+////////////////////////////////////////////////////////////////////////////////
+
+static inline bool TRI_IsCompressedJsonMarker (TRI_doc_document_key_marker_t const* marker) {
+  return (marker->_offsetJson & TRI_DF_COMPRESSED_JSON) != 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief returns the offset of the (possibly compressed) body of a datafile
+/// document marker
+////////////////////////////////////////////////////////////////////////////////
+
+static inline uint16_t TRI_OffsetJsonMarker (TRI_doc_document_key_marker_t const* marker) {
+  return static_cast<uint16_t>(marker->_offsetJson & ~TRI_DF_COMPRESSED_JSON);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief compresses a document body for storing it in a datafile marker
+///
+/// the compressed body consists of the uncompressed length (uint32_t),
+/// followed by the compressed block. returns false if the body is too small
+/// or does not compress well enough, in which case it should be stored
+/// uncompressed
+////////////////////////////////////////////////////////////////////////////////
+
+bool TRI_CompressJson (char const*,
+                       size_t,
+                       std::string&);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief returns the uncompressed body of a compressed datafile marker
+///
+/// the body is decompressed into a cache owned by the calling thread. when the
+/// cache grows beyond its maximal size, the least recently used bodies are
+/// freed, except for the 4 most recently used ones. the result can be used
+/// like a pointer into the datafile as long as the thread does not access more
+/// than 3 other compressed bodies. throws if the body is corrupt
+////////////////////////////////////////////////////////////////////////////////
+
+char const* TRI_UncompressedJsonMarker (TRI_doc_document_key_marker_t const*,
+                                        size_t&);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief sets the maximal size of the per-thread cache of uncompressed bodies
+////////////////////////////////////////////////////////////////////////////////
+
+void TRI_SetCompressedJsonCacheSize (uint64_t);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief returns the maximal size of the per-thread cache of uncompressed
+/// bodies
+////////////////////////////////////////////////////////////////////////////////
+
+uint64_t TRI_GetCompressedJsonCacheSize ();
+
+#endif
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                       END-OF-FILE
+// -----------------------------------------------------------------------------
+
+// Local Variables:
+// mode: outline-minor
+// outline-regexp: "/// @brief\\|/// {@inheritDoc}\\|/// @page\\|// --SECTION--\\|/// @\\}"
+// End:
@@ -131,11 +131,27 @@ static int TruncateDatafile (TRI_datafile_t* const datafile, const off_t length)
   return TRI_ERROR_NO_ERROR;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief updates a checksum with the algorithm of a datafile version
+////////////////////////////////////////////////////////////////////////////////
+
+static inline TRI_voc_crc_t BlockCrc (TRI_df_version_t version,
+                                      TRI_voc_crc_t crc,
+                                      char const* data,
+                                      size_t length) {
+  if (version == TRI_DF_VERSION_CRC32) {
+    return TRI_BlockCrc32(crc, data, length);
+  }
+
+  return TRI_BlockCrc32C(crc, data, length);
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief calculates the actual CRC of a marker, without bounds checks
 ////////////////////////////////////////////////////////////////////////////////
 
-static TRI_voc_crc_t CalculateCrcValue (TRI_df_marker_t const* marker) {
+static TRI_voc_crc_t CalculateCrcValue (TRI_df_version_t version,
+                                        TRI_df_marker_t const* marker) {
   TRI_voc_size_t zero = 0;
   off_t o = offsetof(TRI_df_marker_t, _crc);
   size_t n = sizeof(TRI_voc_crc_t);
@@ -144,9 +160,9 @@ static TRI_voc_crc_t CalculateCrcValue (TRI_df_marker_t const* marker) {
 
   TRI_voc_crc_t crc = TRI_InitialCrc32();
 
-  crc = TRI_BlockCrc32(crc, ptr, o);
-  crc = TRI_BlockCrc32(crc, (char*) &zero, n);
-  crc = TRI_BlockCrc32(crc, ptr + o + n, marker->_size - o - n);
+  crc = BlockCrc(version, crc, ptr, o);
+  crc = BlockCrc(version, crc, (char*) &zero, n);
+  crc = BlockCrc(version, crc, ptr + o + n, marker->_size - o - n);
 
   crc = TRI_FinalCrc32(crc);
 
@@ -157,7 +173,8 @@ static TRI_voc_crc_t CalculateCrcValue (TRI_df_marker_t const* marker) {
 /// @brief diagnoses a marker
 ////////////////////////////////////////////////////////////////////////////////
 
-static std::string DiagnoseMarker (TRI_df_marker_t const* marker,
+static std::string DiagnoseMarker (TRI_df_version_t version,
+                                   TRI_df_marker_t const* marker,
                                    char const* end) {
   std::ostringstream result;
 
@@ -197,7 +214,7 @@ static std::string DiagnoseMarker (TRI_df_marker_t const* marker,
     return result.str();
   }
 
-  TRI_voc_crc_t crc = CalculateCrcValue(marker);
+  TRI_voc_crc_t crc = CalculateCrcValue(version, marker);
     
   if (marker->_crc == crc) {
     result << "crc checksum is correct";
@@ -213,7 +230,8 @@ static std::string DiagnoseMarker (TRI_df_marker_t const* marker,
 /// @brief checks a CRC of a marker, with bounds checks
 ////////////////////////////////////////////////////////////////////////////////
 
-static bool CheckCrcMarker (TRI_df_marker_t const* marker,
+static bool CheckCrcMarker (TRI_df_version_t version,
+                            TRI_df_marker_t const* marker,
                             char const* end) {
   if (marker->_size < sizeof(TRI_df_marker_t)) {
     return false;
@@ -223,7 +241,7 @@ static bool CheckCrcMarker (TRI_df_marker_t const* marker,
     return false;
   }
 
-  auto expected = CalculateCrcValue(marker);
+  auto expected = CalculateCrcValue(version, marker);
   return marker->_crc == expected;
 }
 
@@ -310,6 +328,7 @@ static void InitDatafile (TRI_datafile_t* datafile,
 
   datafile->_state       = TRI_DF_STATE_READ;
   datafile->_fid         = fid;
+  datafile->_version     = TRI_DF_VERSION;
 
   datafile->_filename    = filename;
   datafile->_fd          = fd;
@@ -569,7 +588,7 @@ static TRI_df_scan_t ScanDatafile (TRI_datafile_t const* datafile) {
     if (marker->_size < sizeof(TRI_df_marker_t)) {
       entry._status = 4;
 
-      auto&& diagnosis = DiagnoseMarker(marker, end);
+      auto&& diagnosis = DiagnoseMarker(datafile->_version, marker, end);
       entry._diagnosis = TRI_DuplicateString2Z(TRI_UNKNOWN_MEM_ZONE, diagnosis.c_str(), diagnosis.size());
 
       scan._endPosition = currentSize;
@@ -582,7 +601,7 @@ static TRI_df_scan_t ScanDatafile (TRI_datafile_t const* datafile) {
     if (! TRI_IsValidMarkerDatafile(marker)) {
       entry._status = 4;
 
-      auto&& diagnosis = DiagnoseMarker(marker, end);
+      auto&& diagnosis = DiagnoseMarker(datafile->_version, marker, end);
       entry._diagnosis = TRI_DuplicateString2Z(TRI_UNKNOWN_MEM_ZONE, diagnosis.c_str(), diagnosis.size());
 
       scan._endPosition = currentSize;
@@ -592,12 +611,12 @@ static TRI_df_scan_t ScanDatafile (TRI_datafile_t const* datafile) {
       return scan;
     }
 
-    ok = CheckCrcMarker(marker, end);
+    ok = CheckCrcMarker(datafile->_version, marker, end);
 
     if (! ok) {
       entry._status = 5;
       
-      auto&& diagnosis = DiagnoseMarker(marker, end);
+      auto&& diagnosis = DiagnoseMarker(datafile->_version, marker, end);
       entry._diagnosis = TRI_DuplicateString2Z(TRI_UNKNOWN_MEM_ZONE, diagnosis.c_str(), diagnosis.size());
       
       scan._status = 4;
@@ -657,7 +676,7 @@ static bool TryRepairDatafile (TRI_datafile_t* datafile) {
     }
 
     if (marker->_type != 0) {
-      if (! CheckCrcMarker(marker, end)) {
+      if (! CheckCrcMarker(datafile->_version, marker, end)) {
         // CRC mismatch!
         auto next = reinterpret_cast<char const*>(marker) + marker->_size;
         auto p = next;
@@ -693,7 +712,7 @@ static bool TryRepairDatafile (TRI_datafile_t* datafile) {
                 nextMarker->_size >= sizeof(TRI_df_marker_t) &&
                 next + nextMarker->_size <= end &&
                 TRI_IsValidMarkerDatafile(nextMarker) &&
-                CheckCrcMarker(nextMarker, end)) {
+                CheckCrcMarker(datafile->_version, nextMarker, end)) {
               // next marker looks good.
 
               // create a temporary buffer
@@ -706,7 +725,7 @@ static bool TryRepairDatafile (TRI_datafile_t* datafile) {
               // create a new marker in the temporary buffer
               auto temp = reinterpret_cast<TRI_df_marker_t*>(buffer);
               TRI_InitMarkerDatafile(static_cast<char*>(buffer), TRI_DF_MARKER_BLANK, static_cast<TRI_voc_size_t>(marker->_size));
-              temp->_crc = CalculateCrcValue(temp);
+              temp->_crc = CalculateCrcValue(datafile->_version, temp);
 
               // all done. now copy back the marker into the file
               memcpy(static_cast<void*>(ptr), buffer, static_cast<size_t>(marker->_size));
@@ -898,7 +917,7 @@ static bool CheckDatafile (TRI_datafile_t* datafile,
     }
 
     if (marker->_type != 0) {
-      bool ok = CheckCrcMarker(marker, end);
+      bool ok = CheckCrcMarker(datafile->_version, marker, end);
 
       if (! ok) {
         // CRC mismatch!
@@ -936,7 +955,7 @@ static bool CheckDatafile (TRI_datafile_t* datafile,
                     nextMarker->_size >= sizeof(TRI_df_marker_t) &&
                     next + nextMarker->_size <= end &&
                     TRI_IsValidMarkerDatafile(nextMarker) &&
-                    CheckCrcMarker(nextMarker, end)) {
+                    CheckCrcMarker(datafile->_version, nextMarker, end)) {
                   // next marker looks good.
                   nextMarkerOk = true;
                 }
@@ -961,7 +980,7 @@ static bool CheckDatafile (TRI_datafile_t* datafile,
           LOG_WARNING("crc mismatch found in datafile '%s' at position %lu. expected crc: %x, actual crc: %x", 
                       datafile->getName(datafile),
                       (unsigned long) currentSize,
-                      CalculateCrcValue(marker),
+                      CalculateCrcValue(datafile->_version, marker),
                       marker->_crc);
           
           if (nextMarkerOk) {
@@ -1039,7 +1058,7 @@ static int WriteInitialHeaderMarker (TRI_datafile_t* datafile,
   TRI_InitMarkerDatafile((char*) &header, TRI_DF_MARKER_HEADER, sizeof(TRI_df_header_marker_t));
   header.base._tick = (TRI_voc_tick_t) fid;
 
-  header._version     = TRI_DF_VERSION;
+  header._version     = datafile->_version;
   header._maximalSize = maximalSize;
   header._fid         = fid;
 
@@ -1134,8 +1153,8 @@ static TRI_datafile_t* OpenDatafile (char const* filename,
   
   char const* end = static_cast<char const*>(ptr) + len;
 
-  // check CRC
-  ok = CheckCrcMarker(&header.base, end);
+  // check CRC. the header is checksummed with the algorithm of its own version
+  ok = CheckCrcMarker(header._version, &header.base, end);
 
   if (! ok) {
     TRI_set_errno(TRI_ERROR_ARANGO_CORRUPTED_DATAFILE);
@@ -1150,7 +1169,8 @@ static TRI_datafile_t* OpenDatafile (char const* filename,
 
   // check the datafile version
   if (ok) {
-    if (header._version != TRI_DF_VERSION) {
+    if (header._version != TRI_DF_VERSION &&
+        header._version != TRI_DF_VERSION_CRC32) {
       TRI_set_errno(TRI_ERROR_ARANGO_CORRUPTED_DATAFILE);
 
       LOG_ERROR("unknown datafile version '%u' in datafile '%s'",
@@ -1202,6 +1222,11 @@ static TRI_datafile_t* OpenDatafile (char const* filename,
                fid,
                static_cast<char*>(data));
 
+  if (header._version == TRI_DF_VERSION_CRC32) {
+    // datafile was written before CRC32C checksums were introduced
+    datafile->_version = TRI_DF_VERSION_CRC32;
+  }
+
   return datafile;
 }
 
@@ -1531,6 +1556,15 @@ void TRI_InitMarkerDatafile (char* marker,
   // marker->_tick = 0;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief calculates the checksum of a marker for a datafile version
+////////////////////////////////////////////////////////////////////////////////
+
+TRI_voc_crc_t TRI_CrcMarkerDatafile (TRI_df_version_t version,
+                                     TRI_df_marker_t const* marker) {
+  return CalculateCrcValue(version, marker);
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief checks whether a marker is valid
 ////////////////////////////////////////////////////////////////////////////////
@@ -1806,7 +1840,7 @@ int TRI_WriteCrcElementDatafile (TRI_datafile_t* datafile,
   if (datafile->isPhysical(datafile)) {
     TRI_voc_crc_t crc = TRI_InitialCrc32();
 
-    crc = TRI_BlockCrc32(crc, (char const*) marker, marker->_size);
+    crc = BlockCrc(datafile->_version, crc, (char const*) marker, marker->_size);
     marker->_crc = TRI_FinalCrc32(crc);
   }
 
@@ -1835,25 +1869,71 @@ bool TRI_IterateDatafile (TRI_datafile_t* datafile,
     return false;
   }
 
+  // the markers are read front to back
+  TRI_AdviseDatafile(datafile, TRI_MADVISE_SEQUENTIAL);
+
+  bool result = true;
+
   while (ptr < end) {
     TRI_df_marker_t const* marker = reinterpret_cast<TRI_df_marker_t const*>(ptr);
 
     if (marker->_size == 0) {
-      return true;
+      break;
     }
 
     // update the tick statistics
     TRI_UpdateTicksDatafile(datafile, marker);
 
     if (! iterator(marker, data, datafile)) {
-      return false;
+      result = false;
+      break;
     }
 
     size_t size = TRI_DF_ALIGN_BLOCK(marker->_size);
     ptr += size;
   }
 
-  return true;
+  TRI_ResetAdviceDatafile(datafile);
+
+  return result;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief gives the kernel a hint about how the datafile will be accessed
+////////////////////////////////////////////////////////////////////////////////
+
+void TRI_AdviseDatafile (TRI_datafile_t const* datafile,
+                         int advice) {
+  if (datafile->_data == nullptr) {
+    return;
+  }
+
+  size_t length = static_cast<size_t>(datafile->_maximalSize);
+
+  if (advice == TRI_MADVISE_WILLNEED ||
+      advice == TRI_MADVISE_DONTNEED) {
+    // only the part that contains data
+    length = static_cast<size_t>(datafile->_currentSize);
+
+    if (advice == TRI_MADVISE_DONTNEED &&
+        ! datafile->isPhysical(datafile)) {
+      // dropping the pages of an anonymous mapping would drop the data
+      return;
+    }
+  }
+
+  TRI_MMFileAdvise(datafile->_data, length, advice);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief restores the default access pattern hint of the datafile
+////////////////////////////////////////////////////////////////////////////////
+
+void TRI_ResetAdviceDatafile (TRI_datafile_t const* datafile) {
+  // documents in sealed datafiles are mostly looked up via indexes, so reading
+  // ahead around every access would waste I/O. journals are hot and written
+  // sequentially
+  TRI_AdviseDatafile(datafile, datafile->_isSealed ? TRI_MADVISE_RANDOM : TRI_MADVISE_NORMAL);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -1874,6 +1954,7 @@ TRI_datafile_t* TRI_OpenDatafile (char const* filename,
   }
 
   // check the datafile by scanning markers
+  TRI_AdviseDatafile(datafile, TRI_MADVISE_SEQUENTIAL);
   bool ok = CheckDatafile(datafile, ignoreFailures);
 
   if (! ok) {
@@ -1893,6 +1974,13 @@ TRI_datafile_t* TRI_OpenDatafile (char const* filename,
     TRI_ProtectMMFile(datafile->_data, datafile->_maximalSize, PROT_READ | PROT_WRITE, datafile->_fd, &datafile->_mmHandle);
   }
 
+  TRI_ResetAdviceDatafile(datafile);
+
+  if (! datafile->_isSealed) {
+    // a journal contains the most recent documents, so keep it in memory
+    TRI_AdviseDatafile(datafile, TRI_MADVISE_WILLNEED);
+  }
+
   return datafile;
 }
 
@@ -2055,6 +2143,8 @@ int TRI_SealDatafile (TRI_datafile_t* datafile) {
     datafile->_isSealed = true;
     datafile->_state = TRI_DF_STATE_READ;
     datafile->_maximalSize = datafile->_currentSize;
+
+    TRI_ResetAdviceDatafile(datafile);
   }
 
   if (! ok) {
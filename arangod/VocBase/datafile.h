@@ -96,9 +96,21 @@
 
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief datafile version
+///
+/// version 2 datafiles use CRC32C (Castagnoli) marker checksums, which can be
+/// calculated with CPU instructions on most platforms
 ////////////////////////////////////////////////////////////////////////////////
 
-#define TRI_DF_VERSION          (1)
+#define TRI_DF_VERSION          (2)
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief datafile version using CRC32 marker checksums
+///
+/// datafiles of this version are still read, and their journals are written
+/// in this version until they are sealed
+////////////////////////////////////////////////////////////////////////////////
+
+#define TRI_DF_VERSION_CRC32    (1)
 
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief alignment in datafile blocks
@@ -112,6 +124,13 @@
 
 #define TRI_MARKER_MAXIMAL_SIZE (256 * 1024 * 1024)
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief flag in the _offsetJson attribute of datafile document and edge
+/// markers, indicating that the body of the marker is compressed
+////////////////////////////////////////////////////////////////////////////////
+
+#define TRI_DF_COMPRESSED_JSON  ((uint16_t) 0x8000)
+
 // -----------------------------------------------------------------------------
 // --SECTION--                                                      public types
 // -----------------------------------------------------------------------------
@@ -254,6 +273,7 @@ TRI_df_scan_entry_t;
 
 typedef struct TRI_datafile_s {
   TRI_voc_fid_t _fid;            // datafile identifier
+  TRI_df_version_t _version;     // datafile version, determines the checksum algorithm
 
   TRI_df_state_e _state;         // state of the datafile (READ or WRITE)
   int _fd;                       // underlying file descriptor
@@ -661,6 +681,15 @@ void TRI_InitMarkerDatafile (char*,
 
 bool TRI_IsValidMarkerDatafile (TRI_df_marker_t const*);
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief calculates the checksum of a marker for a datafile version
+///
+/// the checksum is computed as if the field _crc of the marker were 0
+////////////////////////////////////////////////////////////////////////////////
+
+TRI_voc_crc_t TRI_CrcMarkerDatafile (TRI_df_version_t,
+                                     TRI_df_marker_t const*);
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief reserves room for an element, advances the pointer
 ////////////////////////////////////////////////////////////////////////////////
@@ -712,6 +741,26 @@ bool TRI_IterateDatafile (TRI_datafile_t*,
 TRI_datafile_t* TRI_OpenDatafile (char const*,
                                   bool);
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief gives the kernel a hint about how the datafile will be accessed
+///
+/// advice is one of the TRI_MADVISE_* values from Basics/memory-map.h.
+/// sequential, random and normal apply to the whole mapping, willneed and
+/// dontneed only to the part of the datafile that contains data. dontneed is
+/// ignored for anonymous datafiles, because it would drop their contents
+////////////////////////////////////////////////////////////////////////////////
+
+void TRI_AdviseDatafile (TRI_datafile_t const*,
+                         int);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief restores the default access pattern hint of the datafile
+///
+/// this is random access for sealed datafiles and normal for journals
+////////////////////////////////////////////////////////////////////////////////
+
+void TRI_ResetAdviceDatafile (TRI_datafile_t const*);
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief closes a datafile and all memory regions
 ////////////////////////////////////////////////////////////////////////////////
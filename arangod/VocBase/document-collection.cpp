@@ -29,14 +29,21 @@
 
 #include "document-collection.h"
 
+#include "Aql/PlanCache.h"
 #include "Aql/QueryCache.h"
 #include "Basics/Barrier.h"
 #include "Basics/conversions.h"
 #include "Basics/Exceptions.h"
 #include "Basics/files.h"
+#include "Basics/hashes.h"
 #include "Basics/logging.h"
+#include "Basics/memory-map.h"
+#include "Basics/numa.h"
+#include "Basics/process-utils.h"
+#include "Basics/ReadLocker.h"
 #include "Basics/tri-strings.h"
 #include "Basics/ThreadPool.h"
+#include "Basics/WriteLocker.h"
 #include "FulltextIndex/fulltext-index.h"
 #include "Indexes/CapConstraint.h"
 #include "Indexes/EdgeIndex.h"
@@ -117,9 +124,20 @@ TRI_document_collection_t::TRI_document_collection_t ()
   : _useSecondaryIndexes(true),
     _capConstraint(nullptr),
     _ditches(this),
+    _datafileIdsLock(),
+    _datafileIds({ { 0, 0 } }),
+    _datafileIndexes({ { 0, 0 } }),
+    _freeDatafileSlots(),
+    _lastDatafileId(0),
+    _lastDatafileIndex(0),
     _headersPtr(nullptr),
     _keyGenerator(nullptr),
+    _numaNode(TRI_NUMA_NODE_ANY),
     _uncollectedLogfileEntries(0),
+    _numberCompressed(0),
+    _sizeUncompressed(0),
+    _sizeCompressed(0),
+    _compressionTime(0),
     _cleanupIndexes(0) {
 
   _tickMax = 0;
@@ -133,6 +151,135 @@ TRI_document_collection_t::~TRI_document_collection_t () {
   delete _keyGenerator;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief return the index of a datafile or WAL logfile id, registering the
+/// id if it is not yet known. index 0 is reserved for datafile id 0
+///
+/// the lower 24 bits of an index are a slot in the registry, the upper 8 bits
+/// are the generation of the slot. slots of released ids are reused with the
+/// next generation, so a stale index in a copied master pointer does not
+/// resolve to the id that reuses the slot. the most recently registered id,
+/// usually the current WAL logfile, is looked up without locking
+////////////////////////////////////////////////////////////////////////////////
+
+uint32_t TRI_document_collection_t::datafileIndex (TRI_voc_fid_t fid) {
+  if (fid != 0 && fid == _lastDatafileId.load()) {
+    uint32_t index = _lastDatafileIndex.load();
+
+    if (fid == _lastDatafileId.load()) {
+      // the cache was not modified in the meantime
+      return index;
+    }
+  }
+
+  {
+    READ_LOCKER(_datafileIdsLock);
+    auto it = _datafileIndexes.find(fid);
+
+    if (it != _datafileIndexes.end()) {
+      return (*it).second;
+    }
+  }
+
+  WRITE_LOCKER(_datafileIdsLock);
+  auto it = _datafileIndexes.find(fid);
+
+  if (it != _datafileIndexes.end()) {
+    // someone else was faster
+    return (*it).second;
+  }
+
+  uint32_t slot;
+
+  if (! _freeDatafileSlots.empty()) {
+    slot = _freeDatafileSlots.back();
+  }
+  else {
+    if (_datafileIds.size() > DatafileSlotMask) {
+      THROW_ARANGO_EXCEPTION_MESSAGE(TRI_ERROR_INTERNAL, "too many datafiles in collection");
+    }
+
+    slot = static_cast<uint32_t>(_datafileIds.size());
+    _datafileIds.emplace_back(0, 0);
+  }
+
+  auto& entry = _datafileIds[slot];
+  uint32_t const index = slot | (entry.second << 24);
+
+  _datafileIndexes.emplace(fid, index);
+
+  if (! _freeDatafileSlots.empty() && _freeDatafileSlots.back() == slot) {
+    _freeDatafileSlots.pop_back();
+  }
+
+  entry.first = fid;
+
+  // the cache is only modified under the write lock
+  _lastDatafileId.store(0);
+  _lastDatafileIndex.store(index);
+  _lastDatafileId.store(fid);
+
+  return index;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief return the datafile or WAL logfile id for an index. returns 0 if
+/// the id was released in the meantime
+////////////////////////////////////////////////////////////////////////////////
+
+TRI_voc_fid_t TRI_document_collection_t::datafileId (uint32_t index) const {
+  uint32_t const slot = index & DatafileSlotMask;
+
+  READ_LOCKER(_datafileIdsLock);
+
+  TRI_ASSERT(slot < _datafileIds.size());
+
+  auto const& entry = _datafileIds[slot];
+
+  if (entry.second != (index >> 24)) {
+    return 0;
+  }
+
+  return entry.first;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief release the index of a datafile or WAL logfile id. this is called
+/// when no master pointer refers to the datafile or logfile anymore
+////////////////////////////////////////////////////////////////////////////////
+
+void TRI_document_collection_t::releaseDatafileIndex (TRI_voc_fid_t fid) {
+  if (fid == 0) {
+    return;
+  }
+
+  WRITE_LOCKER(_datafileIdsLock);
+
+  auto it = _datafileIndexes.find(fid);
+
+  if (it == _datafileIndexes.end()) {
+    return;
+  }
+
+  uint32_t const slot = (*it).second & DatafileSlotMask;
+  _datafileIndexes.erase(it);
+
+  if (_lastDatafileId.load() == fid) {
+    _lastDatafileId.store(0);
+  }
+
+  auto& entry = _datafileIds[slot];
+  entry.first = 0;
+  entry.second = (entry.second + 1) & 0xff;
+
+  try {
+    _freeDatafileSlots.emplace_back(slot);
+  }
+  catch (...) {
+    // the slot is not reused
+  }
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief add an index to the collection
 /// note: this may throw. it's the caller's responsibility to catch and clean up
@@ -520,7 +667,7 @@ static int DeleteSecondaryIndexes (TRI_document_collection_t* document,
 
 static int CreateHeader (TRI_document_collection_t* document,
                          TRI_doc_document_key_marker_t const* marker,
-                         TRI_voc_fid_t fid,
+                         uint32_t fidIndex,
                          TRI_voc_key_t key,
                          TRI_doc_mptr_t** result) {
   size_t markerSize = (size_t) marker->base._size;
@@ -535,8 +682,8 @@ static int CreateHeader (TRI_document_collection_t* document,
 
   auto primaryIndex = document->primaryIndex();
 
-  header->_rid     = marker->_rid;
-  header->_fid     = fid;
+  header->_rid      = marker->_rid;
+  header->_fidIndex = fidIndex;
   header->setDataPtr(marker);  // ONLY IN OPENITERATOR
   header->_hash    = primaryIndex->calculateHash(key); // ONLY IN OPENITERATOR, PROTECTED by RUNTIME
   *result = header;
@@ -606,7 +753,7 @@ static bool RemoveIndexFile (TRI_document_collection_t* collection,
 /// @brief updates an existing header
 ////////////////////////////////////////////////////////////////////////////////
 
-static void UpdateHeader (TRI_voc_fid_t fid,
+static void UpdateHeader (uint32_t fidIndex,
                           TRI_df_marker_t const* m,
                           TRI_doc_mptr_t* newHeader,
                           TRI_doc_mptr_t const* oldHeader) {
@@ -617,8 +764,8 @@ static void UpdateHeader (TRI_voc_fid_t fid,
   TRI_ASSERT(marker != nullptr);
   TRI_ASSERT(m->_size > 0);
 
-  newHeader->_rid     = marker->_rid;
-  newHeader->_fid     = fid;
+  newHeader->_rid      = marker->_rid;
+  newHeader->_fidIndex = fidIndex;
   newHeader->setDataPtr(marker);  // ONLY IN OPENITERATOR
 }
 
@@ -1161,6 +1308,7 @@ typedef struct open_iterator_state_s {
   TRI_document_collection_t* _document;
   TRI_voc_tid_t              _tid;
   TRI_voc_fid_t              _fid;
+  uint32_t                   _fidIndex;
   TRI_doc_datafile_info_t*   _dfi;
   TRI_vector_t               _operations;
   TRI_vocbase_t*             _vocbase;
@@ -1218,6 +1366,7 @@ static int OpenIteratorApplyInsert (open_iterator_state_t* state,
   if (state->_fid != operation->_fid) {
     // update the state
     state->_fid = operation->_fid;
+    state->_fidIndex = document->datafileIndex(operation->_fid);
     state->_dfi = TRI_FindDatafileInfoDocumentCollection(document, operation->_fid, true);
   }
 
@@ -1269,7 +1418,7 @@ static int OpenIteratorApplyInsert (open_iterator_state_t* state,
     TRI_doc_mptr_t* header;
 
     // get a header
-    int res = CreateHeader(document, (TRI_doc_document_key_marker_t*) marker, operation->_fid, key, &header);
+    int res = CreateHeader(document, (TRI_doc_document_key_marker_t*) marker, state->_fidIndex, key, &header);
 
     if (res != TRI_ERROR_NO_ERROR) {
       LOG_ERROR("out of memory");
@@ -1324,23 +1473,23 @@ static int OpenIteratorApplyInsert (open_iterator_state_t* state,
 
   // it is an update, but only if found has a smaller revision identifier
   else if (found->_rid < d->_rid ||
-           (found->_rid == d->_rid && found->_fid <= operation->_fid)) {
+           (found->_rid == d->_rid && document->datafileId(found->_fidIndex) <= operation->_fid)) {
     // save the old data
     TRI_doc_mptr_copy_t oldData = *found;
 
     TRI_doc_mptr_t* newHeader = const_cast<TRI_doc_mptr_t*>(found);
 
     // update the header info
-    UpdateHeader(operation->_fid, marker, newHeader, found);
+    UpdateHeader(state->_fidIndex, marker, newHeader, found);
     document->_headersPtr->moveBack(newHeader, &oldData);  // ONLY IN OPENITERATOR
 
     // update the datafile info
     TRI_doc_datafile_info_t* dfi;
-    if (oldData._fid == state->_fid) {
+    if (oldData._fidIndex == state->_fidIndex) {
       dfi = state->_dfi;
     }
     else {
-      dfi = TRI_FindDatafileInfoDocumentCollection(document, oldData._fid, true);
+      dfi = TRI_FindDatafileInfoDocumentCollection(document, document->datafileId(oldData._fidIndex), true);
     }
 
     if (dfi != nullptr && found->getDataPtr() != nullptr) {  // ONLY IN OPENITERATOR, PROTECTED by RUNTIME
@@ -1399,6 +1548,7 @@ static int OpenIteratorApplyRemove (open_iterator_state_t* state,
   if (state->_fid != operation->_fid) {
     // update the state
     state->_fid = operation->_fid;
+    state->_fidIndex = document->datafileIndex(operation->_fid);
     state->_dfi = TRI_FindDatafileInfoDocumentCollection(document, operation->_fid, true);
   }
 
@@ -1431,11 +1581,11 @@ static int OpenIteratorApplyRemove (open_iterator_state_t* state,
     TRI_doc_datafile_info_t* dfi;
 
     // update the datafile info
-    if (found->_fid == state->_fid) {
+    if (found->_fidIndex == state->_fidIndex) {
       dfi = state->_dfi;
     }
     else {
-      dfi = TRI_FindDatafileInfoDocumentCollection(document, found->_fid, true);
+      dfi = TRI_FindDatafileInfoDocumentCollection(document, document->datafileId(found->_fidIndex), true);
     }
 
     if (dfi != nullptr) {
@@ -1706,6 +1856,7 @@ static int OpenIteratorHandleShapeMarker (TRI_df_marker_t const* marker,
   if (res == TRI_ERROR_NO_ERROR) {
     if (state->_fid != datafile->_fid) {
       state->_fid = datafile->_fid;
+      state->_fidIndex = document->datafileIndex(datafile->_fid);
       state->_dfi = TRI_FindDatafileInfoDocumentCollection(document, state->_fid, true);
     }
 
@@ -1732,6 +1883,7 @@ static int OpenIteratorHandleAttributeMarker (TRI_df_marker_t const* marker,
   if (res == TRI_ERROR_NO_ERROR) {
     if (state->_fid != datafile->_fid) {
       state->_fid = datafile->_fid;
+      state->_fidIndex = document->datafileIndex(datafile->_fid);
       state->_dfi = TRI_FindDatafileInfoDocumentCollection(document, state->_fid, true);
     }
 
@@ -2033,6 +2185,11 @@ static TRI_doc_collection_info_t* Figures (TRI_document_collection_t* document)
   info->_uncollectedLogfileEntries = document->_uncollectedLogfileEntries;
   info->_tickMax = document->_tickMax;
 
+  info->_numberCompressed = document->_numberCompressed;
+  info->_sizeUncompressed = document->_sizeUncompressed;
+  info->_sizeCompressed   = document->_sizeCompressed;
+  info->_compressionTime  = document->_compressionTime;
+
   return info;
 }
 
@@ -2129,7 +2286,8 @@ static bool InitDocumentCollection (TRI_document_collection_t* document,
     return false;
   }
 
-  document->_headersPtr = new TRI_headers_t;  // ONLY IN CREATE COLLECTION
+  document->_numaNode = TRI_NumaHomeNode(document->_info._cid);
+  document->_headersPtr = new TRI_headers_t(document->_numaNode);  // ONLY IN CREATE COLLECTION
 
   if (document->_headersPtr == nullptr) {  // ONLY IN CREATE COLLECTION
     DestroyBaseDocumentCollection(document);
@@ -2209,6 +2367,7 @@ static int IterateMarkersCollection (TRI_collection_t* collection) {
   openState._deletions      = 0;
   openState._documents      = 0;
   openState._fid            = 0;
+  openState._fidIndex       = 0;
   openState._dfi            = nullptr;
   openState._initialCount   = -1;
 
@@ -2246,6 +2405,649 @@ static int IterateMarkersCollection (TRI_collection_t* collection) {
   return TRI_ERROR_NO_ERROR;
 }
 
+// -----------------------------------------------------------------------------
+// --SECTION--                                                   INDEX SNAPSHOTS
+// -----------------------------------------------------------------------------
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                 private variables
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief name of the index snapshot file in the collection directory
+////////////////////////////////////////////////////////////////////////////////
+
+static char const* IndexSnapshotFilename = "snapshot.db";
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief name of the file an index snapshot is written to before it is
+/// renamed to its final name
+////////////////////////////////////////////////////////////////////////////////
+
+static char const* IndexSnapshotTempFilename = "snapshot.db.tmp";
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief version of the index snapshot file format
+////////////////////////////////////////////////////////////////////////////////
+
+static uint32_t const IndexSnapshotVersion = 1;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief size of the buffer used when writing an index snapshot
+////////////////////////////////////////////////////////////////////////////////
+
+static size_t const IndexSnapshotBufferSize = 1024 * 1024;
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                     private types
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief header of an index snapshot file
+///
+/// the header is followed by the datafile states, the positions of the shape
+/// and attribute markers and the positions of the documents. the file ends
+/// with a CRC32C checksum of all preceding data
+////////////////////////////////////////////////////////////////////////////////
+
+typedef struct index_snapshot_header_s {
+  uint32_t       _version;
+  uint32_t       _numberDatafiles;
+  TRI_voc_cid_t  _cid;
+  TRI_voc_tick_t _tickMax;
+  TRI_voc_rid_t  _revision;
+  uint64_t       _lastKeyValue;
+  uint64_t       _numberMarkers;
+  uint64_t       _numberDocuments;
+}
+index_snapshot_header_t;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief state of a datafile at the time the snapshot was written
+////////////////////////////////////////////////////////////////////////////////
+
+typedef struct index_snapshot_datafile_s {
+  TRI_voc_fid_t           _fid;
+  TRI_voc_tick_t          _tickMin;
+  TRI_voc_tick_t          _tickMax;
+  TRI_voc_tick_t          _dataMin;
+  TRI_voc_tick_t          _dataMax;
+  TRI_voc_size_t          _currentSize;
+  uint32_t                _padding;
+  TRI_doc_datafile_info_t _info;
+}
+index_snapshot_datafile_t;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief position of a marker in a datafile
+///
+/// revision and hash are only used for document markers. they are stored so
+/// the primary index can be rebuilt without reading the documents
+////////////////////////////////////////////////////////////////////////////////
+
+typedef struct index_snapshot_entry_s {
+  TRI_voc_fid_t  _fid;
+  TRI_voc_rid_t  _rid;
+  uint64_t       _hash;
+  TRI_voc_size_t _offset;
+  TRI_voc_size_t _size;
+}
+index_snapshot_entry_t;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief buffered writer for an index snapshot file
+////////////////////////////////////////////////////////////////////////////////
+
+typedef struct index_snapshot_writer_s {
+  int         _fd;
+  uint32_t    _crc;
+  bool        _ok;
+  std::string _buffer;
+}
+index_snapshot_writer_t;
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                 private functions
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief writes the buffered data of an index snapshot to the file
+////////////////////////////////////////////////////////////////////////////////
+
+static void FlushIndexSnapshot (index_snapshot_writer_t* writer) {
+  if (writer->_ok && ! writer->_buffer.empty()) {
+    writer->_ok = TRI_WritePointer(writer->_fd, writer->_buffer.c_str(), writer->_buffer.size());
+  }
+
+  writer->_buffer.clear();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief appends data to an index snapshot
+////////////////////////////////////////////////////////////////////////////////
+
+static void WriteIndexSnapshot (index_snapshot_writer_t* writer,
+                                void const* data,
+                                size_t length) {
+  writer->_crc = TRI_BlockCrc32C(writer->_crc, static_cast<char const*>(data), length);
+  writer->_buffer.append(static_cast<char const*>(data), length);
+
+  if (writer->_buffer.size() >= IndexSnapshotBufferSize) {
+    FlushIndexSnapshot(writer);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief returns the offset of a marker in a datafile, or UINT32_MAX if the
+/// marker is not completely contained in the datafile
+////////////////////////////////////////////////////////////////////////////////
+
+static TRI_voc_size_t MarkerOffsetDatafile (TRI_datafile_t const* datafile,
+                                            void const* marker) {
+  uintptr_t const begin = reinterpret_cast<uintptr_t>(datafile->_data);
+  uintptr_t const end = begin + datafile->_currentSize;
+  uintptr_t const position = reinterpret_cast<uintptr_t>(marker);
+
+  if (position < begin ||
+      position + sizeof(TRI_df_marker_t) > end ||
+      position + static_cast<TRI_df_marker_t const*>(marker)->_size > end) {
+    return UINT32_MAX;
+  }
+
+  return static_cast<TRI_voc_size_t>(position - begin);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief determines the tick range of the markers in a datafile
+///
+/// the range is computed the way the datafile iteration on load computes it:
+/// the minimum is the tick of the first marker, the maximum the largest tick
+/// of all markers. only the marker headers are read
+////////////////////////////////////////////////////////////////////////////////
+
+static void TickRangeDatafile (TRI_datafile_t const* datafile,
+                               TRI_voc_tick_t& tickMin,
+                               TRI_voc_tick_t& tickMax) {
+  char const* ptr = datafile->_data;
+  char const* end = datafile->_data + datafile->_currentSize;
+
+  tickMin = 0;
+  tickMax = 0;
+
+  while (ptr + sizeof(TRI_df_marker_t) <= end) {
+    TRI_df_marker_t const* marker = reinterpret_cast<TRI_df_marker_t const*>(ptr);
+
+    if (marker->_size == 0) {
+      break;
+    }
+
+    if (tickMin == 0) {
+      tickMin = marker->_tick;
+    }
+
+    if (marker->_tick > tickMax) {
+      tickMax = marker->_tick;
+    }
+
+    ptr += TRI_DF_ALIGN_BLOCK(marker->_size);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief returns all datafiles of a collection that a snapshot refers to
+////////////////////////////////////////////////////////////////////////////////
+
+static std::vector<TRI_datafile_t*> SnapshotDatafiles (TRI_document_collection_t* document) {
+  std::vector<TRI_datafile_t*> result;
+
+  for (size_t i = 0; i < document->_datafiles._length; ++i) {
+    result.emplace_back(static_cast<TRI_datafile_t*>(document->_datafiles._buffer[i]));
+  }
+
+  for (size_t i = 0; i < document->_journals._length; ++i) {
+    result.emplace_back(static_cast<TRI_datafile_t*>(document->_journals._buffer[i]));
+  }
+
+  return result;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief writes the index snapshot file of a collection
+///
+/// the snapshot contains the positions of all documents in the primary index
+/// and of all shapes and attributes, plus the statistics that are otherwise
+/// collected while iterating over the datafiles. returns false if no snapshot
+/// can be written for the collection in its current state
+////////////////////////////////////////////////////////////////////////////////
+
+static bool SaveIndexSnapshot (TRI_document_collection_t* document) {
+  char const* name = document->_info._name;
+
+  if (document->_failedTransactions != nullptr &&
+      ! document->_failedTransactions->empty()) {
+    LOG_TRACE("not writing index snapshot for collection '%s': found failed transactions", name);
+    return false;
+  }
+
+  if (document->_compactors._length > 0) {
+    LOG_TRACE("not writing index snapshot for collection '%s': found compactor files", name);
+    return false;
+  }
+
+  if (! TRI_IsFullyCollectedDocumentCollection(document)) {
+    LOG_TRACE("not writing index snapshot for collection '%s': collection has uncollected WAL entries", name);
+    return false;
+  }
+
+  // protects access to the master pointers
+  TransactionBase trx(true);
+
+  std::vector<TRI_datafile_t*> const datafiles = SnapshotDatafiles(document);
+  std::unordered_map<TRI_voc_fid_t, TRI_datafile_t const*> datafilesById;
+
+  for (auto const& datafile : datafiles) {
+    datafilesById.emplace(datafile->_fid, datafile);
+  }
+
+  // collect the shape and attribute markers, which must all have been
+  // transferred into the datafiles
+  std::vector<index_snapshot_entry_t> markers;
+
+  for (auto const& marker : document->getShaper()->markers()) {
+    index_snapshot_entry_t entry;
+    memset(&entry, 0, sizeof(entry));
+    entry._offset = UINT32_MAX;
+
+    for (auto const& datafile : datafiles) {
+      entry._offset = MarkerOffsetDatafile(datafile, marker);
+
+      if (entry._offset != UINT32_MAX) {
+        entry._fid = datafile->_fid;
+        break;
+      }
+    }
+
+    if (entry._offset == UINT32_MAX ||
+        (marker->_type != TRI_DF_MARKER_SHAPE && marker->_type != TRI_DF_MARKER_ATTRIBUTE)) {
+      LOG_TRACE("not writing index snapshot for collection '%s': found shape or attribute outside of datafiles", name);
+      return false;
+    }
+
+    entry._size = marker->_size;
+    markers.emplace_back(entry);
+  }
+
+  auto primaryIndex = document->primaryIndex();
+
+  index_snapshot_header_t header;
+  memset(&header, 0, sizeof(header));
+
+  header._version         = IndexSnapshotVersion;
+  header._numberDatafiles = static_cast<uint32_t>(datafiles.size());
+  header._cid             = document->_info._cid;
+  header._tickMax         = document->_tickMax;
+  header._revision        = document->_info._revision;
+  header._lastKeyValue    = document->_keyGenerator->lastValue();
+  header._numberMarkers   = static_cast<uint64_t>(markers.size());
+  header._numberDocuments = primaryIndex->size();
+
+  char* filename = TRI_Concatenate2File(document->_directory, IndexSnapshotTempFilename);
+
+  if (filename == nullptr) {
+    return false;
+  }
+
+  index_snapshot_writer_t writer;
+  writer._fd  = TRI_CREATE(filename, O_CREAT | O_TRUNC | O_WRONLY, S_IRUSR | S_IWUSR);
+  writer._crc = TRI_InitialCrc32();
+  writer._ok  = (writer._fd >= 0);
+
+  if (! writer._ok) {
+    LOG_WARNING("cannot create index snapshot file '%s': %s", filename, strerror(errno));
+    TRI_FreeString(TRI_CORE_MEM_ZONE, filename);
+    return false;
+  }
+
+  writer._buffer.reserve(IndexSnapshotBufferSize + sizeof(index_snapshot_datafile_t));
+
+  WriteIndexSnapshot(&writer, &header, sizeof(header));
+
+  for (auto const& datafile : datafiles) {
+    index_snapshot_datafile_t state;
+    memset(&state, 0, sizeof(state));
+
+    state._fid         = datafile->_fid;
+    state._dataMin     = datafile->_dataMin;
+    state._dataMax     = datafile->_dataMax;
+    state._currentSize = datafile->_currentSize;
+
+    // the ticks are taken from the markers, so they can be compared with the
+    // datafile's contents when the snapshot is loaded
+    TickRangeDatafile(datafile, state._tickMin, state._tickMax);
+
+    TRI_doc_datafile_info_t const* dfi = TRI_FindDatafileInfoDocumentCollection(document, datafile->_fid, false);
+
+    if (dfi != nullptr) {
+      state._info = *dfi;
+    }
+    state._info._fid = datafile->_fid;
+
+    WriteIndexSnapshot(&writer, &state, sizeof(state));
+  }
+
+  for (auto const& entry : markers) {
+    WriteIndexSnapshot(&writer, &entry, sizeof(entry));
+  }
+
+  uint64_t numberDocuments = 0;
+
+  // documents are written in insertion order, so loading the snapshot 
+  // restores the order
+  std::vector<TRI_doc_mptr_t const*> ordered;
+  document->_headersPtr->ordered(0, static_cast<int64_t>(document->_headersPtr->count()), ordered);
+
+  for (auto const& mptr : ordered) {
+    if (! writer._ok) {
+      break;
+    }
+
+    index_snapshot_entry_t entry;
+    entry._fid    = document->datafileId(mptr->_fidIndex);
+    entry._rid    = mptr->_rid;
+    entry._hash   = mptr->_hash;
+    entry._offset = UINT32_MAX;
+
+    auto it = datafilesById.find(entry._fid);
+
+    if (it != datafilesById.end()) {
+      entry._offset = MarkerOffsetDatafile((*it).second, mptr->getDataPtr());
+    }
+
+    if (entry._offset == UINT32_MAX) {
+      // document is not contained in a datafile of the collection
+      writer._ok = false;
+      break;
+    }
+
+    entry._size = static_cast<TRI_df_marker_t const*>(mptr->getDataPtr())->_size;
+
+    WriteIndexSnapshot(&writer, &entry, sizeof(entry));
+    ++numberDocuments;
+  }
+
+  if (numberDocuments != header._numberDocuments) {
+    writer._ok = false;
+  }
+
+  FlushIndexSnapshot(&writer);
+
+  uint32_t const crc = TRI_FinalCrc32(writer._crc);
+
+  if (writer._ok) {
+    writer._ok = TRI_WritePointer(writer._fd, &crc, sizeof(crc)) && TRI_fsync(writer._fd);
+  }
+
+  TRI_CLOSE(writer._fd);
+
+  if (writer._ok) {
+    char* snapshotFilename = TRI_Concatenate2File(document->_directory, IndexSnapshotFilename);
+
+    writer._ok = (snapshotFilename != nullptr &&
+                  TRI_RenameFile(filename, snapshotFilename) == TRI_ERROR_NO_ERROR);
+
+    if (snapshotFilename != nullptr) {
+      TRI_FreeString(TRI_CORE_MEM_ZONE, snapshotFilename);
+    }
+  }
+
+  if (! writer._ok) {
+    LOG_DEBUG("unable to write index snapshot for collection '%s'", name);
+    TRI_UnlinkFile(filename);
+  }
+
+  TRI_FreeString(TRI_CORE_MEM_ZONE, filename);
+
+  return writer._ok;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief validates a memory-mapped index snapshot against the datafiles of
+/// the collection
+////////////////////////////////////////////////////////////////////////////////
+
+static bool ValidateIndexSnapshot (TRI_document_collection_t* document,
+                                   char const* data,
+                                   size_t size,
+                                   std::unordered_map<TRI_voc_fid_t, TRI_datafile_t*> const& datafilesById) {
+  if (size < sizeof(index_snapshot_header_t) + sizeof(uint32_t)) {
+    return false;
+  }
+
+  uint32_t crc;
+  memcpy(&crc, data + size - sizeof(uint32_t), sizeof(uint32_t));
+
+  if (crc != TRI_FinalCrc32(TRI_BlockCrc32C(TRI_InitialCrc32(), data, size - sizeof(uint32_t)))) {
+    return false;
+  }
+
+  auto header = reinterpret_cast<index_snapshot_header_t const*>(data);
+
+  if (header->_version != IndexSnapshotVersion ||
+      header->_cid != document->_info._cid ||
+      header->_numberDatafiles != datafilesById.size()) {
+    return false;
+  }
+
+  uint64_t const numberEntries = header->_numberMarkers + header->_numberDocuments;
+
+  if (size != sizeof(index_snapshot_header_t) +
+              header->_numberDatafiles * sizeof(index_snapshot_datafile_t) +
+              numberEntries * sizeof(index_snapshot_entry_t) +
+              sizeof(uint32_t)) {
+    return false;
+  }
+
+  // the datafiles must not have changed since the snapshot was written
+  auto state = reinterpret_cast<index_snapshot_datafile_t const*>(header + 1);
+
+  for (uint32_t i = 0; i < header->_numberDatafiles; ++i, ++state) {
+    auto it = datafilesById.find(state->_fid);
+
+    if (it == datafilesById.end() ||
+        (*it).second->_currentSize != state->_currentSize) {
+      return false;
+    }
+
+    TRI_voc_tick_t tickMin;
+    TRI_voc_tick_t tickMax;
+    TickRangeDatafile((*it).second, tickMin, tickMax);
+
+    if (tickMin != state->_tickMin ||
+        tickMax != state->_tickMax) {
+      return false;
+    }
+  }
+
+  // all entries must point into the datafiles
+  auto entry = reinterpret_cast<index_snapshot_entry_t const*>(state);
+
+  for (uint64_t i = 0; i < numberEntries; ++i, ++entry) {
+    auto it = datafilesById.find(entry->_fid);
+
+    if (it == datafilesById.end() ||
+        static_cast<uint64_t>(entry->_offset) + entry->_size > (*it).second->_currentSize ||
+        entry->_size < sizeof(TRI_df_marker_t)) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief restores the state of a collection from a validated index snapshot
+////////////////////////////////////////////////////////////////////////////////
+
+static int ApplyIndexSnapshot (TRI_document_collection_t* document,
+                               char const* data,
+                               std::unordered_map<TRI_voc_fid_t, TRI_datafile_t*> const& datafilesById) {
+  auto header = reinterpret_cast<index_snapshot_header_t const*>(data);
+  auto primaryIndex = document->primaryIndex();
+
+  if (header->_numberDocuments > 0) {
+    int res = primaryIndex->resize(static_cast<size_t>(header->_numberDocuments * 1.1));
+
+    if (res != TRI_ERROR_NO_ERROR) {
+      return res;
+    }
+  }
+
+  // datafile statistics
+  auto state = reinterpret_cast<index_snapshot_datafile_t const*>(header + 1);
+
+  for (uint32_t i = 0; i < header->_numberDatafiles; ++i, ++state) {
+    TRI_datafile_t* datafile = (*datafilesById.find(state->_fid)).second;
+
+    datafile->_tickMin = state->_tickMin;
+    datafile->_tickMax = state->_tickMax;
+    datafile->_dataMin = state->_dataMin;
+    datafile->_dataMax = state->_dataMax;
+
+    TRI_doc_datafile_info_t* dfi = TRI_FindDatafileInfoDocumentCollection(document, state->_fid, true);
+
+    if (dfi == nullptr) {
+      return TRI_ERROR_OUT_OF_MEMORY;
+    }
+
+    *dfi = state->_info;
+  }
+
+  // shapes and attributes
+  auto entry = reinterpret_cast<index_snapshot_entry_t const*>(state);
+  auto shaper = document->getShaper();  // ONLY IN OPENCOLLECTION, PROTECTED by fake trx from caller
+
+  for (uint64_t i = 0; i < header->_numberMarkers; ++i, ++entry) {
+    auto marker = reinterpret_cast<TRI_df_marker_t const*>((*datafilesById.find(entry->_fid)).second->_data + entry->_offset);
+    int res;
+
+    if (marker->_type == TRI_DF_MARKER_SHAPE) {
+      res = shaper->insertShape(marker, true);
+    }
+    else if (marker->_type == TRI_DF_MARKER_ATTRIBUTE) {
+      res = shaper->insertAttribute(marker, true);
+    }
+    else {
+      res = TRI_ERROR_ARANGO_CORRUPTED_DATAFILE;
+    }
+
+    if (res != TRI_ERROR_NO_ERROR) {
+      return res;
+    }
+  }
+
+  // documents
+  TRI_voc_fid_t fid = 0;
+  uint32_t fidIndex = 0;
+  char const* base = nullptr;
+
+  for (uint64_t i = 0; i < header->_numberDocuments; ++i, ++entry) {
+    if (entry->_fid != fid) {
+      fid = entry->_fid;
+      fidIndex = document->datafileIndex(fid);
+      base = (*datafilesById.find(fid)).second->_data;
+    }
+
+    TRI_doc_mptr_t* mptr = document->_headersPtr->request(entry->_size);  // ONLY IN OPENCOLLECTION
+
+    if (mptr == nullptr) {
+      return TRI_ERROR_OUT_OF_MEMORY;
+    }
+
+    mptr->_rid      = entry->_rid;
+    mptr->_fidIndex = fidIndex;
+    mptr->_hash     = entry->_hash;
+    mptr->setDataPtr(base + entry->_offset);  // ONLY IN OPENCOLLECTION
+
+    primaryIndex->insertKey(mptr);
+    ++document->_numberDocuments;
+  }
+
+  document->_tickMax = header->_tickMax;
+  SetRevision(document, header->_revision, false);
+
+  if (header->_lastKeyValue > 0) {
+    std::string lastKey = std::to_string(header->_lastKeyValue);
+    document->_keyGenerator->track(&lastKey[0]);
+  }
+
+  return TRI_ERROR_NO_ERROR;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief loads the primary index and the statistics of a collection from its
+/// index snapshot, if there is a valid one
+///
+/// sets loaded to false if there is no usable snapshot. the collection is not
+/// modified then, and its datafiles must be iterated instead. the snapshot
+/// file is removed in any case, so it cannot become stale
+////////////////////////////////////////////////////////////////////////////////
+
+static int LoadIndexSnapshot (TRI_document_collection_t* document,
+                              bool& loaded) {
+  loaded = false;
+
+  char* filename = TRI_Concatenate2File(document->_directory, IndexSnapshotFilename);
+
+  if (filename == nullptr) {
+    return TRI_ERROR_OUT_OF_MEMORY;
+  }
+
+  if (! TRI_ExistsFile(filename)) {
+    TRI_FreeString(TRI_CORE_MEM_ZONE, filename);
+    return TRI_ERROR_NO_ERROR;
+  }
+
+  int res = TRI_ERROR_NO_ERROR;
+
+  if (document->_vocbase->_server->_indexSnapshots &&
+      document->_compactors._length == 0) {
+    int64_t size = TRI_SizeFile(filename);
+    int fd = TRI_OPEN(filename, O_RDONLY);
+
+    if (fd >= 0 && size > 0) {
+      void* mmHandle;
+      void* data;
+
+      if (TRI_MMFile(nullptr, static_cast<size_t>(size), PROT_READ, MAP_SHARED, fd, &mmHandle, 0, &data) == TRI_ERROR_NO_ERROR) {
+        std::unordered_map<TRI_voc_fid_t, TRI_datafile_t*> datafilesById;
+
+        for (auto const& datafile : SnapshotDatafiles(document)) {
+          datafilesById.emplace(datafile->_fid, datafile);
+        }
+
+        if (ValidateIndexSnapshot(document, static_cast<char const*>(data), static_cast<size_t>(size), datafilesById)) {
+          res = ApplyIndexSnapshot(document, static_cast<char const*>(data), datafilesById);
+          loaded = true;
+        }
+        else {
+          LOG_INFO("ignoring outdated index snapshot for collection '%s'", document->_info._name);
+        }
+
+        TRI_UNMMFile(data, static_cast<size_t>(size), fd, &mmHandle);
+      }
+    }
+
+    if (fd >= 0) {
+      TRI_CLOSE(fd);
+    }
+  }
+
+  TRI_UnlinkFile(filename);
+  TRI_FreeString(TRI_CORE_MEM_ZONE, filename);
+
+  return res;
+}
+
 // -----------------------------------------------------------------------------
 // --SECTION--                                      constructors and destructors
 // -----------------------------------------------------------------------------
@@ -2611,20 +3413,16 @@ size_t TRI_DocumentIteratorDocumentCollection (TransactionBase const*,
   // master pointers and their data pointers in the callback are
   // protected.
 
-  auto primaryIndex = document->primaryIndex()->internals();
-  size_t const nrUsed = static_cast<size_t>(primaryIndex->_nrUsed);
+  auto primaryIndex = document->primaryIndex();
+  size_t const nrUsed = static_cast<size_t>(primaryIndex->size());
 
   if (nrUsed > 0) {
-    void** ptr = primaryIndex->_table;
-    void** end = ptr + primaryIndex->_nrAlloc;
-
-    for (;  ptr < end;  ++ptr) {
-      if (*ptr) {
-        auto d = (TRI_doc_mptr_t const*) *ptr;
+    triagens::arango::PrimaryIndex::Position position;
+    TRI_doc_mptr_t const* d;
 
-        if (! callback(d, document, data)) {
-          break;
-        }
+    while ((d = primaryIndex->lookupSequential(position)) != nullptr) {
+      if (! callback(d, document, data)) {
+        break;
       }
     }
   }
@@ -2916,9 +3714,9 @@ int TRI_FillIndexesDocumentCollection (TRI_vocbase_col_t* collection,
 
   // only log performance infos for indexes with more than this number of entries
   static size_t const NotificationSizeThreshold = 131072; 
-  auto primaryIndex = document->primaryIndex()->internals();
+  auto primaryIndex = document->primaryIndex();
 
-  if ((n > 1) && (primaryIndex->_nrUsed > NotificationSizeThreshold)) {
+  if ((n > 1) && (primaryIndex->size() > NotificationSizeThreshold)) {
     LOG_ACTION("fill-indexes-document-collection { collection: %s/%s }, n: %d", 
                document->_vocbase->_name,
                document->_info._name,
@@ -3065,17 +3863,34 @@ TRI_document_collection_t* TRI_OpenDocumentCollection (TRI_vocbase_t* vocbase,
   {
     double start = TRI_microtime();
 
-    LOG_ACTION("iterate-markers { collection: %s/%s }", 
+    LOG_ACTION("load-index-snapshot { collection: %s/%s }", 
                vocbase->_name,
                document->_info._name);
 
-    // iterate over all markers of the collection
-    int res = IterateMarkersCollection(collection);
-  
+    // try the index snapshot written when the collection was last unloaded
+    bool loaded;
+    int res = LoadIndexSnapshot(document, loaded);
+    
     LOG_TIMER((TRI_microtime() - start),
-              "iterate-markers { collection: %s/%s }", 
+              "load-index-snapshot { collection: %s/%s }", 
               vocbase->_name,
               document->_info._name);
+
+    if (res == TRI_ERROR_NO_ERROR && ! loaded) {
+      start = TRI_microtime();
+
+      LOG_ACTION("iterate-markers { collection: %s/%s }", 
+                 vocbase->_name,
+                 document->_info._name);
+
+      // iterate over all markers of the collection
+      res = IterateMarkersCollection(collection);
+    
+      LOG_TIMER((TRI_microtime() - start),
+                "iterate-markers { collection: %s/%s }", 
+                vocbase->_name,
+                document->_info._name);
+    }
   
     if (res != TRI_ERROR_NO_ERROR) {
       if (document->_failedTransactions != nullptr) {
@@ -3111,17 +3926,24 @@ TRI_document_collection_t* TRI_OpenDocumentCollection (TRI_vocbase_t* vocbase,
 
 int TRI_CloseDocumentCollection (TRI_document_collection_t* document,
                                  bool updateStats) {
-  auto primaryIndex = document->primaryIndex()->internals();
+  uint64_t const nrUsed = document->primaryIndex()->size();
 
   if (! document->_info._deleted &&
-      document->_info._initialCount != static_cast<int64_t>(primaryIndex->_nrUsed)) {
+      document->_info._initialCount != static_cast<int64_t>(nrUsed)) {
     // update the document count
-    document->_info._initialCount = primaryIndex->_nrUsed;
+    document->_info._initialCount = nrUsed;
     
     bool doSync = document->_vocbase->_settings.forceSyncProperties;
     TRI_SaveCollectionInfo(document->_directory, &document->_info, doSync);
   }
 
+  if (updateStats &&
+      ! document->_info._deleted &&
+      document->_vocbase->_server->_indexSnapshots) {
+    // the datafiles must still be mapped to write the snapshot
+    SaveIndexSnapshot(document);
+  }
+
   // closes all open compactors, journals, datafiles
   int res = TRI_CloseCollection(document);
 
@@ -3205,18 +4027,16 @@ static int FillIndexBatch (TRI_document_collection_t* document,
             (int) document->_info._indexBuckets);
 
   // give the index a size hint
-  auto primaryIndex = document->primaryIndex()->internals();
-
-  void** ptr = primaryIndex->_table;
-  void** end = ptr + primaryIndex->_nrAlloc;
+  auto primaryIndex = document->primaryIndex();
+  size_t const nrUsed = static_cast<size_t>(primaryIndex->size());
 
-  idx->sizeHint(static_cast<size_t>(primaryIndex->_nrUsed));
+  idx->sizeHint(nrUsed);
 
   // process documents a million at a time
   size_t blockSize = 1024 * 1024; 
 
-  if (primaryIndex->_nrUsed < blockSize) {
-    blockSize = primaryIndex->_nrUsed;
+  if (nrUsed < blockSize) {
+    blockSize = nrUsed;
   }
   if (blockSize == 0) {
     blockSize = 1;
@@ -3227,20 +4047,19 @@ static int FillIndexBatch (TRI_document_collection_t* document,
   std::vector<TRI_doc_mptr_t const*> documents;
   documents.reserve(blockSize);
 
-  for (;  ptr < end;  ++ptr) {
-    auto mptr = static_cast<TRI_doc_mptr_t const*>(*ptr);
+  triagens::arango::PrimaryIndex::Position position;
+  TRI_doc_mptr_t const* mptr;
 
-    if (mptr != nullptr) {
-      documents.emplace_back(mptr);
+  while ((mptr = primaryIndex->lookupSequential(position)) != nullptr) {
+    documents.emplace_back(mptr);
 
-      if (documents.size() == blockSize) {
-        res = idx->batchInsert(&documents, indexPool->numThreads());
-        documents.clear();
+    if (documents.size() == blockSize) {
+      res = idx->batchInsert(&documents, indexPool->numThreads());
+      documents.clear();
 
-        // some error occurred
-        if (res != TRI_ERROR_NO_ERROR) {
-          break;
-        }
+      // some error occurred
+      if (res != TRI_ERROR_NO_ERROR) {
+        break;
       }
     }
   }
@@ -3277,12 +4096,9 @@ static int FillIndexSequential (TRI_document_collection_t* document,
             (int) document->_info._indexBuckets);
 
   // give the index a size hint
-  auto primaryIndex = document->primaryIndex()->internals();
-
-  void** ptr = primaryIndex->_table;
-  void** end = ptr + primaryIndex->_nrAlloc;
+  auto primaryIndex = document->primaryIndex();
   
-  idx->sizeHint(static_cast<size_t>(primaryIndex->_nrUsed));
+  idx->sizeHint(static_cast<size_t>(primaryIndex->size()));
 
 #ifdef TRI_ENABLE_MAINTAINER_MODE
   static const int LoopSize = 10000;
@@ -3290,27 +4106,25 @@ static int FillIndexSequential (TRI_document_collection_t* document,
   int loops = 0;
 #endif
 
-  for (;  ptr < end;  ++ptr) {
-    auto mptr = static_cast<TRI_doc_mptr_t const*>(*ptr);
+  triagens::arango::PrimaryIndex::Position position;
+  TRI_doc_mptr_t const* mptr;
 
-    if (mptr != nullptr) {
-      int res = idx->insert(mptr, false);
+  while ((mptr = primaryIndex->lookupSequential(position)) != nullptr) {
+    int res = idx->insert(mptr, false);
 
-      if (res != TRI_ERROR_NO_ERROR) {
-        return res;
-      }
+    if (res != TRI_ERROR_NO_ERROR) {
+      return res;
+    }
 
 #ifdef TRI_ENABLE_MAINTAINER_MODE
-      if (++counter == LoopSize) {
-        counter = 0;
-        ++loops;
-        LOG_TRACE("indexed %llu documents of collection %llu",
-                  (unsigned long long) (LoopSize * loops),
-                  (unsigned long long) document->_info._cid);
-      }
-#endif
-
+    if (++counter == LoopSize) {
+      counter = 0;
+      ++loops;
+      LOG_TRACE("indexed %llu documents of collection %llu",
+                (unsigned long long) (LoopSize * loops),
+                (unsigned long long) document->_info._cid);
     }
+#endif
   }
   
   LOG_TIMER((TRI_microtime() - start),
@@ -3335,14 +4149,14 @@ static int FillIndex (TRI_document_collection_t* document,
   }
 
   try {
-    auto primaryIndex = document->primaryIndex()->internals();
+    auto primaryIndex = document->primaryIndex();
     auto indexPool = document->_vocbase->_server->_indexPool;
  
     int res;
 
     if (indexPool != nullptr && 
         idx->hasBatchInsert() && 
-        primaryIndex->_nrUsed > 256 * 1024 &&
+        primaryIndex->size() > 256 * 1024 &&
         document->_info._indexBuckets > 1) {
       // use batch insert if there is an index pool,
       // the collection has more than one index bucket
@@ -3690,6 +4504,7 @@ bool TRI_DropIndexDocumentCollection (TRI_document_collection_t* document,
     TRI_WRITE_LOCK_DOCUMENTS_INDEXES_PRIMARY_COLLECTION(document);
   
     triagens::aql::QueryCache::instance()->invalidate(vocbase, document->_info._name);
+    triagens::aql::PlanCache::instance()->invalidate(vocbase, document->_info._name);
     found = document->removeIndex(iid);
   
     TRI_WRITE_UNLOCK_DOCUMENTS_INDEXES_PRIMARY_COLLECTION(document);
@@ -3963,6 +4778,7 @@ triagens::arango::Index* TRI_EnsureCapConstraintDocumentCollection (TRI_document
   if (idx != nullptr) {
     if (created) {
       triagens::aql::QueryCache::instance()->invalidate(document->_vocbase, document->_info._name);
+      triagens::aql::PlanCache::instance()->invalidate(document->_vocbase, document->_info._name);
       int res = TRI_SaveIndex(document, idx, true);
 
       if (res != TRI_ERROR_NO_ERROR) {
@@ -4291,6 +5107,7 @@ triagens::arango::Index* TRI_EnsureGeoIndex1DocumentCollection (TRI_document_col
   if (idx != nullptr) {
     if (created) {
       triagens::aql::QueryCache::instance()->invalidate(document->_vocbase, document->_info._name);
+      triagens::aql::PlanCache::instance()->invalidate(document->_vocbase, document->_info._name);
       int res = TRI_SaveIndex(document, idx, true);
 
       if (res != TRI_ERROR_NO_ERROR) {
@@ -4322,6 +5139,7 @@ triagens::arango::Index* TRI_EnsureGeoIndex2DocumentCollection (TRI_document_col
   if (idx != nullptr) {
     if (created) {
       triagens::aql::QueryCache::instance()->invalidate(document->_vocbase, document->_info._name);
+      triagens::aql::PlanCache::instance()->invalidate(document->_vocbase, document->_info._name);
       int res = TRI_SaveIndex(document, idx, true);
 
       if (res != TRI_ERROR_NO_ERROR) {
@@ -4489,6 +5307,7 @@ triagens::arango::Index* TRI_EnsureHashIndexDocumentCollection (TRI_document_col
   if (idx != nullptr) {
     if (created) {
       triagens::aql::QueryCache::instance()->invalidate(document->_vocbase, document->_info._name);
+      triagens::aql::PlanCache::instance()->invalidate(document->_vocbase, document->_info._name);
       int res = TRI_SaveIndex(document, idx, true);
 
       if (res != TRI_ERROR_NO_ERROR) {
@@ -4653,6 +5472,7 @@ triagens::arango::Index* TRI_EnsureSkiplistIndexDocumentCollection (TRI_document
   if (idx != nullptr) {
     if (created) {
       triagens::aql::QueryCache::instance()->invalidate(document->_vocbase, document->_info._name);
+      triagens::aql::PlanCache::instance()->invalidate(document->_vocbase, document->_info._name);
       int res = TRI_SaveIndex(document, idx, true);
 
       if (res != TRI_ERROR_NO_ERROR) {
@@ -4849,6 +5669,7 @@ triagens::arango::Index* TRI_EnsureFulltextIndexDocumentCollection (TRI_document
   if (idx != nullptr) {
     if (created) {
       triagens::aql::QueryCache::instance()->invalidate(document->_vocbase, document->_info._name);
+      triagens::aql::PlanCache::instance()->invalidate(document->_vocbase, document->_info._name);
       int res = TRI_SaveIndex(document, idx, true);
 
       if (res != TRI_ERROR_NO_ERROR) {
@@ -4889,17 +5710,13 @@ std::vector<TRI_doc_mptr_copy_t> TRI_SelectByExample (
   std::vector<TRI_doc_mptr_copy_t> filtered;
 
   // do a full scan
-  auto primaryIndex = document->primaryIndex()->internals();
-  TRI_doc_mptr_t** ptr = (TRI_doc_mptr_t**) primaryIndex->_table;
-  TRI_doc_mptr_t** end = (TRI_doc_mptr_t**) ptr + primaryIndex->_nrAlloc;
-
   // TODO Right now this space is protected by JS for internal Attributes.
   // cid is not required here. But this is subject to change in the future
-  for (;  ptr < end;  ++ptr) {
-    if (matcher.matches(0, *ptr)) {
-      filtered.emplace_back(**ptr);
+  document->primaryIndex()->invokeOnAllElements([&matcher, &filtered] (TRI_doc_mptr_t* ptr) -> void {
+    if (matcher.matches(0, ptr)) {
+      filtered.emplace_back(*ptr);
     }
-  }
+  });
   return filtered;
 }
 
@@ -4918,29 +5735,22 @@ CountingAggregation* TRI_AggregateBySingleAttribute (
   auto shaper = document->getShaper();
 
   // do a full scan
-  auto primaryIndex = document->primaryIndex()->internals();
-  TRI_doc_mptr_t** ptr = (TRI_doc_mptr_t**) primaryIndex->_table;
-  TRI_doc_mptr_t** end = (TRI_doc_mptr_t**) ptr + primaryIndex->_nrAlloc;
-
-  for (;  ptr < end;  ++ptr) {
-    if (*ptr != nullptr) {
-      TRI_doc_mptr_t* m = *ptr;
-      TRI_shape_sid_t sid;
-      TRI_EXTRACT_SHAPE_IDENTIFIER_MARKER(sid, m->getDataPtr());
-      TRI_shape_access_t const* accessor = shaper->findAccessor(sid, pid);
-      TRI_shaped_json_t shapedJson;
-      TRI_EXTRACT_SHAPED_JSON_MARKER(shapedJson, m->getDataPtr());
-      TRI_shaped_json_t resultJson;
-      TRI_ExecuteShapeAccessor(accessor, &shapedJson, &resultJson);
-      auto it = agg->find(resultJson);
-      if (it == agg->end()) {
-        agg->insert(std::make_pair(resultJson, 1));
-      }
-      else {
-        it->second++;
-      }
+  document->primaryIndex()->invokeOnAllElements([&agg, &shaper, &pid] (TRI_doc_mptr_t* m) -> void {
+    TRI_shape_sid_t sid;
+    TRI_EXTRACT_SHAPE_IDENTIFIER_MARKER(sid, m->getDataPtr());
+    TRI_shape_access_t const* accessor = shaper->findAccessor(sid, pid);
+    TRI_shaped_json_t shapedJson;
+    TRI_EXTRACT_SHAPED_JSON_MARKER(shapedJson, m->getDataPtr());
+    TRI_shaped_json_t resultJson;
+    TRI_ExecuteShapeAccessor(accessor, &shapedJson, &resultJson);
+    auto it = agg->find(resultJson);
+    if (it == agg->end()) {
+      agg->insert(std::make_pair(resultJson, 1));
     }
-  }
+    else {
+      it->second++;
+    }
+  });
   return agg;
 }
 
@@ -4960,6 +5770,54 @@ int TRI_DeleteDocumentDocumentCollection (TRI_transaction_collection_t* trxColle
                                                 false);  // PROTECTED by trx in trxCollection
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief asks the kernel to read the datafiles and journals of the collection
+/// into memory ahead of a full scan
+////////////////////////////////////////////////////////////////////////////////
+
+bool TRI_PrefetchDocumentCollection (TRI_document_collection_t* document) {
+  if (TRI_PhysicalMemory == 0) {
+    return false;
+  }
+
+  // the memory regions containing data. the advice is given after the lock
+  // is released. advising a region that was unmapped in the meantime is
+  // harmless
+  std::vector<std::pair<void*, size_t>> regions;
+  uint64_t size = 0;
+
+  TRI_READ_LOCK_DATAFILES_DOC_COLLECTION(document);
+
+  try {
+    for (auto const* files : { &document->_datafiles, &document->_journals }) {
+      for (size_t i = 0; i < files->_length; ++i) {
+        auto df = static_cast<TRI_datafile_t const*>(files->_buffer[i]);
+
+        if (df->_data != nullptr && df->_currentSize > 0) {
+          regions.emplace_back(df->_data, static_cast<size_t>(df->_currentSize));
+          size += df->_currentSize;
+        }
+      }
+    }
+  }
+  catch (...) {
+    TRI_READ_UNLOCK_DATAFILES_DOC_COLLECTION(document);
+    return false;
+  }
+
+  TRI_READ_UNLOCK_DATAFILES_DOC_COLLECTION(document);
+
+  if (size > TRI_PhysicalMemory / 4) {
+    return false;
+  }
+
+  for (auto const& it : regions) {
+    TRI_MMFileAdvise(it.first, it.second, TRI_MADVISE_WILLNEED);
+  }
+
+  return true;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief rotate the current journal of the collection
 /// use this for testing only
@@ -34,8 +34,10 @@
 #include "Basics/Common.h"
 #include "Basics/fasthash.h"
 #include "Basics/JsonHelper.h"
+#include "Basics/ReadWriteLock.h"
 #include "Basics/ReadWriteLockCPP11.h"
 #include "VocBase/collection.h"
+#include "VocBase/compressed-json.h"
 #include "VocBase/Ditch.h"
 #include "VocBase/headers.h"
 #include "VocBase/transaction.h"
@@ -123,46 +125,52 @@ class KeyGenerator;
 
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief master pointer
+///
+/// there is one master pointer per document, so its size matters. it has no
+/// vtable outside of maintainer mode and does not store the full datafile id,
+/// but the datafile's index in its collection, see
+/// TRI_document_collection_t::datafileId(). the order of documents by insertion
+/// and update is kept by the collection's headers, see TRI_headers_t
 ////////////////////////////////////////////////////////////////////////////////
 
 struct TRI_doc_mptr_t {
-    TRI_voc_rid_t          _rid;     // this is the revision identifier
-    TRI_voc_fid_t          _fid;     // this is the datafile identifier
-    uint64_t               _hash;    // the pre-calculated hash value of the key
-    TRI_doc_mptr_t*        _prev;    // previous master pointer
-    TRI_doc_mptr_t*        _next;    // next master pointer
+    TRI_voc_rid_t          _rid;      // this is the revision identifier
+    uint64_t               _hash;     // the pre-calculated hash value of the key
+    uint32_t               _fidIndex; // index of the datafile in the collection
+    uint32_t               _position; // position in the insertion order
   protected:
-    void const*            _dataptr; // this is the pointer to the beginning of the raw marker
+    void const*            _dataptr;  // this is the pointer to the beginning of the raw marker
 
   public:
     TRI_doc_mptr_t () : _rid(0), 
-                        _fid(0), 
                         _hash(0),
-                        _prev(nullptr),
-                        _next(nullptr),
+                        _fidIndex(0), 
+                        _position(0),
                         _dataptr(nullptr) {
     }
 
+#ifdef TRI_ENABLE_MAINTAINER_MODE
+    // originals and copies check data pointer accesses differently
     virtual ~TRI_doc_mptr_t () {
     }
+#endif
 
     void clear () {
+      // the position is kept, as stale slots in the insertion order must not
+      // refer to a released header
       _rid = 0;
-      _fid = 0;
+      _fidIndex = 0;
       setDataPtr(nullptr);
       _hash = 0;
-      _prev = nullptr;
-      _next = nullptr;
     }
 
     void copy (TRI_doc_mptr_t const& that) {
       // This is for cases where we explicitly have to copy originals!
       _rid = that._rid;
-      _fid = that._fid;
+      _fidIndex = that._fidIndex;
+      _position = that._position;
       _dataptr = that._dataptr;
       _hash = that._hash;
-      _prev = that._prev;
-      _next = that._next;
     }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -211,8 +219,14 @@ struct TRI_doc_mptr_t {
 
       if (marker->_type == TRI_DOC_MARKER_KEY_DOCUMENT ||
           marker->_type == TRI_DOC_MARKER_KEY_EDGE) {
-        auto offset = (reinterpret_cast<TRI_doc_document_key_marker_t const*>(marker))->_offsetJson;
-        return static_cast<char const*>(_dataptr) + offset;
+        auto m = reinterpret_cast<TRI_doc_document_key_marker_t const*>(marker);
+
+        if (TRI_IsCompressedJsonMarker(m)) {
+          size_t length;
+          return TRI_UncompressedJsonMarker(m, length);
+        }
+
+        return static_cast<char const*>(_dataptr) + m->_offsetJson;
       }
       else if (marker->_type == TRI_WAL_MARKER_DOCUMENT ||
                marker->_type == TRI_WAL_MARKER_EDGE) {
@@ -346,6 +360,11 @@ typedef struct TRI_doc_collection_info_s {
 
   TRI_voc_tick_t  _tickMax;
   uint64_t        _uncollectedLogfileEntries;
+
+  int64_t         _numberCompressed;
+  int64_t         _sizeUncompressed;
+  int64_t         _sizeCompressed;
+  int64_t         _compressionTime;
 }
 TRI_doc_collection_info_t;
 
@@ -410,14 +429,41 @@ public:
   mutable triagens::arango::Ditches      _ditches;
   TRI_associative_pointer_t              _datafileInfo;
 
+  // map a datafile id to the index stored in master pointers and back
+  uint32_t datafileIndex (TRI_voc_fid_t);
+  TRI_voc_fid_t datafileId (uint32_t) const;
+  void releaseDatafileIndex (TRI_voc_fid_t);
+
+private:
+  static uint32_t const DatafileSlotMask = 0x00ffffff;
+
+  mutable triagens::basics::ReadWriteLock               _datafileIdsLock;
+  std::vector<std::pair<TRI_voc_fid_t, uint32_t>>       _datafileIds;
+  std::unordered_map<TRI_voc_fid_t, uint32_t>           _datafileIndexes;
+  std::vector<uint32_t>                                 _freeDatafileSlots;
+  std::atomic<TRI_voc_fid_t>                            _lastDatafileId;
+  std::atomic<uint32_t>                                 _lastDatafileIndex;
+
+public:
   TRI_headers_t*                         _headersPtr;
   KeyGenerator*                          _keyGenerator;
 
+  // NUMA node for the in-memory structures (headers, primary and edge index)
+  int                                    _numaNode;
+
   std::vector<triagens::arango::Index*>  _indexes;
 
   std::set<TRI_voc_tid_t>*               _failedTransactions;
 
   std::atomic<int64_t>                   _uncollectedLogfileEntries;
+
+  // statistics about compressed document bodies written since the collection
+  // was loaded. the compression time is in microseconds
+  std::atomic<int64_t>                   _numberCompressed;
+  std::atomic<int64_t>                   _sizeUncompressed;
+  std::atomic<int64_t>                   _sizeCompressed;
+  std::atomic<int64_t>                   _compressionTime;
+
   int64_t                                _numberDocuments;
   TRI_read_write_lock_t                  _compactionLock;
   double                                 _lastCompaction;
@@ -1082,6 +1128,18 @@ int TRI_DeleteDocumentDocumentCollection (struct TRI_transaction_collection_s*,
                                           TRI_doc_update_policy_t const*,
                                           TRI_doc_mptr_t*);
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief asks the kernel to read the datafiles and journals of the collection
+/// into memory ahead of a full scan
+///
+/// this is skipped if the data would take up more than a quarter of the
+/// physical memory, because the prefetched pages would then evict each other.
+/// returns whether the data were prefetched. the caller must prevent the
+/// datafiles from being unloaded, e.g. via a ditch
+////////////////////////////////////////////////////////////////////////////////
+
+bool TRI_PrefetchDocumentCollection (TRI_document_collection_t*);
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief rotate the current journal of the collection
 /// use this for testing only
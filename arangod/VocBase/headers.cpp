@@ -56,10 +56,49 @@ static inline size_t GetBlockSize (size_t blockNumber) {
   }
 
   // use a block size of 32768
-  // this will use 32768 * sizeof(TRI_doc_mptr_t) bytes, i.e. 1.5 MB
+  // this will use 32768 * sizeof(TRI_doc_mptr_t) bytes, i.e. 1 MB
   return (size_t) (BLOCK_SIZE_UNIT << 8);
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief allocates a block of headers on a NUMA node
+////////////////////////////////////////////////////////////////////////////////
+
+static TRI_doc_mptr_t* AllocateBlock (size_t blockSize,
+                                      int numaNode) {
+  void* memory = TRI_NumaAllocate(blockSize * sizeof(TRI_doc_mptr_t), numaNode, false);
+
+  if (memory == nullptr) {
+    return nullptr;
+  }
+
+  TRI_doc_mptr_t* begin = static_cast<TRI_doc_mptr_t*>(memory);
+
+  for (size_t i = 0; i < blockSize; ++i) {
+    new (begin + i) TRI_doc_mptr_t();
+  }
+
+  return begin;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief frees a block of headers
+////////////////////////////////////////////////////////////////////////////////
+
+static void FreeBlock (TRI_doc_mptr_t* begin,
+                       size_t blockSize,
+                       int numaNode) {
+  if (begin == nullptr) {
+    return;
+  }
+
+  for (size_t i = 0; i < blockSize; ++i) {
+    begin[i].~TRI_doc_mptr_t();
+  }
+
+  TRI_NumaFree(begin, blockSize * sizeof(TRI_doc_mptr_t), numaNode);
+}
+
 // -----------------------------------------------------------------------------
 // --SECTION--                                        constructors & destructors
 // -----------------------------------------------------------------------------
@@ -68,13 +107,14 @@ static inline size_t GetBlockSize (size_t blockNumber) {
 /// @brief creates the headers
 ////////////////////////////////////////////////////////////////////////////////
 
-TRI_headers_t::TRI_headers_t ()
+TRI_headers_t::TRI_headers_t (int numaNode)
   : _freelist(nullptr),
-    _begin(nullptr),
-    _end(nullptr),
     _nrAllocated(0),
     _nrLinked(0),
-    _totalSize(0) {
+    _totalSize(0),
+    _numaNode(numaNode),
+    _order(),
+    _orderBase(0) {
 
   TRI_InitVectorPointer(&_blocks, TRI_UNKNOWN_MEM_ZONE, 16);
 }
@@ -85,7 +125,7 @@ TRI_headers_t::TRI_headers_t ()
 
 TRI_headers_t::~TRI_headers_t () {
   for (size_t i = 0;  i < _blocks._length;  ++i) {
-    delete[] static_cast<TRI_doc_mptr_t*>(_blocks._buffer[i]);
+    FreeBlock(static_cast<TRI_doc_mptr_t*>(_blocks._buffer[i]), GetBlockSize(i), _numaNode);
   }
 
   TRI_DestroyVectorPointer(&_blocks);
@@ -96,7 +136,7 @@ TRI_headers_t::~TRI_headers_t () {
 // -----------------------------------------------------------------------------
 
 ////////////////////////////////////////////////////////////////////////////////
-/// @brief moves an existing header to the end of the list
+/// @brief moves an existing header to the end of the insertion order
 /// this is called when there is an update operation on a document
 ////////////////////////////////////////////////////////////////////////////////
 
@@ -110,12 +150,6 @@ void TRI_headers_t::moveBack (TRI_doc_mptr_t* header,
   TRI_ASSERT(_nrLinked > 0);
   TRI_ASSERT(_totalSize > 0);
 
-  // we have at least one element in the list
-  TRI_ASSERT(_begin != nullptr);
-  TRI_ASSERT(_end != nullptr);
-  TRI_ASSERT(header->_prev != header);
-  TRI_ASSERT(header->_next != header);
-
   TRI_ASSERT(old != nullptr);
   TRI_ASSERT(old->getDataPtr() != nullptr);  // ONLY IN HEADERS, PROTECTED by RUNTIME
 
@@ -126,42 +160,20 @@ void TRI_headers_t::moveBack (TRI_doc_mptr_t* header,
   _totalSize += (  TRI_DF_ALIGN_BLOCK(newSize)
                  - TRI_DF_ALIGN_BLOCK(oldSize));
 
-  if (_end == header) {
-    // header is already at the end
-    TRI_ASSERT(header->_next == nullptr);
-    return;
-  }
-
-  TRI_ASSERT(_begin != _end);
+  TRI_ASSERT(_totalSize > 0);
 
-  // unlink the element
-  if (header->_prev != nullptr) {
-    header->_prev->_next = header->_next;
+  try {
+    // the previous slot of the header becomes stale
+    append(header);
+    cleanupOrder();
   }
-  if (header->_next != nullptr) {
-    header->_next->_prev = header->_prev;
+  catch (...) {
+    // out of memory. the header keeps its position
   }
-
-  if (_begin == header) {
-    TRI_ASSERT(header->_next != nullptr);
-    _begin = header->_next;
-  }
-
-  header->_prev   = _end;
-  header->_next   = nullptr;
-  _end            = header;
-  header->_prev->_next = header;
-
-  TRI_ASSERT(_begin != nullptr);
-  TRI_ASSERT(_end != nullptr);
-  TRI_ASSERT(header->_prev != header);
-  TRI_ASSERT(header->_next != header);
-
-  TRI_ASSERT(_totalSize > 0);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-/// @brief unlinks a header from the linked list, without freeing it
+/// @brief unlinks a header, without freeing it
 ////////////////////////////////////////////////////////////////////////////////
 
 void TRI_headers_t::unlink (TRI_doc_mptr_t* header) {
@@ -169,55 +181,33 @@ void TRI_headers_t::unlink (TRI_doc_mptr_t* header) {
 
   TRI_ASSERT(header != nullptr);
   TRI_ASSERT(header->getDataPtr() != nullptr); // ONLY IN HEADERS, PROTECTED by RUNTIME
-  TRI_ASSERT(header->_prev != header);
-  TRI_ASSERT(header->_next != header);
 
   size = (int64_t) ((TRI_df_marker_t*) header->getDataPtr())->_size; // ONLY IN HEADERS, PROTECTED by RUNTIME
   TRI_ASSERT(size > 0);
 
-  // unlink the header
-  if (header->_prev != nullptr) {
-    header->_prev->_next = header->_next;
-  }
-
-  if (header->_next != nullptr) {
-    header->_next->_prev = header->_prev;
-  }
-
-  // adjust begin & end pointers
-  if (_begin == header) {
-    _begin = header->_next;
-  }
-
-  if (_end == header) {
-    _end = header->_prev;
-  }
-
-  TRI_ASSERT(_begin != header);
-  TRI_ASSERT(_end != header);
-
   TRI_ASSERT(_nrLinked > 0);
   _nrLinked--;
   _totalSize -= TRI_DF_ALIGN_BLOCK(size);
 
+  size_t const i = slot(header->_position);
+
+  if (i < _order.size() && _order[i] == header) {
+    // keep the slot, so the header can be relinked at the same position
+    _order[i] = nullptr;
+  }
+
   if (_nrLinked == 0) {
-    TRI_ASSERT(_begin == nullptr);
-    TRI_ASSERT(_end == nullptr);
     TRI_ASSERT(_totalSize == 0);
   }
   else {
-    TRI_ASSERT(_begin != nullptr);
-    TRI_ASSERT(_end != nullptr);
     TRI_ASSERT(_totalSize > 0);
   }
-
-  TRI_ASSERT(header->_prev != header);
-  TRI_ASSERT(header->_next != header);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-/// @brief moves a header around in the list, using its previous position
-/// (specified in "old"), note that this is only used in revert operations
+/// @brief moves an existing header back to its previous position, using its
+/// previous state (specified in "old"), note that this is only used in revert
+/// operations. the caller will copy the previous state into the header
 ////////////////////////////////////////////////////////////////////////////////
 
 void TRI_headers_t::move (TRI_doc_mptr_t* header,
@@ -227,8 +217,6 @@ void TRI_headers_t::move (TRI_doc_mptr_t* header,
   }
 
   TRI_ASSERT(_nrAllocated > 0);
-  TRI_ASSERT(header->_prev != header);
-  TRI_ASSERT(header->_next != header);
   TRI_ASSERT(header->getDataPtr() != nullptr); // ONLY IN HEADERS, PROTECTED by RUNTIME
   TRI_ASSERT(((TRI_df_marker_t*) header->getDataPtr())->_size > 0); // ONLY IN HEADERS, PROTECTED by RUNTIME
   TRI_ASSERT(old != nullptr);
@@ -244,50 +232,30 @@ void TRI_headers_t::move (TRI_doc_mptr_t* header,
   _totalSize -= (  TRI_DF_ALIGN_BLOCK(newSize)
                  - TRI_DF_ALIGN_BLOCK(oldSize));
 
-  // adjust list start and end pointers
-  if (old->_prev == nullptr) {
-    _begin = header;
-  }
-  else if (_begin == header) {
-    if (old->_prev != nullptr) {
-      _begin = old->_prev;
-    }
-  }
+  size_t const i = slot(old->_position);
 
-  if (old->_next == nullptr) {
-    _end = header;
-  }
-  else if (_end == header) {
-    if (old->_next != nullptr) {
-      _end = old->_next;
-    }
-  }
-
-  if (header->_prev != nullptr) {
-    header->_prev->_next = header->_next;
-  }
-  if (header->_next != nullptr) {
-    header->_next->_prev = header->_prev;
+  if (i < _order.size() && _order[i] == header) {
+    // the previous slot still exists. it becomes valid again when the caller
+    // restores the header's position
+    return;
   }
 
-  if (old->_prev != nullptr) {
-    old->_prev->_next = header;
-  }
-  if (old->_next != nullptr) {
-    old->_next->_prev = header;
+  // the previous slot was removed in the meantime
+  if (slot(header->_position) >= _order.size() || 
+      _order[slot(header->_position)] != header) {
+    try {
+      append(header);
+    }
+    catch (...) {
+      // out of memory
+    }
   }
 
-  header->_prev = old->_prev;
-  header->_next = old->_next;
-
-  TRI_ASSERT(_begin != nullptr);
-  TRI_ASSERT(_end != nullptr);
-  TRI_ASSERT(header->_prev != header);
-  TRI_ASSERT(header->_next != header);
+  old->_position = header->_position;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-/// @brief moves a header back into the list, using its previous position
+/// @brief relinks a header that was unlinked before, using its previous state
 /// (specified in "old")
 ////////////////////////////////////////////////////////////////////////////////
 
@@ -298,20 +266,30 @@ void TRI_headers_t::relink (TRI_doc_mptr_t* header,
   }
 
   TRI_ASSERT(header->getDataPtr() != nullptr); // ONLY IN HEADERS, PROTECTED by RUNTIME
-
   int64_t size = (int64_t) ((TRI_df_marker_t*) header->getDataPtr())->_size; // ONLY IN HEADERS, PROTECTED by RUNTIME
   TRI_ASSERT(size > 0);
+  TRI_ASSERT(old != nullptr);
+  TRI_ASSERT(old->_position == header->_position);
 
-  TRI_ASSERT(_begin != header);
-  TRI_ASSERT(_end != header);
-
-  this->move(header, old);
   _nrLinked++;
   _totalSize += TRI_DF_ALIGN_BLOCK(size);
   TRI_ASSERT(_totalSize > 0);
 
-  TRI_ASSERT(header->_prev != header);
-  TRI_ASSERT(header->_next != header);
+  // slots of unlinked headers are never removed, so the header can be put
+  // back at its original position
+  size_t const i = slot(header->_position);
+
+  if (i < _order.size() && _order[i] == nullptr) {
+    _order[i] = header;
+  }
+  else if (i >= _order.size() || _order[i] != header) {
+    try {
+      append(header);
+    }
+    catch (...) {
+      // out of memory
+    }
+  }
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -327,13 +305,7 @@ TRI_doc_mptr_t* TRI_headers_t::request (size_t size) {
     size_t blockSize = GetBlockSize(_blocks._length);
     TRI_ASSERT(blockSize > 0);
 
-    TRI_doc_mptr_t* begin;
-    try {
-      begin = new TRI_doc_mptr_t[blockSize];
-    }
-    catch (std::exception&) {
-      begin = nullptr;
-    }
+    TRI_doc_mptr_t* begin = AllocateBlock(blockSize, _numaNode);
 
     // out of memory
     if (begin == nullptr) {
@@ -360,39 +332,28 @@ TRI_doc_mptr_t* TRI_headers_t::request (size_t size) {
   TRI_doc_mptr_t* result = const_cast<TRI_doc_mptr_t*>(_freelist);
   TRI_ASSERT(result != nullptr);
 
-  _freelist = static_cast<TRI_doc_mptr_t const*>(result->getDataPtr()); // ONLY IN HEADERS, PROTECTED by RUNTIME
-  result->setDataPtr(nullptr); // ONLY IN HEADERS
-
-  // put new header at the end of the list
-  if (_begin == nullptr) {
-    // list of headers is empty
-    TRI_ASSERT(_nrLinked == 0);
-    TRI_ASSERT(_totalSize == 0);
-
-    _begin = result;
-    _end   = result;
-
-    result->_prev   = nullptr;
-    result->_next   = nullptr;
+  try {
+    append(result);
   }
-  else {
-    // list is not empty
-    TRI_ASSERT(_nrLinked > 0);
-    TRI_ASSERT(_totalSize > 0);
-    TRI_ASSERT(_nrAllocated > 0);
-    TRI_ASSERT(_begin != nullptr);
-    TRI_ASSERT(_end != nullptr);
-
-    _end->_next   = result;
-    result->_prev = _end;
-    result->_next = nullptr;
-    _end          = result;
+  catch (...) {
+    TRI_set_errno(TRI_ERROR_OUT_OF_MEMORY);
+    return nullptr;
   }
 
+  _freelist = static_cast<TRI_doc_mptr_t const*>(result->getDataPtr()); // ONLY IN HEADERS, PROTECTED by RUNTIME
+  result->setDataPtr(nullptr); // ONLY IN HEADERS
+
   _nrAllocated++;
   _nrLinked++;
   _totalSize += (int64_t) TRI_DF_ALIGN_BLOCK(size);
 
+  try {
+    cleanupOrder();
+  }
+  catch (...) {
+    // out of memory. the order is compacted later
+  }
+
   return result;
 }
 
@@ -425,15 +386,17 @@ void TRI_headers_t::release (TRI_doc_mptr_t* header,
     // it is sensible and not everytime the last document is removed
 
     for (size_t i = 0;  i < _blocks._length;  ++i) {
-      delete[] static_cast<TRI_doc_mptr_t*>(_blocks._buffer[i]);
+      FreeBlock(static_cast<TRI_doc_mptr_t*>(_blocks._buffer[i]), GetBlockSize(i), _numaNode);
       _blocks._buffer[i] = nullptr;
     }
 
     // set length to 0
     _blocks._length = 0;
     _freelist = nullptr;
-    _begin = nullptr;
-    _end = nullptr;
+
+    // all remaining slots are stale and refer to freed headers
+    _order.clear();
+    _orderBase = 0;
   }
 }
 
@@ -451,6 +414,133 @@ void TRI_headers_t::adjustTotalSize (int64_t oldSize,
                  - TRI_DF_ALIGN_BLOCK(newSize));
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief returns the oldest linked header in insertion order
+////////////////////////////////////////////////////////////////////////////////
+
+TRI_doc_mptr_t* TRI_headers_t::front () {
+  try {
+    cleanupOrder();
+  }
+  catch (...) {
+    // out of memory. the order is compacted later
+  }
+
+  // the front may still hold slots of unlinked headers
+  size_t const n = _order.size();
+
+  for (size_t i = 0; i < n; ++i) {
+    if (isLinked(i)) {
+      return _order[i];
+    }
+  }
+
+  return nullptr;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief returns linked headers in insertion order
+////////////////////////////////////////////////////////////////////////////////
+
+void TRI_headers_t::ordered (int64_t offset,
+                             int64_t count,
+                             std::vector<TRI_doc_mptr_t const*>& result) const {
+  if (count <= 0) {
+    return;
+  }
+
+  bool const reverse = (offset < 0);
+  uint64_t skip = static_cast<uint64_t>(reverse ? (- offset - 1) : offset);
+  size_t const n = _order.size();
+
+  for (size_t j = 0; j < n; ++j) {
+    size_t const i = (reverse ? n - 1 - j : j);
+
+    if (! isLinked(i)) {
+      continue;
+    }
+
+    if (skip > 0) {
+      --skip;
+      continue;
+    }
+
+    result.emplace_back(_order[i]);
+
+    if (static_cast<int64_t>(result.size()) >= count) {
+      break;
+    }
+  }
+}
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                 private functions
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief appends a header to the insertion order
+////////////////////////////////////////////////////////////////////////////////
+
+void TRI_headers_t::append (TRI_doc_mptr_t* header) {
+  uint32_t const position = static_cast<uint32_t>(_orderBase + _order.size());
+
+  _order.emplace_back(header);
+  header->_position = position;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief whether or not the slot in the insertion order holds a linked
+/// header
+////////////////////////////////////////////////////////////////////////////////
+
+bool TRI_headers_t::isLinked (size_t i) const {
+  TRI_doc_mptr_t const* header = _order[i];
+
+  return (header != nullptr && slot(header->_position) == i);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief removes stale slots from the insertion order
+///
+/// stale slots are popped from the front. slots of unlinked headers are only
+/// removed if no header is currently unlinked, as an unlinked header may be
+/// relinked at its slot. if more than half of the slots are stale, the order
+/// is compacted and the positions of all linked headers are renumbered
+////////////////////////////////////////////////////////////////////////////////
+
+void TRI_headers_t::cleanupOrder () {
+  bool const noneUnlinked = (_nrAllocated == _nrLinked);
+
+  while (! _order.empty()) {
+    if (_order.front() == nullptr ? ! noneUnlinked : isLinked(0)) {
+      break;
+    }
+
+    _order.pop_front();
+    ++_orderBase;
+  }
+
+  if (! noneUnlinked || _order.size() <= 2 * _nrLinked + 1024) {
+    return;
+  }
+
+  std::deque<TRI_doc_mptr_t*> order;
+  size_t const n = _order.size();
+
+  for (size_t i = 0; i < n; ++i) {
+    if (isLinked(i)) {
+      order.emplace_back(_order[i]);
+    }
+  }
+
+  // renumber only after all allocations succeeded
+  _order.swap(order);
+
+  for (size_t i = 0; i < _order.size(); ++i) {
+    _order[i]->_position = static_cast<uint32_t>(_orderBase + i);
+  }
+}
+
 // -----------------------------------------------------------------------------
 // --SECTION--                                                       END-OF-FILE
 // -----------------------------------------------------------------------------
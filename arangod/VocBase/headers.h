@@ -31,8 +31,11 @@
 #define ARANGODB_VOC_BASE_HEADERS_H 1
 
 #include "Basics/Common.h"
+#include "Basics/numa.h"
 #include "Basics/vector.h"
 
+#include <deque>
+
 // -----------------------------------------------------------------------------
 // --SECTION--                                              forward declarations
 // -----------------------------------------------------------------------------
@@ -53,9 +56,11 @@ class TRI_headers_t {
 
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief creates the headers
+///
+/// the header blocks are placed on the specified NUMA node, if any
 ////////////////////////////////////////////////////////////////////////////////
 
-    TRI_headers_t ();
+    explicit TRI_headers_t (int = TRI_NUMA_NODE_ANY);
 
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief destroys the headers
@@ -70,26 +75,28 @@ class TRI_headers_t {
   public:
 
 ////////////////////////////////////////////////////////////////////////////////
-/// @brief move an existing header to the end of the linked list
+/// @brief move an existing header to the end of the insertion order
 ////////////////////////////////////////////////////////////////////////////////
 
     void moveBack (struct TRI_doc_mptr_t*, struct TRI_doc_mptr_t*);
 
 ////////////////////////////////////////////////////////////////////////////////
-/// @brief unlink an existing header from the linked list, without freeing it
+/// @brief unlink an existing header from the insertion order, without 
+/// freeing it
 ////////////////////////////////////////////////////////////////////////////////
 
     void unlink (struct TRI_doc_mptr_t*);
 
 ////////////////////////////////////////////////////////////////////////////////
-/// @brief move an existing header to another position in the linked list
+/// @brief move an existing header back to its previous position in the
+/// insertion order
 ////////////////////////////////////////////////////////////////////////////////
 
     void move (struct TRI_doc_mptr_t*, struct TRI_doc_mptr_t*);
 
 ////////////////////////////////////////////////////////////////////////////////
-/// @brief relink an existing header into the linked list, at its original
-/// position
+/// @brief relink an existing header into the insertion order, at its 
+/// original position if possible
 ////////////////////////////////////////////////////////////////////////////////
 
     void relink (struct TRI_doc_mptr_t*, struct TRI_doc_mptr_t*);
@@ -114,24 +121,23 @@ class TRI_headers_t {
     void adjustTotalSize (int64_t, int64_t);
 
 ////////////////////////////////////////////////////////////////////////////////
-/// @brief return the element at the head of the list
+/// @brief return the oldest linked header in insertion order
 ///
-/// note: the element returned might be nullptr
+/// note: the element returned might be nullptr. the caller must hold the
+/// collection's write lock
 ////////////////////////////////////////////////////////////////////////////////
 
-    inline struct TRI_doc_mptr_t* front () const {
-      return _begin;
-    }
+    struct TRI_doc_mptr_t* front ();
 
 ////////////////////////////////////////////////////////////////////////////////
-/// @brief return the element at the tail of the list
-///
-/// note: the element returned might be nullptr
+/// @brief return linked headers in insertion order. a negative offset reads
+/// from the back, starting with the most recently inserted/updated header at 
+/// offset -1
 ////////////////////////////////////////////////////////////////////////////////
 
-    inline struct TRI_doc_mptr_t* back () const {
-      return _end;
-    }
+    void ordered (int64_t,
+                  int64_t,
+                  std::vector<struct TRI_doc_mptr_t const*>&) const;
 
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief return the number of active headers
@@ -149,6 +155,39 @@ class TRI_headers_t {
       return _totalSize;
     }
 
+// -----------------------------------------------------------------------------
+// --SECTION--                                                 private functions
+// -----------------------------------------------------------------------------
+
+  private:
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief append a header to the insertion order
+////////////////////////////////////////////////////////////////////////////////
+
+    void append (struct TRI_doc_mptr_t*);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief return the slot in the insertion order for a position
+////////////////////////////////////////////////////////////////////////////////
+
+    inline size_t slot (uint32_t position) const {
+      return static_cast<size_t>(position - static_cast<uint32_t>(_orderBase));
+    }
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief whether or not the slot in the insertion order holds a linked
+/// header
+////////////////////////////////////////////////////////////////////////////////
+
+    bool isLinked (size_t) const;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief remove stale slots from the insertion order
+////////////////////////////////////////////////////////////////////////////////
+
+    void cleanupOrder ();
+
 // -----------------------------------------------------------------------------
 // --SECTION--                                                 private variables
 // -----------------------------------------------------------------------------
@@ -157,13 +196,33 @@ class TRI_headers_t {
 
     TRI_doc_mptr_t const*  _freelist;    // free headers
 
-    TRI_doc_mptr_t*        _begin;       // start pointer to list of allocated headers
-    TRI_doc_mptr_t*        _end;         // end pointer to list of allocated headers
     size_t                 _nrAllocated; // number of allocated headers
     size_t                 _nrLinked;    // number of linked headers
     int64_t                _totalSize;   // total size of markers for linked headers
 
+    int const              _numaNode;    // NUMA node for the header blocks
+
     TRI_vector_pointer_t   _blocks;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief headers in order of insertion/update, oldest first
+///
+/// each header stores the (truncated) absolute position of its slot. an 
+/// update appends a new slot and leaves the old one behind, so a slot is only
+/// valid if the header's position refers back to it. unlinked headers have
+/// their slot set to nullptr, so they can be relinked at the same position
+/// if the transaction that removed them is rolled back. stale slots are 
+/// removed from the front, and the whole order is compacted if more than
+/// half of it is stale
+////////////////////////////////////////////////////////////////////////////////
+
+    std::deque<TRI_doc_mptr_t*> _order;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief absolute position of the first slot in _order
+////////////////////////////////////////////////////////////////////////////////
+
+    uint64_t               _orderBase;
 };
 
 #endif
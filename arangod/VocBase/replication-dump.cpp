@@ -33,6 +33,7 @@
 #include "Basics/files.h"
 #include "Basics/json.h"
 #include "Basics/logging.h"
+#include "Basics/memory-map.h"
 #include "Basics/tri-strings.h"
 #include "Cluster/ServerState.h"
 #include "Utils/CollectionNameResolver.h"
@@ -1197,6 +1198,9 @@ static int DumpCollection (TRI_replication_dump_t* dump,
       end = ptr;
     }
 
+    // the dump reads the datafile front to back
+    TRI_AdviseDatafile(datafile, TRI_MADVISE_SEQUENTIAL);
+
     while (ptr < end) {
       TRI_df_marker_t* marker = (TRI_df_marker_t*) ptr;
       TRI_voc_tick_t foundTick;
@@ -1304,6 +1308,8 @@ static int DumpCollection (TRI_replication_dump_t* dump,
     }
 
 NEXT_DF:
+    TRI_ResetAdviceDatafile(datafile);
+
     if (e._isJournal) {
       // read-unlock the journal
       TRI_READ_UNLOCK_DOCUMENTS_INDEXES_PRIMARY_COLLECTION(document);
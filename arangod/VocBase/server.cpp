@@ -35,6 +35,7 @@
 
 #include <regex.h>
 
+#include "Aql/PlanCache.h"
 #include "Aql/QueryCache.h"
 #include "Aql/QueryRegistry.h"
 #include "Basics/conversions.h"
@@ -1663,22 +1664,28 @@ static void DatabaseManager (void* data) {
 int TRI_InitServer (TRI_server_t* server,
                     triagens::rest::ApplicationEndpointServer* applicationEndpointServer,
                     triagens::basics::ThreadPool* indexPool,
+                    triagens::basics::ThreadPool* compactorPool,
+                    triagens::basics::RateLimiter* compactorRateLimiter,
                     char const* basePath,
                     char const* appPath,
                     TRI_vocbase_defaults_t const* defaults,
                     bool disableAppliers,
-                    bool iterateMarkersOnOpen) {
+                    bool iterateMarkersOnOpen,
+                    bool indexSnapshots) {
 
   TRI_ASSERT(server != nullptr);
   TRI_ASSERT(basePath != nullptr);
 
   server->_iterateMarkersOnOpen = iterateMarkersOnOpen;
+  server->_indexSnapshots = indexSnapshots;
   server->_hasCreatedSystemDatabase = false;
 
   // c++ object, may be null in console mode
   server->_applicationEndpointServer = applicationEndpointServer;
 
   server->_indexPool                 = indexPool;
+  server->_compactorPool             = compactorPool;
+  server->_compactorRateLimiter      = compactorRateLimiter;
 
   // ...........................................................................
   // set up paths and filenames
@@ -2390,6 +2397,7 @@ int TRI_DropDatabaseServer (TRI_server_t* server,
 
   // invalidate all entries for the database
   triagens::aql::QueryCache::instance()->invalidate(vocbase);
+  triagens::aql::PlanCache::instance()->invalidate(vocbase);
 
   int res = TRI_ERROR_NO_ERROR;
 
@@ -2741,6 +2749,8 @@ TRI_server_t::TRI_server_t ()
   : _databasesLists(new DatabasesLists()),
     _applicationEndpointServer(nullptr),
     _indexPool(nullptr),
+    _compactorPool(nullptr),
+    _compactorRateLimiter(nullptr),
     _queryRegistry(nullptr),
     _basePath(nullptr),
     _databasePath(nullptr),
@@ -2749,6 +2759,7 @@ TRI_server_t::TRI_server_t ()
     _appPath(nullptr),
     _disableReplicationAppliers(false),
     _iterateMarkersOnOpen(false),
+    _indexSnapshots(false),
     _hasCreatedSystemDatabase(false),
     _initialized(false) {
 
@@ -47,6 +47,7 @@ namespace triagens {
     class QueryRegistry;
   }
   namespace basics {
+    class RateLimiter;
     class ThreadPool;
   }
   namespace rest {
@@ -83,6 +84,8 @@ struct TRI_server_t {
   TRI_vocbase_defaults_t             _defaults;
   triagens::rest::ApplicationEndpointServer*  _applicationEndpointServer; 
   triagens::basics::ThreadPool*      _indexPool;                 
+  triagens::basics::ThreadPool*      _compactorPool;
+  triagens::basics::RateLimiter*     _compactorRateLimiter;
   triagens::aql::QueryRegistry*      _queryRegistry;
 
   char*                              _basePath;
@@ -93,6 +96,7 @@ struct TRI_server_t {
 
   bool                               _disableReplicationAppliers;
   bool                               _iterateMarkersOnOpen;
+  bool                               _indexSnapshots;
   bool                               _hasCreatedSystemDatabase;
   bool                               _initialized;
 };
@@ -114,10 +118,13 @@ extern size_t PageSize;
 int TRI_InitServer (TRI_server_t*,
                     triagens::rest::ApplicationEndpointServer*,
                     triagens::basics::ThreadPool*,
+                    triagens::basics::ThreadPool*,
+                    triagens::basics::RateLimiter*,
                     char const*,
                     char const*,
                     TRI_vocbase_defaults_t const*,
                     bool,
+                    bool,
                     bool);
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -213,7 +213,7 @@ static void FreeOperations (TRI_transaction_t* trx) {
 
         if (op->type == TRI_VOC_DOCUMENT_OPERATION_UPDATE ||
             op->type == TRI_VOC_DOCUMENT_OPERATION_REMOVE) {
-          TRI_voc_fid_t fid = op->oldHeader._fid;
+          TRI_voc_fid_t fid = document->datafileId(op->oldHeader._fidIndex);
           TRI_df_marker_t const* marker = static_cast<TRI_df_marker_t const*>(op->oldHeader.getDataPtr());  // PROTECTED by trx from above
 
           auto it2 = stats.find(fid);
@@ -1262,9 +1262,9 @@ int TRI_AddOperationTransaction (triagens::wal::DocumentOperation& operation,
   }
 
   // set header file id
-  operation.header->_fid = fid;
+  operation.header->_fidIndex = document->datafileIndex(fid);
 
-  TRI_ASSERT(operation.header->_fid > 0);
+  TRI_ASSERT(operation.header->_fidIndex > 0);
 
   if (isSingleOperationTransaction) {
     // operation is directly executed
@@ -1277,11 +1277,11 @@ int TRI_AddOperationTransaction (triagens::wal::DocumentOperation& operation,
     if (operation.type == TRI_VOC_DOCUMENT_OPERATION_UPDATE ||
         operation.type == TRI_VOC_DOCUMENT_OPERATION_REMOVE) {
       // update datafile statistics for the old header
-      TRI_ASSERT(operation.oldHeader._fid > 0);
+      TRI_ASSERT(operation.oldHeader._fidIndex > 0);
        
       TRI_LOCK_JOURNAL_ENTRIES_DOC_COLLECTION(document);
 
-      TRI_doc_datafile_info_t* dfi = TRI_FindDatafileInfoDocumentCollection(document, operation.oldHeader._fid, false);
+      TRI_doc_datafile_info_t* dfi = TRI_FindDatafileInfoDocumentCollection(document, document->datafileId(operation.oldHeader._fidIndex), false);
       // the old header might point to the WAL. in this case, there'll be no stats update
 
       if (dfi != nullptr) {
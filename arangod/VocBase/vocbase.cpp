@@ -35,6 +35,7 @@
 
 #include <regex.h>
 
+#include "Aql/PlanCache.h"
 #include "Aql/QueryCache.h"
 #include "Aql/QueryList.h"
 #include "Basics/conversions.h"
@@ -778,6 +779,7 @@ static int RenameCollection (TRI_vocbase_t* vocbase,
 
   // invalidate all entries for the two collections
   triagens::aql::QueryCache::instance()->invalidate(vocbase, std::vector<char const*>{ oldName, newName });
+  triagens::aql::PlanCache::instance()->invalidate(vocbase, std::vector<char const*>{ oldName, newName });
 
   return TRI_ERROR_NO_ERROR;
 }
@@ -1161,6 +1163,7 @@ static int DropCollection (TRI_vocbase_t* vocbase,
   TRI_EVENTUAL_WRITE_LOCK_STATUS_VOCBASE_COL(collection);
 
   triagens::aql::QueryCache::instance()->invalidate(vocbase, collection->_name); 
+  triagens::aql::PlanCache::instance()->invalidate(vocbase, collection->_name);
 
   // .............................................................................
   // collection already deleted
@@ -30,6 +30,8 @@
 #include "CollectorThread.h"
 
 #include "Basics/MutexLocker.h"
+#include "Basics/Barrier.h"
+#include "Basics/ThreadPool.h"
 #include "Basics/hashes.h"
 #include "Basics/logging.h"
 #include "Basics/ConditionLocker.h"
@@ -37,6 +39,7 @@
 #include "Utils/CollectionGuard.h"
 #include "Utils/DatabaseGuard.h"
 #include "Utils/transactions.h"
+#include "VocBase/compressed-json.h"
 #include "VocBase/document-collection.h"
 #include "VocBase/server.h"
 #include "VocBase/VocShaper.h"
@@ -58,6 +61,35 @@ static inline TRI_doc_datafile_info_t& getDfi (CollectorCache* cache,
   return cache->dfi[fid];
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief compresses the body of a document marker into the compression
+/// buffer of the cache if the collection wants this. returns whether the
+/// compressed body should be stored
+////////////////////////////////////////////////////////////////////////////////
+
+static bool compressShape (TRI_document_collection_t* document,
+                           CollectorCache* cache,
+                           char const* shape,
+                           size_t shapeLength) {
+  if (! document->_info._compressDocuments) {
+    return false;
+  }
+
+  double const start = TRI_microtime();
+  bool const compressed = TRI_CompressJson(shape, shapeLength, cache->compressionBuffer);
+  double const elapsed = TRI_microtime() - start;
+
+  document->_compressionTime += static_cast<int64_t>(elapsed * 1000000.0);
+
+  if (compressed) {
+    document->_numberCompressed++;
+    document->_sizeUncompressed += static_cast<int64_t>(shapeLength);
+    document->_sizeCompressed += static_cast<int64_t>(cache->compressionBuffer.size());
+  }
+
+  return compressed;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief return a reference to an existing datafile statistics struct,
 /// create it if it does not exist
@@ -125,6 +157,40 @@ static bool ShouldIgnoreCollection (CollectorState const* state,
   return false;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief build the tick-sorted list of surviving markers for a collection
+////////////////////////////////////////////////////////////////////////////////
+
+static void SortOperations (CollectorState const* state,
+                            TRI_voc_cid_t cid,
+                            CollectorThread::OperationsType& sortedOperations) {
+  // insert structural operations - those are already sorted by tick
+  auto it = state->structuralOperations.find(cid);
+
+  if (it != state->structuralOperations.end()) {
+    CollectorThread::OperationsType const& ops = (*it).second;
+
+    sortedOperations.insert(sortedOperations.begin(), ops.begin(), ops.end());
+    TRI_ASSERT_EXPENSIVE(sortedOperations.size() == ops.size());
+  }
+
+  // insert document operations - those are sorted by key, not by tick
+  auto it2 = state->documentOperations.find(cid);
+
+  if (it2 != state->documentOperations.end()) {
+    CollectorThread::DocumentOperationsType const& ops = (*it2).second;
+
+    for (auto it3 = ops.begin(); it3 != ops.end(); ++it3) {
+      sortedOperations.push_back((*it3).second);
+    }
+
+    // sort vector by marker tick
+    std::sort(sortedOperations.begin(), sortedOperations.end(), [] (TRI_df_marker_t const* left, TRI_df_marker_t const* right) {
+      return (left->_tick < right->_tick);
+    });
+  }
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief callback to handle one marker during collection
 ////////////////////////////////////////////////////////////////////////////////
@@ -282,10 +348,12 @@ uint64_t const CollectorThread::Interval = 1000000;
 ////////////////////////////////////////////////////////////////////////////////
 
 CollectorThread::CollectorThread (LogfileManager* logfileManager,
-                                  TRI_server_t* server)
+                                  TRI_server_t* server,
+                                  uint32_t numThreads)
   : Thread("WalCollector"),
     _logfileManager(logfileManager),
     _server(server),
+    _workers(nullptr),
     _condition(),
     _operationsQueueLock(),
     _operationsQueue(),
@@ -294,6 +362,11 @@ CollectorThread::CollectorThread (LogfileManager* logfileManager,
     _numPendingOperations(0) {
 
   allowAsynchronousCancelation();
+
+  if (numThreads > 1) {
+    // the collector thread itself is also transferring markers
+    _workers = new triagens::basics::ThreadPool(static_cast<size_t>(numThreads - 1), "WalCollectorWorker");
+  }
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -301,6 +374,7 @@ CollectorThread::CollectorThread (LogfileManager* logfileManager,
 ////////////////////////////////////////////////////////////////////////////////
 
 CollectorThread::~CollectorThread () {
+  delete _workers;
 }
 
 // -----------------------------------------------------------------------------
@@ -640,7 +714,7 @@ int CollectorThread::processCollectionOperations (CollectorCache* cache) {
 
           // we can safely update the master pointer's dataptr value
           found->setDataPtr(static_cast<void*>(const_cast<char*>(operation.datafilePosition)));
-          found->_fid = fid;
+          found->_fidIndex = document->datafileIndex(fid);
         }
       }
       else if (walMarker->_type == TRI_WAL_MARKER_EDGE) {
@@ -664,7 +738,7 @@ int CollectorThread::processCollectionOperations (CollectorCache* cache) {
 
           // we can safely update the master pointer's dataptr value
           found->setDataPtr(static_cast<void*>(const_cast<char*>(operation.datafilePosition)));
-          found->_fid = fid;
+          found->_fidIndex = document->datafileIndex(fid);
         }
       }
       else if (walMarker->_type == TRI_WAL_MARKER_REMOVE) {
@@ -705,6 +779,9 @@ int CollectorThread::processCollectionOperations (CollectorCache* cache) {
       document->_uncollectedLogfileEntries = 0;
     }
 
+    // all master pointers that referred to the logfile now refer to datafiles
+    document->releaseDatafileIndex(cache->logfile->id());
+
     res = TRI_ERROR_NO_ERROR;
   }
   catch (triagens::basics::Exception const& ex) {
@@ -775,40 +852,35 @@ int CollectorThread::collect (Logfile* logfile) {
     }
   }
 
-  // now for each collection, write all surviving markers into collection datafiles
-  for (auto it = collectionIds.begin(); it != collectionIds.end(); ++it) {
-    auto cid = (*it);
-
-    OperationsType sortedOperations;
+  // now for each collection, write all surviving markers into collection
+  // datafiles. different collections are handled in parallel, but all markers
+  // of a collection are transferred by the same thread and in tick order
+  std::vector<TRI_voc_cid_t> const cids(collectionIds.begin(), collectionIds.end());
+  std::atomic<size_t> next(0);
+  std::atomic<int> transferResult(TRI_ERROR_NO_ERROR);
 
-    // insert structural operations - those are already sorted by tick
-    if (state.structuralOperations.find(cid) != state.structuralOperations.end()) {
-      OperationsType const& ops = state.structuralOperations[cid];
+  auto transfer = [this, &logfile, &state, &cids, &next, &transferResult] () -> void {
+    while (true) {
+      size_t const i = next++;
 
-      sortedOperations.insert(sortedOperations.begin(), ops.begin(), ops.end());
-      TRI_ASSERT_EXPENSIVE(sortedOperations.size() == ops.size());
-    }
-
-    // insert document operations - those are sorted by key, not by tick
-    if (state.documentOperations.find(cid) != state.documentOperations.end()) {
-      DocumentOperationsType const& ops = state.documentOperations[cid];
-
-
-      for (auto it2 = ops.begin(); it2 != ops.end(); ++it2) {
-        sortedOperations.push_back((*it2).second);
+      if (i >= cids.size() || 
+          transferResult.load(std::memory_order_relaxed) != TRI_ERROR_NO_ERROR) {
+        // done or aborted early
+        break;
       }
 
-      // sort vector by marker tick
-      std::sort(sortedOperations.begin(), sortedOperations.end(), [] (TRI_df_marker_t const* left, TRI_df_marker_t const* right) {
-        return (left->_tick < right->_tick);
-      });
-    }
-
-    if (! sortedOperations.empty()) {
+      auto cid = cids[i];
       int res = TRI_ERROR_INTERNAL;
 
       try {
-        res = transferMarkers(logfile, cid, state.collections[cid], state.operationsCount[cid], sortedOperations);
+        OperationsType sortedOperations;
+        SortOperations(&state, cid, sortedOperations);
+
+        if (sortedOperations.empty()) {
+          continue;
+        }
+
+        res = transferMarkers(logfile, cid, state.collections.at(cid), state.operationsCount.at(cid), sortedOperations);
       }
       catch (triagens::basics::Exception const& ex) {
         res = ex.code();
@@ -821,10 +893,44 @@ int CollectorThread::collect (Logfile* logfile) {
           res != TRI_ERROR_ARANGO_DATABASE_NOT_FOUND &&
           res != TRI_ERROR_ARANGO_COLLECTION_NOT_FOUND) {
         LOG_WARNING("got unexpected error in CollectorThread::collect: %s", TRI_errno_string(res));
-        // abort early
-        return res;
+        int expected = TRI_ERROR_NO_ERROR;
+        transferResult.compare_exchange_strong(expected, res);
+      }
+    }
+  };
+
+  size_t numThreads = 0;
+
+  if (_workers != nullptr && ! cids.empty()) {
+    numThreads = (std::min)(_workers->numThreads(), cids.size() - 1);
+  }
+
+  {
+    triagens::basics::Barrier barrier(numThreads);
+
+    for (size_t i = 0; i < numThreads; ++i) {
+      try {
+        _workers->enqueue([&transfer, &barrier] () -> void {
+          transfer();
+          barrier.join();
+        });
+      }
+      catch (...) {
+        // the collector thread will pick up the work
+        barrier.join();
       }
     }
+
+    transfer();
+
+    // barrier destructor waits for all workers
+  }
+
+  int res = transferResult.load();
+
+  if (res != TRI_ERROR_NO_ERROR) {
+    // abort early
+    return res;
   }
 
   // TODO: what to do if an error has occurred?
@@ -993,6 +1099,14 @@ int CollectorThread::executeTransferMarkers (TRI_document_collection_t* document
         char const* shape = base + orig->_offsetJson;
         ptrdiff_t shapeLength = source->_size - (shape - base);
 
+        if (compressShape(document, cache, shape, static_cast<size_t>(shapeLength))) {
+          shape = cache->compressionBuffer.c_str();
+          shapeLength = static_cast<ptrdiff_t>(cache->compressionBuffer.size());
+        }
+        else {
+          cache->compressionBuffer.clear();
+        }
+
         char const* key = base + orig->_offsetKey;
         size_t n = strlen(key) + 1; // add NULL byte
         TRI_voc_size_t const totalSize = static_cast<TRI_voc_size_t>(sizeof(TRI_doc_document_key_marker_t) + TRI_DF_ALIGN_BLOCK(n) + shapeLength);
@@ -1016,6 +1130,10 @@ int CollectorThread::executeTransferMarkers (TRI_document_collection_t* document
         // copy shape into marker
         memcpy(dst + m->_offsetJson, shape, shapeLength);
 
+        if (! cache->compressionBuffer.empty()) {
+          m->_offsetJson |= TRI_DF_COMPRESSED_JSON;
+        }
+
         finishMarker(base, dst, document, source->_tick, cache);
 
         // update statistics
@@ -1030,6 +1148,14 @@ int CollectorThread::executeTransferMarkers (TRI_document_collection_t* document
         char const* shape = base + orig->_offsetJson;
         ptrdiff_t shapeLength = source->_size - (shape - base);
 
+        if (compressShape(document, cache, shape, static_cast<size_t>(shapeLength))) {
+          shape = cache->compressionBuffer.c_str();
+          shapeLength = static_cast<ptrdiff_t>(cache->compressionBuffer.size());
+        }
+        else {
+          cache->compressionBuffer.clear();
+        }
+
         char const* key = base + orig->_offsetKey;
         size_t n = strlen(key) + 1; // add NULL byte
         char const* toKey = base + orig->_offsetToKey;
@@ -1064,6 +1190,10 @@ int CollectorThread::executeTransferMarkers (TRI_document_collection_t* document
         // copy shape into marker
         memcpy(dst + m->base._offsetJson, shape, shapeLength);
 
+        if (! cache->compressionBuffer.empty()) {
+          m->base._offsetJson |= TRI_DF_COMPRESSED_JSON;
+        }
+
         finishMarker(base, dst, document, source->_tick, cache);
 
         // update statistics
@@ -1141,6 +1271,21 @@ int CollectorThread::queueOperations (triagens::wal::Logfile* logfile,
           _logfileManager->increaseCollectQueueSize(logfile);
         }
 
+        // the pending operations counter is also protected by the mutex, as
+        // multiple collector workers may queue operations at the same time
+        uint64_t numOperations = cache->operations->size();
+
+        if (maxNumPendingOperations > 0 && 
+            _numPendingOperations < maxNumPendingOperations &&
+            (_numPendingOperations + numOperations) >= maxNumPendingOperations) {
+          // activate write-throttling!
+          _logfileManager->activateWriteThrottling();
+          LOG_WARNING("queued more than %llu pending WAL collector operations. now activating write-throttling", 
+                      (unsigned long long) maxNumPendingOperations);
+        }
+  
+        _numPendingOperations += numOperations;
+
         // exit the loop
         break;
       }
@@ -1150,19 +1295,6 @@ int CollectorThread::queueOperations (triagens::wal::Logfile* logfile,
     usleep(10000);
   }
   
-  uint64_t numOperations = cache->operations->size();
-
-  if (maxNumPendingOperations > 0 && 
-      _numPendingOperations < maxNumPendingOperations &&
-      (_numPendingOperations + numOperations) >= maxNumPendingOperations) {
-    // activate write-throttling!
-    _logfileManager->activateWriteThrottling();
-    LOG_WARNING("queued more than %llu pending WAL collector operations. now activating write-throttling", 
-                (unsigned long long) maxNumPendingOperations);
-  }
-  
-  _numPendingOperations += numOperations;
-
   // we have put the object into the queue successfully
   // now set the original pointer to null so it isn't double-freed
   cache = nullptr;
@@ -1401,14 +1533,12 @@ void CollectorThread::finishMarker (char const* walPosition,
   // re-use the original WAL marker's tick
   marker->_tick = tick;
 
-  // calculate the CRC
-  TRI_voc_crc_t crc = TRI_InitialCrc32();
-  crc = TRI_BlockCrc32(crc, const_cast<char*>(datafilePosition), marker->_size);
-  marker->_crc = TRI_FinalCrc32(crc);
-
   TRI_datafile_t* datafile = cache->lastDatafile;
   TRI_ASSERT(datafile != nullptr);
 
+  // calculate the CRC, using the checksum algorithm of the target journal
+  marker->_crc = TRI_CrcMarkerDatafile(datafile->_version, marker);
+
   // update ticks
   TRI_UpdateTicksDatafile(datafile, marker);
 
@@ -46,6 +46,10 @@ struct TRI_document_collection_t;
 struct TRI_server_t;
 
 namespace triagens {
+  namespace basics {
+    class ThreadPool;
+  }
+
   namespace wal {
 
     class LogfileManager;
@@ -97,7 +101,8 @@ namespace triagens {
           ditches(),
           dfi(),
           lastFid(0),
-          lastDatafile(nullptr) {
+          lastDatafile(nullptr),
+          compressionBuffer() {
 
         operations->reserve(operationsSize);
       }
@@ -183,6 +188,12 @@ namespace triagens {
 ////////////////////////////////////////////////////////////////////////////////
 
       TRI_datafile_t* lastDatafile;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief buffer for compressing document bodies
+////////////////////////////////////////////////////////////////////////////////
+
+      std::string compressionBuffer;
     };
 
 // -----------------------------------------------------------------------------
@@ -210,7 +221,8 @@ namespace triagens {
 ////////////////////////////////////////////////////////////////////////////////
 
         CollectorThread (LogfileManager*,
-                         TRI_server_t*);
+                         TRI_server_t*,
+                         uint32_t);
 
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief destroy the collector thread
@@ -392,6 +404,13 @@ namespace triagens {
 
         TRI_server_t* _server;
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief worker threads for transferring markers of different collections
+/// in parallel. this is a nullptr if only the collector thread itself is used
+////////////////////////////////////////////////////////////////////////////////
+
+        triagens::basics::ThreadPool* _workers;
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief condition variable for the collector thread
 ////////////////////////////////////////////////////////////////////////////////
@@ -203,7 +203,7 @@ TRI_df_header_marker_t Logfile::getHeaderMarker () const {
   size_t const size = sizeof(TRI_df_header_marker_t);
   TRI_InitMarkerDatafile((char*) &header, TRI_DF_MARKER_HEADER, size);
 
-  header._version     = TRI_DF_VERSION;
+  header._version     = _df->_version;
   header._maximalSize = static_cast<TRI_voc_size_t>(allocatedSize());
   header._fid         = static_cast<TRI_voc_fid_t>(_id);
 
@@ -28,6 +28,7 @@
 ////////////////////////////////////////////////////////////////////////////////
 
 #include "LogfileManager.h"
+#include "Basics/Barrier.h"
 #include "Basics/files.h"
 #include "Basics/hashes.h"
 #include "Basics/json.h"
@@ -38,6 +39,7 @@
 #include "Basics/MutexLocker.h"
 #include "Basics/ReadLocker.h"
 #include "Basics/StringUtils.h"
+#include "Basics/ThreadPool.h"
 #include "Basics/WriteLocker.h"
 #include "VocBase/server.h"
 #include "Wal/AllocatorThread.h"
@@ -75,6 +77,14 @@ static inline uint64_t MinSyncInterval () {
   return 5;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief maximum value for --wal.collector-threads
+////////////////////////////////////////////////////////////////////////////////
+
+static inline uint32_t MaxCollectorThreads () {
+  return 64;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief minimum value for --wal.logfile-size
 ////////////////////////////////////////////////////////////////////////////////
@@ -138,6 +148,9 @@ LogfileManager::LogfileManager (TRI_server_t* server,
     _maxOpenLogfiles(0),
     _numberOfSlots(1048576),
     _syncInterval(100),
+    _groupCommitDelay(0),
+    _groupCommitSize(32),
+    _collectorThreads(2),
     _maxThrottleWait(15000),
     _throttleWhenPending(0),
     _allowOversizeEntries(true),
@@ -239,6 +252,7 @@ void LogfileManager::initialise (std::string* path,
 void LogfileManager::setupOptions (std::map<std::string, triagens::basics::ProgramOptionsDescription>& options) {
   options["Write-ahead log options:help-wal"]
     ("wal.allow-oversize-entries", &_allowOversizeEntries, "allow entries that are bigger than --wal.logfile-size")
+    ("wal.collector-threads", &_collectorThreads, "number of threads used for transferring logfile operations of different collections in parallel")
     ("wal.directory", &_directory, "logfile directory")
     ("wal.historic-logfiles", &_historicLogfiles, "maximum number of historic logfiles to keep after collection")
     ("wal.ignore-logfile-errors", &_ignoreLogfileErrors, "ignore logfile errors. this will read recoverable data from corrupted logfiles but ignore any unrecoverable data")
@@ -249,6 +263,8 @@ void LogfileManager::setupOptions (std::map<std::string, triagens::basics::Progr
     ("wal.slots", &_numberOfSlots, "number of logfile slots to use")
     ("wal.suppress-shape-information", &_suppressShapeInformation, "do not write shape information for markers (saves a lot of disk space, but effectively disables using the write-ahead log for replication)")
     ("wal.sync-interval", &_syncInterval, "interval for automatic, non-requested disk syncs (in milliseconds)")
+    ("wal.group-commit-delay", &_groupCommitDelay, "maximum delay for syncing waitForSync operations together (in microseconds, 0 = no group commit)")
+    ("wal.group-commit-size", &_groupCommitSize, "number of waiting waitForSync operations that trigger a group commit right away")
     ("wal.throttle-when-pending", &_throttleWhenPending, "throttle writes when at least this many operations are waiting for collection (set to 0 to deactivate write-throttling)")
     ("wal.throttle-wait", &_maxThrottleWait, "maximum wait time per operation when write-throttled (in milliseconds)")
   ;
@@ -323,6 +339,14 @@ bool LogfileManager::prepare () {
     LOG_FATAL_AND_EXIT("invalid value for --wal.sync-interval. Please use a value of at least %llu", (unsigned long long) MinSyncInterval());
   }
 
+  if (_collectorThreads < 1 || _collectorThreads > MaxCollectorThreads()) {
+    LOG_FATAL_AND_EXIT("invalid value for --wal.collector-threads. Please use a value between 1 and %lu", (unsigned long) MaxCollectorThreads());
+  }
+
+  if (_groupCommitDelay > 0 && _groupCommitSize == 0) {
+    LOG_FATAL_AND_EXIT("invalid value for --wal.group-commit-size. Please use a value of at least 1");
+  }
+
   // sync interval is specified in milliseconds by the user, but internally
   // we use microseconds
   _syncInterval = _syncInterval * 1000;
@@ -383,11 +407,12 @@ bool LogfileManager::start () {
 
   started = true;
 
-  LOG_TRACE("WAL logfile manager configuration: historic logfiles: %lu, reserve logfiles: %lu, filesize: %lu, sync interval: %lu",
+  LOG_TRACE("WAL logfile manager configuration: historic logfiles: %lu, reserve logfiles: %lu, filesize: %lu, sync interval: %lu, group commit delay: %lu",
             (unsigned long) _historicLogfiles,
             (unsigned long) _reserveLogfiles,
             (unsigned long) _filesize,
-            (unsigned long) _syncInterval);
+            (unsigned long) _syncInterval,
+            (unsigned long) _groupCommitDelay);
 
   return true;
 }
@@ -765,8 +790,8 @@ bool LogfileManager::hasReserveLogfiles () {
 /// @brief signal that a sync operation is required
 ////////////////////////////////////////////////////////////////////////////////
 
-void LogfileManager::signalSync () {
-  _synchroniserThread->signalSync();
+void LogfileManager::signalSync (bool waitForSync) {
+  _synchroniserThread->signalSync(waitForSync);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -1082,7 +1107,8 @@ void LogfileManager::setLogfileSealRequested (Logfile* logfile) {
     logfile->setStatus(Logfile::StatusType::SEAL_REQUESTED);
   }
 
-  signalSync();
+  // sealing must not be delayed by group commit
+  signalSync(true);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -1812,7 +1838,7 @@ int LogfileManager::writeShutdownInfo (bool writeShutdownTime) {
 ////////////////////////////////////////////////////////////////////////////////
 
 int LogfileManager::startSynchroniserThread () {
-  _synchroniserThread = new SynchroniserThread(this, _syncInterval);
+  _synchroniserThread = new SynchroniserThread(this, _syncInterval, _groupCommitDelay, _groupCommitSize);
 
   if (_synchroniserThread == nullptr) {
     return TRI_ERROR_INTERNAL;
@@ -1882,7 +1908,7 @@ void LogfileManager::stopAllocatorThread () {
 ////////////////////////////////////////////////////////////////////////////////
 
 int LogfileManager::startCollectorThread () {
-  _collectorThread = new CollectorThread(this, _server);
+  _collectorThread = new CollectorThread(this, _server, _collectorThreads);
 
   if (_collectorThread == nullptr) {
     return TRI_ERROR_INTERNAL;
@@ -2009,34 +2035,42 @@ int LogfileManager::inspectLogfiles () {
   }
 #endif
 
-  for (auto it = _logfiles.begin(); it != _logfiles.end(); ) {
-    Logfile::IdType const id = (*it).first;
-    std::string const filename = logfileName(id);
+  // open the logfiles. this verifies the checksums of all markers, which can
+  // be done for all logfiles in parallel
+  std::vector<OpenedLogfile> opened;
+  opened.reserve(_logfiles.size());
 
+  for (auto it = _logfiles.begin(); it != _logfiles.end(); ++it) {
     TRI_ASSERT((*it).second == nullptr);
+    opened.emplace_back((*it).first);
+  }
+
+  openLogfiles(opened);
+
+  // inspect the logfiles in the order of their ids, so the tick statistics
+  // are collected in the same order as the markers were written
+  size_t position = 0;
+
+  for (auto it = _logfiles.begin(); it != _logfiles.end(); ++position) {
+    Logfile::IdType const id = (*it).first;
+    std::string const filename = logfileName(id);
 
-    int res = Logfile::judge(filename);
+    TRI_ASSERT(opened[position].id == id);
 
-    if (res == TRI_ERROR_ARANGO_DATAFILE_EMPTY) {
+    if (opened[position].result == TRI_ERROR_ARANGO_DATAFILE_EMPTY) {
       _recoverState->emptyLogfiles.push_back(filename);
       _logfiles.erase(it++);
       continue;
     }
 
-    bool const wasCollected = (id <= _lastCollectedId);
-    Logfile* logfile = Logfile::openExisting(filename, id, wasCollected, _ignoreLogfileErrors);
+    Logfile* logfile = opened[position].logfile;
 
     if (logfile == nullptr) {
       // an error happened when opening a logfile
       if (! _ignoreLogfileErrors) {
         // we don't ignore errors, so we abort here
-        int res = TRI_errno();
-
-        if (res == TRI_ERROR_NO_ERROR) {
-          // must have an error!
-          res = TRI_ERROR_ARANGO_DATAFILE_UNREADABLE;
-        }
-        return res;
+        freeLogfiles(opened, position + 1);
+        return opened[position].result;
       }
 
       _logfiles.erase(it++);
@@ -2055,6 +2089,8 @@ int LogfileManager::inspectLogfiles () {
     // update the tick statistics  
     if (! TRI_IterateDatafile(logfile->df(), &RecoverState::InitialScanMarker, static_cast<void*>(_recoverState))) {
       LOG_WARNING("WAL inspection failed when scanning logfile '%s'", logfile->filename().c_str());
+      (*it).second = logfile;
+      freeLogfiles(opened, position + 1);
       return TRI_ERROR_ARANGO_RECOVERY;
     }
     
@@ -2088,6 +2124,96 @@ int LogfileManager::inspectLogfiles () {
   return TRI_ERROR_NO_ERROR;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief opens existing logfiles in parallel, using a temporary pool with as
+/// many threads as the collector uses, including the current thread. the
+/// result of opening each logfile is stored in its entry. empty logfiles are
+/// not opened but reported with TRI_ERROR_ARANGO_DATAFILE_EMPTY
+////////////////////////////////////////////////////////////////////////////////
+
+void LogfileManager::openLogfiles (std::vector<OpenedLogfile>& opened) {
+  if (opened.empty()) {
+    return;
+  }
+
+  std::atomic<size_t> next(0);
+
+  auto opener = [this, &opened, &next] () -> void {
+    while (true) {
+      size_t const i = next++;
+
+      if (i >= opened.size()) {
+        break;
+      }
+
+      OpenedLogfile& entry = opened[i];
+      std::string const filename = logfileName(entry.id);
+
+      entry.result = Logfile::judge(filename);
+
+      if (entry.result == TRI_ERROR_ARANGO_DATAFILE_EMPTY) {
+        continue;
+      }
+
+      bool const wasCollected = (entry.id <= _lastCollectedId);
+      entry.logfile = Logfile::openExisting(filename, entry.id, wasCollected, _ignoreLogfileErrors);
+
+      if (entry.logfile == nullptr) {
+        // the error number is thread-local
+        entry.result = TRI_errno();
+
+        if (entry.result == TRI_ERROR_NO_ERROR) {
+          // must have an error!
+          entry.result = TRI_ERROR_ARANGO_DATAFILE_UNREADABLE;
+        }
+      }
+      else {
+        entry.result = TRI_ERROR_NO_ERROR;
+      }
+    }
+  };
+
+  size_t const numThreads = (std::min)(static_cast<size_t>(_collectorThreads), opened.size()) - 1;
+
+  if (numThreads == 0) {
+    opener();
+    return;
+  }
+
+  triagens::basics::ThreadPool pool(numThreads, "WalInspector");
+  triagens::basics::Barrier barrier(numThreads);
+
+  for (size_t i = 0; i < numThreads; ++i) {
+    try {
+      pool.enqueue([&opener, &barrier] () -> void {
+        opener();
+        barrier.join();
+      });
+    }
+    catch (...) {
+      // this thread will pick up the work
+      barrier.join();
+    }
+  }
+
+  opener();
+
+  // barrier waits here until all threads have joined
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief frees logfiles that were opened by openLogfiles but not handed over
+/// to the list of logfiles
+////////////////////////////////////////////////////////////////////////////////
+
+void LogfileManager::freeLogfiles (std::vector<OpenedLogfile>& opened,
+                                   size_t start) {
+  for (size_t i = start; i < opened.size(); ++i) {
+    delete opened[i].logfile;
+    opened[i].logfile = nullptr;
+  }
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief allocates a new reserve logfile
 ////////////////////////////////////////////////////////////////////////////////
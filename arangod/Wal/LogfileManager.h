@@ -86,6 +86,22 @@ namespace triagens {
       std::string     timeString;
     };
 
+// -----------------------------------------------------------------------------
+// --SECTION--                                                     OpenedLogfile
+// -----------------------------------------------------------------------------
+
+    struct OpenedLogfile {
+      explicit OpenedLogfile (Logfile::IdType id)
+        : id(id),
+          logfile(nullptr),
+          result(TRI_ERROR_NO_ERROR) {
+      }
+
+      Logfile::IdType id;
+      Logfile* logfile;
+      int result;
+    };
+
 // -----------------------------------------------------------------------------
 // --SECTION--                                              class LogfileManager
 // -----------------------------------------------------------------------------
@@ -438,10 +454,11 @@ namespace triagens {
         bool hasReserveLogfiles ();
 
 ////////////////////////////////////////////////////////////////////////////////
-/// @brief signal that a sync operation is required
+/// @brief signal that a sync operation is required. the flag indicates
+/// whether the caller waits for the sync to complete
 ////////////////////////////////////////////////////////////////////////////////
 
-        void signalSync ();
+        void signalSync (bool);
 
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief reserve space in a logfile
@@ -774,6 +791,19 @@ namespace triagens {
 
         int inspectLogfiles ();
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief open existing logfiles in parallel
+////////////////////////////////////////////////////////////////////////////////
+
+        void openLogfiles (std::vector<OpenedLogfile>&);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief free opened logfiles, starting at the specified position
+////////////////////////////////////////////////////////////////////////////////
+
+        void freeLogfiles (std::vector<OpenedLogfile>&,
+                           size_t);
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief allocate a new reserve logfile
 ////////////////////////////////////////////////////////////////////////////////
@@ -942,6 +972,56 @@ namespace triagens {
 
         uint64_t _syncInterval;
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief group commit settings
+/// @startDocuBlock WalLogfileGroupCommit
+/// `--wal.group-commit-delay`
+///
+/// The maximum time (in microseconds) that ArangoDB will delay syncing the 
+/// write-ahead log for an operation executed with the *waitForSync* attribute,
+/// in order to sync it together with other such operations. Commits waiting
+/// for a sync are coalesced into a single disk sync, which is triggered as
+/// soon as either the oldest waiting commit has been delayed for the specified
+/// amount of time, or as soon as `--wal.group-commit-size` commits are 
+/// waiting. While group commit is active, operations executed without the 
+/// *waitForSync* attribute are synced together with the next group commit, or
+/// after `--wal.sync-interval` at the latest.
+/// A value of *0* turns off group commit, which is the default. Each
+/// operation is then synced as soon as possible.
+///
+/// `--wal.group-commit-size`
+///
+/// The number of commits waiting for a sync that will trigger a group commit
+/// right away, without waiting for the group commit delay to pass.
+/// This option only has an effect if `--wal.group-commit-delay` has a 
+/// non-zero value.
+/// @endDocuBlock
+////////////////////////////////////////////////////////////////////////////////
+
+        uint64_t _groupCommitDelay;
+
+        uint32_t _groupCommitSize;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief number of collector worker threads
+/// @startDocuBlock WalLogfileCollectorThreads
+/// `--wal.collector-threads`
+///
+/// The number of worker threads that the write-ahead log collector uses to
+/// transfer operations of a logfile into the datafiles of their collections.
+/// The operations of different collections are transferred in parallel,
+/// whereas the operations of each individual collection are still 
+/// transferred in the order in which they were written. Logfiles are
+/// collected one after the other.
+/// A value of *1* makes the collector thread transfer all operations itself.
+///
+/// On server start, the same number of threads is used to open the existing
+/// logfiles and verify the checksums of their markers.
+/// @endDocuBlock
+////////////////////////////////////////////////////////////////////////////////
+
+        uint32_t _collectorThreads;
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief maximum wait time for write-throttling
 ////////////////////////////////////////////////////////////////////////////////
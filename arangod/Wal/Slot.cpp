@@ -57,7 +57,7 @@ Slot::Slot ()
 ////////////////////////////////////////////////////////////////////////////////
 
 std::string Slot::statusText () const {
-  switch (_status) {
+  switch (_status.load()) {
     case StatusType::UNUSED:
       return "unused";
     case StatusType::USED:
@@ -95,10 +95,11 @@ void Slot::fill (void* src,
   // set size
   marker->_size = static_cast<TRI_voc_size_t>(size);
 
-  // calculate the crc
+  // calculate the crc. logfiles are only ever written in the current
+  // datafile version, so the crc is always a CRC32C value
   marker->_crc = 0;
   TRI_voc_crc_t crc = TRI_InitialCrc32();
-  crc = TRI_BlockCrc32(crc, (char const*) marker, static_cast<TRI_voc_size_t>(size));
+  crc = TRI_BlockCrc32C(crc, (char const*) marker, static_cast<TRI_voc_size_t>(size));
   marker->_crc = TRI_FinalCrc32(crc);
 
   TRI_IF_FAILURE("WalSlotCrc") {
@@ -125,7 +126,7 @@ void Slot::setUnused () {
   _logfileId   = 0;
   _mem         = nullptr;
   _size        = 0;
-  _status      = StatusType::UNUSED;
+  _status.store(StatusType::UNUSED, std::memory_order_release);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -141,7 +142,7 @@ void Slot::setUsed (void* mem,
   _logfileId = logfileId;
   _mem = mem;
   _size = size;
-  _status = StatusType::USED;
+  _status.store(StatusType::USED, std::memory_order_release);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -151,10 +152,10 @@ void Slot::setUsed (void* mem,
 void Slot::setReturned (bool waitForSync) {
   TRI_ASSERT(isUsed());
   if (waitForSync) {
-    _status = StatusType::RETURNED_WFS;
+    _status.store(StatusType::RETURNED_WFS, std::memory_order_release);
   }
   else {
-    _status = StatusType::RETURNED;
+    _status.store(StatusType::RETURNED, std::memory_order_release);
   }
 }
 
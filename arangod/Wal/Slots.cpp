@@ -32,12 +32,88 @@
 #include "Basics/MutexLocker.h"
 #include "Basics/hashes.h"
 #include "Basics/logging.h"
+#include "Statistics/statistics.h"
 #include "VocBase/datafile.h"
 #include "VocBase/server.h"
 #include "Wal/LogfileManager.h"
 
+#include <thread>
+
 using namespace triagens::wal;
 
+// -----------------------------------------------------------------------------
+// --SECTION--                                                 private constants
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief number of generations
+////////////////////////////////////////////////////////////////////////////////
+
+static uint64_t const NumberOfGenerations = 256;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief position of the slot count in the handout state
+////////////////////////////////////////////////////////////////////////////////
+
+static int const CountShift = 32;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief position of the generation in the handout state
+////////////////////////////////////////////////////////////////////////////////
+
+static int const GenerationShift = 56;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief slot count of a closed generation. no slots can be reserved in a
+/// closed generation
+////////////////////////////////////////////////////////////////////////////////
+
+static uint64_t const ClosedCount = 0xffffff;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief size of the smallest possible marker
+////////////////////////////////////////////////////////////////////////////////
+
+static uint64_t const MinimalMarkerSize = TRI_DF_ALIGN_BLOCK(sizeof(TRI_df_marker_t));
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                 private functions
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief build a handout state
+////////////////////////////////////////////////////////////////////////////////
+
+static inline uint64_t MakeState (uint64_t generation,
+                                  uint64_t count,
+                                  uint64_t offset) {
+  return (generation << GenerationShift) | (count << CountShift) | offset;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief extract the generation from a handout state
+////////////////////////////////////////////////////////////////////////////////
+
+static inline uint64_t GenerationOf (uint64_t state) {
+  return state >> GenerationShift;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief extract the slot count from a handout state
+////////////////////////////////////////////////////////////////////////////////
+
+static inline uint64_t CountOf (uint64_t state) {
+  return (state >> CountShift) & ClosedCount;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief extract the logfile offset from a handout state
+////////////////////////////////////////////////////////////////////////////////
+
+static inline uint64_t OffsetOf (uint64_t state) {
+  return state & 0xffffffffULL;
+}
+
 // -----------------------------------------------------------------------------
 // --SECTION--                                      constructors and destructors
 // -----------------------------------------------------------------------------
@@ -52,14 +128,16 @@ Slots::Slots (LogfileManager* logfileManager,
   : _logfileManager(logfileManager),
     _condition(),
     _lock(),
+    _handoutState(MakeState(0, ClosedCount, 0)),
+    _generations(),
+    _rotateLock(),
+    _nextSlot(0),
+    _recycled(0),
+    _ticked(0),
     _slots(new Slot[numberOfSlots]),
     _numberOfSlots(numberOfSlots),
-    _freeSlots(numberOfSlots),
     _waiting(0),
-    _handoutIndex(0),
     _recycleIndex(0),
-    _logfile(nullptr),
-    _lastAssignedTick(0),
     _lastCommittedTick(0),
     _lastCommittedDataTick(0),
     _numEvents(0)  {
@@ -86,10 +164,10 @@ Slots::~Slots () {
 void Slots::statistics (Slot::TickType& lastTick,
                         Slot::TickType& lastDataTick,
                         uint64_t& numEvents) {
-  MUTEX_LOCKER(_lock);
-  lastTick     = _lastCommittedTick;
-  lastDataTick = _lastCommittedDataTick;
-  numEvents    = _numEvents;
+  // the data tick is read first, as it never overtakes the committed tick
+  lastDataTick = _lastCommittedDataTick.load(std::memory_order_acquire);
+  lastTick     = _lastCommittedTick.load(std::memory_order_acquire);
+  numEvents    = _numEvents.load(std::memory_order_relaxed);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -103,7 +181,7 @@ int Slots::flush (bool waitForSync) {
   int res = closeLogfile(lastTick, worked);
 
   if (res == TRI_ERROR_NO_ERROR) {
-    _logfileManager->signalSync();
+    _logfileManager->signalSync(waitForSync);
 
     if (waitForSync) {
       // wait until data has been committed to disk
@@ -127,8 +205,7 @@ int Slots::flush (bool waitForSync) {
 ////////////////////////////////////////////////////////////////////////////////
 
 Slot::TickType Slots::lastCommittedTick () {
-  MUTEX_LOCKER(_lock);
-  return _lastCommittedTick;
+  return _lastCommittedTick.load(std::memory_order_acquire);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -136,110 +213,7 @@ Slot::TickType Slots::lastCommittedTick () {
 ////////////////////////////////////////////////////////////////////////////////
 
 SlotInfo Slots::nextUnused (uint32_t size) {
-  // we need to use the aligned size for writing
-  uint32_t alignedSize = TRI_DF_ALIGN_BLOCK(size);
-  int iterations = 0;
-  bool hasWaited = false;
-
-  TRI_ASSERT(size > 0);
-
-  while (++iterations < 1000) {
-    {
-      MUTEX_LOCKER(_lock);
-
-      Slot* slot = &_slots[_handoutIndex];
-      TRI_ASSERT(slot != nullptr);
-
-      if (slot->isUnused()) {
-        if (hasWaited) {
-          CONDITION_LOCKER(guard, _condition);
-          TRI_ASSERT(_waiting > 0);
-          --_waiting;
-          hasWaited = false;
-        }
-
-        // cycle until we have a valid logfile
-        while (_logfile == nullptr ||
-               _logfile->freeSize() < static_cast<uint64_t>(alignedSize)) {
-
-          if (_logfile != nullptr) {
-            // seal existing logfile by creating a footer marker
-            int res = writeFooter(slot);
-
-            if (res != TRI_ERROR_NO_ERROR) {
-              return SlotInfo(res);
-            }
-
-            // advance to next slot
-            slot = &_slots[_handoutIndex];
-            _logfileManager->setLogfileSealRequested(_logfile);
-
-            _logfile = nullptr;
-          }
-
-          // fetch the next free logfile (this may create a new one)
-          Logfile::StatusType status = newLogfile(alignedSize);
-
-          if (_logfile == nullptr) {
-            usleep(10 * 1000);
-
-            TRI_IF_FAILURE("LogfileManagerGetWriteableLogfile") {
-              return SlotInfo(TRI_ERROR_ARANGO_NO_JOURNAL);
-            }
-
-            // try again in next iteration
-          }
-          else if (status == Logfile::StatusType::EMPTY) {
-            // inititialise the empty logfile by writing a header marker
-            int res = writeHeader(slot);
-
-            if (res != TRI_ERROR_NO_ERROR) {
-              return SlotInfo(res);
-            }
-
-            // advance to next slot
-            slot = &_slots[_handoutIndex];
-            _logfileManager->setLogfileOpen(_logfile);
-          }
-          else {
-            TRI_ASSERT(status == Logfile::StatusType::OPEN);
-          }
-        }
-
-        // if we get here, we got a free slot for the actual data...
-
-        char* mem = _logfile->reserve(alignedSize);
-
-        if (mem == nullptr) {
-          return SlotInfo(TRI_ERROR_INTERNAL);
-        }
-
-        // only in this case we return a valid slot
-        slot->setUsed(static_cast<void*>(mem), size, _logfile->id(), handout());
-
-        return SlotInfo(slot);
-      }
-    }
-
-    // if we get here, all slots are busy
-    CONDITION_LOCKER(guard, _condition);
-    if (! hasWaited) {
-      ++_waiting;
-      hasWaited = true;
-    }
-
-    bool mustWait;
-    {
-      MUTEX_LOCKER(_lock);
-      mustWait = (_freeSlots == 0);
-    }
-
-    if (mustWait) {
-      guard.wait(10 * 1000);
-    }
-  }
-
-  return SlotInfo(TRI_ERROR_ARANGO_NO_JOURNAL);
+  return handout(size, 0, 0, 0, nullptr);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -255,125 +229,7 @@ SlotInfo Slots::nextUnused (uint32_t size,
                             uint32_t legendOffset,
                             void*& oldLegend) {
                             // legendOffset 0 means no legend included
-  // we need to use the aligned size for writing
-  uint32_t alignedSize = TRI_DF_ALIGN_BLOCK(size);
-  int iterations = 0;
-  bool hasWaited = false;
-
-  TRI_ASSERT(size > 0);
-
-  while (++iterations < 1000) {
-    {
-      MUTEX_LOCKER(_lock);
-
-      Slot* slot = &_slots[_handoutIndex];
-      TRI_ASSERT(slot != nullptr);
-
-      if (slot->isUnused()) {
-        if (hasWaited) {
-          CONDITION_LOCKER(guard, _condition);
-          TRI_ASSERT(_waiting > 0);
-          --_waiting;
-          hasWaited = false;
-        }
-
-        // cycle until we have a valid logfile
-        while (_logfile == nullptr ||
-               _logfile->freeSize() < static_cast<uint64_t>(alignedSize)) {
-
-          if (_logfile != nullptr) {
-            // seal existing logfile by creating a footer marker
-            int res = writeFooter(slot);
-
-            if (res != TRI_ERROR_NO_ERROR) {
-              return SlotInfo(res);
-            }
-
-            // advance to next slot
-            slot = &_slots[_handoutIndex];
-            _logfileManager->setLogfileSealRequested(_logfile);
-
-            _logfile = nullptr;
-          }
-
-          // fetch the next free logfile (this may create a new one)
-          Logfile::StatusType status = newLogfile(alignedSize);
-
-          if (_logfile == nullptr) {
-            usleep(10 * 1000);
-
-            TRI_IF_FAILURE("LogfileManagerGetWriteableLogfile") {
-              return SlotInfo(TRI_ERROR_ARANGO_NO_JOURNAL);
-            }
-
-            // try again in next iteration
-          }
-          else if (status == Logfile::StatusType::EMPTY) {
-            // inititialise the empty logfile by writing a header marker
-            int res = writeHeader(slot);
-
-            if (res != TRI_ERROR_NO_ERROR) {
-              return SlotInfo(res);
-            }
-
-            // advance to next slot
-            slot = &_slots[_handoutIndex];
-            _logfileManager->setLogfileOpen(_logfile);
-          }
-          else {
-            TRI_ASSERT(status == Logfile::StatusType::OPEN);
-          }
-        }
-
-        // if we get here, we got a free slot for the actual data...
-        
-        // Now sort out the legend business:
-        if (legendOffset == 0) {
-          void* legend = _logfile->lookupLegend(cid, sid);
-          if (nullptr == legend) {
-            // Bad, we would need a legend for this marker
-            return SlotInfo(TRI_ERROR_LEGEND_NOT_IN_WAL_FILE);
-          }
-          oldLegend = legend;
-        }
-
-        char* mem = _logfile->reserve(alignedSize);
-
-        if (mem == nullptr) {
-          return SlotInfo(TRI_ERROR_INTERNAL);
-        }
-
-        if (legendOffset != 0) {
-          void* legend = static_cast<void*>(mem + legendOffset);
-          _logfile->cacheLegend(cid, sid, legend);
-        }
-
-        // only in this case we return a valid slot
-        slot->setUsed(static_cast<void*>(mem), size, _logfile->id(), handout());
-
-        return SlotInfo(slot);
-      }
-    }
-
-    // if we get here, all slots are busy
-    CONDITION_LOCKER(guard, _condition);
-    if (! hasWaited) {
-      ++_waiting;
-      hasWaited = true;
-    }
-
-    bool mustWait;
-    {
-      MUTEX_LOCKER(_lock);
-      mustWait = (_freeSlots == 0);
-    }
-
-    if (mustWait) {
-      guard.wait(10 * 1000);
-    }
-  }
-
-  return SlotInfo(TRI_ERROR_ARANGO_NO_JOURNAL);
+  return handout(size, cid, sid, legendOffset, &oldLegend);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -387,16 +243,20 @@ void Slots::returnUsed (SlotInfo& slotInfo,
 
   TRI_ASSERT(tick > 0);
 
-  {
-    MUTEX_LOCKER(_lock);
-    slotInfo.slot->setReturned(waitForSync);
-    ++_numEvents;
-  }
-
-  _logfileManager->signalSync();
+  // the slot status is atomic, so returning a slot does not need a lock
+  slotInfo.slot->setReturned(waitForSync);
+  _numEvents.fetch_add(1, std::memory_order_relaxed);
 
   if (waitForSync) {
+    double const start = TRI_microtime();
+
+    _logfileManager->signalSync(true);
     waitForTick(tick);
+
+    TRI_AddWalSyncTimeStatistics(TRI_microtime() - start);
+  }
+  else {
+    _logfileManager->signalSync(false);
   }
 }
 
@@ -407,8 +267,9 @@ void Slots::returnUsed (SlotInfo& slotInfo,
 SyncRegion Slots::getSyncRegion () {
   SyncRegion region;
 
-  MUTEX_LOCKER(_lock);
-
+  // no lock required here: only the synchroniser thread reads returned slots
+  // and recycles them, and the status of a slot is checked before any of its
+  // other members is accessed
   size_t slotIndex = _recycleIndex;
 
   while (true) {
@@ -418,8 +279,11 @@ SyncRegion Slots::getSyncRegion () {
     if (! slot->isReturned()) {
       // found a slot that is not yet returned
       // if it belongs to another logfile, we can seal the logfile we created
-      // the region for
-      auto otherId = slot->logfileId();
+      // the region for. an unused slot does not belong to any logfile
+      Logfile::IdType otherId = 0;
+      if (slot->isUsed()) {
+        otherId = slot->logfileId();
+      }
       if (region.logfileId != 0 && otherId != 0 && 
           otherId != region.logfileId) {
         region.canSeal = true;
@@ -488,8 +352,8 @@ void Slots::returnSyncRegion (SyncRegion const& region) {
 
       // note last tick
       Slot::TickType tick = slot->tick();
-      TRI_ASSERT(tick >= _lastCommittedTick);
-      _lastCommittedTick = tick;
+      TRI_ASSERT(tick >= _lastCommittedTick.load());
+      _lastCommittedTick.store(tick, std::memory_order_release);
 
       // update the data tick
       TRI_df_marker_t const* m = static_cast<TRI_df_marker_t const*>(slot->mem());
@@ -497,13 +361,13 @@ void Slots::returnSyncRegion (SyncRegion const& region) {
           m->_type != TRI_DF_MARKER_FOOTER && 
           m->_type != TRI_WAL_MARKER_ATTRIBUTE &&
           m->_type != TRI_WAL_MARKER_SHAPE) {
-        _lastCommittedDataTick = tick;
+        _lastCommittedDataTick.store(tick, std::memory_order_release);
       }
 
       region.logfile->update(m);
 
       slot->setUnused();
-      ++_freeSlots;
+      _recycled.fetch_add(1, std::memory_order_release);
 
       // update recycle index, too
       if (++_recycleIndex >= _numberOfSlots) {
@@ -530,18 +394,25 @@ void Slots::returnSyncRegion (SyncRegion const& region) {
 
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief get the current open region of a logfile
-/// this uses the slots lock
+/// this does not need a lock
 ////////////////////////////////////////////////////////////////////////////////
 
 void Slots::getActiveLogfileRegion (Logfile* logfile,
                                     char const*& begin,
                                     char const*& end) {
-  MUTEX_LOCKER(_lock);
+  uint64_t const state = _handoutState.load(std::memory_order_acquire);
 
   TRI_datafile_t* datafile = logfile->df();
 
   begin = datafile->_data;
-  end   = begin + datafile->_currentSize;
+
+  if (_generations[GenerationOf(state)].logfile == logfile) {
+    // the size of the current logfile is only updated when it is sealed
+    end = begin + OffsetOf(state);
+  }
+  else {
+    end = begin + datafile->_currentSize;
+  }
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -571,121 +442,336 @@ void Slots::getActiveTickRange (Logfile* logfile,
 
 int Slots::closeLogfile (Slot::TickType& lastCommittedTick,
                          bool& worked) {
-  int iterations = 0;
-  bool hasWaited = false;
   worked = false;
 
-  while (++iterations < 1000) {
-    {
-      MUTEX_LOCKER(_lock);
+  MUTEX_LOCKER(_rotateLock);
 
-      lastCommittedTick = _lastCommittedTick;
+  lastCommittedTick = _lastCommittedTick.load(std::memory_order_acquire);
 
-      Slot* slot = &_slots[_handoutIndex];
-      TRI_ASSERT(slot != nullptr);
+  uint64_t const state = _handoutState.load(std::memory_order_acquire);
 
-      if (slot->isUnused()) {
-        if (hasWaited) {
-          CONDITION_LOCKER(guard, _condition);
-          TRI_ASSERT(_waiting > 0);
-          --_waiting;
-          hasWaited = false;
-        }
+  if (CountOf(state) != ClosedCount) {
+    if (_generations[GenerationOf(state)].logfile->status() == Logfile::StatusType::EMPTY) {
+      // no need to seal a still-empty logfile
+      return TRI_ERROR_NO_ERROR;
+    }
 
-        if (_logfile != nullptr) {
-          if (_logfile->status() == Logfile::StatusType::EMPTY) {
-            // no need to seal a still-empty logfile
-            return TRI_ERROR_NO_ERROR;
-          }
+    // seal existing logfile by creating a footer marker
+    int res = closeGeneration();
 
-          // seal existing logfile by creating a footer marker
-          int res = writeFooter(slot);
+    if (res != TRI_ERROR_NO_ERROR) {
+      LOG_ERROR("could not write logfile footer: %s", TRI_errno_string(res));
+      return res;
+    }
+  }
 
-          if (res != TRI_ERROR_NO_ERROR) {
-            LOG_ERROR("could not write logfile footer: %s", TRI_errno_string(res));
-            return res;
-          }
+  // fetch the next free logfile (this may create a new one)
+  // note: as we don't have a real marker to write the size does
+  // not matter (we use a size of 1 as it must be > 0)
+  Logfile::StatusType status;
+  int res = openGeneration(1, status);
 
-          _logfileManager->setLogfileSealRequested(_logfile);
+  if (res != TRI_ERROR_NO_ERROR) {
+    return res;
+  }
 
-          // advance to next slot
-          slot = &_slots[_handoutIndex];
+  worked = (status == Logfile::StatusType::EMPTY);
 
-          // invalidate the logfile so for the next write we'll use a
-          // new one
-          _logfile = nullptr;
+  return TRI_ERROR_NO_ERROR;
+}
 
-          // fall-through intentional
-        }
+////////////////////////////////////////////////////////////////////////////////
+/// @brief hand out the next slot, optionally doing the legend business
+/// the slot number, logfile memory and tick are reserved with a single
+/// compare-and-swap on the handout state. only if the current logfile is full
+/// the caller switches to the next logfile, under the rotate lock
+////////////////////////////////////////////////////////////////////////////////
 
-        TRI_ASSERT(_logfile == nullptr);
-        // fetch the next free logfile (this may create a new one)
-        // note: as we don't have a real marker to write the size does
-        // not matter (we use a size of 1 as  it must be > 0)
-        Logfile::StatusType status = newLogfile(1);
+SlotInfo Slots::handout (uint32_t size,
+                         TRI_voc_cid_t cid,
+                         TRI_shape_sid_t sid,
+                         uint32_t legendOffset,
+                         void** oldLegend) {
+  // we need to use the aligned size for writing
+  uint64_t const alignedSize = TRI_DF_ALIGN_BLOCK(size);
+  void* legend = nullptr;
 
-        if (_logfile == nullptr) {
-          TRI_IF_FAILURE("LogfileManagerGetWriteableLogfile") {
-            return TRI_ERROR_ARANGO_NO_JOURNAL;
-          }
+  TRI_ASSERT(size > 0);
+
+  uint64_t state = _handoutState.load(std::memory_order_acquire);
 
-          usleep(10 * 1000);
-          // try again in next iteration
+  while (true) {
+    uint64_t const count = CountOf(state);
+
+    if (count != ClosedCount) {
+      Generation const& generation = _generations[GenerationOf(state)];
+
+      if (count < generation.maxCount &&
+          OffsetOf(state) + alignedSize <= generation.limit) {
+
+        if (oldLegend != nullptr && legendOffset == 0) {
+          // the marker refers to a legend that must be in the same logfile
+          legend = generation.logfile->lookupLegend(cid, sid);
+
+          if (legend == nullptr) {
+            // Bad, we would need a legend for this marker
+            return SlotInfo(TRI_ERROR_LEGEND_NOT_IN_WAL_FILE);
+          }
         }
-        else if (status == Logfile::StatusType::EMPTY) {
-          // inititialise the empty logfile by writing a header marker
-          int res = writeHeader(slot);
 
-          if (res != TRI_ERROR_NO_ERROR) {
-            LOG_ERROR("could not write logfile header: %s", TRI_errno_string(res));
-            return res;
+        uint64_t const next = state + (static_cast<uint64_t>(1) << CountShift) + alignedSize;
+
+        if (_handoutState.compare_exchange_weak(state, next, std::memory_order_acq_rel, std::memory_order_acquire)) {
+          Reservation const reservation = generation.reservation(count, OffsetOf(state));
+          Slot::TickType const tick = tickSlot(reservation.slot);
+          Slot* slot = acquireSlot(reservation.slot);
+
+          if (oldLegend != nullptr) {
+            if (legendOffset == 0) {
+              *oldLegend = legend;
+            }
+            else {
+              reservation.logfile->cacheLegend(cid, sid, static_cast<void*>(reservation.mem + legendOffset));
+            }
           }
 
-          _logfileManager->setLogfileOpen(_logfile);
-          worked = true;
-          return TRI_ERROR_NO_ERROR;
-        }
-        else {
-          TRI_ASSERT(status == Logfile::StatusType::OPEN);
-          worked = false;
-          return TRI_ERROR_NO_ERROR;
+          slot->setUsed(static_cast<void*>(reservation.mem), size, reservation.logfile->id(), tick);
+
+          return SlotInfo(slot);
         }
+
+        // another thread has reserved a slot in the meantime
+        continue;
       }
     }
 
-    // if we get here, all slots are busy
+    // the current logfile is full, or there is no current logfile yet
+    int res = rotate(static_cast<uint32_t>(alignedSize));
+
+    if (res != TRI_ERROR_NO_ERROR) {
+      return SlotInfo(res);
+    }
+
+    state = _handoutState.load(std::memory_order_acquire);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief wait until the slot with the specified number can be used
+/// this is only necessary if all slots are in use
+////////////////////////////////////////////////////////////////////////////////
+
+Slot* Slots::acquireSlot (uint64_t number) {
+  if (number >= _recycled.load(std::memory_order_acquire) + _numberOfSlots) {
     CONDITION_LOCKER(guard, _condition);
-    if (! hasWaited) {
-      ++_waiting;
-      hasWaited = true;
+    ++_waiting;
+
+    while (number >= _recycled.load(std::memory_order_acquire) + _numberOfSlots) {
+      guard.wait(10 * 1000);
     }
 
-    bool mustWait;
-    {
-      MUTEX_LOCKER(_lock);
-      mustWait = (_freeSlots == 0);
+    --_waiting;
+  }
+
+  Slot* slot = &_slots[number % _numberOfSlots];
+  TRI_ASSERT(slot->isUnused());
+
+  return slot;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief take the tick for the slot with the specified number
+/// the tick is taken from the server's tick counter, like the revision and
+/// transaction ids, so the ticks restored on recovery are never lower than
+/// ids that have been written. the caller has reserved the slot already, so
+/// it only waits for the reservations of the preceding slots to take their
+/// ticks, which they do without taking any lock
+////////////////////////////////////////////////////////////////////////////////
+
+Slot::TickType Slots::tickSlot (uint64_t number) {
+  int iterations = 0;
+
+  while (_ticked.load(std::memory_order_acquire) != number) {
+    if (++iterations > 64) {
+      std::this_thread::yield();
     }
+  }
 
-    if (mustWait) {
-      guard.wait(10 * 1000);
+  Slot::TickType const tick = static_cast<Slot::TickType>(TRI_NewTickServer());
+  _ticked.store(number + 1, std::memory_order_release);
+
+  return tick;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief switch to a logfile which can satisfy a marker of the specified
+/// size. this is the slow path of the handout
+////////////////////////////////////////////////////////////////////////////////
+
+int Slots::rotate (uint32_t alignedSize) {
+  MUTEX_LOCKER(_rotateLock);
+
+  uint64_t const state = _handoutState.load(std::memory_order_acquire);
+  uint64_t const count = CountOf(state);
+
+  if (count != ClosedCount) {
+    Generation const& generation = _generations[GenerationOf(state)];
+
+    if (count < generation.maxCount &&
+        OffsetOf(state) + alignedSize <= generation.limit) {
+      // another thread has switched the logfile in the meantime
+      return TRI_ERROR_NO_ERROR;
     }
+
+    // seal existing logfile by creating a footer marker
+    int res = closeGeneration();
+
+    if (res != TRI_ERROR_NO_ERROR) {
+      return res;
+    }
+  }
+
+  Logfile::StatusType status;
+
+  return openGeneration(alignedSize, status);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief seal the current logfile by writing a footer marker
+/// the caller must hold the rotate lock
+////////////////////////////////////////////////////////////////////////////////
+
+int Slots::closeGeneration () {
+  uint64_t const footerSize = TRI_DF_ALIGN_BLOCK(sizeof(TRI_df_footer_marker_t));
+  uint64_t state = _handoutState.load(std::memory_order_acquire);
+  uint64_t closed;
+
+  // reserve the footer and close the generation in one step. the space for
+  // the footer is not included in the generation's limit
+  do {
+    TRI_ASSERT(CountOf(state) != ClosedCount);
+    closed = MakeState(GenerationOf(state), ClosedCount, OffsetOf(state) + footerSize);
+  }
+  while (! _handoutState.compare_exchange_weak(state, closed, std::memory_order_acq_rel, std::memory_order_acquire));
+
+  Generation const& generation = _generations[GenerationOf(state)];
+  Reservation const reservation = generation.reservation(CountOf(state), OffsetOf(state));
+
+  // the size of the logfile is final now
+  TRI_datafile_t* df = generation.logfile->df();
+  df->_next        = reservation.mem + footerSize;
+  df->_currentSize = static_cast<TRI_voc_size_t>(OffsetOf(closed));
+
+  _nextSlot = reservation.slot + 1;
+
+  int res = writeFooter(reservation);
+
+  if (res != TRI_ERROR_NO_ERROR) {
+    return res;
   }
 
-  return TRI_ERROR_ARANGO_NO_JOURNAL;
+  _logfileManager->setLogfileSealRequested(generation.logfile);
+
+  return TRI_ERROR_NO_ERROR;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief make a logfile which can satisfy a marker of the specified size
+/// the current one
+/// the caller must hold the rotate lock
+////////////////////////////////////////////////////////////////////////////////
+
+int Slots::openGeneration (uint32_t size,
+                           Logfile::StatusType& status) {
+  TRI_ASSERT(size > 0);
+  TRI_ASSERT(CountOf(_handoutState.load()) == ClosedCount);
+
+  Logfile* logfile = nullptr;
+  int iterations = 0;
+
+  while (true) {
+    // fetch the next free logfile (this may create a new one)
+    status = Logfile::StatusType::UNKNOWN;
+    logfile = _logfileManager->getWriteableLogfile(size, status);
+
+    if (logfile != nullptr) {
+      break;
+    }
+
+    TRI_IF_FAILURE("LogfileManagerGetWriteableLogfile") {
+      return TRI_ERROR_ARANGO_NO_JOURNAL;
+    }
+
+    if (++iterations >= 1000) {
+      return TRI_ERROR_ARANGO_NO_JOURNAL;
+    }
+
+    usleep(10 * 1000);
+  }
+
+  TRI_datafile_t* df = logfile->df();
+  uint64_t offset = static_cast<uint64_t>(df->_currentSize);
+  uint64_t const limit = logfile->allocatedSize() - Logfile::overhead();
+
+  // the number of markers that may fit into the logfile, plus the header and
+  // the footer
+  uint64_t numberOfSlots = 2;
+
+  if (limit > offset) {
+    numberOfSlots += (limit - offset) / MinimalMarkerSize;
+  }
+
+  if (numberOfSlots > ClosedCount) {
+    numberOfSlots = ClosedCount;
+  }
+
+  uint64_t const number = (GenerationOf(_handoutState.load(std::memory_order_acquire)) + 1) % NumberOfGenerations;
+
+  Generation& generation = _generations[number];
+  generation.logfile   = logfile;
+  generation.begin     = df->_data;
+  generation.limit     = limit;
+  generation.maxCount  = numberOfSlots - 1;
+  generation.firstSlot = _nextSlot;
+
+  uint64_t count = 0;
+
+  if (status == Logfile::StatusType::EMPTY) {
+    // inititialise the empty logfile by writing a header marker
+    int res = writeHeader(generation.reservation(count, offset));
+
+    if (res != TRI_ERROR_NO_ERROR) {
+      LOG_ERROR("could not write logfile header: %s", TRI_errno_string(res));
+      return res;
+    }
+
+    ++count;
+    offset += TRI_DF_ALIGN_BLOCK(sizeof(TRI_df_header_marker_t));
+
+    _logfileManager->setLogfileOpen(logfile);
+  }
+  else {
+    TRI_ASSERT(status == Logfile::StatusType::OPEN);
+  }
+
+  // from now on, slots can be reserved in the logfile
+  _handoutState.store(MakeState(number, count, offset), std::memory_order_release);
+
+  return TRI_ERROR_NO_ERROR;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief write a header marker
 ////////////////////////////////////////////////////////////////////////////////
 
-int Slots::writeHeader (Slot* slot) {
-  TRI_df_header_marker_t&& header = _logfile->getHeaderMarker();
+int Slots::writeHeader (Reservation const& reservation) {
+  TRI_df_header_marker_t&& header = reservation.logfile->getHeaderMarker();
   size_t const size = header.base._size;
 
-  TRI_df_marker_t* mem = reinterpret_cast<TRI_df_marker_t*>(_logfile->reserve(size));
-  TRI_ASSERT(mem != nullptr);
+  Slot::TickType const tick = tickSlot(reservation.slot);
+  Slot* slot = acquireSlot(reservation.slot);
 
-  slot->setUsed(static_cast<void*>(mem), static_cast<uint32_t>(size), _logfile->id(), handout());
+  slot->setUsed(static_cast<void*>(reservation.mem), static_cast<uint32_t>(size), reservation.logfile->id(), tick);
   slot->fill(&header.base, size);
   slot->setReturned(false); // sync
 
@@ -696,39 +782,20 @@ int Slots::writeHeader (Slot* slot) {
 /// @brief write a footer marker
 ////////////////////////////////////////////////////////////////////////////////
 
-int Slots::writeFooter (Slot* slot) {
-  TRI_ASSERT(_logfile != nullptr);
-
-  TRI_df_footer_marker_t&& footer = _logfile->getFooterMarker();
+int Slots::writeFooter (Reservation const& reservation) {
+  TRI_df_footer_marker_t&& footer = reservation.logfile->getFooterMarker();
   size_t const size = footer.base._size;
 
-  TRI_df_marker_t* mem = reinterpret_cast<TRI_df_marker_t*>(_logfile->reserve(size));
-  TRI_ASSERT(mem != nullptr);
+  Slot::TickType const tick = tickSlot(reservation.slot);
+  Slot* slot = acquireSlot(reservation.slot);
 
-  slot->setUsed(static_cast<void*>(mem), static_cast<uint32_t>(size), _logfile->id(), handout());
+  slot->setUsed(static_cast<void*>(reservation.mem), static_cast<uint32_t>(size), reservation.logfile->id(), tick);
   slot->fill(&footer.base, size);
   slot->setReturned(true); // sync
 
   return TRI_ERROR_NO_ERROR;
 }
 
-////////////////////////////////////////////////////////////////////////////////
-/// @brief handout a region and advance the handout index
-////////////////////////////////////////////////////////////////////////////////
-
-Slot::TickType Slots::handout () {
-  TRI_ASSERT(_freeSlots > 0);
-  _freeSlots--;
-
-  if (++_handoutIndex ==_numberOfSlots) {
-    // wrap around
-    _handoutIndex = 0;
-  }
- 
-  _lastAssignedTick = static_cast<Slot::TickType>(TRI_NewTickServer());
-  return _lastAssignedTick;
-}
-
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief wait until all data has been synced up to a certain marker
 ////////////////////////////////////////////////////////////////////////////////
@@ -752,20 +819,6 @@ bool Slots::waitForTick (Slot::TickType tick) {
   return false;
 }
 
-////////////////////////////////////////////////////////////////////////////////
-/// @brief request a new logfile which can satisfy a marker of the
-/// specified size
-////////////////////////////////////////////////////////////////////////////////
-
-Logfile::StatusType Slots::newLogfile (uint32_t size) {
-  TRI_ASSERT(size > 0);
-
-  Logfile::StatusType status = Logfile::StatusType::UNKNOWN;
-  _logfile = _logfileManager->getWriteableLogfile(size, status);
-
-  return status;
-}
-
 // -----------------------------------------------------------------------------
 // --SECTION--                                                       END-OF-FILE
 // -----------------------------------------------------------------------------
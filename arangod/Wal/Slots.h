@@ -193,7 +193,7 @@ namespace triagens {
 
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief get the current open region of a logfile
-/// this uses the slots lock
+/// this does not need a lock
 ////////////////////////////////////////////////////////////////////////////////
 
         void getActiveLogfileRegion (Logfile*,
@@ -209,6 +209,48 @@ namespace triagens {
                                  TRI_voc_tick_t&,
                                  TRI_voc_tick_t&);
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief wait until all data has been synced up to a certain marker
+////////////////////////////////////////////////////////////////////////////////
+
+        bool waitForTick (Slot::TickType);
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                     private types
+// -----------------------------------------------------------------------------
+
+      private:
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief a reserved slot with its logfile memory
+////////////////////////////////////////////////////////////////////////////////
+
+        struct Reservation {
+          uint64_t slot;
+          char*    mem;
+          Logfile* logfile;
+        };
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief a logfile that slots are handed out for. the values are set when
+/// the logfile becomes the current one, and are not changed afterwards
+////////////////////////////////////////////////////////////////////////////////
+
+        struct Generation {
+          Reservation reservation (uint64_t count,
+                                   uint64_t offset) const {
+            return Reservation{ firstSlot + count,
+                                begin + offset,
+                                logfile };
+          }
+
+          Logfile* logfile;
+          char*    begin;
+          uint64_t limit;
+          uint64_t maxCount;
+          uint64_t firstSlot;
+        };
+
 // -----------------------------------------------------------------------------
 // --SECTION--                                                   private methods
 // -----------------------------------------------------------------------------
@@ -221,35 +263,60 @@ namespace triagens {
                           bool&);
 
 ////////////////////////////////////////////////////////////////////////////////
-/// @brief write a header marker
+/// @brief hand out the next slot, optionally doing the legend business
 ////////////////////////////////////////////////////////////////////////////////
 
-        int writeHeader (Slot*);
+        SlotInfo handout (uint32_t,
+                          TRI_voc_cid_t,
+                          TRI_shape_sid_t,
+                          uint32_t,
+                          void**);
 
 ////////////////////////////////////////////////////////////////////////////////
-/// @brief write a footer marker
+/// @brief wait until the slot with the specified number can be used
 ////////////////////////////////////////////////////////////////////////////////
 
-        int writeFooter (Slot*);
+        Slot* acquireSlot (uint64_t);
 
 ////////////////////////////////////////////////////////////////////////////////
-/// @brief handout a region and advance the handout index
+/// @brief take the tick for the slot with the specified number
+/// the ticks are taken in slot order, so they increase with the slot numbers
 ////////////////////////////////////////////////////////////////////////////////
 
-        Slot::TickType handout ();
+        Slot::TickType tickSlot (uint64_t);
 
 ////////////////////////////////////////////////////////////////////////////////
-/// @brief wait until all data has been synced up to a certain marker
+/// @brief switch to a logfile which can satisfy a marker of the specified
+/// size. this is the slow path of the handout
 ////////////////////////////////////////////////////////////////////////////////
 
-        bool waitForTick (Slot::TickType);
+        int rotate (uint32_t);
 
 ////////////////////////////////////////////////////////////////////////////////
-/// @brief request a new logfile which can satisfy a marker of the
-/// specified size
+/// @brief seal the current logfile by writing a footer marker
 ////////////////////////////////////////////////////////////////////////////////
 
-        Logfile::StatusType newLogfile (uint32_t);
+        int closeGeneration ();
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief make a logfile which can satisfy a marker of the specified size
+/// the current one
+////////////////////////////////////////////////////////////////////////////////
+
+        int openGeneration (uint32_t,
+                            Logfile::StatusType&);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief write a header marker
+////////////////////////////////////////////////////////////////////////////////
+
+        int writeHeader (Reservation const&);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief write a footer marker
+////////////////////////////////////////////////////////////////////////////////
+
+        int writeFooter (Reservation const&);
 
 // -----------------------------------------------------------------------------
 // --SECTION--                                                 private variables
@@ -270,76 +337,97 @@ namespace triagens {
         basics::ConditionVariable _condition;
 
 ////////////////////////////////////////////////////////////////////////////////
-/// @brief mutex protecting the slots interface
+/// @brief mutex protecting the tick ranges of the logfiles
 ////////////////////////////////////////////////////////////////////////////////
 
         basics::Mutex _lock;
 
 ////////////////////////////////////////////////////////////////////////////////
-/// @brief all slots
+/// @brief the handout state. it contains the current generation (8 bits),
+/// the number of slots handed out for it (24 bits) and the offset of the
+/// free space in its logfile (32 bits). slots are reserved by advancing the
+/// number and the offset with a compare-and-swap, so the slot numbers and
+/// the logfile memory of a generation are handed out in the same order
 ////////////////////////////////////////////////////////////////////////////////
 
-        Slot* const _slots;
+        std::atomic<uint64_t> _handoutState;
 
 ////////////////////////////////////////////////////////////////////////////////
-/// @brief the total number of slots
+/// @brief the generations. a generation is only overwritten when the
+/// generation number wraps around
 ////////////////////////////////////////////////////////////////////////////////
 
-        size_t const _numberOfSlots;
+        Generation _generations[256];
 
 ////////////////////////////////////////////////////////////////////////////////
-/// @brief the number of currently free slots
+/// @brief mutex serialising the switches to another logfile
 ////////////////////////////////////////////////////////////////////////////////
 
-        size_t _freeSlots;
+        basics::Mutex _rotateLock;
 
 ////////////////////////////////////////////////////////////////////////////////
-/// @brief whether or not someone is waiting for a slot
+/// @brief the number of the first slot of the next generation
+/// only accessed with the rotate lock held
 ////////////////////////////////////////////////////////////////////////////////
 
-        uint32_t _waiting;
+        uint64_t _nextSlot;
 
 ////////////////////////////////////////////////////////////////////////////////
-/// @brief the index of the slot to hand out next
+/// @brief the number of slots recycled so far. the slot with number n can be
+/// used once the slot with number n - _numberOfSlots has been recycled
 ////////////////////////////////////////////////////////////////////////////////
 
-        size_t _handoutIndex;
+        std::atomic<uint64_t> _recycled;
 
 ////////////////////////////////////////////////////////////////////////////////
-/// @brief the index of the slot to recycle
+/// @brief the number of slots that have taken their tick so far
 ////////////////////////////////////////////////////////////////////////////////
 
-        size_t _recycleIndex;
+        std::atomic<uint64_t> _ticked;
 
 ////////////////////////////////////////////////////////////////////////////////
-/// @brief the current logfile to write into
+/// @brief all slots
+////////////////////////////////////////////////////////////////////////////////
+
+        Slot* const _slots;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief the total number of slots
 ////////////////////////////////////////////////////////////////////////////////
 
-        Logfile* _logfile;
+        size_t const _numberOfSlots;
 
 ////////////////////////////////////////////////////////////////////////////////
-/// @brief last assigned tick value
+/// @brief the number of threads waiting for a slot
+/// protected by the condition variable
 ////////////////////////////////////////////////////////////////////////////////
 
-        Slot::TickType _lastAssignedTick;
+        uint32_t _waiting;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief the index of the slot to recycle
+/// only accessed by the synchroniser thread
+////////////////////////////////////////////////////////////////////////////////
+
+        size_t _recycleIndex;
 
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief last committed tick value
 ////////////////////////////////////////////////////////////////////////////////
 
-        Slot::TickType _lastCommittedTick;
+        std::atomic<Slot::TickType> _lastCommittedTick;
 
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief last committed data tick value
 ////////////////////////////////////////////////////////////////////////////////
 
-        Slot::TickType _lastCommittedDataTick;
+        std::atomic<Slot::TickType> _lastCommittedDataTick;
 
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief number of log events handled
 ////////////////////////////////////////////////////////////////////////////////
 
-        uint64_t _numEvents;
+        std::atomic<uint64_t> _numEvents;
 
     };
 
@@ -52,13 +52,20 @@ using namespace triagens::wal;
 ////////////////////////////////////////////////////////////////////////////////
 
 SynchroniserThread::SynchroniserThread (LogfileManager* logfileManager,
-                                        uint64_t syncInterval)
+                                        uint64_t syncInterval,
+                                        uint64_t groupCommitDelay,
+                                        uint32_t groupCommitSize)
   : Thread("WalSynchroniser"),
     _logfileManager(logfileManager),
     _condition(),
     _waiting(0),
+    _waitingWithSync(0),
+    _firstWaiting(0.0),
+    _firstWaitingWithSync(0.0),
     _stop(0),
     _syncInterval(syncInterval),
+    _groupCommitDelay(groupCommitDelay),
+    _groupCommitSize(groupCommitSize),
     _logfileCache({ 0, -1 }) {
 
   allowAsynchronousCancelation();
@@ -96,10 +103,23 @@ void SynchroniserThread::stop () {
 /// @brief signal that we need a sync
 ////////////////////////////////////////////////////////////////////////////////
 
-void SynchroniserThread::signalSync () {
+void SynchroniserThread::signalSync (bool waitForSync) {
   CONDITION_LOCKER(guard, _condition);
-  ++_waiting;
-  _condition.signal();
+
+  if (_waiting++ == 0) {
+    _firstWaiting = TRI_microtime();
+  }
+
+  if (waitForSync && _waitingWithSync++ == 0) {
+    _firstWaitingWithSync = TRI_microtime();
+  }
+
+  if (_groupCommitDelay == 0 ||
+      (waitForSync && (_waitingWithSync == 1 || _waitingWithSync >= _groupCommitSize))) {
+    // wake up the thread if it must sync right away, or if it must start
+    // waiting for the group commit delay of the first waiter
+    _condition.signal();
+  }
 }
 
 // -----------------------------------------------------------------------------
@@ -112,21 +132,17 @@ void SynchroniserThread::signalSync () {
 
 void SynchroniserThread::run () {
   uint64_t iterations = 0;
-  uint32_t waiting;
-    
-  {
-    // fetch initial value for waiting
-    CONDITION_LOCKER(guard, _condition);
-    waiting = _waiting;
-  }
-
-  // go on without the lock
+  uint32_t waiting = 0;
+  uint32_t waitingWithSync = 0;
+  bool sync = false;
 
   while (true) {
     int stop = (int) _stop;
+    bool synced = false;
 
-    if (waiting > 0 || ++iterations == 10) {
+    if (sync || ++iterations == 10) {
       iterations = 0;
+      synced = true;
 
       try {
         // sync as much as we can in this loop
@@ -151,22 +167,39 @@ void SynchroniserThread::run () {
     // now wait until we are woken up or there is something to do
     CONDITION_LOCKER(guard, _condition);
 
-    if (waiting > 0) {
+    if (synced && waiting > 0) {
+      // all requests signalled before the sync have been served by it
       TRI_ASSERT(_waiting >= waiting);
+      TRI_ASSERT(_waitingWithSync >= waitingWithSync);
       _waiting -= waiting;
+      _waitingWithSync -= waitingWithSync;
+
+      // requests signalled during the sync start a new batch
+      double const now = TRI_microtime();
+      _firstWaiting = now;
+      _firstWaitingWithSync = now;
     }
 
     // update value of waiting
     waiting = _waiting;
+    waitingWithSync = _waitingWithSync;
 
-    if (waiting == 0) {
+    uint64_t waitTime = _syncInterval;
+    sync = mustSync(waitTime);
+
+    if (stop > 0 && waiting > 0) {
+      // sync everything before exiting
+      sync = true;
+    }
+
+    if (! sync) {
       if (stop > 0) {
         // stop requested and all synced, we can exit
         break;
       }
 
-      // sleep if nothing to do
-      guard.wait(_syncInterval);
+      // sleep if nothing to do, or until the group commit is due
+      guard.wait(waitTime);
     }
 
     // next iteration
@@ -179,6 +212,50 @@ void SynchroniserThread::run () {
 // --SECTION--                                                   private methods
 // -----------------------------------------------------------------------------
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief determine whether the pending requests must be synced now
+/// without group commit, every pending request is synced right away. with
+/// group commit, requests with waiters are collected until either enough of
+/// them are pending or the oldest of them has waited for the group commit
+/// delay. requests without waiters are synced after the sync interval
+////////////////////////////////////////////////////////////////////////////////
+
+bool SynchroniserThread::mustSync (uint64_t& waitTime) const {
+  if (_waiting == 0) {
+    return false;
+  }
+
+  if (_groupCommitDelay == 0) {
+    return true;
+  }
+
+  double const now = TRI_microtime();
+
+  if (_waitingWithSync > 0) {
+    if (_waitingWithSync >= _groupCommitSize) {
+      return true;
+    }
+
+    uint64_t const elapsed = static_cast<uint64_t>((now - _firstWaitingWithSync) * 1000000.0);
+
+    if (elapsed >= _groupCommitDelay) {
+      return true;
+    }
+
+    waitTime = (std::min)(waitTime, _groupCommitDelay - elapsed);
+  }
+
+  uint64_t const elapsed = static_cast<uint64_t>((now - _firstWaiting) * 1000000.0);
+
+  if (elapsed >= _syncInterval) {
+    return true;
+  }
+
+  waitTime = (std::min)(waitTime, _syncInterval - elapsed);
+
+  return false;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief synchronise an unsynchronized region
 ////////////////////////////////////////////////////////////////////////////////
@@ -66,7 +66,9 @@ namespace triagens {
 ////////////////////////////////////////////////////////////////////////////////
 
         SynchroniserThread (LogfileManager*,
-                            uint64_t);
+                            uint64_t,
+                            uint64_t,
+                            uint32_t);
 
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief destroy the synchroniser thread
@@ -87,10 +89,11 @@ namespace triagens {
         void stop ();
 
 ////////////////////////////////////////////////////////////////////////////////
-/// @brief signal that a sync is needed
+/// @brief signal that a sync is needed. the flag indicates whether someone
+/// is waiting for the sync to complete
 ////////////////////////////////////////////////////////////////////////////////
 
-        void signalSync ();
+        void signalSync (bool);
 
 // -----------------------------------------------------------------------------
 // --SECTION--                                                    Thread methods
@@ -110,6 +113,14 @@ namespace triagens {
 
       private:
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief determine whether the pending requests must be synced now. if not,
+/// returns the maximum time to wait for more requests (in microseconds)
+/// must be called with the condition variable locked
+////////////////////////////////////////////////////////////////////////////////
+
+        bool mustSync (uint64_t&) const;
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief synchronise an unsynchronized region
 ////////////////////////////////////////////////////////////////////////////////
@@ -146,6 +157,24 @@ namespace triagens {
 
         uint32_t _waiting;
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief number of requests waiting for which someone waits for the sync
+////////////////////////////////////////////////////////////////////////////////
+
+        uint32_t _waitingWithSync;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief time the oldest pending request was signalled
+////////////////////////////////////////////////////////////////////////////////
+
+        double _firstWaiting;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief time the oldest pending request with a waiter was signalled
+////////////////////////////////////////////////////////////////////////////////
+
+        double _firstWaitingWithSync;
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief stop flag
 ////////////////////////////////////////////////////////////////////////////////
@@ -158,6 +187,20 @@ namespace triagens {
 
         uint64_t const _syncInterval;
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief maximum time a waiting request is delayed to be synced together
+/// with other requests (in microseconds). 0 means group commit is turned off
+/// and each request is synced as soon as possible
+////////////////////////////////////////////////////////////////////////////////
+
+        uint64_t const _groupCommitDelay;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief number of waiting requests that trigger a group commit right away
+////////////////////////////////////////////////////////////////////////////////
+
+        uint32_t const _groupCommitSize;
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief logfile descriptor cache
 ////////////////////////////////////////////////////////////////////////////////
@@ -41,6 +41,8 @@ static bool CreateDocument (SimpleHttpClient*, const std::string&, const std::st
 
 static bool CreateIndex (SimpleHttpClient*, const std::string&, const std::string&, const std::string&);
 
+static bool ExecuteQuery (SimpleHttpClient*, const std::string&);
+
 // -----------------------------------------------------------------------------
 // --SECTION--                                              benchmark test cases
 // -----------------------------------------------------------------------------
@@ -1503,6 +1505,148 @@ struct AqlInsertTest : public BenchmarkOperation {
   }
 };
 
+// -----------------------------------------------------------------------------
+// --SECTION--                                                     AQL scan test
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief full scans of several collections
+///
+/// each request scans one of the collections completely. this can be used to
+/// compare the scan throughput with and without NUMA-aware allocation
+/// (--server.numa-aware-allocation) and thread placement
+/// (--use-thread-affinity 5). the complexity is the number of documents per
+/// collection in thousands
+////////////////////////////////////////////////////////////////////////////////
+
+struct AqlScanTest : public BenchmarkOperation {
+  AqlScanTest ()
+    : BenchmarkOperation () {
+  }
+
+  ~AqlScanTest () {
+  }
+
+  bool setUp (SimpleHttpClient* client) {
+    for (size_t i = 1; i <= NumberCollections; ++i) {
+      std::string const name = Collection + StringUtils::itoa(static_cast<uint64_t>(i));
+
+      if (! DeleteCollection(client, name) ||
+          ! CreateCollection(client, name, 2)) {
+        return false;
+      }
+
+      std::string const query = "FOR i IN 1.." + StringUtils::itoa(Complexity * 1000) +
+                                " INSERT { value: i } INTO " + name;
+
+      if (! ExecuteQuery(client, query)) {
+        return false;
+      }
+    }
+
+    return true;
+  }
+
+  void tearDown () {
+  }
+
+  std::string url (const int threadNumber, const size_t threadCounter, const size_t globalCounter) {
+    return std::string("/_api/cursor");
+  }
+
+  HttpRequest::HttpRequestType type (const int threadNumber, const size_t threadCounter, const size_t globalCounter) {
+    return HttpRequest::HTTP_REQUEST_POST;
+  }
+
+  const char* payload (size_t* length, const int threadNumber, const size_t threadCounter, const size_t globalCounter, bool* mustFree) {
+    TRI_string_buffer_t* buffer;
+    buffer = TRI_CreateSizedStringBuffer(TRI_UNKNOWN_MEM_ZONE, 256);
+
+    // the filter never matches, so the collection is scanned completely
+    TRI_AppendStringStringBuffer(buffer, "{\"query\":\"FOR d IN ");
+    TRI_AppendStringStringBuffer(buffer, Collection.c_str());
+    TRI_AppendUInt64StringBuffer(buffer, (uint64_t) (globalCounter % NumberCollections) + 1);
+    TRI_AppendStringStringBuffer(buffer, " FILTER d.value == -1 RETURN d\"}");
+
+    *length = TRI_LengthStringBuffer(buffer);
+    *mustFree = true;
+    char* ptr = TRI_StealStringBuffer(buffer);
+    TRI_FreeStringBuffer(TRI_UNKNOWN_MEM_ZONE, buffer);
+
+    return (const char*) ptr;
+  }
+
+  static size_t const NumberCollections;
+};
+
+size_t const AqlScanTest::NumberCollections = 4;
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                    WAL write test
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief concurrent small writes into several collections
+///
+/// the documents are tiny, so the time is mostly spent handing out slots in
+/// the write-ahead log and rotating its logfiles. use a high concurrency and
+/// a small --wal.logfile-size to measure the slot handout
+////////////////////////////////////////////////////////////////////////////////
+
+struct WalWriteTest : public BenchmarkOperation {
+  WalWriteTest ()
+    : BenchmarkOperation () {
+  }
+
+  ~WalWriteTest () {
+  }
+
+  bool setUp (SimpleHttpClient* client) {
+    for (size_t i = 1; i <= NumberCollections; ++i) {
+      std::string const name = Collection + StringUtils::itoa(static_cast<uint64_t>(i));
+
+      if (! DeleteCollection(client, name) ||
+          ! CreateCollection(client, name, 2)) {
+        return false;
+      }
+    }
+
+    return true;
+  }
+
+  void tearDown () {
+  }
+
+  std::string url (const int threadNumber, const size_t threadCounter, const size_t globalCounter) {
+    return std::string("/_api/document?collection=") + Collection +
+           StringUtils::itoa(static_cast<uint64_t>(globalCounter % NumberCollections) + 1);
+  }
+
+  HttpRequest::HttpRequestType type (const int threadNumber, const size_t threadCounter, const size_t globalCounter) {
+    return HttpRequest::HTTP_REQUEST_POST;
+  }
+
+  const char* payload (size_t* length, const int threadNumber, const size_t threadCounter, const size_t globalCounter, bool* mustFree) {
+    TRI_string_buffer_t* buffer;
+    buffer = TRI_CreateSizedStringBuffer(TRI_UNKNOWN_MEM_ZONE, 64);
+
+    TRI_AppendStringStringBuffer(buffer, "{\"value\":");
+    TRI_AppendUInt64StringBuffer(buffer, (uint64_t) globalCounter);
+    TRI_AppendCharStringBuffer(buffer, '}');
+
+    *length = TRI_LengthStringBuffer(buffer);
+    *mustFree = true;
+    char* ptr = TRI_StealStringBuffer(buffer);
+    TRI_FreeStringBuffer(TRI_UNKNOWN_MEM_ZONE, buffer);
+
+    return (const char*) ptr;
+  }
+
+  static size_t const NumberCollections;
+};
+
+size_t const WalWriteTest::NumberCollections = 16;
+
 // -----------------------------------------------------------------------------
 // --SECTION--                                                 private functions
 // -----------------------------------------------------------------------------
@@ -1627,6 +1771,37 @@ static bool CreateDocument (SimpleHttpClient* client,
   return ! failed;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief execute an AQL query
+////////////////////////////////////////////////////////////////////////////////
+
+static bool ExecuteQuery (SimpleHttpClient* client,
+                          const std::string& query) {
+  std::map<std::string, std::string> headerFields;
+  SimpleHttpResult* result = nullptr;
+
+  // the query must not contain characters that need escaping
+  std::string const payload = "{\"query\":\"" + query + "\"}";
+
+  result = client->request(HttpRequest::HTTP_REQUEST_POST,
+                           "/_api/cursor",
+                           payload.c_str(),
+                           payload.size(),
+                           headerFields);
+
+  bool failed = true;
+
+  if (result != nullptr) {
+    if (result->getHttpReturnCode() == 201) {
+      failed = false;
+    }
+
+    delete result;
+  }
+
+  return ! failed;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief return the test case for a name
 ////////////////////////////////////////////////////////////////////////////////
@@ -1686,6 +1861,12 @@ static BenchmarkOperation* GetTestCase (const std::string& name) {
   if (name == "aqlinsert") {
     return new AqlInsertTest();
   }
+  if (name == "aqlscan") {
+    return new AqlScanTest();
+  }
+  if (name == "wal") {
+    return new WalWriteTest();
+  }
 
   return nullptr;
 }
@@ -70,6 +70,7 @@ function collectionRepresentation (collection, showProperties, showCount, showFi
     result.keyOptions    = properties.keyOptions;
     result.waitForSync   = properties.waitForSync;
     result.indexBuckets  = properties.indexBuckets;
+    result.compressDocuments = properties.compressDocuments;
 
     if (cluster.isCoordinator()) {
       result.shardKeys = properties.shardKeys;
@@ -141,6 +142,10 @@ function parseBodyForCreateCollection (req, res) {
     r.parameter.indexBuckets = body.indexBuckets;
   }
 
+  if (body.hasOwnProperty("compressDocuments")) {
+    r.parameter.compressDocuments = body.compressDocuments;
+  }
+
   if (body.hasOwnProperty("keyOptions")) {
     r.parameter.keyOptions = body.keyOptions;
   }
@@ -239,11 +244,17 @@ function parseBodyForCreateCollection (req, res) {
 ///   when the hash table has to be initially built or resized, since buckets 
 ///   are resized individually and can be initially built in parallel. For 
 ///   example, 64 might be a sensible value for a collection with 100
-///   000 000 documents. Currently, only the edge index respects this
-///   value, but other index types might follow in future ArangoDB versions. 
+///   000 000 documents. Currently, only the primary index and the edge index
+///   respect this value, but other index types might follow in future
+///   ArangoDB versions. 
 ///   Changes (see below) are applied when the collection is loaded the next 
 ///   time.
 ///
+/// - *compressDocuments* (optional, default is *false*): if *true*, the
+///   bodies of documents are stored compressed in the collection's datafiles.
+///   This reduces disk usage and I/O for collections with large and repetitive
+///   documents at the cost of some CPU time when documents are read.
+///
 /// - *numberOfShards* (optional, default is *1*): in a cluster, this value
 ///   determines the number of shards to create for the collection. In a single
 ///   server setup, this option is meaningless.
@@ -691,6 +702,18 @@ function get_api_collections (req, res) {
 ///   log for this collection that have not been transferred to journals or
 ///   datafiles.
 ///
+/// * *figures.compression.count*: The number of documents that were stored
+///   compressed since the collection was loaded.
+///
+/// * *figures.compression.uncompressedSize*: The total size of these
+///   documents' bodies before compression, in bytes.
+///
+/// * *figures.compression.compressedSize*: The total size of these
+///   documents' bodies after compression, in bytes.
+///
+/// * *figures.compression.time*: The CPU time spent on compressing documents,
+///   in seconds.
+///
 /// - *journalSize*: The maximal size of a journal or datafile in bytes.
 ///
 /// **Note**: collection data that are stored in the write-ahead log only are
@@ -1245,6 +1268,10 @@ function put_api_collection_truncate (req, res, collection) {
 ///   additional journals or datafiles that are created. Already
 ///   existing journals or datafiles will not be affected.
 ///
+/// - *compressDocuments*: If *true* then the bodies of documents will be
+///   stored compressed in the collection's datafiles. Changing this value only
+///   affects documents that are transferred into datafiles afterwards.
+///
 /// On success an object with the following attributes is returned:
 ///
 /// - *id*: The identifier of the collection.
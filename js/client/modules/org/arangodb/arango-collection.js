@@ -334,7 +334,8 @@ ArangoCollection.prototype.properties = function (properties) {
     "shardKeys": false,
     "numberOfShards": false,
     "keyOptions": false,
-    "indexBuckets": true
+    "indexBuckets": true,
+    "compressDocuments": true
   };
   var a;
 
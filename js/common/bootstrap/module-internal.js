@@ -220,6 +220,17 @@ if (global.REQUEST_TIME_DISTRIBUTION) {
   delete global.REQUEST_TIME_DISTRIBUTION;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief walSyncTimeDistribution
+////////////////////////////////////////////////////////////////////////////////
+
+exports.walSyncTimeDistribution = [];
+
+if (global.WAL_SYNC_TIME_DISTRIBUTION) {
+  exports.walSyncTimeDistribution = global.WAL_SYNC_TIME_DISTRIBUTION;
+  delete global.WAL_SYNC_TIME_DISTRIBUTION;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief startupPath
 ////////////////////////////////////////////////////////////////////////////////
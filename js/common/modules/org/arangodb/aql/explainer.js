@@ -482,6 +482,15 @@ function processQuery (query, explain) {
         return keyword("FOR") + " " + variableName(node.outVariable) + " " + keyword("IN") + " " + collection(node.collection) + "   " + annotation("/* full collection scan" + (node.random ? ", random order" : "") + " */");
       case "EnumerateListNode":
         return keyword("FOR") + " " + variableName(node.outVariable) + " " + keyword("IN") + " " + variableName(node.inVariable) + "   " + annotation("/* list iteration */");
+      case "TraversalNode":
+        return keyword("FOR") + " " + variableName(node.outVariable) + " " + keyword("IN") + " " + func("NEIGHBORS") + "(" + collection(node.vertexCollection) + ", " + collection(node.edgeCollection) + ", " + variableName(node.inVariable) + ", " + value(JSON.stringify(node.direction)) + ")   " + annotation("/* traversal, depth " + node.minDepth + ".." + node.maxDepth + (node.edgeExamples !== null ? ", edge examples" : "") + " */");
+      case "ShortestPathNode":
+        return keyword("FOR") + " " + variableName(node.outVariable) + " " + keyword("IN") + " " + func("SHORTEST_PATH") + "(" + collection(node.vertexCollection) + ", " + collection(node.edgeCollection) + ", " + variableName(node.startVariable) + ", " + variableName(node.targetVariable) + ", " + value(JSON.stringify(node.direction)) + ")." + attribute(node.produceEdges ? "edges" : "vertices") + "   " + annotation("/* shortest path */");
+      case "HashJoinNode":
+        collectionVariables[node.outVariable.id] = node.collection;
+        return keyword("FOR") + " " + variableName(node.outVariable) + " " + keyword("IN") + " " + collection(node.collection) + "   " + annotation("/* hash join on ") + node.keys.map(function(key) {
+          return variableName(node.outVariable) + "." + key.attribute.map(attribute).join(".") + " == " + variableName(key.probeVariable);
+        }).join(" && ") + "   " + annotation("*/");
       case "IndexRangeNode":
         collectionVariables[node.outVariable.id] = node.collection;
         var index = node.index;
@@ -505,7 +514,8 @@ function processQuery (query, explain) {
       case "SortNode":
         return keyword("SORT") + " " + node.elements.map(function(node) {
           return variableName(node.inVariable) + " " + keyword(node.ascending ? "ASC" : "DESC"); 
-        }).join(", ");
+        }).join(", ") + 
+                 (node.limit > 0 ? "   " + annotation("/* top " + node.limit + " */") : "");
       case "LimitNode":
         return keyword("LIMIT") + " " + value(JSON.stringify(node.offset)) + ", " + value(JSON.stringify(node.limit)); 
       case "ReturnNode":
@@ -540,6 +550,9 @@ function processQuery (query, explain) {
       case "ScatterNode":
         return keyword("SCATTER");
       case "GatherNode":
+        if (node.parallelism > 0) {
+          return keyword("GATHER") + "   " + annotation("/* " + node.parallelism + " parallel scans */");
+        }
         return keyword("GATHER");
     }
 
@@ -562,6 +575,9 @@ function processQuery (query, explain) {
   var postHandle = function (node) {
     if ([ "EnumerateCollectionNode",
           "EnumerateListNode",
+          "TraversalNode",
+          "ShortestPathNode",
+          "HashJoinNode",
           "IndexRangeNode",
           "SubqueryNode" ].indexOf(node.type) !== -1) {
       level++;
@@ -884,6 +884,37 @@ function CollectionSuite () {
       db._drop(cn);
     },
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test first and last after updates
+////////////////////////////////////////////////////////////////////////////////
+
+    testFirstLastUpdated : function () {
+      var cn = "example";
+
+      db._drop(cn);
+      var c1 = db._create(cn);
+
+      for (var i = 0; i < 10; ++i) {
+        c1.save({ "a" : i, "_key" : "test" + i });
+      }
+
+      c1.update("test0", { "a" : 10 });
+      assertEqual("test1", c1.first()._key);
+      assertEqual("test0", c1.last()._key);
+
+      c1.replace("test5", { "a" : 11 });
+      assertEqual("test5", c1.last()._key);
+
+      var actual = c1.last(2);
+      assertEqual("test5", actual[0]._key);
+      assertEqual("test0", actual[1]._key);
+
+      c1.remove("test1");
+      assertEqual("test2", c1.first()._key);
+
+      db._drop(cn);
+    },
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief test last
 ////////////////////////////////////////////////////////////////////////////////
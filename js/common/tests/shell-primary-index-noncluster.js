@@ -0,0 +1,217 @@
+/*jshint globalstrict:false, strict:false */
+/*global assertEqual, assertTrue, assertFalse, assertNull */
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test the primary index
+///
+/// @file
+///
+/// DISCLAIMER
+///
+/// Copyright 2010-2012 triagens GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is triAGENS GmbH, Cologne, Germany
+///
+/// @author Copyright 2015, triAGENS GmbH, Cologne, Germany
+////////////////////////////////////////////////////////////////////////////////
+
+var jsunity = require("jsunity");
+var arangodb = require("org/arangodb");
+var db = arangodb.db;
+var internal = require("internal");
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test suite: buckets
+////////////////////////////////////////////////////////////////////////////////
+
+function PrimaryIndexBucketsSuite () {
+  var cn1 = "UnitTestsCollection1";
+  var cn2 = "UnitTestsCollection2";
+  var cn3 = "UnitTestsCollection3";
+  var collections = [ ];
+
+  var keys = function (collection) {
+    return collection.toArray().map(function(doc) { return doc._key; }).sort();
+  };
+
+  return {
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief set up
+////////////////////////////////////////////////////////////////////////////////
+
+    setUp : function () {
+      db._drop(cn1);
+      db._drop(cn2);
+      db._drop(cn3);
+      collections = [
+        db._create(cn1, { indexBuckets: 1 }),
+        db._create(cn2, { indexBuckets: 16 }),
+        db._create(cn3, { indexBuckets: 128 })
+      ];
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief tear down
+////////////////////////////////////////////////////////////////////////////////
+
+    tearDown : function () {
+      collections.forEach(function(c) {
+        c.drop();
+      });
+      collections = [ ];
+      internal.wait(0.0);
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief compare lookups with different buckets
+////////////////////////////////////////////////////////////////////////////////
+
+    testLookupBuckets : function () {
+      var i, n = 5000;
+
+      collections.forEach(function(c) {
+        for (i = 0; i < n; ++i) {
+          c.save({ _key: "test" + i, value: i });
+        }
+
+        assertEqual(n, c.count());
+
+        for (i = 0; i < n; ++i) {
+          assertEqual(i, c.document("test" + i).value);
+        }
+
+        assertFalse(c.exists("test" + n));
+      });
+
+      assertEqual(keys(collections[0]), keys(collections[1]));
+      assertEqual(keys(collections[0]), keys(collections[2]));
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief compare removals with different buckets
+////////////////////////////////////////////////////////////////////////////////
+
+    testRemoveBuckets : function () {
+      var i, n = 2000;
+
+      collections.forEach(function(c) {
+        for (i = 0; i < n; ++i) {
+          c.save({ _key: "test" + i });
+        }
+
+        for (i = 0; i < n; i += 2) {
+          c.remove("test" + i);
+        }
+
+        assertEqual(n / 2, c.count());
+
+        for (i = 0; i < n; ++i) {
+          assertEqual(i % 2 === 1, c.exists("test" + i));
+        }
+
+        for (i = 1; i < n; i += 2) {
+          c.remove("test" + i);
+        }
+
+        assertEqual(0, c.count());
+        assertNull(c.any());
+        assertEqual([ ], c.toArray());
+      });
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief compare skip and limit with different buckets
+////////////////////////////////////////////////////////////////////////////////
+
+    testSkipLimitBuckets : function () {
+      var i, n = 1000;
+
+      collections.forEach(function(c) {
+        for (i = 0; i < n; ++i) {
+          c.save({ _key: "test" + i });
+        }
+
+        var all = c.all().toArray().map(function(doc) { return doc._key; });
+        assertEqual(n, all.length);
+
+        assertEqual(all.slice(10, 30), c.all().skip(10).limit(20).toArray().map(function(doc) { return doc._key; }));
+        assertEqual(all.slice(n - 10), c.all().skip(n - 10).toArray().map(function(doc) { return doc._key; }));
+        assertEqual([ ], c.all().skip(n).toArray());
+
+        assertTrue(c.exists(c.any()._key));
+      });
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief reload collections with different buckets
+////////////////////////////////////////////////////////////////////////////////
+
+    testReloadBuckets : function () {
+      var i, n = 5000;
+
+      collections.forEach(function(c) {
+        for (i = 0; i < n; ++i) {
+          c.save({ _key: "test" + i, value: i });
+        }
+        for (i = 0; i < n; i += 5) {
+          c.remove("test" + i);
+        }
+        for (i = 1; i < n; i += 5) {
+          c.update("test" + i, { value: -i });
+        }
+
+        internal.wal.flush(true, true);
+        c.unload();
+        internal.wait(2);
+      });
+
+      collections = [ db._collection(cn1), db._collection(cn2), db._collection(cn3) ];
+
+      collections.forEach(function(c) {
+        assertEqual(n - n / 5, c.count());
+
+        for (i = 0; i < n; ++i) {
+          if (i % 5 === 0) {
+            assertFalse(c.exists("test" + i));
+          }
+          else if (i % 5 === 1) {
+            assertEqual(-i, c.document("test" + i).value);
+          }
+          else {
+            assertEqual(i, c.document("test" + i).value);
+          }
+        }
+      });
+
+      assertEqual(keys(collections[0]), keys(collections[1]));
+      assertEqual(keys(collections[0]), keys(collections[2]));
+    }
+
+  };
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief executes the test suites
+////////////////////////////////////////////////////////////////////////////////
+
+jsunity.run(PrimaryIndexBucketsSuite);
+
+return jsunity.done();
+
+// Local Variables:
+// mode: outline-minor
+// outline-regexp: "^\\(/// @brief\\|/// @addtogroup\\|// --SECTION--\\|/// @page\\|/// @}\\)"
+// End:
@@ -1869,7 +1869,7 @@ function resultCursor (req, res, cursor, code, options) {
     count = cursor.json.length;
     rows = cursor.json;
     extra = { };
-    [ "stats", "warnings", "profile" ].forEach(function(d) {
+    [ "stats", "warnings", "profile", "plan" ].forEach(function(d) {
       if (cursor.hasOwnProperty(d)) {
         extra[d] = cursor[d];
       }
@@ -1,6 +1,6 @@
 /*jshint strict: false, unused: false, bitwise: false, esnext: true */
 /*global COMPARE_STRING, AQL_TO_BOOL, AQL_TO_NUMBER, AQL_TO_STRING, AQL_WARNING, AQL_QUERY_SLEEP */
-/*global CPP_SHORTEST_PATH, CPP_NEIGHBORS, Set */
+/*global CPP_SHORTEST_PATH, CPP_NEIGHBORS, CPP_GRAPH_CENTRALITY, Set */
 
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief Ahuacatl, internal query functions
@@ -7544,6 +7544,69 @@ function RUN_DIJKSTRA_WITH_RESULT_HANDLE (func, graphName, options, result, afte
   return result;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief computes the absolute closeness, eccentricity or betweenness of
+/// a graph's vertices in C++. the sources of the shortest path searches are
+/// distributed over multiple threads. returns undefined if the options are
+/// not supported by the C++ implementation
+////////////////////////////////////////////////////////////////////////////////
+
+function RUN_GRAPH_CENTRALITY (measure, graphName, vertexExample, options) {
+  'use strict';
+
+  if (isCoordinator) {
+    return undefined;
+  }
+
+  var supported = [ "direction", "algorithm", "weight", "defaultWeight", "samples", "threads" ];
+  var unsupported = Object.keys(options).filter(function (key) {
+    return supported.indexOf(key) === -1;
+  });
+  if (unsupported.length > 0) {
+    return undefined;
+  }
+
+  var params = { direction: options.direction };
+  [ "weight", "defaultWeight", "samples", "threads" ].forEach(function (key) {
+    if (options.hasOwnProperty(key)) {
+      params[key] = options[key];
+    }
+  });
+
+  let graph = graphModule._graph(graphName);
+  let vertexCollections = graph._vertexCollections().map(function (c) { return c.name();});
+  let edgeCollections = graph._edgeCollections().map(function (c) { return c.name();});
+
+  if (vertexExample !== undefined && vertexExample !== null &&
+      (typeof vertexExample !== "object" || Array.isArray(vertexExample) ||
+       Object.keys(vertexExample).length > 0)) {
+    params.sources = DOCUMENT_IDS_BY_EXAMPLE(vertexCollections, vertexExample);
+  }
+
+  return CPP_GRAPH_CENTRALITY(vertexCollections, edgeCollections, measure, params);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief divides all values by the maximum value
+////////////////////////////////////////////////////////////////////////////////
+
+function NORMALIZE_GRAPH_CENTRALITY (result) {
+  'use strict';
+
+  var max = 0;
+  Object.keys(result).forEach(function (r) {
+    if (result[r] > max) {
+      max = result[r];
+    }
+  });
+  if (max === 0) {
+    return result;
+  }
+  Object.keys(result).forEach(function (r) {
+    result[r] /= max;
+  });
+  return result;
+}
 
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief visitor callback function for absolute eccentricity traversal
@@ -7643,6 +7706,12 @@ function AQL_GRAPH_ABSOLUTE_ECCENTRICITY (graphName, vertexExample, options) {
   if (! options.algorithm) {
     options.algorithm = "dijkstra";
   }
+
+  var centrality = RUN_GRAPH_CENTRALITY("eccentricity", graphName, vertexExample, options);
+  if (centrality !== undefined) {
+    return centrality;
+  }
+
   options.fromVertexExample = vertexExample;
   options.toVertexExample = {};
 
@@ -7730,6 +7799,15 @@ function AQL_GRAPH_ECCENTRICITY (graphName, options) {
   if (! options.algorithm) {
     options.algorithm = "dijkstra";
   }
+
+  var centrality = RUN_GRAPH_CENTRALITY("eccentricity", graphName, {}, options);
+  if (centrality !== undefined) {
+    Object.keys(centrality).forEach(function (r) {
+      centrality[r] = centrality[r] === 0 ? 0 : 1 / centrality[r];
+    });
+    return NORMALIZE_GRAPH_CENTRALITY(centrality);
+  }
+
   options.fromVertexExample = {};
   options.toVertexExample = {};
   options.visitor = TRAVERSAL_ECCENTRICITY_VISITOR;
@@ -7908,6 +7986,12 @@ function AQL_GRAPH_ABSOLUTE_CLOSENESS (graphName, vertexExample, options) {
   if (! options.algorithm) {
     options.algorithm = "dijkstra";
   }
+
+  var centrality = RUN_GRAPH_CENTRALITY("closeness", graphName, vertexExample, options);
+  if (centrality !== undefined) {
+    return centrality;
+  }
+
   options.fromVertexExample = vertexExample;
   options.toVertexExample = {};
 
@@ -8006,6 +8090,15 @@ function AQL_GRAPH_CLOSENESS (graphName, options) {
   if (! options.algorithm) {
     options.algorithm = "dijkstra";
   }
+
+  var centrality = RUN_GRAPH_CENTRALITY("closeness", graphName, {}, options);
+  if (centrality !== undefined) {
+    Object.keys(centrality).forEach(function (r) {
+      centrality[r] = centrality[r] === 0 ? 0 : 1 / centrality[r];
+    });
+    return NORMALIZE_GRAPH_CENTRALITY(centrality);
+  }
+
   options.fromVertexExample = {};
   options.toVertexExample = {};
   options.visitor = TRAVERSAL_CLOSENESS_VISITOR;
@@ -8061,6 +8154,12 @@ function AQL_GRAPH_CLOSENESS (graphName, options) {
 /// is used as length.
 /// If no default is supplied the default would be positive Infinity so the path and
 /// hence the betweenness can not be calculated.
+///   * *samples*                          : If set to a number smaller than the number
+/// of vertices, only this many randomly chosen vertices are used as start vertices of
+/// the shortest paths and the result is extrapolated. This gives an approximate
+/// betweenness at a fraction of the cost.
+///   * *threads*                          : The number of threads used for the computation.
+/// Defaults to the number of available processors.
 ///
 /// @EXAMPLES
 ///
@@ -8106,6 +8205,12 @@ function AQL_GRAPH_ABSOLUTE_BETWEENNESS (graphName, options) {
   if (! options.direction) {
     options.direction =  'any';
   }
+
+  var centrality = RUN_GRAPH_CENTRALITY("betweenness", graphName, {}, options);
+  if (centrality !== undefined) {
+    return centrality;
+  }
+
   options.algorithm = "Floyd-Warshall";
 
   // Make sure we ONLY extract _ids
@@ -8158,6 +8263,12 @@ function AQL_GRAPH_ABSOLUTE_BETWEENNESS (graphName, options) {
 /// is used as length.
 /// If no default is supplied the default would be positive Infinity so the path and
 /// hence the eccentricity can not be calculated.
+///   * *samples*                          : If set to a number smaller than the number
+/// of vertices, only this many randomly chosen vertices are used as start vertices of
+/// the shortest paths and the result is extrapolated. This gives an approximate
+/// betweenness at a fraction of the cost.
+///   * *threads*                          : The number of threads used for the computation.
+/// Defaults to the number of available processors.
 ///
 /// @EXAMPLES
 ///
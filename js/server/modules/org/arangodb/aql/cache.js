@@ -1,4 +1,5 @@
-/*global AQL_QUERY_CACHE_PROPERTIES, AQL_QUERY_CACHE_INVALIDATE */
+/*global AQL_QUERY_CACHE_PROPERTIES, AQL_QUERY_CACHE_INVALIDATE,
+  AQL_PLAN_CACHE_PROPERTIES, AQL_PLAN_CACHE_INVALIDATE */
 
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief AQL query cache management
@@ -54,6 +55,30 @@ exports.properties = function (properties) {
   return AQL_QUERY_CACHE_PROPERTIES();
 };
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief invalidates the plan cache
+////////////////////////////////////////////////////////////////////////////////
+
+exports.clearPlanCache = function () {
+  'use strict';
+
+  AQL_PLAN_CACHE_INVALIDATE();
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief fetches or sets the properties of the plan cache, and returns its
+/// hit statistics
+////////////////////////////////////////////////////////////////////////////////
+
+exports.planCacheProperties = function (properties) {
+  'use strict';
+ 
+  if (properties !== undefined) {
+    return AQL_PLAN_CACHE_PROPERTIES(properties);
+  }
+  return AQL_PLAN_CACHE_PROPERTIES();
+};
+
 // -----------------------------------------------------------------------------
 // --SECTION--                                                       END-OF-FILE
 // -----------------------------------------------------------------------------
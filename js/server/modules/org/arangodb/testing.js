@@ -144,6 +144,7 @@ var allTests =
     "boost",
     "shell_server",
     "shell_server_aql",
+    "shell_server_index_snapshots",
     "http_server",
     "ssl_server",
     "shell_client",
@@ -995,10 +996,10 @@ function runArangoshCmd (options, instanceInfo, addArgs, cmds) {
   return executeAndWait(arangosh, argv);
 }
 
-function performTests(options, testList, testname, remote) {
+function performTests(options, testList, testname, remote, serverArgs) {
   var instanceInfo;
   if (remote) {
-    instanceInfo = startInstance("tcp", options, [], testname);
+    instanceInfo = startInstance("tcp", options, serverArgs || [], testname);
     if (instanceInfo === false) {
       return {status: false, message: "failed to start server!"};
     }
@@ -1184,6 +1185,15 @@ testFuncs.shell_server = function (options) {
   return performTests(options, tests_shell_server, 'shell_server', true);
 };
 
+testFuncs.shell_server_index_snapshots = function (options) {
+  return performTests(options,
+                      [ fs.join(makePathUnix("js/server/tests"),
+                                "shell-index-snapshots-noncluster.js") ],
+                      'shell_server_index_snapshots',
+                      true,
+                      {"database.index-snapshots": "true"});
+};
+
 testFuncs.shell_server_only = function (options) {
   findTests();
   return performTests(options,
@@ -0,0 +1,180 @@
+/*global require */
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief performance tests for NUMA-aware placement of collection memory
+///
+/// @file
+///
+/// compare the results of a server started with
+/// `--server.numa-aware-allocation true --use-thread-affinity 5` with those
+/// of a server started without these options. the readers look up documents
+/// by key and scan their collections from concurrent tasks, so most of the
+/// time is spent in the primary index and the document headers
+///
+/// DISCLAIMER
+///
+/// Copyright 2010-2012 triagens GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is triAGENS GmbH, Cologne, Germany
+///
+/// @author Copyright 2015, triAGENS GmbH, Cologne, Germany
+////////////////////////////////////////////////////////////////////////////////
+
+var loadTestRunner = require("loadtestrunner");
+var internal = require("internal");
+var tasks = require("org/arangodb/tasks");
+var db = internal.db;
+
+// each reader uses its own collection, so the collections are distributed
+// over the NUMA nodes
+var colName = "perf_numa";
+var doneName = colName + "_done";
+var runs = 0;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief set up
+////////////////////////////////////////////////////////////////////////////////
+
+var setUp = function (options) {
+  var i, j;
+
+  for (i = 0; i < options.maxReaders; ++i) {
+    db._drop(colName + i);
+    var c = db._create(colName + i);
+
+    for (j = 0; j < options.documents; ++j) {
+      c.save({ _key: "test" + j, value: j });
+    }
+  }
+
+  db._drop(doneName);
+  db._create(doneName);
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief tear down
+////////////////////////////////////////////////////////////////////////////////
+
+var tearDown = function (options) {
+  var i;
+
+  for (i = 0; i < options.maxReaders; ++i) {
+    db._drop(colName + i);
+  }
+
+  db._drop(doneName);
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief start the readers as tasks and wait until all of them are done
+////////////////////////////////////////////////////////////////////////////////
+
+var runReaders = function (readers, command, options) {
+  var i;
+
+  db._collection(doneName).truncate();
+  ++runs;
+
+  for (i = 0; i < readers; ++i) {
+    tasks.register({
+      id: colName + "_reader" + runs + "_" + i,
+      offset: 0,
+      params: { cn: colName + i, done: doneName, n: options.documents, loops: options.loops },
+      command: command
+    });
+  }
+
+  while (db._collection(doneName).count() < readers) {
+    internal.wait(0.01, false);
+  }
+
+  return { };
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief look up all documents of the collection by key
+////////////////////////////////////////////////////////////////////////////////
+
+var lookup = function (params) {
+  var db = require("internal").db;
+  var c = db._collection(params.cn);
+  var i, j;
+
+  for (i = 0; i < params.loops; ++i) {
+    for (j = 0; j < params.n; ++j) {
+      c.document("test" + j);
+    }
+  }
+
+  db._collection(params.done).save({ });
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief scan the collection with AQL
+////////////////////////////////////////////////////////////////////////////////
+
+var scan = function (params) {
+  var db = require("internal").db;
+  var i;
+
+  for (i = 0; i < params.loops; ++i) {
+    db._query("FOR doc IN @@cn FILTER doc.value < 0 RETURN doc", { "@cn": params.cn }).toArray();
+  }
+
+  db._collection(params.done).save({ });
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Testcases: read from a varying number of concurrent readers
+////////////////////////////////////////////////////////////////////////////////
+
+var makeTest = function (readers, command) {
+  return function (testParams, testMethodStr, testMethod, options) {
+    return runReaders(readers, command, options);
+  };
+};
+
+var testMethods = {
+  tasks: { }
+};
+
+var testSuite = [
+  { name: "setup",     setUp: setUp, teardown: null, params: null, func: null },
+
+  { name: "lookup-1",  func: makeTest(1, lookup) },
+  { name: "lookup-8",  func: makeTest(8, lookup) },
+  { name: "lookup-32", func: makeTest(32, lookup) },
+  { name: "scan-1",    func: makeTest(1, scan) },
+  { name: "scan-8",    func: makeTest(8, scan) },
+  { name: "scan-32",   func: makeTest(32, scan) },
+
+  { name: "teardown",  setUp: null, tearDown: tearDown, params: null, func: null }
+];
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief execute suite. note that the number of concurrent readers is
+/// bounded by the number of server threads and V8 contexts
+////////////////////////////////////////////////////////////////////////////////
+
+var testOptions = {
+  maxReaders: 32,
+  documents: 20000,
+  loops: 5,
+  runs: 5,   // number of runs for each test Has to be at least 3, else calculations will fail.
+  strip: 1,  // how many min/max extreme values to ignore
+  digits: 4  // result display digits
+};
+
+loadTestRunner.loadTestRunner(testSuite, testOptions, testMethods);
@@ -0,0 +1,144 @@
+/*global require */
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief performance tests for concurrent WAL slot handout
+///
+/// @file
+///
+/// DISCLAIMER
+///
+/// Copyright 2010-2012 triagens GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is triAGENS GmbH, Cologne, Germany
+///
+/// @author Copyright 2015, triAGENS GmbH, Cologne, Germany
+////////////////////////////////////////////////////////////////////////////////
+
+var loadTestRunner = require("loadtestrunner");
+var internal = require("internal");
+var tasks = require("org/arangodb/tasks");
+var db = internal.db;
+
+// each writer uses its own collection, so the writers do not serialize on
+// the collection lock but only on the WAL slot handout
+var colName = "perf_walslots";
+var doneName = colName + "_done";
+var runs = 0;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief set up
+////////////////////////////////////////////////////////////////////////////////
+
+var setUp = function (options) {
+  var i;
+
+  for (i = 0; i < options.maxWriters; ++i) {
+    db._drop(colName + i);
+    db._create(colName + i);
+  }
+
+  db._drop(doneName);
+  db._create(doneName);
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief tear down
+////////////////////////////////////////////////////////////////////////////////
+
+var tearDown = function (options) {
+  var i;
+
+  for (i = 0; i < options.maxWriters; ++i) {
+    db._drop(colName + i);
+  }
+
+  db._drop(doneName);
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief start the writers as tasks and wait until all of them are done
+////////////////////////////////////////////////////////////////////////////////
+
+var runWriters = function (writers, options) {
+  var i;
+
+  db._collection(doneName).truncate();
+  ++runs;
+
+  for (i = 0; i < writers; ++i) {
+    tasks.register({
+      id: colName + "_writer" + runs + "_" + i,
+      offset: 0,
+      params: { cn: colName + i, done: doneName, n: options.documents },
+      command: function (params) {
+        var db = require("internal").db;
+        var c = db._collection(params.cn);
+        var j;
+
+        for (j = 0; j < params.n; ++j) {
+          c.save({ value: j });
+        }
+
+        db._collection(params.done).save({ });
+      }
+    });
+  }
+
+  while (db._collection(doneName).count() < writers) {
+    internal.wait(0.01, false);
+  }
+
+  return { };
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Testcases: write from a varying number of concurrent writers
+////////////////////////////////////////////////////////////////////////////////
+
+var makeTest = function (writers) {
+  return function (testParams, testMethodStr, testMethod, options) {
+    return runWriters(writers, options);
+  };
+};
+
+var testMethods = {
+  tasks: { }
+};
+
+var testSuite = [
+  { name: "setup",     setUp: setUp, teardown: null, params: null, func: null },
+
+  { name: "writers-1",  func: makeTest(1) },
+  { name: "writers-4",  func: makeTest(4) },
+  { name: "writers-16", func: makeTest(16) },
+  { name: "writers-64", func: makeTest(64) },
+
+  { name: "teardown",  setUp: null, tearDown: tearDown, params: null, func: null }
+];
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief execute suite. note that the number of concurrent writers is
+/// bounded by the number of server threads and V8 contexts
+////////////////////////////////////////////////////////////////////////////////
+
+var testOptions = {
+  maxWriters: 64,
+  documents: 10000,
+  runs: 5,   // number of runs for each test Has to be at least 3, else calculations will fail.
+  strip: 1,  // how many min/max extreme values to ignore
+  digits: 4  // result display digits
+};
+
+loadTestRunner.loadTestRunner(testSuite, testOptions, testMethods);
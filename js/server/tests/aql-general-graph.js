@@ -1842,6 +1842,28 @@ function ahuacatlQueryGeneralTraversalTestSuite() {
       assertEqual(actual[0]["UnitTests_Leipziger/Gerda"].toFixed(2), (1).toFixed(2));
     },
 
+    testGRAPH_CENTRALITY_threads: function () {
+      [ "GRAPH_CLOSENESS", "GRAPH_ECCENTRICITY", "GRAPH_BETWEENNESS" ].forEach(function (func) {
+        var expected = getQueryResults("RETURN " + func + "('werKenntWen', {threads : 1})");
+        var actual = getQueryResults("RETURN " + func + "('werKenntWen', {threads : 4})");
+        assertEqual(expected, actual, func);
+      });
+    },
+
+    testGRAPH_BETWEENNESS_samples: function () {
+      var expected = getQueryResults("RETURN GRAPH_ABSOLUTE_BETWEENNESS('werKenntWen', {direction : 'outbound'})");
+
+      // at least as many samples as vertices give the exact result
+      var actual = getQueryResults("RETURN GRAPH_ABSOLUTE_BETWEENNESS('werKenntWen', {direction : 'outbound', samples : 100})");
+      assertEqual(expected, actual);
+
+      actual = getQueryResults("RETURN GRAPH_ABSOLUTE_BETWEENNESS('werKenntWen', {direction : 'outbound', samples : 2})");
+      assertEqual(Object.keys(expected[0]).sort(), Object.keys(actual[0]).sort());
+      Object.keys(actual[0]).forEach(function (v) {
+        assertTrue(actual[0][v] >= 0);
+      });
+    },
+
     /*
     testGRAPH_BETWEENNESS: function () {
       var actual;
@@ -0,0 +1,229 @@
+/*jshint globalstrict:false, strict:false, maxlen: 500 */
+/*global assertEqual, assertNotEqual, assertTrue, AQL_EXPLAIN, AQL_EXECUTE */
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief tests for optimizer rules
+///
+/// @file
+///
+/// DISCLAIMER
+///
+/// Copyright 2010-2012 triagens GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is triAGENS GmbH, Cologne, Germany
+///
+/// @author Copyright 2015, triAGENS GmbH, Cologne, Germany
+////////////////////////////////////////////////////////////////////////////////
+
+var jsunity = require("jsunity");
+var helper = require("org/arangodb/aql-helper");
+var db = require("org/arangodb").db;
+var removeAlwaysOnClusterRules = helper.removeAlwaysOnClusterRules;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test suite
+////////////////////////////////////////////////////////////////////////////////
+
+function optimizerRuleTestSuite () {
+  var ruleName = "parallelize-collection-scans";
+  // various choices to control the optimizer:
+  var paramNone     = { optimizer: { rules: [ "-all" ] }, scanThreads: 2 };
+  var paramEnabled  = { optimizer: { rules: [ "-all", "+" + ruleName ] }, scanThreads: 2 };
+  var paramDisabled = { optimizer: { rules: [ "+all", "-" + ruleName ] } };
+  var cn1 = "UnitTestsLarge";
+  var cn2 = "UnitTestsSmall";
+  var c1, c2;
+
+  var gatherNode = function (result) {
+    return result.plan.nodes.filter(function(node) { return node.type === "GatherNode"; })[0];
+  };
+
+  var sorted = function (values) {
+    return values.sort(function (l, r) {
+      return JSON.stringify(l) < JSON.stringify(r) ? -1 : 1;
+    });
+  };
+
+  return {
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief set up
+////////////////////////////////////////////////////////////////////////////////
+
+    setUp : function () {
+      db._drop(cn1);
+      db._drop(cn2);
+      c1 = db._create(cn1);
+      c2 = db._create(cn2);
+
+      db._query("FOR i IN 0..24999 INSERT { value: i, group: i % 7, name: CONCAT('test', i) } INTO " + cn1);
+
+      for (var i = 0; i < 100; ++i) {
+        c2.save({ value: i });
+      }
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief tear down
+////////////////////////////////////////////////////////////////////////////////
+
+    tearDown : function () {
+      db._drop(cn1);
+      db._drop(cn2);
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test that rule has no effect when explicitly disabled
+////////////////////////////////////////////////////////////////////////////////
+
+    testRuleDisabled : function () {
+      var query = "FOR d IN " + cn1 + " FILTER d.group == 3 RETURN d.value";
+
+      var result = AQL_EXPLAIN(query, { }, paramNone);
+      assertEqual([ ], removeAlwaysOnClusterRules(result.plan.rules));
+      assertEqual(undefined, gatherNode(result));
+      
+      result = AQL_EXPLAIN(query, { }, paramDisabled);
+      assertEqual(-1, result.plan.rules.indexOf(ruleName));
+      assertEqual(undefined, gatherNode(result));
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test that rule has no effect
+////////////////////////////////////////////////////////////////////////////////
+
+    testRuleNoEffect : function () {
+      var queries = [
+        // collection too small
+        "FOR d IN " + cn2 + " FILTER d.value == 3 RETURN d.value",
+        // nothing to do but scanning
+        "FOR d IN " + cn1 + " RETURN d",
+        // not the outermost loop
+        "FOR i IN 1..2 FOR d IN " + cn1 + " FILTER d.value == i RETURN d.value",
+        // loop in a subquery
+        "LET x = (FOR d IN " + cn1 + " FILTER d.group == 3 RETURN d.value) RETURN LENGTH(x)",
+        // expression that needs V8
+        "FOR d IN " + cn1 + " FILTER d.value % 3 == 0 RETURN d.value",
+        // modification query
+        "FOR d IN " + cn1 + " FILTER d.value < 0 REMOVE d IN " + cn1
+      ];
+
+      queries.forEach(function(query) {
+        var result = AQL_EXPLAIN(query, { }, paramEnabled);
+        assertEqual(-1, result.plan.rules.indexOf(ruleName), query);
+        assertEqual(undefined, gatherNode(result), query);
+      });
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test that the number of threads can be limited per query
+////////////////////////////////////////////////////////////////////////////////
+
+    testRuleScanThreads : function () {
+      var query = "FOR d IN " + cn1 + " FILTER d.group == 3 RETURN d.value";
+
+      var result = AQL_EXPLAIN(query, { }, { optimizer: { rules: [ "-all", "+" + ruleName ] }, scanThreads: 1 });
+      assertEqual(-1, result.plan.rules.indexOf(ruleName));
+      assertEqual(undefined, gatherNode(result));
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test that rule has an effect
+////////////////////////////////////////////////////////////////////////////////
+
+    testRuleHasEffect : function () {
+      var queries = [
+        [ "FOR d IN " + cn1 + " FILTER d.group == 3 RETURN d.value", "ReturnNode" ],
+        [ "FOR d IN " + cn1 + " LET x = [ d.value, d.name ] RETURN x", "ReturnNode" ],
+        [ "FOR d IN " + cn1 + " FILTER d.group == 1 FILTER CONTAINS(d.name, '99') SORT d.value RETURN d.value", "SortNode" ],
+        [ "FOR d IN " + cn1 + " FILTER d.value > 10 LIMIT 5 RETURN d", "LimitNode" ]
+      ];
+
+      queries.forEach(function(query) {
+        var result = AQL_EXPLAIN(query[0], { }, paramEnabled);
+        assertNotEqual(-1, result.plan.rules.indexOf(ruleName), query[0]);
+
+        var node = gatherNode(result);
+        assertEqual(2, node.parallelism, query[0]);
+
+        // the gather is placed directly after the last filter or calculation
+        var parent = result.plan.nodes.filter(function(n) { return n.dependencies.indexOf(node.id) !== -1; })[0];
+        assertEqual(query[1], parent.type, query[0]);
+      });
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test results
+////////////////////////////////////////////////////////////////////////////////
+
+    testResults : function () {
+      var queries = [
+        "FOR d IN " + cn1 + " FILTER d.group == 3 RETURN d.value",
+        "FOR d IN " + cn1 + " LET x = [ d.value, d.name ] RETURN x",
+        "FOR d IN " + cn1 + " FILTER d.group == 1 FILTER CONTAINS(d.name, '99') RETURN d",
+        "FOR d IN " + cn1 + " FILTER d.value > 10 COLLECT g = d.group WITH COUNT INTO n RETURN [ g, n ]",
+        "FOR d IN " + cn1 + " FILTER d.group IN [ 1, 2 ] SORT d.value LIMIT 100, 10 RETURN d.name",
+        "FOR d IN " + cn1 + " FILTER d.value == -1 RETURN d",
+        "FOR d IN " + cn1 + " FILTER d.value < 1000 FOR s IN " + cn2 + " FILTER s.value == d.group RETURN [ d.value, s.value ]"
+      ];
+
+      queries.forEach(function(query) {
+        var expected = AQL_EXECUTE(query, { }, paramDisabled);
+        var actual = AQL_EXECUTE(query, { }, paramEnabled);
+        assertEqual(sorted(expected.json), sorted(actual.json), query);
+        assertEqual(expected.stats.scannedFull, actual.stats.scannedFull, query);
+      });
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test statistics
+////////////////////////////////////////////////////////////////////////////////
+
+    testStatistics : function () {
+      var query = "FOR d IN " + cn1 + " FILTER d.group == 0 RETURN d.value";
+      var result = AQL_EXECUTE(query, { }, paramEnabled);
+
+      assertEqual(3572, result.json.length);
+      assertEqual(25000, result.stats.scannedFull);
+      assertEqual(21428, result.stats.filtered);
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test warnings raised by the workers
+////////////////////////////////////////////////////////////////////////////////
+
+    testWorkerWarnings : function () {
+      var query = "FOR d IN " + cn1 + " LET x = UNIQUE(d.value) RETURN x";
+      var result = AQL_EXECUTE(query, { }, paramEnabled);
+
+      assertEqual(25000, result.json.length);
+      assertTrue(result.warnings.length > 0);
+    }
+
+  };
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief executes the test suite
+////////////////////////////////////////////////////////////////////////////////
+
+jsunity.run(optimizerRuleTestSuite);
+
+return jsunity.done();
+
+// Local Variables:
+// mode: outline-minor
+// outline-regexp: "^\\(/// @brief\\|/// @addtogroup\\|// --SECTION--\\|/// @page\\|/// @}\\)"
+// End:
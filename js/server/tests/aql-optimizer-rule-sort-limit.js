@@ -0,0 +1,183 @@
+/*jshint globalstrict:false, strict:false, maxlen: 500 */
+/*global assertEqual, assertNotEqual, AQL_EXPLAIN, AQL_EXECUTE */
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief tests for optimizer rules
+///
+/// @file
+///
+/// DISCLAIMER
+///
+/// Copyright 2010-2012 triagens GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is triAGENS GmbH, Cologne, Germany
+///
+/// @author Copyright 2015, triAGENS GmbH, Cologne, Germany
+////////////////////////////////////////////////////////////////////////////////
+
+var jsunity = require("jsunity");
+var helper = require("org/arangodb/aql-helper");
+var db = require("org/arangodb").db;
+var removeAlwaysOnClusterRules = helper.removeAlwaysOnClusterRules;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test suite
+////////////////////////////////////////////////////////////////////////////////
+
+function optimizerRuleTestSuite () {
+  var ruleName = "sort-limit";
+  // various choices to control the optimizer:
+  var paramNone     = { optimizer: { rules: [ "-all" ] } };
+  var paramEnabled  = { optimizer: { rules: [ "-all", "+" + ruleName ] } };
+  var paramDisabled = { optimizer: { rules: [ "+all", "-" + ruleName ] } };
+  var c;
+
+  var sortNode = function (result) {
+    return result.plan.nodes.filter(function(node) { return node.type === "SortNode"; })[0];
+  };
+
+  return {
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief set up
+////////////////////////////////////////////////////////////////////////////////
+
+    setUp : function () {
+      db._drop("UnitTestsCollection");
+      c = db._create("UnitTestsCollection");
+
+      for (var i = 0; i < 1000; ++i) {
+        c.save({ value: i, group: i % 10 });
+      }
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief tear down
+////////////////////////////////////////////////////////////////////////////////
+
+    tearDown : function () {
+      db._drop("UnitTestsCollection");
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test that rule has no effect when explicitly disabled
+////////////////////////////////////////////////////////////////////////////////
+
+    testRuleDisabled : function () {
+      var queries = [
+        "FOR i IN " + c.name() + " SORT i.value LIMIT 10 RETURN i",
+        "FOR i IN " + c.name() + " SORT i.value DESC LIMIT 5, 10 RETURN i"
+      ];
+
+      queries.forEach(function(query) {
+        var result = AQL_EXPLAIN(query, { }, paramNone);
+        assertEqual([ ], removeAlwaysOnClusterRules(result.plan.rules));
+        assertEqual(0, sortNode(result).limit);
+      });
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test that rule has no effect
+////////////////////////////////////////////////////////////////////////////////
+
+    testRuleNoEffect : function () {
+      var queries = [
+        "FOR i IN " + c.name() + " SORT i.value RETURN i", // no limit
+        "FOR i IN " + c.name() + " LIMIT 10 SORT i.value RETURN i", // limit before sort
+        "FOR i IN " + c.name() + " SORT i.value FILTER i.value > 10 LIMIT 10 RETURN i", // filter between sort and limit
+        "FOR i IN " + c.name() + " SORT i.value LIMIT 0 RETURN i" // limit 0
+      ];
+
+      queries.forEach(function(query) {
+        var result = AQL_EXPLAIN(query, { }, paramEnabled);
+        assertEqual(-1, result.plan.rules.indexOf(ruleName), query);
+      });
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test that rule has no effect when fullCount is requested
+////////////////////////////////////////////////////////////////////////////////
+
+    testRuleNoEffectFullCount : function () {
+      var query = "FOR i IN " + c.name() + " SORT i.value LIMIT 10 RETURN i";
+      var result = AQL_EXPLAIN(query, { }, { fullCount: true, optimizer: { rules: [ "-all", "+" + ruleName ] } });
+      assertEqual(-1, result.plan.rules.indexOf(ruleName), query);
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test that rule has an effect
+////////////////////////////////////////////////////////////////////////////////
+
+    testRuleHasEffect : function () {
+      var queries = [
+        [ "FOR i IN " + c.name() + " SORT i.value LIMIT 10 RETURN i", 10 ],
+        [ "FOR i IN " + c.name() + " SORT i.value DESC LIMIT 5, 10 RETURN i", 15 ],
+        [ "FOR i IN " + c.name() + " SORT i.group, i.value LIMIT 1 RETURN i", 1 ],
+        [ "FOR i IN 1..100 SORT i DESC LIMIT 3 RETURN i", 3 ]
+      ];
+
+      queries.forEach(function(query) {
+        var result = AQL_EXPLAIN(query[0], { }, paramEnabled);
+        assertNotEqual(-1, result.plan.rules.indexOf(ruleName), query[0]);
+        assertEqual(query[1], sortNode(result).limit, query[0]);
+      });
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test results
+////////////////////////////////////////////////////////////////////////////////
+
+    testResults : function () {
+      var queries = [
+        "FOR i IN " + c.name() + " SORT i.value LIMIT 10 RETURN i.value",
+        "FOR i IN " + c.name() + " SORT i.value DESC LIMIT 5, 10 RETURN i.value",
+        "FOR i IN " + c.name() + " SORT i.value DESC LIMIT 995, 10 RETURN i.value",
+        "FOR i IN " + c.name() + " SORT i.group DESC, i.value LIMIT 250 RETURN [ i.group, i.value ]",
+        "FOR i IN " + c.name() + " SORT i.value LIMIT 2000 RETURN i.value",
+        "FOR i IN 1..10 LET sub = (FOR j IN " + c.name() + " FILTER j.value > i SORT j.value DESC LIMIT 3 RETURN j.value) RETURN sub"
+      ];
+
+      queries.forEach(function(query) {
+        var expected = AQL_EXECUTE(query, { }, paramDisabled).json;
+        var actual = AQL_EXECUTE(query, { }, paramEnabled).json;
+        assertEqual(expected, actual, query);
+      });
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test that results for equal sort values keep their input order
+////////////////////////////////////////////////////////////////////////////////
+
+    testResultsStable : function () {
+      var query = "FOR i IN 1..1000 SORT i % 3 LIMIT 10 RETURN i";
+      var result = AQL_EXECUTE(query, { }, paramEnabled).json;
+      assertEqual([ 3, 6, 9, 12, 15, 18, 21, 24, 27, 30 ], result);
+    }
+
+  };
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief executes the test suite
+////////////////////////////////////////////////////////////////////////////////
+
+jsunity.run(optimizerRuleTestSuite);
+
+return jsunity.done();
+
+// Local Variables:
+// mode: outline-minor
+// outline-regexp: "^\\(/// @brief\\|/// @addtogroup\\|// --SECTION--\\|/// @page\\|/// @}\\)"
+// End:
@@ -0,0 +1,239 @@
+/*jshint globalstrict:false, strict:false, maxlen: 500 */
+/*global assertEqual, assertNotEqual, AQL_EXPLAIN, AQL_EXECUTE */
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief tests for optimizer rules
+///
+/// @file
+///
+/// DISCLAIMER
+///
+/// Copyright 2010-2012 triagens GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is triAGENS GmbH, Cologne, Germany
+///
+/// @author Copyright 2015, triAGENS GmbH, Cologne, Germany
+////////////////////////////////////////////////////////////////////////////////
+
+var jsunity = require("jsunity");
+var helper = require("org/arangodb/aql-helper");
+var db = require("org/arangodb").db;
+var removeAlwaysOnClusterRules = helper.removeAlwaysOnClusterRules;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test suite
+////////////////////////////////////////////////////////////////////////////////
+
+function optimizerRuleTestSuite () {
+  var ruleName = "use-hash-join";
+  // various choices to control the optimizer:
+  var paramNone     = { optimizer: { rules: [ "-all" ] } };
+  var paramEnabled  = { optimizer: { rules: [ "-all", "+" + ruleName ] } };
+  var paramDisabled = { optimizer: { rules: [ "+all", "-" + ruleName ] } };
+  var cn1 = "UnitTestsOrders";
+  var cn2 = "UnitTestsCustomers";
+  var c1, c2;
+
+  var nodeTypes = function (result) {
+    return result.plan.nodes.map(function(node) { return node.type; });
+  };
+
+  var hashJoinNode = function (result) {
+    return result.plan.nodes.filter(function(node) { return node.type === "HashJoinNode"; })[0];
+  };
+
+  return {
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief set up
+////////////////////////////////////////////////////////////////////////////////
+
+    setUp : function () {
+      db._drop(cn1);
+      db._drop(cn2);
+      c1 = db._create(cn1);
+      c2 = db._create(cn2);
+
+      var i;
+      for (i = 0; i < 1000; ++i) {
+        c1.save({ order: i, customer: "c" + (i % 110), region: i % 3, nested: { customer: "c" + (i % 110) } });
+      }
+      for (i = 0; i < 100; ++i) {
+        c2.save({ id: "c" + i, region: i % 3, name: "customer" + i });
+      }
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief tear down
+////////////////////////////////////////////////////////////////////////////////
+
+    tearDown : function () {
+      db._drop(cn1);
+      db._drop(cn2);
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test that rule has no effect when explicitly disabled
+////////////////////////////////////////////////////////////////////////////////
+
+    testRuleDisabled : function () {
+      var query = "FOR o IN " + cn1 + " FOR c IN " + cn2 + " FILTER o.customer == c.id RETURN [ o.order, c.name ]";
+
+      var result = AQL_EXPLAIN(query, { }, paramNone);
+      assertEqual([ ], removeAlwaysOnClusterRules(result.plan.rules));
+      assertEqual(-1, nodeTypes(result).indexOf("HashJoinNode"));
+      
+      result = AQL_EXPLAIN(query, { }, paramDisabled);
+      assertEqual(-1, result.plan.rules.indexOf(ruleName));
+      assertEqual(-1, nodeTypes(result).indexOf("HashJoinNode"));
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test that rule has no effect
+////////////////////////////////////////////////////////////////////////////////
+
+    testRuleNoEffect : function () {
+      var queries = [
+        // no join condition
+        "FOR o IN " + cn1 + " FOR c IN " + cn2 + " RETURN [ o.order, c.name ]",
+        // comparison with a constant
+        "FOR c IN " + cn2 + " FILTER c.id == 'c1' RETURN c.name",
+        // not an equality condition
+        "FOR o IN " + cn1 + " FOR c IN " + cn2 + " FILTER o.customer < c.id RETURN [ o.order, c.name ]",
+        // both sides depend on the inner loop
+        "FOR o IN " + cn1 + " FOR c IN " + cn2 + " FILTER c.name == c.id RETURN [ o.order, c.name ]",
+        // or-combined condition
+        "FOR o IN " + cn1 + " FOR c IN " + cn2 + " FILTER o.customer == c.id || o.region == c.region RETURN [ o.order, c.name ]",
+        // filter not directly following the loop
+        "FOR o IN " + cn1 + " FOR c IN " + cn2 + " LIMIT 10 FILTER o.customer == c.id RETURN [ o.order, c.name ]",
+        // non-deterministic probe value
+        "FOR o IN " + cn1 + " FOR c IN " + cn2 + " FILTER CONCAT('c', FLOOR(RAND() * 100)) == c.id RETURN [ o.order, c.name ]"
+      ];
+
+      queries.forEach(function(query) {
+        var result = AQL_EXPLAIN(query, { }, paramEnabled);
+        assertEqual(-1, result.plan.rules.indexOf(ruleName), query);
+        assertEqual(-1, nodeTypes(result).indexOf("HashJoinNode"), query);
+      });
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test that rule has an effect
+////////////////////////////////////////////////////////////////////////////////
+
+    testRuleHasEffect : function () {
+      var queries = [
+        [ "FOR o IN " + cn1 + " FOR c IN " + cn2 + " FILTER o.customer == c.id RETURN [ o.order, c.name ]", cn2, [ [ "id" ] ] ],
+        [ "FOR o IN " + cn1 + " FOR c IN " + cn2 + " FILTER c.id == o.customer RETURN [ o.order, c.name ]", cn2, [ [ "id" ] ] ],
+        [ "FOR o IN " + cn1 + " FOR c IN " + cn2 + " FILTER c.id == o.nested.customer RETURN [ o.order, c.name ]", cn2, [ [ "id" ] ] ],
+        [ "FOR c IN " + cn2 + " FOR o IN " + cn1 + " FILTER c.id == o.nested.customer RETURN [ o.order, c.name ]", cn1, [ [ "nested", "customer" ] ] ],
+        [ "FOR o IN " + cn1 + " FOR c IN " + cn2 + " FILTER o.customer == c.id && o.region == c.region RETURN [ o.order, c.name ]", cn2, [ [ "id" ], [ "region" ] ] ],
+        [ "FOR o IN " + cn1 + " FOR c IN " + cn2 + " FILTER o.customer == c.id FILTER c.name != 'foo' RETURN [ o.order, c.name ]", cn2, [ [ "id" ] ] ],
+        [ "FOR o IN " + cn1 + " FOR c IN " + cn2 + " FILTER CONCAT('c', o.order % 110) == c.id RETURN [ o.order, c.name ]", cn2, [ [ "id" ] ] ]
+      ];
+
+      queries.forEach(function(query) {
+        var result = AQL_EXPLAIN(query[0], { }, paramEnabled);
+        assertNotEqual(-1, result.plan.rules.indexOf(ruleName), query[0]);
+
+        // the hash table is built from the inner collection
+        var node = hashJoinNode(result);
+        assertEqual(query[1], node.collection, query[0]);
+        assertEqual(query[2], node.keys.map(function(key) { return key.attribute; }), query[0]);
+        assertEqual(1, nodeTypes(result).filter(function(type) { return type === "EnumerateCollectionNode"; }).length, query[0]);
+      });
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test that an index is preferred over a hash join
+////////////////////////////////////////////////////////////////////////////////
+
+    testIndexPreferred : function () {
+      c2.ensureHashIndex("id");
+
+      var query = "FOR o IN " + cn1 + " FOR c IN " + cn2 + " FILTER o.customer == c.id RETURN [ o.order, c.name ]";
+      var result = AQL_EXPLAIN(query);
+      assertNotEqual(-1, nodeTypes(result).indexOf("IndexRangeNode"));
+      assertEqual(-1, nodeTypes(result).indexOf("HashJoinNode"));
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test that rule has no effect when the joined collection is modified
+////////////////////////////////////////////////////////////////////////////////
+
+    testModifiedCollection : function () {
+      var query = "FOR o IN " + cn1 + " FOR c IN " + cn2 + " FILTER o.customer == c.id UPDATE c WITH { visits: (c.visits == null ? 1 : c.visits + 1) } IN " + cn2;
+
+      var result = AQL_EXPLAIN(query, { }, paramEnabled);
+      assertEqual(-1, result.plan.rules.indexOf(ruleName));
+      assertEqual(-1, nodeTypes(result).indexOf("HashJoinNode"));
+
+      AQL_EXECUTE(query, { }, paramEnabled);
+
+      // 910 of the orders have a matching customer. every update must see
+      // the result of the previous one
+      var visits = AQL_EXECUTE("FOR c IN " + cn2 + " SORT c.id RETURN c.visits").json;
+      assertEqual(100, visits.length);
+      assertEqual(910, visits.reduce(function(sum, v) { return sum + v; }, 0));
+
+      // modifying the other collection does not prevent the join
+      query = "FOR o IN " + cn1 + " FOR c IN " + cn2 + " FILTER o.customer == c.id UPDATE o WITH { name: c.name } IN " + cn1;
+      result = AQL_EXPLAIN(query, { }, paramEnabled);
+      assertEqual(cn2, hashJoinNode(result).collection);
+      
+      AQL_EXECUTE(query, { }, paramEnabled);
+      assertEqual(910, AQL_EXECUTE("FOR o IN " + cn1 + " FILTER o.name != null RETURN 1").json.length);
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test results
+////////////////////////////////////////////////////////////////////////////////
+
+    testResults : function () {
+      var queries = [
+        "FOR o IN " + cn1 + " FOR c IN " + cn2 + " FILTER o.customer == c.id SORT o.order RETURN [ o.order, c.name ]",
+        "FOR c IN " + cn2 + " FOR o IN " + cn1 + " FILTER o.customer == c.id SORT o.order RETURN [ o.order, c.name ]",
+        "FOR o IN " + cn1 + " FOR c IN " + cn2 + " FILTER o.customer == c.id && o.region == c.region SORT o.order RETURN [ o.order, c.name ]",
+        "FOR o IN " + cn1 + " FOR c IN " + cn2 + " FILTER o.region == c.region SORT o.order, c.name RETURN [ o.order, c.name ]",
+        "FOR o IN " + cn1 + " FOR c IN " + cn2 + " FILTER o.customer == c.id FILTER c.region == 1 SORT o.order RETURN [ o.order, c.name ]",
+        "FOR o IN " + cn1 + " FOR c IN " + cn2 + " FILTER o.missing == c.missing SORT o.order, c.name LIMIT 100 RETURN [ o.order, c.name ]",
+        "FOR o IN " + cn1 + " FOR c IN " + cn2 + " FILTER o.customer == c.id COLLECT name = c.name WITH COUNT INTO n SORT name RETURN [ name, n ]",
+        "FOR o IN " + cn1 + " FOR c IN " + cn2 + " FILTER o.customer == c.id LIMIT 10, 5 RETURN 1",
+        "FOR o IN " + cn1 + " LET m = (FOR c IN " + cn2 + " FILTER c.id == o.customer RETURN c.name) SORT o.order RETURN [ o.order, m ]",
+        "FOR o IN " + cn1 + " FOR c IN " + cn2 + " FILTER o.customer == c.id FOR o2 IN " + cn1 + " FILTER o2.order == o.order SORT o.order RETURN [ o.order, c.name, o2.order ]"
+      ];
+
+      queries.forEach(function(query) {
+        var expected = AQL_EXECUTE(query, { }, paramDisabled).json;
+        var actual = AQL_EXECUTE(query, { }, paramEnabled).json;
+        assertEqual(expected, actual, query);
+      });
+    }
+
+  };
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief executes the test suite
+////////////////////////////////////////////////////////////////////////////////
+
+jsunity.run(optimizerRuleTestSuite);
+
+return jsunity.done();
+
+// Local Variables:
+// mode: outline-minor
+// outline-regexp: "^\\(/// @brief\\|/// @addtogroup\\|// --SECTION--\\|/// @page\\|/// @}\\)"
+// End:
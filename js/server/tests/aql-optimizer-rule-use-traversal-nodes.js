@@ -0,0 +1,189 @@
+/*jshint globalstrict:false, strict:false, maxlen: 500 */
+/*global assertEqual, assertNotEqual, AQL_EXPLAIN, AQL_EXECUTE */
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief tests for optimizer rules
+///
+/// @file
+///
+/// DISCLAIMER
+///
+/// Copyright 2010-2012 triagens GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is triAGENS GmbH, Cologne, Germany
+///
+/// @author Copyright 2015, triAGENS GmbH, Cologne, Germany
+////////////////////////////////////////////////////////////////////////////////
+
+var jsunity = require("jsunity");
+var helper = require("org/arangodb/aql-helper");
+var db = require("org/arangodb").db;
+var removeAlwaysOnClusterRules = helper.removeAlwaysOnClusterRules;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test suite
+////////////////////////////////////////////////////////////////////////////////
+
+function optimizerRuleTestSuite () {
+  var ruleName = "use-traversal-nodes";
+  // various choices to control the optimizer:
+  var paramNone     = { optimizer: { rules: [ "-all" ] } };
+  var paramEnabled  = { optimizer: { rules: [ "-all", "+" + ruleName ] } };
+  var paramDisabled = { optimizer: { rules: [ "+all", "-" + ruleName ] } };
+  var vn = "UnitTestsVertex";
+  var en = "UnitTestsEdge";
+
+  var nodeTypes = function (result) {
+    return result.plan.nodes.map(function(node) { return node.type; });
+  };
+
+  return {
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief set up
+////////////////////////////////////////////////////////////////////////////////
+
+    setUp : function () {
+      db._drop(vn);
+      db._drop(en);
+      var v = db._create(vn);
+      var e = db._createEdgeCollection(en);
+
+      for (var i = 1; i <= 6; ++i) {
+        v.save({ _key: "v" + i, value: i });
+      }
+
+      [ [ 1, 2 ], [ 1, 3 ], [ 2, 4 ], [ 3, 4 ], [ 4, 5 ], [ 6, 1 ] ].forEach(function(pair) {
+        e.save(vn + "/v" + pair[0], vn + "/v" + pair[1], { weight: pair[0] });
+      });
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief tear down
+////////////////////////////////////////////////////////////////////////////////
+
+    tearDown : function () {
+      db._drop(vn);
+      db._drop(en);
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test that rule has no effect when explicitly disabled
+////////////////////////////////////////////////////////////////////////////////
+
+    testRuleDisabled : function () {
+      var queries = [
+        "FOR v IN NEIGHBORS(" + vn + ", " + en + ", '" + vn + "/v1', 'outbound') RETURN v",
+        "FOR v IN SHORTEST_PATH(" + vn + ", " + en + ", '" + vn + "/v1', '" + vn + "/v5', 'outbound').vertices RETURN v"
+      ];
+
+      queries.forEach(function(query) {
+        var result = AQL_EXPLAIN(query, { }, paramNone);
+        assertEqual([ ], removeAlwaysOnClusterRules(result.plan.rules));
+        assertEqual(-1, nodeTypes(result).indexOf("TraversalNode"), query);
+        assertEqual(-1, nodeTypes(result).indexOf("ShortestPathNode"), query);
+      });
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test that rule has no effect
+////////////////////////////////////////////////////////////////////////////////
+
+    testRuleNoEffect : function () {
+      var queries = [
+        // result of function is used later
+        "LET n = NEIGHBORS(" + vn + ", " + en + ", '" + vn + "/v1', 'outbound') FOR v IN n RETURN [ v, n ]",
+        // not iterated over
+        "RETURN NEIGHBORS(" + vn + ", " + en + ", '" + vn + "/v1', 'outbound')",
+        // non-constant examples
+        "FOR x IN [ { weight: 1 } ] FOR v IN NEIGHBORS(" + vn + ", " + en + ", '" + vn + "/v1', 'outbound', x) RETURN v",
+        // null examples
+        "FOR v IN NEIGHBORS(" + vn + ", " + en + ", '" + vn + "/v1', 'outbound', null) RETURN v",
+        // invalid direction
+        "FOR v IN NEIGHBORS(" + vn + ", " + en + ", '" + vn + "/v1', 'sideways') RETURN v",
+        // weighted shortest path
+        "FOR v IN SHORTEST_PATH(" + vn + ", " + en + ", '" + vn + "/v1', '" + vn + "/v5', 'outbound', { weight: 'weight' }).vertices RETURN v",
+        // other attribute of shortest path
+        "FOR v IN SHORTEST_PATH(" + vn + ", " + en + ", '" + vn + "/v1', '" + vn + "/v5', 'outbound').foo RETURN v"
+      ];
+
+      queries.forEach(function(query) {
+        var result = AQL_EXPLAIN(query, { }, paramEnabled);
+        assertEqual(-1, result.plan.rules.indexOf(ruleName), query);
+      });
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test that rule has an effect
+////////////////////////////////////////////////////////////////////////////////
+
+    testRuleHasEffect : function () {
+      var queries = [
+        [ "FOR v IN NEIGHBORS(" + vn + ", " + en + ", '" + vn + "/v1', 'outbound') RETURN v", "TraversalNode" ],
+        [ "FOR v IN NEIGHBORS(" + vn + ", " + en + ", 'v1', 'any', [ ], { maxDepth: 2, includeData: true }) RETURN v", "TraversalNode" ],
+        [ "FOR v IN NEIGHBORS(" + vn + ", " + en + ", { _id: '" + vn + "/v4' }, 'inbound', { weight: 1 }) RETURN v", "TraversalNode" ],
+        [ "FOR i IN 1..3 FOR v IN NEIGHBORS(" + vn + ", " + en + ", CONCAT('v', i), 'outbound') RETURN v", "TraversalNode" ],
+        [ "FOR v IN SHORTEST_PATH(" + vn + ", " + en + ", '" + vn + "/v1', '" + vn + "/v5', 'outbound').vertices RETURN v", "ShortestPathNode" ],
+        [ "FOR v IN SHORTEST_PATH(" + vn + ", " + en + ", 'v1', 'v5', 'any', { includeData: true }).edges RETURN v", "ShortestPathNode" ]
+      ];
+
+      queries.forEach(function(query) {
+        var result = AQL_EXPLAIN(query[0], { }, paramEnabled);
+        assertNotEqual(-1, result.plan.rules.indexOf(ruleName), query[0]);
+        assertNotEqual(-1, nodeTypes(result).indexOf(query[1]), query[0]);
+        assertEqual(-1, nodeTypes(result).indexOf("EnumerateListNode"), query[0]);
+      });
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test results
+////////////////////////////////////////////////////////////////////////////////
+
+    testResults : function () {
+      var queries = [
+        "FOR v IN NEIGHBORS(" + vn + ", " + en + ", '" + vn + "/v1', 'outbound') SORT v RETURN v",
+        "FOR v IN NEIGHBORS(" + vn + ", " + en + ", '" + vn + "/v4', 'any') SORT v RETURN v",
+        "FOR v IN NEIGHBORS(" + vn + ", " + en + ", 'v1', 'outbound', [ ], { minDepth: 2, maxDepth: 3 }) SORT v RETURN v",
+        "FOR v IN NEIGHBORS(" + vn + ", " + en + ", 'v1', 'outbound', { weight: 1 }, { includeData: true }) SORT v.value RETURN v.value",
+        "FOR i IN 1..6 FOR v IN NEIGHBORS(" + vn + ", " + en + ", CONCAT('" + vn + "/v', i), 'inbound') SORT i, v RETURN [ i, v ]",
+        "FOR v IN NEIGHBORS(" + vn + ", " + en + ", 'v1', 'outbound') LIMIT 0 RETURN v",
+        "FOR v IN SHORTEST_PATH(" + vn + ", " + en + ", '" + vn + "/v6', '" + vn + "/v5', 'outbound').vertices RETURN v._key",
+        "FOR v IN SHORTEST_PATH(" + vn + ", " + en + ", 'v6', 'v5', 'outbound', { includeData: true }).vertices RETURN v.value",
+        "FOR v IN SHORTEST_PATH(" + vn + ", " + en + ", 'v5', 'v6', 'any').edges RETURN [ v._from, v._to ]",
+        "FOR v IN SHORTEST_PATH(" + vn + ", " + en + ", 'v1', 'v1', 'outbound').vertices RETURN v._key"
+      ];
+
+      queries.forEach(function(query) {
+        var expected = AQL_EXECUTE(query, { }, paramDisabled).json;
+        var actual = AQL_EXECUTE(query, { }, paramEnabled).json;
+        assertEqual(expected, actual, query);
+      });
+    }
+
+  };
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief executes the test suite
+////////////////////////////////////////////////////////////////////////////////
+
+jsunity.run(optimizerRuleTestSuite);
+
+return jsunity.done();
+
+// Local Variables:
+// mode: outline-minor
+// outline-regexp: "^\\(/// @brief\\|/// @addtogroup\\|// --SECTION--\\|/// @page\\|/// @}\\)"
+// End:
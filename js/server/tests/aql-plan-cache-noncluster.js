@@ -0,0 +1,349 @@
+/*jshint globalstrict:false, strict:false, maxlen: 500 */
+/*global assertEqual, assertTrue, AQL_EXECUTE, AQL_EXPLAIN,
+  AQL_PLAN_CACHE_PROPERTIES, AQL_PLAN_CACHE_INVALIDATE */
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief tests for the AQL plan cache
+///
+/// @file
+///
+/// DISCLAIMER
+///
+/// Copyright 2010-2012 triagens GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is triAGENS GmbH, Cologne, Germany
+///
+/// @author Jan Steemann
+/// @author Copyright 2015, triAGENS GmbH, Cologne, Germany
+////////////////////////////////////////////////////////////////////////////////
+
+var jsunity = require("jsunity");
+var db = require("org/arangodb").db;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test suite
+////////////////////////////////////////////////////////////////////////////////
+
+function ahuacatlPlanCacheTestSuite () {
+  var cacheProperties;
+  var cn = "UnitTestsAhuacatlPlanCache";
+  var c;
+  var query = "FOR doc IN @@collection FILTER doc.value >= @value SORT doc.value RETURN doc.value";
+
+  var fill = function (n) {
+    for (var i = 0; i < n; ++i) {
+      c.save({ value: i });
+    }
+  };
+
+  return {
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief set up
+////////////////////////////////////////////////////////////////////////////////
+
+    setUp : function () {
+      cacheProperties = AQL_PLAN_CACHE_PROPERTIES();
+      AQL_PLAN_CACHE_PROPERTIES({ maxEntries: 16 });
+      AQL_PLAN_CACHE_INVALIDATE();
+
+      db._drop(cn);
+      c = db._create(cn);
+      fill(10);
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief tear down
+////////////////////////////////////////////////////////////////////////////////
+
+    tearDown : function () {
+      db._drop(cn);
+      c = null;
+
+      AQL_PLAN_CACHE_PROPERTIES({ maxEntries: cacheProperties.maxEntries });
+      AQL_PLAN_CACHE_INVALIDATE();
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test properties
+////////////////////////////////////////////////////////////////////////////////
+
+    testProperties : function () {
+      var result = AQL_PLAN_CACHE_PROPERTIES({ maxEntries: 2 });
+      assertEqual(2, result.maxEntries);
+      assertEqual(0, result.entries);
+      assertTrue(result.hasOwnProperty("hits"));
+      assertTrue(result.hasOwnProperty("misses"));
+
+      result = AQL_PLAN_CACHE_PROPERTIES();
+      assertEqual(2, result.maxEntries);
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test that a repeated query uses the cached plan
+////////////////////////////////////////////////////////////////////////////////
+
+    testHit : function () {
+      var before = AQL_PLAN_CACHE_PROPERTIES();
+
+      var result1 = AQL_EXECUTE(query, { "@collection": cn, value: 5 });
+      var after1 = AQL_PLAN_CACHE_PROPERTIES();
+      assertEqual([ 5, 6, 7, 8, 9 ], result1.json);
+      assertEqual(before.hits, after1.hits);
+      assertEqual(before.misses + 1, after1.misses);
+      assertEqual(1, after1.entries);
+
+      var result2 = AQL_EXECUTE(query, { "@collection": cn, value: 5 });
+      var after2 = AQL_PLAN_CACHE_PROPERTIES();
+      assertEqual(result1.json, result2.json);
+      assertEqual(after1.hits + 1, after2.hits);
+      assertEqual(after1.misses, after2.misses);
+      assertEqual(1, after2.entries);
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test that cached plans see data changes
+////////////////////////////////////////////////////////////////////////////////
+
+    testDataChange : function () {
+      assertEqual([ 8, 9 ], AQL_EXECUTE(query, { "@collection": cn, value: 8 }).json);
+
+      c.save({ value: 10 });
+      var before = AQL_PLAN_CACHE_PROPERTIES();
+      assertEqual([ 8, 9, 10 ], AQL_EXECUTE(query, { "@collection": cn, value: 8 }).json);
+      assertEqual(before.hits + 1, AQL_PLAN_CACHE_PROPERTIES().hits);
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test that different bind parameter values re-use the cached plan
+////////////////////////////////////////////////////////////////////////////////
+
+    testBindParameters : function () {
+      AQL_EXECUTE(query, { "@collection": cn, value: 5 });
+      var before = AQL_PLAN_CACHE_PROPERTIES();
+
+      var result = AQL_EXECUTE(query, { "@collection": cn, value: 7 });
+      var after = AQL_PLAN_CACHE_PROPERTIES();
+      assertEqual([ 7, 8, 9 ], result.json);
+      assertEqual(before.hits + 1, after.hits);
+      assertEqual(before.misses, after.misses);
+      assertEqual(1, after.entries);
+      
+      result = AQL_EXECUTE(query, { "@collection": cn, value: "foo" });
+      assertEqual([ ], result.json);
+      result = AQL_EXECUTE(query, { "@collection": cn, value: null });
+      assertEqual([ 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 ], result.json);
+      assertEqual(before.hits + 3, AQL_PLAN_CACHE_PROPERTIES().hits);
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test re-binding bind parameters used in an index lookup
+////////////////////////////////////////////////////////////////////////////////
+
+    testBindParametersIndex : function () {
+      c.ensureSkiplist("value");
+      var q = "FOR doc IN @@collection FILTER doc.value == @value RETURN doc.value";
+
+      assertEqual([ 3 ], AQL_EXECUTE(q, { "@collection": cn, value: 3 }).json);
+      var before = AQL_PLAN_CACHE_PROPERTIES();
+
+      assertEqual([ 4 ], AQL_EXECUTE(q, { "@collection": cn, value: 4 }).json);
+      assertEqual([ ], AQL_EXECUTE(q, { "@collection": cn, value: 42 }).json);
+      assertEqual(before.hits + 2, AQL_PLAN_CACHE_PROPERTIES().hits);
+      
+      var plan = AQL_EXPLAIN(q, { "@collection": cn, value: 4 }).plan;
+      assertEqual([ "IndexRangeNode" ], plan.nodes.map(function(node) { 
+        return node.type; 
+      }).filter(function(type) { 
+        return type === "IndexRangeNode"; 
+      }));
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test that bind parameters that are injected into the plan use
+/// different plans for different values
+////////////////////////////////////////////////////////////////////////////////
+
+    testBindParametersInjected : function () {
+      var q = "FOR doc IN @@collection SORT doc.value LIMIT @n RETURN doc.value";
+
+      assertEqual([ 0, 1 ], AQL_EXECUTE(q, { "@collection": cn, n: 2 }).json);
+      var before = AQL_PLAN_CACHE_PROPERTIES();
+
+      assertEqual([ 0, 1, 2 ], AQL_EXECUTE(q, { "@collection": cn, n: 3 }).json);
+      var after = AQL_PLAN_CACHE_PROPERTIES();
+      assertEqual(before.hits, after.hits);
+      assertEqual(before.misses + 1, after.misses);
+      
+      assertEqual([ 0, 1 ], AQL_EXECUTE(q, { "@collection": cn, n: 2 }).json);
+      assertEqual(after.hits + 1, AQL_PLAN_CACHE_PROPERTIES().hits);
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test that different options use different plans
+////////////////////////////////////////////////////////////////////////////////
+
+    testOptions : function () {
+      AQL_EXECUTE(query, { "@collection": cn, value: 5 });
+      var before = AQL_PLAN_CACHE_PROPERTIES();
+
+      var result = AQL_EXECUTE(query, { "@collection": cn, value: 5 }, { optimizer: { rules: [ "-all" ] } });
+      var after = AQL_PLAN_CACHE_PROPERTIES();
+      assertEqual([ 5, 6, 7, 8, 9 ], result.json);
+      assertEqual(before.hits, after.hits);
+      assertEqual(2, after.entries);
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test bypassing the cache
+////////////////////////////////////////////////////////////////////////////////
+
+    testBypass : function () {
+      var before = AQL_PLAN_CACHE_PROPERTIES();
+
+      AQL_EXECUTE(query, { "@collection": cn, value: 5 }, { planCache: false });
+      AQL_EXECUTE(query, { "@collection": cn, value: 5 }, { planCache: false });
+      var after = AQL_PLAN_CACHE_PROPERTIES();
+      assertEqual(before.hits, after.hits);
+      assertEqual(before.misses, after.misses);
+      assertEqual(0, after.entries);
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test turning off the cache
+////////////////////////////////////////////////////////////////////////////////
+
+    testTurnOff : function () {
+      AQL_EXECUTE(query, { "@collection": cn, value: 5 });
+      assertEqual(1, AQL_PLAN_CACHE_PROPERTIES().entries);
+
+      AQL_PLAN_CACHE_PROPERTIES({ maxEntries: 0 });
+      assertEqual(0, AQL_PLAN_CACHE_PROPERTIES().entries);
+
+      AQL_EXECUTE(query, { "@collection": cn, value: 5 });
+      assertEqual(0, AQL_PLAN_CACHE_PROPERTIES().entries);
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test eviction of the least recently used plans
+////////////////////////////////////////////////////////////////////////////////
+
+    testMaxEntries : function () {
+      AQL_PLAN_CACHE_PROPERTIES({ maxEntries: 2 });
+
+      var q1 = "FOR doc IN @@collection FILTER doc.value == @value RETURN 1";
+      var q2 = "FOR doc IN @@collection FILTER doc.value == @value RETURN 2";
+      var q3 = "FOR doc IN @@collection FILTER doc.value == @value RETURN 3";
+
+      AQL_EXECUTE(q1, { "@collection": cn, value: 1 });
+      AQL_EXECUTE(q2, { "@collection": cn, value: 1 });
+      // use the first plan again
+      AQL_EXECUTE(q1, { "@collection": cn, value: 1 });
+      AQL_EXECUTE(q3, { "@collection": cn, value: 1 });
+      assertEqual(2, AQL_PLAN_CACHE_PROPERTIES().entries);
+
+      // the plan for the second query was evicted
+      var before = AQL_PLAN_CACHE_PROPERTIES();
+      AQL_EXECUTE(q1, { "@collection": cn, value: 1 });
+      assertEqual(before.hits + 1, AQL_PLAN_CACHE_PROPERTIES().hits);
+      
+      before = AQL_PLAN_CACHE_PROPERTIES();
+      AQL_EXECUTE(q2, { "@collection": cn, value: 1 });
+      assertEqual(before.hits, AQL_PLAN_CACHE_PROPERTIES().hits);
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test invalidation when creating an index
+////////////////////////////////////////////////////////////////////////////////
+
+    testInvalidationIndex : function () {
+      AQL_EXECUTE(query, { "@collection": cn, value: 5 });
+      assertEqual(1, AQL_PLAN_CACHE_PROPERTIES().entries);
+
+      c.ensureSkiplist("value");
+      assertEqual(0, AQL_PLAN_CACHE_PROPERTIES().entries);
+
+      var result = AQL_EXECUTE(query, { "@collection": cn, value: 5 });
+      assertEqual([ 5, 6, 7, 8, 9 ], result.json);
+      assertEqual(1, AQL_PLAN_CACHE_PROPERTIES().entries);
+      
+      c.dropIndex(c.getIndexes()[1]);
+      assertEqual(0, AQL_PLAN_CACHE_PROPERTIES().entries);
+      
+      result = AQL_EXECUTE(query, { "@collection": cn, value: 5 });
+      assertEqual([ 5, 6, 7, 8, 9 ], result.json);
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test invalidation when dropping the collection
+////////////////////////////////////////////////////////////////////////////////
+
+    testInvalidationDrop : function () {
+      AQL_EXECUTE(query, { "@collection": cn, value: 5 });
+      assertEqual(1, AQL_PLAN_CACHE_PROPERTIES().entries);
+
+      db._drop(cn);
+      assertEqual(0, AQL_PLAN_CACHE_PROPERTIES().entries);
+
+      c = db._create(cn);
+      fill(7);
+
+      var result = AQL_EXECUTE(query, { "@collection": cn, value: 5 });
+      assertEqual([ 5, 6 ], result.json);
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test invalidation when renaming the collection
+////////////////////////////////////////////////////////////////////////////////
+
+    testInvalidationRename : function () {
+      AQL_EXECUTE(query, { "@collection": cn, value: 5 });
+      assertEqual(1, AQL_PLAN_CACHE_PROPERTIES().entries);
+
+      c.rename(cn + "Renamed");
+      assertEqual(0, AQL_PLAN_CACHE_PROPERTIES().entries);
+      db._drop(cn + "Renamed");
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test a cached data-modification query
+////////////////////////////////////////////////////////////////////////////////
+
+    testModificationQuery : function () {
+      var q = "FOR i IN 1..@n INSERT { value: i } IN @@collection";
+
+      AQL_EXECUTE(q, { "@collection": cn, n: 2 });
+      var before = AQL_PLAN_CACHE_PROPERTIES();
+      AQL_EXECUTE(q, { "@collection": cn, n: 2 });
+      assertEqual(before.hits + 1, AQL_PLAN_CACHE_PROPERTIES().hits);
+
+      assertEqual(14, c.count());
+    }
+
+  };
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief executes the test suite
+////////////////////////////////////////////////////////////////////////////////
+
+jsunity.run(ahuacatlPlanCacheTestSuite);
+
+return jsunity.done();
+
+// Local Variables:
+// mode: outline-minor
+// outline-regexp: "^\\(/// @brief\\|/// @addtogroup\\|// --SECTION--\\|/// @page\\|/// @}\\)"
+// End:
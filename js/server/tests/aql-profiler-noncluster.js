@@ -0,0 +1,181 @@
+/*jshint globalstrict:false, strict:false, maxlen: 500 */
+/*global assertEqual, assertTrue, assertFalse, assertUndefined, AQL_EXECUTE */
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief tests for the per-node AQL query profiling
+///
+/// @file
+///
+/// DISCLAIMER
+///
+/// Copyright 2010-2012 triagens GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is triAGENS GmbH, Cologne, Germany
+///
+/// @author Jan Steemann
+/// @author Copyright 2015, triAGENS GmbH, Cologne, Germany
+////////////////////////////////////////////////////////////////////////////////
+
+var jsunity = require("jsunity");
+var db = require("org/arangodb").db;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test suite
+////////////////////////////////////////////////////////////////////////////////
+
+function ahuacatlProfilerTestSuite () {
+  var cn = "UnitTestsAhuacatlProfiler";
+  var c;
+  var options = { profile: true, cache: false, optimizer: { rules: [ "-all" ] } };
+
+  var nodesOfType = function (nodes, type) {
+    return nodes.filter(function (node) {
+      return node.type === type;
+    });
+  };
+
+  return {
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief set up
+////////////////////////////////////////////////////////////////////////////////
+
+    setUp : function () {
+      db._drop(cn);
+      c = db._create(cn);
+
+      for (var i = 0; i < 10; ++i) {
+        c.save({ value: i });
+      }
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief tear down
+////////////////////////////////////////////////////////////////////////////////
+
+    tearDown : function () {
+      db._drop(cn);
+      c = null;
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test that no plan is returned without profiling
+////////////////////////////////////////////////////////////////////////////////
+
+    testNoProfile : function () {
+      var result = AQL_EXECUTE("FOR doc IN " + cn + " RETURN doc.value", { }, { cache: false });
+      assertEqual(10, result.json.length);
+      assertUndefined(result.plan);
+      assertFalse(result.stats.hasOwnProperty("nodes"));
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test that all nodes of the plan are profiled
+////////////////////////////////////////////////////////////////////////////////
+
+    testAllNodesProfiled : function () {
+      var result = AQL_EXECUTE("FOR doc IN " + cn + " RETURN doc.value", { }, options);
+      assertEqual(10, result.json.length);
+      assertTrue(Array.isArray(result.plan.nodes));
+      assertFalse(result.stats.hasOwnProperty("nodes"));
+
+      result.plan.nodes.forEach(function (node) {
+        assertTrue(node.hasOwnProperty("profile"));
+        assertTrue(node.profile.calls > 0);
+        assertTrue(node.profile.runtime >= 0);
+        assertTrue(node.profile.memory >= 0);
+      });
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test the number of items consumed and produced by the nodes
+////////////////////////////////////////////////////////////////////////////////
+
+    testItems : function () {
+      var result = AQL_EXECUTE("FOR doc IN " + cn + " FILTER doc.value >= 6 RETURN doc.value", { }, options);
+      assertEqual(4, result.json.length);
+
+      var nodes = result.plan.nodes;
+
+      var singleton = nodesOfType(nodes, "SingletonNode");
+      assertEqual(1, singleton.length);
+      assertEqual(0, singleton[0].profile.itemsIn);
+      assertEqual(1, singleton[0].profile.itemsOut);
+
+      var enumerate = nodesOfType(nodes, "EnumerateCollectionNode");
+      assertEqual(1, enumerate.length);
+      assertEqual(1, enumerate[0].profile.itemsIn);
+      assertEqual(10, enumerate[0].profile.itemsOut);
+      assertTrue(enumerate[0].profile.memory > 0);
+
+      var filter = nodesOfType(nodes, "FilterNode");
+      assertEqual(1, filter.length);
+      assertEqual(10, filter[0].profile.itemsIn);
+      assertEqual(4, filter[0].profile.itemsOut);
+
+      var ret = nodesOfType(nodes, "ReturnNode");
+      assertEqual(1, ret.length);
+      assertEqual(4, ret[0].profile.itemsIn);
+      assertEqual(4, ret[0].profile.itemsOut);
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test that a limit reduces the number of items produced
+////////////////////////////////////////////////////////////////////////////////
+
+    testLimit : function () {
+      var result = AQL_EXECUTE("FOR doc IN " + cn + " LIMIT 2, 3 RETURN doc.value", { }, options);
+      assertEqual(3, result.json.length);
+
+      var limit = nodesOfType(result.plan.nodes, "LimitNode");
+      assertEqual(1, limit.length);
+      assertEqual(3, limit[0].profile.itemsOut);
+      
+      var ret = nodesOfType(result.plan.nodes, "ReturnNode");
+      assertEqual(3, ret[0].profile.itemsOut);
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test that the nodes of subqueries are profiled
+////////////////////////////////////////////////////////////////////////////////
+
+    testSubquery : function () {
+      var result = AQL_EXECUTE("FOR i IN 1..3 LET sub = (FOR doc IN " + cn + " RETURN doc.value) RETURN LENGTH(sub)", { }, options);
+      assertEqual([ 10, 10, 10 ], result.json);
+
+      var subquery = nodesOfType(result.plan.nodes, "SubqueryNode");
+      assertEqual(1, subquery.length);
+      assertEqual(3, subquery[0].profile.itemsOut);
+
+      var enumerate = nodesOfType(subquery[0].subquery.nodes, "EnumerateCollectionNode");
+      assertEqual(1, enumerate.length);
+      assertEqual(30, enumerate[0].profile.itemsOut);
+    }
+
+  };
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief executes the test suite
+////////////////////////////////////////////////////////////////////////////////
+
+jsunity.run(ahuacatlProfilerTestSuite);
+
+return jsunity.done();
+
+// Local Variables:
+// mode: outline-minor
+// outline-regexp: "^\\(/// @brief\\|/// @addtogroup\\|// --SECTION--\\|/// @page\\|/// @}\\)"
+// End:
@@ -0,0 +1,138 @@
+/*jshint globalstrict:false, strict:false, maxlen: 500 */
+/*global assertEqual, AQL_EXECUTE */
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief tests for sorting with a memory limit
+///
+/// @file
+///
+/// DISCLAIMER
+///
+/// Copyright 2010-2012 triagens GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is triAGENS GmbH, Cologne, Germany
+///
+/// @author Copyright 2015, triAGENS GmbH, Cologne, Germany
+////////////////////////////////////////////////////////////////////////////////
+
+var jsunity = require("jsunity");
+var db = require("org/arangodb").db;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test suite
+////////////////////////////////////////////////////////////////////////////////
+
+function sortMemoryLimitTestSuite () {
+  var c;
+  // the limits are small enough to make the sort spill many runs
+  var limits = [ 1, 1000, 50000 ];
+
+  var compare = function (query) {
+    var expected = AQL_EXECUTE(query).json;
+
+    limits.forEach(function(limit) {
+      var actual = AQL_EXECUTE(query, { }, { sortMemoryLimit: limit }).json;
+      assertEqual(expected, actual, query + ", sortMemoryLimit: " + limit);
+    });
+  };
+
+  return {
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief set up
+////////////////////////////////////////////////////////////////////////////////
+
+    setUp : function () {
+      db._drop("UnitTestsCollection");
+      c = db._create("UnitTestsCollection");
+
+      for (var i = 0; i < 3000; ++i) {
+        c.save({ value: i, group: i % 7, text: "test" + (i * 17 % 3000) });
+      }
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief tear down
+////////////////////////////////////////////////////////////////////////////////
+
+    tearDown : function () {
+      db._drop("UnitTestsCollection");
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test sorting documents
+////////////////////////////////////////////////////////////////////////////////
+
+    testSortDocuments : function () {
+      compare("FOR i IN " + c.name() + " SORT i.text RETURN i");
+      compare("FOR i IN " + c.name() + " SORT i.value DESC RETURN i.value");
+      compare("FOR i IN " + c.name() + " SORT i.group, i.value RETURN [ i.group, i.value ]");
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test sorting computed values
+////////////////////////////////////////////////////////////////////////////////
+
+    testSortComputed : function () {
+      compare("FOR i IN 1..5000 LET x = CONCAT('foo', i % 13) SORT x, i DESC RETURN { x: x, i: i }");
+      compare("FOR i IN 1..5000 SORT i % 11 RETURN i");
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test that the sort stays stable across spilled runs
+////////////////////////////////////////////////////////////////////////////////
+
+    testSortStable : function () {
+      var actual = AQL_EXECUTE("FOR i IN 1..3000 SORT i % 2 RETURN i", { }, { sortMemoryLimit: 1 }).json;
+
+      assertEqual(3000, actual.length);
+      for (var i = 0; i < 1500; ++i) {
+        assertEqual((i + 1) * 2, actual[i]);
+        assertEqual(i * 2 + 1, actual[1500 + i]);
+      }
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test sorts with a limit and in subqueries
+////////////////////////////////////////////////////////////////////////////////
+
+    testSortLimitAndSubquery : function () {
+      compare("FOR i IN " + c.name() + " SORT i.text LIMIT 100, 1000 RETURN i.text");
+      compare("FOR i IN 1..3 LET sub = (FOR j IN " + c.name() + " FILTER j.group == i SORT j.text DESC RETURN j.value) RETURN sub");
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test sorting empty input
+////////////////////////////////////////////////////////////////////////////////
+
+    testSortEmpty : function () {
+      compare("FOR i IN " + c.name() + " FILTER i.value < 0 SORT i.value RETURN i");
+    }
+
+  };
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief executes the test suite
+////////////////////////////////////////////////////////////////////////////////
+
+jsunity.run(sortMemoryLimitTestSuite);
+
+return jsunity.done();
+
+// Local Variables:
+// mode: outline-minor
+// outline-regexp: "^\\(/// @brief\\|/// @addtogroup\\|// --SECTION--\\|/// @page\\|/// @}\\)"
+// End:
@@ -0,0 +1,135 @@
+/*jshint globalstrict:false, strict:false, unused : false */
+/*global assertEqual, assertTrue */
+////////////////////////////////////////////////////////////////////////////////
+/// @brief tests for revision ids after recovery
+///
+/// @file
+///
+/// DISCLAIMER
+///
+/// Copyright 2010-2012 triagens GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is triAGENS GmbH, Cologne, Germany
+///
+/// @author Copyright 2015, triAGENS GmbH, Cologne, Germany
+////////////////////////////////////////////////////////////////////////////////
+
+var db = require("org/arangodb").db;
+var internal = require("internal");
+var jsunity = require("jsunity");
+
+
+function runSetup () {
+  'use strict';
+  internal.debugClearFailAt();
+  
+  db._drop("UnitTestsRecovery");
+  var c = db._create("UnitTestsRecovery");
+  var i;
+
+  for (i = 0; i < 1000; ++i) {
+    c.save({ _key: "test" + i, value: i });
+  }
+
+  db._executeTransaction({
+    collections: {
+      write: "UnitTestsRecovery"
+    },
+    action: function () {
+      var c = require("internal").db.UnitTestsRecovery;
+      var i;
+
+      for (i = 0; i < 1000; i += 2) {
+        c.update("test" + i, { value: i + 1 });
+      }
+    }
+  });
+
+  c.save({ _key: "crashme" }, true); // wait for sync
+
+  internal.debugSegfault("crashing server");
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief compares two revision ids. they are compared as strings because
+/// they may not fit into a number without losing precision
+////////////////////////////////////////////////////////////////////////////////
+
+function compareRevisions (lhs, rhs) {
+  'use strict';
+  if (lhs.length !== rhs.length) {
+    return lhs.length < rhs.length ? -1 : 1;
+  }
+  if (lhs === rhs) {
+    return 0;
+  }
+  return lhs < rhs ? -1 : 1;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test suite
+////////////////////////////////////////////////////////////////////////////////
+
+function recoverySuite () {
+  'use strict';
+  jsunity.jsUnity.attachAssertions();
+
+  return {
+    setUp: function () {
+    },
+    tearDown: function () {
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test whether new revision ids are greater than the recovered ones
+////////////////////////////////////////////////////////////////////////////////
+    
+    testRevisionIds : function () {
+      var c = db._collection("UnitTestsRecovery");
+      var max = "0";
+
+      assertEqual(1001, c.count());
+
+      c.toArray().forEach(function (doc) {
+        if (compareRevisions(max, doc._rev) < 0) {
+          max = doc._rev;
+        }
+      });
+
+      var rev = c.save({ _key: "new" })._rev;
+      assertEqual(1, compareRevisions(rev, max));
+
+      rev = c.update("test0", { value: 0 })._rev;
+      assertEqual(1, compareRevisions(rev, max));
+    }
+        
+  };
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief executes the test suite
+////////////////////////////////////////////////////////////////////////////////
+
+function main (argv) {
+  'use strict';
+  if (argv[1] === "setup") {
+    runSetup();
+    return 0;
+  }
+  else {
+    jsunity.run(recoverySuite);
+    return jsunity.done().status ? 0 : 1;
+  }
+}
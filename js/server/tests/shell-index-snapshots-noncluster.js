@@ -0,0 +1,265 @@
+/*jshint globalstrict:false, strict:false */
+/*global assertFalse, assertEqual */
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test loading collections from primary index snapshots
+///
+/// @file
+///
+/// the snapshots are only written if the server is started with
+/// `--database.index-snapshots true`. without it, the tests check that
+/// reloading collections from their datafiles yields the same state
+///
+/// DISCLAIMER
+///
+/// Copyright 2010-2012 triagens GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is triAGENS GmbH, Cologne, Germany
+///
+/// @author Copyright 2015, triAGENS GmbH, Cologne, Germany
+////////////////////////////////////////////////////////////////////////////////
+
+var jsunity = require("jsunity");
+
+var arangodb = require("org/arangodb");
+var db = arangodb.db;
+var fs = require("fs");
+var internal = require("internal");
+var ArangoCollection = require("org/arangodb/arango-collection").ArangoCollection;
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                   index snapshots
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test suite
+////////////////////////////////////////////////////////////////////////////////
+
+function IndexSnapshotsSuite () {
+  'use strict';
+  var cn = "UnitTestsIndexSnapshots";
+  var en = "UnitTestsIndexSnapshotsEdges";
+  var enabled = (internal.options()["database.index-snapshots"] === true);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief returns the name of the snapshot file of a collection
+////////////////////////////////////////////////////////////////////////////////
+
+  var snapshotFile = function (name) {
+    return fs.join(db._path(), "collection-" + db._collection(name)._id, "snapshot.db");
+  };
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief unloads a collection after all its WAL entries have been collected
+////////////////////////////////////////////////////////////////////////////////
+
+  var unload = function (name) {
+    internal.wal.flush(true, true);
+
+    db._collection(name).unload();
+    while (db._collection(name).status() !== ArangoCollection.STATUS_UNLOADED) {
+      internal.wait(0.1, false);
+    }
+
+    assertEqual(enabled, fs.exists(snapshotFile(name)));
+  };
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief loads a collection, which always removes its snapshot
+////////////////////////////////////////////////////////////////////////////////
+
+  var load = function (name) {
+    db._collection(name).load();
+    assertEqual(ArangoCollection.STATUS_LOADED, db._collection(name).status());
+    assertFalse(fs.exists(snapshotFile(name)));
+
+    return db._collection(name);
+  };
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief returns all documents of a collection, sorted by key
+////////////////////////////////////////////////////////////////////////////////
+
+  var documents = function (name) {
+    return db._query("FOR d IN @@cn SORT d._key RETURN d", { "@cn": name }).toArray();
+  };
+
+  return {
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief set up
+////////////////////////////////////////////////////////////////////////////////
+
+    setUp : function () {
+      db._drop(cn);
+      db._drop(en);
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief tear down
+////////////////////////////////////////////////////////////////////////////////
+
+    tearDown : function () {
+      db._drop(cn);
+      db._drop(en);
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test reloading documents
+////////////////////////////////////////////////////////////////////////////////
+
+    testReloadDocuments : function () {
+      var c = db._create(cn);
+      var i;
+
+      for (i = 0; i < 5000; ++i) {
+        c.save({ _key: "test" + i, value: i });
+      }
+      // removals and updates leave dead markers in the datafiles
+      for (i = 0; i < 5000; i += 3) {
+        c.remove("test" + i);
+      }
+      for (i = 1; i < 5000; i += 3) {
+        c.update("test" + i, { text: "updated" });
+      }
+      c.ensureHashIndex("value");
+
+      var expected = documents(cn);
+      var count = c.count();
+
+      unload(cn);
+      c = load(cn);
+
+      assertEqual(count, c.count());
+      assertEqual(expected, documents(cn));
+      assertEqual(1, c.byExample({ value: 4999 }).toArray().length);
+      assertEqual(0, c.byExample({ value: 3 }).toArray().length);
+      assertEqual("updated", c.document("test4").text);
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test reloading edges
+////////////////////////////////////////////////////////////////////////////////
+
+    testReloadEdges : function () {
+      var c = db._create(cn);
+      var e = db._createEdgeCollection(en);
+      var i;
+
+      for (i = 0; i < 100; ++i) {
+        c.save({ _key: "v" + i });
+      }
+      for (i = 0; i < 1000; ++i) {
+        e.save(cn + "/v" + (i % 100), cn + "/v" + ((i * 7) % 100), { value: i });
+      }
+
+      var expected = documents(en);
+
+      unload(en);
+      e = load(en);
+
+      assertEqual(1000, e.count());
+      assertEqual(expected, documents(en));
+      assertEqual(10, e.outEdges(cn + "/v1").length);
+      assertEqual(10, e.inEdges(cn + "/v7").length);
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test that the key generator continues after the last key
+////////////////////////////////////////////////////////////////////////////////
+
+    testReloadKeyGenerator : function () {
+      var c = db._create(cn, { keyOptions: { type: "autoincrement", offset: 0, increment: 1 } });
+      var i;
+
+      for (i = 0; i < 1000; ++i) {
+        c.save({ value: i });
+      }
+      // the last key is not taken from the last document
+      c.remove("1000");
+
+      unload(cn);
+      c = load(cn);
+
+      assertEqual("1001", c.save({ value: 1000 })._key);
+      assertEqual(1000, c.count());
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test that a snapshot is rejected after the journal was appended to
+////////////////////////////////////////////////////////////////////////////////
+
+    testRejectOutdatedSnapshot : function () {
+      var c = db._create(cn);
+      var i;
+
+      for (i = 0; i < 1000; ++i) {
+        c.save({ _key: "test" + i, value: i });
+      }
+
+      unload(cn);
+
+      var saved = snapshotFile(cn) + ".saved";
+
+      if (enabled) {
+        fs.copyFile(snapshotFile(cn), saved);
+      }
+
+      // append to the journal after the snapshot has been written
+      c = load(cn);
+
+      for (i = 1000; i < 1100; ++i) {
+        c.save({ _key: "test" + i, value: i });
+      }
+      c.remove("test0");
+
+      var expected = documents(cn);
+
+      unload(cn);
+
+      if (enabled) {
+        // put the outdated snapshot in place of the current one
+        fs.remove(snapshotFile(cn));
+        fs.copyFile(saved, snapshotFile(cn));
+        fs.remove(saved);
+      }
+
+      c = load(cn);
+
+      assertEqual(1099, c.count());
+      assertEqual(expected, documents(cn));
+      assertEqual(1099, c.document("test1099").value);
+      assertFalse(c.exists("test0"));
+    }
+
+  };
+}
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                              main
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief executes the test suite
+////////////////////////////////////////////////////////////////////////////////
+
+jsunity.run(IndexSnapshotsSuite);
+
+return jsunity.done();
+
+// Local Variables:
+// mode: outline-minor
+// outline-regexp: "^\\(/// @brief\\|/// @addtogroup\\|// --SECTION--\\|/// @\\}\\)"
+// End:
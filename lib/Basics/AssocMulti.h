@@ -38,6 +38,7 @@
 #include "Basics/Common.h"
 #include "Basics/prime-numbers.h"
 #include "Basics/logging.h"
+#include "Basics/numa.h"
 #include "Basics/Mutex.h"
 #include "Basics/MutexLocker.h"
 
@@ -162,6 +163,8 @@ namespace triagens {
         
         std::function<std::string()> _contextCallback;
 
+        int const _numaNode;  // NUMA node the tables are placed on
+
 // -----------------------------------------------------------------------------
 // --SECTION--                                      constructors and destructors
 // -----------------------------------------------------------------------------
@@ -179,7 +182,8 @@ namespace triagens {
                     IsEqualElementElementFuncType isEqualElementElementByKey,
                     size_t numberBuckets = 1,
                     IndexType initialSize = 64, 
-                    std::function<std::string()> contextCallback = [] () -> std::string { return ""; }) :
+                    std::function<std::string()> contextCallback = [] () -> std::string { return ""; },
+                    int numaNode = TRI_NUMA_NODE_ANY) :
 #ifdef TRI_INTERNAL_STATS
             _nrFinds(0), _nrAdds(0), _nrRems(0), _nrResizes(0),
             _nrProbes(0), _nrProbesF(0), _nrProbesD(0),
@@ -189,7 +193,8 @@ namespace triagens {
             _isEqualKeyElement(isEqualKeyElement),
             _isEqualElementElement(isEqualElementElement),
             _isEqualElementElementByKey(isEqualElementElementByKey),
-            _contextCallback(contextCallback) {
+            _contextCallback(contextCallback),
+            _numaNode(numaNode) {
 
           // Make the number of buckets a power of two:
           size_t ex = 0;
@@ -211,7 +216,7 @@ namespace triagens {
               b._table = nullptr;
 
               // may fail...
-              b._table = new Entry[b._nrAlloc];
+              b._table = allocateTable(b._nrAlloc);
 
               for (IndexType i = 0; i < b._nrAlloc; i++) {
                 invalidateEntry(b, i);
@@ -220,7 +225,7 @@ namespace triagens {
           }
           catch (...) {
             for (auto& b : _buckets) {
-              delete [] b._table;
+              freeTable(b._table, b._nrAlloc);
               b._table = nullptr;
               b._nrAlloc = 0;
             }
@@ -235,7 +240,7 @@ namespace triagens {
         ~AssocMulti () {
           for (auto& b : _buckets) {
             if (b._table != nullptr) {
-              delete [] b._table;
+              freeTable(b._table, b._nrAlloc);
               b._table = nullptr;
             }
           }
@@ -1023,6 +1028,29 @@ namespace triagens {
           return i < b._nrAlloc ? i : dummy;
         }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief allocate a table on the NUMA node of the index, throws if out of
+/// memory
+////////////////////////////////////////////////////////////////////////////////
+
+        Entry* allocateTable (IndexType size) const {
+          void* table = TRI_NumaAllocate(sizeof(Entry) * static_cast<size_t>(size), _numaNode, false);
+
+          if (table == nullptr) {
+            throw std::bad_alloc();
+          }
+
+          return static_cast<Entry*>(table);
+        }
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief free a table allocated with allocateTable
+////////////////////////////////////////////////////////////////////////////////
+
+        void freeTable (Entry* table, IndexType size) const {
+          TRI_NumaFree(table, sizeof(Entry) * static_cast<size_t>(size), _numaNode);
+        }
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief resize the array, internal method
 ////////////////////////////////////////////////////////////////////////////////
@@ -1038,7 +1066,8 @@ namespace triagens {
 
           b._nrAlloc = static_cast<IndexType>(TRI_NearPrime(size));
           try {
-            b._table = new Entry[b._nrAlloc];
+            b._table = allocateTable(b._nrAlloc);
+
             IndexType i;
             for (i = 0; i < b._nrAlloc; i++) {
               invalidateEntry(b, i);
@@ -1078,7 +1107,7 @@ namespace triagens {
             }
           }
 
-          delete [] oldTable;
+          freeTable(oldTable, oldAlloc);
           
           LOG_TIMER((TRI_microtime() - start),
                     "index-resize, %s, target size: %llu",
@@ -0,0 +1,143 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @brief token bucket rate limiter
+///
+/// @file
+///
+/// DISCLAIMER
+///
+/// Copyright 2014 ArangoDB GmbH, Cologne, Germany
+/// Copyright 2004-2014 triAGENS GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Jan Steemann
+/// @author Copyright 2015, ArangoDB GmbH, Cologne, Germany
+////////////////////////////////////////////////////////////////////////////////
+
+#include "RateLimiter.h"
+#include "Basics/MutexLocker.h"
+
+using namespace triagens::basics;
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                       RateLimiter
+// -----------------------------------------------------------------------------
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                        constructors / destructors
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief create a rate limiter with the specified number of units per second
+////////////////////////////////////////////////////////////////////////////////
+
+RateLimiter::RateLimiter (uint64_t rate)
+  : _lock(),
+    _rate(rate),
+    _tokens(static_cast<double>(rate)),
+    _lastRefill(TRI_microtime()) {
+
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief destroy the rate limiter
+////////////////////////////////////////////////////////////////////////////////
+
+RateLimiter::~RateLimiter () {
+}
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                  public functions
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief change the number of units per second. 0 means unlimited
+////////////////////////////////////////////////////////////////////////////////
+
+void RateLimiter::setRate (uint64_t rate) {
+  MUTEX_LOCKER(_lock);
+
+  _rate.store(rate, std::memory_order_relaxed);
+
+  if (_tokens > static_cast<double>(rate)) {
+    _tokens = static_cast<double>(rate);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief consume the specified number of units, sleeping if the rate limit
+/// has been exceeded. returns the time slept (in microseconds)
+////////////////////////////////////////////////////////////////////////////////
+
+uint64_t RateLimiter::consume (uint64_t units) {
+  if (units == 0 || rate() == 0) {
+    // unlimited
+    return 0;
+  }
+
+  uint64_t waitTime = 0;
+
+  {
+    MUTEX_LOCKER(_lock);
+
+    double const rate = static_cast<double>(_rate.load(std::memory_order_relaxed));
+
+    if (rate == 0.0) {
+      return 0;
+    }
+
+    // refill the bucket, but never above its capacity of one second
+    double const now = TRI_microtime();
+    _tokens += (now - _lastRefill) * rate;
+    _lastRefill = now;
+
+    if (_tokens > rate) {
+      _tokens = rate;
+    }
+
+    _tokens -= static_cast<double>(units);
+
+    if (_tokens < 0.0) {
+      // we are in debt. the debt is paid off by sleeping outside the lock, so
+      // other consumers queue up behind us and wait even longer
+      waitTime = static_cast<uint64_t>((- _tokens / rate) * 1000000.0);
+    }
+  }
+
+  // sleep in small chunks, as usleep() may not accept values of one second
+  // or more
+  uint64_t remaining = waitTime;
+
+  while (remaining > 0) {
+    uint64_t const sleepTime = (std::min)(remaining, static_cast<uint64_t>(500000));
+#ifdef _WIN32
+    usleep((unsigned long) sleepTime);
+#else
+    usleep((useconds_t) sleepTime);
+#endif
+    remaining -= sleepTime;
+  }
+
+  return waitTime;
+}
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                       END-OF-FILE
+// -----------------------------------------------------------------------------
+
+// Local Variables:
+// mode: outline-minor
+// outline-regexp: "/// @brief\\|/// {@inheritDoc}\\|/// @page\\|// --SECTION--\\|/// @\\}"
+// End:
@@ -0,0 +1,133 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @brief token bucket rate limiter
+///
+/// @file
+///
+/// DISCLAIMER
+///
+/// Copyright 2014 ArangoDB GmbH, Cologne, Germany
+/// Copyright 2004-2014 triAGENS GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Jan Steemann
+/// @author Copyright 2015, ArangoDB GmbH, Cologne, Germany
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef ARANGODB_BASICS_RATE_LIMITER_H
+#define ARANGODB_BASICS_RATE_LIMITER_H 1
+
+#include "Basics/Common.h"
+#include "Basics/Mutex.h"
+
+namespace triagens {
+  namespace basics {
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                       RateLimiter
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief a token bucket that limits the throughput of one or many threads
+/// to a number of units (e.g. bytes) per second. the bucket is refilled 
+/// continuously and can hold at most one second worth of units, so short
+/// bursts are allowed. callers that consume more units than are available
+/// go into debt and are put to sleep until the debt has been paid off
+////////////////////////////////////////////////////////////////////////////////
+
+    class RateLimiter {
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                        constructors / destructors
+// -----------------------------------------------------------------------------
+
+      public:
+
+        RateLimiter (RateLimiter const&) = delete;
+        RateLimiter& operator= (RateLimiter const&) = delete;
+
+        explicit RateLimiter (uint64_t);
+
+        ~RateLimiter ();
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                  public functions
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief return the number of units per second. 0 means unlimited
+////////////////////////////////////////////////////////////////////////////////
+
+        uint64_t rate () const {
+          return _rate.load(std::memory_order_relaxed);
+        }
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief change the number of units per second. 0 means unlimited
+////////////////////////////////////////////////////////////////////////////////
+
+        void setRate (uint64_t);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief consume the specified number of units, sleeping if the rate limit
+/// has been exceeded. returns the time slept (in microseconds)
+////////////////////////////////////////////////////////////////////////////////
+
+        uint64_t consume (uint64_t);
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                 private variables
+// -----------------------------------------------------------------------------
+
+      private:
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief protects the bucket
+////////////////////////////////////////////////////////////////////////////////
+
+        triagens::basics::Mutex _lock;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief units per second
+////////////////////////////////////////////////////////////////////////////////
+
+        std::atomic<uint64_t> _rate;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief units currently in the bucket. negative if in debt
+////////////////////////////////////////////////////////////////////////////////
+
+        double _tokens;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief time of last refill
+////////////////////////////////////////////////////////////////////////////////
+
+        double _lastRefill;
+    };
+
+  }
+}
+
+#endif
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                       END-OF-FILE
+// -----------------------------------------------------------------------------
+
+// Local Variables:
+// mode: outline-minor
+// outline-regexp: "/// @brief\\|/// {@inheritDoc}\\|/// @page\\|// --SECTION--\\|/// @\\}"
+// End:
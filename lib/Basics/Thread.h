@@ -152,6 +152,13 @@ namespace triagens {
 
        void setProcessorAffinity (size_t c);
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief sets the process affinity to a set of cores, e.g. all cores of a
+/// NUMA node
+////////////////////////////////////////////////////////////////////////////////
+
+       void setProcessorAffinity (std::vector<size_t> const& cores);
+
 // -----------------------------------------------------------------------------
 // --SECTION--                                                 protected methods
 // -----------------------------------------------------------------------------
@@ -260,10 +267,10 @@ namespace triagens {
         volatile sig_atomic_t _joined;
 
 ////////////////////////////////////////////////////////////////////////////////
-/// @brief processor affinity
+/// @brief processor affinity. empty if the thread may run on all cores
 ////////////////////////////////////////////////////////////////////////////////
 
-        int _affinity;
+        std::vector<size_t> _affinity;
 
     };
   }
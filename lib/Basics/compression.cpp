@@ -0,0 +1,356 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @brief fast block compression
+///
+/// @file
+///
+/// DISCLAIMER
+///
+/// Copyright 2014 ArangoDB GmbH, Cologne, Germany
+/// Copyright 2004-2014 triAGENS GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Jan Steemann
+/// @author Copyright 2015, ArangoDB GmbH, Cologne, Germany
+////////////////////////////////////////////////////////////////////////////////
+
+#include "compression.h"
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                 private variables
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief minimal length of a back-reference
+////////////////////////////////////////////////////////////////////////////////
+
+static size_t const MinMatch = 4;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief number of bytes at the end of a block that are always literals
+////////////////////////////////////////////////////////////////////////////////
+
+static size_t const LastLiterals = 5;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief no back-reference may start within this many bytes from the end
+////////////////////////////////////////////////////////////////////////////////
+
+static size_t const MatchFindLimit = 12;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief maximal distance of a back-reference
+////////////////////////////////////////////////////////////////////////////////
+
+static size_t const MaxOffset = 65535;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief number of bits of the hash table used to find back-references
+////////////////////////////////////////////////////////////////////////////////
+
+static int const HashLog = 12;
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                 private functions
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief reads 4 possibly unaligned bytes
+////////////////////////////////////////////////////////////////////////////////
+
+static inline uint32_t Read32 (uint8_t const* p) {
+  uint32_t value;
+  memcpy(&value, p, sizeof(value));
+
+  return value;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief hashes 4 bytes into a slot of the hash table
+////////////////////////////////////////////////////////////////////////////////
+
+static inline uint32_t HashSequence (uint32_t sequence) {
+  return (sequence * 2654435761U) >> (32 - HashLog);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief writes the extension bytes of a length that does not fit into the
+/// 4 bits of the token
+////////////////////////////////////////////////////////////////////////////////
+
+static inline uint8_t* WriteLength (uint8_t* out,
+                                    size_t length) {
+  while (length >= 255) {
+    *out++ = 255;
+    length -= 255;
+  }
+
+  *out++ = static_cast<uint8_t>(length);
+
+  return out;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief reads the extension bytes of a length. returns false if the input
+/// ends prematurely
+////////////////////////////////////////////////////////////////////////////////
+
+static inline bool ReadLength (uint8_t const*& in,
+                               uint8_t const* end,
+                               size_t& length) {
+  uint8_t b;
+
+  do {
+    if (in >= end) {
+      return false;
+    }
+
+    b = *in++;
+    length += b;
+  }
+  while (b == 255);
+
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief writes a sequence of literals, optionally followed by a
+/// back-reference. returns nullptr if the output buffer is too small
+////////////////////////////////////////////////////////////////////////////////
+
+static uint8_t* WriteSequence (uint8_t* out,
+                               uint8_t const* outEnd,
+                               uint8_t const* literals,
+                               size_t literalLength,
+                               size_t offset,
+                               size_t matchLength) {
+  // token, length extensions, literals and offset
+  size_t const needed = 1 + (literalLength / 255 + 1) + literalLength + 2 + (matchLength / 255 + 1);
+
+  if (needed > static_cast<size_t>(outEnd - out)) {
+    return nullptr;
+  }
+
+  uint8_t* token = out++;
+
+  if (literalLength >= 15) {
+    *token = 15 << 4;
+    out = WriteLength(out, literalLength - 15);
+  }
+  else {
+    *token = static_cast<uint8_t>(literalLength << 4);
+  }
+
+  memcpy(out, literals, literalLength);
+  out += literalLength;
+
+  if (matchLength == 0) {
+    // last sequence, consisting of literals only
+    return out;
+  }
+
+  *out++ = static_cast<uint8_t>(offset & 0xff);
+  *out++ = static_cast<uint8_t>(offset >> 8);
+
+  matchLength -= MinMatch;
+
+  if (matchLength >= 15) {
+    *token |= 15;
+    out = WriteLength(out, matchLength - 15);
+  }
+  else {
+    *token |= static_cast<uint8_t>(matchLength);
+  }
+
+  return out;
+}
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                  public functions
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief returns the maximal size of a compressed block
+////////////////////////////////////////////////////////////////////////////////
+
+size_t TRI_MaxCompressedSizeBlock (size_t length) {
+  return length + length / 255 + 16;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief compresses a block
+////////////////////////////////////////////////////////////////////////////////
+
+size_t TRI_CompressBlock (char const* source,
+                          size_t sourceLength,
+                          char* dest,
+                          size_t destLength) {
+  uint8_t const* const src = reinterpret_cast<uint8_t const*>(source);
+  uint8_t const* const srcEnd = src + sourceLength;
+  uint8_t* out = reinterpret_cast<uint8_t*>(dest);
+  uint8_t const* const outEnd = out + destLength;
+  uint8_t const* anchor = src;
+
+  if (sourceLength > MatchFindLimit && sourceLength < UINT32_MAX) {
+    // positions of previously seen sequences, plus one. 0 means empty
+    uint32_t table[1 << HashLog];
+    memset(table, 0, sizeof(table));
+
+    uint8_t const* const matchLimit = srcEnd - LastLiterals;
+    uint8_t const* const searchLimit = srcEnd - MatchFindLimit;
+    uint8_t const* ip = src;
+
+    while (ip < searchLimit) {
+      uint32_t const sequence = Read32(ip);
+      uint32_t const h = HashSequence(sequence);
+      uint32_t const candidate = table[h];
+
+      table[h] = static_cast<uint32_t>(ip - src) + 1;
+
+      if (candidate == 0) {
+        ++ip;
+        continue;
+      }
+
+      uint8_t const* ref = src + candidate - 1;
+
+      if (static_cast<size_t>(ip - ref) > MaxOffset ||
+          Read32(ref) != sequence) {
+        ++ip;
+        continue;
+      }
+
+      // extend the match backwards into the pending literals
+      while (ip > anchor && ref > src && ip[-1] == ref[-1]) {
+        --ip;
+        --ref;
+      }
+
+      // and forwards
+      uint8_t const* end = ip + MinMatch;
+      uint8_t const* refEnd = ref + MinMatch;
+
+      while (end < matchLimit && *end == *refEnd) {
+        ++end;
+        ++refEnd;
+      }
+
+      out = WriteSequence(out, outEnd, anchor, static_cast<size_t>(ip - anchor), static_cast<size_t>(ip - ref), static_cast<size_t>(end - ip));
+
+      if (out == nullptr) {
+        return 0;
+      }
+
+      ip = end;
+      anchor = ip;
+    }
+  }
+
+  out = WriteSequence(out, outEnd, anchor, static_cast<size_t>(srcEnd - anchor), 0, 0);
+
+  if (out == nullptr) {
+    return 0;
+  }
+
+  return static_cast<size_t>(out - reinterpret_cast<uint8_t*>(dest));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief decompresses a block
+////////////////////////////////////////////////////////////////////////////////
+
+bool TRI_DecompressBlock (char const* source,
+                          size_t sourceLength,
+                          char* dest,
+                          size_t destLength) {
+  uint8_t const* in = reinterpret_cast<uint8_t const*>(source);
+  uint8_t const* const inEnd = in + sourceLength;
+  uint8_t* const dst = reinterpret_cast<uint8_t*>(dest);
+  uint8_t* out = dst;
+  uint8_t const* const outEnd = out + destLength;
+
+  while (in < inEnd) {
+    uint8_t const token = *in++;
+
+    // literals
+    size_t length = token >> 4;
+
+    if (length == 15 && ! ReadLength(in, inEnd, length)) {
+      return false;
+    }
+
+    if (length > static_cast<size_t>(inEnd - in) ||
+        length > static_cast<size_t>(outEnd - out)) {
+      return false;
+    }
+
+    memcpy(out, in, length);
+    in += length;
+    out += length;
+
+    if (in == inEnd) {
+      // the last sequence has no back-reference
+      return (out == outEnd);
+    }
+
+    // back-reference
+    if (inEnd - in < 2) {
+      return false;
+    }
+
+    size_t const offset = static_cast<size_t>(in[0]) | (static_cast<size_t>(in[1]) << 8);
+    in += 2;
+
+    if (offset == 0 || offset > static_cast<size_t>(out - dst)) {
+      return false;
+    }
+
+    length = token & 15;
+
+    if (length == 15 && ! ReadLength(in, inEnd, length)) {
+      return false;
+    }
+
+    length += MinMatch;
+
+    if (length > static_cast<size_t>(outEnd - out)) {
+      return false;
+    }
+
+    uint8_t const* ref = out - offset;
+
+    if (offset >= length) {
+      memcpy(out, ref, length);
+      out += length;
+    }
+    else {
+      // the match overlaps with its own output
+      for (size_t i = 0; i < length; ++i) {
+        *out++ = *ref++;
+      }
+    }
+  }
+
+  return false;
+}
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                       END-OF-FILE
+// -----------------------------------------------------------------------------
+
+// Local Variables:
+// mode: outline-minor
+// outline-regexp: "/// @brief\\|/// {@inheritDoc}\\|/// @page\\|// --SECTION--\\|/// @\\}"
+// End:
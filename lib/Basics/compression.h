@@ -0,0 +1,87 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @brief fast block compression
+///
+/// @file
+///
+/// DISCLAIMER
+///
+/// Copyright 2014 ArangoDB GmbH, Cologne, Germany
+/// Copyright 2004-2014 triAGENS GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Jan Steemann
+/// @author Copyright 2015, ArangoDB GmbH, Cologne, Germany
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef ARANGODB_BASICS_C_COMPRESSION_H
+#define ARANGODB_BASICS_C_COMPRESSION_H 1
+
+#include "Basics/Common.h"
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                 block compression
+// -----------------------------------------------------------------------------
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                  public functions
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief returns the maximal size of a compressed block
+///
+/// a buffer of this size is always large enough to compress a block of the
+/// specified size
+////////////////////////////////////////////////////////////////////////////////
+
+size_t TRI_MaxCompressedSizeBlock (size_t);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief compresses a block
+///
+/// the block is compressed with an LZ77-style codec that is optimized for
+/// speed rather than compression ratio. it uses the LZ4 block format, i.e. a
+/// sequence of literal runs and back-references of up to 64 KB. returns the
+/// size of the compressed data, or 0 if the compressed data does not fit into
+/// the output buffer
+////////////////////////////////////////////////////////////////////////////////
+
+size_t TRI_CompressBlock (char const*,
+                          size_t,
+                          char*,
+                          size_t);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief decompresses a block
+///
+/// the size of the output buffer must be exactly the size of the original
+/// data. returns false if the compressed data are corrupt
+////////////////////////////////////////////////////////////////////////////////
+
+bool TRI_DecompressBlock (char const*,
+                          size_t,
+                          char*,
+                          size_t);
+
+#endif
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                       END-OF-FILE
+// -----------------------------------------------------------------------------
+
+// Local Variables:
+// mode: outline-minor
+// outline-regexp: "/// @brief\\|/// {@inheritDoc}\\|/// @page\\|// --SECTION--\\|/// @\\}"
+// End:
@@ -29,6 +29,12 @@
 
 #include "hashes.h"
 
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define TRI_HAVE_SSE42_CRC32C 1
+#include <cpuid.h>
+#include <nmmintrin.h>
+#endif
+
 // -----------------------------------------------------------------------------
 // --SECTION--                                                               FNV
 // -----------------------------------------------------------------------------
@@ -524,6 +530,185 @@ uint32_t TRI_Crc32HashString (char const* data) {
   return TRI_FinalCrc32(crc);
 }
 
+// -----------------------------------------------------------------------------
+// --SECTION--                                                            CRC32C
+// -----------------------------------------------------------------------------
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                 private variables
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief precomputed lookup values for crc32c 8 bytes-at-a-time calculation
+////////////////////////////////////////////////////////////////////////////////
+
+static uint32_t Crc32CLookup[8][256];
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief whether or not the CPU supports the SSE 4.2 crc32 instruction
+////////////////////////////////////////////////////////////////////////////////
+
+static bool HasHardwareCrc32C = false;
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                 private functions
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief generates the CRC32C lookup tables
+////////////////////////////////////////////////////////////////////////////////
+
+static void GenerateCrc32CLookup () {
+  // reflected Castagnoli polynomial
+  uint32_t const polynomial = 0x82F63B78;
+
+  for (uint32_t i = 0; i < 256; ++i) {
+    uint32_t value = i;
+
+    for (int j = 0; j < 8; ++j) {
+      value = (value >> 1) ^ ((value & 1) ? polynomial : 0);
+    }
+
+    Crc32CLookup[0][i] = value;
+  }
+
+  for (uint32_t i = 0; i < 256; ++i) {
+    for (int j = 1; j < 8; ++j) {
+      uint32_t const previous = Crc32CLookup[j - 1][i];
+      Crc32CLookup[j][i] = (previous >> 8) ^ Crc32CLookup[0][previous & 0xFF];
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief CRC32C value of data block, using the lookup tables
+///
+/// this uses the same slicing-by-8 algorithm as TRI_BlockCrc32
+////////////////////////////////////////////////////////////////////////////////
+
+static uint32_t SoftwareBlockCrc32C (uint32_t value, char const* data, size_t length) {
+  uint8_t const* currentChar = (uint8_t const*) data;
+
+  // process eight bytes at once
+  while (length >= 8) {
+    uint32_t one;
+    uint32_t two;
+    memcpy(&one, currentChar, sizeof(uint32_t));
+    memcpy(&two, currentChar + sizeof(uint32_t), sizeof(uint32_t));
+    one ^= value;
+
+    value = Crc32CLookup[0][(two>>24) & 0xFF] ^
+            Crc32CLookup[1][(two>>16) & 0xFF] ^
+            Crc32CLookup[2][(two>> 8) & 0xFF] ^
+            Crc32CLookup[3][ two      & 0xFF] ^
+            Crc32CLookup[4][(one>>24) & 0xFF] ^
+            Crc32CLookup[5][(one>>16) & 0xFF] ^
+            Crc32CLookup[6][(one>> 8) & 0xFF] ^
+            Crc32CLookup[7][ one      & 0xFF];
+    currentChar += 8;
+    length -= 8;
+  }
+
+  // remaining 1 to 7 bytes (standard CRC table-based algorithm)
+  while (length--) {
+    value = (value >> 8) ^ Crc32CLookup[0][(value & 0xFF) ^ *currentChar++];
+  }
+
+  return value;
+}
+
+#ifdef TRI_HAVE_SSE42_CRC32C
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief CRC32C value of data block, using the SSE 4.2 crc32 instruction
+///
+/// this function is compiled for SSE 4.2 regardless of the compiler options,
+/// so it must only be called if the CPU supports it
+////////////////////////////////////////////////////////////////////////////////
+
+__attribute__((target("sse4.2")))
+static uint32_t HardwareBlockCrc32C (uint32_t value, char const* data, size_t length) {
+  uint8_t const* currentChar = (uint8_t const*) data;
+
+  // process single bytes until the data is 8-byte aligned
+  while (length > 0 && (reinterpret_cast<uintptr_t>(currentChar) & 7) != 0) {
+    value = _mm_crc32_u8(value, *currentChar++);
+    --length;
+  }
+
+  // process eight bytes at once
+  uint64_t value64 = value;
+
+  while (length >= 8) {
+    value64 = _mm_crc32_u64(value64, *reinterpret_cast<uint64_t const*>(currentChar));
+    currentChar += 8;
+    length -= 8;
+  }
+
+  value = static_cast<uint32_t>(value64);
+
+  // remaining 1 to 7 bytes
+  while (length--) {
+    value = _mm_crc32_u8(value, *currentChar++);
+  }
+
+  return value;
+}
+
+#endif
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief check whether the CPU supports the SSE 4.2 crc32 instruction
+////////////////////////////////////////////////////////////////////////////////
+
+static bool DetectHardwareCrc32C () {
+#ifdef TRI_HAVE_SSE42_CRC32C
+  unsigned int eax, ebx, ecx, edx;
+
+  if (__get_cpuid(1, &eax, &ebx, &ecx, &edx) == 0) {
+    return false;
+  }
+
+  return ((ecx & bit_SSE4_2) != 0);
+#else
+  return false;
+#endif
+}
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                  public functions
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief CRC32C (Castagnoli) value of data block
+////////////////////////////////////////////////////////////////////////////////
+
+uint32_t TRI_BlockCrc32C (uint32_t value, char const* data, size_t length) {
+#ifdef TRI_HAVE_SSE42_CRC32C
+  if (HasHardwareCrc32C) {
+    return HardwareBlockCrc32C(value, data, length);
+  }
+#endif
+
+  return SoftwareBlockCrc32C(value, data, length);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief CRC32C value of data block, always using the lookup tables
+////////////////////////////////////////////////////////////////////////////////
+
+uint32_t TRI_SoftwareBlockCrc32C (uint32_t value, char const* data, size_t length) {
+  return SoftwareBlockCrc32C(value, data, length);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief whether or not CRC32C is calculated with CPU instructions
+////////////////////////////////////////////////////////////////////////////////
+
+bool TRI_HasHardwareCrc32C () {
+  return HasHardwareCrc32C;
+}
+
 // -----------------------------------------------------------------------------
 // --SECTION--                                                            MODULE
 // -----------------------------------------------------------------------------
@@ -552,6 +737,8 @@ void TRI_InitialiseHashes () {
   }
 
   GenerateCrc32Polynomial();
+  GenerateCrc32CLookup();
+  HasHardwareCrc32C = DetectHardwareCrc32C();
 
   Initialised = true;
 }
@@ -102,6 +102,37 @@ uint32_t TRI_Crc32HashPointer (void const*, size_t);
 
 uint32_t TRI_Crc32HashString (char const*);
 
+// -----------------------------------------------------------------------------
+// --SECTION--                                                            CRC32C
+// -----------------------------------------------------------------------------
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                  public functions
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief CRC32C (Castagnoli) value of data block
+///
+/// the initial and final values are the same as for CRC32, so
+/// TRI_InitialCrc32() and TRI_FinalCrc32() can be used
+////////////////////////////////////////////////////////////////////////////////
+
+uint32_t TRI_BlockCrc32C (uint32_t, char const* data, size_t length);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief CRC32C value of data block, always using the lookup tables
+///
+/// this is the fallback of TRI_BlockCrc32C on CPUs without SSE 4.2
+////////////////////////////////////////////////////////////////////////////////
+
+uint32_t TRI_SoftwareBlockCrc32C (uint32_t, char const* data, size_t length);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief whether or not CRC32C is calculated with CPU instructions
+////////////////////////////////////////////////////////////////////////////////
+
+bool TRI_HasHardwareCrc32C ();
+
 // -----------------------------------------------------------------------------
 // --SECTION--                                                            MODULE
 // -----------------------------------------------------------------------------
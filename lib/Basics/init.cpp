@@ -32,6 +32,7 @@
 #include "Basics/files.h"
 #include "Basics/hashes.h"
 #include "Basics/logging.h"
+#include "Basics/numa.h"
 #include "Basics/process-utils.h"
 #include "Basics/random.h"
 
@@ -53,6 +54,7 @@ void TRI_InitialiseC (int argc, char* argv[]) {
   TRI_InitialiseHashes();
   TRI_InitialiseRandom();
   TRI_InitialiseProcess(argc, argv);
+  TRI_InitialiseNuma();
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -151,6 +151,32 @@ int TRI_ProtectMMFile (void* memoryAddress,
   return TRI_ERROR_SYS_ERROR;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+// @brief give an access pattern hint for a region in a memory-mapped file
+////////////////////////////////////////////////////////////////////////////////
+
+int TRI_MMFileAdvise (void* memoryAddress,
+                      size_t numOfBytes,
+                      int advice) {
+  if (numOfBytes == 0) {
+    return TRI_ERROR_NO_ERROR;
+  }
+
+  int res = madvise(memoryAddress, numOfBytes, advice);
+
+  if (res == 0) {
+    return TRI_ERROR_NO_ERROR;
+  }
+
+  LOG_DEBUG("madvise %d for %llu bytes at %p failed: %s",
+            advice,
+            (unsigned long long) numOfBytes,
+            memoryAddress,
+            strerror(errno));
+
+  return TRI_ERROR_SYS_ERROR;
+}
+
 #endif
 
 // -----------------------------------------------------------------------------
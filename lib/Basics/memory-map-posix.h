@@ -49,6 +49,16 @@
 #define TRI_MMAP_ANONYMOUS MAP_ANON
 #endif
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief access pattern hints for memory mapped files
+////////////////////////////////////////////////////////////////////////////////
+
+#define TRI_MADVISE_NORMAL      MADV_NORMAL
+#define TRI_MADVISE_SEQUENTIAL  MADV_SEQUENTIAL
+#define TRI_MADVISE_RANDOM      MADV_RANDOM
+#define TRI_MADVISE_WILLNEED    MADV_WILLNEED
+#define TRI_MADVISE_DONTNEED    MADV_DONTNEED
+
 #endif
 
 #endif
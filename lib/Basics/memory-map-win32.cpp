@@ -335,6 +335,17 @@ int TRI_ProtectMMFile (void* memoryAddress,
   return TRI_ERROR_NO_ERROR;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief gives an access pattern hint for a memory mapped region. this is
+/// not supported under windows
+////////////////////////////////////////////////////////////////////////////////
+
+int TRI_MMFileAdvise (void* memoryAddress,
+                      size_t numOfBytes,
+                      int advice) {
+  return TRI_ERROR_NO_ERROR;
+}
+
 
 #endif
 
@@ -66,6 +66,16 @@
 #define MS_INVALIDATE   2             /* invalidate the caches */
 #define MS_SYNC         4             /* synchronous memory sync */
 
+////////////////////////////////////////////////////////////////////////////////
+// Access pattern hints, which are ignored under windows.
+////////////////////////////////////////////////////////////////////////////////
+
+#define TRI_MADVISE_NORMAL      0
+#define TRI_MADVISE_SEQUENTIAL  1
+#define TRI_MADVISE_RANDOM      2
+#define TRI_MADVISE_WILLNEED    3
+#define TRI_MADVISE_DONTNEED    4
+
 
 
 #define PROT_READ       0x1             /* Page can be read.  */
@@ -103,6 +103,19 @@ int TRI_ProtectMMFile (void* memoryAddress,
                        int fileDescriptor,
                        void** mmHandle);
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief gives the kernel a hint about the access pattern of a region in a
+/// memory mapped file
+///
+/// advice is one of the TRI_MADVISE_* values. the memory address must be
+/// aligned to the page size. this is a hint only and is ignored on platforms
+/// that do not support it
+////////////////////////////////////////////////////////////////////////////////
+
+int TRI_MMFileAdvise (void* memoryAddress,
+                      size_t numOfBytes,
+                      int advice);
+
 #endif
 
 // -----------------------------------------------------------------------------
@@ -0,0 +1,339 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @brief NUMA topology and memory placement
+///
+/// @file
+///
+/// DISCLAIMER
+///
+/// Copyright 2014 ArangoDB GmbH, Cologne, Germany
+/// Copyright 2004-2014 triAGENS GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Jan Steemann
+/// @author Copyright 2015, ArangoDB GmbH, Cologne, Germany
+////////////////////////////////////////////////////////////////////////////////
+
+#include "numa.h"
+
+#ifdef TRI_HAVE_LINUX_PROC
+#include <fstream>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#endif
+
+#include "Basics/files.h"
+#include "Basics/logging.h"
+#include "Basics/system-functions.h"
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                 private variables
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief the processors of each NUMA node
+////////////////////////////////////////////////////////////////////////////////
+
+static std::vector<std::vector<size_t>> NodeProcessors;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief whether or not NUMA-aware allocation is turned on
+////////////////////////////////////////////////////////////////////////////////
+
+static std::atomic<bool> NumaAwareAllocation(false);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief the page size
+////////////////////////////////////////////////////////////////////////////////
+
+static size_t PageSize = 4096;
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                 private functions
+// -----------------------------------------------------------------------------
+
+#ifdef TRI_HAVE_LINUX_PROC
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief parses a processor list as found in sysfs, e.g. "0-3,8-11"
+////////////////////////////////////////////////////////////////////////////////
+
+static std::vector<size_t> ParseProcessorList (std::string const& list) {
+  std::vector<size_t> result;
+
+  char const* p = list.c_str();
+
+  while (*p != '\0') {
+    char* end;
+    unsigned long from = strtoul(p, &end, 10);
+
+    if (end == p) {
+      break;
+    }
+
+    unsigned long to = from;
+    p = end;
+
+    if (*p == '-') {
+      ++p;
+      to = strtoul(p, &end, 10);
+
+      if (end == p) {
+        break;
+      }
+
+      p = end;
+    }
+
+    for (unsigned long i = from; i <= to; ++i) {
+      result.emplace_back(static_cast<size_t>(i));
+    }
+
+    if (*p != ',') {
+      break;
+    }
+
+    ++p;
+  }
+
+  return result;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief reads the NUMA topology from sysfs
+////////////////////////////////////////////////////////////////////////////////
+
+static void ReadTopology () {
+  for (size_t node = 0; ; ++node) {
+    std::string const path = "/sys/devices/system/node/node" + std::to_string(node);
+
+    if (! TRI_IsDirectory(path.c_str())) {
+      break;
+    }
+
+    std::ifstream file(path + "/cpulist");
+    std::string list;
+
+    if (! file || ! std::getline(file, list)) {
+      break;
+    }
+
+    NodeProcessors.emplace_back(ParseProcessorList(list));
+  }
+}
+
+#endif
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                  public functions
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief returns the number of NUMA nodes of the machine
+////////////////////////////////////////////////////////////////////////////////
+
+size_t TRI_NumberNumaNodes () {
+  return NodeProcessors.size();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief returns the processors that belong to a NUMA node
+////////////////////////////////////////////////////////////////////////////////
+
+std::vector<size_t> TRI_NumaNodeProcessors (size_t node) {
+  if (node >= NodeProcessors.size()) {
+    return std::vector<size_t>();
+  }
+
+  return NodeProcessors[node];
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief turns NUMA-aware allocation on or off
+////////////////////////////////////////////////////////////////////////////////
+
+void TRI_SetNumaAwareAllocation (bool value) {
+  NumaAwareAllocation.store(value);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief returns the NUMA node that should hold the memory of an object
+////////////////////////////////////////////////////////////////////////////////
+
+int TRI_NumaHomeNode (uint64_t id) {
+  size_t const n = NodeProcessors.size();
+
+  if (n <= 1 || ! NumaAwareAllocation.load(std::memory_order_relaxed)) {
+    return TRI_NUMA_NODE_ANY;
+  }
+
+  return static_cast<int>(id % n);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief asks the kernel to place a memory region on a NUMA node
+////////////////////////////////////////////////////////////////////////////////
+
+void TRI_NumaBindMemory (void* memoryAddress,
+                         size_t numOfBytes,
+                         int node) {
+  if (node == TRI_NUMA_NODE_ANY || memoryAddress == nullptr) {
+    return;
+  }
+
+#if defined(TRI_HAVE_LINUX_PROC) && defined(SYS_mbind)
+
+  // constants from linux/mempolicy.h, which is not always installed
+  static int const MpolPreferred = 1;
+  static unsigned long const MpolMfMove = (1 << 1);
+
+  static size_t const MaskBits = 8 * sizeof(unsigned long);
+
+  if (static_cast<size_t>(node) >= NodeProcessors.size()) {
+    return;
+  }
+
+  // mbind requires page-aligned regions
+  uintptr_t begin = reinterpret_cast<uintptr_t>(memoryAddress);
+  uintptr_t end   = begin + numOfBytes;
+
+  begin = (begin + PageSize - 1) & ~(static_cast<uintptr_t>(PageSize) - 1);
+  end &= ~(static_cast<uintptr_t>(PageSize) - 1);
+
+  if (end <= begin) {
+    return;
+  }
+
+  unsigned long mask[16] = { 0 };
+
+  if (static_cast<size_t>(node) >= sizeof(mask) * 8) {
+    return;
+  }
+
+  mask[node / MaskBits] |= (1UL << (node % MaskBits));
+
+  // the kernel ignores the last bit of the mask
+  long res = syscall(SYS_mbind,
+                     reinterpret_cast<void*>(begin),
+                     static_cast<unsigned long>(end - begin),
+                     MpolPreferred,
+                     mask,
+                     static_cast<unsigned long>(sizeof(mask) * 8 + 1),
+                     MpolMfMove);
+
+  if (res != 0) {
+    LOG_DEBUG("mbind for memory range %p - %p failed: %s",
+              (void*) begin,
+              (void*) end,
+              strerror(errno));
+  }
+
+#endif
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief allocates memory that is placed on a NUMA node
+////////////////////////////////////////////////////////////////////////////////
+
+void* TRI_NumaAllocate (size_t numOfBytes,
+                        int node,
+                        bool zero) {
+#ifdef TRI_HAVE_LINUX_PROC
+  if (node != TRI_NUMA_NODE_ANY && numOfBytes > 0) {
+    void* result = mmap(nullptr, numOfBytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+    if (result == MAP_FAILED) {
+      return nullptr;
+    }
+
+    // the pages are not touched yet, so binding them places them on the node
+    // when they are first written
+    TRI_NumaBindMemory(result, numOfBytes, node);
+
+    return result;
+  }
+#endif
+
+  return TRI_Allocate(TRI_UNKNOWN_MEM_ZONE, numOfBytes, zero);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief frees memory allocated with TRI_NumaAllocate
+////////////////////////////////////////////////////////////////////////////////
+
+void TRI_NumaFree (void* memoryAddress,
+                   size_t numOfBytes,
+                   int node) {
+  if (memoryAddress == nullptr) {
+    return;
+  }
+
+#ifdef TRI_HAVE_LINUX_PROC
+  if (node != TRI_NUMA_NODE_ANY && numOfBytes > 0) {
+    if (munmap(memoryAddress, numOfBytes) != 0) {
+      LOG_DEBUG("munmap for memory range %p failed: %s", memoryAddress, strerror(errno));
+    }
+
+    return;
+  }
+#endif
+
+  TRI_Free(TRI_UNKNOWN_MEM_ZONE, memoryAddress);
+}
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                            modules initialisation
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief initialises the NUMA components
+////////////////////////////////////////////////////////////////////////////////
+
+void TRI_InitialiseNuma () {
+  if (! NodeProcessors.empty()) {
+    return;
+  }
+
+#ifdef TRI_HAVE_LINUX_PROC
+  long pageSize = sysconf(_SC_PAGESIZE);
+
+  if (pageSize > 0) {
+    PageSize = static_cast<size_t>(pageSize);
+  }
+
+  ReadTopology();
+#endif
+
+  if (NodeProcessors.empty()) {
+    // no NUMA or unknown topology: a single node containing all processors
+    std::vector<size_t> processors;
+    size_t const n = TRI_numberProcessors();
+
+    for (size_t i = 0; i < n; ++i) {
+      processors.emplace_back(i);
+    }
+
+    NodeProcessors.emplace_back(processors);
+  }
+}
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                       END-OF-FILE
+// -----------------------------------------------------------------------------
+
+// Local Variables:
+// mode: outline-minor
+// outline-regexp: "/// @brief\\|/// {@inheritDoc}\\|/// @page\\|// --SECTION--\\|/// @\\}"
+// End:
@@ -0,0 +1,136 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @brief NUMA topology and memory placement
+///
+/// @file
+///
+/// DISCLAIMER
+///
+/// Copyright 2014 ArangoDB GmbH, Cologne, Germany
+/// Copyright 2004-2014 triAGENS GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Jan Steemann
+/// @author Copyright 2015, ArangoDB GmbH, Cologne, Germany
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef ARANGODB_BASICS_C_NUMA_H
+#define ARANGODB_BASICS_C_NUMA_H 1
+
+#include "Basics/Common.h"
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                  public constants
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief placeholder for "no specific NUMA node"
+////////////////////////////////////////////////////////////////////////////////
+
+#define TRI_NUMA_NODE_ANY (-1)
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                  public functions
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief returns the number of NUMA nodes of the machine
+///
+/// this is 1 on machines without NUMA and on platforms on which the topology
+/// cannot be determined
+////////////////////////////////////////////////////////////////////////////////
+
+size_t TRI_NumberNumaNodes ();
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief returns the processors that belong to a NUMA node
+////////////////////////////////////////////////////////////////////////////////
+
+std::vector<size_t> TRI_NumaNodeProcessors (size_t);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief turns NUMA-aware allocation on or off
+////////////////////////////////////////////////////////////////////////////////
+
+void TRI_SetNumaAwareAllocation (bool);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief returns the NUMA node that should hold the memory of an object
+///
+/// objects are distributed round-robin over the NUMA nodes by their id.
+/// returns TRI_NUMA_NODE_ANY if NUMA-aware allocation is turned off or the
+/// machine has a single node only
+////////////////////////////////////////////////////////////////////////////////
+
+int TRI_NumaHomeNode (uint64_t);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief asks the kernel to place a memory region on a NUMA node
+///
+/// only the pages fully contained in the region are affected. pages that are
+/// already in use are migrated if possible. this is a no-op for
+/// TRI_NUMA_NODE_ANY and on platforms without NUMA support. the placement
+/// is a hint only, so failures are logged but not reported to the caller.
+/// the region must not share pages with other allocations, so heap memory
+/// should not be bound. use TRI_NumaAllocate instead
+////////////////////////////////////////////////////////////////////////////////
+
+void TRI_NumaBindMemory (void*,
+                         size_t,
+                         int);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief allocates memory that is placed on a NUMA node
+///
+/// for a specific node, the memory is mapped anonymously and bound to the node
+/// before it is touched, so its pages are faulted in on that node. the memory
+/// is page-granular and always zeroed. for TRI_NUMA_NODE_ANY and on platforms
+/// without NUMA support, the memory is allocated from TRI_UNKNOWN_MEM_ZONE.
+/// returns a nullptr if the memory cannot be allocated. the memory must be
+/// released with TRI_NumaFree, passing the same size and node
+////////////////////////////////////////////////////////////////////////////////
+
+void* TRI_NumaAllocate (size_t,
+                        int,
+                        bool);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief frees memory allocated with TRI_NumaAllocate
+////////////////////////////////////////////////////////////////////////////////
+
+void TRI_NumaFree (void*,
+                   size_t,
+                   int);
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                            modules initialisation
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief initialises the NUMA components
+////////////////////////////////////////////////////////////////////////////////
+
+void TRI_InitialiseNuma ();
+
+#endif
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                       END-OF-FILE
+// -----------------------------------------------------------------------------
+
+// Local Variables:
+// mode: outline-minor
+// outline-regexp: "/// @brief\\|/// {@inheritDoc}\\|/// @page\\|// --SECTION--\\|/// @\\}"
+// End:
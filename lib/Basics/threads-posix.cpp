@@ -230,6 +230,30 @@ void TRI_SetProcessorAffinity (TRI_thread_t* thread, size_t core) {
 #endif
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief sets the process affinity to a set of cores
+////////////////////////////////////////////////////////////////////////////////
+
+void TRI_SetProcessorAffinity (TRI_thread_t* thread, std::vector<size_t> const& cores) {
+#ifdef TRI_HAVE_THREAD_AFFINITY
+
+  cpu_set_t cpuset;
+
+  CPU_ZERO(&cpuset);
+
+  for (auto const& core : cores) {
+    CPU_SET(core, &cpuset);
+  }
+
+  int s = pthread_setaffinity_np(*thread, sizeof(cpu_set_t), &cpuset);
+
+  if (s != 0) {
+    LOG_ERROR("cannot set affinity to %d cores: %s", (int) cores.size(), strerror(errno));
+  }
+
+#endif
+}
+
 #endif
 
 // -----------------------------------------------------------------------------
@@ -226,6 +226,13 @@ void TRI_AllowCancelation(void) {
 void TRI_SetProcessorAffinity (TRI_thread_t* thread, size_t core) {
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief sets the process affinity to a set of cores
+////////////////////////////////////////////////////////////////////////////////
+
+void TRI_SetProcessorAffinity (TRI_thread_t* thread, std::vector<size_t> const& cores) {
+}
+
 // -----------------------------------------------------------------------------
 // --SECTION--                                                       END-OF-FILE
 // -----------------------------------------------------------------------------